@@ -91,7 +91,8 @@ static int32_t WriteRegWrap(void *Handle, uint8_t Reg, uint8_t *pData, uint16_t
 static int32_t HTS221_GetOutputDataRate(HTS221_Object_t *pObj, float *Odr);
 static int32_t HTS221_SetOutputDataRate(HTS221_Object_t *pObj, float Odr);
 static int32_t HTS221_Initialize(HTS221_Object_t *pObj);
-static float Linear_Interpolation(lin_t *Lin, float Coeff);
+static int32_t HTS221_LoadCalibration(HTS221_Object_t *pObj);
+static float Linear_Interpolation(const lin_fixed_t *Lin, int16_t Raw);
 
 /**
  * @}
@@ -330,36 +331,6 @@ int32_t HTS221_HUM_SetOutputDataRate(HTS221_Object_t *pObj, float Odr)
 int32_t HTS221_HUM_GetHumidity(HTS221_Object_t *pObj, float *Value)
 {
   axis1bit16_t data_raw_humidity;
-  axis1bit16_t coeff;
-  lin_t lin_hum;
-
-  if (hts221_hum_adc_point_0_get(&(pObj->Ctx), coeff.u8bit) != HTS221_OK)
-  {
-    return HTS221_ERROR;
-  }
-
-  lin_hum.x0 = (float)coeff.i16bit;
-
-  if (hts221_hum_rh_point_0_get(&(pObj->Ctx), coeff.u8bit) != HTS221_OK)
-  {
-    return HTS221_ERROR;
-  }
-
-  lin_hum.y0 = (float)coeff.u8bit[0];
-
-  if (hts221_hum_adc_point_1_get(&(pObj->Ctx), coeff.u8bit) != HTS221_OK)
-  {
-    return HTS221_ERROR;
-  }
-
-  lin_hum.x1 = (float)coeff.i16bit;
-
-  if (hts221_hum_rh_point_1_get(&(pObj->Ctx), coeff.u8bit) != HTS221_OK)
-  {
-    return HTS221_ERROR;
-  }
-
-  lin_hum.y1 = (float)coeff.u8bit[0];
 
   (void)memset(data_raw_humidity.u8bit, 0x00, sizeof(int16_t));
   if (hts221_humidity_raw_get(&(pObj->Ctx), data_raw_humidity.u8bit) != HTS221_OK)
@@ -367,7 +338,7 @@ int32_t HTS221_HUM_GetHumidity(HTS221_Object_t *pObj, float *Value)
     return HTS221_ERROR;
   }
 
-  *Value = Linear_Interpolation(&lin_hum, (float)data_raw_humidity.i16bit);
+  *Value = Linear_Interpolation(&pObj->hum_lin, data_raw_humidity.i16bit);
 
   if (*Value < 0.0f)
   {
@@ -487,36 +458,6 @@ int32_t HTS221_TEMP_SetOutputDataRate(HTS221_Object_t *pObj, float Odr)
 int32_t HTS221_TEMP_GetTemperature(HTS221_Object_t *pObj, float *Value)
 {
   axis1bit16_t data_raw_temperature;
-  axis1bit16_t coeff;
-  lin_t lin_temp;
-
-  if (hts221_temp_adc_point_0_get(&(pObj->Ctx), coeff.u8bit) != HTS221_OK)
-  {
-    return HTS221_ERROR;
-  }
-
-  lin_temp.x0 = (float)coeff.i16bit;
-
-  if (hts221_temp_deg_point_0_get(&(pObj->Ctx), coeff.u8bit) != HTS221_OK)
-  {
-    return HTS221_ERROR;
-  }
-
-  lin_temp.y0 = (float)coeff.u8bit[0];
-
-  if (hts221_temp_adc_point_1_get(&(pObj->Ctx), coeff.u8bit) != HTS221_OK)
-  {
-    return HTS221_ERROR;
-  }
-
-  lin_temp.x1 = (float)coeff.i16bit;
-
-  if (hts221_temp_deg_point_1_get(&(pObj->Ctx), coeff.u8bit) != HTS221_OK)
-  {
-    return HTS221_ERROR;
-  }
-
-  lin_temp.y1 = (float)coeff.u8bit[0];
 
   (void)memset(data_raw_temperature.u8bit, 0x00, sizeof(int16_t));
   if (hts221_temperature_raw_get(&(pObj->Ctx), data_raw_temperature.u8bit) != HTS221_OK)
@@ -524,7 +465,7 @@ int32_t HTS221_TEMP_GetTemperature(HTS221_Object_t *pObj, float *Value)
     return HTS221_ERROR;
   }
 
-  *Value = Linear_Interpolation(&lin_temp, (float)data_raw_temperature.i16bit);
+  *Value = Linear_Interpolation(&pObj->temp_lin, data_raw_temperature.i16bit);
 
   return HTS221_OK;
 }
@@ -603,6 +544,55 @@ int32_t HTS221_Get_One_Shot_Status(HTS221_Object_t *pObj, uint8_t *Status)
   return HTS221_OK;
 }
 
+/**
+ * @brief  Get the HTS221 One Shot Status and the converted values
+ * @param  pObj the device pObj
+ * @param  Status pointer to the one shot status (1 means measurements available, 0 means measurements not available yet)
+ * @param  Humidity pointer where the humidity value is written, when available
+ * @param  Temperature pointer where the temperature value is written, when available
+ * @retval 0 in case of success, an error code otherwise
+ */
+int32_t HTS221_Get_One_Shot_Data(HTS221_Object_t *pObj, uint8_t *Status, float *Humidity, float *Temperature)
+{
+  uint8_t data_raw[5];
+  int16_t humidity;
+  int16_t temperature;
+
+  /* STATUS_REG, HUMIDITY_OUT_L/H and TEMP_OUT_L/H are contiguous: one transfer */
+  if (hts221_read_reg(&(pObj->Ctx), HTS221_STATUS_REG, data_raw, 5) != HTS221_OK)
+  {
+    return HTS221_ERROR;
+  }
+
+  /* T_DA is bit 0, H_DA bit 1 */
+  if ((data_raw[0] & 0x03U) != 0x03U)
+  {
+    *Status = 0;
+    return HTS221_OK;
+  }
+
+  *Status = 1;
+
+  humidity = (int16_t)(((uint16_t)data_raw[2] << 8) | data_raw[1]);
+  temperature = (int16_t)(((uint16_t)data_raw[4] << 8) | data_raw[3]);
+
+  *Humidity = Linear_Interpolation(&pObj->hum_lin, humidity);
+
+  if (*Humidity < 0.0f)
+  {
+    *Humidity = 0.0f;
+  }
+
+  if (*Humidity > 100.0f)
+  {
+    *Humidity = 100.0f;
+  }
+
+  *Temperature = Linear_Interpolation(&pObj->temp_lin, temperature);
+
+  return HTS221_OK;
+}
+
 /**
  * @brief  Get the HTS221 register value
  * @param  pObj the device pObj
@@ -734,6 +724,54 @@ static int32_t HTS221_Initialize(HTS221_Object_t *pObj)
     return HTS221_ERROR;
   }
 
+  /* Factory calibration, read once */
+  if (HTS221_LoadCalibration(pObj) != HTS221_OK)
+  {
+    return HTS221_ERROR;
+  }
+
+  return HTS221_OK;
+}
+
+/**
+ * @brief  Read the factory calibration and set the humidity and temperature lines
+ * @param  pObj the device pObj
+ * @retval 0 in case of success, an error code otherwise
+ * @note   The points are truncated as by the hts221_hum_rh_point_x_get() and
+ *         hts221_temp_deg_point_x_get() register functions
+ */
+static int32_t HTS221_LoadCalibration(HTS221_Object_t *pObj)
+{
+  uint8_t calib[16];
+  int32_t x0;
+  int32_t y0;
+  int32_t x1;
+  int32_t y1;
+
+  /* H0_RH_X2 to T1_OUT_H in one read */
+  if (hts221_read_reg(&(pObj->Ctx), HTS221_H0_RH_X2, calib, (uint16_t)sizeof(calib)) != HTS221_OK)
+  {
+    return HTS221_ERROR;
+  }
+
+  x0 = (int16_t)((uint16_t)calib[0x06] | ((uint16_t)calib[0x07] << 8));
+  x1 = (int16_t)((uint16_t)calib[0x0A] | ((uint16_t)calib[0x0B] << 8));
+  y0 = (uint8_t)(calib[0x00] >> 1);
+  y1 = (uint8_t)(calib[0x01] >> 1);
+
+  pObj->hum_lin.slope     = y1 - y0;
+  pObj->hum_lin.intercept = (x1 * y0) - (x0 * y1);
+  pObj->hum_lin.div       = (float)(x1 - x0);
+
+  x0 = (int16_t)((uint16_t)calib[0x0C] | ((uint16_t)calib[0x0D] << 8));
+  x1 = (int16_t)((uint16_t)calib[0x0E] | ((uint16_t)calib[0x0F] << 8));
+  y0 = (uint8_t)(((((uint32_t)calib[0x05] & 0x03U) << 8) + calib[0x02]) >> 3);
+  y1 = (uint8_t)(((((uint32_t)calib[0x05] & 0x0CU) << 6) + calib[0x03]) >> 3);
+
+  pObj->temp_lin.slope     = y1 - y0;
+  pObj->temp_lin.intercept = (x1 * y0) - (x0 * y1);
+  pObj->temp_lin.div       = (float)(x1 - x0);
+
   return HTS221_OK;
 }
 
@@ -755,12 +793,15 @@ int32_t HTS221_Enable_DRDY_Interrupt(HTS221_Object_t *pObj)
 /**
  * @brief  Function used to apply coefficient
  * @param  Lin the line
- * @param  Coeff the coefficient
+ * @param  Raw the output register value
  * @retval Calculation result
+ * @note   The numerator is exact in integers: converted to float it rounds as
+ *         the float sum did, so the result is the one of the float interpolation
+ *         between the points
  */
-static float Linear_Interpolation(lin_t *Lin, float Coeff)
+static float Linear_Interpolation(const lin_fixed_t *Lin, int16_t Raw)
 {
-  return (((Lin->y1 - Lin->y0) * Coeff) + ((Lin->x1 * Lin->y0) - (Lin->x0 * Lin->y1))) / (Lin->x1 - Lin->x0);
+  return (float)((Lin->slope * (int32_t)Raw) + Lin->intercept) / Lin->div;
 }
 
 /**
@@ -87,6 +87,14 @@ typedef struct
   float y1;
 } lin_t;
 
+/* Calibration line: y = (slope * x + intercept) / div, div is x1 - x0 */
+typedef struct
+{
+  int32_t slope;
+  int32_t intercept;
+  float div;
+} lin_fixed_t;
+
 typedef struct
 {
   HTS221_IO_t        IO;
@@ -94,6 +102,8 @@ typedef struct
   uint8_t            is_initialized;
   uint8_t            hum_is_enabled;
   uint8_t            temp_is_enabled;
+  lin_fixed_t        hum_lin;
+  lin_fixed_t        temp_lin;
 } HTS221_Object_t;
 
 typedef struct
@@ -181,6 +191,7 @@ int32_t HTS221_Write_Reg(HTS221_Object_t *pObj, uint8_t Reg, uint8_t Data);
 
 int32_t HTS221_Set_One_Shot(HTS221_Object_t *pObj);
 int32_t HTS221_Get_One_Shot_Status(HTS221_Object_t *pObj, uint8_t *Status);
+int32_t HTS221_Get_One_Shot_Data(HTS221_Object_t *pObj, uint8_t *Status, float *Humidity, float *Temperature);
 
 int32_t HTS221_Enable_DRDY_Interrupt(HTS221_Object_t *pObj);
 
@@ -82,6 +82,7 @@ LIS2MDL_MAG_Drv_t LIS2MDL_MAG_Driver =
  */
 static int32_t ReadMagRegWrap(void *Handle, uint8_t Reg, uint8_t *pData, uint16_t Length);
 static int32_t WriteMagRegWrap(void *Handle, uint8_t Reg, uint8_t *pData, uint16_t Length);
+static int32_t LIS2MDL_ConvertAxis(int16_t Raw);
 
 /**
  * @}
@@ -438,7 +439,6 @@ int32_t LIS2MDL_MAG_GetAxesRaw(LIS2MDL_Object_t *pObj, LIS2MDL_AxesRaw_t *Value)
 int32_t LIS2MDL_MAG_GetAxes(LIS2MDL_Object_t *pObj, LIS2MDL_Axes_t *MagneticField)
 {
   axis3bit16_t data_raw;
-  float sensitivity;
 
   /* Read raw data values. */
   if (lis2mdl_magnetic_raw_get(&(pObj->Ctx), data_raw.u8bit) != LIS2MDL_OK)
@@ -446,13 +446,45 @@ int32_t LIS2MDL_MAG_GetAxes(LIS2MDL_Object_t *pObj, LIS2MDL_Axes_t *MagneticFiel
     return LIS2MDL_ERROR;
   }
 
-  /* Get LIS2MDL actual sensitivity. */
-  (void)LIS2MDL_MAG_GetSensitivity(pObj, &sensitivity);
-
   /* Calculate the data. */
-  MagneticField->x = (int32_t)((float)((float)data_raw.i16bit[0] * sensitivity));
-  MagneticField->y = (int32_t)((float)((float)data_raw.i16bit[1] * sensitivity));
-  MagneticField->z = (int32_t)((float)((float)data_raw.i16bit[2] * sensitivity));
+  return LIS2MDL_MAG_ConvertAxes(pObj, data_raw.u8bit, MagneticField);
+}
+
+/**
+ * @brief  Get where the magnetic sensor output registers are, for a LIS2MDL_AXES_SIZE
+ *         bytes burst read issued outside of the driver (e.g. by DMA), to be decoded
+ *         with LIS2MDL_MAG_ConvertAxes()
+ * @param  pObj the device pObj
+ * @param  Address pointer where the I2C device address is written
+ * @param  Reg pointer where the first register of the burst is written, multi-byte bit included
+ * @retval 0 in case of success, an error code otherwise (SPI bus)
+ */
+int32_t LIS2MDL_MAG_GetAxesReg(LIS2MDL_Object_t *pObj, uint8_t *Address, uint8_t *Reg)
+{
+  if (pObj->IO.BusType != LIS2MDL_I2C_BUS)
+  {
+    return LIS2MDL_ERROR;
+  }
+
+  /* Same multi-byte read as ReadMagRegWrap() */
+  *Address = pObj->IO.Address;
+  *Reg = (uint8_t)(LIS2MDL_OUTX_L_REG | 0x80U);
+
+  return LIS2MDL_OK;
+}
+
+/**
+ * @brief  Convert the magnetic sensor output registers
+ * @param  pObj the device pObj
+ * @param  Data the LIS2MDL_AXES_SIZE bytes read from OUTX_L_REG
+ * @param  MagneticField pointer where the values of the axes are written [mgauss]
+ * @retval 0 in case of success, an error code otherwise
+ */
+int32_t LIS2MDL_MAG_ConvertAxes(LIS2MDL_Object_t *pObj, const uint8_t *Data, LIS2MDL_Axes_t *MagneticField)
+{
+  MagneticField->x = LIS2MDL_ConvertAxis((int16_t)(((uint16_t)Data[1] << 8) | Data[0]));
+  MagneticField->y = LIS2MDL_ConvertAxis((int16_t)(((uint16_t)Data[3] << 8) | Data[2]));
+  MagneticField->z = LIS2MDL_ConvertAxis((int16_t)(((uint16_t)Data[5] << 8) | Data[4]));
 
   return LIS2MDL_OK;
 }
@@ -581,6 +613,19 @@ int32_t LIS2MDL_MAG_Set_Power_Mode(LIS2MDL_Object_t *pObj, uint8_t PowerMode)
  * @{
  */
 
+/**
+ * @brief  Convert a raw axis sample with the fixed-point sensitivity
+ * @param  Raw the raw sample [LSB]
+ * @retval the converted value [mgauss], truncated toward zero
+ */
+static int32_t LIS2MDL_ConvertAxis(int16_t Raw)
+{
+  uint32_t magnitude = (Raw < 0) ? (uint32_t)(-(int32_t)Raw) : (uint32_t)Raw;
+  int32_t value = (int32_t)((magnitude * LIS2MDL_MAG_SENSITIVITY_FP_FS_50GAUSS) / (uint32_t)LIS2MDL_SENSITIVITY_SCALE);
+
+  return (Raw < 0) ? -value : value;
+}
+
 /**
  * @brief  Wrap Read register component function to Bus IO function
  * @param  Handle the device handler
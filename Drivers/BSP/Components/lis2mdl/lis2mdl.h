@@ -154,6 +154,13 @@ typedef struct
 
 #define LIS2MDL_MAG_SENSITIVITY_FS_50GAUSS  1.500f  /**< Sensitivity value for 50 gauss full scale [mgauss/LSB] */
 
+/* Fixed-point sensitivity used by the axes conversion, scaled by LIS2MDL_SENSITIVITY_SCALE */
+#define LIS2MDL_SENSITIVITY_SCALE                  1000
+#define LIS2MDL_MAG_SENSITIVITY_FP_FS_50GAUSS      1500U
+
+/* Magnetic sensor output registers, OUTX_L_REG..OUTZ_H_REG */
+#define LIS2MDL_AXES_SIZE                          6U
+
 /**
  * @}
  */
@@ -177,6 +184,8 @@ int32_t LIS2MDL_MAG_GetFullScale(LIS2MDL_Object_t *pObj, int32_t *fullscale);
 int32_t LIS2MDL_MAG_SetFullScale(LIS2MDL_Object_t *pObj, int32_t fullscale);
 int32_t LIS2MDL_MAG_GetAxes(LIS2MDL_Object_t *pObj, LIS2MDL_Axes_t *magnetic_field);
 int32_t LIS2MDL_MAG_GetAxesRaw(LIS2MDL_Object_t *pObj, LIS2MDL_AxesRaw_t *value);
+int32_t LIS2MDL_MAG_GetAxesReg(LIS2MDL_Object_t *pObj, uint8_t *Address, uint8_t *Reg);
+int32_t LIS2MDL_MAG_ConvertAxes(LIS2MDL_Object_t *pObj, const uint8_t *Data, LIS2MDL_Axes_t *MagneticField);
 
 int32_t LIS2MDL_Read_Reg(LIS2MDL_Object_t *pObj, uint8_t reg, uint8_t *data);
 int32_t LIS2MDL_Write_Reg(LIS2MDL_Object_t *pObj, uint8_t reg, uint8_t data);
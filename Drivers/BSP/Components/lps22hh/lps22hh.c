@@ -757,6 +757,54 @@ int32_t LPS22HH_FIFO_Get_Data(LPS22HH_Object_t *pObj, float *Press, float *Temp)
   return LPS22HH_OK;
 }
 
+/**
+ * @brief  Get several samples from the LPS22HH FIFO
+ * @param  pObj the device pObj
+ * @param  Press array where the Nbr pressure values are written
+ * @param  Temp array where the Nbr temperature values are written
+ * @param  Nbr number of samples to be read, at most the FIFO level
+ * @retval 0 in case of success, an error code otherwise
+ */
+int32_t LPS22HH_FIFO_Get_Data_Burst(LPS22HH_Object_t *pObj, float *Press, float *Temp, uint8_t Nbr)
+{
+  uint8_t data_raw[LPS22HH_FIFO_BURST_NBR * LPS22HH_FIFO_SAMPLE_SIZE];
+  const uint8_t *sample;
+  uint32_t count;
+  uint32_t done = 0;
+  uint32_t i;
+  int32_t pressure;
+  int16_t temperature;
+
+  /* With auto-increment the address rolls back from FIFO_DATA_OUT_TEMP_H to
+   * FIFO_DATA_OUT_PRESS_XL, so consecutive samples are read in one transfer */
+  while (done < Nbr)
+  {
+    count = ((Nbr - done) < LPS22HH_FIFO_BURST_NBR) ? (Nbr - done) : LPS22HH_FIFO_BURST_NBR;
+
+    if (lps22hh_read_reg(&(pObj->Ctx), LPS22HH_FIFO_DATA_OUT_PRESS_XL, data_raw,
+                         (uint16_t)(count * LPS22HH_FIFO_SAMPLE_SIZE)) != LPS22HH_OK)
+    {
+      return LPS22HH_ERROR;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+      sample = &data_raw[i * LPS22HH_FIFO_SAMPLE_SIZE];
+
+      /* Same conversion as LPS22HH_FIFO_Get_Data */
+      pressure = (int32_t)(((uint32_t)sample[2] << 16) | ((uint32_t)sample[1] << 8) | sample[0]);
+      temperature = (int16_t)(((uint16_t)sample[4] << 8) | sample[3]);
+
+      Press[done + i] = lps22hh_from_lsb_to_hpa(pressure);
+      Temp[done + i] = lps22hh_from_lsb_to_celsius(temperature);
+    }
+
+    done += count;
+  }
+
+  return LPS22HH_OK;
+}
+
 /**
  * @brief  Get the LPS22HH FIFO threshold
  * @param  pObj the device pObj
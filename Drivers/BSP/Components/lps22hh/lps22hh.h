@@ -153,6 +153,9 @@ typedef enum
 
 #define LPS22HH_FIFO_FULL        (uint8_t)0x20
 
+#define LPS22HH_FIFO_SAMPLE_SIZE  5U  /* Pressure (3 bytes) and temperature (2 bytes) */
+#define LPS22HH_FIFO_BURST_NBR    16U /* FIFO samples read per bus transaction */
+
 /** LPS22HH low noise mode  **/
 #define LPS22HH_LOW_NOISE_DIS      0
 #define LPS22HH_LOW_NOISE_EN       1
@@ -193,6 +196,7 @@ int32_t LPS22HH_Get_Press(LPS22HH_Object_t *pObj, float *Data);
 int32_t LPS22HH_Get_Temp(LPS22HH_Object_t *pObj, float *Data);
 
 int32_t LPS22HH_FIFO_Get_Data(LPS22HH_Object_t *pObj, float *Press, float *Temp);
+int32_t LPS22HH_FIFO_Get_Data_Burst(LPS22HH_Object_t *pObj, float *Press, float *Temp, uint8_t Nbr);
 int32_t LPS22HH_FIFO_Get_FTh_Status(LPS22HH_Object_t *pObj, uint8_t *Status);
 int32_t LPS22HH_FIFO_Get_Full_Status(LPS22HH_Object_t *pObj, uint8_t *Status);
 int32_t LPS22HH_FIFO_Get_Ovr_Status(LPS22HH_Object_t *pObj, uint8_t *Status);
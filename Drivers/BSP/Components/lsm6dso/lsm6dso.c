@@ -86,6 +86,41 @@ LSM6DSO_GYRO_Drv_t LSM6DSO_GYRO_Driver =
   LSM6DSO_GYRO_GetAxesRaw,
 };
 
+/**
+ * @}
+ */
+
+/** @defgroup LSM6DSO_Private_Types LSM6DSO Private Types
+ * @{
+ */
+
+/* Event configuration registers, TAP_CFG0 to MD2_CFG, read and written in one burst */
+typedef struct
+{
+  lsm6dso_tap_cfg0_t    tap_cfg0;
+  lsm6dso_tap_cfg1_t    tap_cfg1;
+  lsm6dso_tap_cfg2_t    tap_cfg2;
+  lsm6dso_tap_ths_6d_t  tap_ths_6d;
+  lsm6dso_int_dur2_t    int_dur2;
+  lsm6dso_wake_up_ths_t wake_up_ths;
+  lsm6dso_wake_up_dur_t wake_up_dur;
+  lsm6dso_free_fall_t   free_fall;
+  lsm6dso_md1_cfg_t     md1_cfg;
+  lsm6dso_md2_cfg_t     md2_cfg;
+} LSM6DSO_Event_Regs_t;
+
+typedef struct
+{
+  lsm6dso_int1_ctrl_t   int1_ctrl;
+  lsm6dso_int2_ctrl_t   int2_ctrl;
+} LSM6DSO_Int_Ctrl_Regs_t;
+
+typedef struct
+{
+  lsm6dso_emb_func_en_a_t emb_func_en_a;
+  lsm6dso_emb_func_en_b_t emb_func_en_b;
+} LSM6DSO_Emb_Func_En_Regs_t;
+
 /**
  * @}
  */
@@ -98,6 +133,12 @@ static int32_t LSM6DSO_ACC_SetOutputDataRate_When_Enabled(LSM6DSO_Object_t *pObj
 static int32_t LSM6DSO_ACC_SetOutputDataRate_When_Disabled(LSM6DSO_Object_t *pObj, float Odr);
 static int32_t LSM6DSO_GYRO_SetOutputDataRate_When_Enabled(LSM6DSO_Object_t *pObj, float Odr);
 static int32_t LSM6DSO_GYRO_SetOutputDataRate_When_Disabled(LSM6DSO_Object_t *pObj, float Odr);
+static int32_t LSM6DSO_ACC_GetSensitivityFp(LSM6DSO_Object_t *pObj, uint32_t *Sensitivity);
+static int32_t LSM6DSO_GYRO_GetSensitivityFp(LSM6DSO_Object_t *pObj, uint32_t *Sensitivity);
+static int32_t LSM6DSO_ConvertAxis(int16_t Raw, uint32_t Sensitivity);
+static int32_t LSM6DSO_ACC_Set_Emb_Func_Events(LSM6DSO_Object_t *pObj, uint8_t Pedometer, uint8_t Tilt,
+                                               lsm6dso_pin_int1_route_t *Int1Route,
+                                               lsm6dso_pin_int2_route_t *Int2Route);
 static int32_t ReadRegWrap(void *Handle, uint8_t Reg, uint8_t *pData, uint16_t Length);
 static int32_t WriteRegWrap(void *Handle, uint8_t Reg, uint8_t *pData, uint16_t Length);
 
@@ -213,6 +254,8 @@ int32_t LSM6DSO_Init(LSM6DSO_Object_t *pObj)
     return LSM6DSO_ERROR;
   }
 
+  pObj->acc_sensitivity = LSM6DSO_ACC_SENSITIVITY_FP_FS_2G;
+
   /* Select default output data rate. */
   pObj->gyro_odr = LSM6DSO_GY_ODR_104Hz;
 
@@ -228,6 +271,8 @@ int32_t LSM6DSO_Init(LSM6DSO_Object_t *pObj)
     return LSM6DSO_ERROR;
   }
 
+  pObj->gyro_sensitivity = LSM6DSO_GYRO_SENSITIVITY_FP_FS_2000DPS;
+
   pObj->is_initialized = 1;
 
   return LSM6DSO_OK;
@@ -362,40 +407,16 @@ int32_t LSM6DSO_ACC_Disable(LSM6DSO_Object_t *pObj)
  */
 int32_t LSM6DSO_ACC_GetSensitivity(LSM6DSO_Object_t *pObj, float *Sensitivity)
 {
-  int32_t ret = LSM6DSO_OK;
-  lsm6dso_fs_xl_t full_scale;
+  uint32_t sensitivity;
 
-  /* Read actual full scale selection from sensor. */
-  if (lsm6dso_xl_full_scale_get(&(pObj->Ctx), &full_scale) != LSM6DSO_OK)
+  if (LSM6DSO_ACC_GetSensitivityFp(pObj, &sensitivity) != LSM6DSO_OK)
   {
     return LSM6DSO_ERROR;
   }
 
-  /* Store the Sensitivity based on actual full scale. */
-  switch (full_scale)
-  {
-    case LSM6DSO_2g:
-      *Sensitivity = LSM6DSO_ACC_SENSITIVITY_FS_2G;
-      break;
-
-    case LSM6DSO_4g:
-      *Sensitivity = LSM6DSO_ACC_SENSITIVITY_FS_4G;
-      break;
-
-    case LSM6DSO_8g:
-      *Sensitivity = LSM6DSO_ACC_SENSITIVITY_FS_8G;
-      break;
-
-    case LSM6DSO_16g:
-      *Sensitivity = LSM6DSO_ACC_SENSITIVITY_FS_16G;
-      break;
-
-    default:
-      ret = LSM6DSO_ERROR;
-      break;
-  }
+  *Sensitivity = (float)sensitivity / (float)LSM6DSO_SENSITIVITY_SCALE;
 
-  return ret;
+  return LSM6DSO_OK;
 }
 
 /**
@@ -552,6 +573,9 @@ int32_t LSM6DSO_ACC_SetFullScale(LSM6DSO_Object_t *pObj, int32_t FullScale)
            : (FullScale <= 8) ? LSM6DSO_8g
            :                    LSM6DSO_16g;
 
+  /* Invalidate the cached sensitivity first: on a bus error the full scale is unknown. */
+  pObj->acc_sensitivity = 0;
+
   if (lsm6dso_xl_full_scale_set(&(pObj->Ctx), new_fs) != LSM6DSO_OK)
   {
     return LSM6DSO_ERROR;
@@ -593,7 +617,7 @@ int32_t LSM6DSO_ACC_GetAxesRaw(LSM6DSO_Object_t *pObj, LSM6DSO_AxesRaw_t *Value)
 int32_t LSM6DSO_ACC_GetAxes(LSM6DSO_Object_t *pObj, LSM6DSO_Axes_t *Acceleration)
 {
   axis3bit16_t data_raw;
-  float sensitivity = 0.0f;
+  uint32_t sensitivity;
 
   /* Read raw data values. */
   if (lsm6dso_acceleration_raw_get(&(pObj->Ctx), data_raw.u8bit) != LSM6DSO_OK)
@@ -602,15 +626,15 @@ int32_t LSM6DSO_ACC_GetAxes(LSM6DSO_Object_t *pObj, LSM6DSO_Axes_t *Acceleration
   }
 
   /* Get LSM6DSO actual sensitivity. */
-  if (LSM6DSO_ACC_GetSensitivity(pObj, &sensitivity) != LSM6DSO_OK)
+  if (LSM6DSO_ACC_GetSensitivityFp(pObj, &sensitivity) != LSM6DSO_OK)
   {
     return LSM6DSO_ERROR;
   }
 
   /* Calculate the data. */
-  Acceleration->x = (int32_t)((float)((float)data_raw.i16bit[0] * sensitivity));
-  Acceleration->y = (int32_t)((float)((float)data_raw.i16bit[1] * sensitivity));
-  Acceleration->z = (int32_t)((float)((float)data_raw.i16bit[2] * sensitivity));
+  Acceleration->x = LSM6DSO_ConvertAxis(data_raw.i16bit[0], sensitivity);
+  Acceleration->y = LSM6DSO_ConvertAxis(data_raw.i16bit[1], sensitivity);
+  Acceleration->z = LSM6DSO_ConvertAxis(data_raw.i16bit[2], sensitivity);
 
   return LSM6DSO_OK;
 }
@@ -677,44 +701,16 @@ int32_t LSM6DSO_GYRO_Disable(LSM6DSO_Object_t *pObj)
  */
 int32_t LSM6DSO_GYRO_GetSensitivity(LSM6DSO_Object_t *pObj, float *Sensitivity)
 {
-  int32_t ret = LSM6DSO_OK;
-  lsm6dso_fs_g_t full_scale;
+  uint32_t sensitivity;
 
-  /* Read actual full scale selection from sensor. */
-  if (lsm6dso_gy_full_scale_get(&(pObj->Ctx), &full_scale) != LSM6DSO_OK)
+  if (LSM6DSO_GYRO_GetSensitivityFp(pObj, &sensitivity) != LSM6DSO_OK)
   {
     return LSM6DSO_ERROR;
   }
 
-  /* Store the sensitivity based on actual full scale. */
-  switch (full_scale)
-  {
-    case LSM6DSO_125dps:
-      *Sensitivity = LSM6DSO_GYRO_SENSITIVITY_FS_125DPS;
-      break;
-
-    case LSM6DSO_250dps:
-      *Sensitivity = LSM6DSO_GYRO_SENSITIVITY_FS_250DPS;
-      break;
+  *Sensitivity = (float)sensitivity / (float)LSM6DSO_SENSITIVITY_SCALE;
 
-    case LSM6DSO_500dps:
-      *Sensitivity = LSM6DSO_GYRO_SENSITIVITY_FS_500DPS;
-      break;
-
-    case LSM6DSO_1000dps:
-      *Sensitivity = LSM6DSO_GYRO_SENSITIVITY_FS_1000DPS;
-      break;
-
-    case LSM6DSO_2000dps:
-      *Sensitivity = LSM6DSO_GYRO_SENSITIVITY_FS_2000DPS;
-      break;
-
-    default:
-      ret = LSM6DSO_ERROR;
-      break;
-  }
-
-  return ret;
+  return LSM6DSO_OK;
 }
 
 /**
@@ -870,6 +866,9 @@ int32_t LSM6DSO_GYRO_SetFullScale(LSM6DSO_Object_t *pObj, int32_t FullScale)
            : (FullScale <= 1000) ? LSM6DSO_1000dps
            :                       LSM6DSO_2000dps;
 
+  /* Invalidate the cached sensitivity first: on a bus error the full scale is unknown. */
+  pObj->gyro_sensitivity = 0;
+
   if (lsm6dso_gy_full_scale_set(&(pObj->Ctx), new_fs) != LSM6DSO_OK)
   {
     return LSM6DSO_ERROR;
@@ -911,7 +910,7 @@ int32_t LSM6DSO_GYRO_GetAxesRaw(LSM6DSO_Object_t *pObj, LSM6DSO_AxesRaw_t *Value
 int32_t LSM6DSO_GYRO_GetAxes(LSM6DSO_Object_t *pObj, LSM6DSO_Axes_t *AngularRate)
 {
   axis3bit16_t data_raw;
-  float sensitivity;
+  uint32_t sensitivity;
 
   /* Read raw data values. */
   if (lsm6dso_angular_rate_raw_get(&(pObj->Ctx), data_raw.u8bit) != LSM6DSO_OK)
@@ -920,15 +919,126 @@ int32_t LSM6DSO_GYRO_GetAxes(LSM6DSO_Object_t *pObj, LSM6DSO_Axes_t *AngularRate
   }
 
   /* Get LSM6DSO actual sensitivity. */
-  if (LSM6DSO_GYRO_GetSensitivity(pObj, &sensitivity) != LSM6DSO_OK)
+  if (LSM6DSO_GYRO_GetSensitivityFp(pObj, &sensitivity) != LSM6DSO_OK)
   {
     return LSM6DSO_ERROR;
   }
 
   /* Calculate the data. */
-  AngularRate->x = (int32_t)((float)((float)data_raw.i16bit[0] * sensitivity));
-  AngularRate->y = (int32_t)((float)((float)data_raw.i16bit[1] * sensitivity));
-  AngularRate->z = (int32_t)((float)((float)data_raw.i16bit[2] * sensitivity));
+  AngularRate->x = LSM6DSO_ConvertAxis(data_raw.i16bit[0], sensitivity);
+  AngularRate->y = LSM6DSO_ConvertAxis(data_raw.i16bit[1], sensitivity);
+  AngularRate->z = LSM6DSO_ConvertAxis(data_raw.i16bit[2], sensitivity);
+
+  return LSM6DSO_OK;
+}
+
+/**
+ * @brief  Get the LSM6DSO gyroscope and accelerometer axes (and optionally temperature)
+ *         with a single burst read of the contiguous output registers
+ * @param  pObj the device pObj
+ * @param  Acceleration pointer where the values of the accelerometer axes are written [mg]
+ * @param  AngularRate pointer where the values of the gyroscope axes are written [mdps]
+ * @param  Temperature pointer where the temperature is written [degC], NULL to skip it
+ * @retval 0 in case of success, an error code otherwise
+ */
+int32_t LSM6DSO_GetAxesAll(LSM6DSO_Object_t *pObj, LSM6DSO_Axes_t *Acceleration, LSM6DSO_Axes_t *AngularRate,
+                           float *Temperature)
+{
+  uint8_t data[2U + LSM6DSO_AXES_ALL_SIZE];
+  int16_t temp_raw;
+
+  /* OUT_TEMP_L..OUTZ_H_A are contiguous: read 14 bytes from the temperature or 12 from the gyroscope. */
+  if (Temperature != NULL)
+  {
+    if (lsm6dso_read_reg(&(pObj->Ctx), LSM6DSO_OUT_TEMP_L, data, (uint16_t)sizeof(data)) != LSM6DSO_OK)
+    {
+      return LSM6DSO_ERROR;
+    }
+  }
+  else
+  {
+    if (lsm6dso_read_reg(&(pObj->Ctx), LSM6DSO_OUTX_L_G, &data[2], LSM6DSO_AXES_ALL_SIZE) != LSM6DSO_OK)
+    {
+      return LSM6DSO_ERROR;
+    }
+  }
+
+  if (LSM6DSO_ConvertAxesAll(pObj, &data[2], Acceleration, AngularRate) != LSM6DSO_OK)
+  {
+    return LSM6DSO_ERROR;
+  }
+
+  if (Temperature != NULL)
+  {
+    /* 256 LSB/degC, 0 LSB at 25 degC */
+    temp_raw = (int16_t)(((uint16_t)data[1] << 8) | data[0]);
+    *Temperature = ((float)temp_raw / 256.0f) + 25.0f;
+  }
+
+  return LSM6DSO_OK;
+}
+
+/**
+ * @brief  Get where the gyroscope and accelerometer output registers are, for a
+ *         LSM6DSO_AXES_ALL_SIZE bytes burst read issued outside of the driver
+ *         (e.g. by DMA), to be decoded with LSM6DSO_ConvertAxesAll()
+ * @param  pObj the device pObj
+ * @param  Address pointer where the I2C device address is written
+ * @param  Reg pointer where the first register of the burst is written
+ * @retval 0 in case of success, an error code otherwise (SPI bus)
+ */
+int32_t LSM6DSO_GetAxesAllReg(LSM6DSO_Object_t *pObj, uint8_t *Address, uint8_t *Reg)
+{
+  if (pObj->IO.BusType != LSM6DSO_I2C_BUS)
+  {
+    return LSM6DSO_ERROR;
+  }
+
+  /* IF_INC is set by LSM6DSO_Init(): the register address auto-increments */
+  *Address = pObj->IO.Address;
+  *Reg = LSM6DSO_OUTX_L_G;
+
+  return LSM6DSO_OK;
+}
+
+/**
+ * @brief  Convert the gyroscope and accelerometer output registers
+ * @param  pObj the device pObj
+ * @param  Data the LSM6DSO_AXES_ALL_SIZE bytes read from OUTX_L_G
+ * @param  Acceleration pointer where the values of the accelerometer axes are written [mg]
+ * @param  AngularRate pointer where the values of the gyroscope axes are written [mdps]
+ * @retval 0 in case of success, an error code otherwise
+ */
+int32_t LSM6DSO_ConvertAxesAll(LSM6DSO_Object_t *pObj, const uint8_t *Data, LSM6DSO_Axes_t *Acceleration,
+                               LSM6DSO_Axes_t *AngularRate)
+{
+  int16_t data_raw[6];
+  uint32_t acc_sensitivity;
+  uint32_t gyro_sensitivity;
+  uint8_t i;
+
+  for (i = 0; i < 6U; i++)
+  {
+    data_raw[i] = (int16_t)(((uint16_t)Data[(2U * i) + 1U] << 8) | Data[2U * i]);
+  }
+
+  if (LSM6DSO_ACC_GetSensitivityFp(pObj, &acc_sensitivity) != LSM6DSO_OK)
+  {
+    return LSM6DSO_ERROR;
+  }
+
+  if (LSM6DSO_GYRO_GetSensitivityFp(pObj, &gyro_sensitivity) != LSM6DSO_OK)
+  {
+    return LSM6DSO_ERROR;
+  }
+
+  AngularRate->x = LSM6DSO_ConvertAxis(data_raw[0], gyro_sensitivity);
+  AngularRate->y = LSM6DSO_ConvertAxis(data_raw[1], gyro_sensitivity);
+  AngularRate->z = LSM6DSO_ConvertAxis(data_raw[2], gyro_sensitivity);
+
+  Acceleration->x = LSM6DSO_ConvertAxis(data_raw[3], acc_sensitivity);
+  Acceleration->y = LSM6DSO_ConvertAxis(data_raw[4], acc_sensitivity);
+  Acceleration->z = LSM6DSO_ConvertAxis(data_raw[5], acc_sensitivity);
 
   return LSM6DSO_OK;
 }
@@ -959,6 +1069,20 @@ int32_t LSM6DSO_Read_Reg(LSM6DSO_Object_t *pObj, uint8_t Reg, uint8_t *Data)
  */
 int32_t LSM6DSO_Write_Reg(LSM6DSO_Object_t *pObj, uint8_t Reg, uint8_t Data)
 {
+  /* A raw write may change the full scale behind the driver back. */
+  if (Reg == LSM6DSO_CTRL1_XL)
+  {
+    pObj->acc_sensitivity = 0;
+  }
+  else if (Reg == LSM6DSO_CTRL2_G)
+  {
+    pObj->gyro_sensitivity = 0;
+  }
+  else
+  {
+    /* Full scale unchanged */
+  }
+
   if (lsm6dso_write_reg(&(pObj->Ctx), Reg, &Data, 1) != LSM6DSO_OK)
   {
     return LSM6DSO_ERROR;
@@ -2225,6 +2349,205 @@ int32_t LSM6DSO_ACC_Get_6D_Orientation_ZH(LSM6DSO_Object_t *pObj, uint8_t *ZHigh
   return LSM6DSO_OK;
 }
 
+/**
+ * @brief  Set the whole hardware event configuration at once, events routed to INT1 pin
+ * @param  pObj the device pObj
+ * @param  Config the events to be enabled and their thresholds
+ * @retval 0 in case of success, an error code otherwise
+ * @note   The registers end up as if the events were all disabled with the LSM6DSO_ACC_Disable_*
+ *         functions and then Config->Events enabled with the LSM6DSO_ACC_Enable_* ones, but each
+ *         register block is read and written in one burst and only when its value changes
+ */
+int32_t LSM6DSO_ACC_Set_Event_Detection(LSM6DSO_Object_t *pObj, const LSM6DSO_Event_Config_t *Config)
+{
+  LSM6DSO_Event_Regs_t regs;
+  LSM6DSO_Event_Regs_t new_regs;
+  LSM6DSO_Int_Ctrl_Regs_t int_ctrl;
+  lsm6dso_pin_int1_route_t int1_route;
+  lsm6dso_pin_int2_route_t int2_route;
+  lsm6dso_ctrl1_xl_t ctrl1_xl;
+  lsm6dso_ctrl1_xl_t new_ctrl1_xl;
+  uint8_t events = Config->Events;
+  uint8_t ff = ((events & LSM6DSO_EVENT_FREE_FALL) != 0U) ? 1U : 0U;
+  uint8_t single_tap = ((events & LSM6DSO_EVENT_SINGLE_TAP) != 0U) ? 1U : 0U;
+  uint8_t double_tap = ((events & LSM6DSO_EVENT_DOUBLE_TAP) != 0U) ? 1U : 0U;
+  uint8_t wake_up = ((events & LSM6DSO_EVENT_WAKE_UP) != 0U) ? 1U : 0U;
+  uint8_t d6d = ((events & LSM6DSO_EVENT_6D_ORIENTATION) != 0U) ? 1U : 0U;
+  uint8_t pedometer = ((events & LSM6DSO_EVENT_PEDOMETER) != 0U) ? 1U : 0U;
+  uint8_t tilt = ((events & LSM6DSO_EVENT_TILT) != 0U) ? 1U : 0U;
+  int32_t ret;
+
+  /* Output Data Rate and Full scale selection, in a single CTRL1_XL access */
+  if (events == 0U)
+  {
+    if (LSM6DSO_ACC_SetOutputDataRate(pObj, Config->IdleOdr) != LSM6DSO_OK)
+    {
+      return LSM6DSO_ERROR;
+    }
+  }
+  else
+  {
+    if (lsm6dso_read_reg(&(pObj->Ctx), LSM6DSO_CTRL1_XL, (uint8_t *)&ctrl1_xl, 1) != LSM6DSO_OK)
+    {
+      return LSM6DSO_ERROR;
+    }
+
+    new_ctrl1_xl = ctrl1_xl;
+    new_ctrl1_xl.fs_xl = (uint8_t)LSM6DSO_2g;
+
+    /* The embedded functions run at 26 Hz, the other events at 416 Hz */
+    if ((ff | single_tap | double_tap | wake_up | d6d) != 0U)
+    {
+      if (pObj->acc_is_enabled == 1U)
+      {
+        new_ctrl1_xl.odr_xl = (uint8_t)LSM6DSO_XL_ODR_417Hz;
+      }
+      else
+      {
+        pObj->acc_odr = LSM6DSO_XL_ODR_417Hz;
+      }
+    }
+    else
+    {
+      if (pObj->acc_is_enabled == 1U)
+      {
+        new_ctrl1_xl.odr_xl = (uint8_t)LSM6DSO_XL_ODR_26Hz;
+      }
+      else
+      {
+        pObj->acc_odr = LSM6DSO_XL_ODR_26Hz;
+      }
+    }
+
+    if (memcmp(&new_ctrl1_xl, &ctrl1_xl, sizeof(ctrl1_xl)) != 0)
+    {
+      pObj->acc_sensitivity = 0;
+
+      if (lsm6dso_write_reg(&(pObj->Ctx), LSM6DSO_CTRL1_XL, (uint8_t *)&new_ctrl1_xl, 1) != LSM6DSO_OK)
+      {
+        return LSM6DSO_ERROR;
+      }
+    }
+  }
+
+  /* Pedometer and tilt, and their routing, in the embedded functions bank */
+  if (lsm6dso_mem_bank_set(&(pObj->Ctx), LSM6DSO_EMBEDDED_FUNC_BANK) != LSM6DSO_OK)
+  {
+    return LSM6DSO_ERROR;
+  }
+
+  ret = LSM6DSO_ACC_Set_Emb_Func_Events(pObj, pedometer, tilt, &int1_route, &int2_route);
+
+  /* Back to the user bank whatever happened in the embedded one */
+  if (lsm6dso_mem_bank_set(&(pObj->Ctx), LSM6DSO_USER_BANK) != LSM6DSO_OK)
+  {
+    return LSM6DSO_ERROR;
+  }
+
+  if (ret != LSM6DSO_OK)
+  {
+    return LSM6DSO_ERROR;
+  }
+
+  /* TAP_CFG0 to MD2_CFG, and INT1_CTRL and INT2_CTRL for the interrupts enable */
+  if (lsm6dso_read_reg(&(pObj->Ctx), LSM6DSO_INT1_CTRL, (uint8_t *)&int_ctrl, sizeof(int_ctrl)) != LSM6DSO_OK)
+  {
+    return LSM6DSO_ERROR;
+  }
+
+  if (lsm6dso_read_reg(&(pObj->Ctx), LSM6DSO_TAP_CFG0, (uint8_t *)&regs, sizeof(regs)) != LSM6DSO_OK)
+  {
+    return LSM6DSO_ERROR;
+  }
+
+  new_regs = regs;
+
+  /* Tap: X, Y and Z directions, threshold and time windows */
+  new_regs.tap_cfg0.tap_x_en = single_tap | double_tap;
+  new_regs.tap_cfg0.tap_y_en = single_tap | double_tap;
+  new_regs.tap_cfg0.tap_z_en = single_tap | double_tap;
+  new_regs.tap_cfg1.tap_ths_x = (double_tap != 0U) ? Config->DoubleTapThreshold
+                              : (single_tap != 0U) ? 0x08U
+                              :                      0x00U;
+  new_regs.int_dur2.shock = (double_tap != 0U) ? 0x03U : (single_tap != 0U) ? 0x02U : 0x00U;
+  new_regs.int_dur2.quiet = (double_tap != 0U) ? 0x03U : (single_tap != 0U) ? 0x01U : 0x00U;
+  new_regs.int_dur2.dur = (double_tap != 0U) ? 0x08U : 0x00U;
+  new_regs.wake_up_ths.single_double_tap = (double_tap != 0U) ? (uint8_t)LSM6DSO_BOTH_SINGLE_DOUBLE
+                                                              : (uint8_t)LSM6DSO_ONLY_SINGLE;
+
+  /* 6D orientation threshold */
+  new_regs.tap_ths_6d.sixd_ths = (d6d != 0U) ? (uint8_t)LSM6DSO_DEG_60 : (uint8_t)LSM6DSO_DEG_80;
+
+  /* Wake up threshold and duration */
+  new_regs.wake_up_ths.wk_ths = (wake_up != 0U) ? 0x02U : 0x00U;
+  if ((ff | wake_up) != 0U)
+  {
+    new_regs.wake_up_dur.wake_dur = 0x00U;
+  }
+
+  /* Free fall: FF_DUR 0x06, its bit 5 is in WAKE_UP_DUR and bits 4:0 in FREE_FALL */
+  if (ff != 0U)
+  {
+    new_regs.wake_up_dur.sleep_dur = 0x00U;
+    new_regs.wake_up_dur.ff_dur = 0x00U;
+    new_regs.free_fall.ff_dur = 0x06U;
+    new_regs.free_fall.ff_ths = Config->FreeFallThreshold;
+  }
+  else
+  {
+    new_regs.wake_up_dur.ff_dur = 0x00U;
+    new_regs.free_fall.ff_dur = 0x00U;
+    new_regs.free_fall.ff_ths = (uint8_t)LSM6DSO_FF_TSH_156mg;
+  }
+
+  /* Routing: the events on INT1 only */
+  new_regs.md1_cfg.int1_ff = ff;
+  new_regs.md1_cfg.int1_single_tap = single_tap;
+  new_regs.md1_cfg.int1_double_tap = double_tap;
+  new_regs.md1_cfg.int1_wu = wake_up;
+  new_regs.md1_cfg.int1_6d = d6d;
+  new_regs.md2_cfg.int2_ff = PROPERTY_DISABLE;
+  new_regs.md2_cfg.int2_single_tap = PROPERTY_DISABLE;
+  new_regs.md2_cfg.int2_double_tap = PROPERTY_DISABLE;
+  new_regs.md2_cfg.int2_wu = PROPERTY_DISABLE;
+  new_regs.md2_cfg.int2_6d = PROPERTY_DISABLE;
+
+  /* Same rules as lsm6dso_pin_int1_route_set and lsm6dso_pin_int2_route_set */
+  new_regs.md1_cfg.int1_emb_func = ((int1_route.emb_func_int1.int1_fsm_lc
+                                     | int1_route.emb_func_int1.int1_sig_mot
+                                     | int1_route.emb_func_int1.int1_step_detector
+                                     | int1_route.emb_func_int1.int1_tilt
+                                     | *(uint8_t *)&int1_route.fsm_int1_a
+                                     | *(uint8_t *)&int1_route.fsm_int1_b) != PROPERTY_DISABLE) ? 1U : 0U;
+  new_regs.md2_cfg.int2_emb_func = ((int2_route.emb_func_int2.int2_fsm_lc
+                                     | int2_route.emb_func_int2.int2_sig_mot
+                                     | int2_route.emb_func_int2.int2_step_detector
+                                     | int2_route.emb_func_int2.int2_tilt
+                                     | *(uint8_t *)&int2_route.fsm_int2_a
+                                     | *(uint8_t *)&int2_route.fsm_int2_b) != PROPERTY_DISABLE) ? 1U : 0U;
+  new_regs.tap_cfg2.interrupts_enable = ((int_ctrl.int2_ctrl.int2_cnt_bdr
+                                          | int_ctrl.int2_ctrl.int2_drdy_g
+                                          | int_ctrl.int2_ctrl.int2_drdy_temp
+                                          | int_ctrl.int2_ctrl.int2_drdy_xl
+                                          | int_ctrl.int2_ctrl.int2_fifo_full
+                                          | int_ctrl.int2_ctrl.int2_fifo_ovr
+                                          | int_ctrl.int2_ctrl.int2_fifo_th
+                                          | new_regs.md2_cfg.int2_sleep_change
+                                          | *(uint8_t *)&int_ctrl.int1_ctrl
+                                          | ff | single_tap | double_tap | wake_up | d6d
+                                          | new_regs.md1_cfg.int1_sleep_change) != PROPERTY_DISABLE) ? 1U : 0U;
+
+  if (memcmp(&new_regs, &regs, sizeof(regs)) != 0)
+  {
+    if (lsm6dso_write_reg(&(pObj->Ctx), LSM6DSO_TAP_CFG0, (uint8_t *)&new_regs, sizeof(new_regs)) != LSM6DSO_OK)
+    {
+      return LSM6DSO_ERROR;
+    }
+  }
+
+  return LSM6DSO_OK;
+}
+
 /**
  * @brief  Get the LSM6DSO ACC data ready bit value
  * @param  pObj the device pObj
@@ -3095,6 +3418,84 @@ int32_t LSM6DSO_DRDY_Set_Mode(LSM6DSO_Object_t *pObj, uint8_t Mode)
  * @{
  */
 
+/**
+ * @brief  Set the pedometer and tilt enables and their INT1 routing, embedded functions bank selected
+ * @param  pObj the device pObj
+ * @param  Pedometer pedometer enabled and routed to INT1 pin
+ * @param  Tilt tilt enabled and routed to INT1 pin
+ * @param  Int1Route embedded function part of the INT1 routing, read and updated
+ * @param  Int2Route embedded function part of the INT2 routing, read and updated
+ * @retval 0 in case of success, an error code otherwise
+ */
+static int32_t LSM6DSO_ACC_Set_Emb_Func_Events(LSM6DSO_Object_t *pObj, uint8_t Pedometer, uint8_t Tilt,
+                                               lsm6dso_pin_int1_route_t *Int1Route,
+                                               lsm6dso_pin_int2_route_t *Int2Route)
+{
+  LSM6DSO_Emb_Func_En_Regs_t emb_en;
+  LSM6DSO_Emb_Func_En_Regs_t new_emb_en;
+  lsm6dso_emb_func_int1_t new_emb_int1;
+  lsm6dso_emb_func_int2_t new_emb_int2;
+
+  if (lsm6dso_read_reg(&(pObj->Ctx), LSM6DSO_EMB_FUNC_EN_A, (uint8_t *)&emb_en, sizeof(emb_en)) != LSM6DSO_OK)
+  {
+    return LSM6DSO_ERROR;
+  }
+
+  /* EMB_FUNC_INT1, FSM_INT1_A and FSM_INT1_B are contiguous, as EMB_FUNC_INT2, FSM_INT2_A and FSM_INT2_B */
+  if (lsm6dso_read_reg(&(pObj->Ctx), LSM6DSO_EMB_FUNC_INT1, (uint8_t *)&Int1Route->emb_func_int1, 3) != LSM6DSO_OK)
+  {
+    return LSM6DSO_ERROR;
+  }
+
+  if (lsm6dso_read_reg(&(pObj->Ctx), LSM6DSO_EMB_FUNC_INT2, (uint8_t *)&Int2Route->emb_func_int2, 3) != LSM6DSO_OK)
+  {
+    return LSM6DSO_ERROR;
+  }
+
+  /* Pedometer in base mode: the PEDO_CMD_REG bits of the advanced modes stay cleared */
+  new_emb_en = emb_en;
+  new_emb_en.emb_func_en_a.pedo_en = Pedometer;
+  new_emb_en.emb_func_en_a.tilt_en = Tilt;
+  new_emb_en.emb_func_en_b.pedo_adv_en = PROPERTY_DISABLE;
+
+  new_emb_int1 = Int1Route->emb_func_int1;
+  new_emb_int1.int1_step_detector = Pedometer;
+  new_emb_int1.int1_tilt = Tilt;
+
+  new_emb_int2 = Int2Route->emb_func_int2;
+  new_emb_int2.int2_tilt = PROPERTY_DISABLE;
+
+  if (memcmp(&new_emb_en, &emb_en, sizeof(emb_en)) != 0)
+  {
+    if (lsm6dso_write_reg(&(pObj->Ctx), LSM6DSO_EMB_FUNC_EN_A, (uint8_t *)&new_emb_en, sizeof(new_emb_en)) != LSM6DSO_OK)
+    {
+      return LSM6DSO_ERROR;
+    }
+  }
+
+  if (memcmp(&new_emb_int1, &Int1Route->emb_func_int1, sizeof(new_emb_int1)) != 0)
+  {
+    Int1Route->emb_func_int1 = new_emb_int1;
+
+    if (lsm6dso_write_reg(&(pObj->Ctx), LSM6DSO_EMB_FUNC_INT1, (uint8_t *)&new_emb_int1, 1) != LSM6DSO_OK)
+    {
+      return LSM6DSO_ERROR;
+    }
+  }
+
+  if (memcmp(&new_emb_int2, &Int2Route->emb_func_int2, sizeof(new_emb_int2)) != 0)
+  {
+    Int2Route->emb_func_int2 = new_emb_int2;
+
+    if (lsm6dso_write_reg(&(pObj->Ctx), LSM6DSO_EMB_FUNC_INT2, (uint8_t *)&new_emb_int2, 1) != LSM6DSO_OK)
+    {
+      return LSM6DSO_ERROR;
+    }
+  }
+
+  return LSM6DSO_OK;
+}
+
 /**
  * @brief  Set the LSM6DSO accelerometer sensor output data rate when enabled
  * @param  pObj the device pObj
@@ -3199,6 +3600,129 @@ static int32_t LSM6DSO_GYRO_SetOutputDataRate_When_Disabled(LSM6DSO_Object_t *pO
   return LSM6DSO_OK;
 }
 
+/**
+ * @brief  Get the LSM6DSO accelerometer fixed-point sensitivity, reading the full scale only if not cached
+ * @param  pObj the device pObj
+ * @param  Sensitivity pointer where the sensitivity [ug/LSB] is written
+ * @retval 0 in case of success, an error code otherwise
+ */
+static int32_t LSM6DSO_ACC_GetSensitivityFp(LSM6DSO_Object_t *pObj, uint32_t *Sensitivity)
+{
+  int32_t ret = LSM6DSO_OK;
+  lsm6dso_fs_xl_t full_scale;
+
+  if (pObj->acc_sensitivity != 0U)
+  {
+    *Sensitivity = pObj->acc_sensitivity;
+    return LSM6DSO_OK;
+  }
+
+  /* Read actual full scale selection from sensor. */
+  if (lsm6dso_xl_full_scale_get(&(pObj->Ctx), &full_scale) != LSM6DSO_OK)
+  {
+    return LSM6DSO_ERROR;
+  }
+
+  /* Store the Sensitivity based on actual full scale. */
+  switch (full_scale)
+  {
+    case LSM6DSO_2g:
+      pObj->acc_sensitivity = LSM6DSO_ACC_SENSITIVITY_FP_FS_2G;
+      break;
+
+    case LSM6DSO_4g:
+      pObj->acc_sensitivity = LSM6DSO_ACC_SENSITIVITY_FP_FS_4G;
+      break;
+
+    case LSM6DSO_8g:
+      pObj->acc_sensitivity = LSM6DSO_ACC_SENSITIVITY_FP_FS_8G;
+      break;
+
+    case LSM6DSO_16g:
+      pObj->acc_sensitivity = LSM6DSO_ACC_SENSITIVITY_FP_FS_16G;
+      break;
+
+    default:
+      ret = LSM6DSO_ERROR;
+      break;
+  }
+
+  *Sensitivity = pObj->acc_sensitivity;
+
+  return ret;
+}
+
+/**
+ * @brief  Get the LSM6DSO gyroscope fixed-point sensitivity, reading the full scale only if not cached
+ * @param  pObj the device pObj
+ * @param  Sensitivity pointer where the sensitivity [udps/LSB] is written
+ * @retval 0 in case of success, an error code otherwise
+ */
+static int32_t LSM6DSO_GYRO_GetSensitivityFp(LSM6DSO_Object_t *pObj, uint32_t *Sensitivity)
+{
+  int32_t ret = LSM6DSO_OK;
+  lsm6dso_fs_g_t full_scale;
+
+  if (pObj->gyro_sensitivity != 0U)
+  {
+    *Sensitivity = pObj->gyro_sensitivity;
+    return LSM6DSO_OK;
+  }
+
+  /* Read actual full scale selection from sensor. */
+  if (lsm6dso_gy_full_scale_get(&(pObj->Ctx), &full_scale) != LSM6DSO_OK)
+  {
+    return LSM6DSO_ERROR;
+  }
+
+  /* Store the sensitivity based on actual full scale. */
+  switch (full_scale)
+  {
+    case LSM6DSO_125dps:
+      pObj->gyro_sensitivity = LSM6DSO_GYRO_SENSITIVITY_FP_FS_125DPS;
+      break;
+
+    case LSM6DSO_250dps:
+      pObj->gyro_sensitivity = LSM6DSO_GYRO_SENSITIVITY_FP_FS_250DPS;
+      break;
+
+    case LSM6DSO_500dps:
+      pObj->gyro_sensitivity = LSM6DSO_GYRO_SENSITIVITY_FP_FS_500DPS;
+      break;
+
+    case LSM6DSO_1000dps:
+      pObj->gyro_sensitivity = LSM6DSO_GYRO_SENSITIVITY_FP_FS_1000DPS;
+      break;
+
+    case LSM6DSO_2000dps:
+      pObj->gyro_sensitivity = LSM6DSO_GYRO_SENSITIVITY_FP_FS_2000DPS;
+      break;
+
+    default:
+      ret = LSM6DSO_ERROR;
+      break;
+  }
+
+  *Sensitivity = pObj->gyro_sensitivity;
+
+  return ret;
+}
+
+/**
+ * @brief  Convert a raw axis sample with a fixed-point sensitivity
+ * @param  Raw the raw sample [LSB]
+ * @param  Sensitivity the sensitivity scaled by LSM6DSO_SENSITIVITY_SCALE
+ * @retval the converted value [mg] or [mdps], truncated toward zero
+ */
+static int32_t LSM6DSO_ConvertAxis(int16_t Raw, uint32_t Sensitivity)
+{
+  /* 32768 * 70000 overflows int32_t but not uint32_t: scale the magnitude, then restore the sign. */
+  uint32_t magnitude = (Raw < 0) ? (uint32_t)(-(int32_t)Raw) : (uint32_t)Raw;
+  int32_t value = (int32_t)((magnitude * Sensitivity) / (uint32_t)LSM6DSO_SENSITIVITY_SCALE);
+
+  return (Raw < 0) ? -value : value;
+}
+
 /**
  * @brief  Wrap Read register component function to Bus IO function
  * @param  Handle the device handler
@@ -112,6 +112,14 @@ typedef struct
   unsigned int SleepStatus : 1;
 } LSM6DSO_Event_Status_t;
 
+typedef struct
+{
+  uint8_t Events;             /* LSM6DSO_EVENT_* routed to INT1, the other events are disabled */
+  uint8_t FreeFallThreshold;  /* lsm6dso_ff_ths_t, while free fall is enabled */
+  uint8_t DoubleTapThreshold; /* Tap threshold, while double tap is enabled */
+  float   IdleOdr;            /* Accelerometer output data rate [Hz] when no event is enabled */
+} LSM6DSO_Event_Config_t;
+
 typedef struct
 {
   LSM6DSO_IO_t        IO;
@@ -121,6 +129,8 @@ typedef struct
   uint8_t             gyro_is_enabled;
   lsm6dso_odr_xl_t    acc_odr;
   lsm6dso_odr_g_t     gyro_odr;
+  uint32_t            acc_sensitivity;  /* Cached [ug/LSB], 0 if the full scale must be read back */
+  uint32_t            gyro_sensitivity; /* Cached [udps/LSB], 0 if the full scale must be read back */
 } LSM6DSO_Object_t;
 
 typedef struct
@@ -197,6 +207,32 @@ typedef struct
 #define LSM6DSO_GYRO_SENSITIVITY_FS_1000DPS  35.000f
 #define LSM6DSO_GYRO_SENSITIVITY_FS_2000DPS  70.000f
 
+/* Fixed-point sensitivities used by the axes conversion, scaled by LSM6DSO_SENSITIVITY_SCALE */
+#define LSM6DSO_SENSITIVITY_SCALE             1000
+
+#define LSM6DSO_ACC_SENSITIVITY_FP_FS_2G        61U
+#define LSM6DSO_ACC_SENSITIVITY_FP_FS_4G       122U
+#define LSM6DSO_ACC_SENSITIVITY_FP_FS_8G       244U
+#define LSM6DSO_ACC_SENSITIVITY_FP_FS_16G      488U
+
+#define LSM6DSO_GYRO_SENSITIVITY_FP_FS_125DPS   4375U
+#define LSM6DSO_GYRO_SENSITIVITY_FP_FS_250DPS   8750U
+#define LSM6DSO_GYRO_SENSITIVITY_FP_FS_500DPS  17500U
+#define LSM6DSO_GYRO_SENSITIVITY_FP_FS_1000DPS 35000U
+#define LSM6DSO_GYRO_SENSITIVITY_FP_FS_2000DPS 70000U
+
+/* Gyroscope then accelerometer output registers, OUTX_L_G..OUTZ_H_A */
+#define LSM6DSO_AXES_ALL_SIZE                   12U
+
+/* Hardware events configured by LSM6DSO_ACC_Set_Event_Detection */
+#define LSM6DSO_EVENT_PEDOMETER                0x01U
+#define LSM6DSO_EVENT_FREE_FALL                0x02U
+#define LSM6DSO_EVENT_DOUBLE_TAP               0x04U
+#define LSM6DSO_EVENT_SINGLE_TAP               0x08U
+#define LSM6DSO_EVENT_WAKE_UP                  0x10U
+#define LSM6DSO_EVENT_TILT                     0x20U
+#define LSM6DSO_EVENT_6D_ORIENTATION           0x40U
+
 /**
  * @}
  */
@@ -231,6 +267,12 @@ int32_t LSM6DSO_GYRO_SetFullScale(LSM6DSO_Object_t *pObj, int32_t FullScale);
 int32_t LSM6DSO_GYRO_GetAxesRaw(LSM6DSO_Object_t *pObj, LSM6DSO_AxesRaw_t *Value);
 int32_t LSM6DSO_GYRO_GetAxes(LSM6DSO_Object_t *pObj, LSM6DSO_Axes_t *AngularRate);
 
+int32_t LSM6DSO_GetAxesAll(LSM6DSO_Object_t *pObj, LSM6DSO_Axes_t *Acceleration, LSM6DSO_Axes_t *AngularRate,
+                           float *Temperature);
+int32_t LSM6DSO_GetAxesAllReg(LSM6DSO_Object_t *pObj, uint8_t *Address, uint8_t *Reg);
+int32_t LSM6DSO_ConvertAxesAll(LSM6DSO_Object_t *pObj, const uint8_t *Data, LSM6DSO_Axes_t *Acceleration,
+                               LSM6DSO_Axes_t *AngularRate);
+
 int32_t LSM6DSO_Read_Reg(LSM6DSO_Object_t *pObj, uint8_t reg, uint8_t *Data);
 int32_t LSM6DSO_Write_Reg(LSM6DSO_Object_t *pObj, uint8_t reg, uint8_t Data);
 int32_t LSM6DSO_Set_Interrupt_Latch(LSM6DSO_Object_t *pObj, uint8_t Status);
@@ -272,6 +314,8 @@ int32_t LSM6DSO_ACC_Get_6D_Orientation_YH(LSM6DSO_Object_t *pObj, uint8_t *YHigh
 int32_t LSM6DSO_ACC_Get_6D_Orientation_ZL(LSM6DSO_Object_t *pObj, uint8_t *ZLow);
 int32_t LSM6DSO_ACC_Get_6D_Orientation_ZH(LSM6DSO_Object_t *pObj, uint8_t *ZHigh);
 
+int32_t LSM6DSO_ACC_Set_Event_Detection(LSM6DSO_Object_t *pObj, const LSM6DSO_Event_Config_t *Config);
+
 int32_t LSM6DSO_ACC_Get_DRDY_Status(LSM6DSO_Object_t *pObj, uint8_t *Status);
 int32_t LSM6DSO_ACC_Get_Event_Status(LSM6DSO_Object_t *pObj, LSM6DSO_Event_Status_t *Status);
 int32_t LSM6DSO_ACC_Set_SelfTest(LSM6DSO_Object_t *pObj, uint8_t Status);
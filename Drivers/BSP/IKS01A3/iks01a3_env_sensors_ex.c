@@ -583,6 +583,53 @@ int32_t IKS01A3_ENV_SENSOR_FIFO_Get_Data(uint32_t Instance, float *Press, float
   return ret;
 }
 
+/**
+ * @brief  Get several samples stored in FIFO in as few bus transactions as possible (available only for LPS22HH sensor)
+ * @param  Instance the device instance
+ * @param  Press array where the Nbr pressure values are written
+ * @param  Temp array where the Nbr temperature values are written
+ * @param  Nbr number of samples to be read, at most the FIFO level
+ * @retval BSP status
+ */
+int32_t IKS01A3_ENV_SENSOR_FIFO_Get_Data_Burst(uint32_t Instance, float *Press, float *Temp, uint8_t Nbr)
+{
+  int32_t ret;
+
+  switch (Instance)
+  {
+#if (USE_IKS01A3_ENV_SENSOR_HTS221_0 == 1)
+    case IKS01A3_HTS221_0:
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+      break;
+#endif
+
+#if (USE_IKS01A3_ENV_SENSOR_LPS22HH_0 == 1)
+    case IKS01A3_LPS22HH_0:
+      if (LPS22HH_FIFO_Get_Data_Burst(EnvCompObj[Instance], Press, Temp, Nbr) != BSP_ERROR_NONE)
+      {
+        ret = BSP_ERROR_COMPONENT_FAILURE;
+      }
+      else
+      {
+        ret = BSP_ERROR_NONE;
+      }
+      break;
+#endif
+
+#if (USE_IKS01A3_ENV_SENSOR_STTS751_0 == 1)
+    case IKS01A3_STTS751_0:
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+      break;
+#endif
+
+    default:
+      ret = BSP_ERROR_WRONG_PARAM;
+      break;
+  }
+
+  return ret;
+}
+
 /**
  * @brief  Get FIFO THR status (available only for LPS22HH, LPS33HW sensor)
  * @param  Instance the device instance
@@ -1105,6 +1152,53 @@ int32_t IKS01A3_ENV_SENSOR_Get_One_Shot_Status(uint32_t Instance, uint8_t *Statu
   return ret;
 }
 
+/**
+ * @brief  Get environmental sensor one shot status and values in a single bus transaction (available only for HTS221 sensor)
+ * @param  Instance environmental sensor instance to be used
+ * @param  Status pointer to the one shot status (1 means measurements available, 0 means measurements not available yet)
+ * @param  Humidity pointer where the humidity value is written, when available
+ * @param  Temperature pointer where the temperature value is written, when available
+ * @retval BSP status
+ */
+int32_t IKS01A3_ENV_SENSOR_Get_One_Shot_Data(uint32_t Instance, uint8_t *Status, float *Humidity, float *Temperature)
+{
+  int32_t ret;
+
+  switch (Instance)
+  {
+#if (USE_IKS01A3_ENV_SENSOR_HTS221_0 == 1)
+    case IKS01A3_HTS221_0:
+      if (HTS221_Get_One_Shot_Data(EnvCompObj[Instance], Status, Humidity, Temperature) != BSP_ERROR_NONE)
+      {
+        ret = BSP_ERROR_COMPONENT_FAILURE;
+      }
+      else
+      {
+        ret = BSP_ERROR_NONE;
+      }
+      break;
+#endif
+
+#if (USE_IKS01A3_ENV_SENSOR_LPS22HH_0 == 1)
+    case IKS01A3_LPS22HH_0:
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+      break;
+#endif
+
+#if (USE_IKS01A3_ENV_SENSOR_STTS751_0 == 1)
+    case IKS01A3_STTS751_0:
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+      break;
+#endif
+
+    default:
+      ret = BSP_ERROR_WRONG_PARAM;
+      break;
+  }
+
+  return ret;
+}
+
 /**
  * @}
  */
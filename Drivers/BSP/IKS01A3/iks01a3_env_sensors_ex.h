@@ -78,6 +78,7 @@ int32_t IKS01A3_ENV_SENSOR_Set_Low_Temperature_Threshold(uint32_t Instance, floa
 int32_t IKS01A3_ENV_SENSOR_Get_Temperature_Limit_Status(uint32_t Instance, uint8_t *HighLimit, uint8_t *LowLimit, uint8_t *ThermLimit);
 int32_t IKS01A3_ENV_SENSOR_Set_Event_Pin(uint32_t Instance, uint8_t Enable);
 int32_t IKS01A3_ENV_SENSOR_FIFO_Get_Data(uint32_t Instance, float *Press, float *Temp);
+int32_t IKS01A3_ENV_SENSOR_FIFO_Get_Data_Burst(uint32_t Instance, float *Press, float *Temp, uint8_t Nbr);
 int32_t IKS01A3_ENV_SENSOR_FIFO_Get_Fth_Status(uint32_t Instance, uint8_t *Status);
 int32_t IKS01A3_ENV_SENSOR_FIFO_Get_Full_Status(uint32_t Instance, uint8_t *Status);
 int32_t IKS01A3_ENV_SENSOR_FIFO_Get_Num_Samples(uint32_t Instance, uint8_t *NumSamples);
@@ -89,6 +90,7 @@ int32_t IKS01A3_ENV_SENSOR_FIFO_Set_Watermark_Level(uint32_t Instance, uint8_t W
 int32_t IKS01A3_ENV_SENSOR_FIFO_Stop_On_Watermark(uint32_t Instance, uint8_t Stop);
 int32_t IKS01A3_ENV_SENSOR_Set_One_Shot(uint32_t Instance);
 int32_t IKS01A3_ENV_SENSOR_Get_One_Shot_Status(uint32_t Instance, uint8_t *Status);
+int32_t IKS01A3_ENV_SENSOR_Get_One_Shot_Data(uint32_t Instance, uint8_t *Status, float *Humidity, float *Temperature);
 
 /**
  * @}
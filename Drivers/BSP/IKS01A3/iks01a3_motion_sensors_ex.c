@@ -2364,6 +2364,59 @@ int32_t IKS01A3_MOTION_SENSOR_Get_6D_Orientation_ZH(uint32_t Instance, uint8_t *
   return ret;
 }
 
+/**
+ * @brief  Set the whole hardware event configuration in a few bus transactions (available only for LSM6DSO sensor)
+ * @param  Instance the device instance
+ * @param  Config the events to be enabled on INT1 pin and their thresholds
+ * @retval BSP status
+ */
+int32_t IKS01A3_MOTION_SENSOR_Set_Event_Detection(uint32_t Instance, const IKS01A3_MOTION_SENSOR_Event_Config_t *Config)
+{
+  int32_t ret;
+#if (USE_IKS01A3_MOTION_SENSOR_LSM6DSO_0 == 1)
+  LSM6DSO_Event_Config_t lsm6dso_config;
+#endif
+
+  switch (Instance)
+  {
+#if (USE_IKS01A3_MOTION_SENSOR_LSM6DSO_0 == 1)
+    case IKS01A3_LSM6DSO_0:
+      lsm6dso_config.Events             = Config->Events;
+      lsm6dso_config.FreeFallThreshold  = Config->FreeFallThreshold;
+      lsm6dso_config.DoubleTapThreshold = Config->DoubleTapThreshold;
+      lsm6dso_config.IdleOdr            = Config->IdleOdr;
+
+      if (LSM6DSO_ACC_Set_Event_Detection(MotionCompObj[Instance], &lsm6dso_config) != BSP_ERROR_NONE)
+      {
+        ret = BSP_ERROR_COMPONENT_FAILURE;
+      }
+      else
+      {
+        ret = BSP_ERROR_NONE;
+      }
+      break;
+#endif
+
+#if (USE_IKS01A3_MOTION_SENSOR_LIS2DW12_0 == 1)
+    case IKS01A3_LIS2DW12_0:
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+      break;
+#endif
+
+#if (USE_IKS01A3_MOTION_SENSOR_LIS2MDL_0 == 1)
+    case IKS01A3_LIS2MDL_0:
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+      break;
+#endif
+
+    default:
+      ret = BSP_ERROR_WRONG_PARAM;
+      break;
+  }
+
+  return ret;
+}
+
 /**
  * @brief  Get number of unread FIFO samples (available only for LSM6DSO and LIS2DW12 sensors)
  * @param  Instance the device instance
@@ -2823,6 +2876,182 @@ int32_t IKS01A3_MOTION_SENSOR_FIFO_Get_Axes(uint32_t Instance, uint32_t Function
   return ret;
 }
 
+/**
+ * @brief  Get accelerometer and gyroscope axes in a single bus transaction (available only for LSM6DSO sensor)
+ * @param  Instance the device instance
+ * @param  Acceleration pointer where the accelerometer axes are written [mg]
+ * @param  AngularRate pointer where the gyroscope axes are written [mdps]
+ * @retval BSP status
+ */
+int32_t IKS01A3_MOTION_SENSOR_Get_AccGyro_Axes(uint32_t Instance, IKS01A3_MOTION_SENSOR_Axes_t *Acceleration, IKS01A3_MOTION_SENSOR_Axes_t *AngularRate)
+{
+  int32_t ret;
+
+  switch (Instance)
+  {
+#if (USE_IKS01A3_MOTION_SENSOR_LSM6DSO_0 == 1)
+    case IKS01A3_LSM6DSO_0:
+      if (LSM6DSO_GetAxesAll(MotionCompObj[Instance], (LSM6DSO_Axes_t *)Acceleration, (LSM6DSO_Axes_t *)AngularRate, NULL) != BSP_ERROR_NONE)
+      {
+        ret = BSP_ERROR_COMPONENT_FAILURE;
+      }
+      else
+      {
+        ret = BSP_ERROR_NONE;
+      }
+      break;
+#endif
+
+#if (USE_IKS01A3_MOTION_SENSOR_LIS2DW12_0 == 1)
+    case IKS01A3_LIS2DW12_0:
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+      break;
+#endif
+
+#if (USE_IKS01A3_MOTION_SENSOR_LIS2MDL_0 == 1)
+    case IKS01A3_LIS2MDL_0:
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+      break;
+#endif
+
+    default:
+      ret = BSP_ERROR_WRONG_PARAM;
+      break;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Get where the output registers of a sensor are, for a burst read issued
+ *         outside of the driver (e.g. by DMA). The data read is decoded with
+ *         IKS01A3_MOTION_SENSOR_Convert_AccGyro_Axes() or IKS01A3_MOTION_SENSOR_Convert_Mag_Axes()
+ *         (available only for LSM6DSO and LIS2MDL sensors on the I2C bus)
+ * @param  Instance the device instance
+ * @param  Address pointer where the I2C device address is written
+ * @param  Reg pointer where the first register of the burst is written
+ * @param  Length pointer where the length of the burst is written
+ * @retval BSP status
+ */
+int32_t IKS01A3_MOTION_SENSOR_Get_Axes_Reg(uint32_t Instance, uint8_t *Address, uint8_t *Reg, uint16_t *Length)
+{
+  int32_t ret;
+
+  switch (Instance)
+  {
+#if (USE_IKS01A3_MOTION_SENSOR_LSM6DSO_0 == 1)
+    case IKS01A3_LSM6DSO_0:
+      if (LSM6DSO_GetAxesAllReg(MotionCompObj[Instance], Address, Reg) != BSP_ERROR_NONE)
+      {
+        ret = BSP_ERROR_COMPONENT_FAILURE;
+      }
+      else
+      {
+        *Length = LSM6DSO_AXES_ALL_SIZE;
+        ret = BSP_ERROR_NONE;
+      }
+      break;
+#endif
+
+#if (USE_IKS01A3_MOTION_SENSOR_LIS2DW12_0 == 1)
+    case IKS01A3_LIS2DW12_0:
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+      break;
+#endif
+
+#if (USE_IKS01A3_MOTION_SENSOR_LIS2MDL_0 == 1)
+    case IKS01A3_LIS2MDL_0:
+      if (LIS2MDL_MAG_GetAxesReg(MotionCompObj[Instance], Address, Reg) != BSP_ERROR_NONE)
+      {
+        ret = BSP_ERROR_COMPONENT_FAILURE;
+      }
+      else
+      {
+        *Length = LIS2MDL_AXES_SIZE;
+        ret = BSP_ERROR_NONE;
+      }
+      break;
+#endif
+
+    default:
+      ret = BSP_ERROR_WRONG_PARAM;
+      break;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Convert accelerometer and gyroscope axes read from IKS01A3_MOTION_SENSOR_Get_Axes_Reg()
+ *         (available only for LSM6DSO sensor)
+ * @param  Instance the device instance
+ * @param  Data the output registers read
+ * @param  Acceleration pointer where the accelerometer axes are written [mg]
+ * @param  AngularRate pointer where the gyroscope axes are written [mdps]
+ * @retval BSP status
+ */
+int32_t IKS01A3_MOTION_SENSOR_Convert_AccGyro_Axes(uint32_t Instance, const uint8_t *Data, IKS01A3_MOTION_SENSOR_Axes_t *Acceleration, IKS01A3_MOTION_SENSOR_Axes_t *AngularRate)
+{
+  int32_t ret;
+
+  switch (Instance)
+  {
+#if (USE_IKS01A3_MOTION_SENSOR_LSM6DSO_0 == 1)
+    case IKS01A3_LSM6DSO_0:
+      if (LSM6DSO_ConvertAxesAll(MotionCompObj[Instance], Data, (LSM6DSO_Axes_t *)Acceleration, (LSM6DSO_Axes_t *)AngularRate) != BSP_ERROR_NONE)
+      {
+        ret = BSP_ERROR_COMPONENT_FAILURE;
+      }
+      else
+      {
+        ret = BSP_ERROR_NONE;
+      }
+      break;
+#endif
+
+    default:
+      ret = BSP_ERROR_WRONG_PARAM;
+      break;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Convert magnetometer axes read from IKS01A3_MOTION_SENSOR_Get_Axes_Reg()
+ *         (available only for LIS2MDL sensor)
+ * @param  Instance the device instance
+ * @param  Data the output registers read
+ * @param  MagneticField pointer where the magnetometer axes are written [mgauss]
+ * @retval BSP status
+ */
+int32_t IKS01A3_MOTION_SENSOR_Convert_Mag_Axes(uint32_t Instance, const uint8_t *Data, IKS01A3_MOTION_SENSOR_Axes_t *MagneticField)
+{
+  int32_t ret;
+
+  switch (Instance)
+  {
+#if (USE_IKS01A3_MOTION_SENSOR_LIS2MDL_0 == 1)
+    case IKS01A3_LIS2MDL_0:
+      if (LIS2MDL_MAG_ConvertAxes(MotionCompObj[Instance], Data, (LIS2MDL_Axes_t *)MagneticField) != BSP_ERROR_NONE)
+      {
+        ret = BSP_ERROR_COMPONENT_FAILURE;
+      }
+      else
+      {
+        ret = BSP_ERROR_NONE;
+      }
+      break;
+#endif
+
+    default:
+      ret = BSP_ERROR_WRONG_PARAM;
+      break;
+  }
+
+  return ret;
+}
+
 /**
  * @brief  Set device self-test (available only for LSM6DSO, LIS2DW12 and LIS2MDL sensors)
  * @param  Instance the device instance
@@ -88,6 +88,14 @@ typedef struct
   unsigned int SleepStatus : 1;
 } IKS01A3_MOTION_SENSOR_Event_Status_t;
 
+typedef struct
+{
+  uint8_t Events;             /* Events routed to INT1 pin, the other events are disabled */
+  uint8_t FreeFallThreshold;  /* Free fall threshold, while free fall is enabled */
+  uint8_t DoubleTapThreshold; /* Tap threshold, while double tap is enabled */
+  float   IdleOdr;            /* Accelerometer output data rate [Hz] when no event is enabled */
+} IKS01A3_MOTION_SENSOR_Event_Config_t;
+
 /**
  * @}
  */
@@ -134,6 +142,7 @@ int32_t IKS01A3_MOTION_SENSOR_Get_6D_Orientation_YL(uint32_t Instance, uint8_t *
 int32_t IKS01A3_MOTION_SENSOR_Get_6D_Orientation_YH(uint32_t Instance, uint8_t *yh);
 int32_t IKS01A3_MOTION_SENSOR_Get_6D_Orientation_ZL(uint32_t Instance, uint8_t *zl);
 int32_t IKS01A3_MOTION_SENSOR_Get_6D_Orientation_ZH(uint32_t Instance, uint8_t *zh);
+int32_t IKS01A3_MOTION_SENSOR_Set_Event_Detection(uint32_t Instance, const IKS01A3_MOTION_SENSOR_Event_Config_t *Config);
 int32_t IKS01A3_MOTION_SENSOR_FIFO_Get_Num_Samples(uint32_t Instance, uint16_t *NumSamples);
 int32_t IKS01A3_MOTION_SENSOR_FIFO_Get_Full_Status(uint32_t Instance, uint8_t *Status);
 int32_t IKS01A3_MOTION_SENSOR_FIFO_Set_BDR(uint32_t Instance, uint32_t Function, float Bdr);
@@ -143,6 +152,10 @@ int32_t IKS01A3_MOTION_SENSOR_FIFO_Set_Stop_On_Fth(uint32_t Instance, uint8_t St
 int32_t IKS01A3_MOTION_SENSOR_FIFO_Set_Mode(uint32_t Instance, uint8_t Mode);
 int32_t IKS01A3_MOTION_SENSOR_FIFO_Get_Tag(uint32_t Instance, uint8_t *Tag);
 int32_t IKS01A3_MOTION_SENSOR_FIFO_Get_Axes(uint32_t Instance, uint32_t Function, IKS01A3_MOTION_SENSOR_Axes_t *Data);
+int32_t IKS01A3_MOTION_SENSOR_Get_AccGyro_Axes(uint32_t Instance, IKS01A3_MOTION_SENSOR_Axes_t *Acceleration, IKS01A3_MOTION_SENSOR_Axes_t *AngularRate);
+int32_t IKS01A3_MOTION_SENSOR_Get_Axes_Reg(uint32_t Instance, uint8_t *Address, uint8_t *Reg, uint16_t *Length);
+int32_t IKS01A3_MOTION_SENSOR_Convert_AccGyro_Axes(uint32_t Instance, const uint8_t *Data, IKS01A3_MOTION_SENSOR_Axes_t *Acceleration, IKS01A3_MOTION_SENSOR_Axes_t *AngularRate);
+int32_t IKS01A3_MOTION_SENSOR_Convert_Mag_Axes(uint32_t Instance, const uint8_t *Data, IKS01A3_MOTION_SENSOR_Axes_t *MagneticField);
 int32_t IKS01A3_MOTION_SENSOR_Set_SelfTest(uint32_t Instance, uint32_t Function, uint8_t Mode);
 int32_t IKS01A3_MOTION_SENSOR_DRDY_Set_Mode(uint32_t Instance, uint8_t Mode);
 int32_t IKS01A3_MOTION_SENSOR_DRDY_Enable_Interrupt(uint32_t Instance, uint32_t Function, IKS01A3_MOTION_SENSOR_IntPin_t IntPin);
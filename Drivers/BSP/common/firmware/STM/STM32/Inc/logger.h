@@ -81,6 +81,48 @@ extern void logUsartInit(UART_HandleTypeDef *husart);
  */
 extern int logUsart(const char* format, ...);
 
+/*!
+ *****************************************************************************
+ *  \brief  Queues data to be written out via UART interface
+ *
+ *  The data is copied in the log ring and sent by DMA, the call does not
+ *  wait for the transfer.
+ *
+ *****************************************************************************
+ */
+extern uint8_t logUsartTx(uint8_t *data, uint16_t dataLen);
+
+/*!
+ *****************************************************************************
+ *  \brief  UART Tx complete notification
+ *
+ *  This function starts the next DMA transfer from the log ring. It is to
+ *  be called from HAL_UART_TxCpltCallback().
+ *
+ *****************************************************************************
+ */
+extern void logUsartTxCpltCallback(UART_HandleTypeDef *huart);
+
+/*!
+ *****************************************************************************
+ *  \brief  Number of log records lost: log ring full, record longer than a
+ *          DMA transfer, or DMA transfer that could not be started
+ *
+ *****************************************************************************
+ */
+extern uint32_t logUsartDropped(void);
+
+/*!
+ *****************************************************************************
+ *  \brief  Tells whether the log ring is drained
+ *
+ *  The USART1 DMA does not run in Stop mode: the low power manager keeps
+ *  the device in Sleep mode while this returns false.
+ *
+ *****************************************************************************
+ */
+extern bool logUsartIsIdle(void);
+
 /*!
  *****************************************************************************
  *  \brief  Writes out a formated string via ITM interface
@@ -44,6 +44,8 @@ typedef enum
   HW_ACC_EVENT_NOTIFY_ENABLED_EVT,
   HW_ACC_EVENT_NOTIFY_DISABLED_EVT,
   HW_ACC_EVENT_READ_EVT,
+  HW_MOTION_BATCH_NOTIFY_ENABLED_EVT,
+  HW_MOTION_BATCH_NOTIFY_DISABLED_EVT,
   /* SW Service Chars related events */
   SW_MOTIONFX_NOTIFY_ENABLED_EVT,
   SW_MOTIONFX_NOTIFY_DISABLED_EVT,
@@ -73,7 +75,11 @@ typedef enum
   CONSOLE_STDERR_NOTIFY_ENABLED_EVT,
   CONSOLE_STDERR_NOTIFY_DISABLED_EVT,
   CONSOLE_TERM_READ_EVT,
-  CONSOLE_STDERR_READ_EVT
+  CONSOLE_STDERR_READ_EVT,
+  /* ATT MTU negotiated with the GATT Client (DataTransfered: LE16 MTU) */
+  ATT_MTU_EXCHANGED_EVT,
+  /* The stack accepts notifications again */
+  TX_POOL_AVAILABLE_EVT
 } MOTENV_STM_Opcode_evt_t;
 
 /**
@@ -96,6 +102,32 @@ typedef struct
   uint8_t                 ServiceInstance;
 } MOTENV_STM_App_Notification_evt_t;
 
+/**
+ * @brief  MOTENV Characteristics, in the order they are added
+ */
+typedef enum
+{
+  /* HW Service Chars */
+  MOTENV_STM_MOTION_CHAR,
+  MOTENV_STM_ENV_CHAR,
+  MOTENV_STM_ACC_EVENT_CHAR,
+  MOTENV_STM_MOTION_BATCH_CHAR,
+  /* SW Service Chars */
+  MOTENV_STM_MOTION_FX_CHAR,
+  MOTENV_STM_ECOMPASS_CHAR,
+  MOTENV_STM_ACTIVITY_REC_CHAR,
+  MOTENV_STM_CARRY_POSITION_CHAR,
+  MOTENV_STM_GESTURE_REC_CHAR,
+  MOTENV_STM_PEDOMETER_CHAR,
+  MOTENV_STM_INTENSITY_DET_CHAR,
+  /* Config Service Chars */
+  MOTENV_STM_CONFIG_CHAR,
+  /* Console Service Chars */
+  MOTENV_STM_CONSOLE_TERM_CHAR,
+  MOTENV_STM_CONSOLE_STDERR_CHAR,
+  MOTENV_STM_CHAR_NUMBER
+} MOTENV_STM_Char_t;
+
 
 /* Exported constants --------------------------------------------------------*/
 /* External variables --------------------------------------------------------*/
@@ -104,6 +136,10 @@ typedef struct
  * @brief  Motion (Acc-Gyro-Magneto) Char shortened UUID
  */
 #define MOTION_CHAR_UUID                (0xE000)
+/**
+ * @brief  Batched Motion (Acc-Gyro-Magneto) Char shortened UUID
+ */
+#define MOTION_BATCH_CHAR_UUID          (0xE001)
 /**
  * @brief  Environmental (Temp-Humidity-Pressure) Char shortened UUID
  */
@@ -156,7 +192,7 @@ typedef struct
 /* Exported functions ------------------------------------------------------- */
 void MOTENV_STM_Init(void);
 void MOTENV_STM_App_Notification(MOTENV_STM_App_Notification_evt_t *pNotification);
-tBleStatus MOTENV_STM_App_Update_Char(uint16_t UUID, uint8_t payloadLen, uint8_t *pPayload);
+tBleStatus MOTENV_STM_App_Update_Char(MOTENV_STM_Char_t Char, uint8_t payloadLen, uint8_t *pPayload);
 
 
 #ifdef __cplusplus
@@ -22,38 +22,47 @@
 #include "common_blesvc.h"
 
 /* Private typedef -----------------------------------------------------------*/
+/**
+ * @brief  MOTENV Services
+ */
+typedef enum
+{
+  MOTENV_HW_SVC,
+  MOTENV_SW_SVC,
+  MOTENV_CONFIG_SVC,
+  MOTENV_CONSOLE_SVC,
+  MOTENV_SVC_NUMBER
+} MotenvSvc_t;
+
+/**
+ * @brief  Static description of one Char: service and events sent to the application
+ */
+typedef struct
+{
+  uint16_t Uuid;              /**< Shortened UUID, for the debug trace */
+  uint8_t  Svc;               /**< MotenvSvc_t */
+  uint8_t  NotifyEnabledEvt;  /**< MOTENV_STM_Opcode_evt_t */
+  uint8_t  NotifyDisabledEvt; /**< MOTENV_STM_Opcode_evt_t */
+  uint8_t  ReadEvt;           /**< MOTENV_STM_Opcode_evt_t or MOTENV_NO_EVT */
+  uint8_t  WriteEvt;          /**< MOTENV_STM_Opcode_evt_t or MOTENV_NO_EVT */
+} MotenvChar_t;
+
 /**
  * @brief  MOTENV Context structure definition
  */
 typedef struct
 {
-  /* Handles for HW Service and Chars */
-  uint16_t	HWSvcHdle;          /**< Service handle */
-  uint16_t	HWMotionCharHdle;   /**< Characteristic handle */
-  uint16_t	HWEnvCharHdle;      /**< Characteristic handle */
-  uint16_t	HWAccEventCharHdle; /**< Characteristic handle */
-
-  /* Handles for SW Service and Chars */
-  uint16_t	SWSvcHdle;               /**< Service handle */
-  uint16_t	SWQuaternionsCharHdle;   /**< Characteristic handle */
-  uint16_t	SWECompassCharHdle;      /**< Characteristic handle */
-  uint16_t	SWActivityRecCharHdle;   /**< Characteristic handle */
-  uint16_t	SWCarryPositionCharHdle; /**< Characteristic handle */
-  uint16_t	SWGestureRecCharHdle;    /**< Characteristic handle */
-  uint16_t	SWPedometerCharHdle;     /**< Characteristic handle */
-  uint16_t	SWIntensityDetCharHdle;  /**< Characteristic handle */
-
-  /* Handles for Config Service and Chars */
-  uint16_t	ConfigSvcHdle;  /**< Service handle */
-  uint16_t	ConfigCharHdle; /**< Characteristic handle */
-
-  /* Handles for Console Service and Chars */
-  uint16_t	ConsoleSvcHdle;        /**< Service handle */
-  uint16_t	ConsoleTermCharHdle;   /**< Characteristic handle */
-  uint16_t	ConsoleStderrCharHdle; /**< Characteristic handle */
+  uint16_t	SvcHdle[MOTENV_SVC_NUMBER];         /**< Service handles */
+  uint16_t	CharHdle[MOTENV_STM_CHAR_NUMBER];   /**< Characteristic handles */
+  /* Char of each attribute handle from SvcHdle[MOTENV_HW_SVC]: one service
+   * declaration per service, declaration, value and CCCD per char */
+  uint8_t	AttrChar[MOTENV_SVC_NUMBER + (3 * MOTENV_STM_CHAR_NUMBER)];
 } MotenvContext_t;
 
 /* Private defines -----------------------------------------------------------*/
+#define MOTENV_NO_EVT    (0xFFU)  /* No application event for the attribute */
+#define MOTENV_ATTR_NONE (0xFFU)  /* AttrChar[]: service or char declaration */
+#define MOTENV_ATTR_CCCD (0x80U)  /* AttrChar[]: flag of the CCCD of the char */
 
 /* Private macros ------------------------------------------------------------*/
 
@@ -61,8 +70,45 @@ typedef struct
 
 PLACE_IN_SECTION("BLE_DRIVER_CONTEXT") static MotenvContext_t aMotenvContext;
 
+/**
+ * Indexed by MOTENV_STM_Char_t
+ */
+static const MotenvChar_t aMotenvChar[MOTENV_STM_CHAR_NUMBER] =
+{
+  { MOTION_CHAR_UUID, MOTENV_HW_SVC,
+    HW_MOTION_NOTIFY_ENABLED_EVT, HW_MOTION_NOTIFY_DISABLED_EVT, MOTENV_NO_EVT, MOTENV_NO_EVT },
+  { ENV_CHAR_UUID, MOTENV_HW_SVC,
+    HW_ENV_NOTIFY_ENABLED_EVT, HW_ENV_NOTIFY_DISABLED_EVT, HW_ENV_READ_EVT, MOTENV_NO_EVT },
+  { ACC_EVENT_CHAR_UUID, MOTENV_HW_SVC,
+    HW_ACC_EVENT_NOTIFY_ENABLED_EVT, HW_ACC_EVENT_NOTIFY_DISABLED_EVT, HW_ACC_EVENT_READ_EVT, MOTENV_NO_EVT },
+  { MOTION_BATCH_CHAR_UUID, MOTENV_HW_SVC,
+    HW_MOTION_BATCH_NOTIFY_ENABLED_EVT, HW_MOTION_BATCH_NOTIFY_DISABLED_EVT, MOTENV_NO_EVT, MOTENV_NO_EVT },
+  { MOTION_FX_CHAR_UUID, MOTENV_SW_SVC,
+    SW_MOTIONFX_NOTIFY_ENABLED_EVT, SW_MOTIONFX_NOTIFY_DISABLED_EVT, MOTENV_NO_EVT, MOTENV_NO_EVT },
+  { ECOMPASS_CHAR_UUID, MOTENV_SW_SVC,
+    SW_ECOMPASS_NOTIFY_ENABLED_EVT, SW_ECOMPASS_NOTIFY_DISABLED_EVT, MOTENV_NO_EVT, MOTENV_NO_EVT },
+  { ACTIVITY_REC_CHAR_UUID, MOTENV_SW_SVC,
+    SW_ACTIVITY_REC_NOTIFY_ENABLED_EVT, SW_ACTIVITY_REC_NOTIFY_DISABLED_EVT, SW_ACTIVITY_REC_READ_EVT, MOTENV_NO_EVT },
+  { CARRY_POSITION_CHAR_UUID, MOTENV_SW_SVC,
+    SW_CARRY_POSITION_NOTIFY_ENABLED_EVT, SW_CARRY_POSITION_NOTIFY_DISABLED_EVT, SW_CARRY_POSITION_READ_EVT, MOTENV_NO_EVT },
+  { GESTURE_REC_CHAR_UUID, MOTENV_SW_SVC,
+    SW_GESTURE_REC_NOTIFY_ENABLED_EVT, SW_GESTURE_REC_NOTIFY_DISABLED_EVT, SW_GESTURE_REC_READ_EVT, MOTENV_NO_EVT },
+  { PEDOMETER_CHAR_UUID, MOTENV_SW_SVC,
+    SW_PEDOMETER_NOTIFY_ENABLED_EVT, SW_PEDOMETER_NOTIFY_DISABLED_EVT, SW_PEDOMETER_READ_EVT, MOTENV_NO_EVT },
+  { INTENSITY_DET_CHAR_UUID, MOTENV_SW_SVC,
+    SW_INTENSITY_DET_NOTIFY_ENABLED_EVT, SW_INTENSITY_DET_NOTIFY_DISABLED_EVT, MOTENV_NO_EVT, MOTENV_NO_EVT },
+  { CONFIG_CHAR_UUID, MOTENV_CONFIG_SVC,
+    CONFIG_NOTIFY_ENABLED_EVT, CONFIG_NOTIFY_DISABLED_EVT, MOTENV_NO_EVT, CONFIG_WRITE_EVT },
+  { CONSOLE_TERM_CHAR_UUID, MOTENV_CONSOLE_SVC,
+    CONSOLE_TERM_NOTIFY_ENABLED_EVT, CONSOLE_TERM_NOTIFY_DISABLED_EVT, CONSOLE_TERM_READ_EVT, MOTENV_NO_EVT },
+  { CONSOLE_STDERR_CHAR_UUID, MOTENV_CONSOLE_SVC,
+    CONSOLE_STDERR_NOTIFY_ENABLED_EVT, CONSOLE_STDERR_NOTIFY_DISABLED_EVT, CONSOLE_STDERR_READ_EVT, MOTENV_NO_EVT }
+};
+
 /* Private function prototypes -----------------------------------------------*/
 static SVCCTL_EvtAckStatus_t Motenv_Event_Handler(void *pckt);
+static uint8_t Motenv_Attr_Char(uint16_t AttrHandle);
+static void Motenv_Register_Attr(void);
 
 
 /* Functions Definition ------------------------------------------------------*/
@@ -81,8 +127,9 @@ do {\
 #define COPY_HW_MOTION_CHAR_UUID(uuid_struct)     COPY_UUID_128(uuid_struct,0x00,0xE0,0x00,0x00,0x00,0x01,0x11,0xE1,0xAC,0x36,0x00,0x02,0xA5,0xD5,0xC5,0x1B)
 #define COPY_HW_ENV_CHAR_UUID(uuid_struct)        COPY_UUID_128(uuid_struct,0x00,0x1D,0x00,0x00,0x00,0x01,0x11,0xE1,0xAC,0x36,0x00,0x02,0xA5,0xD5,0xC5,0x1B)
 #define COPY_HW_ACC_EVENT_CHAR_UUID(uuid_struct)  COPY_UUID_128(uuid_struct,0x00,0x00,0x04,0x00,0x00,0x01,0x11,0xE1,0xAC,0x36,0x00,0x02,0xA5,0xD5,0xC5,0x1B)
+#define COPY_HW_MOTION_BATCH_CHAR_UUID(uuid_struct) COPY_UUID_128(uuid_struct,0x00,0xE0,0x01,0x00,0x00,0x01,0x11,0xE1,0xAC,0x36,0x00,0x02,0xA5,0xD5,0xC5,0x1B)
 
-#define HW_CHAR_NUMBER (3)
+#define HW_CHAR_NUMBER (4)
 
 /* Software Service and Characteristics */
 #define COPY_SW_SERVICE_UUID(uuid_struct)               COPY_UUID_128(uuid_struct,0x00,0x00,0x00,0x00,0x00,0x02,0x11,0xE1,0x9A,0xB4,0x00,0x02,0xA5,0xD5,0xC5,0x1B)
@@ -117,6 +164,7 @@ do {\
 #define MOTION_CHAR_LEN    (TIMESTAMP_LEN+(3*3*2)) //(ACC+GYRO+MAG)*(X+Y+Z)*2BYTES
 #define ENV_CHAR_LEN       (TIMESTAMP_LEN+(2*2)+2+4) //(2BYTES*2TEMP)+(2BYTES*HUM)+(4BYTES*PRESS)
 #define ACC_EVENT_CHAR_LEN (TIMESTAMP_LEN+3)
+#define MOTION_BATCH_CHAR_LEN (CFG_BLE_MAX_ATT_MTU-3) //Samples packed up to the ATT MTU
 
 /* Software Characteristic Length */
 #define QUATERNION_NUM          (3)
@@ -132,7 +180,7 @@ do {\
 #define CONFIG_CHAR_LEN (TIMESTAMP_LEN+18)
 
 /* Console Characteristic Length */
-#define CONSOLE_CHAR_LEN (TIMESTAMP_LEN+18)
+#define CONSOLE_CHAR_LEN (CFG_BLE_MAX_ATT_MTU-3) //Console output packed up to the ATT MTU
 
 /**
  * @brief  Event handler
@@ -146,7 +194,10 @@ static SVCCTL_EvtAckStatus_t Motenv_Event_Handler(void *Event)
   evt_blue_aci *blue_evt;
   aci_gatt_attribute_modified_event_rp0    * attribute_modified;
   aci_gatt_read_permit_req_event_rp0 *read_permit_req;
+  aci_att_exchange_mtu_resp_event_rp0 *exchange_mtu_resp;
   MOTENV_STM_App_Notification_evt_t Notification;
+  const MotenvChar_t *pChar;
+  uint8_t attr;
 
   return_value = SVCCTL_EvtNotAck;
   event_pckt = (hci_event_pckt *)(((hci_uart_pckt*)Event)->data);
@@ -162,89 +213,20 @@ static SVCCTL_EvtAckStatus_t Motenv_Event_Handler(void *Event)
         case EVT_BLUE_GATT_READ_PERMIT_REQ:
         {
           read_permit_req = (aci_gatt_read_permit_req_event_rp0*)blue_evt->data;
-          /* Env char */
-          if(read_permit_req->Attribute_Handle == (aMotenvContext.HWEnvCharHdle + 1U))
-          {
-            /**
-            * Notify to application
-            */
-            BLE_DBG_TEMPLATE_STM_MSG("-- GATT : READ ENV CHAR INFO RECEIVED\n");
-            Notification.Motenv_Evt_Opcode = HW_ENV_READ_EVT;
-            MOTENV_STM_App_Notification(&Notification);
-          }
-          /* Acc Event char */
-          if(read_permit_req->Attribute_Handle == (aMotenvContext.HWAccEventCharHdle + 1U))
-          {
-            /**
-            * Notify to application
-            */
-            BLE_DBG_TEMPLATE_STM_MSG("-- GATT : READ ACC EVENT CHAR INFO RECEIVED\n");
-            Notification.Motenv_Evt_Opcode = HW_ACC_EVENT_READ_EVT;
-            MOTENV_STM_App_Notification(&Notification);
-          }
-          /* Activity Rec char */
-          else if(read_permit_req->Attribute_Handle == (aMotenvContext.SWActivityRecCharHdle + 1U))
-          {
-            /**
-            * Notify to application
-            */
-            BLE_DBG_TEMPLATE_STM_MSG("-- GATT : READ ACTIVITY REC CHAR INFO RECEIVED\n");
-            Notification.Motenv_Evt_Opcode = SW_ACTIVITY_REC_READ_EVT;
-            MOTENV_STM_App_Notification(&Notification);
-          }
-          /* CarryPosition char */
-          else if(read_permit_req->Attribute_Handle == (aMotenvContext.SWCarryPositionCharHdle + 1U))
-          {
-            /**
-            * Notify to application
-            */
-            BLE_DBG_TEMPLATE_STM_MSG("-- GATT : READ CARRY POSITION CHAR INFO RECEIVED\n");
-            Notification.Motenv_Evt_Opcode = SW_CARRY_POSITION_READ_EVT;
-            MOTENV_STM_App_Notification(&Notification);
-          }
-          /* GestureRec char */
-          else if(read_permit_req->Attribute_Handle == (aMotenvContext.SWGestureRecCharHdle + 1U))
-          {
-            /**
-            * Notify to application
-            */
-            BLE_DBG_TEMPLATE_STM_MSG("-- GATT : READ GESTURE REC CHAR INFO RECEIVED\n");
-            Notification.Motenv_Evt_Opcode = SW_GESTURE_REC_READ_EVT;
-            MOTENV_STM_App_Notification(&Notification);
-          }
-          /* Pedometer char */
-          else if(read_permit_req->Attribute_Handle == (aMotenvContext.SWPedometerCharHdle + 1U))
+          attr = Motenv_Attr_Char(read_permit_req->Attribute_Handle);
+          /* Char value */
+          if(attr < MOTENV_STM_CHAR_NUMBER)
           {
-            /**
-            * Notify to application
-            */
-            BLE_DBG_TEMPLATE_STM_MSG("-- GATT : READ PEDOMETER CHAR INFO RECEIVED\n");
-            Notification.Motenv_Evt_Opcode = SW_PEDOMETER_READ_EVT;
-            MOTENV_STM_App_Notification(&Notification);
-          }
-          else
-          {
-            /* do nothing */
-          }
-          /* Console Term char */
-          if(read_permit_req->Attribute_Handle == (aMotenvContext.ConsoleTermCharHdle + 1U))
-          {
-            /**
-            * Notify to application
-            */
-            BLE_DBG_TEMPLATE_STM_MSG("-- GATT : READ CONSOLE TERM CHAR INFO RECEIVED\n");
-            Notification.Motenv_Evt_Opcode = CONSOLE_TERM_READ_EVT;
-            MOTENV_STM_App_Notification(&Notification);
-          }
-          /* Console Stderr char */
-          if(read_permit_req->Attribute_Handle == (aMotenvContext.ConsoleStderrCharHdle + 1U))
-          {
-            /**
-            * Notify to application
-            */
-            BLE_DBG_TEMPLATE_STM_MSG("-- GATT : READ CONSOLE STDERR CHAR INFO RECEIVED\n");
-            Notification.Motenv_Evt_Opcode = CONSOLE_STDERR_READ_EVT;
-            MOTENV_STM_App_Notification(&Notification);
+            pChar = &aMotenvChar[attr];
+            if(pChar->ReadEvt != MOTENV_NO_EVT)
+            {
+              /**
+              * Notify to application
+              */
+              BLE_DBG_TEMPLATE_STM_MSG("-- GATT : READ CHAR 0x%04X INFO RECEIVED\n", pChar->Uuid);
+              Notification.Motenv_Evt_Opcode = (MOTENV_STM_Opcode_evt_t)pChar->ReadEvt;
+              MOTENV_STM_App_Notification(&Notification);
+            }
           }
           (void)aci_gatt_allow_read(read_permit_req->Connection_Handle);
           break;
@@ -252,309 +234,72 @@ static SVCCTL_EvtAckStatus_t Motenv_Event_Handler(void *Event)
 
         /* Handle Write request or Notification enabling from GATT Client */
         case EVT_BLUE_GATT_ATTRIBUTE_MODIFIED:
-       {
+        {
           attribute_modified = (aci_gatt_attribute_modified_event_rp0*)blue_evt->data;
-          /* Env char */
-          if(attribute_modified->Attr_Handle == (aMotenvContext.HWEnvCharHdle + 2U))
-          {
-            /**
-            * Descriptor handle
-            */
-            return_value = SVCCTL_EvtAckFlowEnable;
-            /**
-            * Notify to application
-            */
-            if(attribute_modified->Attr_Data[0] & COMSVC_Notification)
-            {
-              Notification.Motenv_Evt_Opcode = HW_ENV_NOTIFY_ENABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-            else
-            {
-              Notification.Motenv_Evt_Opcode = HW_ENV_NOTIFY_DISABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-          }
-
-          /* Acc Event char */
-          if(attribute_modified->Attr_Handle == (aMotenvContext.HWAccEventCharHdle + 2U))
-          {
-            /**
-            * Descriptor handle
-            */
-            return_value = SVCCTL_EvtAckFlowEnable;
-            /**
-            * Notify to application
-            */
-            if(attribute_modified->Attr_Data[0] & COMSVC_Notification)
-            {
-              Notification.Motenv_Evt_Opcode = HW_ACC_EVENT_NOTIFY_ENABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-            else
-            {
-              Notification.Motenv_Evt_Opcode = HW_ACC_EVENT_NOTIFY_DISABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-          }
-
-          /* Motion char */
-          else if(attribute_modified->Attr_Handle == (aMotenvContext.HWMotionCharHdle + 2U))
-          {
-            /**
-            * Descriptor handle
-            */
-            return_value = SVCCTL_EvtAckFlowEnable;
-            /**
-            * Notify to application
-            */
-            if(attribute_modified->Attr_Data[0] & COMSVC_Notification)
-            {
-              Notification.Motenv_Evt_Opcode = HW_MOTION_NOTIFY_ENABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-            else
-            {
-              Notification.Motenv_Evt_Opcode = HW_MOTION_NOTIFY_DISABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-          }
-
-          /* MotionFX (Quat) char */
-          else if(attribute_modified->Attr_Handle == (aMotenvContext.SWQuaternionsCharHdle + 2U))
-          {
-            /**
-            * Descriptor handle
-            */
-            return_value = SVCCTL_EvtAckFlowEnable;
-            /**
-            * Notify to application
-            */
-            if(attribute_modified->Attr_Data[0] & COMSVC_Notification)
-            {
-              Notification.Motenv_Evt_Opcode = SW_MOTIONFX_NOTIFY_ENABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-            else
-            {
-              Notification.Motenv_Evt_Opcode = SW_MOTIONFX_NOTIFY_DISABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-          }
-
-          /* MotionFX (ECompass) char */
-          else if(attribute_modified->Attr_Handle == (aMotenvContext.SWECompassCharHdle + 2U))
-          {
-            /**
-            * Descriptor handle
-            */
-            return_value = SVCCTL_EvtAckFlowEnable;
-            /**
-            * Notify to application
-            */
-            if(attribute_modified->Attr_Data[0] & COMSVC_Notification)
-            {
-              Notification.Motenv_Evt_Opcode = SW_ECOMPASS_NOTIFY_ENABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-            else
-            {
-              Notification.Motenv_Evt_Opcode = SW_ECOMPASS_NOTIFY_DISABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-          }
-
-          /* Activity Rec char */
-          else if(attribute_modified->Attr_Handle == (aMotenvContext.SWActivityRecCharHdle + 2U))
-          {
-            /**
-            * Descriptor handle
-            */
-            return_value = SVCCTL_EvtAckFlowEnable;
-            /**
-            * Notify to application
-            */
-            if(attribute_modified->Attr_Data[0] & COMSVC_Notification)
-            {
-              Notification.Motenv_Evt_Opcode = SW_ACTIVITY_REC_NOTIFY_ENABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-            else
-            {
-              Notification.Motenv_Evt_Opcode = SW_ACTIVITY_REC_NOTIFY_DISABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-          }
-
-          /* Carry Position char */
-          else if(attribute_modified->Attr_Handle == (aMotenvContext.SWCarryPositionCharHdle + 2U))
+          attr = Motenv_Attr_Char(attribute_modified->Attr_Handle);
+          if(attr == MOTENV_ATTR_NONE)
           {
-            /**
-            * Descriptor handle
-            */
-            return_value = SVCCTL_EvtAckFlowEnable;
-            /**
-            * Notify to application
-            */
-            if(attribute_modified->Attr_Data[0] & COMSVC_Notification)
-            {
-              Notification.Motenv_Evt_Opcode = SW_CARRY_POSITION_NOTIFY_ENABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-            else
-            {
-              Notification.Motenv_Evt_Opcode = SW_CARRY_POSITION_NOTIFY_DISABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
+            /* Not a MOTENV char */
           }
-
-          /* GestureRec char */
-          else if(attribute_modified->Attr_Handle == (aMotenvContext.SWGestureRecCharHdle + 2U))
+          else if((attr & MOTENV_ATTR_CCCD) != 0U)
           {
             /**
             * Descriptor handle
             */
+            pChar = &aMotenvChar[attr & (uint8_t)~MOTENV_ATTR_CCCD];
             return_value = SVCCTL_EvtAckFlowEnable;
             /**
             * Notify to application
             */
             if(attribute_modified->Attr_Data[0] & COMSVC_Notification)
             {
-              Notification.Motenv_Evt_Opcode = SW_GESTURE_REC_NOTIFY_ENABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
+              Notification.Motenv_Evt_Opcode = (MOTENV_STM_Opcode_evt_t)pChar->NotifyEnabledEvt;
             }
             else
             {
-              Notification.Motenv_Evt_Opcode = SW_GESTURE_REC_NOTIFY_DISABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-          }
-
-          /* Pedometer char */
-          else if(attribute_modified->Attr_Handle == (aMotenvContext.SWPedometerCharHdle + 2U))
-          {
-            /**
-            * Descriptor handle
-            */
-            return_value = SVCCTL_EvtAckFlowEnable;
-            /**
-            * Notify to application
-            */
-            if(attribute_modified->Attr_Data[0] & COMSVC_Notification)
-            {
-              Notification.Motenv_Evt_Opcode = SW_PEDOMETER_NOTIFY_ENABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-            else
-            {
-              Notification.Motenv_Evt_Opcode = SW_PEDOMETER_NOTIFY_DISABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-          }
-
-          /* IntensityDet char */
-          else if(attribute_modified->Attr_Handle == (aMotenvContext.SWIntensityDetCharHdle + 2U))
-          {
-            /**
-            * Descriptor handle
-            */
-            return_value = SVCCTL_EvtAckFlowEnable;
-            /**
-            * Notify to application
-            */
-            if(attribute_modified->Attr_Data[0] & COMSVC_Notification)
-            {
-              Notification.Motenv_Evt_Opcode = SW_INTENSITY_DET_NOTIFY_ENABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-            else
-            {
-              Notification.Motenv_Evt_Opcode = SW_INTENSITY_DET_NOTIFY_DISABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
+              Notification.Motenv_Evt_Opcode = (MOTENV_STM_Opcode_evt_t)pChar->NotifyDisabledEvt;
             }
+            MOTENV_STM_App_Notification(&Notification);
           }
-
-          /* Configuration char */
-          else if(attribute_modified->Attr_Handle == (aMotenvContext.ConfigCharHdle + 2U))
+          else if(aMotenvChar[attr].WriteEvt != MOTENV_NO_EVT)
           {
             /**
-            * Descriptor handle
-            */
-            return_value = SVCCTL_EvtAckFlowEnable;
-            /**
-            * Notify to application
+            * Char value
             */
-            if(attribute_modified->Attr_Data[0] & COMSVC_Notification)
-            {
-              Notification.Motenv_Evt_Opcode = CONFIG_NOTIFY_ENABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-            else
-            {
-              Notification.Motenv_Evt_Opcode = CONFIG_NOTIFY_DISABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-          }
-
-          /* Configuration char */
-          else if(attribute_modified->Attr_Handle == (aMotenvContext.ConfigCharHdle + 1U))
-          {
-            BLE_DBG_TEMPLATE_STM_MSG("-- GATT : WRITE CONFIG CHAR INFO RECEIVED\n");
-            Notification.Motenv_Evt_Opcode = CONFIG_WRITE_EVT;
+            pChar = &aMotenvChar[attr];
+            BLE_DBG_TEMPLATE_STM_MSG("-- GATT : WRITE CHAR 0x%04X INFO RECEIVED\n", pChar->Uuid);
+            Notification.Motenv_Evt_Opcode = (MOTENV_STM_Opcode_evt_t)pChar->WriteEvt;
             Notification.DataTransfered.Length=attribute_modified->Attr_Data_Length;
             Notification.DataTransfered.pPayload=attribute_modified->Attr_Data;
             MOTENV_STM_App_Notification(&Notification);
           }
-
-          /* Console Term char */
-          else if(attribute_modified->Attr_Handle == (aMotenvContext.ConsoleTermCharHdle + 2U))
-          {
-            /**
-            * Descriptor handle
-            */
-            return_value = SVCCTL_EvtAckFlowEnable;
-            /**
-            * Notify to application
-            */
-            if(attribute_modified->Attr_Data[0] & COMSVC_Notification)
-            {
-              Notification.Motenv_Evt_Opcode = CONSOLE_TERM_NOTIFY_ENABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-            else
-            {
-              Notification.Motenv_Evt_Opcode = CONSOLE_TERM_NOTIFY_DISABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-          }
-
-          /* Console Stderr char */
-          else if(attribute_modified->Attr_Handle == (aMotenvContext.ConsoleStderrCharHdle + 2U))
-          {
-            /**
-            * Descriptor handle
-            */
-            return_value = SVCCTL_EvtAckFlowEnable;
-            /**
-            * Notify to application
-            */
-            if(attribute_modified->Attr_Data[0] & COMSVC_Notification)
-            {
-              Notification.Motenv_Evt_Opcode = CONSOLE_STDERR_NOTIFY_ENABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-            else
-            {
-              Notification.Motenv_Evt_Opcode = CONSOLE_STDERR_NOTIFY_DISABLED_EVT;
-              MOTENV_STM_App_Notification(&Notification);
-            }
-          }
           else
           {
             /* do nothing */
           }
-        break;
-       }
+          break;
+        }
+
+        /* ATT MTU negotiated: size of the batched notifications */
+        case EVT_BLUE_ATT_EXCHANGE_MTU_RESP:
+        {
+          exchange_mtu_resp = (aci_att_exchange_mtu_resp_event_rp0*)blue_evt->data;
+          BLE_DBG_TEMPLATE_STM_MSG("-- GATT : ATT MTU EXCHANGED\n");
+          Notification.Motenv_Evt_Opcode = ATT_MTU_EXCHANGED_EVT;
+          Notification.ConnectionHandle = exchange_mtu_resp->Connection_Handle;
+          Notification.DataTransfered.Length = 2;
+          Notification.DataTransfered.pPayload = (uint8_t*)&exchange_mtu_resp->Server_RX_MTU;
+          MOTENV_STM_App_Notification(&Notification);
+          break;
+        }
+
+        /* Notification buffers released after BLE_STATUS_INSUFFICIENT_RESOURCES */
+        case EVT_BLUE_GATT_TX_POOL_AVAILABLE:
+        {
+          Notification.Motenv_Evt_Opcode = TX_POOL_AVAILABLE_EVT;
+          MOTENV_STM_App_Notification(&Notification);
+          break;
+        }
 
         default:
           break;
@@ -569,6 +314,53 @@ static SVCCTL_EvtAckStatus_t Motenv_Event_Handler(void *Event)
   return(return_value);
 }/* end Motenv_Event_Handler */
 
+/**
+ * @brief  Char of an attribute handle, read from the table filled by
+ *         Motenv_Register_Attr() so the dispatch does not depend on the
+ *         number of chars
+ * @param  AttrHandle: Attribute handle
+ * @retval MOTENV_STM_Char_t of the value, or'ed with MOTENV_ATTR_CCCD for the
+ *         descriptor, MOTENV_ATTR_NONE when the handle is not a MOTENV char
+ */
+static uint8_t Motenv_Attr_Char(uint16_t AttrHandle)
+{
+  uint16_t offset = AttrHandle - aMotenvContext.SvcHdle[MOTENV_HW_SVC];
+
+  if(offset >= sizeof(aMotenvContext.AttrChar))
+  {
+    return MOTENV_ATTR_NONE;
+  }
+  return aMotenvContext.AttrChar[offset];
+}
+
+/**
+ * @brief  Fill the attribute table once all the chars are added: the stack
+ *         allocates the handles in sequence, the value of a char follows its
+ *         declaration and the CCCD follows the value
+ * @param  None
+ * @retval None
+ */
+static void Motenv_Register_Attr(void)
+{
+  uint16_t offset;
+  uint8_t i;
+
+  memset(aMotenvContext.AttrChar, MOTENV_ATTR_NONE, sizeof(aMotenvContext.AttrChar));
+  for(i = 0; i < (uint8_t)MOTENV_STM_CHAR_NUMBER; i++)
+  {
+    offset = aMotenvContext.CharHdle[i] - aMotenvContext.SvcHdle[MOTENV_HW_SVC];
+    if((offset + 2U) < sizeof(aMotenvContext.AttrChar))
+    {
+      aMotenvContext.AttrChar[offset + 1U] = i;
+      aMotenvContext.AttrChar[offset + 2U] = i | MOTENV_ATTR_CCCD;
+    }
+    else
+    {
+      BLE_DBG_TEMPLATE_STM_MSG("-- GATT : CHAR 0x%04X OUT OF THE ATTRIBUTE TABLE\n", aMotenvChar[i].Uuid);
+    }
+  }
+}
+
 
 /* Public functions ----------------------------------------------------------*/
 
@@ -594,12 +386,12 @@ void MOTENV_STM_Init(void)
                              (Service_UUID_t *) &uuid16,
                              PRIMARY_SERVICE,
                              1+(3*HW_CHAR_NUMBER), /*Max_Attribute_Records*/
-                             &(aMotenvContext.HWSvcHdle));
+                             &(aMotenvContext.SvcHdle[MOTENV_HW_SVC]));
   /**
    *   Add Motion Characteristic for HW Service
    */
   COPY_HW_MOTION_CHAR_UUID(uuid16.Char_UUID_128);
-  (void)aci_gatt_add_char(aMotenvContext.HWSvcHdle,
+  (void)aci_gatt_add_char(aMotenvContext.SvcHdle[MOTENV_HW_SVC],
                           UUID_TYPE_128, &uuid16,
                           MOTION_CHAR_LEN,
                           CHAR_PROP_NOTIFY,
@@ -607,13 +399,13 @@ void MOTENV_STM_Init(void)
                           GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
                           16, /* encryKeySize */
                           0, /* isVariable: 1 */
-                          &(aMotenvContext.HWMotionCharHdle));
+                          &(aMotenvContext.CharHdle[MOTENV_STM_MOTION_CHAR]));
 
     /**
      *   Add Env Characteristic for HW Service
      */
     COPY_HW_ENV_CHAR_UUID(uuid16.Char_UUID_128);
-    (void)aci_gatt_add_char(aMotenvContext.HWSvcHdle,
+    (void)aci_gatt_add_char(aMotenvContext.SvcHdle[MOTENV_HW_SVC],
                             UUID_TYPE_128, &uuid16,
                             ENV_CHAR_LEN,
                             CHAR_PROP_NOTIFY|CHAR_PROP_READ,
@@ -621,13 +413,13 @@ void MOTENV_STM_Init(void)
                             GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
                             16, /* encryKeySize */
                             0, /* isVariable: 1 */
-                            &(aMotenvContext.HWEnvCharHdle));
+                            &(aMotenvContext.CharHdle[MOTENV_STM_ENV_CHAR]));
 
     /**
      *   Add Acc Event Characteristic for HW Service
      */
     COPY_HW_ACC_EVENT_CHAR_UUID(uuid16.Char_UUID_128);
-    (void)aci_gatt_add_char(aMotenvContext.HWSvcHdle,
+    (void)aci_gatt_add_char(aMotenvContext.SvcHdle[MOTENV_HW_SVC],
                             UUID_TYPE_128, &uuid16,
                             ACC_EVENT_CHAR_LEN,
                             CHAR_PROP_NOTIFY|CHAR_PROP_READ,
@@ -635,7 +427,21 @@ void MOTENV_STM_Init(void)
                             GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
                             16, /* encryKeySize */
                             1, /* isVariable: 1 */
-                            &(aMotenvContext.HWAccEventCharHdle));
+                            &(aMotenvContext.CharHdle[MOTENV_STM_ACC_EVENT_CHAR]));
+
+    /**
+     *   Add Motion Batch Characteristic for HW Service
+     */
+    COPY_HW_MOTION_BATCH_CHAR_UUID(uuid16.Char_UUID_128);
+    (void)aci_gatt_add_char(aMotenvContext.SvcHdle[MOTENV_HW_SVC],
+                            UUID_TYPE_128, &uuid16,
+                            MOTION_BATCH_CHAR_LEN,
+                            CHAR_PROP_NOTIFY,
+                            ATTR_PERMISSION_NONE,
+                            GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
+                            16, /* encryKeySize */
+                            1, /* isVariable: 1 */
+                            &(aMotenvContext.CharHdle[MOTENV_STM_MOTION_BATCH_CHAR]));
 
   /**
    *   Add SW Service
@@ -645,13 +451,13 @@ void MOTENV_STM_Init(void)
                              (Service_UUID_t *) &uuid16,
                              PRIMARY_SERVICE,
                              1+(3*SW_CHAR_NUMBER), /*Max_Attribute_Records*/
-                             &(aMotenvContext.SWSvcHdle));
+                             &(aMotenvContext.SvcHdle[MOTENV_SW_SVC]));
 
   /**
    *   Add Quaternions Characteristic for SW Service
    */
   COPY_SW_QUATERNIONS_CHAR_UUID(uuid16.Char_UUID_128);
-  (void)aci_gatt_add_char(aMotenvContext.SWSvcHdle,
+  (void)aci_gatt_add_char(aMotenvContext.SvcHdle[MOTENV_SW_SVC],
                           UUID_TYPE_128, &uuid16,
                           QUATERNION_CHAR_LEN,
                           CHAR_PROP_NOTIFY,
@@ -659,13 +465,13 @@ void MOTENV_STM_Init(void)
                           GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
                           16, /* encryKeySize */
                           0, /* isVariable: 1 */
-                          &(aMotenvContext.SWQuaternionsCharHdle));
+                          &(aMotenvContext.CharHdle[MOTENV_STM_MOTION_FX_CHAR]));
 
   /**
    *   Add ECompass Characteristic for SW Service
    */
   COPY_SW_ECOMPASS_CHAR_UUID(uuid16.Char_UUID_128);
-  (void)aci_gatt_add_char(aMotenvContext.SWSvcHdle,
+  (void)aci_gatt_add_char(aMotenvContext.SvcHdle[MOTENV_SW_SVC],
                           UUID_TYPE_128, &uuid16,
                           ECOMPASS_CHAR_LEN,
                           CHAR_PROP_NOTIFY,
@@ -673,13 +479,13 @@ void MOTENV_STM_Init(void)
                           GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
                           16, /* encryKeySize */
                           0, /* isVariable: 1 */
-                          &(aMotenvContext.SWECompassCharHdle));
+                          &(aMotenvContext.CharHdle[MOTENV_STM_ECOMPASS_CHAR]));
 
   /**
    *   Add Activity Rec Characteristic for SW Service
    */
   COPY_SW_ACTIVITY_REC_CHAR_UUID(uuid16.Char_UUID_128);
-  (void)aci_gatt_add_char(aMotenvContext.SWSvcHdle,
+  (void)aci_gatt_add_char(aMotenvContext.SvcHdle[MOTENV_SW_SVC],
                           UUID_TYPE_128, &uuid16,
                           ACTIVITY_REC_CHAR_LEN,
                           CHAR_PROP_NOTIFY | CHAR_PROP_READ,
@@ -687,13 +493,13 @@ void MOTENV_STM_Init(void)
                           GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
                           16, /* encryKeySize */
                           0, /* isVariable: 1 */
-                          &(aMotenvContext.SWActivityRecCharHdle));
+                          &(aMotenvContext.CharHdle[MOTENV_STM_ACTIVITY_REC_CHAR]));
 
   /**
    *   Add Carry Position Characteristic for SW Service
    */
   COPY_SW_CARRY_POSITION_CHAR_UUID(uuid16.Char_UUID_128);
-  (void)aci_gatt_add_char(aMotenvContext.SWSvcHdle,
+  (void)aci_gatt_add_char(aMotenvContext.SvcHdle[MOTENV_SW_SVC],
                           UUID_TYPE_128, &uuid16,
                           CARRY_POSITION_CHAR_LEN,
                           CHAR_PROP_NOTIFY | CHAR_PROP_READ,
@@ -701,13 +507,13 @@ void MOTENV_STM_Init(void)
                           GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
                           16, /* encryKeySize */
                           0, /* isVariable: 1 */
-                          &(aMotenvContext.SWCarryPositionCharHdle));
+                          &(aMotenvContext.CharHdle[MOTENV_STM_CARRY_POSITION_CHAR]));
 
   /**
    *   Add Gesture Rec Characteristic for SW Service
    */
   COPY_SW_GESTURE_REC_CHAR_UUID(uuid16.Char_UUID_128);
-  (void)aci_gatt_add_char(aMotenvContext.SWSvcHdle,
+  (void)aci_gatt_add_char(aMotenvContext.SvcHdle[MOTENV_SW_SVC],
                           UUID_TYPE_128, &uuid16,
                           GESTURE_REC_CHAR_LEN,
                           CHAR_PROP_NOTIFY | CHAR_PROP_READ,
@@ -715,13 +521,13 @@ void MOTENV_STM_Init(void)
                           GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
                           16, /* encryKeySize */
                           0, /* isVariable: 1 */
-                          &(aMotenvContext.SWGestureRecCharHdle));
+                          &(aMotenvContext.CharHdle[MOTENV_STM_GESTURE_REC_CHAR]));
 
   /**
    *   Add Pedometer Characteristic for SW Service
    */
   COPY_SW_PEDOMETER_CHAR_UUID(uuid16.Char_UUID_128);
-  (void)aci_gatt_add_char(aMotenvContext.SWSvcHdle,
+  (void)aci_gatt_add_char(aMotenvContext.SvcHdle[MOTENV_SW_SVC],
                           UUID_TYPE_128, &uuid16,
                           PEDOMETER_CHAR_LEN,
                           CHAR_PROP_NOTIFY | CHAR_PROP_READ,
@@ -729,13 +535,13 @@ void MOTENV_STM_Init(void)
                           GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
                           16, /* encryKeySize */
                           0, /* isVariable: 1 */
-                          &(aMotenvContext.SWPedometerCharHdle));
+                          &(aMotenvContext.CharHdle[MOTENV_STM_PEDOMETER_CHAR]));
 
   /**
    *   Add IntensityDet Characteristic for SW Service
    */
   COPY_SW_INTENSITY_DET_CHAR_UUID(uuid16.Char_UUID_128);
-  (void)aci_gatt_add_char(aMotenvContext.SWSvcHdle,
+  (void)aci_gatt_add_char(aMotenvContext.SvcHdle[MOTENV_SW_SVC],
                           UUID_TYPE_128, &uuid16,
                           INTENSITY_DET_CHAR_LEN,
                           CHAR_PROP_NOTIFY,
@@ -743,7 +549,7 @@ void MOTENV_STM_Init(void)
                           GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
                           16, /* encryKeySize */
                           0, /* isVariable: 1 */
-                          &(aMotenvContext.SWIntensityDetCharHdle));
+                          &(aMotenvContext.CharHdle[MOTENV_STM_INTENSITY_DET_CHAR]));
 
   /**
    *   Add Config Service
@@ -753,13 +559,13 @@ void MOTENV_STM_Init(void)
                              (Service_UUID_t *) &uuid16,
                              PRIMARY_SERVICE,
                              1+(3*CONFIG_CHAR_NUMBER), /*Max_Attribute_Records*/
-                             &(aMotenvContext.ConfigSvcHdle));
+                             &(aMotenvContext.SvcHdle[MOTENV_CONFIG_SVC]));
 
   /**
    *   Add Config Characteristic for Config Service
    */
   COPY_CONFIG_CHAR_UUID(uuid16.Char_UUID_128);
-  (void)aci_gatt_add_char(aMotenvContext.ConfigSvcHdle,
+  (void)aci_gatt_add_char(aMotenvContext.SvcHdle[MOTENV_CONFIG_SVC],
                           UUID_TYPE_128, &uuid16,
                           CONFIG_CHAR_LEN,
                           CHAR_PROP_NOTIFY | CHAR_PROP_WRITE_WITHOUT_RESP,
@@ -767,7 +573,7 @@ void MOTENV_STM_Init(void)
                           GATT_NOTIFY_ATTRIBUTE_WRITE | GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
                           16, /* encryKeySize */
                           0, /* isVariable: 1 */
-                          &(aMotenvContext.ConfigCharHdle));
+                          &(aMotenvContext.CharHdle[MOTENV_STM_CONFIG_CHAR]));
 
   /**
    *   Add Console Service
@@ -777,12 +583,12 @@ void MOTENV_STM_Init(void)
                              (Service_UUID_t *) &uuid16,
                              PRIMARY_SERVICE,
                              1+(3*CONSOLE_CHAR_NUMBER), /*Max_Attribute_Records*/
-                             &(aMotenvContext.ConsoleSvcHdle));
+                             &(aMotenvContext.SvcHdle[MOTENV_CONSOLE_SVC]));
   /**
    *   Add Cosole Term Characteristic for Config Service
    */
   COPY_TERM_CHAR_UUID(uuid16.Char_UUID_128);
-  (void)aci_gatt_add_char(aMotenvContext.ConsoleSvcHdle,
+  (void)aci_gatt_add_char(aMotenvContext.SvcHdle[MOTENV_CONSOLE_SVC],
                           UUID_TYPE_128, &uuid16,
                           CONSOLE_CHAR_LEN,
                           CHAR_PROP_NOTIFY | CHAR_PROP_WRITE_WITHOUT_RESP | CHAR_PROP_WRITE | CHAR_PROP_READ,
@@ -790,12 +596,12 @@ void MOTENV_STM_Init(void)
                           GATT_NOTIFY_ATTRIBUTE_WRITE | GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
                           16, /* encryKeySize */
                           1, /* isVariable: 1 */
-                          &(aMotenvContext.ConsoleTermCharHdle));
+                          &(aMotenvContext.CharHdle[MOTENV_STM_CONSOLE_TERM_CHAR]));
   /**
    *   Add Console Stderr Characteristic for Config Service
    */
   COPY_STDERR_CHAR_UUID(uuid16.Char_UUID_128);
-  (void)aci_gatt_add_char(aMotenvContext.ConsoleSvcHdle,
+  (void)aci_gatt_add_char(aMotenvContext.SvcHdle[MOTENV_CONSOLE_SVC],
                           UUID_TYPE_128, &uuid16,
                           CONSOLE_CHAR_LEN,
                           CHAR_PROP_NOTIFY | CHAR_PROP_READ,
@@ -803,148 +609,35 @@ void MOTENV_STM_Init(void)
                           GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
                           16, /* encryKeySize */
                           1, /* isVariable: 1 */
-                          &(aMotenvContext.ConsoleStderrCharHdle));
+                          &(aMotenvContext.CharHdle[MOTENV_STM_CONSOLE_STDERR_CHAR]));
+
+  /**
+   *   Route the GATT events by attribute handle
+   */
+  Motenv_Register_Attr();
 
   return;
 } /* end MOTENV_STM_Init */
 
 /**
  * @brief  Characteristic update
- * @param  UUID: UUID of the characteristic
+ * @param  Char: Characteristic
  * @param  payloadLen: Length of the char value to be notified
  * @param  pPayload: Char value to be notified
  * @retval BLE status
  */
-tBleStatus MOTENV_STM_App_Update_Char(uint16_t UUID, uint8_t payloadLen, uint8_t *pPayload) 
+tBleStatus MOTENV_STM_App_Update_Char(MOTENV_STM_Char_t Char, uint8_t payloadLen, uint8_t *pPayload)
 {
-  tBleStatus result = BLE_STATUS_INVALID_PARAMS;
-  switch(UUID)
+  if(Char >= MOTENV_STM_CHAR_NUMBER)
   {
-    case ENV_CHAR_UUID:
-
-     result = aci_gatt_update_char_value(aMotenvContext.HWSvcHdle,
-                                         aMotenvContext.HWEnvCharHdle,
-                                         0, /* charValOffset */
-                                         payloadLen, /* charValueLen */
-                                         pPayload);
-    
-      break;
-
-    case MOTION_CHAR_UUID:
-
-     result = aci_gatt_update_char_value(aMotenvContext.HWSvcHdle,
-                                         aMotenvContext.HWMotionCharHdle,
-                                         0, /* charValOffset */
-                                         payloadLen, /* charValueLen */
-                                         pPayload);
-
-      break;
-
-    case ACC_EVENT_CHAR_UUID:
-
-     result = aci_gatt_update_char_value(aMotenvContext.HWSvcHdle,
-                                         aMotenvContext.HWAccEventCharHdle,
-                                         0, /* charValOffset */
-                                         payloadLen, /* charValueLen */
-                                         pPayload);
-    
-      break;
-
-    case MOTION_FX_CHAR_UUID:
-
-     result = aci_gatt_update_char_value(aMotenvContext.SWSvcHdle,
-                                         aMotenvContext.SWQuaternionsCharHdle,
-                                         0, /* charValOffset */
-                                         payloadLen, /* charValueLen */
-                                         pPayload);
-     break;
-
-    case ECOMPASS_CHAR_UUID:
-
-     result = aci_gatt_update_char_value(aMotenvContext.SWSvcHdle,
-                                         aMotenvContext.SWECompassCharHdle,
-                                         0, /* charValOffset */
-                                         payloadLen, /* charValueLen */
-                                         pPayload);
-     break;
-
-    case ACTIVITY_REC_CHAR_UUID:
-
-     result = aci_gatt_update_char_value(aMotenvContext.SWSvcHdle,
-                                         aMotenvContext.SWActivityRecCharHdle,
-                                         0, /* charValOffset */
-                                         payloadLen, /* charValueLen */
-                                         pPayload);
-     break;
-
-    case CARRY_POSITION_CHAR_UUID:
-
-     result = aci_gatt_update_char_value(aMotenvContext.SWSvcHdle,
-                                         aMotenvContext.SWCarryPositionCharHdle,
-                                         0, /* charValOffset */
-                                         payloadLen, /* charValueLen */
-                                         pPayload);
-     break;
-
-    case GESTURE_REC_CHAR_UUID:
-
-     result = aci_gatt_update_char_value(aMotenvContext.SWSvcHdle,
-                                         aMotenvContext.SWGestureRecCharHdle,
-                                         0, /* charValOffset */
-                                         payloadLen, /* charValueLen */
-                                         pPayload);
-     break;
-
-    case PEDOMETER_CHAR_UUID:
-
-     result = aci_gatt_update_char_value(aMotenvContext.SWSvcHdle,
-                                         aMotenvContext.SWPedometerCharHdle,
-                                         0, /* charValOffset */
-                                         payloadLen, /* charValueLen */
-                                         pPayload);
-     break;
-
-    case INTENSITY_DET_CHAR_UUID:
-
-     result = aci_gatt_update_char_value(aMotenvContext.SWSvcHdle,
-                                         aMotenvContext.SWIntensityDetCharHdle,
-                                         0, /* charValOffset */
-                                         payloadLen, /* charValueLen */
-                                         pPayload);
-     break;
-
-    case CONFIG_CHAR_UUID:
-
-     result = aci_gatt_update_char_value(aMotenvContext.ConfigSvcHdle,
-                                         aMotenvContext.ConfigCharHdle,
-                                         0, /* charValOffset */
-                                         payloadLen, /* charValueLen */
-                                         pPayload);
-     break;
-
-    case CONSOLE_TERM_CHAR_UUID:
-
-     result = aci_gatt_update_char_value(aMotenvContext.ConsoleSvcHdle,
-                                         aMotenvContext.ConsoleTermCharHdle,
-                                         0, /* charValOffset */
-                                         payloadLen, /* charValueLen */
-                                         pPayload);
-     break;
-
-    case CONSOLE_STDERR_CHAR_UUID:
-
-     result = aci_gatt_update_char_value(aMotenvContext.ConsoleSvcHdle,
-                                         aMotenvContext.ConsoleStderrCharHdle,
-                                         0, /* charValOffset */
-                                         payloadLen, /* charValueLen */
-                                         pPayload);
-     break;
-
-    default:
-      break;
+    return BLE_STATUS_INVALID_PARAMS;
   }
 
-  return result;
+  return aci_gatt_update_char_value(aMotenvContext.SvcHdle[aMotenvChar[Char].Svc],
+                                    aMotenvContext.CharHdle[Char],
+                                    0, /* charValOffset */
+                                    payloadLen, /* charValueLen */
+                                    pPayload);
 }
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -145,6 +145,17 @@ extern "C" {
 
   typedef void (*HW_TS_pTimerCb_t)(void);
 
+  /**
+   * Timer server statistics, updated when CFG_HW_TS_INSTRUMENTATION is set to 1
+   */
+  typedef struct
+  {
+    uint32_t Wakeups;           /**< RTC wakeup interrupts handled */
+    uint32_t WakeupCycles;      /**< CPU cycles spent in HW_TS_RTC_Wakeup_Handler() */
+    uint32_t WakeupMaxCycles;   /**< Longest HW_TS_RTC_Wakeup_Handler() */
+    uint32_t Reschedules;       /**< Wakeup timer setups */
+  } HW_TS_Stats_t;
+
   /**
    * @brief  Initialize the timer server
    *         This API shall be called by the application before any timer is requested to the timer server. It
@@ -263,6 +274,15 @@ extern "C" {
    */
   void HW_TS_RTC_CountUpdated_AppNot(void);
 
+  /**
+   * @brief  Read the timer server statistics
+   *         All fields are 0 when CFG_HW_TS_INSTRUMENTATION is not set to 1
+   *
+   * @param  pStats: Statistics copied
+   * @retval None
+   */
+  void HW_TS_Get_Stats(HW_TS_Stats_t *pStats);
+
   /******************************************************************************
    * HW IPCC
    ******************************************************************************/
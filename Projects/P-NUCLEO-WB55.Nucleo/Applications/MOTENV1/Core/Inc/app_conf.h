@@ -139,6 +139,19 @@
 #define L2CAP_SLAVE_LATENCY             0x0000   // 0x0000 .. 0x01F3 = 499 
 #define L2CAP_TIMEOUT_MULTIPLIER        0x1F4    // 500 * 10ms = 5000ms
 
+/**
+ * Connection interval requested for the notifications enabled (conn_param_app.c),
+ * off while the fixed test request above is used
+ */
+#define CFG_CONN_PARAM_ADAPTIVE           (L2CAP_REQUEST_NEW_CONN_PARAM == 0)
+#define CFG_CONN_PARAM_NOTIFY_PER_EVENT   3        /* Notifications planned in one connection event */
+#define CFG_CONN_PARAM_MARGIN             75       /* % of the capacity of an interval used */
+#define CFG_CONN_PARAM_HOLD_MS            5000     /* Rate lower for this long before slowing down */
+#define CFG_CONN_PARAM_RETRY_MS           2000     /* Request again after this, doubled at each attempt */
+#define CFG_CONN_PARAM_MAX_RETRY          4        /* Requests of the same interval before giving up */
+#define CFG_CONN_PARAM_SLAVE_LATENCY      0x0000
+#define CFG_CONN_PARAM_TIMEOUT_MULTIPLIER 0x1F4    // 500 * 10ms = 5000ms
+
 #ifdef NFC_ENABLE
 #define VCARD_STRING_SIZE   256   
      
@@ -187,7 +200,7 @@
  *  - 2, if extended properties is used
  *  The total amount of memory needed is the sum of the above quantities for each attribute.
  */
-#define CFG_BLE_ATT_VALUE_ARRAY_SIZE    (1344)
+#define CFG_BLE_ATT_VALUE_ARRAY_SIZE    (1786)
 
 /**
  * Prepare Write List size in terms of number of packet with ATT_MTU=23 bytes
@@ -306,9 +319,22 @@
 /**
  *  When set to 1, the low power mode is enable
  *  When set to 0, the device stays in RUN mode
+ *  The Stop mode pays only with the NFC reader built with DEMO_LOW_POWER_DETECTION=1, otherwise it
+ *  polls continuously. The debugger is then disabled, see CFG_DEBUGGER_SUPPORTED.
  */
 #define CFG_LPM_SUPPORTED    0
 
+/**
+ * Stop mode budget, see UTIL_SEQ_Idle()
+ * The Stop mode is entered only when the next Timer Server deadline is far enough to pay for
+ * the transitions: the HSI switch before Stop2 and, on exit, the Stop2 wakeup on HSI followed
+ * by the HSE restart of PWR_ExitStopMode() (immediate when CPU2 already runs the HSE).
+ * Below twice these costs the MCU sleeps with the clocks running, as it did in RUN mode.
+ */
+#define CFG_LPM_STOP_ENTRY_US     (20)
+#define CFG_LPM_STOP_EXIT_US      (1000)
+#define CFG_LPM_STOP_MIN_US       (2 * (CFG_LPM_STOP_ENTRY_US + CFG_LPM_STOP_EXIT_US))
+
 /******************************************************************************
  * Timer Server
  ******************************************************************************/
@@ -427,13 +453,25 @@ typedef enum
 #define CFG_DEBUG_TRACE             1
 #endif
 
-#if (CFG_DEBUG_TRACE != 0)
+/**
+ * With NFC_ENABLE the traces go through the log ring, which keeps the device out of Stop mode
+ * until it is drained, see logUsartIsIdle()
+ */
+#if (CFG_DEBUG_TRACE != 0) && !defined(NFC_ENABLE)
 #undef CFG_LPM_SUPPORTED
 #undef CFG_DEBUGGER_SUPPORTED
 #define CFG_LPM_SUPPORTED         0
 #define CFG_DEBUGGER_SUPPORTED      1
 #endif
 
+/**
+ * The debug domain kept powered in Stop mode would add to its current
+ */
+#if (CFG_LPM_SUPPORTED == 1)
+#undef CFG_DEBUGGER_SUPPORTED
+#define CFG_DEBUGGER_SUPPORTED      0
+#endif
+
 /* USER CODE BEGIN Defines */
 
 /* USER CODE END Defines */
@@ -458,15 +496,18 @@ typedef enum
 /* USER CODE BEGIN CFG_Task_Id_With_HCI_Cmd_t */
   CFG_TASK_SW2_BUTTON_PUSHED_ID,
   CFG_TASK_NOTIFY_ACC_GYRO_MAG_ID,
+  CFG_TASK_NOTIFY_MOTION_BATCH_ID,
   CFG_TASK_NOTIFY_ENVIRONMENT_ID,
   CFG_TASK_NOTIFY_MOTIONFX_ID,
-  CFG_TASK_NOTIFY_ECOMPASS_ID,
   CFG_TASK_NOTIFY_ACTIVITY_REC_ID,
   CFG_TASK_NOTIFY_CARRY_POSITION_ID,
   CFG_TASK_NOTIFY_GESTURE_REC_ID,
   CFG_TASK_NOTIFY_PEDOMETER_ID,
   CFG_TASK_NOTIFY_INTENSITY_DET_ID,
   CFG_TASK_HANDLE_MEMS_IT_ID,
+  CFG_TASK_CONSOLE_TX_ID,
+  CFG_TASK_NOTIFY_FLUSH_ID,
+  CFG_TASK_CONN_PARAM_ID,
 
 /* USER CODE END CFG_Task_Id_With_HCI_Cmd_t */
     CFG_LAST_TASK_ID_WITH_HCICMD,                                               /**< Shall be LAST in the list */
@@ -478,7 +519,9 @@ typedef enum
     CFG_FIRST_TASK_ID_WITH_NO_HCICMD = CFG_LAST_TASK_ID_WITH_HCICMD - 1,        /**< Shall be FIRST in the list */
     CFG_TASK_SYSTEM_HCI_ASYNCH_EVT_ID,
 /* USER CODE BEGIN CFG_Task_Id_With_NO_HCI_Cmd_t */
-
+  CFG_TASK_SENSOR_HUB_ID,
+  CFG_TASK_SENSOR_HUB_READY_ID,
+  CFG_TASK_NFC_ID,
 /* USER CODE END CFG_Task_Id_With_NO_HCI_Cmd_t */
     CFG_LAST_TASK_ID_WITHO_NO_HCICMD                                            /**< Shall be LAST in the list */
 } CFG_Task_Id_With_NO_HCI_Cmd_t;
@@ -513,9 +556,46 @@ typedef enum
 typedef enum
 {
     CFG_LPM_APP,
-    CFG_LPM_APP_BLE
+    CFG_LPM_APP_BLE,
+    CFG_LPM_IDLE,
 } CFG_LPM_Id_t;
 
+/******************************************************************************
+ * Flash key-value store
+ ******************************************************************************/
+/**
+ * Pages of the key-value store keeping the magnetometer calibration, at the end
+ * of the CPU1 flash. They are kept out of the code region in the linker files.
+ */
+#define CFG_KV_STORE_ADDRESS    (0x0807E000)
+#define CFG_KV_STORE_PAGE_NBR   (2)
+
+/**
+ * Keep the MotionFX magnetometer calibration in the key-value store
+ */
+#define MOTION_FX_STORE_CALIB_FLASH
+
+/******************************************************************************
+ * Environmental acquisition
+ ******************************************************************************/
+/**
+ * While the Env notifications are enabled, acquire in batches instead of reading
+ * the free-running sensors every 500ms: the LPS22HH FIFO is drained once per
+ * watermark period and averaged, the HTS221 makes one one-shot conversion per
+ * period. A notification is sent only when a value moved by its threshold, or
+ * after CFG_ENV_MAX_SILENCE without notification.
+ * Not defined by default: the Env characteristic is then notified every 500ms as
+ * the ST BLE Sensor application expects.
+ */
+/* #define ENV_BATCHED_ACQUISITION */
+
+#define CFG_ENV_BATCH_ODR               (1)   /**< LPS22HH output data rate [Hz] */
+#define CFG_ENV_BATCH_WATERMARK         (5)   /**< LPS22HH FIFO samples per batch */
+#define CFG_ENV_PRESSURE_THRESHOLD      (10)  /**< 0.10 hPa */
+#define CFG_ENV_HUMIDITY_THRESHOLD      (5)   /**< 0.5 %rH */
+#define CFG_ENV_TEMPERATURE_THRESHOLD   (2)   /**< 0.2 degC */
+#define CFG_ENV_MAX_SILENCE             (60)  /**< [s] */
+
 /******************************************************************************
  * OTP manager
  ******************************************************************************/
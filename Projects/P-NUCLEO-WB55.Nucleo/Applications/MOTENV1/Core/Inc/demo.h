@@ -48,11 +48,13 @@ extern "C" {
 
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
+#define DEMO_IDLE_FOREVER   0xFFFFFFFFU   /*!< demoIdleTime(): only the ST25R3916 IRQ needs demoCycle() */
 /* Exported macro ------------------------------------------------------------*/
 
 /* Exported functions ------------------------------------------------------- */
 bool demoIni( void );
 extern void demoCycle(void);
+extern uint32_t demoIdleTime(void);
 
 #ifdef __cplusplus
 }
@@ -99,6 +99,7 @@
 void     demoCeInit(uint8_t* nfcfNfcid);
 uint16_t demoCeT3T(uint8_t *rxData, uint16_t rxDataLen, uint8_t *txBuf, uint16_t txBufLen );
 uint16_t demoCeT4T(uint8_t *rxData, uint16_t rxDataLen, uint8_t *txBuf, uint16_t txBufLen );
+void     demoCeT4TReset(void);
 
 
 
@@ -101,6 +101,21 @@
    */
 #define CFG_HW_TS_RTC_WAKEUP_HANDLER_ID  RTC_WKUP_IRQn
 
+  /**
+   * The running timers are kept either in a list sorted by time left (0) or in a min-heap sorted by expiry time (1)
+   * With the list, starting or stopping a timer walks the list and updates the time left of all running timers
+   * each time the wakeup timer is setup. With the heap, it costs O(log n) and the wakeup timer is only setup again
+   * when the earliest timer changes.
+   * With the heap, the timeout shall not exceed 0x7FFFFFFF ticks
+   */
+#define CFG_HW_TS_USE_HEAP  1
+
+  /**
+   * When set to 1, the time spent in HW_TS_RTC_Wakeup_Handler() is measured with the DWT cycle counter
+   * and reported by HW_TS_Get_Stats()
+   */
+#define CFG_HW_TS_INSTRUMENTATION  0
+
 /******************************************************************************
  * HW UART
  *****************************************************************************/
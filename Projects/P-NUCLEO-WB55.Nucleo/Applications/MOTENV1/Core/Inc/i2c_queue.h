@@ -0,0 +1,109 @@
+/**
+  ******************************************************************************
+  * @file           : i2c_queue.h
+  * @brief          : header file for the I2C transaction queue
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef I2C_QUEUE_H
+#define I2C_QUEUE_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef I2C_QUEUE_SIZE
+  #define I2C_QUEUE_SIZE                 8U
+#endif
+
+#define I2C_QUEUE_OK                     0
+#define I2C_QUEUE_ERROR                 -1
+#define I2C_QUEUE_FULL                  -2
+
+/* Transaction direction */
+#define I2C_QUEUE_READ                   0U
+#define I2C_QUEUE_WRITE                  1U
+
+/* Transaction flags */
+#define I2C_QUEUE_FLAG_NONE              0U
+/* The transaction may be merged with the previous one of the same device when
+ * registers and buffers are contiguous (device must auto-increment the address) */
+#define I2C_QUEUE_FLAG_MERGE             (1U << 0)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Completion callback, called from the bus completion interrupt
+  * @param  Status I2C_QUEUE_OK or the error returned by the bus
+  * @param  pCtx   Context given when the transaction was posted
+  */
+typedef void (*I2C_QUEUE_Cb_t)(int32_t Status, void *pCtx);
+
+/**
+  * @brief  Start one transfer on the bus. Must return at once and report the
+  *         end of the transfer through I2C_QUEUE_Complete()
+  */
+typedef int32_t (*I2C_QUEUE_Start_Func)(uint16_t DevAddr, uint16_t Reg, uint8_t Dir, uint8_t *pData, uint16_t Length);
+
+typedef struct
+{
+  uint16_t DevAddr;
+  uint16_t Reg;
+  uint8_t *pData;
+  uint16_t Length;
+  uint8_t Dir;
+  uint8_t Flags;
+  I2C_QUEUE_Cb_t Callback;
+  void *pCtx;
+} I2C_QUEUE_Xfer_t;
+
+typedef struct
+{
+  uint32_t Posted;      /* Transactions accepted */
+  uint32_t Transfers;   /* Bus transfers started */
+  uint32_t Merged;      /* Transactions served by the transfer of a previous one */
+  uint32_t Errors;      /* Transfers completed with an error */
+} I2C_QUEUE_Stats_t;
+
+typedef struct
+{
+  I2C_QUEUE_Xfer_t Xfer[I2C_QUEUE_SIZE];
+  /* Updated by I2C_QUEUE_Complete() from the transfer complete interrupt,
+   * polled by the blocking accesses waiting for the queue to drain */
+  volatile uint8_t Head;
+  volatile uint8_t Count;
+  volatile uint8_t InFlight;  /* Transactions covered by the transfer on the bus */
+  I2C_QUEUE_Start_Func Start;
+  I2C_QUEUE_Stats_t Stats;
+} I2C_QUEUE_t;
+
+/* Exported functions ------------------------------------------------------- */
+/* I2C_QUEUE_Post() and I2C_QUEUE_Complete() must not preempt each other:
+ * the caller of I2C_QUEUE_Post() masks the completion interrupt */
+void I2C_QUEUE_Init(I2C_QUEUE_t *pQueue, I2C_QUEUE_Start_Func Start);
+int32_t I2C_QUEUE_Post(I2C_QUEUE_t *pQueue, const I2C_QUEUE_Xfer_t *pXfer);
+void I2C_QUEUE_Complete(I2C_QUEUE_t *pQueue, int32_t Status);
+uint8_t I2C_QUEUE_IsIdle(const I2C_QUEUE_t *pQueue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* I2C_QUEUE_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
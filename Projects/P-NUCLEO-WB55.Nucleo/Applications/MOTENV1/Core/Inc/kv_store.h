@@ -0,0 +1,92 @@
+/**
+  ******************************************************************************
+  * @file           : kv_store.h
+  * @brief          : header file for the flash key-value store
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef KV_STORE_H
+#define KV_STORE_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef KV_STORE_PAGE_SIZE
+  #define KV_STORE_PAGE_SIZE             4096U
+#endif
+
+/* Keys are 0 to KV_STORE_KEY_NBR - 1 */
+#ifndef KV_STORE_KEY_NBR
+  #define KV_STORE_KEY_NBR               4U
+#endif
+
+#ifndef KV_STORE_MAX_LENGTH
+  #define KV_STORE_MAX_LENGTH            256U
+#endif
+
+#define KV_STORE_OK                      0
+#define KV_STORE_ERROR                  -1
+#define KV_STORE_NOT_FOUND              -2
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Flash access. The store reads the flash through the memory map and
+  *         programs it once between two erases, a double word at a time
+  */
+typedef struct
+{
+  /* Erase the page at Address, return 0 on success */
+  int32_t (*Erase)(uintptr_t Address);
+  /* Program the double word at Address, return 0 on success */
+  int32_t (*Program)(uintptr_t Address, uint64_t Data);
+} KV_STORE_Flash_t;
+
+typedef struct
+{
+  uint32_t Writes;      /* Records written, copies excluded */
+  uint32_t Unchanged;   /* Writes skipped, the value was already stored */
+  uint32_t Copies;      /* Records copied out of a page before its erase */
+  uint32_t Erases;      /* Pages erased */
+} KV_STORE_Stats_t;
+
+typedef struct
+{
+  const KV_STORE_Flash_t *pFlash;
+  uintptr_t Base;
+  uint32_t PageNbr;
+  uint32_t Active;      /* Page written */
+  uint32_t Seq;         /* Sequence number of the active page */
+  uint32_t WritePos;    /* Offset of the next record in the active page */
+  uint32_t Index[KV_STORE_KEY_NBR];     /* Offset from Base of the last record of each key, 0 if none */
+  KV_STORE_Stats_t Stats;
+} KV_STORE_t;
+
+/* Exported functions ------------------------------------------------------- */
+int32_t KV_STORE_Init(KV_STORE_t *pStore, const KV_STORE_Flash_t *pFlash, uintptr_t Base, uint32_t PageNbr);
+int32_t KV_STORE_Read(const KV_STORE_t *pStore, uint16_t Key, void *pData, uint16_t Size, uint16_t *pLength);
+int32_t KV_STORE_Write(KV_STORE_t *pStore, uint16_t Key, const void *pData, uint16_t Length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KV_STORE_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,190 @@
+/******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2016 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+/*
+ *      PROJECT:
+ *      $Revision: $
+ *      LANGUAGE:  ANSI C
+ */
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief Lock-free log ring declaration file
+ *
+ */
+
+/*!
+ *
+ * Byte ring holding the log records until the UART takes them.
+ *
+ * Any context, thread or interrupt, can put a record: space is reserved
+ * with a LDREX/STREX compare and swap on the head, then the record is
+ * written and committed by storing its position in its header. There is
+ * a single consumer at a time, which copies whole committed records out
+ * of the ring, typically into a DMA buffer, and frees their space.
+ *
+ * When the ring is full the record is dropped, or the oldest committed
+ * records are dropped to make room, depending on the policy.
+ *
+ */
+
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "platform.h"
+#include "st_errno.h"
+
+/*
+******************************************************************************
+* DEFINES
+******************************************************************************
+*/
+#define LOG_RING_DROP_NEWEST    0U      /*!< Full ring: drop the record being put            */
+#define LOG_RING_DROP_OLDEST    1U      /*!< Full ring: drop the oldest records to make room */
+
+#define LOG_RING_HEADER_LEN     8U      /*!< Record header: position, length and flags       */
+#define LOG_RING_ALIGN          8U      /*!< Record alignment in the ring                    */
+
+/*
+******************************************************************************
+* TYPES
+******************************************************************************
+*/
+
+/*! Log ring statistics */
+typedef struct
+{
+    uint32_t records;       /*!< Records put                                 */
+    uint32_t bytes;         /*!< Bytes put                                   */
+    uint32_t droppedNewest; /*!< Records dropped because the ring was full   */
+    uint32_t droppedOldest; /*!< Records dropped to make room                */
+    uint32_t droppedLong;   /*!< Records longer than the consumer buffer     */
+    uint32_t taken;         /*!< Records taken by the consumer               */
+} logRingStats;
+
+/*! Log ring */
+typedef struct
+{
+    uint8_t           *buf;     /*!< Ring storage, LOG_RING_ALIGN aligned         */
+    uint32_t           size;    /*!< Ring size, a power of two                    */
+    uint8_t            policy;  /*!< LOG_RING_DROP_NEWEST or LOG_RING_DROP_OLDEST */
+    volatile uint32_t  head;    /*!< Next position to reserve, free running       */
+    volatile uint32_t  tail;    /*!< Oldest record, free running                  */
+    volatile uint32_t  owner;   /*!< A consumer is active                         */
+    logRingStats       stats;   /*!< Statistics                                   */
+} logRing;
+
+/*
+******************************************************************************
+* FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ *  \brief  Initialize a log ring
+ *
+ *  \param[out] ring   : ring
+ *  \param[in]  buf    : storage, LOG_RING_ALIGN aligned
+ *  \param[in]  size   : storage size, a power of two
+ *  \param[in]  policy : LOG_RING_DROP_NEWEST or LOG_RING_DROP_OLDEST
+ *
+ *  \return ERR_NONE  : ring ready
+ *  \return ERR_PARAM : invalid storage
+ *****************************************************************************
+ */
+extern ReturnCode logRingIni(logRing *ring, uint8_t *buf, uint32_t size, uint8_t policy);
+
+/*!
+ *****************************************************************************
+ *  \brief  Put a record
+ *
+ *  Does not block. Can be called from any context.
+ *
+ *  \param[in,out] ring : ring
+ *  \param[in]     data : record
+ *  \param[in]     len  : record length, up to logRingMaxLen()
+ *
+ *  \return ERR_NONE  : record put
+ *  \return ERR_NOMEM : ring full, record dropped
+ *  \return ERR_PARAM : record too long
+ *****************************************************************************
+ */
+extern ReturnCode logRingPut(logRing *ring, const uint8_t *data, uint16_t len);
+
+/*!
+ *****************************************************************************
+ *  \brief  Longest record
+ *
+ *  \param[in] ring : ring
+ *
+ *  \return longest record accepted by logRingPut()
+ *****************************************************************************
+ */
+extern uint16_t logRingMaxLen(const logRing *ring);
+
+/*!
+ *****************************************************************************
+ *  \brief  Become the consumer
+ *
+ *  \param[in,out] ring : ring
+ *
+ *  \return true  : the caller is the consumer until logRingRelease()
+ *  \return false : another context is the consumer
+ *****************************************************************************
+ */
+extern bool logRingAcquire(logRing *ring);
+
+/*!
+ *****************************************************************************
+ *  \brief  Take records out of the ring
+ *
+ *  Copies whole records, oldest first, as long as they fit in dst, and
+ *  frees their space. A record longer than dst is dropped, so it cannot
+ *  block the ring. Only the consumer can call it.
+ *
+ *  \param[in,out] ring   : ring
+ *  \param[out]    dst    : destination
+ *  \param[in]     dstLen : destination size
+ *
+ *  \return bytes copied, 0 when no record is committed
+ *****************************************************************************
+ */
+extern uint16_t logRingGet(logRing *ring, uint8_t *dst, uint16_t dstLen);
+
+/*!
+ *****************************************************************************
+ *  \brief  Stop being the consumer
+ *
+ *  \param[in,out] ring : ring
+ *
+ *  \return true : a record was committed meanwhile, acquire the ring again
+ *****************************************************************************
+ */
+extern bool logRingRelease(logRing *ring);
+
+#endif /* LOG_RING_H */
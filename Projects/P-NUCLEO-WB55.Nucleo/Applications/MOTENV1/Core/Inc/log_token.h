@@ -0,0 +1,129 @@
+/******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2016 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+/*
+ *      PROJECT:
+ *      $Revision: $
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief Tokenized log declaration file
+ *
+ */
+
+/*!
+ *
+ * With LOGGER_TOKENIZED, platformLog() does not format its text on the
+ * target. The format string is placed by the linker in the .log_str
+ * section, which is the string table, and its offset in the section is
+ * the token. A call emits a binary record holding the token and the raw
+ * arguments:
+ *
+ *   LOG_TOKEN_SYNC | length | token, LSB first | arguments
+ *
+ * The length counts the bytes following it. The arguments follow the
+ * conversions of the format:
+ * - integers: varint, zigzag for the signed conversions %d and %i
+ * - %s: varint of the length shifted left by one, then the bytes; the low
+ *   bit is set for a byte array from hex2Str(), to be dumped in hex
+ * - floating point: float, LSB first
+ * - a '*' width or precision: zigzag varint
+ *
+ * Tools/log_token_decode.py rebuilds the text from the records and the
+ * .log_str section of the ELF file. Bytes outside of records, such as the
+ * BLE traces sharing the UART, are passed through.
+ *
+ */
+
+#ifndef LOG_TOKEN_H
+#define LOG_TOKEN_H
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdint.h>
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#define LOG_TOKEN_SYNC          0xA5U   /*!< First byte of a record                          */
+#define LOG_TOKEN_HEX           0x01U   /*!< First byte of a hex2Str() result, raw bytes follow */
+#define LOG_TOKEN_MAX_LEN       128U    /*!< Longest record, arguments are truncated beyond  */
+
+#if defined(__ICCARM__)
+#define LOG_TOKEN_SECTION       _Pragma("location=\".log_str\"")                  /*!< Place the next format in the string table */
+#else
+#define LOG_TOKEN_SECTION       __attribute__((section(".log_str")))              /*!< Place the next format in the string table */
+#endif
+
+/*!
+ *****************************************************************************
+ *  \brief  Tokenized log
+ *
+ *  Same arguments as logUsart(); the format must be a string literal.
+ *
+ *****************************************************************************
+ */
+#define logToken(...)                                                                             \
+    do                                                                                            \
+    {                                                                                             \
+        LOG_TOKEN_SECTION static const char logTokenFmt[] = LOG_TOKEN_FIRST( __VA_ARGS__ );       \
+        logTokenWrite( logTokenFmt LOG_TOKEN_REST( __VA_ARGS__ ) );                               \
+    } while(0)
+
+/* Split the format from the arguments, up to 16 arguments */
+#define LOG_TOKEN_FIRST( ... )                  LOG_TOKEN_FIRST_( __VA_ARGS__, 0 )
+#define LOG_TOKEN_FIRST_( first, ... )          first
+#define LOG_TOKEN_REST( ... )                   LOG_TOKEN_REST_( LOG_TOKEN_NUM( __VA_ARGS__ ), __VA_ARGS__ )
+#define LOG_TOKEN_REST_( n, ... )               LOG_TOKEN_REST__( n, __VA_ARGS__ )
+#define LOG_TOKEN_REST__( n, ... )              LOG_TOKEN_REST_##n( __VA_ARGS__ )
+#define LOG_TOKEN_REST_ONE( first )
+#define LOG_TOKEN_REST_MORE( first, ... )       , __VA_ARGS__
+#define LOG_TOKEN_NUM( ... )                    LOG_TOKEN_18TH( __VA_ARGS__, MORE, MORE, MORE, MORE, MORE, MORE, MORE, MORE, MORE, MORE, MORE, MORE, MORE, MORE, MORE, MORE, ONE, 0 )
+#define LOG_TOKEN_18TH( a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, ... )   a18
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ *  \brief  Emit a tokenized log record
+ *
+ *  Walks the format to take the arguments, encodes them and queues the
+ *  record with logUsartTx(). Called through logToken().
+ *
+ *  \param[in] fmt : format, in the .log_str section
+ *
+ *****************************************************************************
+ */
+extern void logTokenWrite(const char *fmt, ...);
+
+#endif /* LOG_TOKEN_H */
@@ -65,15 +65,60 @@
 
 #define LLCP_CONNECTION_MAX         7U /*!< Number of simultaneous services bound */
 
+#ifndef LLCP_MIU
+#define LLCP_MIU                    128U  /*!< Local MIU, SDU size of the service buffers, 128 to 244 */
+#endif
+
+#ifndef LLCP_RW
+#define LLCP_RW                     4U    /*!< Local RW and I PDU transmit queue length: 1, 2, 4 or 8 */
+#endif
+
+#ifndef LLCP_LTO
+#define LLCP_LTO                    500U  /*!< Local Link Timeout [ms], multiple of 10 */
+#endif
+
+#define LLCP_SYMM_DELAY_MIN         2U    /*!< First SYMM delay once the link is idle [ms]          */
+#define LLCP_SYMM_DELAY_MAX         50U   /*!< SYMM delay cap, the link stays far below LLCP_LTO [ms] */
+
+#define LLCP_PENDING_MAX            4U    /*!< DM and SDRES waiting to be sent by the link manager  */
+
+#define LLCP_MIU_DEFAULT            128U  /*!< MIU when no MIUX parameter is given  LLCP 1.1 5.2.2 */
+#define LLCP_LTO_DEFAULT            100U  /*!< LTO when no LTO parameter is given [ms]             */
+
 #define PDU_HEADER_LENGTH           2U /*!< PDU Header length  */
+#define PDU_SEQUENCE_LENGTH         1U /*!< Sequence field length of I, RR and RNR PDU */
+#define PDU_AGF_LENGTH_LENGTH       2U /*!< Length field of a PDU encapsulated in an AGF */
+
+#define LLCP_FRAME_LENGTH           (PDU_HEADER_LENGTH + PDU_SEQUENCE_LENGTH + LLCP_MIU) /*!< Longest frame sent or received */
+
+#define LLCP_BUFFER_LENGTH          LLCP_MIU /*!< LLCP Buffer length */
 
-#define LLCP_BUFFER_LENGTH          sizeof(rfalNfcDepBufFormat) /*!< LLCP Buffer length */
+#define LLCP_SAP_LLC                0x00U /*!< Link management SAP          */
+#define LLCP_SAP_SDP                0x01U /*!< Service Discovery SAP        */
+#define LLCP_SAP_SNEP               0x04U /*!< Well-known SNEP SAP          */
+#define LLCP_SAP_SDP_FIRST          0x10U /*!< First SAP registered in SDP  */
+#define LLCP_SAP_FIRST              0x20U /*!< First SAP not registered     */
+#define LLCP_SAP_MAX                0x3FU /*!< Last SAP                     */
 
 #define LLCP_DM_REASON_DISC_RECEIVED        0x00U
 #define LLCP_DM_REASON_NO_ACTIVE_CONNECTION 0x01U
 #define LLCP_DM_REASON_NO_BOUND_SERVICE     0x02U
 #define LLCP_DM_REASON_REJECTED             0x03U
 
+#define LLCP_FRMR_LENGTH            4U    /*!< FRMR information field length          */
+#define LLCP_FRMR_FLAG_W            0x80U /*!< FRMR W: malformed or unexpected PDU     */
+#define LLCP_FRMR_FLAG_I            0x40U /*!< FRMR I: information field exceeds MIU   */
+#define LLCP_FRMR_FLAG_R            0x20U /*!< FRMR R: invalid N(R)                    */
+#define LLCP_FRMR_FLAG_S            0x10U /*!< FRMR S: invalid N(S)                    */
+
+#if (LLCP_RW != 1U) && (LLCP_RW != 2U) && (LLCP_RW != 4U) && (LLCP_RW != 8U)
+    #error "LLCP_RW must divide the sequence number space"
+#endif
+
+#if (LLCP_MIU < LLCP_MIU_DEFAULT) || (LLCP_MIU > 244U)
+    #error "LLCP_MIU does not fit in a NFC-DEP frame"
+#endif
+
 /*
  ******************************************************************************
  * GLOBAL TYPES
@@ -127,11 +172,22 @@ typedef enum
 typedef struct llcpServiceStruct llcpService;
 
 
-/*! LLCP Service structure */
+/*! LLCP Service structure
+ *
+ * notifyCb is called with:
+ *  - LLCP_PDU_CONNECT : a remote service connected, no data
+ *  - LLCP_PDU_CC      : the connection requested by llcpConnect() is complete, no data
+ *  - LLCP_PDU_DM      : connection refused or closed, data is the DM reason
+ *  - LLCP_PDU_DISC    : remote service disconnected, link lost or FRMR sent, no data
+ *  - LLCP_PDU_UI      : UI SDU received, to be returned with llcpUiBufferProcessed()
+ *  - LLCP_PDU_I       : I SDU received, to be returned with llcpIBufferProcessed()
+ *  - LLCP_PDU_RR      : I PDU acknowledged, the transmit queue has room
+ *  - LLCP_PDU_SNL     : service name lookup answer, data is the SAP (0: unknown)
+ */
 typedef struct
 {
     const uint8_t*   uri;       /*<! Local URI         */
-    uint8_t          SAP;       /*<! SAP               */
+    uint8_t          SAP;       /*<! SAP, 0 to have one assigned */
     llcpServiceClass Class;     /*<! Class             */
                                 /*!< Callback the client whenever an event is received (UI, I buffer, CC) */
     ReturnCode       (*notifyCb)(llcpService* service, llcpPdu pdu, const uint8_t* rxBuffer, uint16_t rxBufferLength);
@@ -147,43 +203,53 @@ typedef struct
     uint8_t  V_RA; /*!< V(RA) Receive Acknowledgement State Variable */
 } llcpStateVariables;
 
+
+/*! LLCP Service Data Unit buffer */
+typedef struct
+{
+    uint8_t  buffer[LLCP_BUFFER_LENGTH];  /*!< SDU                     */
+    uint16_t length;                      /*!< SDU length              */
+} llcpSdu;
+
+
 /*! LLCP Service Configuration */
 typedef struct llcpServiceStruct
 {
     llcpServiceConfig SSAP; /*!< SSAP Source Service Access Point       */
     uint8_t  DSAP;       /*!< DSAP Destination Service Access Point  */
+    bool     bound;      /*!< True while the service is bound        */
 
     uint8_t  TID;        /*!< TID (Transport ID)                     */
 
-    uint8_t RW;          /*!< RW (Receive Window Size, for I PDU)    */
+    uint8_t  RW;         /*!< RW(R) Remote Receive Window Size, for I PDU */
+    uint16_t MIU;        /*!< MIU(R) Remote MIU of the connection    */
 
     bool connected;      /*!< True when service is connected         */
+    bool remoteBusy;     /*!< RNR received, no I PDU to send         */
+    bool localBusy;      /*!< RNR sent                               */
 
     llcpStateVariables state; /*!< State variables for I PDU         */
 
-    /* buffer */
-    uint8_t  txBuffer[LLCP_BUFFER_LENGTH];    /*!< txBuffer             */
-    uint16_t txBufferLength;                  /*!< txBufferLength       */
+    /* I buffers: sent unacknowledged SDUs, then queued ones, in order from V(SA) */
+    llcpSdu  txI[LLCP_RW];                   /*!< I PDU transmit queue                  */
+    uint8_t  txICnt;                         /*!< SDUs in the transmit queue            */
 
-    /* UI buffer */
-    uint8_t  txUiBuffer[LLCP_BUFFER_LENGTH];  /*!< txUiBuffer           */
-    uint16_t txUiBufferLength;                /*!< txUiBufferLength     */
+    llcpSdu  rxI[LLCP_RW];                   /*!< I PDU receive window                  */
+    uint8_t  rxIHead;                        /*!< Oldest SDU received                   */
+    uint8_t  rxICnt;                         /*!< SDUs received not processed yet       */
+    bool     rxIBufferAtUser;                /*!< true while the user hasn't returned it  */
 
-    uint8_t  rxUiBuffer[LLCP_BUFFER_LENGTH];  /*!< rxUiBuffer           */
-    uint16_t rxUiBufferLength;                /*!< rxUiBufferLength     */
-    bool     rxUiBufferAtUser;                /*!< true while the user hasn't returned it */
+    /* UI buffers */
+    llcpSdu  txUi;                           /*!< UI SDU to send, length 0 when none    */
+    uint8_t  txUiDSAP;                       /*!< Destination of txUi                   */
 
-    /* I buffer */
-    uint8_t  txIBuffer[LLCP_BUFFER_LENGTH];  /*!< txIBuffer             */
-    uint16_t txIBufferLength;                /*!< txIBufferLength       */
+    llcpSdu  rxUi;                           /*!< UI SDU received                       */
+    bool     rxUiBufferAtUser;               /*!< true while the user hasn't returned it */
 
-    uint8_t  rxIBuffer[LLCP_BUFFER_LENGTH];  /*!< rxIBuffer             */
-    uint16_t rxIBufferLength;                /*!< rxIBufferLength       */
-    bool     rxIBufferAtUser;                /*!< true while the user hasn't returned it  */
-
-    uint8_t* txBuf;       /*!< Pointer to the buffer to send, either UI or I txBuffer        */
-    uint16_t txBufLength; /*!< txBufLength                                                   */
-    llcpPdu  nextPdu;     /*!< Next PDU that will be sent by the llcpWorker for this service */
+    const uint8_t* uri;   /*!< URI to connect to, or to look up     */
+    uint8_t  reason;      /*!< DM reason to send                    */
+    uint8_t  frmr[LLCP_FRMR_LENGTH]; /*!< FRMR information field to send */
+    llcpPdu  nextPdu;     /*!< Next control PDU that will be sent by the llcpWorker for this service, SYMM for none */
 } llcpService;
 
 
@@ -215,6 +281,30 @@ typedef enum
 } llcpWorkerState;
 
 
+/*! DM or SDRES to be sent by the link manager */
+typedef struct
+{
+    uint8_t DSAP;       /*!< DM: destination, SDRES: TID     */
+    uint8_t SSAP;       /*!< DM: source,      SDRES: SAP     */
+    uint8_t reason;     /*!< DM reason                       */
+} llcpPending;
+
+
+/*! LLCP link statistics */
+typedef struct
+{
+    uint32_t frames;    /*!< Frames sent                     */
+    uint32_t symm;      /*!< SYMM sent                       */
+    uint32_t agf;       /*!< AGF sent                        */
+    uint32_t pdus;      /*!< PDUs sent, SYMM excluded        */
+    uint32_t iTx;       /*!< I PDUs sent                     */
+    uint32_t iRx;       /*!< I PDUs received                 */
+    uint32_t rnr;       /*!< RNR sent                        */
+    uint32_t frmr;      /*!< FRMR sent, connection closed    */
+    uint32_t dropped;   /*!< PDUs received and discarded     */
+} llcpStats;
+
+
 /*! LLCP server Configuration */
 typedef struct
 {
@@ -226,24 +316,32 @@ typedef struct
 
     llcpService service[LLCP_CONNECTION_MAX]; /*!< Connection-oriented */
 
-    llcpService* serviceSAP0; /*!< Link Management Service     */
-    llcpService* serviceSAP1; /*!< Service Name Lookup Service */
-
     uint8_t  TID;       /*!< TID (Transport ID) */
 
-    uint16_t MIU;       /*!< MIU Maximum Information Unit */
+    uint16_t MIU;       /*!< MIU Maximum Information Unit of the link, remote */
+    uint16_t LTO;       /*!< Link Timeout of the remote [ms] */
 
     llcpWorkerState state;
+    ReturnCode      err;        /*!< Error that stopped the link */
 
-    /* Buffer to send */
-    uint8_t* txBuf;       /*!< Pointer to the buffer to send */
-    uint16_t txBufLength; /*!< Length of the buffer to send  */
+    /* Frame to send */
+    uint8_t  txFrame[PDU_HEADER_LENGTH + PDU_AGF_LENGTH_LENGTH + LLCP_FRAME_LENGTH]; /*!< Frame to send, room for an AGF header */
+    uint16_t txFrameLength;              /*!< Length of the frame     */
 
     uint8_t*  rxRfalBuffer;       /*<! Pointer to RFAL Rx buffer        */
     uint16_t* rxRfalBufferLength; /*<! Pointer to RFAL Rx buffer length */
 
-    /* Internal Buffer */
-    uint8_t PDU_SYMM[PDU_HEADER_LENGTH];
+    llcpPending dm[LLCP_PENDING_MAX];     /*!< DM to send             */
+    uint8_t     dmCnt;                    /*!< Number of DM to send   */
+    llcpPending sdres[LLCP_PENDING_MAX];  /*!< SDRES to send          */
+    uint8_t     sdresCnt;                 /*!< Number of SDRES to send */
+
+    uint8_t  nextService;   /*!< Service served first in the next frame  */
+    bool     peerActive;    /*!< Last frame received was not a SYMM      */
+    uint32_t symmDelay;     /*!< Current SYMM delay [ms]                 */
+    uint32_t symmTimer;     /*!< Time to send the next SYMM              */
+
+    llcpStats stats;        /*!< Link statistics */
 } llcpServer;
 
 
@@ -266,14 +364,35 @@ typedef struct
 ReturnCode llcpInit(void);
 
 
+/*!
+ *****************************************************************************
+ * Get the LLCP General Bytes
+ *
+ * This function builds the General Bytes to be given to the ATR_REQ
+ * (rfalNfcDiscoverParam.GB) or the ATR_RES: LLCP magic number followed by
+ * the VERSION, MIUX, WKS, LTO and OPT parameters of the server.
+ *
+ * \param[out] gb    : General Bytes
+ * \param[in]  gbLen : size of gb
+ *
+ * \return length of the General Bytes, 0 if gb is too small
+ *****************************************************************************
+ */
+uint8_t llcpGetGeneralBytes(uint8_t* gb, uint8_t gbLen);
+
+
 /*!
  *****************************************************************************
  * Activate the LLCP
  *
- * This function activates the LLCP
+ * This function activates the LLCP on a NFC-DEP device: it negotiates the
+ * link parameters (version, MIU, LTO) from the remote General Bytes, and
+ * resets all the bound services.
  *
  * \param[in] nfcDevice
  *
+ * \return ERR_PROTO  : no LLCP magic number or incompatible version
+ *
  * \return ERR_NONE if successful or a standard error code
  *****************************************************************************
  */
@@ -400,7 +519,7 @@ ReturnCode llcpSendUI(llcpService* service, uint8_t DSAP, const uint8_t* txBuffe
  *****************************************************************************
  * Check available RW
  *
- * This function checks whether RW is enough to send an I PDU.
+ * This function checks whether the I PDU transmit queue has room.
  *
  * \param[in] service to use to send information
  *
@@ -414,7 +533,9 @@ bool llcpCheckAvailableRW(llcpService* service);
  *****************************************************************************
  * LLCP Send Information
  *
- * This function sends a numbered buffer. LLCP must be previously connected.
+ * This function queues a numbered buffer. LLCP must be previously connected.
+ * Up to LLCP_RW buffers can be queued, they are sent as the remote receive
+ * window allows.
  *
  * \param[in] service to use to send information
  * \param[in] txBuffer
@@ -462,6 +583,11 @@ ReturnCode llcpIBufferProcessed(llcpService* service);
  *
  * Must call the worker in a loop, to keep the LLCP connection active.
  *
+ * Every frame carries all the PDUs pending on the link that fit, in an AGF
+ * when there are several. When the link is idle the Initiator sends SYMM
+ * with a delay doubling from LLCP_SYMM_DELAY_MIN to LLCP_SYMM_DELAY_MAX; it
+ * exchanges back-to-back as long as either side has data.
+ *
  * \return ERR_NONE if successful or a standard error code
  *****************************************************************************
  */
@@ -475,12 +601,25 @@ void llcpWorker(void);
  * Call the llcpWorker until it turns ready. This ensures the underliying RFAL 
  * processing completed.
  *
- * \return ERR_NONE if successful or a standard error code
+ * \return ERR_BUSY        : frame exchange ongoing
+ * \return ERR_WRONG_STATE : LLCP not activated
+ * \return ERR_NONE        : ready
+ * \return other           : error that deactivated the link
  *****************************************************************************
  */
 ReturnCode llcpWorkerGetStatus(void);
 
 
+/*!
+ *****************************************************************************
+ * Get LLCP link statistics
+ *
+ * \param[out] stats : statistics since the last llcpActivate()
+ *****************************************************************************
+ */
+void llcpGetStats(llcpStats* stats);
+
+
 #endif
 
 /**
@@ -0,0 +1,225 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief SNEP 1.0 client and server over LLCP
+ *
+ *  Simple NDEF Exchange Protocol on the LLCP connection oriented transport:
+ *  - a request or response larger than the connection MIU is split in
+ *    fragments; the first one holds the SNEP header, the others are only
+ *    sent once the peer answered CONTINUE, and none is sent after REJECT
+ *  - the message to send is read in place from the caller buffer (e.g. the
+ *    output of ndefMessageEncode(), or a message in flash), only the first
+ *    fragment is copied
+ *  - an incoming NDEF message is handed to a snepSink fragment by fragment,
+ *    so it never needs to be held whole in RAM; a sink that cannot take a
+ *    fragment yet keeps the peer waiting through the LLCP receive window
+ *
+ *  The server is bound to the well-known SNEP SAP. A server with no GET
+ *  handler answers NOT IMPLEMENTED, as the default SNEP server does.
+ *
+ */
+
+#ifndef NFC_SNEP_H
+#define NFC_SNEP_H
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+
+#include "platform.h"
+#include "st_errno.h"
+#include "ndef_buffer.h"
+#include "nfc_llcp.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define SNEP_VERSION                   0x10U   /*!< SNEP 1.0                                       */
+#define SNEP_VERSION_MAJOR_MASK        0xF0U   /*!< Major version bits                             */
+#define SNEP_HEADER_LENGTH             6U      /*!< Version, code, 4 bytes information length     */
+#define SNEP_ACCEPTABLE_LENGTH_LENGTH  4U      /*!< Acceptable length in a GET request            */
+
+#define SNEP_SERVICE_NAME              "urn:nfc:sn:snep"  /*!< Well-known SNEP service name      */
+
+/* Request codes */
+#define SNEP_REQ_CONTINUE              0x00U   /*!< Send the remaining fragments                   */
+#define SNEP_REQ_GET                   0x01U   /*!< Return an NDEF message                         */
+#define SNEP_REQ_PUT                   0x02U   /*!< Accept an NDEF message                         */
+#define SNEP_REQ_REJECT                0x7FU   /*!< Do not send the remaining fragments            */
+
+/* Response codes */
+#define SNEP_RES_CONTINUE              0x80U   /*!< Send the remaining fragments                   */
+#define SNEP_RES_SUCCESS               0x81U   /*!< Operation succeeded                            */
+#define SNEP_RES_NOT_FOUND             0xC0U   /*!< Resource not found                             */
+#define SNEP_RES_EXCESS_DATA           0xC1U   /*!< Resource exceeds the acceptable length         */
+#define SNEP_RES_BAD_REQUEST           0xC2U   /*!< Malformed request                              */
+#define SNEP_RES_NOT_IMPLEMENTED       0xE0U   /*!< Unsupported functionality requested            */
+#define SNEP_RES_UNSUPPORTED_VERSION   0xE1U   /*!< Unsupported protocol version                   */
+#define SNEP_RES_REJECT                0xFFU   /*!< Do not send the remaining fragments            */
+
+/*
+ ******************************************************************************
+ * GLOBAL TYPES
+ ******************************************************************************
+ */
+
+/*! Receiver of an incoming NDEF message
+ *
+ * begin() is called with the request or response code and the NDEF message
+ * length; anything but ERR_NONE refuses the message. data() then gets the
+ * message bytes in order; ERR_BUSY leaves the bytes with the sink, which is
+ * called again with them from snepWorker(), any other error aborts. end()
+ * closes every accepted message, with ERR_NONE once all bytes were taken.
+ */
+typedef struct
+{
+    ReturnCode (*begin)( uint8_t code, uint32_t length );       /*!< Message start      */
+    ReturnCode (*data)( const uint8_t *buf, uint16_t len );     /*!< Message bytes      */
+    void       (*end)( ReturnCode err );                        /*!< Message end        */
+} snepSink;
+
+/*! SNEP server configuration */
+typedef struct
+{
+    const snepSink *sink;                                       /*!< Receiver of PUT and GET request messages, NULL: PUT not implemented */
+    ReturnCode (*getResponse)( ndefConstBuffer *message );      /*!< Answer to the GET request just received, NULL: GET not implemented;
+                                                                     ERR_NOTFOUND answers NOT FOUND                                       */
+} snepServerConfig;
+
+/*! SNEP statistics */
+typedef struct
+{
+    uint32_t requests;    /*!< Requests completed, sent or served           */
+    uint32_t fragTx;      /*!< Fragments sent                               */
+    uint32_t fragRx;      /*!< Fragments received                           */
+    uint32_t sinkBusy;    /*!< Fragments a sink asked to be given again     */
+    uint32_t rejected;    /*!< Transfers refused or aborted                 */
+} snepStats;
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+
+/*!
+ *****************************************************************************
+ * \brief Bind the SNEP client
+ *
+ * To be called after llcpInit() and before llcpGetGeneralBytes()
+ *
+ * \return ERR_NONE or the llcpBindService() error
+ *****************************************************************************
+ */
+ReturnCode snepClientIni( void );
+
+/*!
+ *****************************************************************************
+ * \brief Bind the SNEP server on the well-known SNEP SAP
+ *
+ * To be called after llcpInit() and before llcpGetGeneralBytes()
+ *
+ * \param[in] config : server configuration, kept by reference
+ *
+ * \return ERR_NONE or the llcpBindService() error
+ *****************************************************************************
+ */
+ReturnCode snepServerIni( const snepServerConfig *config );
+
+/*!
+ *****************************************************************************
+ * \brief Send a PUT request
+ *
+ * The client connects to the remote SNEP server first if needed. The link
+ * must be activated.
+ *
+ * \param[in] message : encoded NDEF message, to be kept until completion
+ *
+ * \return ERR_NONE      : request started, see snepClientGetStatus()
+ * \return ERR_BUSY      : a request is ongoing
+ * \return ERR_PARAM     : invalid message
+ *****************************************************************************
+ */
+ReturnCode snepClientPut( const ndefConstBuffer *message );
+
+/*!
+ *****************************************************************************
+ * \brief Send a GET request
+ *
+ * The NDEF message of the response is handed to sink.
+ *
+ * \param[in] request          : encoded NDEF message identifying the resource,
+ *                               to be kept until completion
+ * \param[in] acceptableLength : longest response message accepted
+ * \param[in] sink             : receiver of the response message
+ *
+ * \return ERR_NONE      : request started, see snepClientGetStatus()
+ * \return ERR_BUSY      : a request is ongoing
+ * \return ERR_PARAM     : invalid parameter
+ *****************************************************************************
+ */
+ReturnCode snepClientGet( const ndefConstBuffer *request, uint32_t acceptableLength, const snepSink *sink );
+
+/*!
+ *****************************************************************************
+ * \brief Get the status of the last client request
+ *
+ * \return ERR_BUSY      : request ongoing
+ * \return ERR_NONE      : SUCCESS
+ * \return ERR_NOTFOUND  : NOT FOUND, or no SNEP server on the peer
+ * \return ERR_NOMEM     : EXCESS DATA, or the response was refused by the sink
+ * \return ERR_NOTSUPP   : NOT IMPLEMENTED or UNSUPPORTED VERSION
+ * \return ERR_REQUEST   : BAD REQUEST or REJECT
+ * \return ERR_PROTO     : malformed response
+ * \return ERR_LINK_LOSS : connection lost
+ *****************************************************************************
+ */
+ReturnCode snepClientGetStatus( void );
+
+/*!
+ *****************************************************************************
+ * \brief SNEP worker
+ *
+ * Sends the fragments the LLCP transmit queue had no room for and gives
+ * the sinks the bytes they were busy for. To be called with llcpWorker().
+ *****************************************************************************
+ */
+void snepWorker( void );
+
+/*!
+ *****************************************************************************
+ * \brief Get the SNEP statistics
+ *
+ * \param[out] stats : statistics since snepClientIni() or snepServerIni()
+ *****************************************************************************
+ */
+void snepGetStats( snepStats *stats );
+
+#endif /* NFC_SNEP_H */
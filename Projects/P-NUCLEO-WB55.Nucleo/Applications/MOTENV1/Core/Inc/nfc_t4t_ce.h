@@ -0,0 +1,161 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief Type 4 Tag emulation engine
+ *
+ *  Serves the NDEF Tag Application (T4T version 2.0) from two file images:
+ *  - the CC file, built by t4tCeIni()
+ *  - the NDEF file, NLEN followed by the NDEF message, in RAM or in flash
+ *
+ *  C-APDUs are dispatched through constant tables indexed by INS, so the
+ *  cost of an APDU does not depend on which command it is. The response
+ *  data of READ BINARY is not copied: t4tCeProcess() returns a pointer in
+ *  the file image, to be sent with the status word.
+ *
+ */
+
+#ifndef NFC_T4T_CE_H
+#define NFC_T4T_CE_H
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+
+#include "platform.h"
+#include "st_errno.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#ifndef T4T_CE_MLE
+#define T4T_CE_MLE                     246U    /*!< Longest R-APDU data field, fits an FSD of 256 with the SW */
+#endif
+#ifndef T4T_CE_MLC
+#define T4T_CE_MLC                     246U    /*!< Longest C-APDU data field                      */
+#endif
+
+#define T4T_CE_CC_FILE_ID              0xE103U /*!< CC file identifier                             */
+#define T4T_CE_NDEF_FILE_ID            0xE104U /*!< NDEF file identifier                           */
+#define T4T_CE_CC_LEN                  15U     /*!< CC file length                                 */
+#define T4T_CE_NLEN_LEN                2U      /*!< NLEN field at the start of the NDEF file       */
+#define T4T_CE_SW_LEN                  2U      /*!< Status word length                             */
+
+/* Status words */
+#define T4T_CE_SW_OK                   0x9000U /*!< Command completed                              */
+#define T4T_CE_SW_WRONG_LENGTH         0x6700U /*!< Lc or Le inconsistent                          */
+#define T4T_CE_SW_NOT_ALLOWED          0x6982U /*!< File not writable                              */
+#define T4T_CE_SW_NO_FILE_SELECTED     0x6986U /*!< No current EF                                  */
+#define T4T_CE_SW_NOT_FOUND            0x6A82U /*!< Application or file not found                  */
+#define T4T_CE_SW_WRONG_P1P2           0x6A86U /*!< Incorrect P1 P2                                */
+#define T4T_CE_SW_WRONG_OFFSET         0x6B00U /*!< Offset outside the file                        */
+#define T4T_CE_SW_INS_NOT_SUPPORTED    0x6D00U /*!< Unknown INS                                    */
+#define T4T_CE_SW_CLA_NOT_SUPPORTED    0x6E00U /*!< Unknown CLA                                    */
+
+/*
+ ******************************************************************************
+ * GLOBAL TYPES
+ ******************************************************************************
+ */
+
+/*! R-APDU: data in place, then the status word */
+typedef struct
+{
+    const uint8_t *data;    /*!< Response data, in a file image, NULL for none  */
+    uint16_t       len;     /*!< Response data length                           */
+    uint16_t       sw;      /*!< Status word                                    */
+} t4tCeResponse;
+
+/*! Emulation statistics */
+typedef struct
+{
+    uint32_t apdus;         /*!< C-APDUs processed                              */
+    uint32_t reads;         /*!< READ BINARY completed                          */
+    uint32_t updates;       /*!< UPDATE BINARY completed                        */
+    uint32_t errors;        /*!< C-APDUs answered with an error status          */
+} t4tCeStats;
+
+/*! Emulated Type 4 Tag */
+typedef struct
+{
+    uint8_t        cc[T4T_CE_CC_LEN];   /*!< CC file image                               */
+    uint8_t       *ndef;                /*!< NDEF file image                             */
+    uint16_t       ndefSize;            /*!< NDEF file size, NLEN included               */
+    bool           readOnly;            /*!< NDEF file cannot be updated                 */
+    bool           appSelected;         /*!< NDEF Tag Application selected               */
+    const uint8_t *file;                /*!< Current EF, NULL for none                   */
+    uint16_t       fileSize;            /*!< Size of the current EF                      */
+    t4tCeStats     stats;               /*!< Statistics                                  */
+} t4tCe;
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+
+/*!
+ *****************************************************************************
+ * \brief Initialize an emulated tag
+ *
+ * \param[out] ce           : tag
+ * \param[in]  ndefFile     : NDEF file image, NLEN then the message; kept by
+ *                            reference, may be in flash when readOnly
+ * \param[in]  ndefFileSize : NDEF file size, NLEN included
+ * \param[in]  readOnly     : the reader cannot update the NDEF file
+ *
+ * \return ERR_NONE  : tag ready
+ * \return ERR_PARAM : NDEF file too small or too large
+ *****************************************************************************
+ */
+ReturnCode t4tCeIni( t4tCe *ce, uint8_t *ndefFile, uint16_t ndefFileSize, bool readOnly );
+
+/*!
+ *****************************************************************************
+ * \brief Deselect the application, as after a new activation
+ *
+ * \param[in,out] ce : tag
+ *****************************************************************************
+ */
+void t4tCeReset( t4tCe *ce );
+
+/*!
+ *****************************************************************************
+ * \brief Process a C-APDU
+ *
+ * \param[in,out] ce    : tag
+ * \param[in]     capdu : C-APDU
+ * \param[in]     len   : C-APDU length
+ * \param[out]    rsp   : R-APDU; data stays valid until the next update of
+ *                        the file
+ *****************************************************************************
+ */
+void t4tCeProcess( t4tCe *ce, const uint8_t *capdu, uint16_t len, t4tCeResponse *rsp );
+
+#endif /* NFC_T4T_CE_H */
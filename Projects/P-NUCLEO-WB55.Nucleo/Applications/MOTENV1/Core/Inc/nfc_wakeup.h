@@ -0,0 +1,233 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief Low power tag detection front end
+ *
+ *  The reader stays in RFAL Wake-Up mode: the ST25R3916 only measures the
+ *  antenna (amplitude, phase and/or capacitance) every wake-up period and
+ *  raises an IRQ when a measure is off its reference by delta or more.
+ *  Full discovery is run only after such a wake-up.
+ *
+ *  The references are kept by a software tracker per measure:
+ *  - the tracker follows slow drifts (temperature, supply) while the reader
+ *    is asleep, by re-measuring the antenna every NFC_WAKEUP_RECAL_PERIOD
+ *  - after a wake-up where discovery finds no device (metal object, hand...)
+ *    the tracker re-baselines on the new antenna measure, so the same
+ *    object does not keep waking the reader up
+ *
+ *  The tracker functions do not access the chip and can be fed with
+ *  measurement traces on a host.
+ *
+ */
+
+#ifndef NFC_WAKEUP_H
+#define NFC_WAKEUP_H
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+
+#include "platform.h"
+#include "st_errno.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define NFC_WAKEUP_MEAS_AMPLITUDE      0U      /*!< Inductive amplitude measure                      */
+#define NFC_WAKEUP_MEAS_PHASE          1U      /*!< Inductive phase measure                          */
+#define NFC_WAKEUP_MEAS_CAPACITANCE    2U      /*!< Capacitive measure (needs sensing electrodes)    */
+#define NFC_WAKEUP_MEAS_NUM            3U      /*!< Number of measures                               */
+
+#define NFC_WAKEUP_REF_FRAC_BITS       4U      /*!< Fractional bits of the tracked references        */
+
+/*
+ ******************************************************************************
+ * GLOBAL TYPES
+ ******************************************************************************
+ */
+
+/*! Reference and delta of one measure */
+typedef struct
+{
+    uint16_t reference;   /*!< Reference, NFC_WAKEUP_REF_FRAC_BITS fractional bits    */
+    uint8_t  delta;       /*!< Deviation from the reference that wakes the reader up  */
+    uint8_t  weight;      /*!< The reference moves by 1/2^weight of the deviation     */
+    bool     valid;       /*!< A reference has been measured                          */
+} nfcWakeupTracker;
+
+/*! Detection statistics */
+typedef struct
+{
+    uint32_t wakes;       /*!< Wake-ups, discovery started                            */
+    uint32_t falseWakes;  /*!< Wake-ups where discovery found no device               */
+    uint32_t recals;      /*!< Periodic reference updates                             */
+    uint32_t rebaselines; /*!< References reset after a false wake-up                 */
+    uint32_t lastLatency; /*!< Wake-up to device activation of the last detection [ms] */
+} nfcWakeupStats;
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+
+/*!
+ *****************************************************************************
+ * \brief Initialize a tracker
+ *
+ * \param[out] tracker : tracker
+ * \param[in]  delta   : deviation that wakes the reader up
+ * \param[in]  weight  : drift tracking weight, the reference moves by
+ *                       1/2^weight of the deviation at each measure
+ *****************************************************************************
+ */
+void nfcWakeupTrackerInit( nfcWakeupTracker *tracker, uint8_t delta, uint8_t weight );
+
+/*!
+ *****************************************************************************
+ * \brief Feed a tracker with a measure taken while no device is expected
+ *
+ * The first measure sets the reference. A measure closer to the reference
+ * than delta is a drift and moves the reference towards it.
+ *
+ * \param[in,out] tracker : tracker
+ * \param[in]     measure : antenna measure
+ *
+ * \return true  : measure is off the reference by delta or more, the
+ *                 reference is left unchanged
+ * \return false : drift, reference updated
+ *****************************************************************************
+ */
+bool nfcWakeupTrackerUpdate( nfcWakeupTracker *tracker, uint8_t measure );
+
+/*!
+ *****************************************************************************
+ * \brief Make a measure the new reference
+ *
+ * \param[in,out] tracker : tracker
+ * \param[in]     measure : antenna measure
+ *****************************************************************************
+ */
+void nfcWakeupTrackerRebaseline( nfcWakeupTracker *tracker, uint8_t measure );
+
+/*!
+ *****************************************************************************
+ * \brief Check whether a measure wakes the reader up, as the chip does
+ *
+ * \param[in] tracker : tracker
+ * \param[in] measure : antenna measure
+ *
+ * \return true when the measure is off the reference by delta or more
+ *****************************************************************************
+ */
+bool nfcWakeupTrackerIsOff( const nfcWakeupTracker *tracker, uint8_t measure );
+
+/*!
+ *****************************************************************************
+ * \brief Get the reference to program in the chip
+ *
+ * \param[in] tracker : tracker
+ *
+ * \return rounded reference
+ *****************************************************************************
+ */
+uint8_t nfcWakeupTrackerReference( const nfcWakeupTracker *tracker );
+
+/*!
+ *****************************************************************************
+ * \brief Initialize the front end
+ *
+ * Must be called once RFAL is initialized
+ *****************************************************************************
+ */
+void nfcWakeupIni( void );
+
+/*!
+ *****************************************************************************
+ * \brief Enter Wake-Up mode
+ *
+ * Measures the antenna, updates the references and starts RFAL Wake-Up
+ * mode with them. When the antenna is already off its references, Wake-Up
+ * mode is not started and nfcWakeupHasWoken() returns true right away.
+ *
+ * \return ERR_NONE : Wake-Up mode started, or wake-up already detected
+ * \return other    : RFAL error, discovery should be run instead
+ *****************************************************************************
+ */
+ReturnCode nfcWakeupStart( void );
+
+/*!
+ *****************************************************************************
+ * \brief Check for a wake-up
+ *
+ * Must be called periodically while in Wake-Up mode, after rfalWorker().
+ * Also updates the references every NFC_WAKEUP_RECAL_PERIOD.
+ *
+ * \return true  : wake-up, Wake-Up mode stopped, discovery shall be run
+ * \return false : still asleep
+ *****************************************************************************
+ */
+bool nfcWakeupHasWoken( void );
+
+/*!
+ *****************************************************************************
+ * \brief Time nfcWakeupHasWoken() can be left uncalled
+ *
+ * While asleep only the ST25R3916 IRQ and the next reference update need
+ * nfcWakeupHasWoken() to be called: the MCU may stop in between.
+ *
+ * \return 0     : a wake-up is pending, call nfcWakeupHasWoken() now
+ * \return other : ms to the next reference update, unless the IRQ fires
+ *****************************************************************************
+ */
+uint32_t nfcWakeupIdleTime( void );
+
+/*!
+ *****************************************************************************
+ * \brief Report the end of the discovery run after a wake-up
+ *
+ * After a wake-up without any device, the next nfcWakeupStart() takes its
+ * antenna measures as the new references.
+ *
+ * \param[in] found : a device has been activated
+ *****************************************************************************
+ */
+void nfcWakeupDiscoveryDone( bool found );
+
+/*!
+ *****************************************************************************
+ * \brief Get the detection statistics
+ *
+ * \param[out] stats : statistics
+ *****************************************************************************
+ */
+void nfcWakeupGetStats( nfcWakeupStats *stats );
+
+#endif /* NFC_WAKEUP_H */
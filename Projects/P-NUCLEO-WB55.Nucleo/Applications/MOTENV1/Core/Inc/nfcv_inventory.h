@@ -0,0 +1,181 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief NFC-V multi-tag inventory and read scheduler
+ *
+ *  Inventory of all the ISO15693 tags (VICCs) in the field:
+ *  - each INVENTORY_REQ is sent in 16 slots mode with a mask; a tag answers
+ *    in the slot given by the 4 UID bits that follow the mask
+ *  - a collision in slot s queues the mask extended with s, to be resolved
+ *    by its own 16 slots request later; the queue is a FIFO so the
+ *    resolution is breadth first and each UID range is inventoried once
+ *  - UIDs are recorded once; when the mask queue overflows, the tags found
+ *    so far are sent to quiet state and the inventory restarts from the
+ *    empty mask
+ *
+ *  The read scheduler then hands the tags out in turn. A tag that fails on
+ *  a transmission error is retried after the others, so a tag at the edge
+ *  of the field does not hold the others until a field reset.
+ *
+ */
+
+#ifndef NFCV_INVENTORY_H
+#define NFCV_INVENTORY_H
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+
+#include "platform.h"
+#include "st_errno.h"
+#include "rfal_nfc.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#ifndef NFCV_INVENTORY_MAX_TAGS
+#define NFCV_INVENTORY_MAX_TAGS        64U     /*!< Tags recorded by one inventory                 */
+#endif
+#define NFCV_INVENTORY_QUEUE_LEN       32U     /*!< Masks waiting for their 16 slots request       */
+#define NFCV_INVENTORY_MAX_PASSES      4U      /*!< Inventories from the empty mask                */
+#define NFCV_INVENTORY_MAX_RETRIES     3U      /*!< Reads of a tag failing on transmission errors  */
+
+#define NFCV_INVENTORY_TAG_PENDING     0U      /*!< Tag not read yet                               */
+#define NFCV_INVENTORY_TAG_READ        1U      /*!< Tag read                                       */
+#define NFCV_INVENTORY_TAG_FAILED      2U      /*!< Tag given up                                   */
+
+/*
+ ******************************************************************************
+ * GLOBAL TYPES
+ ******************************************************************************
+ */
+
+/*! Inventoried tag */
+typedef struct
+{
+    rfalNfcvInventoryRes  invRes;    /*!< INVENTORY_RES of the tag                         */
+    uint8_t               state;     /*!< NFCV_INVENTORY_TAG_xxx                           */
+    uint8_t               tries;     /*!< Reads attempted                                  */
+    bool                  isSleep;   /*!< Sent to quiet state                              */
+} nfcvInventoryTag;
+
+/*! Mask of a UID range still to inventory */
+typedef struct
+{
+    uint8_t  maskLen;                           /*!< Mask length in bits, multiple of 4    */
+    uint8_t  maskVal[RFAL_NFCV_UID_LEN];        /*!< Mask value, UID LSB first             */
+} nfcvInventoryMask;
+
+/*! Inventory statistics */
+typedef struct
+{
+    uint32_t requests;    /*!< 16 slots INVENTORY_REQ sent                  */
+    uint32_t slots;       /*!< Slots run                                    */
+    uint32_t collisions;  /*!< Slots with a collision or a corrupted frame  */
+    uint32_t duplicates;  /*!< Answers from tags already recorded           */
+    uint32_t overflows;   /*!< Collisions dropped on a full mask queue      */
+    uint32_t dropped;     /*!< Tags dropped on a full tag list              */
+    uint32_t passes;      /*!< Inventories from the empty mask              */
+} nfcvInventoryStats;
+
+/*! Inventory and read scheduler context */
+typedef struct
+{
+    nfcvInventoryTag    tag[NFCV_INVENTORY_MAX_TAGS];      /*!< Tags found                 */
+    uint8_t             tagCnt;                            /*!< Number of tags found       */
+    nfcvInventoryMask   queue[NFCV_INVENTORY_QUEUE_LEN];   /*!< Pending masks              */
+    uint8_t             queueHead;                         /*!< First pending mask         */
+    uint8_t             queueCnt;                          /*!< Number of pending masks    */
+    uint8_t             next;                              /*!< Next tag to read           */
+    nfcvInventoryStats  stats;                             /*!< Statistics                 */
+} nfcvInventory;
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+
+/*!
+ *****************************************************************************
+ * \brief Initialize an empty inventory
+ *
+ * \param[out] inv : inventory
+ *****************************************************************************
+ */
+void nfcvInventoryIni( nfcvInventory *inv );
+
+/*!
+ *****************************************************************************
+ * \brief Inventory the tags in the field
+ *
+ * NFC-V poller must be initialized and the field on. Tags already recorded
+ * are kept, so it can be called again to add the tags that came in.
+ *
+ * \param[in,out] inv : inventory
+ *
+ * \return ERR_NONE   : all the UID ranges have been inventoried
+ * \return ERR_NOMEM  : tag list full or mask queue still overflowing after
+ *                      NFCV_INVENTORY_MAX_PASSES, some tags may be missing
+ *****************************************************************************
+ */
+ReturnCode nfcvInventoryRun( nfcvInventory *inv );
+
+/*!
+ *****************************************************************************
+ * \brief Get the next tag to read
+ *
+ * Tags are handed out in turn, starting after the last one handed out.
+ *
+ * \param[in,out] inv : inventory
+ * \param[out]    dev : device to give to ndefPollerContextInitialization()
+ * \param[out]    idx : tag index, for nfcvInventoryReadDone()
+ *
+ * \return true  : a tag is pending
+ * \return false : all tags read or given up
+ *****************************************************************************
+ */
+bool nfcvInventoryNextDevice( nfcvInventory *inv, rfalNfcDevice *dev, uint8_t *idx );
+
+/*!
+ *****************************************************************************
+ * \brief Report the result of a tag read
+ *
+ * A transmission error (timeout, CRC, framing, collision) leaves the tag
+ * pending for a later turn, up to NFCV_INVENTORY_MAX_RETRIES reads.
+ *
+ * \param[in,out] inv : inventory
+ * \param[in]     idx : tag index given by nfcvInventoryNextDevice()
+ * \param[in]     err : result of the read
+ *****************************************************************************
+ */
+void nfcvInventoryReadDone( nfcvInventory *inv, uint8_t idx, ReturnCode err );
+
+#endif /* NFCV_INVENTORY_H */
@@ -0,0 +1,191 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief ST25DV fast transfer mailbox transport
+ *
+ *  Moves data through the ST25DV mailbox instead of the EEPROM: no
+ *  programming time per block and no wear. All the commands are the ST
+ *  Fast variants, the tag answers at 52.97 kbit/s.
+ *
+ *  A transfer is cut in frames of one mailbox message each, a 4 bytes
+ *  header and up to NFCV_MAILBOX_PAYLOAD_LEN bytes of data:
+ *  - type and flags: DATA with FIRST, LAST and ACK_REQ, or ACK
+ *  - transfer identifier
+ *  - sequence number, MSB first: index of the DATA frame in the transfer,
+ *    or for an ACK the next frame expected
+ *
+ *  The sender writes a frame as soon as the mailbox is free, up to
+ *  NFCV_MAILBOX_WINDOW frames; the last one of the window asks for an ACK
+ *  and the sender waits for it, which leaves the mailbox free for the
+ *  receiver. The ACK holds the frame the receiver expects: the sender
+ *  resumes from there. The receiver drops a frame already received and
+ *  answers a frame after a missing one with an ACK as soon as it can. An
+ *  ACK of frame 0 restarts the transfer whatever its identifier, as the
+ *  receiver may have lost the FIRST frame. The LAST frame always asks for
+ *  an ACK, which ends the transfer; without it the sender writes the
+ *  frame again after NFCV_MAILBOX_ACK_TIMEOUT.
+ *  A message the other side did not read before the mailbox watchdog
+ *  (RF_MISS_MSG, HOST_MISS_MSG) is sent again.
+ *
+ *  The mailbox control register is polled with a backoff adapted to the
+ *  pace of the host: a wait starts with the delay the last one needed.
+ *
+ */
+
+#ifndef NFCV_MAILBOX_H
+#define NFCV_MAILBOX_H
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+
+#include "platform.h"
+#include "st_errno.h"
+#include "rfal_nfcv.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define NFCV_MAILBOX_MSG_LEN           255U    /*!< Longest message RFAL writes (MSGLen FFh refused) */
+#define NFCV_MAILBOX_HEADER_LEN        4U      /*!< Frame header length                            */
+#define NFCV_MAILBOX_PAYLOAD_LEN       (NFCV_MAILBOX_MSG_LEN - NFCV_MAILBOX_HEADER_LEN) /*!< Data in a frame */
+
+#define NFCV_MAILBOX_FRAME_DATA        0x10U   /*!< DATA frame                                     */
+#define NFCV_MAILBOX_FRAME_ACK         0x20U   /*!< ACK frame                                      */
+#define NFCV_MAILBOX_FRAME_TYPE_MASK   0xF0U   /*!< Frame type bits                                */
+#define NFCV_MAILBOX_FLAG_FIRST        0x01U   /*!< First DATA frame of a transfer                 */
+#define NFCV_MAILBOX_FLAG_LAST         0x02U   /*!< Last DATA frame of a transfer                  */
+#define NFCV_MAILBOX_FLAG_ACK_REQ      0x04U   /*!< DATA frame to acknowledge                      */
+
+#define NFCV_MAILBOX_MB_CTRL_DYN       0x0DU   /*!< MB_CTRL_Dyn register address                   */
+#define NFCV_MAILBOX_MB_EN             0x01U   /*!< MB_CTRL_Dyn: mailbox enabled                   */
+#define NFCV_MAILBOX_HOST_PUT_MSG      0x02U   /*!< MB_CTRL_Dyn: message put by the host           */
+#define NFCV_MAILBOX_RF_PUT_MSG        0x04U   /*!< MB_CTRL_Dyn: message put by RF                 */
+#define NFCV_MAILBOX_HOST_MISS_MSG     0x10U   /*!< MB_CTRL_Dyn: host message not read by RF       */
+#define NFCV_MAILBOX_RF_MISS_MSG       0x20U   /*!< MB_CTRL_Dyn: RF message not read by the host   */
+
+#ifndef NFCV_MAILBOX_TIMEOUT
+#define NFCV_MAILBOX_TIMEOUT           1000U   /*!< Time without progress before giving up [ms]    */
+#endif
+#ifndef NFCV_MAILBOX_WINDOW
+#define NFCV_MAILBOX_WINDOW            4U      /*!< DATA frames sent before waiting for an ACK     */
+#endif
+#define NFCV_MAILBOX_ACK_TIMEOUT       250U    /*!< Wait for an ACK before writing again [ms]      */
+#define NFCV_MAILBOX_MAX_DELAY         32U     /*!< Longest delay between two polls [ms]           */
+#define NFCV_MAILBOX_MAX_RETRIES       5U      /*!< Transmission errors in a row before giving up  */
+
+/*
+ ******************************************************************************
+ * GLOBAL TYPES
+ ******************************************************************************
+ */
+
+/*! Mailbox statistics */
+typedef struct
+{
+    uint32_t framesTx;    /*!< DATA frames written                          */
+    uint32_t framesRx;    /*!< DATA frames read                             */
+    uint32_t acks;        /*!< ACK frames written or read                   */
+    uint32_t polls;       /*!< MB_CTRL_Dyn reads                            */
+    uint32_t retries;     /*!< Commands failed on transmission errors       */
+    uint32_t resumes;     /*!< Transfers resumed after a lost frame         */
+    uint32_t duplicates;  /*!< DATA frames received twice                   */
+} nfcvMailboxStats;
+
+/*! Mailbox channel with a tag */
+typedef struct
+{
+    uint8_t           uid[RFAL_NFCV_UID_LEN];  /*!< Tag UID, as given by the inventory      */
+    bool              selected;                /*!< Tag selected, requests without the UID  */
+    uint8_t           tid;                     /*!< Identifier of the last transfer sent    */
+    uint16_t          backoff;                 /*!< Delay of the next poll [ms]             */
+    nfcvMailboxStats  stats;                   /*!< Statistics                              */
+} nfcvMailbox;
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+
+/*!
+ *****************************************************************************
+ * \brief Open the mailbox channel with a tag
+ *
+ * NFC-V poller must be initialized and the tag in the field.
+ *
+ * \param[out] mb  : channel
+ * \param[in]  uid : tag UID; the tag is selected, or addressed if it cannot be
+ *
+ * \return ERR_NONE     : mailbox enabled
+ * \return ERR_DISABLED : mailbox not enabled (MB_MODE or MB_EN), or not an ST25DV
+ * \return RFAL error of the MB_CTRL_Dyn read
+ *****************************************************************************
+ */
+ReturnCode nfcvMailboxIni( nfcvMailbox *mb, const uint8_t *uid );
+
+/*!
+ *****************************************************************************
+ * \brief Send data to the host of the tag
+ *
+ * Blocks until the host acknowledged the LAST frame.
+ *
+ * \param[in,out] mb  : channel
+ * \param[in]     buf : data
+ * \param[in]     len : data length, at least 1
+ *
+ * \return ERR_NONE    : all data received by the host
+ * \return ERR_PARAM   : invalid parameter, or more than 65535 frames
+ * \return ERR_TIMEOUT : no ACK for NFCV_MAILBOX_TIMEOUT
+ * \return RFAL error  : NFCV_MAILBOX_MAX_RETRIES transmission errors in a row
+ *****************************************************************************
+ */
+ReturnCode nfcvMailboxSend( nfcvMailbox *mb, const uint8_t *buf, uint32_t len );
+
+/*!
+ *****************************************************************************
+ * \brief Receive data from the host of the tag
+ *
+ * Blocks until the LAST frame of a transfer has been received.
+ *
+ * \param[in,out] mb     : channel
+ * \param[out]    buf    : data
+ * \param[in]     bufLen : size of buf
+ * \param[out]    rcvLen : data length
+ *
+ * \return ERR_NONE    : transfer received
+ * \return ERR_NOMEM   : transfer larger than buf, the rest is dropped
+ * \return ERR_TIMEOUT : no new frame for NFCV_MAILBOX_TIMEOUT
+ * \return RFAL error  : NFCV_MAILBOX_MAX_RETRIES transmission errors in a row
+ *****************************************************************************
+ */
+ReturnCode nfcvMailboxReceive( nfcvMailbox *mb, uint8_t *buf, uint32_t bufLen, uint32_t *rcvLen );
+
+#endif /* NFCV_MAILBOX_H */
@@ -67,6 +67,7 @@
 #include "timer.h"
 #include "main.h"
 #include "logger.h"
+#include "log_token.h"
 
 
 /*
@@ -157,7 +158,14 @@
 #define platformI2CSlaveAddrWR(add)                                                                 /*!< I2C Slave address for Write operation       */
 #define platformI2CSlaveAddrRD(add)                                                                 /*!< I2C Slave address for Read operation        */
 
+#ifndef LOGGER_TOKENIZED
+#define LOGGER_TOKENIZED                              0                                             /*!< Log binary records decoded on the host, see log_token.h */
+#endif
+#if LOGGER_TOKENIZED
+#define platformLog(...)                              logToken(__VA_ARGS__)                         /*!< Log  method                                 */
+#else
 #define platformLog(...)                              logUsart(__VA_ARGS__)                         /*!< Log  method                                 */
+#endif
 
 /*
 ******************************************************************************
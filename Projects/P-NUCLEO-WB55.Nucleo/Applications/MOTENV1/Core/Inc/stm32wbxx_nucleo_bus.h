@@ -27,6 +27,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "stm32wbxx_nucleo_conf.h"
 #include "stm32wbxx_nucleo_errno.h"
+#include "i2c_queue.h"
 
 /** @addtogroup BSP
   * @{
@@ -74,6 +75,8 @@ typedef struct
   * @{
   */ 
 extern I2C_HandleTypeDef hi2c1;	
+extern DMA_HandleTypeDef hdma_i2c1_rx;
+extern DMA_HandleTypeDef hdma_i2c1_tx;
 /**
   * @}
   */
@@ -95,6 +98,14 @@ int32_t BSP_I2C1_Send(uint16_t DevAddr, uint8_t *pData, uint16_t Length);
 int32_t BSP_I2C1_Recv(uint16_t DevAddr, uint8_t *pData, uint16_t Length);
 int32_t BSP_I2C1_SendRecv(uint16_t DevAddr, uint8_t *pTxdata, uint8_t *pRxdata, uint16_t Length);
 
+/* Non-blocking register accesses, queued and serviced by DMA */
+int32_t BSP_I2C1_ReadRegAsync(uint16_t Addr, uint16_t Reg, uint8_t *pData, uint16_t Length,
+                              uint8_t Flags, I2C_QUEUE_Cb_t Callback, void *pCtx);
+int32_t BSP_I2C1_WriteRegAsync(uint16_t Addr, uint16_t Reg, uint8_t *pData, uint16_t Length,
+                               uint8_t Flags, I2C_QUEUE_Cb_t Callback, void *pCtx);
+void BSP_I2C1_GetQueueStats(I2C_QUEUE_Stats_t *pStats);
+uint8_t BSP_I2C1_IsQueueIdle(void);
+
 int32_t BSP_GetTick(void);
 
 #if (USE_HAL_I2C_REGISTER_CALLBACKS == 1)
@@ -26,6 +26,7 @@ extern "C" {
 #endif    
     
 #include "cmsis_compiler.h"
+#include "stm32wbxx.h"
 #include "string.h"    
 #include "app_conf.h"
   
@@ -59,6 +60,20 @@ extern "C" {
 #define UTIL_SEQ_CONF_PRIO_NBR                  CFG_PRIO_NBR
 #define UTIL_SEQ_MEMSET8( dest, value, size )   UTILS_MEMSET8( dest, value, size )
 
+/**
+ * When UTIL_SEQ_CONF_STATS is set to 1, the sequencer records the run time and the ready-to-run latency of
+ * each task and the idle time, read with UTIL_SEQ_GetStats() and UTIL_SEQ_GetTaskStats()
+ * The times are in CPU cycles, counted by the DWT cycle counter. The counter is stopped in Stop mode: with
+ * low power enabled, the idle time only covers Sleep mode.
+ * The latency histogram starts at 1 << UTIL_SEQ_CONF_STATS_HIST_SHIFT cycles, 16us at 64MHz
+ */
+#define UTIL_SEQ_CONF_STATS                     0
+#define UTIL_SEQ_CONF_STATS_HIST_SHIFT          10
+#define UTIL_SEQ_STATS_INIT_TIME( )             do { CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; \
+                                                     DWT->CYCCNT = 0;                                \
+                                                     DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk; } while(0)
+#define UTIL_SEQ_STATS_GET_TIME( )              (DWT->CYCCNT)
+
 /******************************************************************************
  * Debug Trace
  ******************************************************************************/
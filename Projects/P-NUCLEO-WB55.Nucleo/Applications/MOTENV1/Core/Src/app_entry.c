@@ -33,7 +33,8 @@
 
 /* Private includes -----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
-
+#include <stdbool.h>
+#include "stm32wbxx_nucleo_bus.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -70,12 +71,23 @@ static void Init_Debug( void );
 static void appe_Tl_Init( void );
 static void APPE_SysStatusNot( SHCI_TL_CmdStatus_t status );
 static void APPE_SysUserEvtRx( void * pPayload );
+#if ( CFG_LPM_SUPPORTED == 1)
+static void Idle_SelectMode( void );
+#endif
 
 #if (CFG_HW_LPUART1_ENABLED == 1)
 extern void MX_LPUART1_UART_Init(void);
 #endif
 #if (CFG_HW_USART1_ENABLED == 1)
 extern void MX_USART1_UART_Init(void);
+#ifdef NFC_ENABLE
+extern uint8_t logUsartTx(uint8_t *data, uint16_t dataLen);
+extern bool logUsartIsIdle(void);
+#endif
+#endif
+#ifdef NFC_ENABLE
+extern uint8_t tx_uart_pending;
+extern uint8_t demoCycleEnable;
 #endif
 
 /* USER CODE BEGIN PFP */
@@ -113,6 +125,12 @@ void HAL_GPIO_EXTI_Callback( uint16_t GPIO_Pin )
   case BUTTON_SW2_Pin:
 #ifndef NFC_ENABLE  
     UTIL_SEQ_SetTask(1<<CFG_TASK_SW2_BUTTON_PUSHED_ID, CFG_SCH_PRIO_0);   //[STM] - Disable to free up EXTI0 for NFC IRQ_3916
+#else
+    /* IRQ_3916_Pin: the ST25R3916 IRQ wakes the NFC reader task up, st25r3916Isr() follows */
+    if (demoCycleEnable)
+    {
+      UTIL_SEQ_SetTask(1<<CFG_TASK_NFC_ID, CFG_SCH_PRIO_0);
+    }
 #endif    
     break;
   case LSM6DSL_INT1_O_GPIO_PIN:
@@ -149,6 +167,8 @@ static void SystemPower_Config( void )
 
   /* Initialize low power manager */
   UTIL_LPM_Init( );
+  /* No Off mode until the BLE stack is initialized, see APPE_SysUserEvtRx() */
+  UTIL_LPM_SetOffMode(1 << CFG_LPM_APP, UTIL_LPM_DISABLE);
 
 #if (CFG_USB_INTERFACE_ENABLE != 0)
   /**
@@ -247,7 +267,34 @@ static void APPE_SysUserEvtRx( void * pPayload )
 }
 
 /* USER CODE BEGIN FD_LOCAL_FUNCTIONS */
+#if ( CFG_LPM_SUPPORTED == 1)
+/**
+ * @brief  Select the low power mode of the coming idle time
+ *
+ * @note  Called in critical section from UTIL_SEQ_Idle(). The Stop mode is allowed when the
+ *        next Timer Server deadline is at least CFG_LPM_STOP_MIN_US away (no timer running
+ *        reads 0xFFFF ticks) and no DMA transfer would be stopped with its clock: USART1 log,
+ *        LPUART1 vCard output and I2C1 queue. The EXTI lines (ST25R3916 IRQ, MEMS interrupts),
+ *        the RTC and IPCC wake the device up from Stop mode.
+ *
+ * @param  None
+ * @retval None
+ */
+static void Idle_SelectMode( void )
+{
+  uint8_t busy;
+
+  busy = (HW_TS_RTC_ReadLeftTicksToCount( ) < DIVC(CFG_LPM_STOP_MIN_US, CFG_TS_TICK_VAL));
+  busy |= (BSP_I2C1_IsQueueIdle( ) == 0U);
+#ifdef NFC_ENABLE
+  busy |= (tx_uart_pending != 0U);
+  busy |= !logUsartIsIdle( );
+#endif
 
+  UTIL_LPM_SetStopMode(1 << CFG_LPM_IDLE, busy ? UTIL_LPM_DISABLE : UTIL_LPM_ENABLE);
+  return;
+}
+#endif
 /* USER CODE END FD_LOCAL_FUNCTIONS */
 
 /*************************************************************
@@ -259,6 +306,7 @@ static void APPE_SysUserEvtRx( void * pPayload )
 void UTIL_SEQ_Idle( void )
 {
 #if ( CFG_LPM_SUPPORTED == 1)
+  Idle_SelectMode( );
   UTIL_LPM_EnterLowPower( );
 #endif
   return;
@@ -303,7 +351,9 @@ void shci_cmd_resp_wait(uint32_t timeout)
 #if(CFG_DEBUG_TRACE != 0)
 void DbgOutputInit( void )
 {
+#ifndef NFC_ENABLE
     MX_USART1_UART_Init();
+#endif /* NFC_ENABLE: USART1 already initialized by main() for the log module, possibly sending */
 
   return;
 }
@@ -317,7 +367,13 @@ void DbgOutputInit( void )
   */
 void DbgOutputTraces(  uint8_t *p_data, uint16_t size, void (*cb)(void) )
 {
+#ifdef NFC_ENABLE
+  /* USART1 is shared with the NFC log: the traces go through the log ring, which copies them */
+  logUsartTx(p_data, size);
+  cb();
+#else
   HW_UART_Transmit_DMA(DBG_TRACE_UART_CFG, p_data, size, cb);
+#endif
 
   return;
 }
@@ -0,0 +1,133 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief Card emulation demo: NDEF Type 4 Tag
+ *
+ *  Implements demo_ce.h on top of the T4T emulation engine of nfc_t4t_ce.c.
+ *  The emulated tag holds a URI record the reader can read and update.
+ *
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "demo_ce.h"
+#include "utils.h"
+#include "nfc_t4t_ce.h"
+#include "ndef_message.h"
+#include "ndef_types_rtd.h"
+
+/* Private define ------------------------------------------------------------*/
+#define CE_NDEF_FILE_LEN    512U    /*!< Size of the emulated NDEF file, NLEN included */
+
+/* Private variables ---------------------------------------------------------*/
+static const uint8_t ceUri[] = "st.com";
+static uint8_t       ceNdefFile[CE_NDEF_FILE_LEN];
+static t4tCe         ceT4t;
+
+/* Exported functions ------------------------------------------------------- */
+
+/**
+  * @brief  Initialize the Card Emulation
+  *         Builds the NDEF file served by the T4T emulation: a URI record
+  *         'http://www.st.com', that the reader may update
+  * @param  nfcfNfcid : NFCID2 of the NFC-F emulation, not used as only T4T is emulated
+  * @retval None
+  */
+void demoCeInit(uint8_t* nfcfNfcid)
+{
+    ReturnCode      err;
+    ndefConstBuffer bufUri;
+    ndefBuffer      bufMessage;
+    ndefMessage     message;
+    ndefRecord      record;
+    ndefType        uri;
+
+    NO_WARNING(nfcfNfcid);
+
+    bufUri.buffer = ceUri;
+    bufUri.length = sizeof(ceUri) - 1U;
+
+    err  = ndefRtdUri(&uri, NDEF_URI_PREFIX_HTTP_WWW, &bufUri);
+    err |= ndefRtdUriToRecord(&uri, &record);
+    err |= ndefMessageInit(&message);
+    err |= ndefMessageAppend(&message, &record);
+
+    bufMessage.buffer = &ceNdefFile[T4T_CE_NLEN_LEN];
+    bufMessage.length = sizeof(ceNdefFile) - T4T_CE_NLEN_LEN;
+    err |= ndefMessageEncode(&message, &bufMessage);
+
+    if( err != ERR_NONE )
+    {
+        bufMessage.length = 0U;
+    }
+
+    /* NLEN: the reader sees an empty tag if the message could not be built */
+    ceNdefFile[0] = (uint8_t)(bufMessage.length >> 8U);
+    ceNdefFile[1] = (uint8_t)(bufMessage.length);
+
+    (void)t4tCeIni(&ceT4t, ceNdefFile, sizeof(ceNdefFile), false);
+}
+
+/**
+  * @brief  Restart the T4T emulation after a new activation: no application selected
+  * @retval None
+  */
+void demoCeT4TReset(void)
+{
+    t4tCeReset(&ceT4t);
+}
+
+/**
+  * @brief  Answer a C-APDU of the reader
+  *         The response data is taken in place from the file image, this
+  *         is the only copy before RFAL takes the frame
+  * @param  rxData    : C-APDU
+  * @param  rxDataLen : C-APDU length
+  * @param  txBuf     : R-APDU buffer
+  * @param  txBufLen  : R-APDU buffer size
+  * @retval R-APDU length
+  */
+uint16_t demoCeT4T(uint8_t *rxData, uint16_t rxDataLen, uint8_t *txBuf, uint16_t txBufLen )
+{
+    t4tCeResponse rsp;
+
+    t4tCeProcess(&ceT4t, rxData, rxDataLen, &rsp);
+
+    if( ((uint32_t)rsp.len + T4T_CE_SW_LEN) > txBufLen )
+    {
+        rsp.len = 0U;
+        rsp.sw  = T4T_CE_SW_WRONG_LENGTH;
+    }
+
+    if( rsp.len != 0U )
+    {
+        ST_MEMCPY(txBuf, rsp.data, rsp.len);
+    }
+    txBuf[rsp.len]      = (uint8_t)(rsp.sw >> 8U);
+    txBuf[rsp.len + 1U] = (uint8_t)(rsp.sw);
+
+    return (uint16_t)(rsp.len + T4T_CE_SW_LEN);
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,114 @@
+/**
+ ******************************************************************************
+  * File Name          : Src/hw_flash.c
+  * Description        : HW flash program and erase, shared with the CPU2.
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+
+/*
+ * The flash is shared with the CPU2:
+ * - CFG_HW_FLASH_SEMID is held during the operation, the CPU2 takes it as
+ *   well to write its own data
+ * - the CPU2 is told of an erase, it then keeps the radio timing by
+ *   suspending the erase when it needs to (PESD)
+ * - an operation is not started while the CPU2 holds the suspend, the CPU1
+ *   would stall on its next flash access
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "app_common.h"
+#include "hw_conf.h"
+#include "hw_flash.h"
+#include "shci.h"
+
+/* Private function prototypes -----------------------------------------------*/
+static void HW_FLASH_Take(void);
+static void HW_FLASH_Release(void);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/**
+  * @brief  Erase a page
+  * @param  Address Page address
+  * @retval 0 on success, -1 otherwise
+  */
+int32_t HW_FLASH_Erase(uintptr_t Address)
+{
+  FLASH_EraseInitTypeDef erase;
+  uint32_t page_error;
+  HAL_StatusTypeDef status;
+
+  erase.TypeErase = FLASH_TYPEERASE_PAGES;
+  erase.Page = (uint32_t)(Address - FLASH_BASE) / FLASH_PAGE_SIZE;
+  erase.NbPages = 1;
+
+  HW_FLASH_Take();
+  (void)SHCI_C2_FLASH_EraseActivity(ERASE_ACTIVITY_ON);
+
+  while (HAL_FLASHEx_IsOperationSuspended() != 0U);
+  status = HAL_FLASHEx_Erase(&erase, &page_error);
+
+  (void)SHCI_C2_FLASH_EraseActivity(ERASE_ACTIVITY_OFF);
+  HW_FLASH_Release();
+
+  return (status == HAL_OK) ? 0 : -1;
+}
+
+/**
+  * @brief  Program a double word, erased before
+  * @param  Address Double word address
+  * @param  Data    Data
+  * @retval 0 on success, -1 otherwise
+  */
+int32_t HW_FLASH_Program(uintptr_t Address, uint64_t Data)
+{
+  HAL_StatusTypeDef status;
+
+  HW_FLASH_Take();
+
+  while (HAL_FLASHEx_IsOperationSuspended() != 0U);
+  status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, (uint32_t)Address, Data);
+
+  HW_FLASH_Release();
+
+  return (status == HAL_OK) ? 0 : -1;
+}
+
+/**
+  * @brief  Take the flash from the CPU2 and unlock the control register
+  * @param  None
+  * @retval None
+  */
+static void HW_FLASH_Take(void)
+{
+  while (LL_HSEM_1StepLock(HSEM, CFG_HW_FLASH_SEMID));
+
+  (void)HAL_FLASH_Unlock();
+  __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+}
+
+/**
+  * @brief  Lock the control register and give the flash back to the CPU2
+  * @param  None
+  * @retval None
+  */
+static void HW_FLASH_Release(void)
+{
+  (void)HAL_FLASH_Lock();
+
+  LL_HSEM_ReleaseLock(HSEM, CFG_HW_FLASH_SEMID, 0);
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -51,6 +51,10 @@ typedef struct
   uint32_t        TimerProcessID;
   uint8_t         PreviousID;
   uint8_t         NextID;
+#if (CFG_HW_TS_USE_HEAP == 1)
+  uint32_t        Expiry;       /**< Time base value when the timer expires */
+  uint8_t         HeapIndex;    /**< Position in aTimerHeap */
+#endif
 }TimerContext_t;
 
 /* Private defines -----------------------------------------------------------*/
@@ -69,6 +73,11 @@ PLACE_IN_SECTION("TIMERSERVER_CONTEXT") static volatile uint8_t CurrentRunningTi
 PLACE_IN_SECTION("TIMERSERVER_CONTEXT") static volatile uint8_t PreviousRunningTimerID;
 PLACE_IN_SECTION("TIMERSERVER_CONTEXT") static volatile uint32_t SSRValueOnLastSetup;
 PLACE_IN_SECTION("TIMERSERVER_CONTEXT") static volatile WakeupTimerLimitation_Status_t  WakeupTimerLimitation;
+#if (CFG_HW_TS_USE_HEAP == 1)
+PLACE_IN_SECTION("TIMERSERVER_CONTEXT") static volatile uint32_t TimeBase;     /**< Ticks counted up to the last wakeup timer setup */
+PLACE_IN_SECTION("TIMERSERVER_CONTEXT") static volatile uint8_t aTimerHeap[CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER]; /**< Running timers, earliest expiry first */
+PLACE_IN_SECTION("TIMERSERVER_CONTEXT") static volatile uint8_t TimerHeapSize;
+#endif
 
 /**
  * END of Section TIMERSERVER_CONTEXT
@@ -79,6 +88,9 @@ static uint8_t  WakeupTimerDivider;
 static uint8_t  AsynchPrescalerUserConfig;
 static uint16_t SynchPrescalerUserConfig;
 static volatile uint16_t MaxWakeupTimerSetup;
+#if (CFG_HW_TS_INSTRUMENTATION == 1)
+static HW_TS_Stats_t TimerStats;
+#endif
 
 /* Global variables ----------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
@@ -86,8 +98,15 @@ static void RestartWakeupCounter(uint16_t Value);
 static uint16_t ReturnTimeElapsed(void);
 static void RescheduleTimerList(void);
 static void UnlinkTimer(uint8_t TimerID, RequestReadSSR_t RequestReadSSR);
+#if (CFG_HW_TS_USE_HEAP == 1)
+static uint8_t TimerExpiresBefore(uint8_t TimerID, uint8_t RefTimerID);
+static void HeapPlace(uint8_t TimerID, uint8_t HeapIndex);
+static void HeapSiftUp(uint8_t HeapIndex);
+static void HeapSiftDown(uint8_t HeapIndex);
+#else
 static void LinkTimerBefore(uint8_t TimerID, uint8_t RefTimerID);
 static void LinkTimerAfter(uint8_t TimerID, uint8_t RefTimerID);
+#endif
 static uint16_t linkTimer(uint8_t TimerID);
 static uint32_t ReadRtcSsrValue(void);
 
@@ -121,6 +140,197 @@ static uint32_t ReadRtcSsrValue(void)
   return second_read;
 }
 
+#if (CFG_HW_TS_USE_HEAP == 1)
+/**
+ * @brief  Compare the expiry of two Timers
+ * @note  The difference is signed so that the time base may wrap around
+ * @param  TimerID:   The ID of the Timer
+ * @param  RefTimerID: The ID of the Timer to compare with
+ * @retval 1 when TimerID expires first, 0 otherwise
+ */
+static uint8_t TimerExpiresBefore(uint8_t TimerID, uint8_t RefTimerID)
+{
+  return (((int32_t)(aTimerContext[TimerID].Expiry - aTimerContext[RefTimerID].Expiry)) < 0) ? 1 : 0;
+}
+
+/**
+ * @brief  Store a Timer at a position of the heap
+ * @param  TimerID:   The ID of the Timer
+ * @param  HeapIndex: The position in the heap
+ * @retval None
+ */
+static void HeapPlace(uint8_t TimerID, uint8_t HeapIndex)
+{
+  aTimerHeap[HeapIndex] = TimerID;
+  aTimerContext[TimerID].HeapIndex = HeapIndex;
+
+  return;
+}
+
+/**
+ * @brief  Move a Timer up the heap until its parent expires first
+ * @param  HeapIndex: The position of the Timer in the heap
+ * @retval None
+ */
+static void HeapSiftUp(uint8_t HeapIndex)
+{
+  uint8_t timer_id;
+  uint8_t parent_index;
+
+  timer_id = aTimerHeap[HeapIndex];
+
+  while(HeapIndex > 0)
+  {
+    parent_index = (HeapIndex - 1) / 2;
+
+    if(TimerExpiresBefore(timer_id, aTimerHeap[parent_index]) == 0)
+    {
+      break;
+    }
+
+    HeapPlace(aTimerHeap[parent_index], HeapIndex);
+    HeapIndex = parent_index;
+  }
+
+  HeapPlace(timer_id, HeapIndex);
+
+  return;
+}
+
+/**
+ * @brief  Move a Timer down the heap until its children expire later
+ * @param  HeapIndex: The position of the Timer in the heap
+ * @retval None
+ */
+static void HeapSiftDown(uint8_t HeapIndex)
+{
+  uint8_t timer_id;
+  uint16_t child_index;
+
+  timer_id = aTimerHeap[HeapIndex];
+
+  for(;;)
+  {
+    child_index = (2 * HeapIndex) + 1;
+
+    if(child_index >= TimerHeapSize)
+    {
+      break;
+    }
+
+    if(((child_index + 1) < TimerHeapSize) && (TimerExpiresBefore(aTimerHeap[child_index + 1], aTimerHeap[child_index]) == 1))
+    {
+      child_index++;
+    }
+
+    if(TimerExpiresBefore(aTimerHeap[child_index], timer_id) == 0)
+    {
+      break;
+    }
+
+    HeapPlace(aTimerHeap[child_index], HeapIndex);
+    HeapIndex = (uint8_t)child_index;
+  }
+
+  HeapPlace(timer_id, HeapIndex);
+
+  return;
+}
+
+/**
+ * @brief  Insert a Timer in the heap
+ * @note  The expiry is absolute on the time base so that the Timers already
+ *        running are not updated. The ID of the earliest Timer is kept in CurrentRunningTimerID
+ *        and PreviousRunningTimerID holds the ID the wakeup timer has been setup for
+ * @param  TimerID:   The ID of the Timer
+ * @retval Time elapsed since the last wakeup timer setup
+ */
+static uint16_t linkTimer(uint8_t TimerID)
+{
+  uint16_t time_elapsed;
+
+  if(TimerHeapSize == 0)
+  {
+    /**
+     * No timer in the heap, the wakeup timer shall be setup
+     */
+    PreviousRunningTimerID = CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER;
+
+    SSRValueOnLastSetup = SSR_FORBIDDEN_VALUE;
+    time_elapsed = 0;
+  }
+  else
+  {
+    time_elapsed = ReturnTimeElapsed();
+  }
+
+  aTimerContext[TimerID].Expiry = TimeBase + time_elapsed + aTimerContext[TimerID].CountLeft;
+
+  HeapPlace(TimerID, TimerHeapSize);
+  TimerHeapSize++;
+  HeapSiftUp(TimerHeapSize - 1);
+
+  CurrentRunningTimerID = aTimerHeap[0];
+
+  return time_elapsed;
+}
+
+/**
+ * @brief  Remove a Timer from the heap
+ * @param  TimerID:   The ID of the Timer
+ * @param  RequestReadSSR: Request to read the SSR register or not
+ * @retval None
+ */
+static void UnlinkTimer(uint8_t TimerID, RequestReadSSR_t RequestReadSSR)
+{
+  uint8_t heap_index;
+  uint8_t last_id;
+
+  heap_index = aTimerContext[TimerID].HeapIndex;
+  TimerHeapSize--;
+
+  if(heap_index != TimerHeapSize)
+  {
+    /**
+     * Fill the hole with the last Timer of the heap
+     */
+    last_id = aTimerHeap[TimerHeapSize];
+    HeapPlace(last_id, heap_index);
+    HeapSiftDown(heap_index);
+    HeapSiftUp(aTimerContext[last_id].HeapIndex);
+  }
+
+  if(TimerHeapSize != 0)
+  {
+    CurrentRunningTimerID = aTimerHeap[0];
+  }
+  else
+  {
+    CurrentRunningTimerID = CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER;
+  }
+
+  if(TimerID == PreviousRunningTimerID)
+  {
+    /**
+     * The wakeup timer has been setup for this Timer, it shall be setup again
+     */
+    PreviousRunningTimerID = CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER;
+  }
+
+  /**
+   * Timer is out of the heap
+   */
+  aTimerContext[TimerID].TimerIDStatus = TimerID_Created;
+
+  if((CurrentRunningTimerID == CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER) && (RequestReadSSR == SSR_Read_Requested))
+  {
+    SSRValueOnLastSetup = SSR_FORBIDDEN_VALUE;
+  }
+
+  return;
+}
+
+#else
 /**
  * @brief  Insert a Timer in the list after the Timer ID specified
  * @param  TimerID:   The ID of the Timer
@@ -281,6 +491,7 @@ static void UnlinkTimer(uint8_t TimerID, RequestReadSSR_t RequestReadSSR)
 
   return;
 }
+#endif
 
 /**
  * @brief  Return the number of ticks counted by the wakeuptimer since it has been started
@@ -422,6 +633,26 @@ static void RescheduleTimerList(void)
    */
   time_elapsed = ReturnTimeElapsed();
 
+#if (CFG_HW_TS_USE_HEAP == 1)
+  /**
+   * Move the time base to now: the expiry of the running timers is unchanged
+   */
+  TimeBase += time_elapsed;
+  time_elapsed = 0;
+
+  timecountleft = aTimerContext[localTimerID].Expiry - TimeBase;
+  if((int32_t)timecountleft < 0)
+  {
+    timecountleft = 0;
+  }
+
+  PreviousRunningTimerID = localTimerID;
+#endif
+
+#if (CFG_HW_TS_INSTRUMENTATION == 1)
+  TimerStats.Reschedules++;
+#endif
+
   if(timecountleft < time_elapsed )
   {
     /**
@@ -449,6 +680,7 @@ static void RescheduleTimerList(void)
 
   }
 
+#if (CFG_HW_TS_USE_HEAP == 0)
   /**
    * update ticks left to be counted for each timer
    */
@@ -464,6 +696,7 @@ static void RescheduleTimerList(void)
     }
     localTimerID = aTimerContext[localTimerID].NextID;
   }
+#endif
 
   /**
    * Write next count
@@ -490,6 +723,11 @@ void HW_TS_RTC_Wakeup_Handler(void)
 #if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
   uint32_t primask_bit;
 #endif
+#if (CFG_HW_TS_INSTRUMENTATION == 1)
+  uint32_t cycles;
+
+  cycles = DWT->CYCCNT;
+#endif
 
 #if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
   primask_bit = __get_PRIMASK();  /**< backup PRIMASK bit */
@@ -581,6 +819,19 @@ void HW_TS_RTC_Wakeup_Handler(void)
   /* Enable the write protection for RTC registers */
   __HAL_RTC_WRITEPROTECTION_ENABLE( phrtc );
 
+#if (CFG_HW_TS_INSTRUMENTATION == 1)
+  /**
+   * The timer callbacks notified by HW_TS_RTC_Int_AppNot() are included
+   */
+  cycles = DWT->CYCCNT - cycles;
+  TimerStats.Wakeups++;
+  TimerStats.WakeupCycles += cycles;
+  if(cycles > TimerStats.WakeupMaxCycles)
+  {
+    TimerStats.WakeupMaxCycles = cycles;
+  }
+#endif
+
   return;
 }
 
@@ -643,6 +894,10 @@ void HW_TS_Init(HW_TS_InitMode_t TimerInitMode, RTC_HandleTypeDef *hrtc)
     }
 
     CurrentRunningTimerID = CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER;   /**<  Set ID to non valid value */
+#if (CFG_HW_TS_USE_HEAP == 1)
+    TimerHeapSize = 0;
+    TimeBase = 0;
+#endif
 
     __HAL_RTC_WAKEUPTIMER_DISABLE(phrtc);                       /**<  Disable the Wakeup Timer */
     __HAL_RTC_WAKEUPTIMER_CLEAR_FLAG(phrtc, RTC_FLAG_WUTF);     /**<  Clear flag in RTC module */
@@ -664,6 +919,14 @@ void HW_TS_Init(HW_TS_InitMode_t TimerInitMode, RTC_HandleTypeDef *hrtc)
   /* Enable the write protection for RTC registers */
   __HAL_RTC_WRITEPROTECTION_ENABLE( phrtc );
 
+#if (CFG_HW_TS_INSTRUMENTATION == 1)
+  /**
+   * Enable the cycle counter used to measure the wakeup handler
+   */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
   HAL_NVIC_SetPriority(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID, CFG_HW_TS_NVIC_RTC_WAKEUP_IT_PREEMPTPRIO, CFG_HW_TS_NVIC_RTC_WAKEUP_IT_SUBPRIO);   /**<  Set NVIC priority */
   HAL_NVIC_EnableIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID); /**<  Enable NVIC */
 
@@ -883,6 +1146,24 @@ uint16_t HW_TS_RTC_ReadLeftTicksToCount(void)
   return (return_value);
 }
 
+void HW_TS_Get_Stats(HW_TS_Stats_t *pStats)
+{
+#if (CFG_HW_TS_INSTRUMENTATION == 1)
+  uint32_t primask_bit;
+
+  primask_bit = __get_PRIMASK();  /**< backup PRIMASK bit */
+  __disable_irq();                /**< Disable all interrupts by setting PRIMASK bit on Cortex*/
+
+  *pStats = TimerStats;
+
+  __set_PRIMASK(primask_bit);     /**< Restore PRIMASK bit*/
+#else
+  memset(pStats, 0, sizeof(HW_TS_Stats_t));
+#endif
+
+  return;
+}
+
 __weak void HW_TS_RTC_Int_AppNot(uint32_t TimerProcessID, uint8_t TimerID, HW_TS_pTimerCb_t pTimerCallBack)
 {
   pTimerCallBack();
@@ -50,6 +50,7 @@ extern UART_HandleTypeDef huart1;
           
 #ifdef NFC_ENABLE
 extern uint8_t tx_uart_pending;  
+extern void logUsartTxCpltCallback(UART_HandleTypeDef *huart);
 #endif
         /* Variables ------------------------------------------------------------------*/
 #if (CFG_HW_USART1_ENABLED == 1)
@@ -301,6 +302,10 @@ void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
                 {
                     HW_huart1TxCb();
                 }
+#ifdef NFC_ENABLE
+              /* Next transfer from the log ring */
+              logUsartTxCpltCallback(huart);
+#endif
         break;
 #endif
 
@@ -0,0 +1,196 @@
+/**
+  ******************************************************************************
+  * @file           : i2c_queue.c
+  * @brief          : I2C transaction queue, independent from the bus hardware
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "i2c_queue.h"
+
+/* Private macros ------------------------------------------------------------*/
+#define I2C_QUEUE_IDX(pQueue, n)        (((pQueue)->Head + (n)) % I2C_QUEUE_SIZE)
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t I2C_QUEUE_Can_Merge(const I2C_QUEUE_Xfer_t *pFirst, uint16_t Length, const I2C_QUEUE_Xfer_t *pNext);
+static void I2C_QUEUE_Release(I2C_QUEUE_t *pQueue, int32_t Status);
+static void I2C_QUEUE_Dispatch(I2C_QUEUE_t *pQueue);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/**
+  * @brief  Initialize an empty queue
+  * @param  pQueue Queue
+  * @param  Start  Bus function starting a transfer
+  * @retval None
+  */
+void I2C_QUEUE_Init(I2C_QUEUE_t *pQueue, I2C_QUEUE_Start_Func Start)
+{
+  memset(pQueue, 0, sizeof(I2C_QUEUE_t));
+  pQueue->Start = Start;
+}
+
+/**
+  * @brief  Append a transaction, and start it when the bus is idle
+  * @param  pQueue Queue
+  * @param  pXfer  Transaction (copied, pData must stay valid until completion)
+  * @retval I2C_QUEUE_OK or I2C_QUEUE_FULL
+  */
+int32_t I2C_QUEUE_Post(I2C_QUEUE_t *pQueue, const I2C_QUEUE_Xfer_t *pXfer)
+{
+  if(pQueue->Count >= I2C_QUEUE_SIZE)
+  {
+    return I2C_QUEUE_FULL;
+  }
+
+  pQueue->Xfer[I2C_QUEUE_IDX(pQueue, pQueue->Count)] = *pXfer;
+  pQueue->Count++;
+  pQueue->Stats.Posted++;
+
+  I2C_QUEUE_Dispatch(pQueue);
+
+  return I2C_QUEUE_OK;
+}
+
+/**
+  * @brief  Report the end of the transfer on the bus
+  *         and start the next one
+  * @param  pQueue Queue
+  * @param  Status I2C_QUEUE_OK or the bus error
+  * @retval None
+  */
+void I2C_QUEUE_Complete(I2C_QUEUE_t *pQueue, int32_t Status)
+{
+  if(pQueue->InFlight != 0U)
+  {
+    I2C_QUEUE_Release(pQueue, Status);
+    I2C_QUEUE_Dispatch(pQueue);
+  }
+}
+
+/**
+  * @brief  Check whether the queue is empty and the bus idle
+  * @param  pQueue Queue
+  * @retval 1 when idle, 0 otherwise
+  */
+uint8_t I2C_QUEUE_IsIdle(const I2C_QUEUE_t *pQueue)
+{
+  return (pQueue->Count == 0U) ? 1U : 0U;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Check whether a transaction extends the transfer being built
+  * @param  pFirst First transaction of the transfer
+  * @param  Length Current length of the transfer
+  * @param  pNext  Candidate transaction
+  * @retval 1 when it can be merged, 0 otherwise
+  */
+static uint8_t I2C_QUEUE_Can_Merge(const I2C_QUEUE_Xfer_t *pFirst, uint16_t Length, const I2C_QUEUE_Xfer_t *pNext)
+{
+  if(((pFirst->Flags & I2C_QUEUE_FLAG_MERGE) == 0U) || ((pNext->Flags & I2C_QUEUE_FLAG_MERGE) == 0U))
+  {
+    return 0;
+  }
+
+  if((pNext->DevAddr != pFirst->DevAddr) || (pNext->Dir != pFirst->Dir))
+  {
+    return 0;
+  }
+
+  if(((uint32_t)Length + pNext->Length) > 0xFFFFU)
+  {
+    return 0;
+  }
+
+  /* Registers and buffers must both follow on */
+  if((pNext->Reg != (uint16_t)(pFirst->Reg + Length)) || (pNext->pData != (pFirst->pData + Length)))
+  {
+    return 0;
+  }
+
+  return 1;
+}
+
+/**
+  * @brief  Remove the transactions of the finished transfer and call back
+  *         their owners (who may post again from the callback)
+  * @param  pQueue Queue
+  * @param  Status Transfer status
+  * @retval None
+  */
+static void I2C_QUEUE_Release(I2C_QUEUE_t *pQueue, int32_t Status)
+{
+  uint8_t n = pQueue->InFlight;
+
+  if(Status != I2C_QUEUE_OK)
+  {
+    pQueue->Stats.Errors++;
+  }
+
+  while(n > 0U)
+  {
+    I2C_QUEUE_Cb_t callback = pQueue->Xfer[pQueue->Head].Callback;
+    void *pCtx = pQueue->Xfer[pQueue->Head].pCtx;
+
+    pQueue->Head = (uint8_t)((pQueue->Head + 1U) % I2C_QUEUE_SIZE);
+    pQueue->Count--;
+    n--;
+
+    /* InFlight is still set: a transaction posted here is only queued */
+    if(callback != NULL)
+    {
+      callback(Status, pCtx);
+    }
+    pQueue->InFlight = n;
+  }
+}
+
+/**
+  * @brief  Start the next transfer if the bus is idle, merging the
+  *         consecutive transactions that follow on
+  * @param  pQueue Queue
+  * @retval None
+  */
+static void I2C_QUEUE_Dispatch(I2C_QUEUE_t *pQueue)
+{
+  while((pQueue->InFlight == 0U) && (pQueue->Count != 0U))
+  {
+    const I2C_QUEUE_Xfer_t *pFirst = &pQueue->Xfer[pQueue->Head];
+    uint16_t length = pFirst->Length;
+    uint8_t n = 1;
+    int32_t status;
+
+    while((n < pQueue->Count) && (I2C_QUEUE_Can_Merge(pFirst, length, &pQueue->Xfer[I2C_QUEUE_IDX(pQueue, n)]) != 0U))
+    {
+      length += pQueue->Xfer[I2C_QUEUE_IDX(pQueue, n)].Length;
+      n++;
+    }
+
+    pQueue->InFlight = n;
+    pQueue->Stats.Transfers++;
+    pQueue->Stats.Merged += (uint32_t)n - 1U;
+
+    status = pQueue->Start(pFirst->DevAddr, pFirst->Reg, pFirst->Dir, pFirst->pData, length);
+    if(status != I2C_QUEUE_OK)
+    {
+      /* Nothing will complete: fail these transactions and try the next ones */
+      I2C_QUEUE_Release(pQueue, status);
+    }
+  }
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
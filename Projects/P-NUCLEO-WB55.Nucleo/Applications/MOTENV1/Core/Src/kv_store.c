@@ -0,0 +1,481 @@
+/**
+  ******************************************************************************
+  * @file           : kv_store.c
+  * @brief          : Log structured key-value store in flash pages
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+*/
+
+/*
+ * The pages are written in turn, as a circular log. A page starts with a
+ * header double word holding KV_STORE_MAGIC and a sequence number, one more
+ * than the page written before. A record is a header double word (key,
+ * length, CRC-32 of the key, length and data) followed by the data, padded to
+ * a double word. The data is programmed first and the header last, so a
+ * record cut by a reset never passes the CRC. Nothing is written after a
+ * record failing the check: the page is closed and the next write goes to
+ * the next page.
+ *
+ * One page is always erased. When the active page is full, the erased page
+ * after it gets the next header, the records of the oldest page not
+ * overwritten since are copied, then the oldest page is erased. At init, a
+ * page with no header is erased if not blank, and the copy and erase are
+ * resumed when no page is erased. A copy cut by a reset closes the new page:
+ * the oldest page is then still whole, so the new page is erased and the
+ * copy started again.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "kv_store.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define KV_STORE_MAGIC                  0x3153564BU     /* "KVS1" */
+#define KV_STORE_DW                     8U
+#define KV_STORE_BLANK                  0xFFFFFFFFFFFFFFFFULL
+
+/* Private macros ------------------------------------------------------------*/
+#define KV_STORE_ALIGN(len)             (((len) + (KV_STORE_DW - 1U)) & ~(KV_STORE_DW - 1U))
+#define KV_STORE_RECORD_SIZE(len)       (KV_STORE_DW + KV_STORE_ALIGN(len))
+#define KV_STORE_PAGE(off)              ((off) / KV_STORE_PAGE_SIZE)
+
+/* The records of every key and a new one always fit a page after its header */
+#if (((KV_STORE_KEY_NBR + 1U) * KV_STORE_RECORD_SIZE(KV_STORE_MAX_LENGTH)) + KV_STORE_DW) > KV_STORE_PAGE_SIZE
+#error "KV_STORE_KEY_NBR records of KV_STORE_MAX_LENGTH do not fit a page"
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+static uint64_t KV_STORE_Get(const KV_STORE_t *pStore, uint32_t Offset);
+static uint32_t KV_STORE_Crc(uint16_t Key, uint16_t Length, const uint8_t *pData);
+static uint8_t KV_STORE_Check(const KV_STORE_t *pStore, uint32_t Offset, uint16_t *pKey, uint16_t *pLength);
+static uint8_t KV_STORE_Is_Blank(const KV_STORE_t *pStore, uint32_t Offset, uint32_t End);
+static uint32_t KV_STORE_Scan(KV_STORE_t *pStore, uint32_t Page);
+static int32_t KV_STORE_Erase(KV_STORE_t *pStore, uint32_t Page);
+static int32_t KV_STORE_Append(KV_STORE_t *pStore, uint16_t Key, const uint8_t *pData, uint16_t Length);
+static int32_t KV_STORE_Collect(KV_STORE_t *pStore, uint32_t Page);
+static int32_t KV_STORE_Open_Page(KV_STORE_t *pStore, uint32_t Page);
+static int32_t KV_STORE_Next_Page(KV_STORE_t *pStore);
+static int32_t KV_STORE_Mount(KV_STORE_t *pStore);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/**
+  * @brief  Mount the store, repairing what a reset left during a write
+  * @param  pStore  Store
+  * @param  pFlash  Flash access
+  * @param  Base    Address of the first page, memory mapped
+  * @param  PageNbr Number of pages, 2 or more
+  * @retval KV_STORE_OK or KV_STORE_ERROR
+  */
+int32_t KV_STORE_Init(KV_STORE_t *pStore, const KV_STORE_Flash_t *pFlash, uintptr_t Base, uint32_t PageNbr)
+{
+  memset(pStore, 0, sizeof(KV_STORE_t));
+  pStore->pFlash = pFlash;
+  pStore->Base = Base;
+  pStore->PageNbr = PageNbr;
+
+  if (PageNbr < 2U)
+  {
+    return KV_STORE_ERROR;
+  }
+
+  return KV_STORE_Mount(pStore);
+}
+
+/**
+  * @brief  Read the value of a key
+  * @param  pStore  Store
+  * @param  Key     Key
+  * @param  pData   Buffer, receives up to Size bytes of the value
+  * @param  Size    Buffer size
+  * @param  pLength Receives the length of the value, may be NULL
+  * @retval KV_STORE_OK, KV_STORE_NOT_FOUND or KV_STORE_ERROR
+  */
+int32_t KV_STORE_Read(const KV_STORE_t *pStore, uint16_t Key, void *pData, uint16_t Size, uint16_t *pLength)
+{
+  uint16_t length;
+
+  if (Key >= KV_STORE_KEY_NBR)
+  {
+    return KV_STORE_ERROR;
+  }
+  if (pStore->Index[Key] == 0U)
+  {
+    return KV_STORE_NOT_FOUND;
+  }
+
+  length = (uint16_t)(KV_STORE_Get(pStore, pStore->Index[Key]) >> 16);
+  memcpy(pData, (const void *)(pStore->Base + pStore->Index[Key] + KV_STORE_DW), (Size < length) ? Size : length);
+  if (pLength != NULL)
+  {
+    *pLength = length;
+  }
+
+  return KV_STORE_OK;
+}
+
+/**
+  * @brief  Write the value of a key, nothing is programmed if it is unchanged
+  * @param  pStore  Store
+  * @param  Key     Key
+  * @param  pData   Value
+  * @param  Length  Value length, up to KV_STORE_MAX_LENGTH
+  * @retval KV_STORE_OK or KV_STORE_ERROR
+  */
+int32_t KV_STORE_Write(KV_STORE_t *pStore, uint16_t Key, const void *pData, uint16_t Length)
+{
+  uint32_t offset;
+  int32_t ret;
+
+  if ((Key >= KV_STORE_KEY_NBR) || (Length > KV_STORE_MAX_LENGTH))
+  {
+    return KV_STORE_ERROR;
+  }
+
+  offset = pStore->Index[Key];
+  if ((offset != 0U) && ((uint16_t)(KV_STORE_Get(pStore, offset) >> 16) == Length)
+      && (memcmp((const void *)(pStore->Base + offset + KV_STORE_DW), pData, Length) == 0))
+  {
+    pStore->Stats.Unchanged++;
+    return KV_STORE_OK;
+  }
+
+  if ((pStore->WritePos + KV_STORE_RECORD_SIZE(Length)) > KV_STORE_PAGE_SIZE)
+  {
+    ret = KV_STORE_Next_Page(pStore);
+    if (ret != KV_STORE_OK)
+    {
+      return ret;
+    }
+  }
+
+  ret = KV_STORE_Append(pStore, Key, (const uint8_t *)pData, Length);
+  if (ret == KV_STORE_OK)
+  {
+    pStore->Stats.Writes++;
+  }
+  return ret;
+}
+
+/**
+  * @brief  Read a double word
+  * @param  pStore Store
+  * @param  Offset Offset from the first page
+  * @retval Double word
+  */
+static uint64_t KV_STORE_Get(const KV_STORE_t *pStore, uint32_t Offset)
+{
+  uint64_t dw;
+
+  memcpy(&dw, (const void *)(pStore->Base + Offset), sizeof(dw));
+  return dw;
+}
+
+/**
+  * @brief  CRC-32 of a record, reflected 0x04C11DB7 polynomial, 4 bits at a time
+  * @param  Key    Key
+  * @param  Length Value length
+  * @param  pData  Value
+  * @retval CRC
+  */
+static uint32_t KV_STORE_Crc(uint16_t Key, uint16_t Length, const uint8_t *pData)
+{
+  static const uint32_t table[16] =
+  {
+    0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU, 0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+    0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU, 0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU
+  };
+  uint8_t hdr[4];
+  uint32_t crc = 0xFFFFFFFFU;
+  uint32_t i;
+
+  hdr[0] = (uint8_t)Key;
+  hdr[1] = (uint8_t)(Key >> 8);
+  hdr[2] = (uint8_t)Length;
+  hdr[3] = (uint8_t)(Length >> 8);
+
+  for (i = 0; i < (4U + (uint32_t)Length); i++)
+  {
+    crc ^= (i < 4U) ? hdr[i] : pData[i - 4U];
+    crc = (crc >> 4) ^ table[crc & 0x0FU];
+    crc = (crc >> 4) ^ table[crc & 0x0FU];
+  }
+
+  return ~crc;
+}
+
+/**
+  * @brief  Check the record at an offset
+  * @param  pStore  Store
+  * @param  Offset  Offset from the first page
+  * @param  pKey    Receives the key
+  * @param  pLength Receives the value length
+  * @retval 1 if a whole record is there, 0 otherwise
+  */
+static uint8_t KV_STORE_Check(const KV_STORE_t *pStore, uint32_t Offset, uint16_t *pKey, uint16_t *pLength)
+{
+  uint64_t hdr;
+  uint32_t end;
+
+  hdr = KV_STORE_Get(pStore, Offset);
+  *pKey = (uint16_t)hdr;
+  *pLength = (uint16_t)(hdr >> 16);
+
+  end = (KV_STORE_PAGE(Offset) + 1U) * KV_STORE_PAGE_SIZE;
+  if ((*pKey >= KV_STORE_KEY_NBR) || (*pLength > KV_STORE_MAX_LENGTH)
+      || ((Offset + KV_STORE_RECORD_SIZE(*pLength)) > end))
+  {
+    return 0;
+  }
+
+  return (KV_STORE_Crc(*pKey, *pLength, (const uint8_t *)(pStore->Base + Offset + KV_STORE_DW)) == (uint32_t)(hdr >> 32)) ? 1U : 0U;
+}
+
+/**
+  * @brief  Check a range is erased
+  * @param  pStore Store
+  * @param  Offset Start, from the first page
+  * @param  End    End, from the first page
+  * @retval 1 if erased, 0 otherwise
+  */
+static uint8_t KV_STORE_Is_Blank(const KV_STORE_t *pStore, uint32_t Offset, uint32_t End)
+{
+  for (; Offset < End; Offset += KV_STORE_DW)
+  {
+    if (KV_STORE_Get(pStore, Offset) != KV_STORE_BLANK)
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+  * @brief  Index the records of a page, the later ones of a key win
+  * @param  pStore Store
+  * @param  Page   Page
+  * @retval Offset in the page following the last whole record
+  */
+static uint32_t KV_STORE_Scan(KV_STORE_t *pStore, uint32_t Page)
+{
+  uint32_t pos = KV_STORE_DW;
+  uint16_t key;
+  uint16_t length;
+
+  while ((pos < KV_STORE_PAGE_SIZE) && (KV_STORE_Check(pStore, (Page * KV_STORE_PAGE_SIZE) + pos, &key, &length) != 0U))
+  {
+    pStore->Index[key] = (Page * KV_STORE_PAGE_SIZE) + pos;
+    pos += KV_STORE_RECORD_SIZE(length);
+  }
+
+  return pos;
+}
+
+/**
+  * @brief  Erase a page
+  * @param  pStore Store
+  * @param  Page   Page
+  * @retval KV_STORE_OK or KV_STORE_ERROR
+  */
+static int32_t KV_STORE_Erase(KV_STORE_t *pStore, uint32_t Page)
+{
+  pStore->Stats.Erases++;
+  return (pStore->pFlash->Erase(pStore->Base + (Page * KV_STORE_PAGE_SIZE)) == 0) ? KV_STORE_OK : KV_STORE_ERROR;
+}
+
+/**
+  * @brief  Append a record to the active page, the data first, the header last
+  * @param  pStore Store
+  * @param  Key    Key
+  * @param  pData  Value, may be in the store
+  * @param  Length Value length, the record fits the page
+  * @retval KV_STORE_OK or KV_STORE_ERROR
+  */
+static int32_t KV_STORE_Append(KV_STORE_t *pStore, uint16_t Key, const uint8_t *pData, uint16_t Length)
+{
+  uint32_t offset = (pStore->Active * KV_STORE_PAGE_SIZE) + pStore->WritePos;
+  uint32_t i;
+  uint64_t dw;
+
+  for (i = 0; i < Length; i += KV_STORE_DW)
+  {
+    dw = KV_STORE_BLANK;
+    memcpy(&dw, &pData[i], ((Length - i) < KV_STORE_DW) ? (Length - i) : KV_STORE_DW);
+    if (pStore->pFlash->Program(pStore->Base + offset + KV_STORE_DW + i, dw) != 0)
+    {
+      pStore->WritePos = KV_STORE_PAGE_SIZE;
+      return KV_STORE_ERROR;
+    }
+  }
+
+  dw = (uint64_t)Key | ((uint64_t)Length << 16) | ((uint64_t)KV_STORE_Crc(Key, Length, pData) << 32);
+  if (pStore->pFlash->Program(pStore->Base + offset, dw) != 0)
+  {
+    pStore->WritePos = KV_STORE_PAGE_SIZE;
+    return KV_STORE_ERROR;
+  }
+
+  pStore->Index[Key] = offset;
+  pStore->WritePos += KV_STORE_RECORD_SIZE(Length);
+  return KV_STORE_OK;
+}
+
+/**
+  * @brief  Copy the records of a page still in use to the active page, then
+  *         erase the page
+  * @param  pStore Store
+  * @param  Page   Oldest page
+  * @retval KV_STORE_OK or KV_STORE_ERROR
+  */
+static int32_t KV_STORE_Collect(KV_STORE_t *pStore, uint32_t Page)
+{
+  uint32_t key;
+  uint32_t offset;
+  uint16_t length;
+
+  for (key = 0; key < KV_STORE_KEY_NBR; key++)
+  {
+    offset = pStore->Index[key];
+    if ((offset != 0U) && (KV_STORE_PAGE(offset) == Page))
+    {
+      length = (uint16_t)(KV_STORE_Get(pStore, offset) >> 16);
+      if (KV_STORE_Append(pStore, (uint16_t)key, (const uint8_t *)(pStore->Base + offset + KV_STORE_DW), length) != KV_STORE_OK)
+      {
+        return KV_STORE_ERROR;
+      }
+      pStore->Stats.Copies++;
+    }
+  }
+
+  /* Still blank while the pages are used for the first time */
+  if (KV_STORE_Is_Blank(pStore, Page * KV_STORE_PAGE_SIZE, (Page + 1U) * KV_STORE_PAGE_SIZE) != 0U)
+  {
+    return KV_STORE_OK;
+  }
+  return KV_STORE_Erase(pStore, Page);
+}
+
+/**
+  * @brief  Make an erased page the active one
+  * @param  pStore Store
+  * @param  Page   Page
+  * @retval KV_STORE_OK or KV_STORE_ERROR
+  */
+static int32_t KV_STORE_Open_Page(KV_STORE_t *pStore, uint32_t Page)
+{
+  if (pStore->pFlash->Program(pStore->Base + (Page * KV_STORE_PAGE_SIZE), KV_STORE_MAGIC | ((uint64_t)(pStore->Seq + 1U) << 32)) != 0)
+  {
+    return KV_STORE_ERROR;
+  }
+  pStore->Active = Page;
+  pStore->Seq++;
+  pStore->WritePos = KV_STORE_DW;
+  return KV_STORE_OK;
+}
+
+/**
+  * @brief  Start the erased page after the active one, and free the oldest
+  * @param  pStore Store
+  * @retval KV_STORE_OK or KV_STORE_ERROR
+  */
+static int32_t KV_STORE_Next_Page(KV_STORE_t *pStore)
+{
+  uint32_t page = (pStore->Active + 1U) % pStore->PageNbr;
+
+  if (KV_STORE_Open_Page(pStore, page) != KV_STORE_OK)
+  {
+    return KV_STORE_ERROR;
+  }
+  return KV_STORE_Collect(pStore, (page + 1U) % pStore->PageNbr);
+}
+
+/**
+  * @brief  Find the pages in use and index their records
+  * @param  pStore Store
+  * @retval KV_STORE_OK or KV_STORE_ERROR
+  */
+static int32_t KV_STORE_Mount(KV_STORE_t *pStore)
+{
+  uint32_t page;
+  uint32_t used;
+  uint32_t end = KV_STORE_DW;
+  uint32_t i;
+  uint64_t hdr;
+
+  /* Keep the pages with a header, the newest is the active one */
+  used = 0;
+  for (page = 0; page < pStore->PageNbr; page++)
+  {
+    hdr = KV_STORE_Get(pStore, page * KV_STORE_PAGE_SIZE);
+    if ((uint32_t)hdr == KV_STORE_MAGIC)
+    {
+      if ((used == 0U) || ((int32_t)((uint32_t)(hdr >> 32) - pStore->Seq) > 0))
+      {
+        pStore->Active = page;
+        pStore->Seq = (uint32_t)(hdr >> 32);
+      }
+      used++;
+    }
+    else if (KV_STORE_Is_Blank(pStore, page * KV_STORE_PAGE_SIZE, (page + 1U) * KV_STORE_PAGE_SIZE) == 0U)
+    {
+      if (KV_STORE_Erase(pStore, page) != KV_STORE_OK)
+      {
+        return KV_STORE_ERROR;
+      }
+    }
+  }
+
+  if (used == 0U)
+  {
+    return KV_STORE_Open_Page(pStore, 0);
+  }
+
+  /* The pages follow each other from the oldest, after the active one */
+  memset(pStore->Index, 0, sizeof(pStore->Index));
+  for (i = 1; i <= pStore->PageNbr; i++)
+  {
+    page = (pStore->Active + i) % pStore->PageNbr;
+    if ((uint32_t)KV_STORE_Get(pStore, page * KV_STORE_PAGE_SIZE) == KV_STORE_MAGIC)
+    {
+      end = KV_STORE_Scan(pStore, page);
+    }
+  }
+
+  /* Close the page after a record cut by a reset */
+  page = pStore->Active;
+  pStore->WritePos = end;
+  if (KV_STORE_Is_Blank(pStore, (page * KV_STORE_PAGE_SIZE) + end, (page + 1U) * KV_STORE_PAGE_SIZE) == 0U)
+  {
+    pStore->WritePos = KV_STORE_PAGE_SIZE;
+  }
+
+  if (used < pStore->PageNbr)
+  {
+    return KV_STORE_OK;
+  }
+
+  /* Reset during a page change: the oldest page is still there */
+  if (pStore->WritePos == KV_STORE_PAGE_SIZE)
+  {
+    /* The copy was cut, start it again */
+    if (KV_STORE_Erase(pStore, page) != KV_STORE_OK)
+    {
+      return KV_STORE_ERROR;
+    }
+    return KV_STORE_Mount(pStore);
+  }
+
+  return KV_STORE_Collect(pStore, (page + 1U) % pStore->PageNbr);
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
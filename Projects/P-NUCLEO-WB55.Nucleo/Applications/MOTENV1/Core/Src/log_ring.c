@@ -0,0 +1,362 @@
+/******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2016 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+/*
+ *      PROJECT:
+ *      $Revision: $
+ *      LANGUAGE:  ANSI C
+ */
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief Lock-free log ring implementation.
+ *
+ *  A record is a header of two words followed by the data, padded to
+ *  LOG_RING_ALIGN. The first word holds the free running position of the
+ *  record and is written last: a record is committed when it matches. A
+ *  record never wraps: a pad record fills the end of the ring instead.
+ *
+ *  The oldest record is freed by the consumer or, with LOG_RING_DROP_OLDEST,
+ *  by a producer: whoever claims it first, with a compare and swap of its
+ *  first word. The claimer marks every LOG_RING_ALIGN unit of the record
+ *  free before moving the tail, so free space never holds a word equal to
+ *  its position, whatever the data written there before.
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "log_ring.h"
+#include <string.h>
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define LOG_RING_FREE           1U              /*!< First word of a free unit, not a position */
+#define LOG_RING_FLAG_PAD       0x00010000U     /*!< Pad record, its length covers the header */
+#define LOG_RING_LEN_MASK       0x0000FFFFU     /*!< Length in the second header word         */
+#define LOG_RING_MIN_SIZE       64U             /*!< Smallest ring                            */
+#define LOG_RING_MAX_SIZE       0x10000U        /*!< Largest ring, pad length fits 16 bits    */
+
+#define logRingAlign( l )       (((l) + (LOG_RING_ALIGN - 1U)) & ~(LOG_RING_ALIGN - 1U))                          /*!< Record length in the ring */
+#define logRingOffset( r, p )   ((p) & ((r)->size - 1U))                                                          /*!< Offset of a position      */
+#define logRingSize( i )        ((((i) & LOG_RING_FLAG_PAD) != 0U) ? ((i) & LOG_RING_LEN_MASK) : (LOG_RING_HEADER_LEN + logRingAlign( (i) & LOG_RING_LEN_MASK ))) /*!< Record size in the ring */
+#define logRingWord( r, p, i )  (((volatile uint32_t *)(void *)&(r)->buf[logRingOffset( (r), (p) )])[(i)])        /*!< Header word of a record   */
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+static bool logRingCas(volatile uint32_t *ptr, uint32_t expected, uint32_t desired);
+static void logRingAdd(volatile uint32_t *cnt, uint32_t val);
+static bool logRingCommitted(const logRing *ring, uint32_t pos, uint32_t *info);
+static void logRingFree(logRing *ring, uint32_t pos, uint32_t info);
+static bool logRingDropOldest(logRing *ring, uint32_t tail);
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+ReturnCode logRingIni(logRing *ring, uint8_t *buf, uint32_t size, uint8_t policy)
+{
+    uint32_t pos;
+
+    if( (ring == NULL) || (buf == NULL) || (((uintptr_t)buf % LOG_RING_ALIGN) != 0U) )
+    {
+        return ERR_PARAM;
+    }
+    if( (size < LOG_RING_MIN_SIZE) || (size > LOG_RING_MAX_SIZE) || ((size & (size - 1U)) != 0U) )
+    {
+        return ERR_PARAM;
+    }
+
+    memset( ring, 0x00, sizeof(logRing) );
+    ring->buf    = buf;
+    ring->size   = size;
+    ring->policy = policy;
+
+    for( pos = 0U; pos < size; pos += LOG_RING_ALIGN )
+    {
+        logRingWord( ring, pos, 0U ) = LOG_RING_FREE;
+    }
+
+    return ERR_NONE;
+}
+
+/*******************************************************************************/
+uint16_t logRingMaxLen(const logRing *ring)
+{
+    /* A record and the pad before it always fit in the ring */
+    return (uint16_t)((ring->size / 2U) - LOG_RING_HEADER_LEN);
+}
+
+/*******************************************************************************/
+ReturnCode logRingPut(logRing *ring, const uint8_t *data, uint16_t len)
+{
+    uint32_t need;
+    uint32_t pad;
+    uint32_t head;
+    uint32_t tail;
+
+    if( len > logRingMaxLen( ring ) )
+    {
+        return ERR_PARAM;
+    }
+
+    need = LOG_RING_HEADER_LEN + logRingAlign( (uint32_t)len );
+
+    /* Reserve the record, and the pad up to the end of the ring if it does not fit before */
+    for(;;)
+    {
+        head = ring->head;
+        tail = ring->tail;
+        pad  = ring->size - logRingOffset( ring, head );
+        pad  = (pad >= need) ? 0U : pad;
+
+        if( (int32_t)(head - tail) < 0 )
+        {
+            continue;                                   /* head read before another put and the consumer moved on */
+        }
+
+        if( ((head + pad + need) - tail) > ring->size )
+        {
+            if( (ring->policy == LOG_RING_DROP_OLDEST) && logRingDropOldest( ring, tail ) )
+            {
+                continue;
+            }
+            logRingAdd( &ring->stats.droppedNewest, 1U );
+            return ERR_NOMEM;
+        }
+
+        if( logRingCas( &ring->head, head, (head + pad + need) ) )
+        {
+            break;
+        }
+    }
+
+    if( pad != 0U )
+    {
+        logRingWord( ring, head, 1U ) = (pad | LOG_RING_FLAG_PAD);
+        __DMB();
+        logRingWord( ring, head, 0U ) = head;
+        head += pad;
+    }
+
+    memcpy( &ring->buf[logRingOffset( ring, head ) + LOG_RING_HEADER_LEN], data, len );
+    logRingWord( ring, head, 1U ) = len;
+    __DMB();
+    logRingWord( ring, head, 0U ) = head;               /* Commit */
+
+    logRingAdd( &ring->stats.records, 1U );
+    logRingAdd( &ring->stats.bytes, len );
+    return ERR_NONE;
+}
+
+/*******************************************************************************/
+bool logRingAcquire(logRing *ring)
+{
+    return logRingCas( &ring->owner, 0U, 1U );
+}
+
+/*******************************************************************************/
+uint16_t logRingGet(logRing *ring, uint8_t *dst, uint16_t dstLen)
+{
+    uint32_t tail;
+    uint32_t info;
+    uint32_t len;
+    uint16_t cnt;
+
+    cnt = 0U;
+    for(;;)
+    {
+        tail = ring->tail;
+        if( !logRingCommitted( ring, tail, &info ) )
+        {
+            break;
+        }
+
+        len = ((info & LOG_RING_FLAG_PAD) != 0U) ? 0U : (info & LOG_RING_LEN_MASK);
+        if( (cnt + len) > dstLen )
+        {
+            if( cnt != 0U )
+            {
+                break;
+            }
+
+            /* Would never fit: drop it rather than stall the ring */
+            if( logRingCas( &logRingWord( ring, tail, 0U ), tail, LOG_RING_FREE ) )
+            {
+                logRingAdd( &ring->stats.droppedLong, 1U );
+                logRingFree( ring, tail, info );
+            }
+            continue;
+        }
+
+        /* A producer may have dropped the record meanwhile */
+        if( logRingCas( &logRingWord( ring, tail, 0U ), tail, LOG_RING_FREE ) )
+        {
+            memcpy( &dst[cnt], &ring->buf[logRingOffset( ring, tail ) + LOG_RING_HEADER_LEN], len );
+            cnt += (uint16_t)len;
+            if( len != 0U )
+            {
+                logRingAdd( &ring->stats.taken, 1U );
+            }
+            logRingFree( ring, tail, info );
+        }
+    }
+
+    return cnt;
+}
+
+/*******************************************************************************/
+bool logRingRelease(logRing *ring)
+{
+    uint32_t info;
+
+    __DMB();
+    ring->owner = 0U;
+    __DMB();
+
+    /* A record committed while its producer saw the ring owned is left to the caller */
+    return logRingCommitted( ring, ring->tail, &info );
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ *  \brief  Compare and swap
+ *
+ *  \return true : *ptr was expected and is now desired
+ *****************************************************************************
+ */
+static bool logRingCas(volatile uint32_t *ptr, uint32_t expected, uint32_t desired)
+{
+    do
+    {
+        if( __LDREXW( ptr ) != expected )
+        {
+            __CLREX();
+            return false;
+        }
+    }
+    while( __STREXW( desired, ptr ) != 0U );
+
+    __DMB();
+    return true;
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Atomic add to a statistics counter
+ *****************************************************************************
+ */
+static void logRingAdd(volatile uint32_t *cnt, uint32_t val)
+{
+    while( __STREXW( (__LDREXW( cnt ) + val), cnt ) != 0U )
+    {
+        /* Preempted, retry */
+    }
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Check the record at a position is committed
+ *
+ *  \param[in]  ring : ring
+ *  \param[in]  pos  : record position, the tail
+ *  \param[out] info : second header word: length and flags
+ *
+ *  \return true : committed record, info is valid if the record is claimed
+ *****************************************************************************
+ */
+static bool logRingCommitted(const logRing *ring, uint32_t pos, uint32_t *info)
+{
+    if( logRingWord( ring, pos, 0U ) != pos )
+    {
+        return false;
+    }
+    __DMB();
+    *info = logRingWord( ring, pos, 1U );
+    return true;
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Free the claimed record at the tail
+ *
+ *  \param[in,out] ring : ring
+ *  \param[in]     pos  : record position, the tail
+ *  \param[in]     info : second header word: length and flags
+ *****************************************************************************
+ */
+static void logRingFree(logRing *ring, uint32_t pos, uint32_t info)
+{
+    uint32_t unit;
+
+    for( unit = LOG_RING_ALIGN; unit < logRingSize( info ); unit += LOG_RING_ALIGN )
+    {
+        logRingWord( ring, (pos + unit), 0U ) = LOG_RING_FREE;
+    }
+    __DMB();
+    ring->tail = (pos + logRingSize( info ));
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Drop the oldest record to make room
+ *
+ *  \return true  : room may have been made, try again
+ *  \return false : the oldest record is still being written
+ *****************************************************************************
+ */
+static bool logRingDropOldest(logRing *ring, uint32_t tail)
+{
+    uint32_t info;
+
+    if( !logRingCommitted( ring, tail, &info ) )
+    {
+        return false;
+    }
+
+    if( logRingCas( &logRingWord( ring, tail, 0U ), tail, LOG_RING_FREE ) )
+    {
+        if( (info & LOG_RING_FLAG_PAD) == 0U )
+        {
+            logRingAdd( &ring->stats.droppedOldest, 1U );
+        }
+        logRingFree( ring, tail, info );
+    }
+    return true;
+}
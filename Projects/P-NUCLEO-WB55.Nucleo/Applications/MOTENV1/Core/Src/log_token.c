@@ -0,0 +1,358 @@
+/******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2016 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+/*
+ *      PROJECT:
+ *      $Revision: $
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief Tokenized log implementation.
+ *
+ *  The format is only walked to know the type of each argument: flags,
+ *  width and precision digits are skipped, the text is never formatted.
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "log_token.h"
+#include "logger.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define LOG_TOKEN_HDR_LEN       4U      /* Sync, length and token */
+
+#if defined(__ICCARM__)
+#pragma section = ".log_str"
+#define LOG_TOKEN_BASE          ((const char *)__section_begin(".log_str"))
+#else
+extern const char __log_str_start__[];
+#define LOG_TOKEN_BASE          __log_str_start__
+#endif
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! Record being built */
+typedef struct
+{
+    uint8_t  buf[LOG_TOKEN_MAX_LEN];    /*!< Record                          */
+    uint16_t len;                       /*!< Record length                   */
+    bool     full;                      /*!< An argument did not fit         */
+} logTokenRec;
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+static void logTokenRaw(logTokenRec *rec, const uint8_t *data, uint32_t len);
+static void logTokenVarint(logTokenRec *rec, uint64_t val);
+static void logTokenSigned(logTokenRec *rec, int64_t val);
+static void logTokenBytes(logTokenRec *rec, const uint8_t *data, uint32_t len, bool hex);
+static void logTokenString(logTokenRec *rec, const char *str);
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+void logTokenWrite(const char *fmt, ...)
+{
+    logTokenRec  rec;
+    va_list      args;
+    const char  *p;
+    uint8_t      lng;
+    float        flt;
+    uint32_t     token;
+
+    token      = (uint32_t)(fmt - LOG_TOKEN_BASE);
+    rec.buf[0] = LOG_TOKEN_SYNC;
+    rec.buf[2] = (uint8_t)token;
+    rec.buf[3] = (uint8_t)(token >> 8U);
+    rec.len    = LOG_TOKEN_HDR_LEN;
+    rec.full   = false;
+
+    va_start( args, fmt );
+    for( p = fmt; (*p != '\0') && !rec.full; p++ )
+    {
+        if( *p != '%' )
+        {
+            continue;
+        }
+        p++;
+
+        /* Flags */
+        while( (*p == '-') || (*p == '+') || (*p == ' ') || (*p == '#') || (*p == '0') )
+        {
+            p++;
+        }
+
+        /* Width and precision */
+        if( *p == '*' )
+        {
+            logTokenSigned( &rec, va_arg( args, int ) );
+            p++;
+        }
+        while( (*p >= '0') && (*p <= '9') )
+        {
+            p++;
+        }
+        if( *p == '.' )
+        {
+            p++;
+            if( *p == '*' )
+            {
+                logTokenSigned( &rec, va_arg( args, int ) );
+                p++;
+            }
+            while( (*p >= '0') && (*p <= '9') )
+            {
+                p++;
+            }
+        }
+
+        /* Length: 0 int, 1 long, 2 long long, 3 size_t and alike */
+        lng = 0U;
+        for(;; p++)
+        {
+            if( *p == 'l' )
+            {
+                lng++;
+            }
+            else if( (*p == 'z') || (*p == 'j') || (*p == 't') )
+            {
+                lng = 3U;
+            }
+            else if( (*p != 'h') && (*p != 'L') )
+            {
+                break;
+            }
+        }
+
+        switch( *p )
+        {
+            case 'd':
+            case 'i':
+                if( lng == 1U )
+                {
+                    logTokenSigned( &rec, va_arg( args, long ) );
+                }
+                else if( lng == 2U )
+                {
+                    logTokenSigned( &rec, va_arg( args, long long ) );
+                }
+                else if( lng == 3U )
+                {
+                    logTokenSigned( &rec, va_arg( args, ptrdiff_t ) );
+                }
+                else
+                {
+                    logTokenSigned( &rec, va_arg( args, int ) );
+                }
+                break;
+
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'c':
+                if( lng == 1U )
+                {
+                    logTokenVarint( &rec, va_arg( args, unsigned long ) );
+                }
+                else if( lng == 2U )
+                {
+                    logTokenVarint( &rec, va_arg( args, unsigned long long ) );
+                }
+                else if( lng == 3U )
+                {
+                    logTokenVarint( &rec, va_arg( args, size_t ) );
+                }
+                else
+                {
+                    logTokenVarint( &rec, va_arg( args, unsigned int ) );
+                }
+                break;
+
+            case 'p':
+                logTokenVarint( &rec, (uintptr_t)va_arg( args, void* ) );
+                break;
+
+            case 's':
+                logTokenString( &rec, va_arg( args, const char* ) );
+                break;
+
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                flt = (float)va_arg( args, double );
+                logTokenRaw( &rec, (const uint8_t*)&flt, sizeof(flt) );
+                break;
+
+            case 'n':
+                (void)va_arg( args, void* );
+                break;
+
+            case '%':
+                break;
+
+            default:
+                rec.full = true;                        /* Unknown conversion, the arguments cannot be walked */
+                break;
+        }
+
+        if( *p == '\0' )
+        {
+            break;
+        }
+    }
+    va_end( args );
+
+    rec.buf[1] = (uint8_t)(rec.len - 2U);
+    logUsartTx( rec.buf, rec.len );
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ *  \brief  Append bytes if they fit, else mark the record full
+ *****************************************************************************
+ */
+static void logTokenRaw(logTokenRec *rec, const uint8_t *data, uint32_t len)
+{
+    if( (rec->len + len) > LOG_TOKEN_MAX_LEN )
+    {
+        rec->full = true;
+        return;
+    }
+    memcpy( &rec->buf[rec->len], data, len );
+    rec->len += (uint16_t)len;
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Append an unsigned varint: 7 bits per byte, LSB first
+ *****************************************************************************
+ */
+static void logTokenVarint(logTokenRec *rec, uint64_t val)
+{
+    uint8_t  tmp[10];
+    uint16_t n;
+
+    n = 0U;
+    do
+    {
+        tmp[n] = (uint8_t)(val & 0x7FU);
+        val  >>= 7U;
+        if( val != 0U )
+        {
+            tmp[n] |= 0x80U;
+        }
+        n++;
+    }
+    while( val != 0U );
+
+    logTokenRaw( rec, tmp, n );
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Append a signed varint, zigzag encoded
+ *****************************************************************************
+ */
+static void logTokenSigned(logTokenRec *rec, int64_t val)
+{
+    logTokenVarint( rec, (((uint64_t)val << 1U) ^ (uint64_t)(val >> 63U)) );
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Append a byte array: its length and the hex flag, then the bytes
+ *
+ *  The array is truncated to the room left in the record.
+ *****************************************************************************
+ */
+static void logTokenBytes(logTokenRec *rec, const uint8_t *data, uint32_t len, bool hex)
+{
+    uint32_t room;
+
+    room = (uint32_t)LOG_TOKEN_MAX_LEN - rec->len;
+    room = (room > 2U) ? (room - 2U) : 0U;          /* Length varint fits 2 bytes */
+    if( len > room )
+    {
+        len       = room;
+        rec->full = true;
+    }
+
+    logTokenVarint( rec, (((uint64_t)len << 1U) | (hex ? 1U : 0U)) );
+    logTokenRaw( rec, data, len );
+}
+
+/*!
+ *****************************************************************************
+ *  \brief  Append a string, or the raw bytes of a hex2Str() result
+ *****************************************************************************
+ */
+static void logTokenString(logTokenRec *rec, const char *str)
+{
+    if( str == NULL )
+    {
+        str = "(null)";
+    }
+
+    if( (uint8_t)str[0] == LOG_TOKEN_HEX )
+    {
+        logTokenBytes( rec, (const uint8_t*)&str[2], (uint8_t)str[1], true );
+    }
+    else
+    {
+        logTokenBytes( rec, (const uint8_t*)str, strlen( str ), false );
+    }
+}
@@ -40,6 +40,8 @@
 #include "usart.h"
 #include "logger.h"
 #include "st_errno.h"
+#include "log_ring.h"
+#include "log_token.h"
 #include <string.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -59,11 +61,25 @@ char hexStr[MAX_HEX_STR][MAX_HEX_STR_LENGTH];
 uint8_t hexStrIdx = 0;
 #endif /* #if USE_LOGGER == LOGGER_ON */
 
-#define USART_TIMEOUT          1000
+#ifndef LOG_USART_RING_SIZE
+#define LOG_USART_RING_SIZE    4096U                 /* Log ring size, a power of two        */
+#endif
+#ifndef LOG_USART_DROP_POLICY
+#define LOG_USART_DROP_POLICY  LOG_RING_DROP_NEWEST  /* Records dropped when the ring is full */
+#endif
+#define LOG_USART_DMA_LEN      256U                  /* Longest DMA transfer, longest record  */
 
 UART_HandleTypeDef *pLogUsart = 0;
 uint8_t logUsartTx(uint8_t *data, uint16_t dataLen);
 
+static logRing  logUsartRing;
+static uint64_t logUsartRingBuf[LOG_USART_RING_SIZE / sizeof(uint64_t)];
+static uint8_t  logUsartDmaBuf[LOG_USART_DMA_LEN];
+static uint32_t logUsartLost;          /* Records taken from the ring but not sent */
+
+static void logUsartKick(void);
+static void logUsartDrain(void);
+
 /**
   * @brief  This function initalize the UART handle.
 	* @param	husart : already initalized handle to USART HW
@@ -71,22 +87,113 @@ uint8_t logUsartTx(uint8_t *data, uint16_t dataLen);
   */
 void logUsartInit(UART_HandleTypeDef *husart)
 {
+    logRingIni(&logUsartRing, (uint8_t*)logUsartRingBuf, sizeof(logUsartRingBuf), LOG_USART_DROP_POLICY);
     pLogUsart = husart;
 }
 
 /**
-  * @brief  This function Transmit data via USART
+  * @brief  This function queues data to be transmitted via USART
+  *         The data is copied in the log ring and sent by DMA, the call
+  *         does not wait for the transfer.
 	* @param	data : data to be transmitted
 	* @param	dataLen : length of data to be transmitted
-  * @retval ERR_INVALID_HANDLE : in case the SPI HW is not initalized yet
-  * @retval others : HAL status
+  * @retval ERR_INVALID_HANDLE : in case the USART HW is not initalized yet
+  * @retval ERR_NOMEM : log ring full, data dropped
+  * @retval ERR_NONE : data queued
   */
 uint8_t logUsartTx(uint8_t *data, uint16_t dataLen)
 {
+  ReturnCode err = ERR_NONE;
+  uint16_t   len;
+
   if(pLogUsart == 0)
     return ERR_INVALID_HANDLE;
 
-  return HAL_UART_Transmit(pLogUsart, data, dataLen, USART_TIMEOUT);
+  /* Records longer than a DMA transfer are split */
+  while(dataLen > 0)
+  {
+    len = (dataLen < LOG_USART_DMA_LEN) ? dataLen : LOG_USART_DMA_LEN;
+    if(logRingPut(&logUsartRing, data, len) != ERR_NONE)
+    {
+      err = ERR_NOMEM;
+    }
+    data    += len;
+    dataLen -= len;
+  }
+
+  logUsartKick();
+  return (uint8_t)err;
+}
+
+/**
+  * @brief  USART Tx complete: next DMA transfer from the log ring
+	* @param	huart : UART handle of the completed transfer
+  * @retval none
+  */
+void logUsartTxCpltCallback(UART_HandleTypeDef *huart)
+{
+  if((pLogUsart != 0) && (huart == pLogUsart))
+  {
+    logUsartDrain();
+  }
+}
+
+/**
+  * @brief  Log records lost: log ring full, record too long or DMA not started
+  * @retval number of records lost
+  */
+uint32_t logUsartDropped(void)
+{
+  return (logUsartRing.stats.droppedNewest + logUsartRing.stats.droppedOldest +
+          logUsartRing.stats.droppedLong + logUsartLost);
+}
+
+/**
+  * @brief  Check whether the log ring is drained
+  * @retval true when no DMA transfer is ongoing
+  */
+bool logUsartIsIdle(void)
+{
+  return (logUsartRing.owner == 0U);
+}
+
+/**
+  * @brief  Start a DMA transfer if none is ongoing
+  * @retval none
+  */
+static void logUsartKick(void)
+{
+  if(logRingAcquire(&logUsartRing))
+  {
+    logUsartDrain();
+  }
+}
+
+/**
+  * @brief  Send the committed records, the caller owns the log ring
+  *         The ring stays owned until the Tx complete callback.
+  * @retval none
+  */
+static void logUsartDrain(void)
+{
+  uint32_t taken;
+  uint16_t len;
+
+  do
+  {
+    taken = logUsartRing.stats.taken;
+    len   = logRingGet(&logUsartRing, logUsartDmaBuf, sizeof(logUsartDmaBuf));
+    if(len != 0)
+    {
+      if(HAL_UART_Transmit_DMA(pLogUsart, logUsartDmaBuf, len) == HAL_OK)
+      {
+        return;
+      }
+      /* The records are out of the ring already */
+      logUsartLost += (logUsartRing.stats.taken - taken);
+    }
+  }
+  while(logRingRelease(&logUsartRing) && logRingAcquire(&logUsartRing));
 }
 
 int logUsart(const char* format, ...)
@@ -118,10 +225,20 @@ char* hex2Str(unsigned char * data, size_t dataLen)
   #if (USE_LOGGER == LOGGER_ON)
   {
     unsigned char * pin = data;
-    const char * hex = "0123456789ABCDEF";
     char * pout = hexStr[hexStrIdx];
-    uint8_t i = 0;
     uint8_t idx = hexStrIdx;
+    #if LOGGER_TOKENIZED
+    /* The bytes are dumped in hex by the decoder */
+    if(dataLen > (MAX_HEX_STR_LENGTH - 2))
+    {
+      dataLen = MAX_HEX_STR_LENGTH - 2;
+    }
+    pout[0] = (char)LOG_TOKEN_HEX;
+    pout[1] = (char)dataLen;
+    memcpy(&pout[2], pin, dataLen);
+    #else
+    const char * hex = "0123456789ABCDEF";
+    uint8_t i = 0;
     if(dataLen == 0)
     {
       pout[0] = 0;     
@@ -137,6 +254,7 @@ char* hex2Str(unsigned char * data, size_t dataLen)
       *pout++ = hex[(*pin)&0xF];
       *pout = 0;
     }    
+    #endif /* LOGGER_TOKENIZED */
     
     hexStrIdx++;
     hexStrIdx %= MAX_HEX_STR;
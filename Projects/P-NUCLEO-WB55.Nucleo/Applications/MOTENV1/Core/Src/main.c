@@ -76,9 +76,6 @@ SPI_HandleTypeDef hspi1;
 /* Private variables ---------------------------------------------------------*/
 
 
-extern uint8_t tx_uart_pending;
-extern uint8_t string_buff[VCARD_STRING_SIZE];      
-
 uint8_t demoCycleEnable = 0;
 #endif
 /* USER CODE END PV */
@@ -201,20 +198,8 @@ int main(void)
   /* USER CODE BEGIN WHILE */
   while(1)
   {
+    /* The NFC reader runs in CFG_TASK_NFC_ID, see NFC_Process() */
   	UTIL_SEQ_Run( UTIL_SEQ_DEFAULT ); 
-        
-#ifdef NFC_ENABLE        
-	if (demoCycleEnable)
-	{
-	  demoCycle();
-	}
-
-	if (tx_uart_pending)
-	{
-	  /* TRACE - Send the received NDEF string via UART */
-	  HAL_UART_Transmit_DMA(&hlpuart1, (uint8_t*)string_buff, VCARD_STRING_SIZE);
-	}
-#endif                
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -51,6 +51,13 @@
 #include "ndef_message.h"
 #include "ndef_types_rtd.h"
 #include "ndef_dump.h"
+#include "nfc_wakeup.h"
+#include "nfcv_inventory.h"
+#include "nfcv_mailbox.h"
+#include "nfc_llcp.h"
+#include "nfc_snep.h"
+#include "demo_ce.h"
+#include "nfc_t4t_ce.h"
 #include "app_conf.h"   
 #include "stm32_seq.h"  
 
@@ -64,6 +71,26 @@
 #define DEMO_ST_NOTINIT               0  /*!< Demo State:  Not initialized */
 #define DEMO_ST_START_DISCOVERY       1  /*!< Demo State:  Start Discovery */
 #define DEMO_ST_DISCOVERY             2  /*!< Demo State:  Discovery       */
+#define DEMO_ST_START_WAKEUP          3  /*!< Demo State:  Start Wake-Up   */
+#define DEMO_ST_WAKEUP                4  /*!< Demo State:  Wake-Up         */
+
+#ifndef DEMO_LOW_POWER_DETECTION
+#define DEMO_LOW_POWER_DETECTION      0  /*!< Discover only after a Wake-Up mode detection, see nfc_wakeup.h */
+#endif
+#define DEMO_WAKEUP_DISCOVERY_WINDOW  1200U /*!< Discovery time after a wake-up before declaring it false [ms] */
+#define DEMO_WAKEUP_DISCOVERY_PERIOD  100U  /*!< Poll period during that time: a device is expected [ms]  */
+
+#ifndef DEMO_NFCV_MULTI_TAG
+#define DEMO_NFCV_MULTI_TAG           0  /*!< Inventory and read all the NFC-V tags in the field, see nfcv_inventory.h */
+#endif
+#ifndef DEMO_NFCV_MAILBOX
+#define DEMO_NFCV_MAILBOX             0  /*!< Receive a message through the ST25DV mailbox instead of reading the NDEF, see nfcv_mailbox.h */
+#endif
+#define DEMO_NFCV_MAILBOX_BUF_LEN     4096U /*!< Longest message received through the mailbox */
+#ifndef DEMO_CARD_EMULATION
+#define DEMO_CARD_EMULATION           0  /*!< Also listen as NFC-A and emulate a Type 4 Tag, see nfc_t4t_ce.h */
+#endif
+#define DEMO_CE_BUF_LEN               (T4T_CE_MLE + T4T_CE_SW_LEN)  /*!< Longest R-APDU of the emulated tag */
 
 #define NDEF_DEMO_READ              0U   /*!< NDEF menu read               */
 #define NDEF_DEMO_WRITE_MSG1        1U   /*!< NDEF menu write 1 record     */
@@ -92,7 +119,6 @@ extern uint8_t demoCycleEnable;     //[STM]
 
 /* P2P communication data */
 static uint8_t NFCID3[] = {0x01, 0xFE, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A};
-static uint8_t GB[] = {0x46, 0x66, 0x6d, 0x01, 0x01, 0x11, 0x02, 0x02, 0x07, 0x80, 0x03, 0x02, 0x00, 0x03, 0x04, 0x01, 0x32, 0x07, 0x01, 0x03};
     
 #if defined(ST25R3916) && defined(RFAL_FEATURE_LISTEN_MODE)
 /* NFC-A CE config */
@@ -110,12 +136,10 @@ static uint8_t ceNFCF_SENSF_RES[]  = {0x01,
 #endif /* RFAL_FEATURE_LISTEN_MODE */
 
 /* P2P communication data */    
-static uint8_t ndefLLCPSYMM[] = {0x00, 0x00};
-static uint8_t ndefInit[] = {0x05, 0x20, 0x06, 0x0F, 0x75, 0x72, 0x6E, 0x3A, 0x6E, 0x66, 0x63, 0x3A, 0x73, 0x6E, 0x3A, 0x73, 0x6E, 0x65, 0x70, 0x02, 0x02, 0x07, 0x80, 0x05, 0x01, 0x02};
-static const uint8_t ndefSnepPrefix[] = { 0x13, 0x20, 0x00, 0x10, 0x02, 0x00, 0x00, 0x00 };
 static const uint8_t URL[] = "st.com";
 static ndefConstBuffer bufURL = { URL, sizeof(URL) - 1 };
-static uint8_t ndefUriBuffer[255]; 
+static uint8_t ndefUriBuffer[LLCP_MIU]; 
+static uint32_t p2pRxLength;
 
 static uint8_t *ndefStates[] =
 {
@@ -163,6 +187,9 @@ static uint8_t              rawMessageBuf[DEMO_RAW_MESSAGE_BUF_LEN];
 
 static uint32_t             timer;
 static uint32_t             timerLed;
+#if DEMO_LOW_POWER_DETECTION
+static uint32_t             timerDiscovery;
+#endif /* DEMO_LOW_POWER_DETECTION */
 static bool                 ledOn;
 
 /*
@@ -171,7 +198,13 @@ static bool                 ledOn;
 ******************************************************************************
 */
 
-static void demoNdef(rfalNfcDevice *nfcDevice);
+static ReturnCode demoNdef(rfalNfcDevice *nfcDevice);
+#if DEMO_NFCV_MULTI_TAG
+static void demoNfcvMultiTag(void);
+#endif /* DEMO_NFCV_MULTI_TAG */
+#if DEMO_NFCV_MAILBOX
+static ReturnCode demoNfcvMailbox(rfalNfcDevice *nfcDevice);
+#endif /* DEMO_NFCV_MAILBOX */
 static void ndefCCDump(ndefContext *ctx);
 static void ndefDumpSysInfo(ndefContext *ctx);
 
@@ -180,12 +213,23 @@ static bool ndefIsSTTag(ndefContext *ctx);
 static void LedNotificationWriteDone(void);
 #endif /* NDEF_FEATURE_ALL */
 
-static void demoP2P( void );
+static uint8_t demoP2PIni( uint8_t *gb, uint8_t gbLen );
+static void demoP2P( rfalNfcDevice *nfcDevice );
+static ReturnCode demoP2PRxBegin( uint8_t code, uint32_t length );
+static ReturnCode demoP2PRxData( const uint8_t *buf, uint16_t len );
+static void demoP2PRxEnd( ReturnCode err );
+#if DEMO_CARD_EMULATION && defined(ST25R3916) && defined(RFAL_FEATURE_LISTEN_MODE)
+static void demoCE( rfalNfcDevice *nfcDevice );
+#endif /* DEMO_CARD_EMULATION */
 ReturnCode  demoTransceiveBlocking( uint8_t *txBuf, uint16_t txBufSize, uint8_t **rxBuf, uint16_t **rcvLen, uint32_t fwt );
 
 static void ledsOn(void);
 static void ledsOff(void);
 
+/* SNEP server: messages pushed by the device, PUT only */
+static const snepSink         p2pSink         = { demoP2PRxBegin, demoP2PRxData, demoP2PRxEnd };
+static const snepServerConfig p2pServerConfig = { &p2pSink, NULL };
+
 /*!
  *****************************************************************************
  * \brief Check user button
@@ -266,8 +310,7 @@ bool demoIni( void )
         discParam.ap2pBR        = RFAL_BR_424;
 
         ST_MEMCPY( &discParam.nfcid3, NFCID3, sizeof(NFCID3) );
-        ST_MEMCPY( &discParam.GB, GB, sizeof(GB) );
-        discParam.GBLen         = sizeof(GB);
+        discParam.GBLen         = demoP2PIni( discParam.GB, sizeof(discParam.GB) );
 
         discParam.notifyCb             = NULL;
         discParam.totalDuration        = 1000U;
@@ -298,7 +341,25 @@ bool demoIni( void )
 //      
 //#endif /* ST25R3916 */
 
+#if DEMO_CARD_EMULATION && defined(ST25R3916) && defined(RFAL_FEATURE_LISTEN_MODE)
+        /* Set configuration for NFC-A CE, answered as a Type 4 Tag by demoCE() */
+        ST_MEMCPY( discParam.lmConfigPA.SENS_RES, ceNFCA_SENS_RES, RFAL_LM_SENS_RES_LEN );
+        ST_MEMCPY( discParam.lmConfigPA.nfcid, ceNFCA_NFCID, sizeof(ceNFCA_NFCID) );
+        discParam.lmConfigPA.nfcidLen = RFAL_LM_NFCID_LEN_07;
+        discParam.lmConfigPA.SEL_RES  = ceNFCA_SEL_RES;
+
+        discParam.techs2Find |= RFAL_NFC_LISTEN_TECH_A;
+
+        demoCeInit( ceNFCF_nfcid2 );
+#endif /* DEMO_CARD_EMULATION */
+
+#if DEMO_LOW_POWER_DETECTION
+        discParam.totalDuration = DEMO_WAKEUP_DISCOVERY_PERIOD;
+        nfcWakeupIni();
+        state = DEMO_ST_START_WAKEUP;
+#else
         state = DEMO_ST_START_DISCOVERY;
+#endif /* DEMO_LOW_POWER_DETECTION */
         return true;
     }
     return false;
@@ -385,14 +446,45 @@ void demoCycle( void )
             rfalNfcDeactivate( false );
             rfalNfcDiscover( &discParam );
 
+#if DEMO_LOW_POWER_DETECTION
+            timerDiscovery = platformTimerCreate(DEMO_WAKEUP_DISCOVERY_WINDOW);
+#endif /* DEMO_LOW_POWER_DETECTION */
             state = DEMO_ST_DISCOVERY;
             break;
 
+#if DEMO_LOW_POWER_DETECTION
+        /*******************************************************************************/
+        case DEMO_ST_START_WAKEUP:
+            ledsOff();
+
+            rfalNfcDeactivate( false );
+            if( nfcWakeupStart() == ERR_NONE )
+            {
+                state = DEMO_ST_WAKEUP;
+            }
+            else
+            {
+                state = DEMO_ST_START_DISCOVERY;     /* Fall back on continuous discovery */
+            }
+            break;
+
+        /*******************************************************************************/
+        case DEMO_ST_WAKEUP:
+            if( nfcWakeupHasWoken() )
+            {
+                state = DEMO_ST_START_DISCOVERY;
+            }
+            break;
+#endif /* DEMO_LOW_POWER_DETECTION */
+
         /*******************************************************************************/
         case DEMO_ST_DISCOVERY:
             if( rfalNfcIsDevActivated( rfalNfcGetState() ) )
             {
                 rfalNfcGetActiveDevice( &nfcDevice );
+#if DEMO_LOW_POWER_DETECTION
+                nfcWakeupDiscoveryDone( true );
+#endif /* DEMO_LOW_POWER_DETECTION */
                 
                 ledsOff();
 
@@ -429,7 +521,7 @@ void demoCycle( void )
                             case RFAL_NFCA_T4T_NFCDEP:
                             case RFAL_NFCA_NFCDEP:
                                 platformLog("NFCA Passive P2P device found. NFCID: %s\r\n", hex2Str( nfcDevice->nfcid, nfcDevice->nfcidLen ) );
-                                demoP2P();
+                                demoP2P( nfcDevice );
                                 break;
                                 
                             default:
@@ -490,7 +582,7 @@ void demoCycle( void )
                         if( rfalNfcfIsNfcDepSupported( &nfcDevice->dev.nfcf ) )
                         {
                             platformLog("NFCF Passive P2P device found. NFCID: %s\r\n", hex2Str( nfcDevice->nfcid, nfcDevice->nfcidLen ) );
-                            demoP2P();
+                            demoP2P( nfcDevice );
                         }
                         else
                         {
@@ -525,7 +617,16 @@ void demoCycle( void )
                         
                             platformLedOn(PLATFORM_LED_V_PORT, PLATFORM_LED_V_PIN);
                             
+#if DEMO_NFCV_MAILBOX
+                            if( demoNfcvMailbox(nfcDevice) == ERR_DISABLED )
+                            {
+                                demoNdef(nfcDevice);
+                            }
+#elif DEMO_NFCV_MULTI_TAG
+                            demoNfcvMultiTag();
+#else
                             demoNdef(nfcDevice);  
+#endif /* DEMO_NFCV_MULTI_TAG */
 
                             /* Loop until tag is removed from the field */
                             platformLog("Operation completed\r\nTag can be removed from the field\r\n");
@@ -551,9 +652,20 @@ void demoCycle( void )
                         platformLog("NFC Active P2P device found. NFCID3: %s\r\n", hex2Str(nfcDevice->nfcid, nfcDevice->nfcidLen));
                         platformLedOn(PLATFORM_LED_AP2P_PORT, PLATFORM_LED_AP2P_PIN);
                     
-                        demoP2P();
+                        demoP2P( nfcDevice );
                         break;
-                    
+
+#if DEMO_CARD_EMULATION && defined(ST25R3916) && defined(RFAL_FEATURE_LISTEN_MODE)
+                    /*******************************************************************************/
+                    case RFAL_NFC_POLL_TYPE_NFCA:
+
+                        platformLog("Activated in CE NFC-A mode.\r\n");
+                        platformLedOn(PLATFORM_LED_A_PORT, PLATFORM_LED_A_PIN);
+
+                        demoCE( nfcDevice );
+                        break;
+#endif /* DEMO_CARD_EMULATION */
+
                     /*******************************************************************************/
                     default:
                         break;
@@ -561,8 +673,21 @@ void demoCycle( void )
              
                 //rfalNfcDeactivate( false );   //[STM], Leave NFC reader activated so it's always energizing the smartag. per John T
 
+#if DEMO_LOW_POWER_DETECTION
+                state = DEMO_ST_START_WAKEUP;
+#else
                 state = DEMO_ST_START_DISCOVERY;
+#endif /* DEMO_LOW_POWER_DETECTION */
             }
+#if DEMO_LOW_POWER_DETECTION
+            else if( platformTimerIsExpired(timerDiscovery) )
+            {
+                /* Woken up by something else than a device */
+                rfalNfcDeactivate( false );
+                nfcWakeupDiscoveryDone( false );
+                state = DEMO_ST_START_WAKEUP;
+            }
+#endif /* DEMO_LOW_POWER_DETECTION */
             break;
 
         /*******************************************************************************/
@@ -574,57 +699,97 @@ void demoCycle( void )
 }
 
 
+/*!
+ *****************************************************************************
+ * \brief Demo Idle Time
+ *
+ *  Tells how long demoCycle() can be left uncalled, unless the ST25R3916
+ *  raises its IRQ meanwhile. Only the Wake-Up mode, in Read mode, lets the
+ *  MCU stop: the other states poll the RFAL worker and the demo timers.
+ *
+ * \return 0                 : call demoCycle() again
+ * \return DEMO_IDLE_FOREVER : wait for the ST25R3916 IRQ
+ * \return other             : ms to the next demoCycle() call
+ *****************************************************************************
+ */
+uint32_t demoIdleTime( void )
+{
+    switch( state )
+    {
+#if DEMO_LOW_POWER_DETECTION
+        case DEMO_ST_WAKEUP:
+            if( ndefDemoFeature == NDEF_DEMO_READ )
+            {
+                return nfcWakeupIdleTime();
+            }
+            return 0;
+#endif /* DEMO_LOW_POWER_DETECTION */
+
+        case DEMO_ST_NOTINIT:
+            return DEMO_IDLE_FOREVER;
+
+        default:
+            return 0;
+    }
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Demo P2P Ini
+ *
+ * Initializes LLCP and binds the SNEP client and server
+ *
+ * \param[out] gb    : General Bytes for the ATR_REQ
+ * \param[in]  gbLen : size of gb
+ *
+ * \return length of the General Bytes
+ *****************************************************************************
+ */
+static uint8_t demoP2PIni( uint8_t *gb, uint8_t gbLen )
+{
+    (void)llcpInit();
+    (void)snepClientIni();
+    (void)snepServerIni( &p2pServerConfig );
+
+    return llcpGetGeneralBytes( gb, gbLen );
+}
+
+
 /*!
  *****************************************************************************
  * \brief Demo P2P Exchange
  *
  * Sends a NDEF URI record 'http://www.ST.com' via NFC-DEP (P2P) protocol.
  * 
- * This method sends a set of static predefined frames which tries to establish
- * a LLCP connection, followed by the NDEF record, and then keeps sending 
- * LLCP SYMM packets to maintain the connection.
- * 
+ * The LLCP link is activated and the SNEP client pushes the record in a PUT
+ * request. The link is then kept by the LLCP worker until the device is
+ * removed, and the SNEP server dumps the messages the device pushes.
  * 
+ * \param[in] nfcDevice : activated NFC-DEP device
  *****************************************************************************
  */
-void demoP2P( void )
+static void demoP2P( rfalNfcDevice *nfcDevice )
 {
-    uint16_t   *rxLen;
-    uint8_t    *rxData;
-    ReturnCode err;
+    ReturnCode      err;
+    ReturnCode      put;
+    llcpStats       stats;
 
-    ndefBuffer  bufPayload;
-    ndefMessage message;
-    ndefRecord  record;
-    ndefType    uri;
+    ndefBuffer      bufPayload;
+    ndefConstBuffer bufMessage;
+    ndefMessage     message;
+    ndefRecord      record;
+    ndefType        uri;
 
-    platformLog(" Initalize device .. ");
-    err = demoTransceiveBlocking( ndefInit, sizeof(ndefInit), &rxData, &rxLen, RFAL_FWT_NONE);
-    if( err != ERR_NONE )
-    {
-        platformLog("failed.");
-        return;
-    }
-    platformLog("succeeded.\r\n");
-    
     err  = ndefRtdUri(&uri, NDEF_URI_PREFIX_HTTP_WWW, &bufURL);
     err |= ndefRtdUriToRecord(&uri, &record);
 
     err |= ndefMessageInit(&message);
     err |= ndefMessageAppend(&message, &record);  /* To get MB and ME bits set */
 
-    /* Build the SNEP buffer made of the prefix, the length byte and the record */
-    ST_MEMCPY(ndefUriBuffer, ndefSnepPrefix, sizeof(ndefSnepPrefix));
-
-    /* Skip 1 byte for length byte */
-    bufPayload.buffer = ndefUriBuffer + sizeof(ndefSnepPrefix) + 1;
-    bufPayload.length = sizeof(ndefUriBuffer) - sizeof(ndefSnepPrefix);
-    err |= ndefMessageEncode(&message, &bufPayload);
-
-    ndefUriBuffer[sizeof(ndefSnepPrefix)] = bufPayload.length;
-
     bufPayload.buffer = ndefUriBuffer;
-    bufPayload.length = sizeof(ndefSnepPrefix) + 1 + bufPayload.length;
+    bufPayload.length = sizeof(ndefUriBuffer);
+    err |= ndefMessageEncode(&message, &bufPayload);
 
     if( err != ERR_NONE )
     {
@@ -632,26 +797,101 @@ void demoP2P( void )
         return;
     }
 
-    ndefBufferDump("URL converted to SNEP:\r\n", (ndefConstBuffer*)&bufPayload, true);
+    bufMessage.buffer = bufPayload.buffer;
+    bufMessage.length = bufPayload.length;
+    ndefBufferDump("URL converted to NDEF:\r\n", &bufMessage, true);
 
-    platformLog(" Push NDEF Uri: www.ST.com .. ");
-    err = demoTransceiveBlocking(bufPayload.buffer, bufPayload.length, &rxData, &rxLen, RFAL_FWT_NONE);
+    platformLog(" Initalize device .. ");
+    err = llcpActivate( nfcDevice );
     if( err != ERR_NONE )
     {
-        platformLog("failed.");
+        platformLog("failed.\r\n");
         return;
     }
     platformLog("succeeded.\r\n");
 
+    /* The request is sent, fragmented if needed, once connected to the SNEP server */
+    platformLog(" Push NDEF Uri: www.ST.com .. ");
+    put = snepClientPut( &bufMessage );
+    if( put != ERR_NONE )
+    {
+        platformLog("failed.\r\n");
+    }
+
+    do
+    {
+        rfalNfcWorker();
+        llcpWorker();
+        snepWorker();
+
+        if( (put == ERR_NONE) && (snepClientGetStatus() != ERR_BUSY) )
+        {
+            put = snepClientGetStatus();
+            platformLog("%s.\r\n", (put == ERR_NONE) ? "succeeded" : "failed");
+            platformLog(" Device present, maintaining connection\r\n");
+            put = ERR_DONE;
+        }
+
+        err = llcpWorkerGetStatus();
+    }
+    while( (err == ERR_NONE) || (err == ERR_BUSY) );
+
+    llcpGetStats( &stats );
+    platformLog(" Device removed, %d frames, %d SYMM, %d AGF.\r\n", stats.frames, stats.symm, stats.agf);
+    (void)llcpDeactivate();
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Demo P2P SNEP server sink
+ *
+ * Messages pushed by the device are gathered in the raw message buffer and
+ * dumped once complete; larger ones are refused.
+ *****************************************************************************
+ */
+static ReturnCode demoP2PRxBegin( uint8_t code, uint32_t length )
+{
+    if( (code != SNEP_REQ_PUT) || (length > sizeof(rawMessageBuf)) )
+    {
+        platformLog(" SNEP request refused (%d bytes)\r\n", length);
+        return ERR_NOMEM;
+    }
+
+    p2pRxLength = 0;
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+static ReturnCode demoP2PRxData( const uint8_t *buf, uint16_t len )
+{
+    ST_MEMCPY( &rawMessageBuf[p2pRxLength], buf, len );
+    p2pRxLength += len;
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+static void demoP2PRxEnd( ReturnCode err )
+{
+    ndefConstBuffer bufMessage;
+    ndefMessage     message;
+
+    if( err != ERR_NONE )
+    {
+        return;
+    }
+
+    bufMessage.buffer = rawMessageBuf;
+    bufMessage.length = p2pRxLength;
 
-    platformLog(" Device present, maintaining connection ");
-    while(err == ERR_NONE) 
+    platformLog(" NDEF message pushed by the device:\r\n");
+    if( ndefMessageDecode(&bufMessage, &message) == ERR_NONE )
     {
-        err = demoTransceiveBlocking( ndefLLCPSYMM, sizeof(ndefLLCPSYMM), &rxData, &rxLen, RFAL_FWT_NONE);
-        platformLog(".");
-        platformDelay(50);
+        (void)ndefMessageDump(&message, verbose);
     }
-    platformLog("\r\n Device removed.\r\n");
 }
 
 
@@ -699,7 +939,56 @@ ReturnCode demoTransceiveBlocking( uint8_t *txBuf, uint16_t txBufSize, uint8_t *
     return err;
 }
 
-static void demoNdef(rfalNfcDevice *pNfcDevice)
+#if DEMO_CARD_EMULATION && defined(ST25R3916) && defined(RFAL_FEATURE_LISTEN_MODE)
+/*!
+ *****************************************************************************
+ * \brief Demo Card Emulation
+ *
+ * Answers the C-APDUs of the reader as a Type 4 Tag holding a NDEF URI
+ * record, until the reader goes away or deactivates the tag. Each new
+ * activation starts with no application selected.
+ *
+ * \param[in] nfcDevice : activated reader
+ *****************************************************************************
+ */
+static void demoCE( rfalNfcDevice *nfcDevice )
+{
+    ReturnCode err = ERR_NONE;
+    uint8_t    *rxData;
+    uint16_t   *rcvLen;
+    uint8_t    txBuf[DEMO_CE_BUF_LEN];
+    uint16_t   txLen;
+
+    NO_WARNING(nfcDevice);
+
+    do
+    {
+        rfalNfcWorker();
+
+        switch( rfalNfcGetState() )
+        {
+            case RFAL_NFC_STATE_ACTIVATED:
+                /* Wait for the first C-APDU */
+                demoCeT4TReset();
+                err = demoTransceiveBlocking( NULL, 0, &rxData, &rcvLen, 0 );
+                break;
+
+            case RFAL_NFC_STATE_DATAEXCHANGE:
+            case RFAL_NFC_STATE_DATAEXCHANGE_DONE:
+                txLen = demoCeT4T( rxData, *rcvLen, txBuf, sizeof(txBuf) );
+                err   = demoTransceiveBlocking( txBuf, txLen, &rxData, &rcvLen, RFAL_FWT_NONE );
+                break;
+
+            case RFAL_NFC_STATE_LISTEN_SLEEP:
+            default:
+                break;
+        }
+    }
+    while( (err == ERR_NONE) || (err == ERR_SLEEP_REQ) );
+}
+#endif /* DEMO_CARD_EMULATION */
+
+static ReturnCode demoNdef(rfalNfcDevice *pNfcDevice)
 {
     ReturnCode       err;
     ndefMessage      message;
@@ -730,7 +1019,7 @@ static void demoNdef(rfalNfcDevice *pNfcDevice)
     if( err != ERR_NONE )
     {
         platformLog("NDEF NOT DETECTED (ndefPollerContextInitialization returns %d)\r\n", err);
-        return;
+        return err;
     }
     
     if( verbose && (pNfcDevice->type == RFAL_NFC_LISTEN_TYPE_NFCV) )
@@ -747,7 +1036,7 @@ static void demoNdef(rfalNfcDevice *pNfcDevice)
         platformLog("NDEF NOT DETECTED (ndefPollerNdefDetect returns %d)\r\n", err);
         if( ndefDemoFeature != NDEF_DEMO_FORMAT_TAG)
         {
-            return;
+            return err;
         }
     }
     else
@@ -770,13 +1059,13 @@ static void demoNdef(rfalNfcDevice *pNfcDevice)
             if( info.state == NDEF_STATE_INITIALIZED )
             {
                 /* Nothing to read... */
-                return;
+                return ERR_NONE;
             }
             err = ndefPollerReadRawMessage(&ndefCtx, rawMessageBuf, sizeof(rawMessageBuf), &rawMessageLen);
             if( err != ERR_NONE )
             {
                 platformLog("NDEF message cannot be read (ndefPollerReadRawMessage returns %d)\r\n", err);
-                return;
+                return err;
             }
             if( verbose )
             {
@@ -793,13 +1082,13 @@ static void demoNdef(rfalNfcDevice *pNfcDevice)
             if( err != ERR_NONE )
             {
                 platformLog("NDEF message cannot be decoded (ndefMessageDecode  returns %d)\r\n", err);
-                return;
+                return err;
             }
             err = ndefMessageDump(&message, verbose);
             if( err != ERR_NONE )
             {
                 platformLog("NDEF message cannot be displayed (ndefMessageDump returns %d)\r\n", err);
-                return;
+                return err;
             }
             break;
 
@@ -824,13 +1113,13 @@ static void demoNdef(rfalNfcDevice *pNfcDevice)
             if( err != ERR_NONE )
             {
                 platformLog("Message creation failed\r\n", err);
-                return;
+                return err;
             }
             err = ndefPollerWriteMessage(&ndefCtx, &message); /* Write message */
             if( err != ERR_NONE )
             {
                 platformLog("Message cannot be written (ndefPollerWriteMessage return %d)\r\n", err);
-                return;
+                return err;
             }
             platformLog("Wrote 1 record to the Tag\r\n");
             if( verbose )
@@ -872,13 +1161,13 @@ static void demoNdef(rfalNfcDevice *pNfcDevice)
             if( err != ERR_NONE )
             {
                 platformLog("Raw message creation failed (%d)\r\n", err);
-                return;
+                return err;
             }
             err = ndefPollerWriteRawMessage(&ndefCtx, bufRawMessage.buffer, bufRawMessage.length);
             if( err != ERR_NONE )
             {
                 platformLog("Message cannot be written (ndefPollerWriteRawMessage return %d)\r\n", err);
-                return;
+                return err;
             }
             platformLog("Wrote 2 records to the Tag\r\n");
             if( verbose )
@@ -897,7 +1186,7 @@ static void demoNdef(rfalNfcDevice *pNfcDevice)
             if( !ndefIsSTTag(&ndefCtx) )
             {
                 platformLog("Manufacturer ID not found or not an ST tag. Format aborted \r\n");
-                return;
+                return ERR_REQUEST;
             }
             platformLog("Formatting Tag...\r\n");
             /* Format Tag */
@@ -905,7 +1194,7 @@ static void demoNdef(rfalNfcDevice *pNfcDevice)
             if( err != ERR_NONE )
             {
                 platformLog("Tag cannot be formatted (ndefPollerTagFormat returns %d)\r\n", err);
-                return;
+                return err;
             }
             platformLog("Tag formatted\r\n");
             LedNotificationWriteDone();
@@ -916,8 +1205,82 @@ static void demoNdef(rfalNfcDevice *pNfcDevice)
             ndefDemoFeature = NDEF_DEMO_READ;
             break;     
     }
-    return;
+    return ERR_NONE;
+}
+
+#if DEMO_NFCV_MULTI_TAG
+/*!
+ *****************************************************************************
+ * \brief Demo NFC-V multi-tag
+ *
+ * Inventories all the NFC-V tags in the field, then reads their NDEF
+ * message one after the other, in addressed or selected mode, without
+ * resetting the field between two tags.
+ *****************************************************************************
+ */
+static void demoNfcvMultiTag( void )
+{
+    static nfcvInventory inv;
+    rfalNfcDevice        dev;
+    uint8_t              devUID[RFAL_NFCV_UID_LEN];
+    uint8_t              idx;
+    ReturnCode           err;
+
+    nfcvInventoryIni( &inv );
+    err = nfcvInventoryRun( &inv );
+    platformLog("%d NFC-V tag(s) in the field, %d inventory request(s)%s\r\n", inv.tagCnt, inv.stats.requests, (err != ERR_NONE) ? ", list incomplete" : "");
+
+    while( nfcvInventoryNextDevice( &inv, &dev, &idx ) )
+    {
+        ST_MEMCPY( devUID, dev.nfcid, RFAL_NFCV_UID_LEN );
+        REVERSE_BYTES( devUID, RFAL_NFCV_UID_LEN );
+        platformLog("ISO15693/NFC-V tag %d UID: %s\r\n", idx, hex2Str(devUID, RFAL_NFCV_UID_LEN));
+
+        nfcvInventoryReadDone( &inv, idx, demoNdef( &dev ) );
+    }
+}
+#endif /* DEMO_NFCV_MULTI_TAG */
+
+#if DEMO_NFCV_MAILBOX
+/*!
+ *****************************************************************************
+ * \brief Demo NFC-V mailbox
+ *
+ * Receives one message sent by the host of an ST25DV through the fast
+ * transfer mailbox, then reports the throughput.
+ *
+ * \return ERR_DISABLED : no mailbox, the NDEF can be read instead
+ *****************************************************************************
+ */
+static ReturnCode demoNfcvMailbox( rfalNfcDevice *nfcDevice )
+{
+    static nfcvMailbox mb;
+    static uint8_t     mbBuf[DEMO_NFCV_MAILBOX_BUF_LEN];
+    uint32_t           rcvLen;
+    uint32_t           start;
+    uint32_t           elapsed;
+    ReturnCode         err;
+
+    err = nfcvMailboxIni( &mb, nfcDevice->nfcid );
+    if( err != ERR_NONE )
+    {
+        platformLog("Mailbox not available (%d)\r\n", err);
+        return err;
+    }
+
+    start   = platformGetSysTick();
+    err     = nfcvMailboxReceive( &mb, mbBuf, sizeof(mbBuf), &rcvLen );
+    elapsed = platformGetSysTick() - start;
+
+    platformLog("Mailbox message: %d bytes in %d ms, %d frame(s), %d poll(s), %d retries, %d resume(s) (%d)\r\n",
+                rcvLen, elapsed, mb.stats.framesRx, mb.stats.polls, mb.stats.retries, mb.stats.resumes, err);
+    if( (err == ERR_NONE) && (rcvLen != 0U) )
+    {
+        platformLog(" %s\r\n", hex2Str( mbBuf, MIN( rcvLen, 32U ) ));
+    }
+    return err;
 }
+#endif /* DEMO_NFCV_MAILBOX */
 
 static void ndefT2TCCDump(ndefContext *ctx)
 {
@@ -0,0 +1,1673 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*
+ *      PROJECT:   LLCP
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief LLCP link engine
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+
+#include "nfc_llcp.h"
+#include "utils.h"
+#include "platform.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define LLCP_MAGIC_LENGTH           3U    /*!< LLCP magic number length in the General Bytes */
+#define LLCP_VERSION                0x11U /*!< LLCP 1.1                                      */
+#define LLCP_VERSION_MAJOR(v)       ((uint8_t)(v) >> 4U)
+#define LLCP_VERSION_MINOR(v)       ((uint8_t)(v) & 0x0FU)
+#define LLCP_OPT_LSC_BOTH           0x03U /*!< Connectionless and connection-oriented       */
+
+/* Parameters  LLCP 1.1 Table 6 */
+#define LLCP_PARAM_VERSION          0x01U
+#define LLCP_PARAM_MIUX             0x02U
+#define LLCP_PARAM_WKS              0x03U
+#define LLCP_PARAM_LTO              0x04U
+#define LLCP_PARAM_RW               0x05U
+#define LLCP_PARAM_SN               0x06U
+#define LLCP_PARAM_OPT              0x07U
+#define LLCP_PARAM_SDREQ            0x08U
+#define LLCP_PARAM_SDRES            0x09U
+
+#define LLCP_PARAM_HEADER_LENGTH    2U      /*!< Type and length of a parameter  */
+#define LLCP_MIUX_MASK              0x07FFU
+#define LLCP_RW_MASK                0x0FU
+#define LLCP_LTO_UNIT               10U     /*!< LTO parameter unit [ms]         */
+
+#define LLCP_SEQ(x)                 ((uint8_t)((x) & 0x0FU))  /*!< Sequence numbers are modulo 16 */
+
+#if (LLCP_SYMM_DELAY_MAX >= (LLCP_LTO / 2U))
+    #error "LLCP_SYMM_DELAY_MAX must stay well below LLCP_LTO"
+#endif
+
+/*
+ ******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************
+ */
+
+static llcpServer gLlcp;
+
+static const uint8_t llcpMagic[LLCP_MAGIC_LENGTH] = { 0x46U, 0x66U, 0x6DU };
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+static void llcpResetService(llcpService* service);
+static llcpService* llcpFindService(uint8_t sap);
+static llcpService* llcpFindServiceByUri(const uint8_t* uri, uint8_t uriLength);
+static const uint8_t* llcpGetParam(const uint8_t* params, uint16_t length, uint8_t type, uint8_t* paramLength);
+static void llcpSetConnectionParams(llcpService* service, const uint8_t* params, uint16_t length);
+static void llcpPushPending(llcpPending* list, uint8_t* cnt, uint8_t dsap, uint8_t ssap, uint8_t reason);
+
+static void llcpTransmit(void);
+static void llcpLinkError(ReturnCode err);
+static void llcpSchedule(void);
+static uint16_t llcpBuildFrame(void);
+static bool llcpHasPdu(void);
+static uint16_t llcpNextPdu(uint8_t* buf, uint16_t room);
+static uint16_t llcpNextServicePdu(llcpService* service, uint8_t* buf, uint16_t room);
+static bool llcpCanSendI(const llcpService* service);
+static bool llcpNeedsAck(const llcpService* service);
+static uint8_t llcpAckValue(const llcpService* service);
+static uint16_t llcpPutHeader(uint8_t* buf, uint8_t dsap, llcpPdu ptype, uint8_t ssap);
+static uint16_t llcpPutConnectionParams(uint8_t* buf);
+
+static void llcpProcessFrame(const uint8_t* frame, uint16_t length);
+static void llcpProcessPdu(const uint8_t* pdu, uint16_t length);
+static void llcpProcessConnect(uint8_t dsap, uint8_t ssap, const uint8_t* params, uint16_t length);
+static void llcpProcessSnl(const uint8_t* params, uint16_t length);
+static void llcpProcessI(llcpService* service, const uint8_t* pdu, uint16_t length);
+static bool llcpAcknowledge(llcpService* service, uint8_t nr);
+static void llcpFrameReject(llcpService* service, uint8_t flags, llcpPdu ptype, uint8_t seq);
+static void llcpDeliver(void);
+static void llcpNotify(llcpService* service, llcpPdu pdu, const uint8_t* rxBuffer, uint16_t rxBufferLength);
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+ReturnCode llcpInit(void)
+{
+    ST_MEMSET(&gLlcp, 0x00, sizeof(gLlcp));
+
+    gLlcp.config.VERSION = LLCP_VERSION;
+    gLlcp.config.MIUX    = (uint16_t)(LLCP_MIU - LLCP_MIU_DEFAULT);
+    gLlcp.config.WKS     = (uint16_t)((1U << LLCP_SAP_LLC) | (1U << LLCP_SAP_SDP));
+    gLlcp.config.LTO     = (uint8_t)(LLCP_LTO / LLCP_LTO_UNIT);
+    gLlcp.config.OPT     = LLCP_OPT_LSC_BOTH;
+
+    gLlcp.state = LLCP_TRANSMIT;
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+uint8_t llcpGetGeneralBytes(uint8_t* gb, uint8_t gbLen)
+{
+    uint8_t  buf[LLCP_MAGIC_LENGTH + 17U];
+    uint8_t  len;
+    uint16_t wks;
+    uint8_t  i;
+
+    wks = gLlcp.config.WKS;
+    for( i = 0; i < LLCP_CONNECTION_MAX; i++ )
+    {
+        if( gLlcp.service[i].bound && (gLlcp.service[i].SSAP.SAP < LLCP_SAP_SDP_FIRST) )
+        {
+            wks |= (uint16_t)(1U << gLlcp.service[i].SSAP.SAP);
+        }
+    }
+
+    ST_MEMCPY(buf, llcpMagic, LLCP_MAGIC_LENGTH);
+    len = LLCP_MAGIC_LENGTH;
+
+    buf[len++] = LLCP_PARAM_VERSION;
+    buf[len++] = 1U;
+    buf[len++] = gLlcp.config.VERSION;
+
+    if( gLlcp.config.MIUX != 0U )
+    {
+        buf[len++] = LLCP_PARAM_MIUX;
+        buf[len++] = 2U;
+        buf[len++] = (uint8_t)(gLlcp.config.MIUX >> 8U);
+        buf[len++] = (uint8_t)(gLlcp.config.MIUX);
+    }
+
+    buf[len++] = LLCP_PARAM_WKS;
+    buf[len++] = 2U;
+    buf[len++] = (uint8_t)(wks >> 8U);
+    buf[len++] = (uint8_t)(wks);
+
+    buf[len++] = LLCP_PARAM_LTO;
+    buf[len++] = 1U;
+    buf[len++] = gLlcp.config.LTO;
+
+    buf[len++] = LLCP_PARAM_OPT;
+    buf[len++] = 1U;
+    buf[len++] = gLlcp.config.OPT;
+
+    if( (gb == NULL) || (gbLen < len) )
+    {
+        return 0U;
+    }
+
+    ST_MEMCPY(gb, buf, len);
+    return len;
+}
+
+
+/*******************************************************************************/
+ReturnCode llcpActivate(rfalNfcDevice* nfcDevice)
+{
+    const uint8_t* gb;
+    const uint8_t* param;
+    uint8_t        gbLen;
+    uint8_t        paramLen;
+    uint8_t        version;
+    ReturnCode     err;
+    uint8_t        i;
+
+    if( (nfcDevice == NULL) || (nfcDevice->rfInterface != RFAL_NFC_INTERFACE_NFCDEP) )
+    {
+        return ERR_PARAM;
+    }
+
+    /* The remote General Bytes come in the ATR_RES when polling, in the ATR_REQ when listening */
+    if( nfcDevice->type >= RFAL_NFC_POLL_TYPE_NFCA )
+    {
+        gLlcp.role = LLCP_TARGET;
+        gb         = nfcDevice->proto.nfcDep.activation.Initiator.ATR_REQ.GBi;
+    }
+    else
+    {
+        gLlcp.role = LLCP_INITIATOR;
+        gb         = nfcDevice->proto.nfcDep.activation.Target.ATR_RES.GBt;
+    }
+    gbLen = nfcDevice->proto.nfcDep.info.GBLen;
+
+    if( (gbLen < LLCP_MAGIC_LENGTH) || (ST_BYTECMP(gb, llcpMagic, LLCP_MAGIC_LENGTH) != 0) )
+    {
+        return ERR_PROTO;
+    }
+    gb    += LLCP_MAGIC_LENGTH;
+    gbLen -= LLCP_MAGIC_LENGTH;
+
+    /* Version agreement  LLCP 1.1 5.2.2 */
+    param = llcpGetParam(gb, gbLen, LLCP_PARAM_VERSION, &paramLen);
+    if( (param == NULL) || (paramLen != 1U) || (LLCP_VERSION_MAJOR(param[0]) != LLCP_VERSION_MAJOR(gLlcp.config.VERSION)) )
+    {
+        return ERR_PROTO;
+    }
+    version = param[0];
+    gLlcp.agreedVersion = (LLCP_VERSION_MINOR(version) < LLCP_VERSION_MINOR(gLlcp.config.VERSION)) ? version : gLlcp.config.VERSION;
+
+    param = llcpGetParam(gb, gbLen, LLCP_PARAM_MIUX, &paramLen);
+    gLlcp.MIU = LLCP_MIU_DEFAULT;
+    if( (param != NULL) && (paramLen == 2U) )
+    {
+        gLlcp.MIU += (uint16_t)((((uint16_t)param[0] << 8U) | param[1]) & LLCP_MIUX_MASK);
+    }
+
+    param = llcpGetParam(gb, gbLen, LLCP_PARAM_LTO, &paramLen);
+    gLlcp.LTO = LLCP_LTO_DEFAULT;
+    if( (param != NULL) && (paramLen == 1U) && (param[0] != 0U) )
+    {
+        gLlcp.LTO = (uint16_t)(param[0] * LLCP_LTO_UNIT);
+    }
+
+    for( i = 0; i < LLCP_CONNECTION_MAX; i++ )
+    {
+        llcpResetService(&gLlcp.service[i]);
+    }
+
+    gLlcp.dmCnt       = 0;
+    gLlcp.sdresCnt    = 0;
+    gLlcp.nextService = 0;
+    gLlcp.peerActive  = true;
+    gLlcp.symmDelay   = 0;
+    gLlcp.err         = ERR_NONE;
+    ST_MEMSET(&gLlcp.stats, 0x00, sizeof(gLlcp.stats));
+
+    gLlcp.activated = true;
+    gLlcp.state     = LLCP_TRANSMIT;
+
+    if( gLlcp.role == LLCP_TARGET )
+    {
+        /* The Initiator sends the first PDU */
+        err = rfalNfcDataExchangeStart(NULL, 0, &gLlcp.rxRfalBuffer, &gLlcp.rxRfalBufferLength, RFAL_FWT_NONE);
+        if( err != ERR_NONE )
+        {
+            llcpLinkError(err);
+            return err;
+        }
+        gLlcp.state = LLCP_RECEIVE;
+    }
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode llcpDeactivate(void)
+{
+    uint8_t i;
+
+    gLlcp.activated = false;
+    gLlcp.state     = LLCP_TRANSMIT;
+
+    for( i = 0; i < LLCP_CONNECTION_MAX; i++ )
+    {
+        llcpResetService(&gLlcp.service[i]);
+    }
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode llcpDeinit(void)
+{
+    ST_MEMSET(&gLlcp, 0x00, sizeof(gLlcp));
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode llcpBindService(const llcpServiceConfig* config, llcpService** service)
+{
+    llcpService* slot = NULL;
+    uint8_t      sap;
+    uint8_t      i;
+
+    if( (config == NULL) || (service == NULL) || (config->notifyCb == NULL) || (config->SAP > LLCP_SAP_MAX) )
+    {
+        return ERR_PARAM;
+    }
+
+    if( (config->SAP != 0U) && ((config->SAP == LLCP_SAP_SDP) || (llcpFindService(config->SAP) != NULL)) )
+    {
+        return ERR_PARAM;
+    }
+
+    for( i = 0; i < LLCP_CONNECTION_MAX; i++ )
+    {
+        if( !gLlcp.service[i].bound )
+        {
+            slot = &gLlcp.service[i];
+            break;
+        }
+    }
+
+    if( slot == NULL )
+    {
+        return ERR_NOMEM;
+    }
+
+    sap = config->SAP;
+    if( sap == 0U )
+    {
+        for( sap = LLCP_SAP_FIRST; llcpFindService(sap) != NULL; sap++ )
+        {
+        }
+    }
+
+    ST_MEMSET(slot, 0x00, sizeof(llcpService));
+    slot->SSAP     = *config;
+    slot->SSAP.SAP = sap;
+    slot->bound    = true;
+    llcpResetService(slot);
+
+    *service = slot;
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode llcpUnbindService(llcpService* service)
+{
+    if( (service == NULL) || !service->bound )
+    {
+        return ERR_PARAM;
+    }
+
+    ST_MEMSET(service, 0x00, sizeof(llcpService));
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode llcpServiceNameLookup(llcpService* service, const uint8_t* uri)
+{
+    if( (service == NULL) || !service->bound || (uri == NULL) )
+    {
+        return ERR_PARAM;
+    }
+
+    if( !gLlcp.activated || (service->nextPdu != LLCP_PDU_SYMM) )
+    {
+        return ERR_WRONG_STATE;
+    }
+
+    gLlcp.TID++;
+    service->TID     = gLlcp.TID;
+    service->uri     = uri;
+    service->nextPdu = LLCP_PDU_SNL;
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode llcpConnect(llcpService* service, uint8_t dsap, const uint8_t* uri)
+{
+    if( (service == NULL) || !service->bound || ((service->SSAP.Class & LLCP_CLASS_CONNECTION_ORIENTED) == 0U) )
+    {
+        return ERR_PARAM;
+    }
+
+    if( !gLlcp.activated || service->connected || (service->nextPdu != LLCP_PDU_SYMM) )
+    {
+        return ERR_WRONG_STATE;
+    }
+
+    /* Connection by name goes to the SDP, which resolves the SN parameter */
+    service->uri     = uri;
+    service->DSAP    = (uri != NULL) ? LLCP_SAP_SDP : dsap;
+    service->nextPdu = LLCP_PDU_CONNECT;
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode llcpDisconnect(llcpService* service)
+{
+    if( (service == NULL) || !service->connected )
+    {
+        return ERR_WRONG_STATE;
+    }
+
+    service->connected = false;
+    service->txICnt    = 0;
+    service->nextPdu   = LLCP_PDU_DISC;
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode llcpSendUI(llcpService* service, uint8_t DSAP, const uint8_t* txBuffer, uint16_t txLength)
+{
+    if( (service == NULL) || !service->bound || (txBuffer == NULL) || (txLength == 0U) || (txLength > LLCP_BUFFER_LENGTH) )
+    {
+        return ERR_PARAM;
+    }
+
+    if( !gLlcp.activated )
+    {
+        return ERR_WRONG_STATE;
+    }
+
+    if( txLength > gLlcp.MIU )
+    {
+        return ERR_PARAM;
+    }
+
+    if( service->txUi.length != 0U )
+    {
+        return ERR_BUSY;
+    }
+
+    ST_MEMCPY(service->txUi.buffer, txBuffer, txLength);
+    service->txUi.length = txLength;
+    service->txUiDSAP    = DSAP;
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+bool llcpCheckAvailableRW(llcpService* service)
+{
+    return ( (service != NULL) && service->connected && (service->txICnt < LLCP_RW) );
+}
+
+
+/*******************************************************************************/
+ReturnCode llcpSendI(llcpService* service, const uint8_t* txBuffer, uint16_t txLength)
+{
+    llcpSdu* sdu;
+
+    if( (service == NULL) || (txBuffer == NULL) || (txLength == 0U) || (txLength > LLCP_BUFFER_LENGTH) )
+    {
+        return ERR_PARAM;
+    }
+
+    if( !service->connected )
+    {
+        return ERR_WRONG_STATE;
+    }
+
+    if( txLength > service->MIU )
+    {
+        return ERR_PARAM;
+    }
+
+    if( service->txICnt >= LLCP_RW )
+    {
+        return ERR_BUSY;
+    }
+
+    /* Queue entries follow V(SA): the ring index is the future N(S) */
+    sdu = &service->txI[(uint8_t)(service->state.V_SA + service->txICnt) % LLCP_RW];
+    ST_MEMCPY(sdu->buffer, txBuffer, txLength);
+    sdu->length = txLength;
+    service->txICnt++;
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode llcpUiBufferProcessed(llcpService* service)
+{
+    if( (service == NULL) || !service->rxUiBufferAtUser )
+    {
+        return ERR_WRONG_STATE;
+    }
+
+    service->rxUi.length      = 0;
+    service->rxUiBufferAtUser = false;
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode llcpIBufferProcessed(llcpService* service)
+{
+    if( (service == NULL) || !service->rxIBufferAtUser )
+    {
+        return ERR_WRONG_STATE;
+    }
+
+    /* The window slot is acknowledged with the next I, RR or RNR */
+    service->rxIHead         = (uint8_t)((service->rxIHead + 1U) % LLCP_RW);
+    service->rxICnt--;
+    service->rxIBufferAtUser = false;
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+void llcpWorker(void)
+{
+    ReturnCode err;
+
+    if( !gLlcp.activated )
+    {
+        return;
+    }
+
+    /* SDUs handed back since the last call make room for the next ones */
+    llcpDeliver();
+
+    switch( gLlcp.state )
+    {
+        case LLCP_TRANSMIT:
+            /* Initiator paces the SYMM exchanges of an idle link */
+            if( (gLlcp.role == LLCP_INITIATOR) && (gLlcp.symmDelay != 0U) && !llcpHasPdu() && !platformTimerIsExpired(gLlcp.symmTimer) )
+            {
+                break;
+            }
+            llcpTransmit();
+            break;
+
+        case LLCP_RECEIVE:
+            err = rfalNfcDataExchangeGetStatus();
+            if( err == ERR_BUSY )
+            {
+                break;
+            }
+
+            if( err != ERR_NONE )
+            {
+                llcpLinkError(err);
+                break;
+            }
+
+            llcpProcessFrame(gLlcp.rxRfalBuffer, *gLlcp.rxRfalBufferLength);
+            if( !gLlcp.activated )
+            {
+                break;
+            }
+            llcpDeliver();
+
+            gLlcp.state = LLCP_TRANSMIT;
+            if( gLlcp.role == LLCP_TARGET )
+            {
+                /* The Target answers each PDU right away */
+                llcpTransmit();
+            }
+            else
+            {
+                llcpSchedule();
+            }
+            break;
+
+        case LLCP_ERROR:
+        default:
+            break;
+    }
+}
+
+
+/*******************************************************************************/
+ReturnCode llcpWorkerGetStatus(void)
+{
+    if( gLlcp.state == LLCP_ERROR )
+    {
+        return gLlcp.err;
+    }
+
+    if( !gLlcp.activated )
+    {
+        return ERR_WRONG_STATE;
+    }
+
+    return ( (gLlcp.state == LLCP_RECEIVE) ? ERR_BUSY : ERR_NONE );
+}
+
+
+/*******************************************************************************/
+void llcpGetStats(llcpStats* stats)
+{
+    *stats = gLlcp.stats;
+}
+
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief Reset the connection state of a service, keeping it bound
+ *****************************************************************************
+ */
+static void llcpResetService(llcpService* service)
+{
+    service->DSAP             = 0;
+    service->RW               = 1U;
+    service->MIU              = LLCP_MIU_DEFAULT;
+    service->connected        = false;
+    service->remoteBusy       = false;
+    service->localBusy        = false;
+    ST_MEMSET(&service->state, 0x00, sizeof(service->state));
+    service->txICnt           = 0;
+    service->rxIHead          = 0;
+    service->rxICnt           = 0;
+    service->rxIBufferAtUser  = false;
+    service->txUi.length      = 0;
+    service->rxUi.length      = 0;
+    service->rxUiBufferAtUser = false;
+    service->nextPdu          = LLCP_PDU_SYMM;
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Find the bound service of a SAP
+ *****************************************************************************
+ */
+static llcpService* llcpFindService(uint8_t sap)
+{
+    uint8_t i;
+
+    for( i = 0; i < LLCP_CONNECTION_MAX; i++ )
+    {
+        if( gLlcp.service[i].bound && (gLlcp.service[i].SSAP.SAP == sap) )
+        {
+            return &gLlcp.service[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Find the bound service of a service name
+ *****************************************************************************
+ */
+static llcpService* llcpFindServiceByUri(const uint8_t* uri, uint8_t uriLength)
+{
+    const uint8_t* local;
+    uint8_t        i;
+
+    for( i = 0; i < LLCP_CONNECTION_MAX; i++ )
+    {
+        local = gLlcp.service[i].SSAP.uri;
+        if( gLlcp.service[i].bound && (local != NULL) && (strlen((const char*)local) == uriLength) && (ST_BYTECMP(local, uri, uriLength) == 0) )
+        {
+            return &gLlcp.service[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Find a parameter in a TLV list
+ *
+ * \param[in]  params      : TLV list
+ * \param[in]  length      : TLV list length
+ * \param[in]  type        : parameter type
+ * \param[out] paramLength : parameter value length
+ *
+ * \return the parameter value, NULL when not found
+ *****************************************************************************
+ */
+static const uint8_t* llcpGetParam(const uint8_t* params, uint16_t length, uint8_t type, uint8_t* paramLength)
+{
+    uint16_t i = 0;
+
+    while( (i + LLCP_PARAM_HEADER_LENGTH) <= length )
+    {
+        if( (i + LLCP_PARAM_HEADER_LENGTH + params[i + 1U]) > length )
+        {
+            break;
+        }
+
+        if( params[i] == type )
+        {
+            *paramLength = params[i + 1U];
+            return &params[i + LLCP_PARAM_HEADER_LENGTH];
+        }
+        i += (uint16_t)(LLCP_PARAM_HEADER_LENGTH + params[i + 1U]);
+    }
+
+    return NULL;
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Take the remote MIU and RW of a connection from a CONNECT or CC
+ *****************************************************************************
+ */
+static void llcpSetConnectionParams(llcpService* service, const uint8_t* params, uint16_t length)
+{
+    const uint8_t* param;
+    uint8_t        paramLen;
+
+    service->MIU = LLCP_MIU_DEFAULT;
+    param = llcpGetParam(params, length, LLCP_PARAM_MIUX, &paramLen);
+    if( (param != NULL) && (paramLen == 2U) )
+    {
+        service->MIU += (uint16_t)((((uint16_t)param[0] << 8U) | param[1]) & LLCP_MIUX_MASK);
+    }
+
+    service->RW = 1U;
+    param = llcpGetParam(params, length, LLCP_PARAM_RW, &paramLen);
+    if( (param != NULL) && (paramLen == 1U) )
+    {
+        service->RW = (uint8_t)(param[0] & LLCP_RW_MASK);
+    }
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Queue a DM or SDRES for the link manager, dropped when full
+ *****************************************************************************
+ */
+static void llcpPushPending(llcpPending* list, uint8_t* cnt, uint8_t dsap, uint8_t ssap, uint8_t reason)
+{
+    if( *cnt >= LLCP_PENDING_MAX )
+    {
+        gLlcp.stats.dropped++;
+        return;
+    }
+
+    list[*cnt].DSAP   = dsap;
+    list[*cnt].SSAP   = ssap;
+    list[*cnt].reason = reason;
+    (*cnt)++;
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Build and send the next frame
+ *****************************************************************************
+ */
+static void llcpTransmit(void)
+{
+    ReturnCode err;
+
+    gLlcp.txFrameLength = llcpBuildFrame();
+
+    err = rfalNfcDataExchangeStart(gLlcp.txFrame, gLlcp.txFrameLength, &gLlcp.rxRfalBuffer, &gLlcp.rxRfalBufferLength, RFAL_FWT_NONE);
+    if( err != ERR_NONE )
+    {
+        llcpLinkError(err);
+        return;
+    }
+
+    gLlcp.state = LLCP_RECEIVE;
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Deactivate the link on an error, the connections are lost
+ *****************************************************************************
+ */
+static void llcpLinkError(ReturnCode err)
+{
+    uint8_t i;
+
+    gLlcp.err       = err;
+    gLlcp.state     = LLCP_ERROR;
+    gLlcp.activated = false;
+
+    /* Connections pending are lost as well */
+    for( i = 0; i < LLCP_CONNECTION_MAX; i++ )
+    {
+        if( gLlcp.service[i].connected || (gLlcp.service[i].nextPdu == LLCP_PDU_CONNECT) )
+        {
+            gLlcp.service[i].connected = false;
+            gLlcp.service[i].nextPdu   = LLCP_PDU_SYMM;
+            llcpNotify(&gLlcp.service[i], LLCP_PDU_DISC, NULL, 0);
+        }
+    }
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Set when the Initiator sends its next frame
+ *
+ * Right away while either side has data. Once the link is idle, SYMM are
+ * sent after a delay doubling from LLCP_SYMM_DELAY_MIN to LLCP_SYMM_DELAY_MAX.
+ *****************************************************************************
+ */
+static void llcpSchedule(void)
+{
+    if( gLlcp.peerActive || llcpHasPdu() )
+    {
+        gLlcp.symmDelay = 0;
+        return;
+    }
+
+    if( gLlcp.symmDelay == 0U )
+    {
+        gLlcp.symmDelay = LLCP_SYMM_DELAY_MIN;
+    }
+    else
+    {
+        gLlcp.symmDelay = MIN((2U * gLlcp.symmDelay), LLCP_SYMM_DELAY_MAX);
+    }
+
+    gLlcp.symmTimer = platformTimerCreate((uint16_t)gLlcp.symmDelay);
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Build the next frame
+ *
+ * Takes all the pending PDUs that fit in the remote link MIU and aggregates
+ * them in an AGF, or sends the single one as is, or a SYMM when none.
+ *
+ * \return frame length
+ *****************************************************************************
+ */
+static uint16_t llcpBuildFrame(void)
+{
+    uint8_t* frame = gLlcp.txFrame;
+    uint16_t agfMax;
+    uint16_t offset;
+    uint16_t first;
+    uint16_t len;
+    uint8_t  cnt;
+
+    agfMax = (uint16_t)MIN((uint16_t)LLCP_FRAME_LENGTH, (uint16_t)(PDU_HEADER_LENGTH + gLlcp.MIU));
+
+    /* First PDU goes after the AGF header and its length field, in case more follow */
+    offset = PDU_HEADER_LENGTH + PDU_AGF_LENGTH_LENGTH;
+    first  = llcpNextPdu(&frame[offset], LLCP_FRAME_LENGTH);
+    cnt    = 0;
+
+    if( first != 0U )
+    {
+        cnt = 1;
+        frame[PDU_HEADER_LENGTH]      = (uint8_t)(first >> 8U);
+        frame[PDU_HEADER_LENGTH + 1U] = (uint8_t)(first);
+        offset += first;
+
+        while( (offset + PDU_AGF_LENGTH_LENGTH + PDU_HEADER_LENGTH) <= agfMax )
+        {
+            len = llcpNextPdu(&frame[offset + PDU_AGF_LENGTH_LENGTH], (uint16_t)(agfMax - offset - PDU_AGF_LENGTH_LENGTH));
+            if( len == 0U )
+            {
+                break;
+            }
+            frame[offset]      = (uint8_t)(len >> 8U);
+            frame[offset + 1U] = (uint8_t)(len);
+            offset += (uint16_t)(PDU_AGF_LENGTH_LENGTH + len);
+            cnt++;
+        }
+    }
+
+    gLlcp.stats.frames++;
+
+    if( cnt == 0U )
+    {
+        gLlcp.stats.symm++;
+        return llcpPutHeader(frame, LLCP_SAP_LLC, LLCP_PDU_SYMM, LLCP_SAP_LLC);
+    }
+
+    gLlcp.stats.pdus += cnt;
+
+    if( cnt == 1U )
+    {
+        ST_MEMMOVE(frame, &frame[PDU_HEADER_LENGTH + PDU_AGF_LENGTH_LENGTH], first);
+        return first;
+    }
+
+    gLlcp.stats.agf++;
+    (void)llcpPutHeader(frame, LLCP_SAP_LLC, LLCP_PDU_AGF, LLCP_SAP_LLC);
+    return offset;
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Check whether a PDU other than SYMM is waiting
+ *****************************************************************************
+ */
+static bool llcpHasPdu(void)
+{
+    const llcpService* service;
+    uint8_t            i;
+
+    if( (gLlcp.dmCnt != 0U) || (gLlcp.sdresCnt != 0U) )
+    {
+        return true;
+    }
+
+    for( i = 0; i < LLCP_CONNECTION_MAX; i++ )
+    {
+        service = &gLlcp.service[i];
+        if( service->bound &&
+            ( (service->nextPdu != LLCP_PDU_SYMM) || (service->txUi.length != 0U) || llcpCanSendI(service) || llcpNeedsAck(service) ) )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Write the next pending PDU, if it fits
+ *
+ * Link manager PDUs first, then the services in turn, starting after the
+ * last one that sent an I PDU.
+ *
+ * \param[out] buf  : PDU
+ * \param[in]  room : space in buf
+ *
+ * \return PDU length, 0 when nothing is pending or the next PDU does not fit
+ *****************************************************************************
+ */
+static uint16_t llcpNextPdu(uint8_t* buf, uint16_t room)
+{
+    llcpPending* p;
+    uint16_t     len;
+    uint8_t      n;
+    uint8_t      i;
+
+    if( gLlcp.dmCnt != 0U )
+    {
+        if( room < (PDU_HEADER_LENGTH + 1U) )
+        {
+            return 0;
+        }
+        p   = &gLlcp.dm[0];
+        len = llcpPutHeader(buf, p->DSAP, LLCP_PDU_DM, p->SSAP);
+        buf[len++] = p->reason;
+
+        gLlcp.dmCnt--;
+        ST_MEMMOVE(&gLlcp.dm[0], &gLlcp.dm[1], (gLlcp.dmCnt * sizeof(llcpPending)));
+        return len;
+    }
+
+    if( gLlcp.sdresCnt != 0U )
+    {
+        if( room < (PDU_HEADER_LENGTH + LLCP_PARAM_HEADER_LENGTH + 2U) )
+        {
+            return 0;
+        }
+        p   = &gLlcp.sdres[0];
+        len = llcpPutHeader(buf, LLCP_SAP_SDP, LLCP_PDU_SNL, LLCP_SAP_SDP);
+        buf[len++] = LLCP_PARAM_SDRES;
+        buf[len++] = 2U;
+        buf[len++] = p->DSAP;
+        buf[len++] = p->SSAP;
+
+        gLlcp.sdresCnt--;
+        ST_MEMMOVE(&gLlcp.sdres[0], &gLlcp.sdres[1], (gLlcp.sdresCnt * sizeof(llcpPending)));
+        return len;
+    }
+
+    for( n = 0; n < LLCP_CONNECTION_MAX; n++ )
+    {
+        i = (uint8_t)((gLlcp.nextService + n) % LLCP_CONNECTION_MAX);
+        if( !gLlcp.service[i].bound )
+        {
+            continue;
+        }
+
+        len = llcpNextServicePdu(&gLlcp.service[i], buf, room);
+        if( len != 0U )
+        {
+            return len;
+        }
+    }
+
+    return 0;
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Write the next pending PDU of a service, if it fits
+ *
+ * Control PDU first, then UI, then I as the remote window allows, with the
+ * acknowledgement piggybacked, then RR or RNR when no I carries it.
+ *****************************************************************************
+ */
+static uint16_t llcpNextServicePdu(llcpService* service, uint8_t* buf, uint16_t room)
+{
+    const llcpSdu* sdu;
+    uint16_t       len;
+    uint8_t        uriLen;
+    uint8_t        sap = service->SSAP.SAP;
+    bool           busy;
+
+    if( service->nextPdu != LLCP_PDU_SYMM )
+    {
+        uriLen = (service->uri != NULL) ? (uint8_t)strlen((const char*)service->uri) : 0U;
+
+        /* Longest control PDU: header, MIUX, RW and SN parameters */
+        if( room < (PDU_HEADER_LENGTH + 7U + LLCP_PARAM_HEADER_LENGTH + 1U + uriLen) )
+        {
+            return 0;
+        }
+
+        switch( service->nextPdu )
+        {
+            case LLCP_PDU_CONNECT:
+                len  = llcpPutHeader(buf, service->DSAP, LLCP_PDU_CONNECT, sap);
+                len += llcpPutConnectionParams(&buf[len]);
+                if( service->uri != NULL )
+                {
+                    buf[len++] = LLCP_PARAM_SN;
+                    buf[len++] = uriLen;
+                    ST_MEMCPY(&buf[len], service->uri, uriLen);
+                    len += uriLen;
+                }
+                break;
+
+            case LLCP_PDU_CC:
+                len  = llcpPutHeader(buf, service->DSAP, LLCP_PDU_CC, sap);
+                len += llcpPutConnectionParams(&buf[len]);
+                break;
+
+            case LLCP_PDU_DISC:
+                len  = llcpPutHeader(buf, service->DSAP, LLCP_PDU_DISC, sap);
+                break;
+
+            case LLCP_PDU_DM:
+                len  = llcpPutHeader(buf, service->DSAP, LLCP_PDU_DM, sap);
+                buf[len++] = service->reason;
+                break;
+
+            case LLCP_PDU_FRMR:
+                len  = llcpPutHeader(buf, service->DSAP, LLCP_PDU_FRMR, sap);
+                ST_MEMCPY(&buf[len], service->frmr, LLCP_FRMR_LENGTH);
+                len += LLCP_FRMR_LENGTH;
+                break;
+
+            case LLCP_PDU_SNL:
+                len  = llcpPutHeader(buf, LLCP_SAP_SDP, LLCP_PDU_SNL, LLCP_SAP_SDP);
+                buf[len++] = LLCP_PARAM_SDREQ;
+                buf[len++] = (uint8_t)(1U + uriLen);
+                buf[len++] = service->TID;
+                ST_MEMCPY(&buf[len], service->uri, uriLen);
+                len += uriLen;
+                break;
+
+            default:
+                len = 0;
+                break;
+        }
+
+        /* A rejected connection is then closed  LLCP 1.1 5.6.7 */
+        service->nextPdu = (service->nextPdu == LLCP_PDU_FRMR) ? LLCP_PDU_DISC : LLCP_PDU_SYMM;
+        if( len != 0U )
+        {
+            return len;
+        }
+    }
+
+    if( service->txUi.length != 0U )
+    {
+        if( room < (PDU_HEADER_LENGTH + service->txUi.length) )
+        {
+            return 0;
+        }
+        len = llcpPutHeader(buf, service->txUiDSAP, LLCP_PDU_UI, sap);
+        ST_MEMCPY(&buf[len], service->txUi.buffer, service->txUi.length);
+        len += service->txUi.length;
+
+        service->txUi.length = 0;
+        return len;
+    }
+
+    if( llcpCanSendI(service) )
+    {
+        sdu = &service->txI[service->state.V_S % LLCP_RW];
+        if( room < (PDU_HEADER_LENGTH + PDU_SEQUENCE_LENGTH + sdu->length) )
+        {
+            return 0;
+        }
+        len = llcpPutHeader(buf, service->DSAP, LLCP_PDU_I, sap);
+        service->state.V_RA = llcpAckValue(service);
+        buf[len++] = (uint8_t)((service->state.V_S << 4U) | service->state.V_RA);
+        ST_MEMCPY(&buf[len], sdu->buffer, sdu->length);
+        len += sdu->length;
+
+        service->state.V_S = LLCP_SEQ(service->state.V_S + 1U);
+        service->localBusy = (service->rxICnt >= LLCP_RW);
+        gLlcp.stats.iTx++;
+
+        /* Let the other services have the next I PDU */
+        gLlcp.nextService = (uint8_t)(((uint8_t)(service - gLlcp.service) + 1U) % LLCP_CONNECTION_MAX);
+        return len;
+    }
+
+    if( llcpNeedsAck(service) )
+    {
+        if( room < (PDU_HEADER_LENGTH + PDU_SEQUENCE_LENGTH) )
+        {
+            return 0;
+        }
+        busy = (service->rxICnt >= LLCP_RW);
+        len  = llcpPutHeader(buf, service->DSAP, (busy ? LLCP_PDU_RNR : LLCP_PDU_RR), sap);
+        service->state.V_RA = llcpAckValue(service);
+        buf[len++] = service->state.V_RA;
+
+        service->localBusy = busy;
+        if( busy )
+        {
+            gLlcp.stats.rnr++;
+        }
+        return len;
+    }
+
+    return 0;
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Check whether an I PDU can be sent: queued and inside RW(R)
+ *****************************************************************************
+ */
+static bool llcpCanSendI(const llcpService* service)
+{
+    uint8_t inFlight = LLCP_SEQ(service->state.V_S - service->state.V_SA);
+
+    return ( service->connected && !service->remoteBusy && (inFlight < service->txICnt) && (inFlight < service->RW) );
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Check whether an RR or RNR is due
+ *****************************************************************************
+ */
+static bool llcpNeedsAck(const llcpService* service)
+{
+    return ( service->connected &&
+             ((llcpAckValue(service) != service->state.V_RA) || (service->localBusy != (service->rxICnt >= LLCP_RW))) );
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief N(R) to send
+ *
+ * Only the I PDUs already handed back by the user are acknowledged, so the
+ * remote window never exceeds the free receive buffers.
+ *****************************************************************************
+ */
+static uint8_t llcpAckValue(const llcpService* service)
+{
+    return LLCP_SEQ(service->state.V_R - service->rxICnt);
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Write a PDU header
+ *
+ * \return header length
+ *****************************************************************************
+ */
+static uint16_t llcpPutHeader(uint8_t* buf, uint8_t dsap, llcpPdu ptype, uint8_t ssap)
+{
+    buf[0] = (uint8_t)((uint8_t)(dsap << 2U) | ((uint8_t)ptype >> 2U));
+    buf[1] = (uint8_t)((uint8_t)(((uint8_t)ptype & 0x03U) << 6U) | (ssap & LLCP_SAP_MAX));
+
+    return PDU_HEADER_LENGTH;
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Write the MIUX and RW parameters of a connection
+ *
+ * \return parameters length
+ *****************************************************************************
+ */
+static uint16_t llcpPutConnectionParams(uint8_t* buf)
+{
+    uint16_t len = 0;
+
+    if( gLlcp.config.MIUX != 0U )
+    {
+        buf[len++] = LLCP_PARAM_MIUX;
+        buf[len++] = 2U;
+        buf[len++] = (uint8_t)(gLlcp.config.MIUX >> 8U);
+        buf[len++] = (uint8_t)(gLlcp.config.MIUX);
+    }
+
+    buf[len++] = LLCP_PARAM_RW;
+    buf[len++] = 1U;
+    buf[len++] = LLCP_RW;
+
+    return len;
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Process a received frame, a single PDU or an AGF
+ *****************************************************************************
+ */
+static void llcpProcessFrame(const uint8_t* frame, uint16_t length)
+{
+    uint16_t offset;
+    uint16_t len;
+
+    if( length < PDU_HEADER_LENGTH )
+    {
+        gLlcp.stats.dropped++;
+        return;
+    }
+
+    if( (frame[0] == 0x00U) && (frame[1] == 0x00U) )
+    {
+        gLlcp.peerActive = false;
+        return;
+    }
+    gLlcp.peerActive = true;
+
+    if( (frame[0] != ((uint8_t)LLCP_PDU_AGF >> 2U)) || ((frame[1] >> 6U) != ((uint8_t)LLCP_PDU_AGF & 0x03U)) )
+    {
+        llcpProcessPdu(frame, length);
+        return;
+    }
+
+    offset = PDU_HEADER_LENGTH;
+    while( (offset + PDU_AGF_LENGTH_LENGTH) <= length )
+    {
+        len     = (uint16_t)(((uint16_t)frame[offset] << 8U) | frame[offset + 1U]);
+        offset += PDU_AGF_LENGTH_LENGTH;
+        if( (len < PDU_HEADER_LENGTH) || ((offset + len) > length) )
+        {
+            gLlcp.stats.dropped++;
+            break;
+        }
+
+        llcpProcessPdu(&frame[offset], len);
+        if( !gLlcp.activated )
+        {
+            break;
+        }
+        offset += len;
+    }
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Process a PDU
+ *****************************************************************************
+ */
+static void llcpProcessPdu(const uint8_t* pdu, uint16_t length)
+{
+    llcpService*   service;
+    const uint8_t* info   = &pdu[PDU_HEADER_LENGTH];
+    uint16_t       infoLen = (uint16_t)(length - PDU_HEADER_LENGTH);
+    uint8_t        dsap    = (uint8_t)(pdu[0] >> 2U);
+    llcpPdu        ptype   = (llcpPdu)((uint8_t)((pdu[0] & 0x03U) << 2U) | (uint8_t)(pdu[1] >> 6U));
+    uint8_t        ssap    = (uint8_t)(pdu[1] & LLCP_SAP_MAX);
+
+    service = llcpFindService(dsap);
+
+    switch( ptype )
+    {
+        case LLCP_PDU_CONNECT:
+            llcpProcessConnect(dsap, ssap, info, infoLen);
+            break;
+
+        case LLCP_PDU_SNL:
+            llcpProcessSnl(info, infoLen);
+            break;
+
+        case LLCP_PDU_CC:
+            if( (service == NULL) || service->connected )
+            {
+                gLlcp.stats.dropped++;
+                break;
+            }
+            llcpResetService(service);
+            llcpSetConnectionParams(service, info, infoLen);
+            service->DSAP      = ssap;
+            service->connected = true;
+            llcpNotify(service, LLCP_PDU_CC, NULL, 0);
+            break;
+
+        case LLCP_PDU_DM:
+            if( service == NULL )
+            {
+                gLlcp.stats.dropped++;
+                break;
+            }
+            service->connected = false;
+            llcpNotify(service, LLCP_PDU_DM, info, MIN(infoLen, 1U));
+            break;
+
+        case LLCP_PDU_DISC:
+            if( (dsap == LLCP_SAP_LLC) && (ssap == LLCP_SAP_LLC) )
+            {
+                /* Link deactivation  LLCP 1.1 5.4 */
+                llcpLinkError(ERR_LINK_LOSS);
+                break;
+            }
+            if( (service == NULL) || !service->connected || (service->DSAP != ssap) )
+            {
+                llcpPushPending(gLlcp.dm, &gLlcp.dmCnt, ssap, dsap, LLCP_DM_REASON_NO_ACTIVE_CONNECTION);
+                break;
+            }
+            llcpResetService(service);
+            service->DSAP    = ssap;
+            service->reason  = LLCP_DM_REASON_DISC_RECEIVED;
+            service->nextPdu = LLCP_PDU_DM;
+            llcpNotify(service, LLCP_PDU_DISC, NULL, 0);
+            break;
+
+        case LLCP_PDU_UI:
+            if( (service == NULL) || ((service->SSAP.Class & LLCP_CLASS_CONNECTIONLESS) == 0U) || service->rxUiBufferAtUser || (infoLen > LLCP_BUFFER_LENGTH) )
+            {
+                /* Connectionless: no flow control, the SDU is lost */
+                gLlcp.stats.dropped++;
+                break;
+            }
+            ST_MEMCPY(service->rxUi.buffer, info, infoLen);
+            service->rxUi.length      = infoLen;
+            service->rxUiBufferAtUser = true;
+            llcpNotify(service, LLCP_PDU_UI, service->rxUi.buffer, infoLen);
+            break;
+
+        case LLCP_PDU_I:
+        case LLCP_PDU_RR:
+        case LLCP_PDU_RNR:
+            if( (service != NULL) && !service->connected && (service->DSAP == ssap) &&
+                ((service->nextPdu == LLCP_PDU_FRMR) || (service->nextPdu == LLCP_PDU_DISC)) )
+            {
+                /* Rejected connection being closed: no DM for the PDUs already sent */
+                gLlcp.stats.dropped++;
+                break;
+            }
+            if( (service == NULL) || !service->connected || (service->DSAP != ssap) || (infoLen < PDU_SEQUENCE_LENGTH) )
+            {
+                if( ptype == LLCP_PDU_I )
+                {
+                    llcpPushPending(gLlcp.dm, &gLlcp.dmCnt, ssap, dsap, LLCP_DM_REASON_NO_ACTIVE_CONNECTION);
+                }
+                gLlcp.stats.dropped++;
+                break;
+            }
+
+            if( ptype == LLCP_PDU_I )
+            {
+                llcpProcessI(service, pdu, length);
+            }
+            else
+            {
+                service->remoteBusy = (ptype == LLCP_PDU_RNR);
+                if( !llcpAcknowledge(service, LLCP_SEQ(info[0])) )
+                {
+                    llcpFrameReject(service, LLCP_FRMR_FLAG_R, ptype, info[0]);
+                }
+            }
+            break;
+
+        case LLCP_PDU_FRMR:
+            if( (service != NULL) && service->connected )
+            {
+                llcpResetService(service);
+                llcpNotify(service, LLCP_PDU_DISC, NULL, 0);
+            }
+            break;
+
+        default:
+            /* SYMM and AGF are not allowed in an AGF, PAX and DPS are not supported */
+            gLlcp.stats.dropped++;
+            break;
+    }
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Process a CONNECT, to a SAP or by service name to the SDP
+ *****************************************************************************
+ */
+static void llcpProcessConnect(uint8_t dsap, uint8_t ssap, const uint8_t* params, uint16_t length)
+{
+    llcpService*   service = NULL;
+    const uint8_t* sn;
+    uint8_t        snLen;
+
+    if( dsap == LLCP_SAP_SDP )
+    {
+        sn = llcpGetParam(params, length, LLCP_PARAM_SN, &snLen);
+        if( sn != NULL )
+        {
+            service = llcpFindServiceByUri(sn, snLen);
+        }
+    }
+    else
+    {
+        service = llcpFindService(dsap);
+    }
+
+    if( service == NULL )
+    {
+        llcpPushPending(gLlcp.dm, &gLlcp.dmCnt, ssap, dsap, LLCP_DM_REASON_NO_BOUND_SERVICE);
+        return;
+    }
+
+    if( service->connected || (service->nextPdu != LLCP_PDU_SYMM) || ((service->SSAP.Class & LLCP_CLASS_CONNECTION_ORIENTED) == 0U) )
+    {
+        llcpPushPending(gLlcp.dm, &gLlcp.dmCnt, ssap, dsap, LLCP_DM_REASON_REJECTED);
+        return;
+    }
+
+    llcpResetService(service);
+    llcpSetConnectionParams(service, params, length);
+    service->DSAP      = ssap;
+    service->connected = true;
+    service->nextPdu   = LLCP_PDU_CC;
+    llcpNotify(service, LLCP_PDU_CONNECT, NULL, 0);
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Process a SNL: answer the SDREQ, report the SDRES
+ *****************************************************************************
+ */
+static void llcpProcessSnl(const uint8_t* params, uint16_t length)
+{
+    llcpService* service;
+    uint16_t     i = 0;
+    uint8_t      len;
+    uint8_t      j;
+
+    while( (i + LLCP_PARAM_HEADER_LENGTH) <= length )
+    {
+        len = params[i + 1U];
+        if( (i + LLCP_PARAM_HEADER_LENGTH + len) > length )
+        {
+            break;
+        }
+
+        if( (params[i] == LLCP_PARAM_SDREQ) && (len >= 1U) )
+        {
+            service = llcpFindServiceByUri(&params[i + 3U], (uint8_t)(len - 1U));
+            llcpPushPending(gLlcp.sdres, &gLlcp.sdresCnt, params[i + 2U], ((service != NULL) ? service->SSAP.SAP : 0U), 0U);
+        }
+        else if( (params[i] == LLCP_PARAM_SDRES) && (len == 2U) )
+        {
+            for( j = 0; j < LLCP_CONNECTION_MAX; j++ )
+            {
+                service = &gLlcp.service[j];
+                if( service->bound && (service->TID == params[i + 2U]) )
+                {
+                    service->DSAP = (uint8_t)(params[i + 3U] & LLCP_SAP_MAX);
+                    llcpNotify(service, LLCP_PDU_SNL, &service->DSAP, 1U);
+                    break;
+                }
+            }
+        }
+        else
+        {
+            /* Unknown parameter, skipped */
+        }
+
+        i += (uint16_t)(LLCP_PARAM_HEADER_LENGTH + len);
+    }
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Process an I PDU: store it in the receive window, then its N(R)
+ *
+ * An I PDU out of sequence, outside the window given to the remote, longer
+ * than the MIU or acknowledging an I PDU not sent is a remote error: the
+ * connection is rejected.
+ *****************************************************************************
+ */
+static void llcpProcessI(llcpService* service, const uint8_t* pdu, uint16_t length)
+{
+    llcpSdu* sdu;
+    uint8_t  seq    = pdu[PDU_HEADER_LENGTH];
+    uint16_t sduLen = (uint16_t)(length - PDU_HEADER_LENGTH - PDU_SEQUENCE_LENGTH);
+
+    gLlcp.stats.iRx++;
+
+    if( ((seq >> 4U) != service->state.V_R) || (service->rxICnt >= LLCP_RW) )
+    {
+        llcpFrameReject(service, LLCP_FRMR_FLAG_S, LLCP_PDU_I, seq);
+        return;
+    }
+
+    if( sduLen > LLCP_BUFFER_LENGTH )
+    {
+        llcpFrameReject(service, LLCP_FRMR_FLAG_I, LLCP_PDU_I, seq);
+        return;
+    }
+
+    if( !llcpAcknowledge(service, LLCP_SEQ(seq)) )
+    {
+        llcpFrameReject(service, LLCP_FRMR_FLAG_R, LLCP_PDU_I, seq);
+        return;
+    }
+
+    sdu = &service->rxI[(uint8_t)(service->rxIHead + service->rxICnt) % LLCP_RW];
+    ST_MEMCPY(sdu->buffer, &pdu[PDU_HEADER_LENGTH + PDU_SEQUENCE_LENGTH], sduLen);
+    sdu->length = sduLen;
+    service->rxICnt++;
+    service->state.V_R  = LLCP_SEQ(service->state.V_R + 1U);
+    service->remoteBusy = false;
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Release the I PDUs acknowledged by N(R)
+ *
+ * \return false when N(R) acknowledges an I PDU not sent
+ *****************************************************************************
+ */
+static bool llcpAcknowledge(llcpService* service, uint8_t nr)
+{
+    uint8_t acked = LLCP_SEQ(nr - service->state.V_SA);
+
+    if( acked > LLCP_SEQ(service->state.V_S - service->state.V_SA) )
+    {
+        return false;
+    }
+
+    if( acked != 0U )
+    {
+        service->state.V_SA = nr;
+        service->txICnt    -= acked;
+        llcpNotify(service, LLCP_PDU_RR, NULL, 0);
+    }
+    return true;
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Reject a PDU of a connection  LLCP 1.1 4.3.7, 5.6.7
+ *
+ * The connection is closed at once: its queues are flushed, the user is
+ * notified as on a DISC, then an FRMR and a DISC are sent to the remote.
+ *
+ * \param[in] service : connection
+ * \param[in] flags   : LLCP_FRMR_FLAG_xxx
+ * \param[in] ptype   : type of the rejected PDU
+ * \param[in] seq     : sequence field of the rejected PDU
+ *****************************************************************************
+ */
+static void llcpFrameReject(llcpService* service, uint8_t flags, llcpPdu ptype, uint8_t seq)
+{
+    uint8_t frmr[LLCP_FRMR_LENGTH];
+    uint8_t dsap = service->DSAP;
+
+    frmr[0] = (uint8_t)(flags | ((uint8_t)ptype & 0x0FU));
+    frmr[1] = seq;
+    frmr[2] = (uint8_t)((uint8_t)(service->state.V_S << 4U) | service->state.V_R);
+    frmr[3] = (uint8_t)((uint8_t)(service->state.V_SA << 4U) | service->state.V_RA);
+
+    gLlcp.stats.frmr++;
+    gLlcp.stats.dropped++;
+
+    llcpResetService(service);
+    service->DSAP    = dsap;
+    ST_MEMCPY(service->frmr, frmr, LLCP_FRMR_LENGTH);
+    service->nextPdu = LLCP_PDU_FRMR;
+    llcpNotify(service, LLCP_PDU_DISC, NULL, 0);
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Hand the received I SDUs to the user, in order, one at a time
+ *****************************************************************************
+ */
+static void llcpDeliver(void)
+{
+    llcpService* service;
+    uint8_t      i;
+
+    for( i = 0; i < LLCP_CONNECTION_MAX; i++ )
+    {
+        service = &gLlcp.service[i];
+        while( service->connected && !service->rxIBufferAtUser && (service->rxICnt != 0U) )
+        {
+            service->rxIBufferAtUser = true;
+            llcpNotify(service, LLCP_PDU_I, service->rxI[service->rxIHead].buffer, service->rxI[service->rxIHead].length);
+        }
+    }
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief Call the service callback
+ *****************************************************************************
+ */
+static void llcpNotify(llcpService* service, llcpPdu pdu, const uint8_t* rxBuffer, uint16_t rxBufferLength)
+{
+    if( service->SSAP.notifyCb != NULL )
+    {
+        (void)service->SSAP.notifyCb(service, pdu, rxBuffer, rxBufferLength);
+    }
+}
@@ -0,0 +1,924 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief SNEP 1.0 client and server over LLCP
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+
+#include "nfc_snep.h"
+#include "utils.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define SNEP_INFO_LENGTH_POS           2U      /*!< Information length in the SNEP header          */
+
+/*
+ ******************************************************************************
+ * GLOBAL TYPES
+ ******************************************************************************
+ */
+
+/*! SNEP end of a connection, client or server */
+typedef struct
+{
+    llcpService      *service;       /*!< LLCP connection oriented service              */
+    bool              isServer;      /*!< Server end                                    */
+
+    /* Message being sent */
+    bool              txActive;      /*!< Fragments still to queue                      */
+    bool              txHold;        /*!< First fragment sent, waiting for CONTINUE     */
+    uint8_t           txHdr[SNEP_HEADER_LENGTH + SNEP_ACCEPTABLE_LENGTH_LENGTH]; /*!< Header of the first fragment */
+    uint8_t           txHdrLen;      /*!< Header length, 0 once the first fragment is queued */
+    ndefConstBuffer   txMsg;         /*!< NDEF message, read in place                   */
+    uint32_t          txOffset;      /*!< NDEF bytes queued                             */
+
+    /* Message being received */
+    const snepSink   *sink;          /*!< Receiver of the incoming message              */
+    bool              rxActive;      /*!< NDEF bytes still expected                     */
+    bool              rxContinued;   /*!< CONTINUE sent, the peer streams the fragments */
+    uint8_t           rxCode;        /*!< Request or response code of the message       */
+    uint32_t          rxRemaining;   /*!< NDEF bytes still expected                     */
+    const uint8_t    *rxHeld;        /*!< Bytes the sink was busy for, in the LLCP SDU  */
+    uint16_t          rxHeldLen;     /*!< Length of rxHeld, 0 for none                  */
+
+    /* Request */
+    bool              busy;          /*!< Client: request ongoing                       */
+    ReturnCode        status;        /*!< Client: result of the last request            */
+    uint8_t           reqCode;       /*!< Client: request code                          */
+    ndefConstBuffer   reqMsg;        /*!< Client: request message                       */
+    uint32_t          acceptable;    /*!< GET acceptable length                         */
+} snepEndpoint;
+
+/*
+ ******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************
+ */
+
+static snepEndpoint            gSnepClient;
+static snepEndpoint            gSnepServer;
+static const snepServerConfig *gSnepServerConfig;
+static snepStats               gSnepStats;
+static uint8_t                 gSnepFrag[LLCP_BUFFER_LENGTH];   /*!< First fragment, header and data */
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+static ReturnCode snepClientNotify( llcpService *service, llcpPdu pdu, const uint8_t *rxBuffer, uint16_t rxBufferLength );
+static ReturnCode snepServerNotify( llcpService *service, llcpPdu pdu, const uint8_t *rxBuffer, uint16_t rxBufferLength );
+static void snepSend( snepEndpoint *ep, uint8_t code, const ndefConstBuffer *msg );
+static void snepTransmit( snepEndpoint *ep );
+static bool snepReceive( snepEndpoint *ep, const uint8_t *buf, uint16_t len );
+static bool snepServerRequest( snepEndpoint *ep, uint8_t code, const uint8_t *info, uint16_t len, uint32_t infoLen );
+static bool snepClientResponse( snepEndpoint *ep, uint8_t code, const uint8_t *info, uint16_t len, uint32_t infoLen );
+static bool snepFeed( snepEndpoint *ep, const uint8_t *buf, uint16_t len );
+static void snepComplete( snepEndpoint *ep );
+static void snepAbort( snepEndpoint *ep, ReturnCode err );
+static void snepClientDone( ReturnCode status );
+static void snepReset( snepEndpoint *ep, ReturnCode err );
+static ReturnCode snepResponseToErr( uint8_t code );
+static uint32_t snepGetU32( const uint8_t *buf );
+static void snepPutU32( uint8_t *buf, uint32_t val );
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+ReturnCode snepClientIni( void )
+{
+    llcpServiceConfig cfg;
+
+    ST_MEMSET( &gSnepClient, 0x00, sizeof(gSnepClient) );
+    ST_MEMSET( &gSnepStats, 0x00, sizeof(gSnepStats) );
+
+    cfg.uri      = NULL;
+    cfg.SAP      = 0;
+    cfg.Class    = LLCP_CLASS_CONNECTION_ORIENTED;
+    cfg.notifyCb = snepClientNotify;
+
+    return llcpBindService( &cfg, &gSnepClient.service );
+}
+
+/*******************************************************************************/
+ReturnCode snepServerIni( const snepServerConfig *config )
+{
+    llcpServiceConfig cfg;
+
+    if( config == NULL )
+    {
+        return ERR_PARAM;
+    }
+
+    ST_MEMSET( &gSnepServer, 0x00, sizeof(gSnepServer) );
+    ST_MEMSET( &gSnepStats, 0x00, sizeof(gSnepStats) );
+    gSnepServer.isServer = true;
+    gSnepServerConfig    = config;
+
+    cfg.uri      = (const uint8_t*)SNEP_SERVICE_NAME;
+    cfg.SAP      = LLCP_SAP_SNEP;
+    cfg.Class    = LLCP_CLASS_CONNECTION_ORIENTED;
+    cfg.notifyCb = snepServerNotify;
+
+    return llcpBindService( &cfg, &gSnepServer.service );
+}
+
+/*******************************************************************************/
+ReturnCode snepClientPut( const ndefConstBuffer *message )
+{
+    ReturnCode err;
+
+    if( (message == NULL) || ((message->buffer == NULL) && (message->length != 0U)) || (gSnepClient.service == NULL) )
+    {
+        return ERR_PARAM;
+    }
+
+    if( gSnepClient.busy )
+    {
+        return ERR_BUSY;
+    }
+
+    gSnepClient.reqCode    = SNEP_REQ_PUT;
+    gSnepClient.reqMsg     = *message;
+    gSnepClient.acceptable = 0U;
+    gSnepClient.sink       = NULL;
+
+    if( gSnepClient.service->connected )
+    {
+        gSnepClient.busy   = true;
+        gSnepClient.status = ERR_BUSY;
+        snepSend( &gSnepClient, SNEP_REQ_PUT, &gSnepClient.reqMsg );
+        return ERR_NONE;
+    }
+
+    /* The request is sent once the connection is complete */
+    err = llcpConnect( gSnepClient.service, 0, (const uint8_t*)SNEP_SERVICE_NAME );
+    if( err == ERR_NONE )
+    {
+        gSnepClient.busy   = true;
+        gSnepClient.status = ERR_BUSY;
+    }
+    return err;
+}
+
+/*******************************************************************************/
+ReturnCode snepClientGet( const ndefConstBuffer *request, uint32_t acceptableLength, const snepSink *sink )
+{
+    ReturnCode err;
+
+    if( (request == NULL) || ((request->buffer == NULL) && (request->length != 0U)) || (sink == NULL) || (gSnepClient.service == NULL) )
+    {
+        return ERR_PARAM;
+    }
+
+    if( gSnepClient.busy )
+    {
+        return ERR_BUSY;
+    }
+
+    gSnepClient.reqCode    = SNEP_REQ_GET;
+    gSnepClient.reqMsg     = *request;
+    gSnepClient.acceptable = acceptableLength;
+    gSnepClient.sink       = sink;
+
+    if( gSnepClient.service->connected )
+    {
+        gSnepClient.busy   = true;
+        gSnepClient.status = ERR_BUSY;
+        snepSend( &gSnepClient, SNEP_REQ_GET, &gSnepClient.reqMsg );
+        return ERR_NONE;
+    }
+
+    err = llcpConnect( gSnepClient.service, 0, (const uint8_t*)SNEP_SERVICE_NAME );
+    if( err == ERR_NONE )
+    {
+        gSnepClient.busy   = true;
+        gSnepClient.status = ERR_BUSY;
+    }
+    return err;
+}
+
+/*******************************************************************************/
+ReturnCode snepClientGetStatus( void )
+{
+    return ( gSnepClient.busy ? ERR_BUSY : gSnepClient.status );
+}
+
+/*******************************************************************************/
+void snepWorker( void )
+{
+    snepEndpoint *ep[2] = { &gSnepClient, &gSnepServer };
+    ReturnCode    err;
+    uint8_t       i;
+
+    for( i = 0; i < 2U; i++ )
+    {
+        if( ep[i]->service == NULL )
+        {
+            continue;
+        }
+
+        /* Give the sink the bytes it was busy for: the LLCP SDU is still held */
+        if( ep[i]->rxHeldLen != 0U )
+        {
+            err = ep[i]->sink->data( ep[i]->rxHeld, ep[i]->rxHeldLen );
+            if( err != ERR_BUSY )
+            {
+                ep[i]->rxHeldLen = 0U;
+                (void)llcpIBufferProcessed( ep[i]->service );
+
+                if( err != ERR_NONE )
+                {
+                    snepAbort( ep[i], err );
+                }
+                else if( ep[i]->rxRemaining == 0U )
+                {
+                    snepComplete( ep[i] );
+                }
+                else
+                {
+                    /* MISRA 15.7 - Empty else */
+                }
+            }
+        }
+
+        snepTransmit( ep[i] );
+    }
+}
+
+/*******************************************************************************/
+void snepGetStats( snepStats *stats )
+{
+    *stats = gSnepStats;
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief LLCP notification of the client service
+ *****************************************************************************
+ */
+static ReturnCode snepClientNotify( llcpService *service, llcpPdu pdu, const uint8_t *rxBuffer, uint16_t rxBufferLength )
+{
+    switch( pdu )
+    {
+        case LLCP_PDU_CC:
+            if( gSnepClient.busy )
+            {
+                snepSend( &gSnepClient, gSnepClient.reqCode, &gSnepClient.reqMsg );
+            }
+            break;
+
+        case LLCP_PDU_DM:
+            /* No SNEP server on the peer */
+            if( gSnepClient.busy )
+            {
+                snepClientDone( ERR_NOTFOUND );
+            }
+            break;
+
+        case LLCP_PDU_DISC:
+            snepReset( &gSnepClient, ERR_LINK_LOSS );
+            break;
+
+        case LLCP_PDU_I:
+            if( !snepReceive( &gSnepClient, rxBuffer, rxBufferLength ) )
+            {
+                (void)llcpIBufferProcessed( service );
+            }
+            break;
+
+        case LLCP_PDU_RR:
+            /* Refill the queue before the frame is answered */
+            snepTransmit( &gSnepClient );
+            break;
+
+        default:
+            break;
+    }
+
+    return ERR_NONE;
+}
+
+/*!
+ *****************************************************************************
+ * \brief LLCP notification of the server service
+ *****************************************************************************
+ */
+static ReturnCode snepServerNotify( llcpService *service, llcpPdu pdu, const uint8_t *rxBuffer, uint16_t rxBufferLength )
+{
+    switch( pdu )
+    {
+        case LLCP_PDU_CONNECT:
+        case LLCP_PDU_DISC:
+            snepReset( &gSnepServer, ERR_LINK_LOSS );
+            break;
+
+        case LLCP_PDU_I:
+            if( !snepReceive( &gSnepServer, rxBuffer, rxBufferLength ) )
+            {
+                (void)llcpIBufferProcessed( service );
+            }
+            break;
+
+        case LLCP_PDU_RR:
+            snepTransmit( &gSnepServer );
+            break;
+
+        default:
+            break;
+    }
+
+    return ERR_NONE;
+}
+
+/*!
+ *****************************************************************************
+ * \brief Start sending a request or a response
+ *
+ * \param[in,out] ep   : sending end
+ * \param[in]     code : request or response code
+ * \param[in]     msg  : NDEF message, NULL for none; a GET request is
+ *                       sent with ep->acceptable
+ *****************************************************************************
+ */
+static void snepSend( snepEndpoint *ep, uint8_t code, const ndefConstBuffer *msg )
+{
+    uint32_t infoLen;
+
+    ep->txHdr[0] = SNEP_VERSION;
+    ep->txHdr[1] = code;
+    ep->txHdrLen = SNEP_HEADER_LENGTH;
+
+    ep->txMsg.buffer = (msg != NULL) ? msg->buffer : NULL;
+    ep->txMsg.length = (msg != NULL) ? msg->length : 0U;
+    infoLen          = ep->txMsg.length;
+
+    if( !ep->isServer && (code == SNEP_REQ_GET) )
+    {
+        snepPutU32( &ep->txHdr[SNEP_HEADER_LENGTH], ep->acceptable );
+        ep->txHdrLen += SNEP_ACCEPTABLE_LENGTH_LENGTH;
+        infoLen      += SNEP_ACCEPTABLE_LENGTH_LENGTH;
+    }
+    snepPutU32( &ep->txHdr[SNEP_INFO_LENGTH_POS], infoLen );
+
+    ep->txOffset = 0U;
+    ep->txHold   = false;
+    ep->txActive = true;
+
+    snepTransmit( ep );
+}
+
+/*!
+ *****************************************************************************
+ * \brief Queue the fragments the LLCP transmit queue has room for
+ *
+ * The first fragment carries the header; when the message does not fit in
+ * it, the others wait for the CONTINUE of the peer. They are then queued
+ * straight from the message, each up to the MIU of the connection.
+ *****************************************************************************
+ */
+static void snepTransmit( snepEndpoint *ep )
+{
+    uint32_t remaining;
+    uint16_t fragMax;
+    uint16_t len;
+
+    while( ep->txActive && !ep->txHold && llcpCheckAvailableRW( ep->service ) )
+    {
+        fragMax   = (uint16_t)MIN( ep->service->MIU, LLCP_BUFFER_LENGTH );
+        remaining = ep->txMsg.length - ep->txOffset;
+
+        if( ep->txHdrLen != 0U )
+        {
+            len = (uint16_t)MIN( remaining, (uint32_t)fragMax - ep->txHdrLen );
+
+            ST_MEMCPY( gSnepFrag, ep->txHdr, ep->txHdrLen );
+            if( len != 0U )
+            {
+                ST_MEMCPY( &gSnepFrag[ep->txHdrLen], &ep->txMsg.buffer[ep->txOffset], len );
+            }
+
+            if( llcpSendI( ep->service, gSnepFrag, (uint16_t)(ep->txHdrLen + len) ) != ERR_NONE )
+            {
+                break;
+            }
+            ep->txHdrLen  = 0U;
+            ep->txOffset += len;
+            ep->txHold    = ( ep->txOffset < ep->txMsg.length );
+        }
+        else
+        {
+            len = (uint16_t)MIN( remaining, fragMax );
+
+            if( llcpSendI( ep->service, &ep->txMsg.buffer[ep->txOffset], len ) != ERR_NONE )
+            {
+                break;
+            }
+            ep->txOffset += len;
+        }
+
+        gSnepStats.fragTx++;
+
+        if( !ep->txHold && (ep->txOffset >= ep->txMsg.length) )
+        {
+            ep->txActive = false;
+        }
+    }
+}
+
+/*!
+ *****************************************************************************
+ * \brief Process a received fragment
+ *
+ * \return true  : the sink keeps the bytes, the LLCP SDU must not be returned
+ * \return false : the LLCP SDU can be returned
+ *****************************************************************************
+ */
+static bool snepReceive( snepEndpoint *ep, const uint8_t *buf, uint16_t len )
+{
+    uint8_t code;
+
+    gSnepStats.fragRx++;
+
+    if( ep->rxActive )
+    {
+        return snepFeed( ep, buf, len );
+    }
+
+    if( len < SNEP_HEADER_LENGTH )
+    {
+        if( ep->isServer )
+        {
+            snepSend( ep, SNEP_RES_BAD_REQUEST, NULL );
+        }
+        else if( ep->busy )
+        {
+            snepClientDone( ERR_PROTO );
+        }
+        else
+        {
+            /* MISRA 15.7 - Empty else */
+        }
+        return false;
+    }
+
+    code = buf[1];
+
+    if( (buf[0] & SNEP_VERSION_MAJOR_MASK) != (SNEP_VERSION & SNEP_VERSION_MAJOR_MASK) )
+    {
+        if( ep->isServer )
+        {
+            snepSend( ep, SNEP_RES_UNSUPPORTED_VERSION, NULL );
+        }
+        else if( ep->busy )
+        {
+            snepClientDone( ERR_NOTSUPP );
+        }
+        else
+        {
+            /* MISRA 15.7 - Empty else */
+        }
+        return false;
+    }
+
+    if( ep->isServer )
+    {
+        return snepServerRequest( ep, code, &buf[SNEP_HEADER_LENGTH], (uint16_t)(len - SNEP_HEADER_LENGTH), snepGetU32( &buf[SNEP_INFO_LENGTH_POS] ) );
+    }
+    return snepClientResponse( ep, code, &buf[SNEP_HEADER_LENGTH], (uint16_t)(len - SNEP_HEADER_LENGTH), snepGetU32( &buf[SNEP_INFO_LENGTH_POS] ) );
+}
+
+/*!
+ *****************************************************************************
+ * \brief Process the first fragment of a request
+ *
+ * \param[in,out] ep      : server end
+ * \param[in]     code    : request code
+ * \param[in]     info    : information field bytes in this fragment
+ * \param[in]     len     : length of info
+ * \param[in]     infoLen : information field length of the whole request
+ *
+ * \return true when the sink keeps the bytes
+ *****************************************************************************
+ */
+static bool snepServerRequest( snepEndpoint *ep, uint8_t code, const uint8_t *info, uint16_t len, uint32_t infoLen )
+{
+    const uint8_t *data   = info;
+    uint16_t       dlen   = len;
+    uint32_t       ndefLen = infoLen;
+
+    switch( code )
+    {
+        case SNEP_REQ_CONTINUE:
+            if( ep->txActive && ep->txHold )
+            {
+                ep->txHold = false;
+                snepTransmit( ep );
+            }
+            return false;
+
+        case SNEP_REQ_REJECT:
+            if( ep->txActive && ep->txHold )
+            {
+                ep->txActive = false;
+                gSnepStats.rejected++;
+            }
+            return false;
+
+        case SNEP_REQ_GET:
+        case SNEP_REQ_PUT:
+            break;
+
+        default:
+            snepSend( ep, SNEP_RES_NOT_IMPLEMENTED, NULL );
+            return false;
+    }
+
+    /* A new request drops what is left of the previous response */
+    ep->txActive = false;
+
+    if( code == SNEP_REQ_GET )
+    {
+        if( (infoLen < SNEP_ACCEPTABLE_LENGTH_LENGTH) || (len < SNEP_ACCEPTABLE_LENGTH_LENGTH) )
+        {
+            snepSend( ep, SNEP_RES_BAD_REQUEST, NULL );
+            return false;
+        }
+        ep->acceptable = snepGetU32( data );
+        data     = &data[SNEP_ACCEPTABLE_LENGTH_LENGTH];
+        dlen    -= SNEP_ACCEPTABLE_LENGTH_LENGTH;
+        ndefLen -= SNEP_ACCEPTABLE_LENGTH_LENGTH;
+    }
+
+    if( dlen > ndefLen )
+    {
+        snepSend( ep, SNEP_RES_BAD_REQUEST, NULL );
+        return false;
+    }
+
+    if( (gSnepServerConfig->sink == NULL) || ((code == SNEP_REQ_GET) && (gSnepServerConfig->getResponse == NULL)) )
+    {
+        snepSend( ep, SNEP_RES_NOT_IMPLEMENTED, NULL );
+        return false;
+    }
+
+    if( gSnepServerConfig->sink->begin( code, ndefLen ) != ERR_NONE )
+    {
+        gSnepStats.rejected++;
+        snepSend( ep, SNEP_RES_REJECT, NULL );
+        return false;
+    }
+
+    ep->sink        = gSnepServerConfig->sink;
+    ep->rxActive    = true;
+    ep->rxCode      = code;
+    ep->rxRemaining = ndefLen;
+    ep->rxContinued = ( dlen < ndefLen );
+
+    /* The peer streams the next fragments while this one is processed */
+    if( ep->rxContinued )
+    {
+        snepSend( ep, SNEP_RES_CONTINUE, NULL );
+    }
+
+    return snepFeed( ep, data, dlen );
+}
+
+/*!
+ *****************************************************************************
+ * \brief Process the first fragment of a response
+ *
+ * \param[in,out] ep      : client end
+ * \param[in]     code    : response code
+ * \param[in]     info    : information field bytes in this fragment
+ * \param[in]     len     : length of info
+ * \param[in]     infoLen : information field length of the whole response
+ *
+ * \return true when the sink keeps the bytes
+ *****************************************************************************
+ */
+static bool snepClientResponse( snepEndpoint *ep, uint8_t code, const uint8_t *info, uint16_t len, uint32_t infoLen )
+{
+    if( !ep->busy )
+    {
+        return false;
+    }
+
+    if( code == SNEP_RES_CONTINUE )
+    {
+        if( ep->txActive && ep->txHold )
+        {
+            ep->txHold = false;
+            snepTransmit( ep );
+        }
+        return false;
+    }
+
+    /* Final response: whatever is left of the request is not sent */
+    ep->txActive = false;
+
+    if( code != SNEP_RES_SUCCESS )
+    {
+        if( code == SNEP_RES_REJECT )
+        {
+            gSnepStats.rejected++;
+        }
+        snepClientDone( snepResponseToErr( code ) );
+        return false;
+    }
+
+    if( ep->reqCode == SNEP_REQ_PUT )
+    {
+        gSnepStats.requests++;
+        snepClientDone( ERR_NONE );
+        return false;
+    }
+
+    if( (len > infoLen) || (infoLen > ep->acceptable) )
+    {
+        snepClientDone( ERR_PROTO );
+        return false;
+    }
+
+    if( ep->sink->begin( code, infoLen ) != ERR_NONE )
+    {
+        gSnepStats.rejected++;
+        if( len < infoLen )
+        {
+            snepSend( ep, SNEP_REQ_REJECT, NULL );
+        }
+        snepClientDone( ERR_NOMEM );
+        return false;
+    }
+
+    ep->rxActive    = true;
+    ep->rxCode      = code;
+    ep->rxRemaining = infoLen;
+    ep->rxContinued = ( len < infoLen );
+
+    if( ep->rxContinued )
+    {
+        snepSend( ep, SNEP_REQ_CONTINUE, NULL );
+    }
+
+    return snepFeed( ep, info, len );
+}
+
+/*!
+ *****************************************************************************
+ * \brief Hand NDEF message bytes to the sink
+ *
+ * \return true when the sink keeps the bytes
+ *****************************************************************************
+ */
+static bool snepFeed( snepEndpoint *ep, const uint8_t *buf, uint16_t len )
+{
+    ReturnCode err;
+
+    if( len > ep->rxRemaining )
+    {
+        snepAbort( ep, ERR_PROTO );
+        return false;
+    }
+
+    if( len != 0U )
+    {
+        /* Bytes are accounted for now, the sink has them from here on */
+        ep->rxRemaining -= len;
+
+        err = ep->sink->data( buf, len );
+        if( err == ERR_BUSY )
+        {
+            gSnepStats.sinkBusy++;
+            ep->rxHeld    = buf;
+            ep->rxHeldLen = len;
+            return true;
+        }
+
+        if( err != ERR_NONE )
+        {
+            snepAbort( ep, err );
+            return false;
+        }
+    }
+
+    if( ep->rxRemaining == 0U )
+    {
+        snepComplete( ep );
+    }
+
+    return false;
+}
+
+/*!
+ *****************************************************************************
+ * \brief Complete an incoming message and answer it
+ *****************************************************************************
+ */
+static void snepComplete( snepEndpoint *ep )
+{
+    ndefConstBuffer msg;
+    ReturnCode      err;
+
+    ep->rxActive = false;
+    ep->sink->end( ERR_NONE );
+
+    if( !ep->isServer )
+    {
+        gSnepStats.requests++;
+        snepClientDone( ERR_NONE );
+        return;
+    }
+
+    gSnepStats.requests++;
+
+    if( ep->rxCode == SNEP_REQ_PUT )
+    {
+        snepSend( ep, SNEP_RES_SUCCESS, NULL );
+        return;
+    }
+
+    msg.buffer = NULL;
+    msg.length = 0U;
+    err = gSnepServerConfig->getResponse( &msg );
+
+    if( err == ERR_NOTFOUND )
+    {
+        snepSend( ep, SNEP_RES_NOT_FOUND, NULL );
+    }
+    else if( err != ERR_NONE )
+    {
+        snepSend( ep, SNEP_RES_NOT_IMPLEMENTED, NULL );
+    }
+    else if( msg.length > ep->acceptable )
+    {
+        snepSend( ep, SNEP_RES_EXCESS_DATA, NULL );
+    }
+    else
+    {
+        ep->txMsg = msg;
+        snepSend( ep, SNEP_RES_SUCCESS, &ep->txMsg );
+    }
+}
+
+/*!
+ *****************************************************************************
+ * \brief Abort an incoming message
+ *
+ * Once CONTINUE was sent the peer streams the remaining fragments and SNEP
+ * has no way to stop it: the connection is closed. Otherwise the message
+ * is refused.
+ *****************************************************************************
+ */
+static void snepAbort( snepEndpoint *ep, ReturnCode err )
+{
+    ep->rxActive  = false;
+    ep->rxHeldLen = 0U;
+    ep->sink->end( err );
+    gSnepStats.rejected++;
+
+    if( ep->rxContinued )
+    {
+        ep->txActive = false;
+        (void)llcpDisconnect( ep->service );
+    }
+    else if( ep->isServer )
+    {
+        snepSend( ep, SNEP_RES_REJECT, NULL );
+    }
+    else
+    {
+        /* MISRA 15.7 - Empty else */
+    }
+
+    if( !ep->isServer )
+    {
+        snepClientDone( ( err == ERR_PROTO ) ? ERR_PROTO : ERR_NOMEM );
+    }
+}
+
+/*!
+ *****************************************************************************
+ * \brief End the client request
+ *****************************************************************************
+ */
+static void snepClientDone( ReturnCode status )
+{
+    gSnepClient.busy   = false;
+    gSnepClient.status = status;
+}
+
+/*!
+ *****************************************************************************
+ * \brief Drop the transfers of a connection that was closed or reopened
+ *****************************************************************************
+ */
+static void snepReset( snepEndpoint *ep, ReturnCode err )
+{
+    if( ep->rxActive )
+    {
+        ep->sink->end( err );
+    }
+
+    ep->rxActive  = false;
+    ep->rxHeldLen = 0U;
+    ep->txActive  = false;
+    ep->txHold    = false;
+
+    if( !ep->isServer && ep->busy )
+    {
+        snepClientDone( err );
+    }
+}
+
+/*!
+ *****************************************************************************
+ * \brief Convert a SNEP response code to an error code
+ *****************************************************************************
+ */
+static ReturnCode snepResponseToErr( uint8_t code )
+{
+    switch( code )
+    {
+        case SNEP_RES_SUCCESS:
+            return ERR_NONE;
+        case SNEP_RES_NOT_FOUND:
+            return ERR_NOTFOUND;
+        case SNEP_RES_EXCESS_DATA:
+            return ERR_NOMEM;
+        case SNEP_RES_NOT_IMPLEMENTED:
+        case SNEP_RES_UNSUPPORTED_VERSION:
+            return ERR_NOTSUPP;
+        case SNEP_RES_BAD_REQUEST:
+        case SNEP_RES_REJECT:
+            return ERR_REQUEST;
+        default:
+            return ERR_PROTO;
+    }
+}
+
+/*!
+ *****************************************************************************
+ * \brief Read a big endian 32 bits value
+ *****************************************************************************
+ */
+static uint32_t snepGetU32( const uint8_t *buf )
+{
+    return ( ((uint32_t)buf[0] << 24U) | ((uint32_t)buf[1] << 16U) | ((uint32_t)buf[2] << 8U) | (uint32_t)buf[3] );
+}
+
+/*!
+ *****************************************************************************
+ * \brief Write a big endian 32 bits value
+ *****************************************************************************
+ */
+static void snepPutU32( uint8_t *buf, uint32_t val )
+{
+    buf[0] = (uint8_t)(val >> 24U);
+    buf[1] = (uint8_t)(val >> 16U);
+    buf[2] = (uint8_t)(val >> 8U);
+    buf[3] = (uint8_t)(val);
+}
@@ -0,0 +1,421 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief Type 4 Tag emulation engine
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+
+#include "nfc_t4t_ce.h"
+#include "utils.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define T4T_CE_CLA                     0x00U   /*!< Interindustry class, no SM, channel 0          */
+
+#define T4T_CE_INS_SELECT              0xA4U   /*!< SELECT                                         */
+#define T4T_CE_INS_READ_BINARY         0xB0U   /*!< READ BINARY                                    */
+#define T4T_CE_INS_UPDATE_BINARY       0xD6U   /*!< UPDATE BINARY                                  */
+
+#define T4T_CE_CMD_UNKNOWN             0U      /*!< Dispatch index: INS not supported              */
+#define T4T_CE_CMD_SELECT              1U      /*!< Dispatch index: SELECT                         */
+#define T4T_CE_CMD_READ_BINARY         2U      /*!< Dispatch index: READ BINARY                    */
+#define T4T_CE_CMD_UPDATE_BINARY       3U      /*!< Dispatch index: UPDATE BINARY                  */
+
+#define T4T_CE_SELECT_BY_FID           0x00U   /*!< SELECT P1: by file identifier                  */
+#define T4T_CE_SELECT_BY_NAME          0x04U   /*!< SELECT P1: by DF name                          */
+#define T4T_CE_SELECT_FIRST            0x00U   /*!< SELECT P2: first or only occurrence, FCI       */
+#define T4T_CE_SELECT_NO_FCI           0x0CU   /*!< SELECT P2: first or only occurrence, no FCI    */
+
+#define T4T_CE_HEADER_LEN              4U      /*!< CLA INS P1 P2                                  */
+#define T4T_CE_FID_LEN                 2U      /*!< File identifier length                         */
+#define T4T_CE_OFFSET_MAX              0x7FFFU /*!< Offset range of READ/UPDATE BINARY             */
+
+#define T4T_CE_MAPPING_VERSION         0x20U   /*!< T4T mapping version 2.0                        */
+#define T4T_CE_NDEF_FILE_CTRL_TLV      0x04U   /*!< NDEF File Control TLV                          */
+#define T4T_CE_NDEF_FILE_CTRL_LEN      0x06U   /*!< NDEF File Control TLV length                   */
+#define T4T_CE_ACCESS_GRANTED          0x00U   /*!< Read or write access without restriction       */
+#define T4T_CE_ACCESS_DENIED           0xFFU   /*!< No write access                                */
+
+/*
+ ******************************************************************************
+ * GLOBAL TYPES
+ ******************************************************************************
+ */
+
+/*! Parsed short C-APDU */
+typedef struct
+{
+    uint8_t        p1;      /*!< P1                                             */
+    uint8_t        p2;      /*!< P2                                             */
+    uint16_t       lc;      /*!< Lc, 0 when absent                              */
+    const uint8_t *data;    /*!< Command data                                   */
+    uint16_t       le;      /*!< Le, 256 for 00, 0 when absent                  */
+} t4tCeApdu;
+
+/*! Command handler */
+typedef void (*t4tCeHandler)( t4tCe *ce, const t4tCeApdu *apdu, t4tCeResponse *rsp );
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+static bool t4tCeParse( const uint8_t *capdu, uint16_t len, t4tCeApdu *apdu );
+static void t4tCeInsNotSupported( t4tCe *ce, const t4tCeApdu *apdu, t4tCeResponse *rsp );
+static void t4tCeSelect( t4tCe *ce, const t4tCeApdu *apdu, t4tCeResponse *rsp );
+static void t4tCeReadBinary( t4tCe *ce, const t4tCeApdu *apdu, t4tCeResponse *rsp );
+static void t4tCeUpdateBinary( t4tCe *ce, const t4tCeApdu *apdu, t4tCeResponse *rsp );
+
+/*
+ ******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************
+ */
+
+/*! NDEF Tag Application name, version 2 */
+static const uint8_t t4tCeNdefAid[] = { 0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01 };
+
+/*! Dispatch index of each INS */
+static const uint8_t t4tCeInsIndex[256] =
+{
+    [T4T_CE_INS_SELECT]        = T4T_CE_CMD_SELECT,
+    [T4T_CE_INS_READ_BINARY]   = T4T_CE_CMD_READ_BINARY,
+    [T4T_CE_INS_UPDATE_BINARY] = T4T_CE_CMD_UPDATE_BINARY,
+};
+
+/*! Handler of each dispatch index */
+static const t4tCeHandler t4tCeHandlers[] =
+{
+    t4tCeInsNotSupported,
+    t4tCeSelect,
+    t4tCeReadBinary,
+    t4tCeUpdateBinary,
+};
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+ReturnCode t4tCeIni( t4tCe *ce, uint8_t *ndefFile, uint16_t ndefFileSize, bool readOnly )
+{
+    if( (ce == NULL) || (ndefFile == NULL) || (ndefFileSize < T4T_CE_NLEN_LEN) || (ndefFileSize > T4T_CE_OFFSET_MAX) )
+    {
+        return ERR_PARAM;
+    }
+
+    ST_MEMSET( ce, 0x00, sizeof(t4tCe) );
+    ce->ndef     = ndefFile;
+    ce->ndefSize = ndefFileSize;
+    ce->readOnly = readOnly;
+
+    ce->cc[0]  = 0x00U;
+    ce->cc[1]  = (uint8_t)T4T_CE_CC_LEN;
+    ce->cc[2]  = T4T_CE_MAPPING_VERSION;
+    ce->cc[3]  = (uint8_t)(T4T_CE_MLE >> 8U);
+    ce->cc[4]  = (uint8_t)(T4T_CE_MLE);
+    ce->cc[5]  = (uint8_t)(T4T_CE_MLC >> 8U);
+    ce->cc[6]  = (uint8_t)(T4T_CE_MLC);
+    ce->cc[7]  = T4T_CE_NDEF_FILE_CTRL_TLV;
+    ce->cc[8]  = T4T_CE_NDEF_FILE_CTRL_LEN;
+    ce->cc[9]  = (uint8_t)(T4T_CE_NDEF_FILE_ID >> 8U);
+    ce->cc[10] = (uint8_t)(T4T_CE_NDEF_FILE_ID);
+    ce->cc[11] = (uint8_t)(ndefFileSize >> 8U);
+    ce->cc[12] = (uint8_t)(ndefFileSize);
+    ce->cc[13] = T4T_CE_ACCESS_GRANTED;
+    ce->cc[14] = readOnly ? T4T_CE_ACCESS_DENIED : T4T_CE_ACCESS_GRANTED;
+
+    return ERR_NONE;
+}
+
+/*******************************************************************************/
+void t4tCeReset( t4tCe *ce )
+{
+    ce->appSelected = false;
+    ce->file        = NULL;
+    ce->fileSize    = 0U;
+}
+
+/*******************************************************************************/
+void t4tCeProcess( t4tCe *ce, const uint8_t *capdu, uint16_t len, t4tCeResponse *rsp )
+{
+    t4tCeApdu apdu;
+
+    rsp->data = NULL;
+    rsp->len  = 0U;
+    ce->stats.apdus++;
+
+    if( !t4tCeParse( capdu, len, &apdu ) )
+    {
+        rsp->sw = T4T_CE_SW_WRONG_LENGTH;
+    }
+    else if( capdu[0] != T4T_CE_CLA )
+    {
+        rsp->sw = T4T_CE_SW_CLA_NOT_SUPPORTED;
+    }
+    else
+    {
+        t4tCeHandlers[t4tCeInsIndex[capdu[1]]]( ce, &apdu, rsp );
+    }
+
+    if( rsp->sw != T4T_CE_SW_OK )
+    {
+        ce->stats.errors++;
+    }
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief Split a short C-APDU in its fields
+ *
+ * \return false when the length matches none of the four cases
+ *****************************************************************************
+ */
+static bool t4tCeParse( const uint8_t *capdu, uint16_t len, t4tCeApdu *apdu )
+{
+    uint16_t body;
+
+    if( len < T4T_CE_HEADER_LEN )
+    {
+        return false;
+    }
+
+    apdu->p1   = capdu[2];
+    apdu->p2   = capdu[3];
+    apdu->lc   = 0U;
+    apdu->data = NULL;
+    apdu->le   = 0U;
+
+    body = (uint16_t)(len - T4T_CE_HEADER_LEN);
+
+    /* Case 1: header only */
+    if( body == 0U )
+    {
+        return true;
+    }
+
+    /* Case 2: Le only */
+    if( body == 1U )
+    {
+        apdu->le = (capdu[T4T_CE_HEADER_LEN] == 0U) ? 256U : capdu[T4T_CE_HEADER_LEN];
+        return true;
+    }
+
+    apdu->lc   = capdu[T4T_CE_HEADER_LEN];
+    apdu->data = &capdu[T4T_CE_HEADER_LEN + 1U];
+
+    /* Case 3: Lc and data */
+    if( (apdu->lc != 0U) && (body == (1U + apdu->lc)) )
+    {
+        return true;
+    }
+
+    /* Case 4: Lc, data and Le */
+    if( (apdu->lc != 0U) && (body == (2U + apdu->lc)) )
+    {
+        apdu->le = (capdu[len - 1U] == 0U) ? 256U : capdu[len - 1U];
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+ *****************************************************************************
+ * \brief Any INS but SELECT, READ BINARY and UPDATE BINARY
+ *****************************************************************************
+ */
+static void t4tCeInsNotSupported( t4tCe *ce, const t4tCeApdu *apdu, t4tCeResponse *rsp )
+{
+    NO_WARNING(ce);
+    NO_WARNING(apdu);
+
+    rsp->sw = T4T_CE_SW_INS_NOT_SUPPORTED;
+}
+
+/*!
+ *****************************************************************************
+ * \brief SELECT the NDEF Tag Application by name, or one of its files by
+ *        identifier
+ *****************************************************************************
+ */
+static void t4tCeSelect( t4tCe *ce, const t4tCeApdu *apdu, t4tCeResponse *rsp )
+{
+    uint16_t fid;
+
+    if( apdu->p1 == T4T_CE_SELECT_BY_NAME )
+    {
+        if( (apdu->p2 != T4T_CE_SELECT_FIRST) && (apdu->p2 != T4T_CE_SELECT_NO_FCI) )
+        {
+            rsp->sw = T4T_CE_SW_WRONG_P1P2;
+            return;
+        }
+
+        if( (apdu->lc != sizeof(t4tCeNdefAid)) || (ST_BYTECMP( apdu->data, t4tCeNdefAid, sizeof(t4tCeNdefAid) ) != 0) )
+        {
+            t4tCeReset( ce );
+            rsp->sw = T4T_CE_SW_NOT_FOUND;
+            return;
+        }
+
+        ce->appSelected = true;
+        ce->file        = NULL;
+        ce->fileSize    = 0U;
+        rsp->sw         = T4T_CE_SW_OK;
+        return;
+    }
+
+    if( (apdu->p1 != T4T_CE_SELECT_BY_FID) || (apdu->p2 != T4T_CE_SELECT_NO_FCI) )
+    {
+        rsp->sw = T4T_CE_SW_WRONG_P1P2;
+        return;
+    }
+
+    if( apdu->lc != T4T_CE_FID_LEN )
+    {
+        rsp->sw = T4T_CE_SW_WRONG_LENGTH;
+        return;
+    }
+
+    if( !ce->appSelected )
+    {
+        rsp->sw = T4T_CE_SW_NOT_FOUND;
+        return;
+    }
+
+    fid = GETU16( apdu->data );
+
+    if( fid == T4T_CE_CC_FILE_ID )
+    {
+        ce->file     = ce->cc;
+        ce->fileSize = T4T_CE_CC_LEN;
+    }
+    else if( fid == T4T_CE_NDEF_FILE_ID )
+    {
+        ce->file     = ce->ndef;
+        ce->fileSize = ce->ndefSize;
+    }
+    else
+    {
+        rsp->sw = T4T_CE_SW_NOT_FOUND;
+        return;
+    }
+
+    rsp->sw = T4T_CE_SW_OK;
+}
+
+/*!
+ *****************************************************************************
+ * \brief READ BINARY from the current EF
+ *
+ * The response data is the file image itself.
+ *****************************************************************************
+ */
+static void t4tCeReadBinary( t4tCe *ce, const t4tCeApdu *apdu, t4tCeResponse *rsp )
+{
+    uint16_t offset;
+
+    if( ce->file == NULL )
+    {
+        rsp->sw = T4T_CE_SW_NO_FILE_SELECTED;
+        return;
+    }
+
+    if( (apdu->le == 0U) || (apdu->lc != 0U) )
+    {
+        rsp->sw = T4T_CE_SW_WRONG_LENGTH;
+        return;
+    }
+
+    offset = (uint16_t)(((uint16_t)apdu->p1 << 8U) | apdu->p2);
+    if( (offset > T4T_CE_OFFSET_MAX) || (offset > ce->fileSize) )
+    {
+        rsp->sw = T4T_CE_SW_WRONG_OFFSET;
+        return;
+    }
+
+    rsp->data = &ce->file[offset];
+    rsp->len  = (uint16_t)MIN( MIN( apdu->le, (uint16_t)(ce->fileSize - offset) ), T4T_CE_MLE );
+    rsp->sw   = T4T_CE_SW_OK;
+    ce->stats.reads++;
+}
+
+/*!
+ *****************************************************************************
+ * \brief UPDATE BINARY of the NDEF file
+ *****************************************************************************
+ */
+static void t4tCeUpdateBinary( t4tCe *ce, const t4tCeApdu *apdu, t4tCeResponse *rsp )
+{
+    uint16_t offset;
+
+    if( ce->file == NULL )
+    {
+        rsp->sw = T4T_CE_SW_NO_FILE_SELECTED;
+        return;
+    }
+
+    if( (ce->file != ce->ndef) || ce->readOnly )
+    {
+        rsp->sw = T4T_CE_SW_NOT_ALLOWED;
+        return;
+    }
+
+    if( (apdu->lc == 0U) || (apdu->lc > T4T_CE_MLC) || (apdu->le != 0U) )
+    {
+        rsp->sw = T4T_CE_SW_WRONG_LENGTH;
+        return;
+    }
+
+    offset = (uint16_t)(((uint16_t)apdu->p1 << 8U) | apdu->p2);
+    if( (offset > T4T_CE_OFFSET_MAX) || (((uint32_t)offset + apdu->lc) > ce->ndefSize) )
+    {
+        rsp->sw = T4T_CE_SW_WRONG_OFFSET;
+        return;
+    }
+
+    ST_MEMCPY( &ce->ndef[offset], apdu->data, apdu->lc );
+    rsp->sw = T4T_CE_SW_OK;
+    ce->stats.updates++;
+}
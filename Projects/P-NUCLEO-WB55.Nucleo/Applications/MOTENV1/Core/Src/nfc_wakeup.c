@@ -0,0 +1,378 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief Low power tag detection front end
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+
+#include "nfc_wakeup.h"
+#include "utils.h"
+#include "rfal_rf.h"
+#include "rfal_chip.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#ifndef NFC_WAKEUP_PERIOD
+#define NFC_WAKEUP_PERIOD              RFAL_WUM_PERIOD_200MS /*!< Antenna measure period in Wake-Up mode  */
+#endif
+
+#ifndef NFC_WAKEUP_RECAL_PERIOD
+#define NFC_WAKEUP_RECAL_PERIOD        10000U  /*!< Period of the reference updates while asleep [ms]  */
+#endif
+
+#define NFC_WAKEUP_USE_AMPLITUDE       true    /*!< Wake up on inductive amplitude                    */
+#define NFC_WAKEUP_USE_PHASE           true    /*!< Wake up on inductive phase                        */
+#define NFC_WAKEUP_USE_CAPACITANCE     false   /*!< Wake up on capacitance (no electrodes on board)   */
+
+#define NFC_WAKEUP_AMPLITUDE_DELTA     3U      /*!< Amplitude deviation that wakes up, up to 15       */
+#define NFC_WAKEUP_PHASE_DELTA         3U      /*!< Phase deviation that wakes up, up to 15           */
+#define NFC_WAKEUP_CAPACITANCE_DELTA   2U      /*!< Capacitance deviation that wakes up, up to 15     */
+
+#define NFC_WAKEUP_TRACK_WEIGHT        2U      /*!< References move by 1/4 of the drift at each update */
+#define NFC_WAKEUP_MEAS_AVG            4U      /*!< Conversions averaged in a reference measure       */
+
+/*
+ ******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************
+ */
+
+static const bool     gWakeupUse[NFC_WAKEUP_MEAS_NUM]   = { NFC_WAKEUP_USE_AMPLITUDE, NFC_WAKEUP_USE_PHASE, NFC_WAKEUP_USE_CAPACITANCE };
+static const uint8_t  gWakeupDelta[NFC_WAKEUP_MEAS_NUM] = { NFC_WAKEUP_AMPLITUDE_DELTA, NFC_WAKEUP_PHASE_DELTA, NFC_WAKEUP_CAPACITANCE_DELTA };
+
+static nfcWakeupTracker  gTracker[NFC_WAKEUP_MEAS_NUM];
+static nfcWakeupStats    gStats;
+static bool              gWoken;          /*!< Wake-up not yet handled by a discovery run    */
+static bool              gRebaseline;     /*!< Next antenna measure becomes the reference     */
+static uint32_t          gWakeTime;       /*!< Tick of the last wake-up                       */
+static uint32_t          gRecalTimer;     /*!< Next reference update                          */
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+static ReturnCode nfcWakeupMeasure( uint8_t *meas );
+static void nfcWakeupSetWoken( void );
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+void nfcWakeupTrackerInit( nfcWakeupTracker *tracker, uint8_t delta, uint8_t weight )
+{
+    tracker->reference = 0U;
+    tracker->delta     = (delta == 0U) ? 1U : delta;
+    tracker->weight    = weight;
+    tracker->valid     = false;
+}
+
+/*******************************************************************************/
+bool nfcWakeupTrackerUpdate( nfcWakeupTracker *tracker, uint8_t measure )
+{
+    int32_t deviation;
+
+    if( !tracker->valid )
+    {
+        nfcWakeupTrackerRebaseline( tracker, measure );
+        return false;
+    }
+
+    if( nfcWakeupTrackerIsOff( tracker, measure ) )
+    {
+        return true;
+    }
+
+    /* Exponential average: follows temperature and supply drifts */
+    deviation = ((int32_t)measure << NFC_WAKEUP_REF_FRAC_BITS) - (int32_t)tracker->reference;
+    tracker->reference = (uint16_t)((int32_t)tracker->reference + (deviation / (1L << tracker->weight)));
+
+    return false;
+}
+
+/*******************************************************************************/
+void nfcWakeupTrackerRebaseline( nfcWakeupTracker *tracker, uint8_t measure )
+{
+    tracker->reference = (uint16_t)((uint16_t)measure << NFC_WAKEUP_REF_FRAC_BITS);
+    tracker->valid     = true;
+}
+
+/*******************************************************************************/
+bool nfcWakeupTrackerIsOff( const nfcWakeupTracker *tracker, uint8_t measure )
+{
+    int32_t diff = (int32_t)measure - (int32_t)nfcWakeupTrackerReference( tracker );
+
+    if( diff < 0 )
+    {
+        diff = -diff;
+    }
+
+    return ( diff >= (int32_t)tracker->delta );
+}
+
+/*******************************************************************************/
+uint8_t nfcWakeupTrackerReference( const nfcWakeupTracker *tracker )
+{
+    uint16_t ref = (uint16_t)((tracker->reference + (1U << (NFC_WAKEUP_REF_FRAC_BITS - 1U))) >> NFC_WAKEUP_REF_FRAC_BITS);
+
+    return (uint8_t)((ref > 0xFFU) ? 0xFFU : ref);
+}
+
+/*******************************************************************************/
+void nfcWakeupIni( void )
+{
+    uint8_t i;
+
+    for( i = 0; i < NFC_WAKEUP_MEAS_NUM; i++ )
+    {
+        nfcWakeupTrackerInit( &gTracker[i], gWakeupDelta[i], NFC_WAKEUP_TRACK_WEIGHT );
+    }
+
+    ST_MEMSET( &gStats, 0x00, sizeof(gStats) );
+    gWoken      = false;
+    gRebaseline = false;
+}
+
+/*******************************************************************************/
+ReturnCode nfcWakeupStart( void )
+{
+    rfalWakeUpConfig cfg;
+    uint8_t          meas[NFC_WAKEUP_MEAS_NUM];
+    bool             off = false;
+    ReturnCode       err;
+    uint8_t          i;
+
+    gWoken = false;
+
+    err = nfcWakeupMeasure( meas );
+    if( err != ERR_NONE )
+    {
+        return err;
+    }
+
+    for( i = 0; i < NFC_WAKEUP_MEAS_NUM; i++ )
+    {
+        if( !gWakeupUse[i] )
+        {
+            continue;
+        }
+
+        if( gRebaseline )
+        {
+            nfcWakeupTrackerRebaseline( &gTracker[i], meas[i] );
+        }
+        else if( nfcWakeupTrackerUpdate( &gTracker[i], meas[i] ) )
+        {
+            off = true;
+        }
+    }
+
+    if( gRebaseline )
+    {
+        gRebaseline = false;
+        gStats.rebaselines++;
+    }
+
+    /* Something changed since the last reference: no need to sleep */
+    if( off )
+    {
+        nfcWakeupSetWoken();
+        return ERR_NONE;
+    }
+
+    ST_MEMSET( &cfg, 0x00, sizeof(cfg) );
+    cfg.period      = NFC_WAKEUP_PERIOD;
+    cfg.irqTout     = false;
+    cfg.swTagDetect = false;
+
+    /* References are tracked here, the HW auto averaging is not used */
+    cfg.indAmp.enabled   = gWakeupUse[NFC_WAKEUP_MEAS_AMPLITUDE];
+    cfg.indAmp.delta     = gTracker[NFC_WAKEUP_MEAS_AMPLITUDE].delta;
+    cfg.indAmp.reference = nfcWakeupTrackerReference( &gTracker[NFC_WAKEUP_MEAS_AMPLITUDE] );
+
+    cfg.indPha.enabled   = gWakeupUse[NFC_WAKEUP_MEAS_PHASE];
+    cfg.indPha.delta     = gTracker[NFC_WAKEUP_MEAS_PHASE].delta;
+    cfg.indPha.reference = nfcWakeupTrackerReference( &gTracker[NFC_WAKEUP_MEAS_PHASE] );
+
+    cfg.cap.enabled      = gWakeupUse[NFC_WAKEUP_MEAS_CAPACITANCE];
+    cfg.cap.delta        = gTracker[NFC_WAKEUP_MEAS_CAPACITANCE].delta;
+    cfg.cap.reference    = nfcWakeupTrackerReference( &gTracker[NFC_WAKEUP_MEAS_CAPACITANCE] );
+
+    err = rfalWakeUpModeStart( &cfg );
+    if( err != ERR_NONE )
+    {
+        return err;
+    }
+
+    gRecalTimer = platformTimerCreate( NFC_WAKEUP_RECAL_PERIOD );
+
+    return ERR_NONE;
+}
+
+/*******************************************************************************/
+bool nfcWakeupHasWoken( void )
+{
+    if( gWoken )
+    {
+        return true;
+    }
+
+    if( rfalWakeUpModeHasWoke() )
+    {
+        rfalWakeUpModeStop();
+        nfcWakeupSetWoken();
+        return true;
+    }
+
+    if( platformTimerIsExpired( gRecalTimer ) )
+    {
+        /* Wake-Up mode compares with fixed references: refresh them */
+        rfalWakeUpModeStop();
+        gStats.recals++;
+
+        if( nfcWakeupStart() != ERR_NONE )
+        {
+            nfcWakeupSetWoken();
+        }
+        return gWoken;
+    }
+
+    return false;
+}
+
+/*******************************************************************************/
+uint32_t nfcWakeupIdleTime( void )
+{
+    int32_t left;
+
+    if( gWoken )
+    {
+        return 0;
+    }
+
+    /* Only the antenna (ST25R3916 IRQ) and the reference update can end the sleep */
+    left = (int32_t)(gRecalTimer - platformGetSysTick());
+    return ( (left > 0) ? (uint32_t)left : 0U );
+}
+
+/*******************************************************************************/
+void nfcWakeupDiscoveryDone( bool found )
+{
+    if( found )
+    {
+        gStats.lastLatency = (platformGetSysTick() - gWakeTime);
+    }
+    else
+    {
+        /* Whatever woke the reader up is not a device: make it the reference */
+        gStats.falseWakes++;
+        gRebaseline = true;
+    }
+
+    gWoken = false;
+}
+
+/*******************************************************************************/
+void nfcWakeupGetStats( nfcWakeupStats *stats )
+{
+    *stats = gStats;
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief Measure the antenna
+ *
+ * Each measure is the rounded average of NFC_WAKEUP_MEAS_AVG conversions, so
+ * that a reference is not taken on a noise peak
+ *
+ * \param[out] meas : NFC_WAKEUP_MEAS_NUM measures, only the used ones are set
+ *
+ * \return ERR_NONE or the RFAL error
+ *****************************************************************************
+ */
+static ReturnCode nfcWakeupMeasure( uint8_t *meas )
+{
+    static ReturnCode (* const measFunc[NFC_WAKEUP_MEAS_NUM])( uint8_t *result ) =
+    {
+        rfalChipMeasureAmplitude, rfalChipMeasurePhase, rfalChipMeasureCapacitance
+    };
+    ReturnCode err;
+    uint16_t   sum;
+    uint8_t    conv;
+    uint8_t    i;
+    uint8_t    n;
+
+    ST_MEMSET( meas, 0x00, NFC_WAKEUP_MEAS_NUM );
+
+    for( i = 0; i < NFC_WAKEUP_MEAS_NUM; i++ )
+    {
+        if( !gWakeupUse[i] )
+        {
+            continue;
+        }
+
+        sum = 0U;
+        for( n = 0; n < NFC_WAKEUP_MEAS_AVG; n++ )
+        {
+            EXIT_ON_ERR( err, measFunc[i]( &conv ) );
+            sum += conv;
+        }
+        meas[i] = (uint8_t)((sum + (NFC_WAKEUP_MEAS_AVG / 2U)) / NFC_WAKEUP_MEAS_AVG);
+    }
+
+    return ERR_NONE;
+}
+
+/*!
+ *****************************************************************************
+ * \brief Record a wake-up
+ *****************************************************************************
+ */
+static void nfcWakeupSetWoken( void )
+{
+    gWoken    = true;
+    gWakeTime = platformGetSysTick();
+    gStats.wakes++;
+}
@@ -0,0 +1,345 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief NFC-V multi-tag inventory and read scheduler
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+
+#include "nfcv_inventory.h"
+#include "utils.h"
+#include "rfal_rf.h"
+#include "rfal_nfcv.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define NFCV_INVENTORY_SLOTS           16U     /*!< Slots of an INVENTORY_REQ in 16 slots mode             */
+#define NFCV_INVENTORY_SLOT_BITS       4U      /*!< Mask bits given by the slot number                     */
+#define NFCV_INVENTORY_MASK_MAX_LEN    60U     /*!< Longest mask in 16 slots mode  Digital 2.1 9.6.1.6     */
+#define NFCV_INVENTORY_FDT_NORES       4U      /*!< FDTV,INVENT_NORES [ms], as in rfalNfcvPollerCollisionResolution() */
+
+#define NFCV_INVENTORY_RES_BITS        rfalConvBytesToBits(sizeof(rfalNfcvInventoryRes)) /*!< INVENTORY_RES + CRC */
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+static void nfcvInventoryRequest( nfcvInventory *inv, const nfcvInventoryMask *mask, bool *overflow );
+static void nfcvInventoryAddTag( nfcvInventory *inv, const rfalNfcvInventoryRes *invRes );
+static bool nfcvInventoryPush( nfcvInventory *inv, const nfcvInventoryMask *mask );
+static bool nfcvInventoryPop( nfcvInventory *inv, nfcvInventoryMask *mask );
+static void nfcvInventorySleepAll( nfcvInventory *inv );
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+void nfcvInventoryIni( nfcvInventory *inv )
+{
+    ST_MEMSET( inv, 0x00, sizeof(nfcvInventory) );
+}
+
+/*******************************************************************************/
+ReturnCode nfcvInventoryRun( nfcvInventory *inv )
+{
+    nfcvInventoryMask mask;
+    uint8_t           pass;
+    bool              overflow;
+
+    for( pass = 0; pass < NFCV_INVENTORY_MAX_PASSES; pass++ )
+    {
+        inv->stats.passes++;
+        inv->queueHead = 0U;
+        inv->queueCnt  = 0U;
+        overflow       = false;
+
+        ST_MEMSET( &mask, 0x00, sizeof(mask) );
+        (void)nfcvInventoryPush( inv, &mask );
+
+        while( nfcvInventoryPop( inv, &mask ) )
+        {
+            nfcvInventoryRequest( inv, &mask, &overflow );
+            if( inv->stats.dropped != 0U )
+            {
+                return ERR_NOMEM;
+            }
+        }
+
+        if( !overflow )
+        {
+            return ERR_NONE;
+        }
+
+        /* Some collisions were dropped: keep the tags found out of the next pass */
+        nfcvInventorySleepAll( inv );
+    }
+
+    return ERR_NOMEM;
+}
+
+/*******************************************************************************/
+bool nfcvInventoryNextDevice( nfcvInventory *inv, rfalNfcDevice *dev, uint8_t *idx )
+{
+    uint8_t n;
+    uint8_t i;
+
+    for( n = 0; n < inv->tagCnt; n++ )
+    {
+        i = (uint8_t)((inv->next + n) % inv->tagCnt);
+
+        if( inv->tag[i].state == NFCV_INVENTORY_TAG_PENDING )
+        {
+            ST_MEMSET( dev, 0x00, sizeof(rfalNfcDevice) );
+            dev->type                = RFAL_NFC_LISTEN_TYPE_NFCV;
+            dev->dev.nfcv.InvRes     = inv->tag[i].invRes;
+            dev->dev.nfcv.isSleep    = inv->tag[i].isSleep;
+            dev->nfcid               = dev->dev.nfcv.InvRes.UID;
+            dev->nfcidLen            = RFAL_NFCV_UID_LEN;
+            dev->rfInterface         = RFAL_NFC_INTERFACE_RF;
+
+            *idx      = i;
+            inv->next = (uint8_t)((i + 1U) % inv->tagCnt);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*******************************************************************************/
+void nfcvInventoryReadDone( nfcvInventory *inv, uint8_t idx, ReturnCode err )
+{
+    nfcvInventoryTag *tag;
+
+    if( idx >= inv->tagCnt )
+    {
+        return;
+    }
+
+    tag = &inv->tag[idx];
+    tag->tries++;
+
+    if( err == ERR_NONE )
+    {
+        tag->state = NFCV_INVENTORY_TAG_READ;
+    }
+    else if( ((err == ERR_TIMEOUT) || (err == ERR_CRC) || (err == ERR_FRAMING) || (err == ERR_RF_COLLISION)) &&
+             (tag->tries < NFCV_INVENTORY_MAX_RETRIES)                                                          )
+    {
+        /* Transmission error: retry once the other tags had their turn */
+        tag->state = NFCV_INVENTORY_TAG_PENDING;
+    }
+    else
+    {
+        tag->state = NFCV_INVENTORY_TAG_FAILED;
+    }
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief Run one INVENTORY_REQ in 16 slots mode
+ *
+ * Records the tags that answered alone and queues the masks of the slots
+ * with a collision.
+ *
+ * \param[in,out] inv      : inventory
+ * \param[in]     mask     : UID range to inventory
+ * \param[out]    overflow : set when a collision could not be queued
+ *****************************************************************************
+ */
+static void nfcvInventoryRequest( nfcvInventory *inv, const nfcvInventoryMask *mask, bool *overflow )
+{
+    rfalNfcvInventoryRes invRes;
+    nfcvInventoryMask    child;
+    ReturnCode           ret;
+    uint16_t             rcvdLen;
+    uint8_t              slot;
+
+    inv->stats.requests++;
+
+    for( slot = 0; slot < NFCV_INVENTORY_SLOTS; slot++ )
+    {
+        rcvdLen = 0U;
+        if( slot == 0U )
+        {
+            ret = rfalNfcvPollerInventory( RFAL_NFCV_NUM_SLOTS_16, mask->maskLen, mask->maskVal, &invRes, &rcvdLen );
+        }
+        else
+        {
+            ret = rfalISO15693TransceiveEOFAnticollision( (uint8_t*)&invRes, sizeof(rfalNfcvInventoryRes), &rcvdLen );
+        }
+        inv->stats.slots++;
+
+        if( ret == ERR_TIMEOUT )
+        {
+            /* Empty slot */
+            platformDelay( NFCV_INVENTORY_FDT_NORES );
+            continue;
+        }
+
+        if( rcvdLen < NFCV_INVENTORY_RES_BITS )
+        {
+            /* Only a partial frame was received, make sure FDTV,INVENT_NORES is fulfilled */
+            platformDelay( NFCV_INVENTORY_FDT_NORES );
+        }
+
+        if( (ret == ERR_NONE) && (rcvdLen == NFCV_INVENTORY_RES_BITS) )
+        {
+            nfcvInventoryAddTag( inv, &invRes );
+            continue;
+        }
+
+        /* Collision, or a corrupted frame: split the range on the next 4 UID bits */
+        inv->stats.collisions++;
+        if( mask->maskLen > (NFCV_INVENTORY_MASK_MAX_LEN - NFCV_INVENTORY_SLOT_BITS) )
+        {
+            continue;
+        }
+
+        child = *mask;
+        child.maskVal[mask->maskLen / RFAL_BITS_IN_BYTE] |= (uint8_t)(slot << (mask->maskLen % RFAL_BITS_IN_BYTE));
+        child.maskLen = (uint8_t)(mask->maskLen + NFCV_INVENTORY_SLOT_BITS);
+
+        if( !nfcvInventoryPush( inv, &child ) )
+        {
+            inv->stats.overflows++;
+            *overflow = true;
+        }
+    }
+}
+
+/*!
+ *****************************************************************************
+ * \brief Record a tag, unless its UID is already known
+ *
+ * \param[in,out] inv    : inventory
+ * \param[in]     invRes : INVENTORY_RES of the tag
+ *****************************************************************************
+ */
+static void nfcvInventoryAddTag( nfcvInventory *inv, const rfalNfcvInventoryRes *invRes )
+{
+    uint8_t i;
+
+    for( i = 0; i < inv->tagCnt; i++ )
+    {
+        if( ST_BYTECMP( inv->tag[i].invRes.UID, invRes->UID, RFAL_NFCV_UID_LEN ) == 0 )
+        {
+            inv->stats.duplicates++;
+            return;
+        }
+    }
+
+    if( inv->tagCnt < NFCV_INVENTORY_MAX_TAGS )
+    {
+        ST_MEMSET( &inv->tag[inv->tagCnt], 0x00, sizeof(nfcvInventoryTag) );
+        inv->tag[inv->tagCnt].invRes = *invRes;
+        inv->tag[inv->tagCnt].state  = NFCV_INVENTORY_TAG_PENDING;
+        inv->tagCnt++;
+    }
+    else
+    {
+        inv->stats.dropped++;
+    }
+}
+
+/*!
+ *****************************************************************************
+ * \brief Append a mask to the pending masks
+ *
+ * \return false when the queue is full
+ *****************************************************************************
+ */
+static bool nfcvInventoryPush( nfcvInventory *inv, const nfcvInventoryMask *mask )
+{
+    if( inv->queueCnt >= NFCV_INVENTORY_QUEUE_LEN )
+    {
+        return false;
+    }
+
+    inv->queue[(inv->queueHead + inv->queueCnt) % NFCV_INVENTORY_QUEUE_LEN] = *mask;
+    inv->queueCnt++;
+    return true;
+}
+
+/*!
+ *****************************************************************************
+ * \brief Take the oldest pending mask
+ *
+ * \return false when no mask is pending
+ *****************************************************************************
+ */
+static bool nfcvInventoryPop( nfcvInventory *inv, nfcvInventoryMask *mask )
+{
+    if( inv->queueCnt == 0U )
+    {
+        return false;
+    }
+
+    *mask = inv->queue[inv->queueHead];
+    inv->queueHead = (uint8_t)((inv->queueHead + 1U) % NFCV_INVENTORY_QUEUE_LEN);
+    inv->queueCnt--;
+    return true;
+}
+
+/*!
+ *****************************************************************************
+ * \brief Send the recorded tags to quiet state
+ *
+ * Quiet tags no longer answer INVENTORY_REQ, but still answer addressed
+ * and select requests, so they can be read afterwards.
+ *****************************************************************************
+ */
+static void nfcvInventorySleepAll( nfcvInventory *inv )
+{
+    uint8_t i;
+
+    for( i = 0; i < inv->tagCnt; i++ )
+    {
+        if( !inv->tag[i].isSleep && (rfalNfcvPollerSleep( 0x00, inv->tag[i].invRes.UID ) == ERR_NONE) )
+        {
+            inv->tag[i].isSleep = true;
+        }
+    }
+}
@@ -0,0 +1,625 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief ST25DV fast transfer mailbox transport
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+
+#include "nfcv_mailbox.h"
+#include "utils.h"
+#include "rfal_nfcv.h"
+#include "rfal_st25xv.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define NFCV_MAILBOX_REQ_FLAGS         ((uint8_t)RFAL_NFCV_REQ_FLAG_DEFAULT)   /*!< Request flags, high data rate */
+#define NFCV_MAILBOX_MAX_FRAMES        0xFFFFU /*!< Frames of a transfer, the ACK of the last one holds 0xFFFF     */
+#define NFCV_MAILBOX_BUSY              (NFCV_MAILBOX_HOST_PUT_MSG | NFCV_MAILBOX_RF_PUT_MSG) /*!< Mailbox holds a message */
+
+#define NFCV_MAILBOX_RES_LEN           1U      /*!< Response flags before the message                              */
+#define NFCV_MAILBOX_CRC_LEN           2U      /*!< CRC received with the response                                 */
+#define NFCV_MAILBOX_REQ_HEADER_LEN    (1U + 1U + 1U + RFAL_NFCV_UID_LEN + 1U) /*!< Flags, command, IC Mfg code, UID, MSGLen */
+
+#define nfcvMailboxIsTxError( e )      (((e) == ERR_TIMEOUT) || ((e) == ERR_CRC) || ((e) == ERR_FRAMING) || ((e) == ERR_RF_COLLISION)) /*!< Retried transmission error */
+#define nfcvMailboxUid( mb )           ((mb)->selected ? NULL : (mb)->uid)     /*!< Select mode saves the UID in every request */
+
+/*
+ ******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************
+ */
+
+static uint8_t gMbFrame[NFCV_MAILBOX_MSG_LEN];                                           /*!< Frame to write            */
+static uint8_t gMbTxBuf[NFCV_MAILBOX_REQ_HEADER_LEN + NFCV_MAILBOX_MSG_LEN];             /*!< Write Message request     */
+static uint8_t gMbRxBuf[NFCV_MAILBOX_RES_LEN + 256U + NFCV_MAILBOX_CRC_LEN];             /*!< Read Message response     */
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+static ReturnCode nfcvMailboxPoll( nfcvMailbox *mb, uint8_t *ctrl );
+static ReturnCode nfcvMailboxWait( nfcvMailbox *mb, uint8_t events, bool free, uint32_t timer, uint8_t *ctrl );
+static ReturnCode nfcvMailboxWrite( nfcvMailbox *mb, uint8_t type, uint8_t tid, uint16_t seq, const uint8_t *data, uint16_t len );
+static ReturnCode nfcvMailboxRead( nfcvMailbox *mb, const uint8_t **frame, uint16_t *len );
+static bool nfcvMailboxRetry( nfcvMailbox *mb, ReturnCode err, uint8_t *errors );
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+ReturnCode nfcvMailboxIni( nfcvMailbox *mb, const uint8_t *uid )
+{
+    ReturnCode err;
+    uint8_t    ctrl;
+
+    if( (mb == NULL) || (uid == NULL) )
+    {
+        return ERR_PARAM;
+    }
+
+    ST_MEMSET( mb, 0x00, sizeof(nfcvMailbox) );
+    ST_MEMCPY( mb->uid, uid, RFAL_NFCV_UID_LEN );
+
+    /* Stay in addressed mode if the tag cannot be selected */
+    mb->selected = (rfalNfcvPollerSelect( NFCV_MAILBOX_REQ_FLAGS, mb->uid ) == ERR_NONE);
+
+    err = nfcvMailboxPoll( mb, &ctrl );
+    if( err != ERR_NONE )
+    {
+        return err;
+    }
+
+    return (((ctrl & NFCV_MAILBOX_MB_EN) != 0U) ? ERR_NONE : ERR_DISABLED);
+}
+
+/*******************************************************************************/
+ReturnCode nfcvMailboxSend( nfcvMailbox *mb, const uint8_t *buf, uint32_t len )
+{
+    ReturnCode     err;
+    const uint8_t *frame;
+    uint32_t       timer;
+    uint32_t       ackTimer;
+    uint32_t       frames;
+    uint32_t       seq;
+    uint32_t       lastSeq;
+    uint32_t       acked;
+    uint32_t       limit;
+    uint32_t       next;
+    uint32_t       offset;
+    uint16_t       frameLen;
+    uint8_t        type;
+    uint8_t        ctrl;
+    uint8_t        errors;
+    bool           waitAck;
+
+    if( (mb == NULL) || (buf == NULL) || (len == 0U) )
+    {
+        return ERR_PARAM;
+    }
+
+    frames = (((len - 1U) / NFCV_MAILBOX_PAYLOAD_LEN) + 1U);
+    if( frames > NFCV_MAILBOX_MAX_FRAMES )
+    {
+        return ERR_PARAM;
+    }
+
+    mb->tid++;
+    seq      = 0U;
+    lastSeq  = frames;
+    acked    = 0U;
+    errors   = 0U;
+    timer    = platformTimerCreate( NFCV_MAILBOX_TIMEOUT );
+    ackTimer = timer;
+
+    for(;;)
+    {
+        /* Write as soon as the mailbox is free, at the end of the window wait for the ACK */
+        limit   = MIN( frames, (acked + NFCV_MAILBOX_WINDOW) );
+        waitAck = (seq >= limit);
+
+        err = nfcvMailboxWait( mb, (NFCV_MAILBOX_HOST_PUT_MSG | NFCV_MAILBOX_RF_MISS_MSG), !waitAck, (waitAck ? ackTimer : timer), &ctrl );
+        if( (err == ERR_TIMEOUT) && waitAck && !platformTimerIsExpired( timer ) )
+        {
+            /* The frame asking for the ACK, or the ACK, was lost */
+            seq = (limit - 1U);
+            mb->stats.resumes++;
+            continue;
+        }
+        if( err != ERR_NONE )
+        {
+            return err;
+        }
+
+        if( (ctrl & NFCV_MAILBOX_HOST_PUT_MSG) != 0U )
+        {
+            err = nfcvMailboxRead( mb, &frame, &frameLen );
+            if( err == ERR_PROTO )
+            {
+                /* Released by the watchdog since the poll */
+                continue;
+            }
+            if( err != ERR_NONE )
+            {
+                if( !nfcvMailboxRetry( mb, err, &errors ) )
+                {
+                    return err;
+                }
+
+                /* The ACK may be lost with the response: ask it again */
+                if( waitAck )
+                {
+                    seq = (limit - 1U);
+                }
+                continue;
+            }
+
+            errors = 0U;
+            next   = GETU16( &frame[2] );
+            if( ((frame[0] & NFCV_MAILBOX_FRAME_TYPE_MASK) != NFCV_MAILBOX_FRAME_ACK) || ((frame[1] != mb->tid) && (next != 0U)) )
+            {
+                continue;
+            }
+
+            mb->stats.acks++;
+            if( next >= frames )
+            {
+                return ERR_NONE;
+            }
+
+            /* The host lost a frame: resume from the one it expects */
+            if( next < seq )
+            {
+                seq = next;
+                mb->stats.resumes++;
+            }
+            acked = next;
+            timer = platformTimerCreate( NFCV_MAILBOX_TIMEOUT );
+            continue;
+        }
+
+        if( ((ctrl & NFCV_MAILBOX_RF_MISS_MSG) != 0U) && (lastSeq < seq) )
+        {
+            /* The watchdog released the last frame before the host read it */
+            seq     = lastSeq;
+            lastSeq = frames;
+            mb->stats.resumes++;
+        }
+
+        if( (seq >= limit) || ((ctrl & NFCV_MAILBOX_BUSY) != 0U) )
+        {
+            continue;
+        }
+
+        offset = (seq * NFCV_MAILBOX_PAYLOAD_LEN);
+        type   = NFCV_MAILBOX_FRAME_DATA;
+        type  |= ((seq == 0U)            ? NFCV_MAILBOX_FLAG_FIRST   : 0U);
+        type  |= ((seq == (frames - 1U)) ? NFCV_MAILBOX_FLAG_LAST    : 0U);
+        type  |= ((seq == (limit - 1U))  ? NFCV_MAILBOX_FLAG_ACK_REQ : 0U);
+
+        err = nfcvMailboxWrite( mb, type, mb->tid, (uint16_t)seq, &buf[offset], (uint16_t)MIN( (len - offset), NFCV_MAILBOX_PAYLOAD_LEN ) );
+        if( err == ERR_PROTO )
+        {
+            /* Refused: the host put a message since the poll */
+            continue;
+        }
+        if( err != ERR_NONE )
+        {
+            if( !nfcvMailboxRetry( mb, err, &errors ) )
+            {
+                return err;
+            }
+
+            /* Only the response may have been lost: if the frame is in, go on, the host drops it if written twice */
+            if( (nfcvMailboxPoll( mb, &ctrl ) != ERR_NONE) || ((ctrl & NFCV_MAILBOX_RF_PUT_MSG) == 0U) )
+            {
+                continue;
+            }
+        }
+
+        errors  = 0U;
+        mb->stats.framesTx++;
+        lastSeq = seq;
+        seq++;
+
+        if( (type & NFCV_MAILBOX_FLAG_ACK_REQ) != 0U )
+        {
+            ackTimer = platformTimerCreate( NFCV_MAILBOX_ACK_TIMEOUT );
+        }
+    }
+}
+
+/*******************************************************************************/
+ReturnCode nfcvMailboxReceive( nfcvMailbox *mb, uint8_t *buf, uint32_t bufLen, uint32_t *rcvLen )
+{
+    ReturnCode     err;
+    const uint8_t *frame;
+    uint32_t       timer;
+    uint32_t       expected;
+    uint16_t       seq;
+    uint16_t       frameLen;
+    uint16_t       dataLen;
+    uint8_t        tid;
+    uint8_t        ctrl;
+    uint8_t        events;
+    uint8_t        errors;
+    bool           started;
+    bool           done;
+    bool           overflow;
+    bool           ackPending;
+    bool           ackWritten;
+    bool           missArmed;
+
+    if( (mb == NULL) || (buf == NULL) || (rcvLen == NULL) )
+    {
+        return ERR_PARAM;
+    }
+
+    *rcvLen    = 0U;
+    expected   = 0U;
+    tid        = 0U;
+    errors     = 0U;
+    started    = false;
+    done       = false;
+    overflow   = false;
+    ackPending = false;
+    ackWritten = false;
+    missArmed  = true;
+    timer      = platformTimerCreate( NFCV_MAILBOX_TIMEOUT );
+
+    for(;;)
+    {
+        /* A message the host lost is asked again once, until the next one comes */
+        events  = (NFCV_MAILBOX_HOST_PUT_MSG | NFCV_MAILBOX_RF_MISS_MSG);
+        events |= (missArmed ? NFCV_MAILBOX_HOST_MISS_MSG : 0U);
+
+        err = nfcvMailboxWait( mb, events, (ackPending || done), timer, &ctrl );
+        if( err != ERR_NONE )
+        {
+            return err;
+        }
+
+        if( ((ctrl & NFCV_MAILBOX_RF_MISS_MSG) != 0U) && ackWritten )
+        {
+            /* The host did not read our ACK in time */
+            ackWritten = false;
+            ackPending = true;
+        }
+
+        if( done && ackWritten && ((ctrl & NFCV_MAILBOX_RF_PUT_MSG) == 0U) )
+        {
+            /* The host took the ACK of the LAST frame, a message now in the mailbox is the next transfer */
+            return (overflow ? ERR_NOMEM : ERR_NONE);
+        }
+
+        if( (ctrl & NFCV_MAILBOX_HOST_PUT_MSG) != 0U )
+        {
+            err = nfcvMailboxRead( mb, &frame, &frameLen );
+            if( err == ERR_PROTO )
+            {
+                continue;
+            }
+            if( err != ERR_NONE )
+            {
+                if( !nfcvMailboxRetry( mb, err, &errors ) )
+                {
+                    return err;
+                }
+
+                /* Reading the last byte frees the mailbox: if the frame is gone, ask it again */
+                ackPending = true;
+                continue;
+            }
+
+            errors    = 0U;
+            missArmed = true;
+            if( (frame[0] & NFCV_MAILBOX_FRAME_TYPE_MASK) != NFCV_MAILBOX_FRAME_DATA )
+            {
+                continue;
+            }
+
+            seq = GETU16( &frame[2] );
+            if( ((frame[0] & NFCV_MAILBOX_FLAG_FIRST) != 0U) && (seq == 0U) && (!started || (frame[1] != tid)) )
+            {
+                tid      = frame[1];
+                expected = 0U;
+                *rcvLen  = 0U;
+                started  = true;
+                done     = false;
+                overflow = false;
+            }
+
+            if( !started || (frame[1] != tid) )
+            {
+                continue;
+            }
+
+            if( seq == expected )
+            {
+                mb->stats.framesRx++;
+                dataLen = (frameLen - NFCV_MAILBOX_HEADER_LEN);
+                if( !overflow && ((*rcvLen + dataLen) <= bufLen) )
+                {
+                    ST_MEMCPY( &buf[*rcvLen], &frame[NFCV_MAILBOX_HEADER_LEN], dataLen );
+                    *rcvLen += dataLen;
+                }
+                else
+                {
+                    overflow = true;
+                }
+
+                expected++;
+                done       = ((frame[0] & NFCV_MAILBOX_FLAG_LAST) != 0U);
+                ackPending = ((frame[0] & NFCV_MAILBOX_FLAG_ACK_REQ) != 0U);
+                ackWritten = false;
+                timer      = platformTimerCreate( NFCV_MAILBOX_TIMEOUT );
+            }
+            else if( seq < expected )
+            {
+                /* Written twice, or our ACK did not get through */
+                mb->stats.duplicates++;
+                ackPending = (ackPending || ((frame[0] & NFCV_MAILBOX_FLAG_ACK_REQ) != 0U));
+            }
+            else
+            {
+                /* A frame was lost: ask the host to resume from it */
+                if( !ackPending )
+                {
+                    mb->stats.resumes++;
+                }
+                ackPending = true;
+            }
+            continue;
+        }
+
+        if( ((ctrl & NFCV_MAILBOX_HOST_MISS_MSG) != 0U) && missArmed )
+        {
+            /* The watchdog released a frame before we read it */
+            missArmed  = false;
+            ackPending = true;
+            mb->stats.resumes++;
+        }
+
+        if( !ackPending || ((ctrl & NFCV_MAILBOX_BUSY) != 0U) )
+        {
+            continue;
+        }
+
+        /* Before the FIRST frame, tid is unknown: an ACK of frame 0 restarts any transfer */
+        err = nfcvMailboxWrite( mb, NFCV_MAILBOX_FRAME_ACK, tid, (uint16_t)expected, NULL, 0U );
+        if( err == ERR_PROTO )
+        {
+            continue;
+        }
+        if( err != ERR_NONE )
+        {
+            if( !nfcvMailboxRetry( mb, err, &errors ) )
+            {
+                return err;
+            }
+            continue;
+        }
+
+        errors     = 0U;
+        mb->stats.acks++;
+        ackPending = false;
+        ackWritten = true;
+    }
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief Read MB_CTRL_Dyn
+ *
+ * \param[in,out] mb   : channel
+ * \param[out]    ctrl : register value
+ *
+ * \return RFAL error
+ *****************************************************************************
+ */
+static ReturnCode nfcvMailboxPoll( nfcvMailbox *mb, uint8_t *ctrl )
+{
+    mb->stats.polls++;
+    return rfalST25xVPollerFastReadDynamicConfiguration( NFCV_MAILBOX_REQ_FLAGS, nfcvMailboxUid( mb ), NFCV_MAILBOX_MB_CTRL_DYN, ctrl );
+}
+
+/*!
+ *****************************************************************************
+ * \brief Poll MB_CTRL_Dyn until something is to be done
+ *
+ * The first poll comes after the delay the last wait needed, a bit shorter
+ * if it was ready at once. The delay then doubles up to
+ * NFCV_MAILBOX_MAX_DELAY, so a slow host is not flooded with requests and
+ * a fast one is not kept waiting.
+ *
+ * \param[in,out] mb     : channel
+ * \param[in]     events : MB_CTRL_Dyn bits that end the wait
+ * \param[in]     free   : an empty mailbox also ends the wait
+ * \param[in]     timer  : time limit
+ * \param[out]    ctrl   : last MB_CTRL_Dyn value
+ *
+ * \return ERR_NONE    : ctrl holds an event
+ * \return ERR_TIMEOUT : time limit reached
+ * \return RFAL error  : NFCV_MAILBOX_MAX_RETRIES transmission errors in a row
+ *****************************************************************************
+ */
+static ReturnCode nfcvMailboxWait( nfcvMailbox *mb, uint8_t events, bool free, uint32_t timer, uint8_t *ctrl )
+{
+    ReturnCode err;
+    uint16_t   delay;
+    uint8_t    errors;
+    bool       first;
+
+    delay  = mb->backoff;
+    errors = 0U;
+    first  = true;
+
+    for(;;)
+    {
+        if( delay != 0U )
+        {
+            platformDelay( delay );
+        }
+
+        err = nfcvMailboxPoll( mb, ctrl );
+        if( err == ERR_NONE )
+        {
+            errors = 0U;
+            if( ((*ctrl & events) != 0U) || (free && ((*ctrl & NFCV_MAILBOX_BUSY) == 0U)) )
+            {
+                mb->backoff = (first ? (mb->backoff / 2U) : delay);
+                return ERR_NONE;
+            }
+        }
+        else if( !nfcvMailboxRetry( mb, err, &errors ) )
+        {
+            return err;
+        }
+        else
+        {
+            /* MISRA 15.7 - Empty else */
+        }
+
+        if( platformTimerIsExpired( timer ) )
+        {
+            return ERR_TIMEOUT;
+        }
+
+        first = false;
+        delay = ((delay == 0U) ? 1U : (uint16_t)MIN( (2U * delay), NFCV_MAILBOX_MAX_DELAY ));
+    }
+}
+
+/*!
+ *****************************************************************************
+ * \brief Write a frame in the mailbox
+ *
+ * \param[in,out] mb   : channel
+ * \param[in]     type : frame type and flags
+ * \param[in]     tid  : transfer identifier
+ * \param[in]     seq  : sequence number
+ * \param[in]     data : frame data, NULL for none
+ * \param[in]     len  : frame data length
+ *
+ * \return RFAL error
+ *****************************************************************************
+ */
+static ReturnCode nfcvMailboxWrite( nfcvMailbox *mb, uint8_t type, uint8_t tid, uint16_t seq, const uint8_t *data, uint16_t len )
+{
+    gMbFrame[0] = type;
+    gMbFrame[1] = tid;
+    gMbFrame[2] = (uint8_t)(seq >> 8U);
+    gMbFrame[3] = (uint8_t)(seq);
+
+    if( len != 0U )
+    {
+        ST_MEMCPY( &gMbFrame[NFCV_MAILBOX_HEADER_LEN], data, len );
+    }
+
+    /* MSGLen is the number of bytes minus 1 */
+    return rfalST25xVPollerFastWriteMessage( NFCV_MAILBOX_REQ_FLAGS, nfcvMailboxUid( mb ), (uint8_t)((NFCV_MAILBOX_HEADER_LEN + len) - 1U), gMbFrame, gMbTxBuf, (uint16_t)sizeof(gMbTxBuf) );
+}
+
+/*!
+ *****************************************************************************
+ * \brief Read the whole message in the mailbox
+ *
+ * \param[in,out] mb    : channel
+ * \param[out]    frame : message, valid until the next read
+ * \param[out]    len   : message length
+ *
+ * \return ERR_PROTO : error response, or no room for a frame header
+ * \return RFAL error
+ *****************************************************************************
+ */
+static ReturnCode nfcvMailboxRead( nfcvMailbox *mb, const uint8_t **frame, uint16_t *len )
+{
+    ReturnCode err;
+    uint16_t   rcvLen;
+
+    /* MBPointer and Number of bytes 0: the full message */
+    err = rfalST25xVPollerFastReadMessage( NFCV_MAILBOX_REQ_FLAGS, nfcvMailboxUid( mb ), 0U, 0U, gMbRxBuf, (uint16_t)sizeof(gMbRxBuf), &rcvLen );
+    if( err != ERR_NONE )
+    {
+        return err;
+    }
+
+    if( ((gMbRxBuf[0] & (uint8_t)RFAL_NFCV_RES_FLAG_ERROR) != 0U) || (rcvLen < (NFCV_MAILBOX_RES_LEN + NFCV_MAILBOX_HEADER_LEN)) )
+    {
+        return ERR_PROTO;
+    }
+
+    *frame = &gMbRxBuf[NFCV_MAILBOX_RES_LEN];
+    *len   = (rcvLen - NFCV_MAILBOX_RES_LEN);
+    return ERR_NONE;
+}
+
+/*!
+ *****************************************************************************
+ * \brief Tell whether a failed command is to be retried
+ *
+ * \param[in,out] mb     : channel
+ * \param[in]     err    : command result
+ * \param[in,out] errors : transmission errors in a row
+ *
+ * \return true : transmission error, retry
+ *****************************************************************************
+ */
+static bool nfcvMailboxRetry( nfcvMailbox *mb, ReturnCode err, uint8_t *errors )
+{
+    if( !nfcvMailboxIsTxError( err ) )
+    {
+        return false;
+    }
+
+    (*errors)++;
+    if( *errors >= NFCV_MAILBOX_MAX_RETRIES )
+    {
+        return false;
+    }
+
+    mb->stats.retries++;
+    return true;
+}
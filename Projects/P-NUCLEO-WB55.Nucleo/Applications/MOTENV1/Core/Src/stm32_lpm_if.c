@@ -44,7 +44,18 @@
 #include "stm32_lpm_if.h"
 #include "stm32_lpm.h"
 #include "app_conf.h"
+#include "stm32wbxx_ll_rtc.h"
 
+/* Private defines -----------------------------------------------------------*/
+#define RTC_SECONDS_PER_DAY     (24U * 60U * 60U)
+
+/* Private variables ---------------------------------------------------------*/
+/**
+ * The SysTick is stopped in Stop mode: the time spent there is read from the RTC calendar
+ * and added to the HAL tick, so that HAL_GetTick() based timeouts keep their meaning.
+ */
+static uint32_t StopEntryTime;          /**< RTC time on Stop entry, in subseconds of the day */
+static uint32_t StopTickRemainder;      /**< Fraction of ms not yet added to the HAL tick */
 
 /* Exported variables --------------------------------------------------------*/
 const struct UTIL_LPM_Driver_s UTIL_PowerDriver = 
@@ -61,6 +72,8 @@ const struct UTIL_LPM_Driver_s UTIL_PowerDriver =
 
 /* Private functions prototypes-----------------------------------------------*/
 static void Switch_On_HSI( void );
+static uint32_t ReadRtcTime( void );
+static void UpdateTick( void );
 
 
 /* Functions Definition ------------------------------------------------------*/
@@ -145,6 +158,9 @@ void PWR_EnterStopMode( void )
   /* Release RCC semaphore */
   LL_HSEM_ReleaseLock( HSEM, CFG_HW_RCC_SEMID, 0 );
 
+  HAL_SuspendTick( );
+  StopEntryTime = ReadRtcTime( );
+
   /************************************************************************************
    * ENTER STOP MODE
    ***********************************************************************************/
@@ -196,6 +212,9 @@ void PWR_ExitStopMode( void )
 
   /* Release RCC semaphore */
   LL_HSEM_ReleaseLock( HSEM, CFG_HW_RCC_SEMID, 0 );
+
+  UpdateTick( );
+  HAL_ResumeTick( );
 }
 
 /**
@@ -249,6 +268,58 @@ static void Switch_On_HSI( void )
   while (LL_RCC_GetSysClkSource( ) != LL_RCC_SYS_CLKSOURCE_STATUS_HSI);
 }
 
+/**
+  * @brief Read the RTC calendar time of the day
+  * @note The shadow registers are bypassed (see HW_TS_Init()): the time is read again until
+  *       the subsecond counter does not change meanwhile
+  * @param none
+  * @retval Time of the day in 1/(PREDIV_S+1) s
+  */
+static uint32_t ReadRtcTime( void )
+{
+  uint32_t ssr;
+  uint32_t tr;
+  uint32_t prediv_s = LL_RTC_GetSynchPrescaler( RTC );
+
+  do
+  {
+    ssr = LL_RTC_TIME_GetSubSecond( RTC );
+    tr = READ_REG( RTC->TR );
+  } while( ssr != LL_RTC_TIME_GetSubSecond( RTC ) );
+
+  tr = ( __LL_RTC_CONVERT_BCD2BIN( ( tr & ( RTC_TR_HT | RTC_TR_HU ) ) >> RTC_TR_HU_Pos ) * 3600U )
+     + ( __LL_RTC_CONVERT_BCD2BIN( ( tr & ( RTC_TR_MNT | RTC_TR_MNU ) ) >> RTC_TR_MNU_Pos ) * 60U )
+     + __LL_RTC_CONVERT_BCD2BIN( ( tr & ( RTC_TR_ST | RTC_TR_SU ) ) >> RTC_TR_SU_Pos );
+
+  /* The subsecond counter counts down from PREDIV_S */
+  return ( tr * ( prediv_s + 1U ) ) + ( prediv_s - ssr );
+}
+
+/**
+  * @brief Add the time spent in Stop mode to the HAL tick
+  * @param none
+  * @retval none
+  */
+static void UpdateTick( void )
+{
+  uint32_t prediv_s = LL_RTC_GetSynchPrescaler( RTC );
+  uint32_t day = RTC_SECONDS_PER_DAY * ( prediv_s + 1U );
+  uint32_t now = ReadRtcTime( );
+  uint32_t elapsed;
+  uint32_t ms;
+
+  /* The day is up to 0xA8C00000 subseconds (PREDIV_S 0x7FFF): now + day would overflow */
+  elapsed = ( now >= StopEntryTime ) ? ( now - StopEntryTime ) : ( now + ( day - StopEntryTime ) );
+
+  /* Whole seconds first, elapsed * 1000 overflows after a few seconds */
+  ms = ( elapsed / ( prediv_s + 1U ) ) * 1000U;
+  elapsed = ( ( elapsed % ( prediv_s + 1U ) ) * 1000U ) + StopTickRemainder;
+  ms += elapsed / ( prediv_s + 1U );
+  StopTickRemainder = elapsed % ( prediv_s + 1U );
+
+  uwTick += ms;
+}
+
 
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -39,6 +39,8 @@ __weak HAL_StatusTypeDef MX_I2C1_Init(I2C_HandleTypeDef* hi2c);
   */
 
 I2C_HandleTypeDef hi2c1;											
+DMA_HandleTypeDef hdma_i2c1_rx;
+DMA_HandleTypeDef hdma_i2c1_tx;
 /**
   * @}
   */
@@ -52,6 +54,9 @@ static uint32_t IsI2C1MspCbValid = 0;
 #endif /* USE_HAL_I2C_REGISTER_CALLBACKS */				
 
 static uint32_t I2C1InitCounter = 0;
+
+/* Transactions posted with BSP_I2C1_ReadRegAsync/WriteRegAsync */
+static I2C_QUEUE_t I2C1Queue;
 /**
   * @}
   */
@@ -62,6 +67,9 @@ static uint32_t I2C1InitCounter = 0;
 
 static void I2C1_MspInit(I2C_HandleTypeDef* hI2c); 
 static void I2C1_MspDeInit(I2C_HandleTypeDef* hI2c);
+static int32_t I2C1_Queue_Start(uint16_t DevAddr, uint16_t Reg, uint8_t Dir, uint8_t *pData, uint16_t Length);
+static int32_t I2C1_GetError(void);
+static int32_t I2C1_WaitIdle(void);
 #if (USE_CUBEMX_BSP_V2 == 1)
 static uint32_t I2C_GetTiming(uint32_t clock_src_hz, uint32_t i2cfreq_hz);
 static void Compute_PRESC_SCLDEL_SDADEL(uint32_t clock_src_freq, uint32_t I2C_Speed);
@@ -124,6 +132,7 @@ int32_t BSP_I2C1_Init(void)
     	}
     	else
     	{
+      		I2C_QUEUE_Init(&I2C1Queue, I2C1_Queue_Start);
       		ret = BSP_ERROR_NONE;
     	}
 	  }	
@@ -168,6 +177,11 @@ int32_t BSP_I2C1_IsReady(uint16_t DevAddr, uint32_t Trials)
 {
   int32_t ret = BSP_ERROR_NONE;
   
+  if (I2C1_WaitIdle() != BSP_ERROR_NONE)
+  {
+    return BSP_ERROR_BUSY;
+  }
+
   if (HAL_I2C_IsDeviceReady(&hi2c1, DevAddr, Trials, BUS_I2C1_POLL_TIMEOUT) != HAL_OK)
   {
     ret = BSP_ERROR_BUSY;
@@ -189,6 +203,11 @@ int32_t BSP_I2C1_WriteReg(uint16_t DevAddr, uint16_t Reg, uint8_t *pData, uint16
 {
   int32_t ret = BSP_ERROR_NONE;  
   
+  if (I2C1_WaitIdle() != BSP_ERROR_NONE)
+  {
+    return BSP_ERROR_BUSY;
+  }
+
   if (HAL_I2C_Mem_Write(&hi2c1, DevAddr,Reg, I2C_MEMADD_SIZE_8BIT,pData, Length, BUS_I2C1_POLL_TIMEOUT) != HAL_OK)
   {    
     if (HAL_I2C_GetError(&hi2c1) == HAL_I2C_ERROR_AF)
@@ -215,6 +234,11 @@ int32_t  BSP_I2C1_ReadReg(uint16_t DevAddr, uint16_t Reg, uint8_t *pData, uint16
 {
   int32_t ret = BSP_ERROR_NONE;
   
+  if (I2C1_WaitIdle() != BSP_ERROR_NONE)
+  {
+    return BSP_ERROR_BUSY;
+  }
+
   if (HAL_I2C_Mem_Read(&hi2c1, DevAddr, Reg, I2C_MEMADD_SIZE_8BIT, pData, Length, BUS_I2C1_POLL_TIMEOUT) != HAL_OK)
   { 
     if (HAL_I2C_GetError(&hi2c1) == HAL_I2C_ERROR_AF)
@@ -244,6 +268,11 @@ int32_t BSP_I2C1_WriteReg16(uint16_t DevAddr, uint16_t Reg, uint8_t *pData, uint
   int32_t ret = BSP_ERROR_NONE;
   
   
+  if (I2C1_WaitIdle() != BSP_ERROR_NONE)
+  {
+    return BSP_ERROR_BUSY;
+  }
+
   if (HAL_I2C_Mem_Write(&hi2c1, DevAddr, Reg, I2C_MEMADD_SIZE_16BIT, pData, Length, BUS_I2C1_POLL_TIMEOUT) != HAL_OK)
   {
     if (HAL_I2C_GetError(&hi2c1) == HAL_I2C_ERROR_AF)    
@@ -269,6 +298,11 @@ int32_t  BSP_I2C1_ReadReg16(uint16_t DevAddr, uint16_t Reg, uint8_t *pData, uint
 {
   int32_t ret = BSP_ERROR_NONE;  
  
+  if (I2C1_WaitIdle() != BSP_ERROR_NONE)
+  {
+    return BSP_ERROR_BUSY;
+  }
+
   if (HAL_I2C_Mem_Read(&hi2c1, DevAddr, Reg, I2C_MEMADD_SIZE_16BIT, pData, Length, BUS_I2C1_POLL_TIMEOUT) != HAL_OK)
   {
     if (HAL_I2C_GetError(&hi2c1) != HAL_I2C_ERROR_AF)
@@ -293,6 +327,11 @@ int32_t  BSP_I2C1_ReadReg16(uint16_t DevAddr, uint16_t Reg, uint8_t *pData, uint
 int32_t BSP_I2C1_Send(uint16_t DevAddr, uint8_t *pData, uint16_t Length) {
   int32_t ret = BSP_ERROR_NONE;	  
   
+  if (I2C1_WaitIdle() != BSP_ERROR_NONE)
+  {
+    return BSP_ERROR_BUSY;
+  }
+
   if (HAL_I2C_Master_Transmit(&hi2c1, DevAddr, pData, Length, BUS_I2C1_POLL_TIMEOUT) != HAL_OK)
   {
     if (HAL_I2C_GetError(&hi2c1) != HAL_I2C_ERROR_AF)
@@ -318,6 +357,11 @@ int32_t BSP_I2C1_Send(uint16_t DevAddr, uint8_t *pData, uint16_t Length) {
 int32_t BSP_I2C1_Recv(uint16_t DevAddr, uint8_t *pData, uint16_t Length) {	
   int32_t ret = BSP_ERROR_NONE;
   
+  if (I2C1_WaitIdle() != BSP_ERROR_NONE)
+  {
+    return BSP_ERROR_BUSY;
+  }
+
   if (HAL_I2C_Master_Receive(&hi2c1, DevAddr, pData, Length, BUS_I2C1_POLL_TIMEOUT) != HAL_OK)
   {
     if (HAL_I2C_GetError(&hi2c1) != HAL_I2C_ERROR_AF)
@@ -332,6 +376,140 @@ int32_t BSP_I2C1_Recv(uint16_t DevAddr, uint8_t *pData, uint16_t Length) {
   return ret;
 }
 
+/**
+  * @brief  Post a register read, serviced by DMA once the transactions
+  *         before it are done. The function returns at once.
+  * @param  DevAddr  Device address on Bus.
+  * @param  Reg      The target register address to read
+  * @param  pData    Pointer to data buffer to read, valid until the callback
+  * @param  Length   Data Length
+  * @param  Flags    I2C_QUEUE_FLAG_MERGE to share one transfer with the
+  *                  previous read of contiguous registers of the device
+  * @param  Callback Called from the I2C interrupt with the BSP status
+  * @param  pCtx     Passed back to the callback
+  * @retval BSP status
+  */
+int32_t BSP_I2C1_ReadRegAsync(uint16_t DevAddr, uint16_t Reg, uint8_t *pData, uint16_t Length,
+                              uint8_t Flags, I2C_QUEUE_Cb_t Callback, void *pCtx)
+{
+  I2C_QUEUE_Xfer_t xfer;
+  uint32_t primask_bit;
+  int32_t ret;
+
+  xfer.DevAddr = DevAddr;
+  xfer.Reg = Reg;
+  xfer.pData = pData;
+  xfer.Length = Length;
+  xfer.Dir = I2C_QUEUE_READ;
+  xfer.Flags = Flags;
+  xfer.Callback = Callback;
+  xfer.pCtx = pCtx;
+
+  /* The queue is also updated by the I2C1 completion interrupt */
+  primask_bit = __get_PRIMASK();
+  __disable_irq();
+  ret = I2C_QUEUE_Post(&I2C1Queue, &xfer);
+  __set_PRIMASK(primask_bit);
+
+  return (ret == I2C_QUEUE_OK) ? BSP_ERROR_NONE : BSP_ERROR_BUSY;
+}
+
+/**
+  * @brief  Post a register write, serviced by DMA once the transactions
+  *         before it are done. The function returns at once.
+  * @param  DevAddr  Device address on Bus.
+  * @param  Reg      The target register address to write
+  * @param  pData    Pointer to data buffer to write, valid until the callback
+  * @param  Length   Data Length
+  * @param  Flags    I2C_QUEUE_FLAG_MERGE to share one transfer with the
+  *                  previous write of contiguous registers of the device
+  * @param  Callback Called from the I2C interrupt with the BSP status
+  * @param  pCtx     Passed back to the callback
+  * @retval BSP status
+  */
+int32_t BSP_I2C1_WriteRegAsync(uint16_t DevAddr, uint16_t Reg, uint8_t *pData, uint16_t Length,
+                               uint8_t Flags, I2C_QUEUE_Cb_t Callback, void *pCtx)
+{
+  I2C_QUEUE_Xfer_t xfer;
+  uint32_t primask_bit;
+  int32_t ret;
+
+  xfer.DevAddr = DevAddr;
+  xfer.Reg = Reg;
+  xfer.pData = pData;
+  xfer.Length = Length;
+  xfer.Dir = I2C_QUEUE_WRITE;
+  xfer.Flags = Flags;
+  xfer.Callback = Callback;
+  xfer.pCtx = pCtx;
+
+  /* The queue is also updated by the I2C1 completion interrupt */
+  primask_bit = __get_PRIMASK();
+  __disable_irq();
+  ret = I2C_QUEUE_Post(&I2C1Queue, &xfer);
+  __set_PRIMASK(primask_bit);
+
+  return (ret == I2C_QUEUE_OK) ? BSP_ERROR_NONE : BSP_ERROR_BUSY;
+}
+
+/**
+  * @brief  Get the statistics of the asynchronous transactions
+  * @param  pStats Where the statistics are copied
+  * @retval None
+  */
+void BSP_I2C1_GetQueueStats(I2C_QUEUE_Stats_t *pStats)
+{
+  uint32_t primask_bit = __get_PRIMASK();
+
+  __disable_irq();
+  *pStats = I2C1Queue.Stats;
+  __set_PRIMASK(primask_bit);
+}
+
+/**
+  * @brief  Check whether an asynchronous transaction is queued or ongoing
+  * @note   The I2C1 DMA does not run in Stop mode, see UTIL_SEQ_Idle()
+  * @retval 1 when idle, 0 otherwise
+  */
+uint8_t BSP_I2C1_IsQueueIdle(void)
+{
+  return I2C_QUEUE_IsIdle(&I2C1Queue);
+}
+
+/**
+  * @brief  Transfer completed callbacks (I2C1 interrupt context)
+  * @param  hi2c I2C handle
+  * @retval None
+  */
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+  if (hi2c->Instance == I2C1)
+  {
+    I2C_QUEUE_Complete(&I2C1Queue, BSP_ERROR_NONE);
+  }
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+  if (hi2c->Instance == I2C1)
+  {
+    I2C_QUEUE_Complete(&I2C1Queue, BSP_ERROR_NONE);
+  }
+}
+
+/**
+  * @brief  Transfer error callback (I2C1 interrupt context)
+  * @param  hi2c I2C handle
+  * @retval None
+  */
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+  if (hi2c->Instance == I2C1)
+  {
+    I2C_QUEUE_Complete(&I2C1Queue, I2C1_GetError());
+  }
+}
+
 #if (USE_HAL_I2C_REGISTER_CALLBACKS == 1)  
 /**
   * @brief Register Default BSP I2C1 Bus Msp Callbacks
@@ -447,6 +625,56 @@ static void I2C1_MspInit(I2C_HandleTypeDef* i2cHandle)
 
     /* Peripheral clock enable */
     __HAL_RCC_I2C1_CLK_ENABLE();
+
+    /* I2C1 DMA Init */
+    __HAL_RCC_DMAMUX1_CLK_ENABLE();
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    /* I2C1_RX Init */
+    hdma_i2c1_rx.Instance = DMA1_Channel1;
+    hdma_i2c1_rx.Init.Request = DMA_REQUEST_I2C1_RX;
+    hdma_i2c1_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_i2c1_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_i2c1_rx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_i2c1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_i2c1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_i2c1_rx.Init.Mode = DMA_NORMAL;
+    hdma_i2c1_rx.Init.Priority = DMA_PRIORITY_LOW;
+    if (HAL_DMA_Init(&hdma_i2c1_rx) != HAL_OK)
+    {
+      /* Asynchronous transfers will report BSP_ERROR_PERIPH_FAILURE */
+      return;
+    }
+
+    __HAL_LINKDMA(i2cHandle,hdmarx,hdma_i2c1_rx);
+
+    /* I2C1_TX Init */
+    hdma_i2c1_tx.Instance = DMA1_Channel2;
+    hdma_i2c1_tx.Init.Request = DMA_REQUEST_I2C1_TX;
+    hdma_i2c1_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_i2c1_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_i2c1_tx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_i2c1_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_i2c1_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_i2c1_tx.Init.Mode = DMA_NORMAL;
+    hdma_i2c1_tx.Init.Priority = DMA_PRIORITY_LOW;
+    if (HAL_DMA_Init(&hdma_i2c1_tx) != HAL_OK)
+    {
+      /* Asynchronous transfers will report BSP_ERROR_PERIPH_FAILURE */
+      return;
+    }
+
+    __HAL_LINKDMA(i2cHandle,hdmatx,hdma_i2c1_tx);
+
+    /* I2C1 and DMA interrupts Init */
+    HAL_NVIC_SetPriority(DMA1_Channel1_IRQn, 15, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+    HAL_NVIC_SetPriority(DMA1_Channel2_IRQn, 15, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel2_IRQn);
+    HAL_NVIC_SetPriority(I2C1_EV_IRQn, 15, 0);
+    HAL_NVIC_EnableIRQ(I2C1_EV_IRQn);
+    HAL_NVIC_SetPriority(I2C1_ER_IRQn, 15, 0);
+    HAL_NVIC_EnableIRQ(I2C1_ER_IRQn);
   /* USER CODE BEGIN I2C1_MspInit 1 */
 
   /* USER CODE END I2C1_MspInit 1 */
@@ -466,11 +694,77 @@ static void I2C1_MspDeInit(I2C_HandleTypeDef* i2cHandle)
     */
     HAL_GPIO_DeInit(GPIOB, GPIO_PIN_8|GPIO_PIN_9);
 
+    /* I2C1 DMA DeInit */
+    HAL_DMA_DeInit(i2cHandle->hdmarx);
+    HAL_DMA_DeInit(i2cHandle->hdmatx);
+
+    /* I2C1 and DMA interrupts DeInit */
+    HAL_NVIC_DisableIRQ(I2C1_EV_IRQn);
+    HAL_NVIC_DisableIRQ(I2C1_ER_IRQn);
+    HAL_NVIC_DisableIRQ(DMA1_Channel1_IRQn);
+    HAL_NVIC_DisableIRQ(DMA1_Channel2_IRQn);
+
   /* USER CODE BEGIN I2C1_MspDeInit 1 */
 
   /* USER CODE END I2C1_MspDeInit 1 */
 }
 
+/**
+  * @brief  Start one transfer of the queue with DMA
+  * @param  DevAddr Device address on Bus.
+  * @param  Reg     The target register address
+  * @param  Dir     I2C_QUEUE_READ or I2C_QUEUE_WRITE
+  * @param  pData   Pointer to data buffer
+  * @param  Length  Data Length
+  * @retval BSP status
+  */
+static int32_t I2C1_Queue_Start(uint16_t DevAddr, uint16_t Reg, uint8_t Dir, uint8_t *pData, uint16_t Length)
+{
+  HAL_StatusTypeDef status;
+
+  if (Dir == I2C_QUEUE_READ)
+  {
+    status = HAL_I2C_Mem_Read_DMA(&hi2c1, DevAddr, Reg, I2C_MEMADD_SIZE_8BIT, pData, Length);
+  }
+  else
+  {
+    status = HAL_I2C_Mem_Write_DMA(&hi2c1, DevAddr, Reg, I2C_MEMADD_SIZE_8BIT, pData, Length);
+  }
+
+  return (status == HAL_OK) ? BSP_ERROR_NONE : I2C1_GetError();
+}
+
+/**
+  * @brief  Translate the last HAL I2C error
+  * @retval BSP status
+  */
+static int32_t I2C1_GetError(void)
+{
+  if (HAL_I2C_GetError(&hi2c1) == HAL_I2C_ERROR_AF)
+  {
+    return BSP_ERROR_BUS_ACKNOWLEDGE_FAILURE;
+  }
+  return BSP_ERROR_PERIPH_FAILURE;
+}
+
+/**
+  * @brief  Let the posted transactions finish before a blocking access
+  * @retval BSP status
+  */
+static int32_t I2C1_WaitIdle(void)
+{
+  uint32_t tickstart = HAL_GetTick();
+
+  while (I2C_QUEUE_IsIdle(&I2C1Queue) == 0U)
+  {
+    if ((HAL_GetTick() - tickstart) > BUS_I2C1_POLL_TIMEOUT)
+    {
+      return BSP_ERROR_BUSY;
+    }
+  }
+  return BSP_ERROR_NONE;
+}
+
 /**
   * @}
   */
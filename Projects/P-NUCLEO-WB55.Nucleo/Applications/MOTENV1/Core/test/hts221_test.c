@@ -0,0 +1,336 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \brief Host test of the HTS221 calibration read at init
+ *
+ *  The driver runs against a register map: a real part, calibrations in
+ *  realistic ranges, any register value and x1 == x0. Every humidity and
+ *  temperature must be the one of the float interpolation between the
+ *  points given by the hts221_*_point_*_get() register functions, bit for
+ *  bit but for the sign of a zero. A sample takes the two output register
+ *  reads only.
+ *
+ *  Run by Tools/run_host_tests.sh
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdbool.h>
+#include <stdio.h>
+#include "hts221.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define SIM_CALIBRATIONS       300U
+#define SIM_FULL_RANGE         20U                     /*!< Calibrations with every raw value */
+#define SIM_RAW_STEP           37
+
+#define CHECK( cond )          do { if( !(cond) ) { printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond ); gFailures++; } } while(0)
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static uint32_t         gFailures;
+static uint8_t          gRegs[0x40];
+static uint32_t         gXfers;
+static uint32_t         gRng = 12345;
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+static uint32_t simRand( void )
+{
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 17;
+    gRng ^= gRng << 5;
+    return gRng;
+}
+
+static int32_t simIoInit( void )
+{
+    return 0;
+}
+
+static int32_t simIoDeInit( void )
+{
+    return 0;
+}
+
+static int32_t simIoTick( void )
+{
+    return 0;
+}
+
+/* Auto increment read, the MSB of the register address is the increment bit */
+static int32_t simIoRead( uint16_t addr, uint16_t reg, uint8_t *data, uint16_t len )
+{
+    uint16_t i;
+
+    (void)addr;
+    gXfers++;
+    for( i = 0; i < len; i++ )
+    {
+        data[i] = gRegs[((reg & 0x7FU) + i) & 0x3FU];
+    }
+    return 0;
+}
+
+/* The output and calibration registers are read only */
+static int32_t simIoWrite( uint16_t addr, uint16_t reg, uint8_t *data, uint16_t len )
+{
+    uint16_t i;
+    uint16_t r;
+
+    (void)addr;
+    gXfers++;
+    for( i = 0; i < len; i++ )
+    {
+        r = ((reg & 0x7FU) + i) & 0x3FU;
+        if( r < HTS221_HUMIDITY_OUT_L )
+        {
+            gRegs[r] = data[i];
+        }
+    }
+    return 0;
+}
+
+static void simSet16( uint8_t reg, int16_t value )
+{
+    gRegs[reg]      = (uint8_t)value;
+    gRegs[reg + 1U] = (uint8_t)((uint16_t)value >> 8);
+}
+
+static void simCalibration( uint32_t c )
+{
+    uint16_t t0;
+    uint16_t t1;
+    uint8_t  r;
+
+    memset( gRegs, 0x00, sizeof(gRegs) );
+    gRegs[HTS221_WHO_AM_I] = HTS221_ID;
+
+    if( c == 0U )
+    {
+        /* A real part */
+        gRegs[HTS221_H0_RH_X2]   = 0x3C;
+        gRegs[HTS221_H1_RH_X2]   = 0x8C;
+        gRegs[HTS221_T0_DEGC_X8] = 0xAD;
+        gRegs[HTS221_T1_DEGC_X8] = 0x2A;
+        gRegs[HTS221_T1_T0_MSB]  = 0x05;
+        simSet16( HTS221_H0_T0_OUT_L, 3 );
+        simSet16( HTS221_H1_T0_OUT_L, -8617 );
+        simSet16( HTS221_T0_OUT_L, 0 );
+        simSet16( HTS221_T1_OUT_L, 678 );
+    }
+    else if( (c % 3U) == 1U )
+    {
+        /* Realistic ranges */
+        t0 = (uint16_t)(80U + (simRand() % 160U));
+        t1 = (uint16_t)(t0 + 200U + (simRand() % 200U));
+        gRegs[HTS221_H0_RH_X2]   = (uint8_t)(40U + (simRand() % 30U));
+        gRegs[HTS221_H1_RH_X2]   = (uint8_t)(120U + (simRand() % 60U));
+        gRegs[HTS221_T0_DEGC_X8] = (uint8_t)t0;
+        gRegs[HTS221_T1_DEGC_X8] = (uint8_t)t1;
+        gRegs[HTS221_T1_T0_MSB]  = (uint8_t)(((t0 >> 8) & 3U) | (((t1 >> 8) & 3U) << 2));
+        simSet16( HTS221_H0_T0_OUT_L, (int16_t)((int32_t)(simRand() % 2000U) - 1000) );
+        simSet16( HTS221_H1_T0_OUT_L, (int16_t)((int32_t)(simRand() % 20000U) - 10000) );
+        simSet16( HTS221_T0_OUT_L, (int16_t)((int32_t)(simRand() % 2000U) - 1000) );
+        simSet16( HTS221_T1_OUT_L, (int16_t)(simRand() % 2000U) );
+    }
+    else
+    {
+        /* Any register value */
+        for( r = HTS221_H0_RH_X2; r <= HTS221_T1_OUT_H; r++ )
+        {
+            gRegs[r] = (uint8_t)simRand();
+        }
+        if( (c % 17U) == 0U )
+        {
+            gRegs[HTS221_H1_T0_OUT_L] = gRegs[HTS221_H0_T0_OUT_L];
+            gRegs[HTS221_H1_T0_OUT_H] = gRegs[HTS221_H0_T0_OUT_H];
+        }
+    }
+}
+
+/* The float interpolation between the points of the register functions */
+static float simInterpolation( hts221_ctx_t *ctx, bool humidity, int16_t raw )
+{
+    axis1bit16_t coeff;
+    lin_t        lin;
+    float        value;
+
+    if( humidity )
+    {
+        (void)hts221_hum_adc_point_0_get( ctx, coeff.u8bit );
+        lin.x0 = (float)coeff.i16bit;
+        (void)hts221_hum_rh_point_0_get( ctx, coeff.u8bit );
+        lin.y0 = (float)coeff.u8bit[0];
+        (void)hts221_hum_adc_point_1_get( ctx, coeff.u8bit );
+        lin.x1 = (float)coeff.i16bit;
+        (void)hts221_hum_rh_point_1_get( ctx, coeff.u8bit );
+        lin.y1 = (float)coeff.u8bit[0];
+    }
+    else
+    {
+        (void)hts221_temp_adc_point_0_get( ctx, coeff.u8bit );
+        lin.x0 = (float)coeff.i16bit;
+        (void)hts221_temp_deg_point_0_get( ctx, coeff.u8bit );
+        lin.y0 = (float)coeff.u8bit[0];
+        (void)hts221_temp_adc_point_1_get( ctx, coeff.u8bit );
+        lin.x1 = (float)coeff.i16bit;
+        (void)hts221_temp_deg_point_1_get( ctx, coeff.u8bit );
+        lin.y1 = (float)coeff.u8bit[0];
+    }
+
+    value = (((lin.y1 - lin.y0) * (float)raw) + ((lin.x1 * lin.y0) - (lin.x0 * lin.y1))) / (lin.x1 - lin.x0);
+    if( humidity && (value < 0.0f) )
+    {
+        value = 0.0f;
+    }
+    if( humidity && (value > 100.0f) )
+    {
+        value = 100.0f;
+    }
+    return value;
+}
+
+/* Same bits, any zero or any NaN */
+static bool simSame( float a, float b )
+{
+    uint32_t ba;
+    uint32_t bb;
+
+    if( (a != a) || (b != b) )
+    {
+        return (a != a) && (b != b);
+    }
+    if( (a == 0.0f) && (b == 0.0f) )
+    {
+        return true;
+    }
+    memcpy( &ba, &a, sizeof(ba) );
+    memcpy( &bb, &b, sizeof(bb) );
+    return ba == bb;
+}
+
+static void testCalibrations( void )
+{
+    HTS221_IO_t     io = { simIoInit, simIoDeInit, 0, HTS221_I2C_ADDRESS, simIoWrite, simIoRead, simIoTick };
+    HTS221_Object_t obj;
+    uint32_t        c;
+    int32_t         raw;
+    uint32_t        samples  = 0;
+    uint32_t        mismatch = 0;
+    uint32_t        xfers    = 0;
+    uint32_t        x0;
+    float           hum;
+    float           temp;
+
+    for( c = 0; c < SIM_CALIBRATIONS; c++ )
+    {
+        memset( &obj, 0x00, sizeof(obj) );
+        simCalibration( c );
+        CHECK( HTS221_RegisterBusIO( &obj, &io ) == HTS221_OK );
+        CHECK( HTS221_Init( &obj ) == HTS221_OK );
+
+        for( raw = -32768; raw <= 32767; raw += (c < SIM_FULL_RANGE) ? 1 : SIM_RAW_STEP )
+        {
+            simSet16( HTS221_HUMIDITY_OUT_L, (int16_t)raw );
+            simSet16( HTS221_TEMP_OUT_L, (int16_t)(-raw - 1) );
+
+            x0 = gXfers;
+            CHECK( HTS221_HUM_GetHumidity( &obj, &hum ) == HTS221_OK );
+            CHECK( HTS221_TEMP_GetTemperature( &obj, &temp ) == HTS221_OK );
+            xfers += gXfers - x0;
+            samples++;
+
+            if( !simSame( hum, simInterpolation( &obj.Ctx, true, (int16_t)raw ) ) ||
+                !simSame( temp, simInterpolation( &obj.Ctx, false, (int16_t)(-raw - 1) ) ) )
+            {
+                if( mismatch++ == 0U )
+                {
+                    printf( "FAIL calibration %lu raw %ld: %g %%rH %g degC\n", (unsigned long)c, (long)raw, hum, temp );
+                }
+            }
+        }
+    }
+
+    printf( "  %lu calibrations, %lu samples, %lu bus transactions per sample\n",
+            (unsigned long)SIM_CALIBRATIONS, (unsigned long)samples, (unsigned long)(xfers / samples) );
+    CHECK( mismatch == 0U );
+    CHECK( xfers == (2U * samples) );
+}
+
+/* A real part at a few raw values */
+static void testRealPart( void )
+{
+    HTS221_IO_t     io = { simIoInit, simIoDeInit, 0, HTS221_I2C_ADDRESS, simIoWrite, simIoRead, simIoTick };
+    HTS221_Object_t obj;
+    float           hum;
+    float           temp;
+
+    memset( &obj, 0x00, sizeof(obj) );
+    simCalibration( 0 );
+    CHECK( HTS221_RegisterBusIO( &obj, &io ) == HTS221_OK );
+    CHECK( HTS221_Init( &obj ) == HTS221_OK );
+
+    /* H0 30 %rH at 3, H1 70 %rH at -8617; T0 53 degC at 0, T1 37 degC at 678 */
+    simSet16( HTS221_HUMIDITY_OUT_L, -4307 );
+    simSet16( HTS221_TEMP_OUT_L, 339 );
+    CHECK( HTS221_HUM_GetHumidity( &obj, &hum ) == HTS221_OK );
+    CHECK( HTS221_TEMP_GetTemperature( &obj, &temp ) == HTS221_OK );
+    CHECK( (hum > 49.99f) && (hum < 50.01f) );
+    CHECK( (temp > 44.99f) && (temp < 45.01f) );
+
+    simSet16( HTS221_HUMIDITY_OUT_L, 32767 );
+    CHECK( (HTS221_HUM_GetHumidity( &obj, &hum ) == HTS221_OK) && (hum == 0.0f) );
+    simSet16( HTS221_HUMIDITY_OUT_L, -32768 );
+    CHECK( (HTS221_HUM_GetHumidity( &obj, &hum ) == HTS221_OK) && (hum == 100.0f) );
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+int main( void )
+{
+    testRealPart();
+    testCalibrations();
+
+    printf( "%s\n", (gFailures == 0U) ? "PASS" : "FAIL" );
+    return (gFailures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,349 @@
+/**
+ ******************************************************************************
+ * File Name          : hw_timerserver_test.c
+ * Description        : Host test of the Timer Server against a simulated RTC
+ *                      wakeup timer: random starts and stops of repeated and
+ *                      single shot timers, no timer may expire early or late.
+ *                      Run by Tools/run_host_tests.sh
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Simulated RTC -------------------------------------------------------------*/
+/* The time unit is the wakeup timer tick (RTCCLK/16 = 2048 Hz), the sub-second
+ * register counts down at the same rate */
+#include <stdint.h>
+#include "hw_conf.h"
+
+typedef struct
+{
+  volatile uint32_t CR;
+  volatile uint32_t SSR;
+  volatile uint32_t PRER;
+  volatile uint32_t WUTR;
+} RTC_TypeDef;
+
+typedef struct
+{
+  uint32_t Dummy;
+} RTC_HandleTypeDef;
+
+#if (CFG_HW_TS_INSTRUMENTATION == 1)
+typedef struct
+{
+  uint32_t CYCCNT;
+  uint32_t CTRL;
+} DWT_Type;
+
+typedef struct
+{
+  uint32_t DEMCR;
+} CoreDebug_Type;
+
+static DWT_Type SimDwt;
+static CoreDebug_Type SimCoreDebug;
+
+#define DWT                                       (&SimDwt)
+#define CoreDebug                                 (&SimCoreDebug)
+#define CoreDebug_DEMCR_TRCENA_Msk                (1U)
+#define DWT_CTRL_CYCCNTENA_Msk                    (1U)
+#endif
+
+static RTC_TypeDef SimRtc;
+static uint32_t SimIrqPending;
+static uint32_t SimIrqEnabled = 1;
+static uint64_t SimNow;
+static uint64_t SimWutStart;
+static uint32_t SimWutEnabled;
+static uint32_t SimWutFlag;
+static uint64_t SimRegReads;
+static uint64_t SimWutSetups;
+
+static uint32_t Sim_Read(volatile uint32_t *pReg);
+static uint32_t Sim_Flag(uint32_t Flag);
+static void Sim_Wut_Enable(uint32_t Enable);
+
+#define LSI_VALUE                                 (32000)
+#define RTC                                       (&SimRtc)
+#define RTC_CR_WUTE                               (1U << 10)
+#define RTC_CR_WUCKSEL                            (7U)
+#define RTC_CR_BYPSHAD                            (1U << 5)
+#define RTC_SSR_SS                                (0xFFFFU)
+#define RTC_PRER_PREDIV_A                         (0x7FU << 16)
+#define RTC_PRER_PREDIV_S                         (0x7FFFU)
+#define RTC_WUTR_WUT                              (0xFFFFU)
+#define RTC_FLAG_WUTWF                            (1U)
+#define RTC_FLAG_WUTF                             (2U)
+#define RTC_IT_WUT                                (0U)
+#define RTC_EXTI_LINE_WAKEUPTIMER_EVENT           (0U)
+#define RTC_WKUP_IRQn                             (3)
+#define SET                                       (1U)
+#define RESET                                     (0U)
+#define READ_BIT(REG, BIT)                        (Sim_Read(&(REG)) & (BIT))
+#define SET_BIT(REG, BIT)                         ((REG) |= (BIT))
+#define MODIFY_REG(REG, CLEARMASK, SETMASK)       ((REG) = (((REG) & (~(CLEARMASK))) | (SETMASK)))
+#define POSITION_VAL(VAL)                         (__builtin_ctz(VAL))
+#define __HAL_RTC_WAKEUPTIMER_GET_FLAG(h, f)      (Sim_Flag(f))
+#define __HAL_RTC_WAKEUPTIMER_DISABLE(h)          Sim_Wut_Enable(0)
+#define __HAL_RTC_WAKEUPTIMER_ENABLE(h)           Sim_Wut_Enable(1)
+#define __HAL_RTC_WAKEUPTIMER_CLEAR_FLAG(h, f)    (SimWutFlag = 0)
+#define __HAL_RTC_WAKEUPTIMER_EXTI_CLEAR_FLAG()   ((void)0)
+#define __HAL_RTC_WAKEUPTIMER_ENABLE_IT(h, i)     ((void)0)
+#define __HAL_RTC_WRITEPROTECTION_DISABLE(h)      ((void)0)
+#define __HAL_RTC_WRITEPROTECTION_ENABLE(h)       ((void)0)
+#define HAL_NVIC_SetPendingIRQ(i)                 (SimIrqPending = 1)
+#define HAL_NVIC_ClearPendingIRQ(i)               (SimIrqPending = 0)
+#define HAL_NVIC_DisableIRQ(i)                    (SimIrqEnabled = 0)
+#define HAL_NVIC_EnableIRQ(i)                     (SimIrqEnabled = 1)
+#define HAL_NVIC_SetPriority(i, p, s)             ((void)0)
+#define LL_EXTI_EnableRisingTrig_0_31(l)          ((void)0)
+#define LL_EXTI_EnableIT_0_31(l)                  ((void)0)
+
+/* Module under test ---------------------------------------------------------*/
+#include "../Src/hw_timerserver.c"
+
+/* Private defines -----------------------------------------------------------*/
+#define NB_TIMERS                       (10)
+#define NB_REPEATED                     (4)
+#define NB_STEPS                        (2000000)
+/* Ticks a callback may come after its deadline (wakeup handler granularity) */
+#define MAX_LATENCY                     (2)
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t TimerId[NB_TIMERS];
+static uint64_t Due[NB_TIMERS];
+static uint32_t Running[NB_TIMERS];
+static uint32_t Period[NB_TIMERS];
+static uint64_t Fires;
+static uint64_t LatencySum;
+static uint64_t LatencyMax;
+static uint32_t Failures;
+
+/* Simulated RTC -------------------------------------------------------------*/
+static void Sim_Update(void)
+{
+  uint64_t period;
+
+  if(SimWutEnabled != 0U)
+  {
+    period = (uint64_t)(SimRtc.WUTR & RTC_WUTR_WUT) + 1U;
+    if(SimNow >= (SimWutStart + period))
+    {
+      SimWutFlag = 1;
+      SimWutStart += period * ((SimNow - SimWutStart) / period);
+    }
+  }
+}
+
+static uint32_t Sim_Read(volatile uint32_t *pReg)
+{
+  SimRegReads++;
+  if(pReg == &SimRtc.SSR)
+  {
+    return 0x7FFFU - (uint32_t)(SimNow % 0x8000U);
+  }
+  if(pReg == &SimRtc.CR)
+  {
+    return SimRtc.CR | ((SimWutEnabled != 0U) ? RTC_CR_WUTE : 0U);
+  }
+  return *pReg;
+}
+
+static uint32_t Sim_Flag(uint32_t Flag)
+{
+  SimRegReads++;
+  Sim_Update();
+  if(Flag == RTC_FLAG_WUTWF)
+  {
+    return (SimWutEnabled == 0U) ? 1U : 0U;
+  }
+  return SimWutFlag;
+}
+
+static void Sim_Wut_Enable(uint32_t Enable)
+{
+  if((Enable != 0U) && (SimWutEnabled == 0U))
+  {
+    SimWutStart = SimNow;
+    SimWutSetups++;
+  }
+  SimWutEnabled = Enable;
+}
+
+static void Sim_Run_Irq(void)
+{
+  Sim_Update();
+  while(((SimIrqPending != 0U) || (SimWutFlag != 0U)) && (SimIrqEnabled != 0U))
+  {
+    SimIrqPending = 0;
+    SimWutFlag = 0;
+    HW_TS_RTC_Wakeup_Handler();
+    Sim_Update();
+  }
+}
+
+/* Timer callbacks -----------------------------------------------------------*/
+static void Timer_Fired(uint32_t Index)
+{
+  uint64_t latency;
+
+  if(Running[Index] == 0U)
+  {
+    printf("FAIL: timer %lu fired while stopped\n", (unsigned long)Index);
+    Failures++;
+    return;
+  }
+  if(SimNow < Due[Index])
+  {
+    printf("FAIL: timer %lu fired %llu ticks early\n", (unsigned long)Index, (unsigned long long)(Due[Index] - SimNow));
+    Failures++;
+    return;
+  }
+
+  latency = SimNow - Due[Index];
+  LatencySum += latency;
+  Fires++;
+  if(latency > LatencyMax)
+  {
+    LatencyMax = latency;
+  }
+
+  if(Index < NB_REPEATED)
+  {
+    Due[Index] = SimNow + Period[Index];
+  }
+  else
+  {
+    Running[Index] = 0;
+  }
+}
+
+#define TIMER_CB(n)   static void Timer_Cb##n(void) { Timer_Fired(n); }
+TIMER_CB(0) TIMER_CB(1) TIMER_CB(2) TIMER_CB(3) TIMER_CB(4)
+TIMER_CB(5) TIMER_CB(6) TIMER_CB(7) TIMER_CB(8) TIMER_CB(9)
+
+static const HW_TS_pTimerCb_t TimerCb[NB_TIMERS] =
+{
+  Timer_Cb0, Timer_Cb1, Timer_Cb2, Timer_Cb3, Timer_Cb4,
+  Timer_Cb5, Timer_Cb6, Timer_Cb7, Timer_Cb8, Timer_Cb9
+};
+
+void HW_TS_RTC_CountUpdated_AppNot(void)
+{
+}
+
+/* Private functions ---------------------------------------------------------*/
+static void Start(uint32_t Index, uint32_t Timeout)
+{
+  HW_TS_Start(TimerId[Index], Timeout);
+  Due[Index] = SimNow + Timeout;
+  Running[Index] = 1;
+  Sim_Run_Irq();
+}
+
+static void Stop(uint32_t Index)
+{
+  HW_TS_Stop(TimerId[Index]);
+  Running[Index] = 0;
+  Sim_Run_Irq();
+}
+
+/* MOTENV-like mix: sensor hub 10ms, environment 500ms, two faster repeated
+ * timers, and single shots (advertising, LED, NFC) started and stopped at random */
+static void Run(const char *pName, uint32_t MaxTimeout, uint32_t StartPercent)
+{
+  static const uint32_t repeated[NB_REPEATED] = {20, 1024, 41, 128};
+  RTC_HandleTypeDef hrtc;
+  uint32_t step;
+  uint32_t i;
+  uint32_t r;
+
+  memset(&SimRtc, 0, sizeof(SimRtc));
+  memset(Running, 0, sizeof(Running));
+  SimNow = SimWutStart = 0;
+  SimWutEnabled = SimWutFlag = SimIrqPending = 0;
+  SimRegReads = SimWutSetups = 0;
+  Fires = LatencySum = LatencyMax = 0;
+  srand(1);
+
+  SimRtc.PRER = (15U << 16) | 0x7FFFU;    /* WUCKSEL = 0: RTCCLK/16 */
+  HW_TS_Init(hw_ts_InitMode_Full, &hrtc);
+
+  for(i = 0; i < NB_TIMERS; i++)
+  {
+    Period[i] = (i < NB_REPEATED) ? repeated[i] : 0U;
+    HW_TS_Create(CFG_TIM_PROC_ID_ISR, &TimerId[i], (i < NB_REPEATED) ? hw_ts_Repeated : hw_ts_SingleShot, TimerCb[i]);
+  }
+  for(i = 0; i < NB_REPEATED; i++)
+  {
+    Start(i, Period[i]);
+  }
+
+  for(step = 0; step < NB_STEPS; step++)
+  {
+    SimNow += (uint64_t)(rand() % 3);
+    Sim_Run_Irq();
+
+    r = (uint32_t)(rand() % 100);
+    if(r < StartPercent)
+    {
+      Start(NB_REPEATED + ((uint32_t)rand() % (NB_TIMERS - NB_REPEATED)), 1U + ((uint32_t)rand() % MaxTimeout));
+    }
+    else if(r < (StartPercent + 3U))
+    {
+      Stop(NB_REPEATED + ((uint32_t)rand() % (NB_TIMERS - NB_REPEATED)));
+    }
+    else if(r < (StartPercent + 4U))
+    {
+      i = (uint32_t)rand() % NB_REPEATED;
+      Start(i, Period[i]);
+    }
+  }
+
+  /* Let the pending single shots expire: none may be lost */
+  for(i = 0; i < (MaxTimeout + MAX_LATENCY + 1U); i++)
+  {
+    SimNow++;
+    Sim_Run_Irq();
+  }
+  for(i = NB_REPEATED; i < NB_TIMERS; i++)
+  {
+    if(Running[i] != 0U)
+    {
+      printf("FAIL: timer %lu never fired\n", (unsigned long)i);
+      Failures++;
+    }
+  }
+  if(LatencyMax > MAX_LATENCY)
+  {
+    printf("FAIL: latency %llu ticks\n", (unsigned long long)LatencyMax);
+    Failures++;
+  }
+
+  printf("%s: %llu expiries, latency mean %.2f max %llu ticks, %llu wakeup timer setups, %llu RTC reads\n",
+         pName, (unsigned long long)Fires, (double)LatencySum / (double)Fires, (unsigned long long)LatencyMax,
+         (unsigned long long)SimWutSetups, (unsigned long long)SimRegReads);
+}
+
+int main(void)
+{
+  printf("Backend: %s\n", (CFG_HW_TS_USE_HEAP == 1) ? "heap" : "list");
+
+  /* Timeouts shorter than the 16 bits wakeup timer, and up to 50s */
+  Run("Short timeouts", 4000, 6);
+  Run("Long timeouts", 100000, 1);
+
+  printf("%s\n", (Failures == 0U) ? "PASS" : "FAIL");
+  return (Failures == 0U) ? 0 : 1;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,467 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \brief Host test of the I2C transaction queue
+ *
+ *  i2c_queue.c drives a simulated 400 kHz bus holding the registers of the
+ *  IKS01A3 IMU and magnetometer: a transfer takes the time of its bytes, the
+ *  data move and the completion is reported when it ends, a device may NACK
+ *  and the start of a transfer may fail.
+ *
+ *  Back-to-back reads of contiguous registers into contiguous buffers of one
+ *  device share a transfer, the others do not. Every transaction of a
+ *  failed transfer gets the error and the queue goes on with the next ones.
+ *  A transaction posted from a completion callback waits for the bus. The
+ *  CPU time blocked on the bus by the sensor reads is accounted for the
+ *  blocking accesses and for the queue.
+ *
+ *  Run by Tools/run_host_tests.sh
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "i2c_queue.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define SIM_IMU_ADDR           0xD6U
+#define SIM_MAG_ADDR           0x3CU
+#define SIM_GYRO_REG           0x22U                   /*!< OUTX_L_G, 6 bytes */
+#define SIM_ACC_REG            0x28U                   /*!< OUTX_L_A, 6 bytes */
+#define SIM_MAG_REG            0x68U                   /*!< OUTX_L_REG, 6 bytes */
+#define SIM_AXES_LEN           6U
+
+#define SIM_BYTE_US            22.5                    /*!< 9 bits at 400 kHz */
+#define SIM_START_US           5.0                     /*!< CPU time to program a DMA transfer */
+#define SIM_TICKS              1000U                   /*!< Sensor hub ticks of the workload */
+
+#define SIM_ERROR_NACK         (-102)                  /*!< As BSP_ERROR_BUS_ACKNOWLEDGE_FAILURE */
+#define SIM_ERROR_START        (-104)                  /*!< As BSP_ERROR_PERIPH_FAILURE */
+
+#define SIM_MAX_DONE           32U
+
+#define CHECK( cond )          do { if( !(cond) ) { printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond ); gFailures++; } } while(0)
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+typedef struct
+{
+    bool     busy;
+    uint16_t devAddr;
+    uint16_t reg;
+    uint8_t  dir;
+    uint8_t *pData;
+    uint16_t length;
+    double   start;                                    /*!< [us] */
+    double   end;                                      /*!< [us] */
+} simTransfer_t;
+
+typedef struct
+{
+    uint32_t id;
+    int32_t  status;
+} simDone_t;
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static uint32_t         gFailures;
+static I2C_QUEUE_t      gQueue;
+
+/* Simulated bus */
+static uint8_t          gImuRegs[0x80];
+static uint8_t          gMagRegs[0x80];
+static simTransfer_t    gXfer;
+static double           gNow;                          /*!< [us] */
+static double           gBusTime;                      /*!< Time the bus was busy [us] */
+static double           gCpuTime;                      /*!< Time the CPU spent starting transfers [us] */
+static uint32_t         gStarts;
+static uint16_t         gNackAddr;                     /*!< Device not answering */
+static uint32_t         gStartFailures;                /*!< Next starts refused */
+static bool             gInCallback;
+
+/* Completions, in order */
+static simDone_t        gDone[SIM_MAX_DONE];
+static uint32_t         gDoneCnt;
+
+/* Chain posted from the callbacks */
+static uint8_t          gChainBuf[SIM_AXES_LEN];
+static uint32_t         gChainLeft;
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+static double simDuration( uint16_t length )
+{
+    /* Address, register, repeated start and address, then the data */
+    return (3.0 + length) * SIM_BYTE_US;
+}
+
+static uint8_t *simRegs( uint16_t devAddr )
+{
+    return ((devAddr & 0xFEU) == SIM_IMU_ADDR) ? gImuRegs : gMagRegs;
+}
+
+static int32_t simStart( uint16_t DevAddr, uint16_t Reg, uint8_t Dir, uint8_t *pData, uint16_t Length )
+{
+    CHECK( !gXfer.busy );
+    CHECK( !gInCallback );
+
+    gNow     += SIM_START_US;
+    gCpuTime += SIM_START_US;
+    if( gStartFailures > 0U )
+    {
+        gStartFailures--;
+        return SIM_ERROR_START;
+    }
+
+    gStarts++;
+    gXfer.busy    = true;
+    gXfer.devAddr = DevAddr;
+    gXfer.reg     = Reg;
+    gXfer.dir     = Dir;
+    gXfer.pData   = pData;
+    gXfer.length  = Length;
+    gXfer.start   = gNow;
+    gXfer.end     = gNow + simDuration( Length );
+    return I2C_QUEUE_OK;
+}
+
+/* Completion interrupt of the transfer on the bus */
+static bool simComplete( void )
+{
+    int32_t status = I2C_QUEUE_OK;
+
+    if( !gXfer.busy )
+    {
+        return false;
+    }
+
+    gBusTime += gXfer.end - gXfer.start;
+    gNow = (gNow > gXfer.end) ? gNow : gXfer.end;
+    gXfer.busy = false;
+
+    if( (gXfer.devAddr & 0xFEU) == gNackAddr )
+    {
+        status = SIM_ERROR_NACK;
+    }
+    else if( gXfer.dir == I2C_QUEUE_READ )
+    {
+        memcpy( gXfer.pData, &simRegs( gXfer.devAddr )[gXfer.reg], gXfer.length );
+    }
+    else
+    {
+        memcpy( &simRegs( gXfer.devAddr )[gXfer.reg], gXfer.pData, gXfer.length );
+    }
+
+    I2C_QUEUE_Complete( &gQueue, status );
+    return true;
+}
+
+static void simDrain( void )
+{
+    while( simComplete() )
+    {
+    }
+    CHECK( I2C_QUEUE_IsIdle( &gQueue ) == 1U );
+}
+
+static void simReset( void )
+{
+    uint32_t i;
+
+    for( i = 0; i < sizeof(gImuRegs); i++ )
+    {
+        gImuRegs[i] = (uint8_t)(0x10U + i);
+        gMagRegs[i] = (uint8_t)(0xA0U + i);
+    }
+    memset( &gXfer, 0, sizeof(gXfer) );
+    gNow           = 0.0;
+    gBusTime       = 0.0;
+    gCpuTime       = 0.0;
+    gStarts        = 0;
+    gNackAddr      = 0;
+    gStartFailures = 0;
+    gDoneCnt       = 0;
+    I2C_QUEUE_Init( &gQueue, simStart );
+}
+
+static void doneCb( int32_t Status, void *pCtx )
+{
+    if( gDoneCnt < SIM_MAX_DONE )
+    {
+        gDone[gDoneCnt].id     = (uint32_t)(uintptr_t)pCtx;
+        gDone[gDoneCnt].status = Status;
+    }
+    gDoneCnt++;
+}
+
+static int32_t postRead( uint16_t devAddr, uint16_t reg, uint8_t *pData, uint16_t length, uint8_t flags, uint32_t id )
+{
+    I2C_QUEUE_Xfer_t xfer;
+
+    xfer.DevAddr  = devAddr;
+    xfer.Reg      = reg;
+    xfer.pData    = pData;
+    xfer.Length   = length;
+    xfer.Dir      = I2C_QUEUE_READ;
+    xfer.Flags    = flags;
+    xfer.Callback = doneCb;
+    xfer.pCtx     = (void *)(uintptr_t)id;
+
+    return I2C_QUEUE_Post( &gQueue, &xfer );
+}
+
+static bool sameRegs( const uint8_t *pData, uint16_t devAddr, uint16_t reg, uint16_t length )
+{
+    return (memcmp( pData, &simRegs( devAddr )[reg], length ) == 0);
+}
+
+/*
+******************************************************************************
+* TESTS
+******************************************************************************
+*/
+
+/* Reads queued behind a transfer: the contiguous ones of a device share the next one */
+static void testMerge( void )
+{
+    uint8_t mag[SIM_AXES_LEN];
+    uint8_t imu[2U * SIM_AXES_LEN];
+    uint8_t gap[SIM_AXES_LEN];
+    uint8_t other[SIM_AXES_LEN];
+    uint32_t i;
+
+    simReset();
+
+    /* Bus busy with the magnetometer, then gyro and acc into one buffer */
+    CHECK( postRead( SIM_MAG_ADDR, SIM_MAG_REG, mag, SIM_AXES_LEN, I2C_QUEUE_FLAG_MERGE, 1 ) == I2C_QUEUE_OK );
+    CHECK( postRead( SIM_IMU_ADDR, SIM_GYRO_REG, &imu[0], SIM_AXES_LEN, I2C_QUEUE_FLAG_MERGE, 2 ) == I2C_QUEUE_OK );
+    CHECK( postRead( SIM_IMU_ADDR, SIM_ACC_REG, &imu[SIM_AXES_LEN], SIM_AXES_LEN, I2C_QUEUE_FLAG_MERGE, 3 ) == I2C_QUEUE_OK );
+    /* Contiguous registers but not buffer, contiguous buffer but other device */
+    CHECK( postRead( SIM_IMU_ADDR, SIM_ACC_REG + SIM_AXES_LEN, gap, SIM_AXES_LEN, I2C_QUEUE_FLAG_MERGE, 4 ) == I2C_QUEUE_OK );
+    CHECK( postRead( SIM_MAG_ADDR, SIM_MAG_REG, other, SIM_AXES_LEN, I2C_QUEUE_FLAG_MERGE, 5 ) == I2C_QUEUE_OK );
+    CHECK( gStarts == 1U );
+    simDrain();
+
+    CHECK( gStarts == 4U );
+    CHECK( gQueue.Stats.Posted == 5U );
+    CHECK( gQueue.Stats.Transfers == 4U );
+    CHECK( gQueue.Stats.Merged == 1U );
+    CHECK( gDoneCnt == 5U );
+    for( i = 0; (i < gDoneCnt) && (i < SIM_MAX_DONE); i++ )
+    {
+        CHECK( gDone[i].id == (i + 1U) );
+        CHECK( gDone[i].status == I2C_QUEUE_OK );
+    }
+    CHECK( sameRegs( mag, SIM_MAG_ADDR, SIM_MAG_REG, SIM_AXES_LEN ) );
+    CHECK( sameRegs( imu, SIM_IMU_ADDR, SIM_GYRO_REG, sizeof(imu) ) );
+    CHECK( sameRegs( gap, SIM_IMU_ADDR, SIM_ACC_REG + SIM_AXES_LEN, SIM_AXES_LEN ) );
+    CHECK( sameRegs( other, SIM_MAG_ADDR, SIM_MAG_REG, SIM_AXES_LEN ) );
+
+    /* Without the flag each read keeps its own transfer */
+    simReset();
+    CHECK( postRead( SIM_MAG_ADDR, SIM_MAG_REG, mag, SIM_AXES_LEN, I2C_QUEUE_FLAG_NONE, 1 ) == I2C_QUEUE_OK );
+    CHECK( postRead( SIM_IMU_ADDR, SIM_GYRO_REG, &imu[0], SIM_AXES_LEN, I2C_QUEUE_FLAG_MERGE, 2 ) == I2C_QUEUE_OK );
+    CHECK( postRead( SIM_IMU_ADDR, SIM_ACC_REG, &imu[SIM_AXES_LEN], SIM_AXES_LEN, I2C_QUEUE_FLAG_NONE, 3 ) == I2C_QUEUE_OK );
+    simDrain();
+    CHECK( gQueue.Stats.Transfers == 3U );
+    CHECK( gQueue.Stats.Merged == 0U );
+    CHECK( sameRegs( imu, SIM_IMU_ADDR, SIM_GYRO_REG, sizeof(imu) ) );
+
+    /* A full queue refuses the transaction */
+    simReset();
+    for( i = 0; i < I2C_QUEUE_SIZE; i++ )
+    {
+        CHECK( postRead( SIM_MAG_ADDR, SIM_MAG_REG, mag, SIM_AXES_LEN, I2C_QUEUE_FLAG_NONE, i ) == I2C_QUEUE_OK );
+    }
+    CHECK( postRead( SIM_MAG_ADDR, SIM_MAG_REG, mag, SIM_AXES_LEN, I2C_QUEUE_FLAG_NONE, i ) == I2C_QUEUE_FULL );
+    simDrain();
+    CHECK( gDoneCnt == I2C_QUEUE_SIZE );
+}
+
+/* A NACK fails every transaction of the transfer, a refused start as well, the next ones go on */
+static void testErrors( void )
+{
+    uint8_t mag[SIM_AXES_LEN];
+    uint8_t imu[2U * SIM_AXES_LEN];
+
+    simReset();
+    gNackAddr = SIM_IMU_ADDR;
+    CHECK( postRead( SIM_MAG_ADDR, SIM_MAG_REG, mag, SIM_AXES_LEN, I2C_QUEUE_FLAG_MERGE, 1 ) == I2C_QUEUE_OK );
+    CHECK( postRead( SIM_IMU_ADDR, SIM_GYRO_REG, &imu[0], SIM_AXES_LEN, I2C_QUEUE_FLAG_MERGE, 2 ) == I2C_QUEUE_OK );
+    CHECK( postRead( SIM_IMU_ADDR, SIM_ACC_REG, &imu[SIM_AXES_LEN], SIM_AXES_LEN, I2C_QUEUE_FLAG_MERGE, 3 ) == I2C_QUEUE_OK );
+    CHECK( postRead( SIM_MAG_ADDR, SIM_MAG_REG, mag, SIM_AXES_LEN, I2C_QUEUE_FLAG_MERGE, 4 ) == I2C_QUEUE_OK );
+    simDrain();
+
+    CHECK( gDoneCnt == 4U );
+    CHECK( gDone[0].status == I2C_QUEUE_OK );
+    CHECK( gDone[1].status == SIM_ERROR_NACK );
+    CHECK( gDone[2].status == SIM_ERROR_NACK );
+    CHECK( gDone[3].status == I2C_QUEUE_OK );
+    CHECK( gQueue.Stats.Errors == 1U );
+    CHECK( sameRegs( mag, SIM_MAG_ADDR, SIM_MAG_REG, SIM_AXES_LEN ) );
+
+    /* The start of the second transfer is refused: failed at once, the third one runs */
+    simReset();
+    CHECK( postRead( SIM_MAG_ADDR, SIM_MAG_REG, mag, SIM_AXES_LEN, I2C_QUEUE_FLAG_NONE, 1 ) == I2C_QUEUE_OK );
+    CHECK( postRead( SIM_IMU_ADDR, SIM_GYRO_REG, &imu[0], SIM_AXES_LEN, I2C_QUEUE_FLAG_NONE, 2 ) == I2C_QUEUE_OK );
+    CHECK( postRead( SIM_IMU_ADDR, SIM_ACC_REG, &imu[SIM_AXES_LEN], SIM_AXES_LEN, I2C_QUEUE_FLAG_NONE, 3 ) == I2C_QUEUE_OK );
+    gStartFailures = 1;
+    simDrain();
+
+    CHECK( gDoneCnt == 3U );
+    CHECK( gDone[0].status == I2C_QUEUE_OK );
+    CHECK( (gDone[1].id == 2U) && (gDone[1].status == SIM_ERROR_START) );
+    CHECK( (gDone[2].id == 3U) && (gDone[2].status == I2C_QUEUE_OK) );
+    CHECK( gQueue.Stats.Errors == 1U );
+    CHECK( sameRegs( &imu[SIM_AXES_LEN], SIM_IMU_ADDR, SIM_ACC_REG, SIM_AXES_LEN ) );
+
+    /* Refused when the bus is idle: failed within the post */
+    simReset();
+    gStartFailures = 1;
+    CHECK( postRead( SIM_MAG_ADDR, SIM_MAG_REG, mag, SIM_AXES_LEN, I2C_QUEUE_FLAG_NONE, 1 ) == I2C_QUEUE_OK );
+    CHECK( (gDoneCnt == 1U) && (gDone[0].status == SIM_ERROR_START) );
+    CHECK( I2C_QUEUE_IsIdle( &gQueue ) == 1U );
+}
+
+static void chainCb( int32_t Status, void *pCtx );
+
+static int32_t postChain( uint32_t id )
+{
+    I2C_QUEUE_Xfer_t xfer;
+
+    xfer.DevAddr  = SIM_IMU_ADDR;
+    xfer.Reg      = SIM_ACC_REG;
+    xfer.pData    = gChainBuf;
+    xfer.Length   = SIM_AXES_LEN;
+    xfer.Dir      = I2C_QUEUE_READ;
+    xfer.Flags    = I2C_QUEUE_FLAG_MERGE;
+    xfer.Callback = chainCb;
+    xfer.pCtx     = (void *)(uintptr_t)id;
+    return I2C_QUEUE_Post( &gQueue, &xfer );
+}
+
+static void chainCb( int32_t Status, void *pCtx )
+{
+    doneCb( Status, pCtx );
+
+    /* The transfer is still in flight: only queued, started once the callbacks return */
+    if( gChainLeft > 0U )
+    {
+        gChainLeft--;
+        gInCallback = true;
+        CHECK( postChain( (uint32_t)(uintptr_t)pCtx + 1U ) == I2C_QUEUE_OK );
+        gInCallback = false;
+        CHECK( I2C_QUEUE_IsIdle( &gQueue ) == 0U );
+    }
+}
+
+/* Each completion posts the next read */
+static void testPostFromCallback( void )
+{
+    uint32_t i;
+
+    simReset();
+    gChainLeft = 5;
+    CHECK( postChain( 1 ) == I2C_QUEUE_OK );
+    simDrain();
+
+    CHECK( gDoneCnt == 6U );
+    CHECK( gStarts == 6U );
+    for( i = 0; (i < gDoneCnt) && (i < SIM_MAX_DONE); i++ )
+    {
+        CHECK( (gDone[i].id == (i + 1U)) && (gDone[i].status == I2C_QUEUE_OK) );
+    }
+    CHECK( sameRegs( gChainBuf, SIM_IMU_ADDR, SIM_ACC_REG, SIM_AXES_LEN ) );
+}
+
+/* CPU time blocked on the bus by the sensor hub reads, blocking then queued */
+static void testBlockedTime( void )
+{
+    uint8_t  imu[2U * SIM_AXES_LEN];
+    uint8_t  mag[SIM_AXES_LEN];
+    double   blocking;
+    double   posting = 0.0;
+    double   posted;
+    uint32_t t;
+
+    /* Blocking accesses: the caller programs each of the three reads and waits for its end */
+    blocking = SIM_TICKS * 3.0 * (SIM_START_US + simDuration( SIM_AXES_LEN ));
+
+    /* Queue: the caller only posts, the next transfers are started by the completion interrupt */
+    simReset();
+    for( t = 0; t < SIM_TICKS; t++ )
+    {
+        posted = gNow;
+        CHECK( postRead( SIM_MAG_ADDR, SIM_MAG_REG, mag, SIM_AXES_LEN, I2C_QUEUE_FLAG_MERGE, 1 ) == I2C_QUEUE_OK );
+        CHECK( postRead( SIM_IMU_ADDR, SIM_GYRO_REG, &imu[0], SIM_AXES_LEN, I2C_QUEUE_FLAG_MERGE, 2 ) == I2C_QUEUE_OK );
+        CHECK( postRead( SIM_IMU_ADDR, SIM_ACC_REG, &imu[SIM_AXES_LEN], SIM_AXES_LEN, I2C_QUEUE_FLAG_MERGE, 3 ) == I2C_QUEUE_OK );
+        posting += gNow - posted;
+        simDrain();
+    }
+
+    printf( "  CPU on I2C over %u ticks: %.1f ms blocking, %.1f ms queued (%.1f ms in the posts), bus busy %.1f ms\n",
+            SIM_TICKS, blocking / 1000.0, gCpuTime / 1000.0, posting / 1000.0, gBusTime / 1000.0 );
+    CHECK( gQueue.Stats.Transfers == 2U * SIM_TICKS );
+    CHECK( gQueue.Stats.Merged == SIM_TICKS );
+    CHECK( posting == (SIM_TICKS * SIM_START_US) );
+    CHECK( gCpuTime == (gQueue.Stats.Transfers * SIM_START_US) );
+    CHECK( gCpuTime < (blocking / 20.0) );
+    /* The merge saves the address and register phases of one read per tick */
+    CHECK( gBusTime == (SIM_TICKS * (simDuration( SIM_AXES_LEN ) + simDuration( 2U * SIM_AXES_LEN ))) );
+}
+
+/*
+******************************************************************************
+* MAIN
+******************************************************************************
+*/
+int main( void )
+{
+    testMerge();
+    testErrors();
+    testPostFromCallback();
+    testBlockedTime();
+
+    printf( "%s\n", (gFailures == 0U) ? "PASS" : "FAIL" );
+    return (gFailures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,614 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \brief Host test of the flash key-value store
+ *
+ *  kv_store.c runs through hw_flash.c on a flash simulated at the HAL:
+ *  4 kB pages, double words programmed once between two erases, the
+ *  semaphore, the unlock and the erase activity checked on each operation,
+ *  the CPU2 holding the semaphore or the suspend for a while.
+ *
+ *  A power cut is injected at every flash operation of random write
+ *  sequences in turn: the cut program leaves random bits, the cut erase
+ *  leaves a mix of erased, old and random double words, and the recovery
+ *  is sometimes cut as well. After the reset every key holds its last
+ *  value, or the new one for the key being written, and the store keeps
+ *  taking writes. A flash error is reported and the store recovers at the
+ *  next init. The wear of the pages and the init time are printed for
+ *  information.
+ *
+ *  Run by Tools/run_host_tests.sh
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+#include "../Src/hw_flash.c"
+#include "../Src/kv_store.c"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define SIM_PAGES_MAX          8U
+#define SIM_WRITES_MAX         200U
+#define SIM_SEEDS              2U
+#define SIM_AFTER_CUT          100U                    /*!< Writes after each reset         */
+#define SIM_CPU2_POLLS         3U                      /*!< Polls the CPU2 keeps the flash  */
+
+#define CHECK( cond )          do { if( !(cond) ) { printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond ); gFailures++; } } while(0)
+
+/*
+******************************************************************************
+* GLOBAL VARIABLES
+******************************************************************************
+*/
+uint8_t                 hostFlash[SIM_PAGES_MAX * FLASH_PAGE_SIZE] __attribute__((aligned(8)));
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static uint32_t         gFailures;
+static const KV_STORE_Flash_t gFlash = { HW_FLASH_Erase, HW_FLASH_Program };
+
+/* Flash */
+static uint32_t         gPages;
+static uint32_t         gErases[SIM_PAGES_MAX];
+static uint32_t         gPrograms;
+static long             gOps;
+static long             gCutAt;                        /*!< Power cut on this operation     */
+static long             gFailAt;                       /*!< Flash error on this operation   */
+static jmp_buf          gReset;
+static bool             gUnlocked;
+static bool             gSemTaken;
+static bool             gEraseActivity;
+static uint32_t         gCpu2Sem;                      /*!< Polls the CPU2 still holds the semaphore */
+static uint32_t         gCpu2Suspend;                  /*!< Polls the CPU2 still suspends the operation */
+static uint32_t         gRng = 1;
+
+/* Values expected */
+static uint8_t          gModel[KV_STORE_KEY_NBR][KV_STORE_MAX_LENGTH];
+static uint16_t         gModelLen[KV_STORE_KEY_NBR];
+static bool             gModelSet[KV_STORE_KEY_NBR];
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+static uint32_t simRand( void )
+{
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 17;
+    gRng ^= gRng << 5;
+    return gRng;
+}
+
+static uint64_t simRand64( void )
+{
+    return ((uint64_t)simRand() << 32) | simRand();
+}
+
+/* Offset in hostFlash[] of an address truncated to 32 bits by the HAL */
+static uint32_t simOffset( uint32_t address )
+{
+    return address - (uint32_t)FLASH_BASE;
+}
+
+static void simFresh( uint32_t pages )
+{
+    gPages = pages;
+    memset( hostFlash, 0xFF, sizeof(hostFlash) );
+    memset( gErases, 0x00, sizeof(gErases) );
+    gPrograms = 0;
+    gOps      = 0;
+    gCutAt    = -1;
+    gFailAt   = -1;
+}
+
+/* The CPU1 restarts: the flash interface is locked and the semaphore free */
+static void simPowerOn( void )
+{
+    gUnlocked      = false;
+    gSemTaken      = false;
+    gEraseActivity = false;
+}
+
+/* The CPU2 uses the flash before the next operation */
+static void simCpu2Busy( void )
+{
+    gCpu2Sem     = SIM_CPU2_POLLS;
+    gCpu2Suspend = SIM_CPU2_POLLS;
+}
+
+static bool simMatches( const KV_STORE_t *store, uint16_t key, const uint8_t *value, uint16_t len, bool set )
+{
+    uint8_t  buf[KV_STORE_MAX_LENGTH];
+    uint16_t got;
+    int32_t  ret;
+
+    ret = KV_STORE_Read( store, key, buf, sizeof(buf), &got );
+    if( !set )
+    {
+        return (ret == KV_STORE_NOT_FOUND);
+    }
+    return (ret == KV_STORE_OK) && (got == len) && (memcmp( buf, value, len ) == 0);
+}
+
+static void simValue( uint8_t *value, uint16_t *len, uint16_t maxLen )
+{
+    uint16_t i;
+
+    *len = (uint16_t)(simRand() % (maxLen + 1U));
+    for( i = 0; i < *len; i++ )
+    {
+        value[i] = (uint8_t)simRand();
+    }
+}
+
+static void simModel( uint16_t key, const uint8_t *value, uint16_t len )
+{
+    memcpy( gModel[key], value, len );
+    gModelLen[key] = len;
+    gModelSet[key] = true;
+}
+
+static bool simModelMatches( const KV_STORE_t *store )
+{
+    uint16_t key;
+
+    for( key = 0; key < KV_STORE_KEY_NBR; key++ )
+    {
+        if( !simMatches( store, key, gModel[key], gModelLen[key], gModelSet[key] ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void testBasic( void )
+{
+    KV_STORE_t store;
+    uint8_t    value[64];
+    uint8_t    buf[64];
+    uint16_t   len;
+    uint16_t   i;
+
+    simFresh( 2 );
+    simPowerOn();
+    CHECK( KV_STORE_Init( &store, &gFlash, FLASH_BASE, 2 ) == KV_STORE_OK );
+    CHECK( KV_STORE_Read( &store, 0, buf, sizeof(buf), &len ) == KV_STORE_NOT_FOUND );
+    for( i = 0; i < sizeof(value); i++ )
+    {
+        value[i] = (uint8_t)i;
+    }
+
+    simCpu2Busy();
+    CHECK( KV_STORE_Write( &store, 0, value, sizeof(value) ) == KV_STORE_OK );
+    CHECK( KV_STORE_Write( &store, 0, value, sizeof(value) ) == KV_STORE_OK );
+    CHECK( (store.Stats.Unchanged == 1U) && (store.Stats.Writes == 1U) );
+    CHECK( KV_STORE_Write( &store, KV_STORE_KEY_NBR, value, 4 ) == KV_STORE_ERROR );
+    CHECK( KV_STORE_Write( &store, 1, value, KV_STORE_MAX_LENGTH + 1U ) == KV_STORE_ERROR );
+
+    CHECK( KV_STORE_Init( &store, &gFlash, FLASH_BASE, 2 ) == KV_STORE_OK );
+    CHECK( (KV_STORE_Read( &store, 0, buf, sizeof(buf), &len ) == KV_STORE_OK) && (len == sizeof(value)) );
+    CHECK( memcmp( buf, value, sizeof(value) ) == 0 );
+    CHECK( (KV_STORE_Read( &store, 0, buf, 10, &len ) == KV_STORE_OK) && (len == sizeof(value)) );
+    CHECK( KV_STORE_Init( &store, &gFlash, FLASH_BASE, 1 ) == KV_STORE_ERROR );
+    CHECK( !gUnlocked && !gSemTaken && !gEraseActivity );
+}
+
+/* A flash error fails the write, the next init finds the previous value */
+static void testFlashError( void )
+{
+    KV_STORE_t store;
+    uint8_t    value[40];
+    uint8_t    other[40];
+    long       op;
+
+    for( op = 1; op <= 6; op++ )
+    {
+        simFresh( 2 );
+        simPowerOn();
+        memset( gModelSet, 0x00, sizeof(gModelSet) );
+        memset( value, 0x5A, sizeof(value) );
+        memset( other, 0xA5, sizeof(other) );
+
+        CHECK( KV_STORE_Init( &store, &gFlash, FLASH_BASE, 2 ) == KV_STORE_OK );
+        CHECK( KV_STORE_Write( &store, 1, value, sizeof(value) ) == KV_STORE_OK );
+        simModel( 1, value, sizeof(value) );
+
+        gFailAt = gOps + op;
+        CHECK( KV_STORE_Write( &store, 1, other, sizeof(other) ) == KV_STORE_ERROR );
+        CHECK( !gUnlocked && !gSemTaken );
+
+        CHECK( KV_STORE_Init( &store, &gFlash, FLASH_BASE, 2 ) == KV_STORE_OK );
+        CHECK( simModelMatches( &store ) );
+        CHECK( KV_STORE_Write( &store, 1, other, sizeof(other) ) == KV_STORE_OK );
+        simModel( 1, other, sizeof(other) );
+        CHECK( KV_STORE_Init( &store, &gFlash, FLASH_BASE, 2 ) == KV_STORE_OK );
+        CHECK( simModelMatches( &store ) );
+    }
+}
+
+/* The calibration saved n times, the other keys written once */
+static void testWear( uint32_t pages, uint16_t len, uint32_t saves )
+{
+    KV_STORE_t store;
+    uint8_t    value[KV_STORE_MAX_LENGTH];
+    uint8_t    other[32];
+    uint32_t   min = UINT32_MAX;
+    uint32_t   max = 0;
+    uint32_t   total = 0;
+    uint32_t   i;
+    uint16_t   key;
+
+    simFresh( pages );
+    simPowerOn();
+    CHECK( KV_STORE_Init( &store, &gFlash, FLASH_BASE, pages ) == KV_STORE_OK );
+    for( key = 1; key < KV_STORE_KEY_NBR; key++ )
+    {
+        memset( other, key, sizeof(other) );
+        CHECK( KV_STORE_Write( &store, key, other, sizeof(other) ) == KV_STORE_OK );
+    }
+    for( i = 0; i < saves; i++ )
+    {
+        simValue( value, &len, len );
+        len = (len == 0U) ? 1U : len;
+        CHECK( KV_STORE_Write( &store, 0, value, len ) == KV_STORE_OK );
+    }
+    for( i = 0; i < pages; i++ )
+    {
+        total += gErases[i];
+        min    = (gErases[i] < min) ? gErases[i] : min;
+        max    = (gErases[i] > max) ? gErases[i] : max;
+    }
+
+    printf( "  wear %lu pages, %lu saves: %lu erases, per page %lu to %lu, %lu copies\n",
+            (unsigned long)pages, (unsigned long)saves, (unsigned long)total, (unsigned long)min,
+            (unsigned long)max, (unsigned long)store.Stats.Copies );
+
+    CHECK( (max - min) <= 1U );
+    CHECK( KV_STORE_Init( &store, &gFlash, FLASH_BASE, pages ) == KV_STORE_OK );
+    CHECK( simMatches( &store, 0, value, len, true ) );
+    for( key = 1; key < KV_STORE_KEY_NBR; key++ )
+    {
+        memset( other, key, sizeof(other) );
+        CHECK( simMatches( &store, key, other, sizeof(other), true ) );
+    }
+}
+
+/* Init of full pages, the best of 100 */
+static void testBoot( uint32_t pages )
+{
+    KV_STORE_t      store;
+    uint8_t         value[64];
+    uint16_t        len;
+    struct timespec t0;
+    struct timespec t1;
+    double          best = 1e12;
+    double          ns;
+    uint32_t        i;
+
+    simFresh( pages );
+    simPowerOn();
+    CHECK( KV_STORE_Init( &store, &gFlash, FLASH_BASE, pages ) == KV_STORE_OK );
+    for( i = 0; (i < 200U) || ((store.WritePos + 144U) <= KV_STORE_PAGE_SIZE); i++ )
+    {
+        simValue( value, &len, sizeof(value) );
+        CHECK( KV_STORE_Write( &store, (uint16_t)(i % KV_STORE_KEY_NBR), value, len ) == KV_STORE_OK );
+    }
+
+    for( i = 0; i < 100U; i++ )
+    {
+        clock_gettime( CLOCK_MONOTONIC, &t0 );
+        CHECK( KV_STORE_Init( &store, &gFlash, FLASH_BASE, pages ) == KV_STORE_OK );
+        clock_gettime( CLOCK_MONOTONIC, &t1 );
+        ns   = ((double)(t1.tv_sec - t0.tv_sec) * 1e9) + (double)(t1.tv_nsec - t0.tv_nsec);
+        best = (ns < best) ? ns : best;
+    }
+    printf( "  init of %lu full pages: %.1f us (host)\n", (unsigned long)pages, best / 1000.0 );
+}
+
+/* A random write sequence cut at every flash operation in turn */
+static void testPowerCuts( uint32_t pages, uint32_t writes, uint32_t seed, uint16_t maxLen )
+{
+    static uint8_t  values[SIM_WRITES_MAX][KV_STORE_MAX_LENGTH];
+    static uint16_t lens[SIM_WRITES_MAX];
+    static uint16_t keys[SIM_WRITES_MAX];
+    KV_STORE_t      store;
+    uint8_t         value[KV_STORE_MAX_LENGTH];
+    uint16_t        len;
+    uint16_t        key;
+    long            ops;
+    long            cut;
+    long            cuts = 0;
+    volatile uint32_t i;
+    uint32_t        cutWrite;
+    uint32_t        j;
+    bool            isOld;
+    bool            isNew;
+
+    gRng = seed;
+    for( j = 0; j < writes; j++ )
+    {
+        keys[j] = (uint16_t)(simRand() % KV_STORE_KEY_NBR);
+        simValue( values[j], &lens[j], maxLen );
+    }
+
+    /* Operations of the whole sequence */
+    simFresh( pages );
+    simPowerOn();
+    CHECK( KV_STORE_Init( &store, &gFlash, FLASH_BASE, pages ) == KV_STORE_OK );
+    for( j = 0; j < writes; j++ )
+    {
+        CHECK( KV_STORE_Write( &store, keys[j], values[j], lens[j] ) == KV_STORE_OK );
+    }
+    ops = gOps;
+
+    for( cut = 1; cut <= ops; cut++ )
+    {
+        simFresh( pages );
+        simPowerOn();
+        memset( gModelSet, 0x00, sizeof(gModelSet) );
+        gCutAt = cut;
+        gRng   = (seed * 7919U) + (uint32_t)cut;
+        i      = 0;
+
+        if( setjmp( gReset ) == 0 )
+        {
+            CHECK( KV_STORE_Init( &store, &gFlash, FLASH_BASE, pages ) == KV_STORE_OK );
+            for( i = 0; i < writes; i++ )
+            {
+                CHECK( KV_STORE_Write( &store, keys[i], values[i], lens[i] ) == KV_STORE_OK );
+                simModel( keys[i], values[i], lens[i] );
+            }
+            continue;
+        }
+
+        /* Reset during the write i, the recovery is cut once in four */
+        cutWrite = i;
+        simPowerOn();
+        gCutAt = ((simRand() % 4U) == 0U) ? (gOps + 1 + (long)(simRand() % 20U)) : -1;
+        if( setjmp( gReset ) != 0 )
+        {
+            simPowerOn();
+            gCutAt = -1;
+        }
+        CHECK( KV_STORE_Init( &store, &gFlash, FLASH_BASE, pages ) == KV_STORE_OK );
+        gCutAt = -1;
+
+        for( key = 0; key < KV_STORE_KEY_NBR; key++ )
+        {
+            if( (cutWrite < writes) && (key == keys[cutWrite]) )
+            {
+                isOld = simMatches( &store, key, gModel[key], gModelLen[key], gModelSet[key] );
+                isNew = simMatches( &store, key, values[cutWrite], lens[cutWrite], true );
+                if( !isOld && !isNew )
+                {
+                    printf( "FAIL cut %ld of %lu pages, seed %lu: key %u lost\n", cut, (unsigned long)pages, (unsigned long)seed, key );
+                    gFailures++;
+                    return;
+                }
+                if( isNew )
+                {
+                    simModel( key, values[cutWrite], lens[cutWrite] );
+                }
+            }
+            else if( !simMatches( &store, key, gModel[key], gModelLen[key], gModelSet[key] ) )
+            {
+                printf( "FAIL cut %ld of %lu pages, seed %lu: key %u wrong\n", cut, (unsigned long)pages, (unsigned long)seed, key );
+                gFailures++;
+                return;
+            }
+        }
+
+        /* The store still takes writes */
+        for( j = 0; j < SIM_AFTER_CUT; j++ )
+        {
+            key = (uint16_t)(simRand() % KV_STORE_KEY_NBR);
+            simValue( value, &len, maxLen );
+            CHECK( KV_STORE_Write( &store, key, value, len ) == KV_STORE_OK );
+            simModel( key, value, len );
+        }
+        CHECK( KV_STORE_Init( &store, &gFlash, FLASH_BASE, pages ) == KV_STORE_OK );
+        CHECK( simModelMatches( &store ) );
+        cuts++;
+    }
+
+    printf( "  %lu pages, seed %lu: %ld power cuts\n", (unsigned long)pages, (unsigned long)seed, cuts );
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+HAL_StatusTypeDef HAL_FLASH_Unlock( void )
+{
+    gUnlocked = true;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock( void )
+{
+    gUnlocked = false;
+    return HAL_OK;
+}
+
+uint32_t LL_HSEM_1StepLock( HSEM_TypeDef *HSEMx, uint32_t Semaphore )
+{
+    (void)HSEMx;
+    CHECK( Semaphore == CFG_HW_FLASH_SEMID );
+    if( gCpu2Sem != 0U )
+    {
+        gCpu2Sem--;
+        return 1U;
+    }
+    CHECK( !gSemTaken );
+    gSemTaken = true;
+    return 0U;
+}
+
+void LL_HSEM_ReleaseLock( HSEM_TypeDef *HSEMx, uint32_t Semaphore, uint32_t process )
+{
+    (void)HSEMx;
+    (void)process;
+    CHECK( (Semaphore == CFG_HW_FLASH_SEMID) && gSemTaken );
+    gSemTaken = false;
+}
+
+SHCI_CmdStatus_t SHCI_C2_FLASH_EraseActivity( SHCI_EraseActivity_t erase_activity )
+{
+    CHECK( gSemTaken );
+    gEraseActivity = (erase_activity == ERASE_ACTIVITY_ON);
+    return SHCI_Success;
+}
+
+uint32_t HAL_FLASHEx_IsOperationSuspended( void )
+{
+    if( gCpu2Suspend != 0U )
+    {
+        gCpu2Suspend--;
+        return 1U;
+    }
+    return 0U;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase( FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError )
+{
+    uint32_t offset = pEraseInit->Page * FLASH_PAGE_SIZE;
+    uint32_t i;
+    uint32_t b;
+
+    *PageError = 0xFFFFFFFFU;
+    CHECK( gSemTaken && gUnlocked && gEraseActivity && (gCpu2Suspend == 0U) );
+    CHECK( (pEraseInit->TypeErase == FLASH_TYPEERASE_PAGES) && (pEraseInit->NbPages == 1U) );
+    CHECK( pEraseInit->Page < gPages );
+    if( pEraseInit->Page >= gPages )
+    {
+        return HAL_ERROR;
+    }
+
+    gOps++;
+    if( gOps == gFailAt )
+    {
+        *PageError = pEraseInit->Page;
+        return HAL_ERROR;
+    }
+    if( gOps == gCutAt )
+    {
+        /* Cut erase: double words erased, left or garbled */
+        for( i = 0; i < FLASH_PAGE_SIZE; i += 8U )
+        {
+            switch( simRand() % 3U )
+            {
+                case 0:
+                    memset( &hostFlash[offset + i], 0xFF, 8 );
+                    break;
+                case 1:
+                    for( b = 0; b < 8U; b++ )
+                    {
+                        hostFlash[offset + i + b] |= (uint8_t)simRand();
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+        longjmp( gReset, 1 );
+    }
+
+    memset( &hostFlash[offset], 0xFF, FLASH_PAGE_SIZE );
+    gErases[pEraseInit->Page]++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program( uint32_t TypeProgram, uint32_t Address, uint64_t Data )
+{
+    uint32_t offset = simOffset( Address );
+    uint64_t current;
+
+    CHECK( gSemTaken && gUnlocked && !gEraseActivity && (gCpu2Suspend == 0U) );
+    CHECK( TypeProgram == FLASH_TYPEPROGRAM_DOUBLEWORD );
+    CHECK( ((offset % 8U) == 0U) && (offset < (gPages * FLASH_PAGE_SIZE)) );
+    if( ((offset % 8U) != 0U) || (offset >= (gPages * FLASH_PAGE_SIZE)) )
+    {
+        return HAL_ERROR;
+    }
+
+    /* Programmed once between two erases */
+    memcpy( &current, &hostFlash[offset], sizeof(current) );
+    CHECK( current == UINT64_MAX );
+
+    gOps++;
+    if( gOps == gFailAt )
+    {
+        return HAL_ERROR;
+    }
+    if( gOps == gCutAt )
+    {
+        /* Cut program: some bits cleared */
+        current = ((simRand() & 1U) != 0U) ? (Data | simRand64()) : simRand64();
+        memcpy( &hostFlash[offset], &current, sizeof(current) );
+        longjmp( gReset, 1 );
+    }
+
+    memcpy( &hostFlash[offset], &Data, sizeof(Data) );
+    gPrograms++;
+    return HAL_OK;
+}
+
+int main( void )
+{
+    uint32_t seed;
+
+    testBasic();
+    testFlashError();
+    testWear( 2, 72, 100000 );
+    testWear( 4, 72, 100000 );
+    testBoot( 2 );
+    testBoot( 4 );
+    for( seed = 1; seed <= SIM_SEEDS; seed++ )
+    {
+        testPowerCuts( 2, 150, seed, KV_STORE_MAX_LENGTH );
+        testPowerCuts( 3, 150, seed, 80 );
+        testPowerCuts( 4, 200, seed, 40 );
+    }
+
+    printf( "%s\n", (gFailures == 0U) ? "PASS" : "FAIL" );
+    return (gFailures == 0U) ? 0 : 1;
+}
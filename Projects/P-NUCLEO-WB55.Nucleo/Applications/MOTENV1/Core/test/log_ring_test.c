@@ -0,0 +1,311 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \brief Host test of the lock-free log ring
+ *
+ *  Checks the parameters, the pad record at the end of the ring and the
+ *  record too long for the consumer. Then 4 producer threads, which also
+ *  drain the ring as logUsartTx() does, and a consumer thread put numbered
+ *  records through a 1 kB ring under both drop policies: no record may be
+ *  corrupt or out of order, and every record is delivered or counted as
+ *  dropped. The exclusive access instructions are emulated in Tools/host.
+ *
+ *  Run by Tools/run_host_tests.sh
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <pthread.h>
+#include <stdlib.h>
+#include "platform.h"
+#include "../Src/log_ring.c"
+#include "utils.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define STRESS_PRODUCERS       4U
+#define STRESS_RECORDS         200000U                 /*!< Records per producer            */
+#define STRESS_RING_SIZE       1024U
+#define STRESS_RECORD_HEADER   6U                      /*!< Length, producer, sequence      */
+#define STRESS_RECORD_MAX      106U
+
+#define CHECK( cond )          do { if( !(cond) ) { printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond ); gFailures++; } } while(0)
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static uint32_t        gFailures;
+static logRing         gRing;
+static uint64_t        gRingBuf[STRESS_RING_SIZE / sizeof(uint64_t)];
+
+static uint8_t*        gStream;          /*!< Records delivered, in order    */
+static size_t          gStreamLen;
+static uint32_t        gPutErrors[STRESS_PRODUCERS];
+static volatile bool   gDone;
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+static uint8_t simPattern( uint32_t producer, uint32_t seq, uint32_t i )
+{
+    return (uint8_t)((producer * 31U) + (seq * 7U) + (i * 13U));
+}
+
+/* Consume as long as records are committed, as logUsartDrain() */
+static void simDrain( void )
+{
+    uint8_t  dst[256];
+    uint16_t n;
+
+    while( logRingAcquire( &gRing ) )
+    {
+        while( (n = logRingGet( &gRing, dst, sizeof(dst) )) != 0U )
+        {
+            ST_MEMCPY( &gStream[gStreamLen], dst, n );
+            gStreamLen += n;
+        }
+        if( !logRingRelease( &gRing ) )
+        {
+            break;
+        }
+    }
+}
+
+static void* simProducer( void* arg )
+{
+    uint32_t producer = (uint32_t)(uintptr_t)arg;
+    uint32_t seed     = 1234U + producer;
+    uint8_t  rec[STRESS_RECORD_MAX];
+    uint32_t seq;
+    uint32_t len;
+    uint32_t i;
+
+    for( seq = 0; seq < STRESS_RECORDS; seq++ )
+    {
+        len    = STRESS_RECORD_HEADER + ((uint32_t)rand_r( &seed ) % (STRESS_RECORD_MAX - STRESS_RECORD_HEADER));
+        rec[0] = (uint8_t)len;
+        rec[1] = (uint8_t)producer;
+        ST_MEMCPY( &rec[2], &seq, sizeof(seq) );
+        for( i = STRESS_RECORD_HEADER; i < len; i++ )
+        {
+            rec[i] = simPattern( producer, seq, i );
+        }
+
+        if( logRingPut( &gRing, rec, (uint16_t)len ) != ERR_NONE )
+        {
+            gPutErrors[producer]++;
+        }
+        if( (seq & 3U) == 0U )
+        {
+            simDrain();
+        }
+    }
+    return NULL;
+}
+
+static void* simConsumer( void* arg )
+{
+    (void)arg;
+    while( !gDone )
+    {
+        simDrain();
+    }
+    return NULL;
+}
+
+static void testParameters( void )
+{
+    static uint64_t buf[64];
+
+    CHECK( logRingIni( &gRing, (uint8_t*)buf, 48U, LOG_RING_DROP_NEWEST ) == ERR_PARAM );
+    CHECK( logRingIni( &gRing, (uint8_t*)buf, 384U, LOG_RING_DROP_NEWEST ) == ERR_PARAM );
+    CHECK( logRingIni( &gRing, &((uint8_t*)buf)[4], 256U, LOG_RING_DROP_NEWEST ) == ERR_PARAM );
+    CHECK( logRingIni( &gRing, (uint8_t*)buf, 256U, LOG_RING_DROP_NEWEST ) == ERR_NONE );
+    CHECK( logRingMaxLen( &gRing ) == (128U - LOG_RING_HEADER_LEN) );
+    CHECK( logRingPut( &gRing, (const uint8_t*)buf, (uint16_t)(logRingMaxLen( &gRing ) + 1U) ) == ERR_PARAM );
+}
+
+/* Records around the end of the ring come out whole and in order */
+static void testWrap( void )
+{
+    static uint64_t buf[32];
+    uint8_t  rec[40];
+    uint8_t  dst[64];
+    uint32_t i;
+    uint16_t n;
+
+    CHECK( logRingIni( &gRing, (uint8_t*)buf, sizeof(buf), LOG_RING_DROP_NEWEST ) == ERR_NONE );
+    CHECK( logRingAcquire( &gRing ) );
+    CHECK( !logRingAcquire( &gRing ) );
+
+    for( i = 0; i < 100U; i++ )
+    {
+        ST_MEMSET( rec, (int)i, sizeof(rec) );
+        CHECK( logRingPut( &gRing, rec, (uint16_t)(20U + (i % 20U)) ) == ERR_NONE );
+        n = logRingGet( &gRing, dst, sizeof(dst) );
+        CHECK( n == (20U + (i % 20U)) );
+        CHECK( (dst[0] == (uint8_t)i) && (dst[n - 1U] == (uint8_t)i) );
+    }
+    CHECK( !logRingRelease( &gRing ) );
+    CHECK( gRing.stats.taken == 100U );
+}
+
+/* A record longer than the consumer buffer is dropped, the next ones go through */
+static void testTooLong( void )
+{
+    static uint64_t buf[32];
+    uint8_t  rec[100];
+    uint8_t  dst[64];
+    uint16_t n;
+
+    CHECK( logRingIni( &gRing, (uint8_t*)buf, sizeof(buf), LOG_RING_DROP_NEWEST ) == ERR_NONE );
+    ST_MEMSET( rec, 0x11, sizeof(rec) );
+    CHECK( logRingPut( &gRing, rec, 100U ) == ERR_NONE );
+    ST_MEMSET( rec, 0x22, sizeof(rec) );
+    CHECK( logRingPut( &gRing, rec, 20U ) == ERR_NONE );
+
+    CHECK( logRingAcquire( &gRing ) );
+    n = logRingGet( &gRing, dst, sizeof(dst) );
+    CHECK( (n == 20U) && (dst[0] == 0x22U) );
+    CHECK( logRingGet( &gRing, dst, sizeof(dst) ) == 0U );
+    CHECK( !logRingRelease( &gRing ) );
+
+    CHECK( gRing.stats.droppedLong == 1U );
+    CHECK( gRing.stats.taken == 1U );
+
+    /* The space is free again */
+    CHECK( logRingPut( &gRing, rec, 100U ) == ERR_NONE );
+    CHECK( logRingPut( &gRing, rec, 100U ) == ERR_NONE );
+}
+
+static void testStress( uint8_t policy )
+{
+    pthread_t producers[STRESS_PRODUCERS];
+    pthread_t consumer;
+    int64_t   last[STRESS_PRODUCERS];
+    uint32_t  total = STRESS_PRODUCERS * STRESS_RECORDS;
+    uint32_t  putErrors = 0;
+    uint32_t  got   = 0;
+    uint32_t  bad   = 0;
+    uint32_t  order = 0;
+    uint32_t  p;
+    uint32_t  seq;
+    uint32_t  len;
+    uint32_t  k;
+    size_t    i = 0;
+
+    ST_MEMSET( gPutErrors, 0x00, sizeof(gPutErrors) );
+    gStreamLen = 0;
+    gDone      = false;
+    CHECK( logRingIni( &gRing, (uint8_t*)gRingBuf, sizeof(gRingBuf), policy ) == ERR_NONE );
+
+    pthread_create( &consumer, NULL, simConsumer, NULL );
+    for( p = 0; p < STRESS_PRODUCERS; p++ )
+    {
+        pthread_create( &producers[p], NULL, simProducer, (void*)(uintptr_t)p );
+    }
+    for( p = 0; p < STRESS_PRODUCERS; p++ )
+    {
+        pthread_join( producers[p], NULL );
+        putErrors += gPutErrors[p];
+        last[p]    = -1;
+    }
+    gDone = true;
+    pthread_join( consumer, NULL );
+    simDrain();
+
+    /* Parse the records delivered */
+    while( i < gStreamLen )
+    {
+        len = gStream[i];
+        p   = gStream[i + 1U];
+        ST_MEMCPY( &seq, &gStream[i + 2U], sizeof(seq) );
+        if( (len < STRESS_RECORD_HEADER) || (p >= STRESS_PRODUCERS) || ((i + len) > gStreamLen) )
+        {
+            bad++;
+            break;
+        }
+        for( k = STRESS_RECORD_HEADER; k < len; k++ )
+        {
+            if( gStream[i + k] != simPattern( p, seq, k ) )
+            {
+                bad++;
+                break;
+            }
+        }
+        order  += ((int64_t)seq <= last[p]) ? 1U : 0U;
+        last[p] = seq;
+        got++;
+        i += len;
+    }
+
+    printf( "  %s: %lu records from %u threads, delivered %lu, dropped newest %lu, oldest %lu\n",
+            (policy == LOG_RING_DROP_NEWEST) ? "drop newest" : "drop oldest", (unsigned long)total, STRESS_PRODUCERS,
+            (unsigned long)got, (unsigned long)gRing.stats.droppedNewest, (unsigned long)gRing.stats.droppedOldest );
+
+    CHECK( bad == 0U );
+    CHECK( order == 0U );
+    CHECK( (got + gRing.stats.droppedNewest + gRing.stats.droppedOldest) == total );
+    CHECK( putErrors == gRing.stats.droppedNewest );
+    CHECK( gRing.stats.records == (total - putErrors) );
+    CHECK( gRing.stats.taken == got );
+    CHECK( gRing.stats.droppedLong == 0U );
+    CHECK( gRing.owner == 0U );
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+int main( void )
+{
+    gStream = malloc( (size_t)STRESS_PRODUCERS * STRESS_RECORDS * STRESS_RECORD_MAX );
+    if( gStream == NULL )
+    {
+        return 1;
+    }
+
+    testParameters();
+    testWrap();
+    testTooLong();
+    testStress( LOG_RING_DROP_NEWEST );
+    testStress( LOG_RING_DROP_OLDEST );
+
+    free( gStream );
+    printf( "%s\n", (gFailures == 0U) ? "PASS" : "FAIL" );
+    return (gFailures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,303 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \brief Host test of the tokenized log and of its decoder
+ *
+ *  Logs the demo lines and the edge cases of the format walk with
+ *  logToken(), plain text interleaved, through logger.c and a DMA stub.
+ *  The encoding of a few records is checked byte by byte, then the capture
+ *  is decoded by Tools/log_token_decode.py with the .log_str section of this
+ *  executable and must match the text printf() gives for the same lines.
+ *  The bytes sent and the time per call of both paths are printed for
+ *  information.
+ *
+ *  Run by Tools/run_host_tests.sh, linked with Tools/host/log_str.ld
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#define USE_LOGGER             1        /* LOGGER_ON */
+#define LOGGER_TOKENIZED       1
+
+#include <stdlib.h>
+#include <time.h>
+#include "platform.h"
+#include "../Src/log_ring.c"
+#include "../Src/logger.c"
+#include "../Src/log_token.c"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define SIM_OUT_SIZE           (64U * 1024U)
+#define SIM_BENCH_RUNS         100000U
+
+#define CHECK( cond )          do { if( !(cond) ) { printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond ); gFailures++; } } while(0)
+
+/* Log a line tokenized and append the text expected from the decoder */
+#define SIM_LOG( ... )         do { logToken( __VA_ARGS__ ); simFlush(); simExpect( __VA_ARGS__ ); } while(0)
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static uint32_t           gFailures;
+static UART_HandleTypeDef gUart;
+static bool               gDmaBusy;
+
+static uint8_t            gOut[SIM_OUT_SIZE];        /*!< Bytes sent on the UART   */
+static size_t             gOutLen;
+static char               gExpect[SIM_OUT_SIZE];     /*!< Text of the same lines   */
+static size_t             gExpectLen;
+
+static const uint8_t      gUid[7]  = { 0x04, 0x9A, 0x3B, 0x52, 0x61, 0x2E, 0x80 };
+static const uint8_t      gUid8[8] = { 0xE0, 0x02, 0x26, 0x00, 0x12, 0x34, 0x56, 0x78 };
+static volatile int       gV1 = 1234;
+static volatile int       gV2 = 456;
+static volatile int       gV3 = 12;
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/* Complete the DMA transfers until the log ring is drained */
+static void simFlush( void )
+{
+    while( gDmaBusy )
+    {
+        gDmaBusy = false;
+        logUsartTxCpltCallback( &gUart );
+    }
+}
+
+static void simExpect( const char* format, ... )
+{
+    va_list args;
+
+    va_start( args, format );
+    gExpectLen += (size_t)vsnprintf( &gExpect[gExpectLen], sizeof(gExpect) - gExpectLen, format, args );
+    va_end( args );
+}
+
+/* Text of hex2Str() in the text build */
+static const char* simHex( const uint8_t* data, size_t len )
+{
+    static char str[2U * MAX_HEX_STR_LENGTH];
+    size_t      i;
+
+    for( i = 0; i < len; i++ )
+    {
+        snprintf( &str[2U * i], 3, "%02X", data[i] );
+    }
+    str[2U * len] = '\0';
+    return str;
+}
+
+static double simNs( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+/* Record layout: sync, length, token, zigzag and varint arguments */
+static void testEncoding( void )
+{
+    LOG_TOKEN_SECTION static const char fmt[] = "%d %u %s";
+    uint16_t token = (uint16_t)(fmt - __log_str_start__);
+
+    gOutLen = 0;
+    logTokenWrite( fmt, -1, 300U, "ab" );
+    simFlush();
+
+    CHECK( gOutLen == 10U );
+    CHECK( (gOut[0] == LOG_TOKEN_SYNC) && (gOut[1] == 8U) );
+    CHECK( (gOut[2] == (uint8_t)token) && (gOut[3] == (uint8_t)(token >> 8U)) );
+    CHECK( gOut[4] == 0x01U );                                 /* -1 zigzag         */
+    CHECK( (gOut[5] == 0xACU) && (gOut[6] == 0x02U) );         /* 300 varint        */
+    CHECK( (gOut[7] == 0x04U) && (gOut[8] == 'a') && (gOut[9] == 'b') );    /* Length 2, text */
+
+    /* Arguments beyond LOG_TOKEN_MAX_LEN are truncated, the record stays valid */
+    gOutLen = 0;
+    logToken( "%s %d\r\n", hex2Str( (uint8_t*)gExpect, MAX_HEX_STR_LENGTH ), 5 );
+    simFlush();
+    CHECK( (gOutLen <= LOG_TOKEN_MAX_LEN) && (gOut[1] == (gOutLen - 2U)) );
+}
+
+/* The decoder rebuilds the text of every line, plain text passes through */
+static void testDecoder( const char* exe )
+{
+    static const char raw[] = "BLE trace: ACI_GATT_UPDATE_CHAR_VALUE\r\n";
+    static const char fill[] = "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef";
+    char  cmd[1024];
+    char  capture[256];
+    char  decoded[256];
+    char* text;
+    FILE* f;
+    long  n;
+
+    gOutLen    = 0;
+    gExpectLen = 0;
+
+    logToken( "ISO14443A/NFC-A card found. UID: %s\r\n", hex2Str( (uint8_t*)gUid, sizeof(gUid) ) );
+    simFlush();
+    simExpect( "ISO14443A/NFC-A card found. UID: %s\r\n", simHex( gUid, sizeof(gUid) ) );
+    logToken( "ISO15693/NFC-V card found. UID: %s\r\n", hex2Str( (uint8_t*)gUid8, sizeof(gUid8) ) );
+    simFlush();
+    simExpect( "ISO15693/NFC-V card found. UID: %s\r\n", simHex( gUid8, sizeof(gUid8) ) );
+
+    SIM_LOG( "Operation completed\r\nTag can be removed from the field\r\n" );
+    SIM_LOG( " Device removed, %d frames, %d SYMM, %d AGF.\r\n", gV1, gV2, gV3 );
+    SIM_LOG( "  %d  %d  %d  %d  %d   %d\r\n", 1, 0, 0, 1, 0, 1 );
+    SIM_LOG( "NDEF Len: %d, Offset=%d\r\n", 27, -2 );
+    SIM_LOG( "%c", 'S' );
+    SIM_LOG( "%s NDEF detected.\r\n", "READ/WRITE" );
+
+    logUsartTx( (uint8_t*)raw, (uint16_t)strlen( raw ) );
+    simFlush();
+    simExpect( "%s", raw );
+
+    SIM_LOG( " * Magic: %2.2Xh Version: %d.%d Size: %d (%lu bytes) ptr %p\r\n", 0xE1, 1, 0, 0x6D, 872UL, (void*)0x20001234 );
+    SIM_LOG( "%*d|%-6s|%.3f|%%|%lld|%zu|%hu\r\n", 5, 42, "ab", 3.14159, -123456789012LL, (size_t)77, (unsigned short)65535 );
+    SIM_LOG( "%08x %o %5.1f\r\n", 0xBEEFU, 8U, -2.5 );
+
+    logToken( "long %s\r\n", hex2Str( (uint8_t*)fill, 60 ) );
+    simFlush();
+    simExpect( "long %s\r\n", simHex( (const uint8_t*)fill, 60 ) );
+
+    printf( "  %u lines: text %lu B, tokenized %lu B\n", 13U, (unsigned long)gExpectLen, (unsigned long)gOutLen );
+    CHECK( gOutLen < (gExpectLen / 2U) );
+
+    /* Decode the capture with the string table of this executable */
+    snprintf( capture, sizeof(capture), "%s.bin", exe );
+    snprintf( decoded, sizeof(decoded), "%s.txt", exe );
+    f = fopen( capture, "wb" );
+    CHECK( f != NULL );
+    if( f == NULL )
+    {
+        return;
+    }
+    fwrite( gOut, 1, gOutLen, f );
+    fclose( f );
+
+    snprintf( cmd, sizeof(cmd), "python3 Tools/log_token_decode.py %s %s > %s", exe, capture, decoded );
+    CHECK( system( cmd ) == 0 );
+
+    f = fopen( decoded, "rb" );
+    CHECK( f != NULL );
+    if( f == NULL )
+    {
+        return;
+    }
+    text = malloc( SIM_OUT_SIZE );
+    n    = (long)fread( text, 1, SIM_OUT_SIZE, f );
+    fclose( f );
+
+    CHECK( (size_t)n == gExpectLen );
+    CHECK( memcmp( text, gExpect, gExpectLen ) == 0 );
+    if( ((size_t)n != gExpectLen) || (memcmp( text, gExpect, gExpectLen ) != 0) )
+    {
+        printf( "  decoded:\n%.*s  expected:\n%s", (int)n, text, gExpect );
+    }
+    free( text );
+}
+
+/* Time per call, text and tokenized, ring and DMA handoff included */
+static void testBench( void )
+{
+    double   t0;
+    double   tText;
+    double   tToken;
+    size_t   bText;
+    size_t   bToken;
+    uint32_t i;
+
+    gOutLen = 0;
+    t0      = simNs();
+    for( i = 0; i < SIM_BENCH_RUNS; i++ )
+    {
+        logUsart( " Device removed, %d frames, %d SYMM, %d AGF.\r\n", gV1, gV2, gV3 );
+        simFlush();
+        bText   = gOutLen;
+        gOutLen = 0;
+    }
+    tText = (simNs() - t0) / SIM_BENCH_RUNS;
+
+    t0 = simNs();
+    for( i = 0; i < SIM_BENCH_RUNS; i++ )
+    {
+        logToken( " Device removed, %d frames, %d SYMM, %d AGF.\r\n", gV1, gV2, gV3 );
+        simFlush();
+        bToken  = gOutLen;
+        gOutLen = 0;
+    }
+    tToken = (simNs() - t0) / SIM_BENCH_RUNS;
+
+    printf( "  3 ints line: text %lu B %.0f ns, tokenized %lu B %.0f ns\n",
+            (unsigned long)bText, tText, (unsigned long)bToken, tToken );
+    CHECK( bToken < bText );
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA( UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size )
+{
+    (void)huart;
+    if( gDmaBusy || ((gOutLen + Size) > sizeof(gOut)) )
+    {
+        return HAL_BUSY;
+    }
+    memcpy( &gOut[gOutLen], pData, Size );
+    gOutLen += Size;
+    gDmaBusy = true;
+    return HAL_OK;
+}
+
+int main( int argc, char** argv )
+{
+    (void)argc;
+
+    logUsartInit( &gUart );
+
+    testEncoding();
+    testDecoder( argv[0] );
+    testBench();
+    CHECK( logUsartDropped() == 0U );
+
+    printf( "%s\n", (gFailures == 0U) ? "PASS" : "FAIL" );
+    return (gFailures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,290 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \brief Host test of the DMA log output
+ *
+ *  Runs logger.c against a 115200 baud 8N1 UART with DMA simulated in
+ *  virtual time: steady logging and the bursts of the NDEF dump and of the
+ *  demo must not lose a line, an overload drops lines but every line is
+ *  delivered whole and in order or counted by logUsartDropped(). A DMA
+ *  transfer that cannot be started is counted and the next lines go out.
+ *  The caller side time of logUsart() is printed for information.
+ *
+ *  Run by Tools/run_host_tests.sh
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#define USE_LOGGER             1        /* LOGGER_ON */
+
+#include <stdlib.h>
+#include <time.h>
+#include "platform.h"
+#include "../Src/log_ring.c"
+#include "../Src/logger.c"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define SIM_BYTE_US            (10.0 * 1e6 / 115200.0)  /*!< 8N1 character time    */
+#define SIM_OUT_SIZE           (1U << 20)
+
+#define CHECK( cond )          do { if( !(cond) ) { printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond ); gFailures++; } } while(0)
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static uint32_t           gFailures;
+static UART_HandleTypeDef gUart;
+
+static double             gNowUs;
+static double             gDmaEndUs;
+static bool               gDmaBusy;
+static uint32_t           gDmaTransfers;
+static HAL_StatusTypeDef  gDmaFail;       /*!< Next start fails with this status */
+static char*              gOut;
+static size_t             gOutLen;
+
+static uint32_t           gLineNo;
+static uint32_t           gLines;
+static double             gCallNs;
+static double             gMaxCallNs;
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/* Run the UART until t */
+static void simAdvance( double t )
+{
+    while( gDmaBusy && (gDmaEndUs <= t) )
+    {
+        gNowUs   = gDmaEndUs;
+        gDmaBusy = false;
+        logUsartTxCpltCallback( &gUart );
+    }
+    if( t > gNowUs )
+    {
+        gNowUs = t;
+    }
+}
+
+static double simNs( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+/* One platformLog() line of len bytes */
+static void simLine( int len )
+{
+    static const char fill[] = "0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF";
+    double t0;
+    double dt;
+
+    t0 = simNs();
+    logUsart( "L%06lu %.*s\r\n", (unsigned long)gLineNo, len - 10, fill );
+    dt = simNs() - t0;
+
+    gCallNs += dt;
+    if( dt > gMaxCallNs )
+    {
+        gMaxCallNs = dt;
+    }
+    gLineNo++;
+    gLines++;
+}
+
+/* Count the lines delivered, false if one is cut or out of order */
+static bool simDelivered( uint32_t *delivered )
+{
+    size_t        i    = 0;
+    long          last = -1;
+    unsigned long no;
+    int           k;
+    char*         end;
+
+    *delivered = 0;
+    gOut[gOutLen] = '\0';
+    while( i < gOutLen )
+    {
+        if( (sscanf( &gOut[i], "L%06lu %n", &no, &k ) != 1) || ((long)no <= last) )
+        {
+            return false;
+        }
+        end = strstr( &gOut[i], "\r\n" );
+        if( end == NULL )
+        {
+            return false;
+        }
+        i    = (size_t)(end - gOut) + 2U;
+        last = (long)no;
+        (*delivered)++;
+    }
+    return true;
+}
+
+static void simReset( void )
+{
+    gOutLen       = 0;
+    gLines        = 0;
+    gCallNs       = 0;
+    gMaxCallNs    = 0;
+    gDmaTransfers = 0;
+}
+
+/* bursts of burstLines lines of len bytes, lineGapUs apart, burstGapUs between the bursts */
+static void testScenario( const char* name, uint32_t bursts, uint32_t burstLines, int len,
+                          double lineGapUs, double burstGapUs, bool lossless )
+{
+    uint32_t dropped0 = logUsartDropped();
+    uint32_t delivered;
+    uint32_t dropped;
+    uint32_t b;
+    uint32_t l;
+    bool     whole;
+
+    simReset();
+    for( b = 0; b < bursts; b++ )
+    {
+        for( l = 0; l < burstLines; l++ )
+        {
+            simLine( len );
+            simAdvance( gNowUs + lineGapUs );
+        }
+        simAdvance( gNowUs + burstGapUs );
+    }
+    simAdvance( gNowUs + 1e7 );
+
+    whole   = simDelivered( &delivered );
+    dropped = logUsartDropped() - dropped0;
+
+    printf( "  %-32s %5lu lines %6.1f kB: dropped %5.1f%%, caller %5.0f ns avg %6.0f ns max (blocking %6.0f us), %lu DMA\n",
+            name, (unsigned long)gLines, (gLines * len) / 1000.0, (100.0 * dropped) / gLines,
+            gCallNs / gLines, gMaxCallNs, len * SIM_BYTE_US, (unsigned long)gDmaTransfers );
+
+    CHECK( whole );
+    CHECK( (delivered + dropped) == gLines );
+    CHECK( !lossless || (dropped == 0U) );
+    CHECK( logUsartIsIdle() );
+}
+
+/* The records taken for a DMA transfer that did not start are counted */
+static void testDmaFailure( HAL_StatusTypeDef status )
+{
+    uint32_t dropped0 = logUsartDropped();
+    uint32_t delivered;
+    uint32_t l;
+
+    simReset();
+    gDmaFail = status;
+    simLine( 60 );                       /* Lost, the ring is released        */
+    CHECK( logUsartIsIdle() );
+    CHECK( (logUsartDropped() - dropped0) == 1U );
+
+    for( l = 0; l < 20U; l++ )
+    {
+        simLine( 60 );
+        simAdvance( gNowUs + 100.0 );
+    }
+    simAdvance( gNowUs + 1e7 );
+
+    CHECK( simDelivered( &delivered ) );
+    CHECK( delivered == 20U );
+    CHECK( (logUsartDropped() - dropped0) == 1U );
+    CHECK( logUsartIsIdle() );
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA( UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size )
+{
+    HAL_StatusTypeDef ret = gDmaFail;
+
+    (void)huart;
+    if( gDmaBusy )
+    {
+        return HAL_BUSY;
+    }
+    if( ret != HAL_OK )
+    {
+        gDmaFail = HAL_OK;
+        return ret;
+    }
+
+    memcpy( &gOut[gOutLen], pData, Size );
+    gOutLen  += Size;
+    gDmaBusy  = true;
+    gDmaEndUs = gNowUs + (Size * SIM_BYTE_US);
+    gDmaTransfers++;
+    return HAL_OK;
+}
+
+int main( void )
+{
+    uint32_t i;
+
+    gOut = malloc( SIM_OUT_SIZE + 1U );
+    if( gOut == NULL )
+    {
+        return 1;
+    }
+
+    logUsartInit( &gUart );
+    printf( "  ring %u bytes, %s\n", (unsigned)LOG_USART_RING_SIZE,
+            (LOG_USART_DROP_POLICY == LOG_RING_DROP_NEWEST) ? "drop newest" : "drop oldest" );
+
+    /* Warm the caches */
+    for( i = 0; i < 2000U; i++ )
+    {
+        simLine( 60 );
+        simAdvance( gNowUs + 10000.0 );
+    }
+
+    testScenario( "steady 60 B every 10 ms",         1,  500, 60, 10000.0, 0.0, true );
+    testScenario( "NDEF dump burst 40 x 70 B / 1 s", 10,  40, 70,    20.0, 1e6, true );
+    testScenario( "demo burst 120 x 60 B / 2 s",     5,  120, 60,    20.0, 2e6, false );
+    testScenario( "overload 20 kB/s for 2 s",        1,  500, 80,  4000.0, 0.0, false );
+    testDmaFailure( HAL_ERROR );
+    testDmaFailure( HAL_BUSY );
+
+    free( gOut );
+    printf( "%s\n", (gFailures == 0U) ? "PASS" : "FAIL" );
+    return (gFailures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \brief Host tests: two LLCP and SNEP instances in one program
+ *
+ *  The loopback tests link nfc_llcp.c and nfc_snep.c twice, once for each
+ *  side of the link. The translation unit of an instance defines
+ *  LLCP_INSTANCE (A or B) before including this file and the module: its
+ *  global functions, and the RFAL functions it calls, get the instance
+ *  prefix, e.g. A_llcpWorker() and A_rfalNfcDataExchangeStart().
+ *
+ */
+
+#ifndef NFC_LLCP_INSTANCE_H
+#define NFC_LLCP_INSTANCE_H
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "platform.h"
+
+/*
+******************************************************************************
+* GLOBAL MACROS
+******************************************************************************
+*/
+#define LLCP_INSTANCE_CAT2( p, n )      p##_##n
+#define LLCP_INSTANCE_CAT( p, n )       LLCP_INSTANCE_CAT2( p, n )
+
+#ifdef LLCP_INSTANCE
+#define llcpInit                        LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpInit )
+#define llcpGetGeneralBytes             LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpGetGeneralBytes )
+#define llcpActivate                    LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpActivate )
+#define llcpDeactivate                  LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpDeactivate )
+#define llcpDeinit                      LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpDeinit )
+#define llcpBindService                 LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpBindService )
+#define llcpUnbindService               LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpUnbindService )
+#define llcpServiceNameLookup           LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpServiceNameLookup )
+#define llcpConnect                     LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpConnect )
+#define llcpDisconnect                  LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpDisconnect )
+#define llcpSendUI                      LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpSendUI )
+#define llcpCheckAvailableRW            LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpCheckAvailableRW )
+#define llcpSendI                       LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpSendI )
+#define llcpUiBufferProcessed           LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpUiBufferProcessed )
+#define llcpIBufferProcessed            LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpIBufferProcessed )
+#define llcpWorker                      LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpWorker )
+#define llcpWorkerGetStatus             LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpWorkerGetStatus )
+#define llcpGetStats                    LLCP_INSTANCE_CAT( LLCP_INSTANCE, llcpGetStats )
+
+#define snepClientIni                   LLCP_INSTANCE_CAT( LLCP_INSTANCE, snepClientIni )
+#define snepServerIni                   LLCP_INSTANCE_CAT( LLCP_INSTANCE, snepServerIni )
+#define snepClientPut                   LLCP_INSTANCE_CAT( LLCP_INSTANCE, snepClientPut )
+#define snepClientGet                   LLCP_INSTANCE_CAT( LLCP_INSTANCE, snepClientGet )
+#define snepClientGetStatus             LLCP_INSTANCE_CAT( LLCP_INSTANCE, snepClientGetStatus )
+#define snepWorker                      LLCP_INSTANCE_CAT( LLCP_INSTANCE, snepWorker )
+#define snepGetStats                    LLCP_INSTANCE_CAT( LLCP_INSTANCE, snepGetStats )
+
+#define rfalNfcDataExchangeStart        LLCP_INSTANCE_CAT( LLCP_INSTANCE, rfalNfcDataExchangeStart )
+#define rfalNfcDataExchangeGetStatus    LLCP_INSTANCE_CAT( LLCP_INSTANCE, rfalNfcDataExchangeGetStatus )
+#endif /* LLCP_INSTANCE */
+
+/*! Prototypes of the LLCP functions of instance P */
+#define LLCP_INSTANCE_DECLARE( P ) \
+    ReturnCode P##_llcpInit( void ); \
+    uint8_t    P##_llcpGetGeneralBytes( uint8_t* gb, uint8_t gbLen ); \
+    ReturnCode P##_llcpActivate( rfalNfcDevice* nfcDevice ); \
+    ReturnCode P##_llcpDeactivate( void ); \
+    ReturnCode P##_llcpBindService( const llcpServiceConfig* config, llcpService** service ); \
+    ReturnCode P##_llcpConnect( llcpService* service, uint8_t dsap, const uint8_t* uri ); \
+    ReturnCode P##_llcpDisconnect( llcpService* service ); \
+    bool       P##_llcpCheckAvailableRW( llcpService* service ); \
+    ReturnCode P##_llcpSendI( llcpService* service, const uint8_t* txBuffer, uint16_t txLength ); \
+    ReturnCode P##_llcpIBufferProcessed( llcpService* service ); \
+    void       P##_llcpWorker( void ); \
+    ReturnCode P##_llcpWorkerGetStatus( void ); \
+    void       P##_llcpGetStats( llcpStats* stats ); \
+    ReturnCode P##_rfalNfcDataExchangeStart( uint8_t* txData, uint16_t txDataLen, uint8_t** rxData, uint16_t** rvdLen, uint32_t fwt ); \
+    ReturnCode P##_rfalNfcDataExchangeGetStatus( void )
+
+/*! Prototypes of the SNEP functions of instance P */
+#define SNEP_INSTANCE_DECLARE( P ) \
+    ReturnCode P##_snepClientIni( void ); \
+    ReturnCode P##_snepServerIni( const snepServerConfig* config ); \
+    ReturnCode P##_snepClientPut( const ndefConstBuffer* message ); \
+    ReturnCode P##_snepClientGet( const ndefConstBuffer* request, uint32_t acceptableLength, const snepSink* sink ); \
+    ReturnCode P##_snepClientGetStatus( void ); \
+    void       P##_snepWorker( void ); \
+    void       P##_snepGetStats( snepStats* stats )
+
+#endif /* NFC_LLCP_INSTANCE_H */
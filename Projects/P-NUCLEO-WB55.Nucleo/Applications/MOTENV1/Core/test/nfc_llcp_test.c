@@ -0,0 +1,642 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \brief Host test of the LLCP link engine
+ *
+ *  Two instances of nfc_llcp.c, A as Initiator and B as Target, exchange
+ *  frames over an in-memory NFC-DEP link at 424 kbps. Numbered SDUs are
+ *  sent in one or both directions, with the receivers handing the buffers
+ *  back at once or 1 ms later, and must arrive in order. Then frames are
+ *  corrupted on the way to check that an invalid N(S) or N(R) makes the
+ *  receiver send an FRMR and a DISC, and that the service can connect
+ *  again.
+ *
+ *  Run by Tools/run_host_tests.sh
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdlib.h>
+#include "nfc_llcp_instance.h"
+#include "nfc_llcp.h"
+#include "utils.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define SIM_STEP               0.01                    /*!< Worker call period [ms]               */
+#define SIM_LATENCY            1.0                     /*!< Turnaround per direction [ms]         */
+#define SIM_BYTE_MS            (8.0 / 424.0)           /*!< Byte time at 424 kbps [ms]            */
+#define SIM_DEP_OVERHEAD       6U                      /*!< LEN, CMD, PFB and CRC of a DEP frame  */
+#define SIM_FRAME_MAX          300U
+
+#define BULK_DURATION          2000.0                  /*!< [ms] */
+#define IDLE_DURATION          20000.0                 /*!< [ms] */
+#define MIN_THROUGHPUT         8.0                     /*!< Bulk transfer [kB/s]                  */
+#define MAX_IDLE_SYMM          50.0                    /*!< SYMM per second on an idle link       */
+
+#define NB_SERVICES            2U
+
+#define CHECK( cond )          do { if( !(cond) ) { printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond ); gFailures++; } } while(0)
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! One side of the NFC-DEP link */
+typedef struct
+{
+    uint8_t  tx[SIM_FRAME_MAX];  /*!< Frame on its way to the other side  */
+    uint16_t txLen;
+    double   deliverAt;          /*!< Arrival time, < 0 when none         */
+    uint8_t  rx[SIM_FRAME_MAX];  /*!< RFAL receive buffer                 */
+    uint16_t rxLen;
+} simSide;
+
+/*! Application of a service */
+typedef struct
+{
+    llcpService* service;
+    bool         connected;
+    uint32_t     disconnects;    /*!< DISC or DM notified                 */
+    uint32_t     txSeq;          /*!< Next SDU number sent                */
+    uint32_t     rxSeq;          /*!< Next SDU number expected            */
+    uint32_t     rxBytes;
+    uint32_t     errors;         /*!< SDUs out of order or truncated      */
+    bool         pending;        /*!< SDU not handed back yet             */
+    bool         bulk;           /*!< Refill the transmit queue on RR     */
+} simApp;
+
+/*! Frame corruption */
+typedef void (*simTamper)( uint8_t* frame, uint16_t length );
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static uint32_t  gFailures;
+static double    gMs;
+static uint32_t  gFrames;
+
+static simSide   gA;             /*!< Initiator */
+static simSide   gB;             /*!< Target    */
+static simTamper gTamperToB;
+
+static simApp    gAppA[NB_SERVICES];
+static simApp    gAppB[NB_SERVICES];
+static uint16_t  gSduLen;
+static bool      gDeferred;
+static double    gNextConsume;
+
+/* Control PDUs sent by B, in order */
+static llcpPdu   gBControl[16];
+static uint8_t   gBControlCnt;
+static uint8_t   gBFrmr[LLCP_FRMR_LENGTH];
+
+static const uint8_t* const gUri[NB_SERVICES] = { (const uint8_t*)"urn:nfc:sn:bulk0", (const uint8_t*)"urn:nfc:sn:bulk1" };
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+LLCP_INSTANCE_DECLARE( A );
+LLCP_INSTANCE_DECLARE( B );
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+static llcpPdu simPduType( const uint8_t* pdu )
+{
+    return (llcpPdu)((uint8_t)((pdu[0] & 0x03U) << 2U) | (uint8_t)(pdu[1] >> 6U));
+}
+
+/* Record the control PDUs of a frame sent by B */
+static void simTraceB( const uint8_t* frame, uint16_t length )
+{
+    const uint8_t* pdu;
+    uint16_t       offset = PDU_HEADER_LENGTH;
+    uint16_t       len;
+    llcpPdu        ptype;
+
+    if( length < PDU_HEADER_LENGTH )
+    {
+        return;
+    }
+
+    do
+    {
+        if( simPduType( frame ) == LLCP_PDU_AGF )
+        {
+            if( (offset + PDU_AGF_LENGTH_LENGTH) > length )
+            {
+                return;
+            }
+            len     = (uint16_t)(((uint16_t)frame[offset] << 8U) | frame[offset + 1U]);
+            pdu     = &frame[offset + PDU_AGF_LENGTH_LENGTH];
+            offset  = (uint16_t)(offset + PDU_AGF_LENGTH_LENGTH + len);
+        }
+        else
+        {
+            pdu    = frame;
+            len    = length;
+            offset = length;
+        }
+
+        ptype = simPduType( pdu );
+        if( (ptype == LLCP_PDU_FRMR) || (ptype == LLCP_PDU_DISC) || (ptype == LLCP_PDU_DM) )
+        {
+            if( gBControlCnt < (sizeof(gBControl) / sizeof(gBControl[0])) )
+            {
+                gBControl[gBControlCnt++] = ptype;
+            }
+            if( (ptype == LLCP_PDU_FRMR) && (len == (PDU_HEADER_LENGTH + LLCP_FRMR_LENGTH)) )
+            {
+                ST_MEMCPY( gBFrmr, &pdu[PDU_HEADER_LENGTH], LLCP_FRMR_LENGTH );
+            }
+        }
+    } while( offset < length );
+}
+
+static void simSend( simSide* side, const uint8_t* frame, uint16_t length )
+{
+    ST_MEMCPY( side->tx, frame, length );
+    side->txLen     = length;
+    side->deliverAt = gMs + SIM_LATENCY + ((double)(length + SIM_DEP_OVERHEAD) * SIM_BYTE_MS);
+}
+
+static ReturnCode simReceive( simSide* from, simSide* to )
+{
+    if( (from->deliverAt < 0.0) || (gMs < from->deliverAt) )
+    {
+        return ERR_BUSY;
+    }
+    ST_MEMCPY( to->rx, from->tx, from->txLen );
+    to->rxLen       = from->txLen;
+    from->deliverAt = -1.0;
+    return ERR_NONE;
+}
+
+static bool simTrySend( simApp* app, bool isB )
+{
+    uint8_t buf[LLCP_MIU];
+
+    if( !app->connected || !(isB ? B_llcpCheckAvailableRW( app->service ) : A_llcpCheckAvailableRW( app->service )) )
+    {
+        return false;
+    }
+
+    ST_MEMSET( buf, 0xA5, sizeof(buf) );
+    ST_MEMCPY( buf, &app->txSeq, sizeof(app->txSeq) );
+    if( (isB ? B_llcpSendI( app->service, buf, gSduLen ) : A_llcpSendI( app->service, buf, gSduLen )) != ERR_NONE )
+    {
+        return false;
+    }
+    app->txSeq++;
+    return true;
+}
+
+static ReturnCode simNotify( simApp* app, bool isB, llcpService* service, llcpPdu pdu, const uint8_t* rxBuffer, uint16_t rxBufferLength )
+{
+    uint32_t seq;
+
+    switch( pdu )
+    {
+        case LLCP_PDU_CC:
+        case LLCP_PDU_CONNECT:
+            app->connected = true;
+            break;
+
+        case LLCP_PDU_I:
+            ST_MEMCPY( &seq, rxBuffer, sizeof(seq) );
+            if( (seq != app->rxSeq) || (rxBufferLength != gSduLen) )
+            {
+                app->errors++;
+            }
+            app->rxSeq    = seq + 1U;
+            app->rxBytes += rxBufferLength;
+            app->pending  = true;
+            if( !gDeferred )
+            {
+                app->pending = false;
+                (void)(isB ? B_llcpIBufferProcessed( service ) : A_llcpIBufferProcessed( service ));
+            }
+            break;
+
+        case LLCP_PDU_DM:
+        case LLCP_PDU_DISC:
+            app->connected = false;
+            app->disconnects++;
+            break;
+
+        case LLCP_PDU_RR:
+            /* Room in the transmit queue: refill it before the frame is answered */
+            while( app->bulk && simTrySend( app, isB ) )
+            {
+            }
+            break;
+
+        default:
+            break;
+    }
+    return ERR_NONE;
+}
+
+static ReturnCode simNotifyA0( llcpService* s, llcpPdu p, const uint8_t* b, uint16_t l ) { return simNotify( &gAppA[0], false, s, p, b, l ); }
+static ReturnCode simNotifyA1( llcpService* s, llcpPdu p, const uint8_t* b, uint16_t l ) { return simNotify( &gAppA[1], false, s, p, b, l ); }
+static ReturnCode simNotifyB0( llcpService* s, llcpPdu p, const uint8_t* b, uint16_t l ) { return simNotify( &gAppB[0], true,  s, p, b, l ); }
+static ReturnCode simNotifyB1( llcpService* s, llcpPdu p, const uint8_t* b, uint16_t l ) { return simNotify( &gAppB[1], true,  s, p, b, l ); }
+
+static void simStep( void )
+{
+    uint8_t i;
+
+    A_llcpWorker();
+    B_llcpWorker();
+
+    /* Deferred consumers hand one SDU back per ms */
+    if( gDeferred && (gMs >= gNextConsume) )
+    {
+        gNextConsume = gMs + 1.0;
+        for( i = 0; i < NB_SERVICES; i++ )
+        {
+            if( gAppA[i].pending )
+            {
+                gAppA[i].pending = false;
+                (void)A_llcpIBufferProcessed( gAppA[i].service );
+            }
+            if( gAppB[i].pending )
+            {
+                gAppB[i].pending = false;
+                (void)B_llcpIBufferProcessed( gAppB[i].service );
+            }
+        }
+    }
+
+    gMs += SIM_STEP;
+}
+
+static void simRun( double duration )
+{
+    double end = gMs + duration;
+
+    while( gMs < end )
+    {
+        simStep();
+    }
+}
+
+/* Bind the services, activate the link, connect A to B by service name */
+static void simSetup( uint8_t nbServices )
+{
+    ReturnCode (* const notifyA[NB_SERVICES])( llcpService*, llcpPdu, const uint8_t*, uint16_t ) = { simNotifyA0, simNotifyA1 };
+    ReturnCode (* const notifyB[NB_SERVICES])( llcpService*, llcpPdu, const uint8_t*, uint16_t ) = { simNotifyB0, simNotifyB1 };
+    static rfalNfcDevice devA;
+    static rfalNfcDevice devB;
+    llcpServiceConfig    config;
+    uint8_t              i;
+
+    ST_MEMSET( gAppA, 0x00, sizeof(gAppA) );
+    ST_MEMSET( gAppB, 0x00, sizeof(gAppB) );
+    gA.deliverAt  = -1.0;
+    gB.deliverAt  = -1.0;
+    gMs           = 0.0;
+    gFrames       = 0;
+    gNextConsume  = 0.0;
+    gTamperToB    = NULL;
+    gBControlCnt  = 0;
+
+    CHECK( A_llcpInit() == ERR_NONE );
+    CHECK( B_llcpInit() == ERR_NONE );
+    for( i = 0; i < nbServices; i++ )
+    {
+        config.uri      = NULL;
+        config.SAP      = 0;
+        config.Class    = LLCP_CLASS_CONNECTION_ORIENTED;
+        config.notifyCb = notifyA[i];
+        CHECK( A_llcpBindService( &config, &gAppA[i].service ) == ERR_NONE );
+
+        config.uri      = gUri[i];
+        config.SAP      = (uint8_t)(LLCP_SAP_SDP_FIRST + i);
+        config.notifyCb = notifyB[i];
+        CHECK( B_llcpBindService( &config, &gAppB[i].service ) == ERR_NONE );
+    }
+
+    /* A polls and gets B's General Bytes in the ATR_RES, B the ones of A in the ATR_REQ */
+    ST_MEMSET( &devA, 0x00, sizeof(devA) );
+    devA.type        = RFAL_NFC_LISTEN_TYPE_NFCA;
+    devA.rfInterface = RFAL_NFC_INTERFACE_NFCDEP;
+    devA.proto.nfcDep.info.GBLen = B_llcpGetGeneralBytes( devA.proto.nfcDep.activation.Target.ATR_RES.GBt, RFAL_NFCDEP_GB_MAX_LEN );
+
+    ST_MEMSET( &devB, 0x00, sizeof(devB) );
+    devB.type        = RFAL_NFC_POLL_TYPE_NFCA;
+    devB.rfInterface = RFAL_NFC_INTERFACE_NFCDEP;
+    devB.proto.nfcDep.info.GBLen = A_llcpGetGeneralBytes( devB.proto.nfcDep.activation.Initiator.ATR_REQ.GBi, RFAL_NFCDEP_GB_MAX_LEN );
+
+    CHECK( A_llcpActivate( &devA ) == ERR_NONE );
+    CHECK( B_llcpActivate( &devB ) == ERR_NONE );
+
+    for( i = 0; i < nbServices; i++ )
+    {
+        CHECK( A_llcpConnect( gAppA[i].service, 0, gUri[i] ) == ERR_NONE );
+    }
+    simRun( 50.0 );
+    for( i = 0; i < nbServices; i++ )
+    {
+        CHECK( gAppA[i].connected && gAppB[i].connected );
+    }
+}
+
+static bool simLinkOk( void )
+{
+    return ( (A_llcpWorkerGetStatus() <= ERR_BUSY) && (B_llcpWorkerGetStatus() <= ERR_BUSY) );
+}
+
+/* Bulk transfer: A to B (0), B to A (1) or both (2) */
+static void testBulk( uint8_t dir, uint8_t nbServices, uint16_t sduLen, bool deferred )
+{
+    llcpStats statsA;
+    llcpStats statsB;
+    uint32_t  bytes  = 0;
+    uint32_t  errors = 0;
+    double    kBps;
+    uint8_t   i;
+
+    gSduLen   = sduLen;
+    gDeferred = deferred;
+    simSetup( nbServices );
+
+    for( i = 0; i < nbServices; i++ )
+    {
+        gAppA[i].bulk = (dir != 1U);
+        gAppB[i].bulk = (dir != 0U);
+    }
+
+    gMs = 0.0;
+    while( gMs < BULK_DURATION )
+    {
+        for( i = 0; i < nbServices; i++ )
+        {
+            while( gAppA[i].bulk && simTrySend( &gAppA[i], false ) )
+            {
+            }
+            while( gAppB[i].bulk && simTrySend( &gAppB[i], true ) )
+            {
+            }
+        }
+        simStep();
+    }
+
+    A_llcpGetStats( &statsA );
+    B_llcpGetStats( &statsB );
+    for( i = 0; i < nbServices; i++ )
+    {
+        bytes  += gAppA[i].rxBytes + gAppB[i].rxBytes;
+        errors += gAppA[i].errors + gAppB[i].errors;
+    }
+    kBps = (double)bytes / BULK_DURATION;
+
+    printf( "  %-4s %u service%s SDU %3u %s: %6.2f kB/s, %5lu frames, AGF %lu/%lu, RNR %lu/%lu\n",
+            (dir == 0U) ? "A->B" : ((dir == 1U) ? "B->A" : "both"), nbServices, (nbServices > 1U) ? "s" : " ",
+            sduLen, deferred ? "deferred " : "immediate", kBps, (unsigned long)gFrames,
+            (unsigned long)statsA.agf, (unsigned long)statsB.agf, (unsigned long)statsA.rnr, (unsigned long)statsB.rnr );
+
+    CHECK( errors == 0U );
+    CHECK( kBps >= MIN_THROUGHPUT );
+    CHECK( (statsA.dropped == 0U) && (statsB.dropped == 0U) );
+    CHECK( (statsA.frmr == 0U) && (statsB.frmr == 0U) );
+    CHECK( simLinkOk() );
+}
+
+/* Idle link with a short message every 300 to 700 ms from either side */
+static void testIdle( void )
+{
+    llcpStats statsA;
+    double    next = 200.0;
+    uint32_t  sent = 0;
+    bool      fromB;
+
+    gSduLen   = 16;
+    gDeferred = false;
+    simSetup( 1 );
+    srand( 7 );
+
+    gMs = 0.0;
+    while( gMs < IDLE_DURATION )
+    {
+        if( gMs >= next )
+        {
+            fromB = ((rand() & 1) != 0);
+            sent += simTrySend( fromB ? &gAppB[0] : &gAppA[0], fromB ) ? 1U : 0U;
+            next  = gMs + 300.0 + (double)(rand() % 400);
+        }
+        simStep();
+    }
+    simRun( 200.0 );
+
+    A_llcpGetStats( &statsA );
+    printf( "  idle: %.1f frames/s, %.1f SYMM/s, %lu messages\n",
+            (double)gFrames * 1000.0 / IDLE_DURATION, (double)statsA.symm * 1000.0 / IDLE_DURATION, (unsigned long)sent );
+
+    CHECK( sent > 0U );
+    CHECK( (gAppA[0].rxSeq + gAppB[0].rxSeq) == sent );
+    CHECK( (gAppA[0].errors + gAppB[0].errors) == 0U );
+    CHECK( ((double)statsA.symm * 1000.0 / IDLE_DURATION) <= MAX_IDLE_SYMM );
+    CHECK( simLinkOk() );
+}
+
+/* Corruption of the next I PDU sent by A */
+static uint8_t gTamperNs;
+static uint8_t gTamperNr;
+static bool    gTamperDone;
+
+static void simTamperI( uint8_t* frame, uint16_t length )
+{
+    uint8_t* seq = NULL;
+
+    if( gTamperDone || (length < (PDU_HEADER_LENGTH + PDU_SEQUENCE_LENGTH)) )
+    {
+        return;
+    }
+
+    if( simPduType( frame ) == LLCP_PDU_I )
+    {
+        seq = &frame[PDU_HEADER_LENGTH];
+    }
+    else if( (simPduType( frame ) == LLCP_PDU_AGF) && (length >= (2U * PDU_HEADER_LENGTH + PDU_AGF_LENGTH_LENGTH + PDU_SEQUENCE_LENGTH)) &&
+             (simPduType( &frame[PDU_HEADER_LENGTH + PDU_AGF_LENGTH_LENGTH] ) == LLCP_PDU_I) )
+    {
+        seq = &frame[(2U * PDU_HEADER_LENGTH) + PDU_AGF_LENGTH_LENGTH];
+    }
+    else
+    {
+        return;
+    }
+
+    *seq = (uint8_t)((uint8_t)(*seq + (uint8_t)(gTamperNs << 4U)) & 0xF0U) | (uint8_t)((*seq + gTamperNr) & 0x0FU);
+    gTamperDone = true;
+}
+
+/* An invalid sequence number makes B reject the connection, then A connects again */
+static void testReject( const char* name, uint8_t nsOffset, uint8_t nrOffset, uint8_t flag )
+{
+    llcpStats statsA;
+    llcpStats statsB;
+
+    gSduLen   = 48;
+    gDeferred = false;
+    simSetup( 1 );
+
+    gAppA[0].bulk = true;
+    while( simTrySend( &gAppA[0], false ) )
+    {
+    }
+    simRun( 100.0 );
+    CHECK( gAppB[0].rxSeq != 0U );
+
+    /* Corrupt the next I PDU */
+    gTamperNs   = nsOffset;
+    gTamperNr   = nrOffset;
+    gTamperDone = false;
+    gTamperToB  = simTamperI;
+    while( simTrySend( &gAppA[0], false ) )
+    {
+    }
+    simRun( 100.0 );
+    gTamperToB    = NULL;
+    gAppA[0].bulk = false;
+    simRun( 100.0 );
+
+    A_llcpGetStats( &statsA );
+    B_llcpGetStats( &statsB );
+
+    printf( "  %s: FRMR %02X %02X %02X %02X after %lu SDUs in order, then DISC\n", name,
+            gBFrmr[0], gBFrmr[1], gBFrmr[2], gBFrmr[3], (unsigned long)gAppB[0].rxSeq );
+
+    CHECK( gTamperDone );
+    CHECK( statsB.frmr == 1U );
+    CHECK( (gBControlCnt >= 2U) && (gBControl[0] == LLCP_PDU_FRMR) && (gBControl[1] == LLCP_PDU_DISC) );
+    CHECK( gBFrmr[0] == (uint8_t)(flag | (uint8_t)LLCP_PDU_I) );
+    CHECK( (gBFrmr[2] & 0x0FU) == (gAppB[0].rxSeq & 0x0FU) );
+    CHECK( !gAppA[0].connected && (gAppA[0].disconnects != 0U) );
+    CHECK( !gAppB[0].connected && (gAppB[0].disconnects != 0U) );
+    CHECK( gAppB[0].errors == 0U );
+    CHECK( statsA.frmr == 0U );
+    CHECK( simLinkOk() );
+
+    /* The link is still up: the service connects again and transfers */
+    gAppA[0].txSeq = 0;
+    gAppB[0].rxSeq = 0;
+    CHECK( A_llcpConnect( gAppA[0].service, 0, gUri[0] ) == ERR_NONE );
+    simRun( 50.0 );
+    CHECK( gAppA[0].connected && gAppB[0].connected );
+    CHECK( simTrySend( &gAppA[0], false ) );
+    simRun( 50.0 );
+    CHECK( gAppB[0].rxSeq == 1U );
+    CHECK( gAppB[0].errors == 0U );
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+uint32_t HAL_GetTick( void )
+{
+    return (uint32_t)gMs;
+}
+
+ReturnCode A_rfalNfcDataExchangeStart( uint8_t* txData, uint16_t txDataLen, uint8_t** rxData, uint16_t** rvdLen, uint32_t fwt )
+{
+    (void)fwt;
+    CHECK( txDataLen <= SIM_FRAME_MAX );
+
+    simSend( &gA, txData, txDataLen );
+    if( gTamperToB != NULL )
+    {
+        gTamperToB( gA.tx, gA.txLen );
+    }
+    *rxData = gA.rx;
+    *rvdLen = &gA.rxLen;
+    gFrames++;
+    return ERR_NONE;
+}
+
+ReturnCode A_rfalNfcDataExchangeGetStatus( void )
+{
+    return simReceive( &gB, &gA );
+}
+
+ReturnCode B_rfalNfcDataExchangeStart( uint8_t* txData, uint16_t txDataLen, uint8_t** rxData, uint16_t** rvdLen, uint32_t fwt )
+{
+    (void)fwt;
+    CHECK( txDataLen <= SIM_FRAME_MAX );
+
+    /* The Target's first call only starts the reception */
+    if( txDataLen != 0U )
+    {
+        simTraceB( txData, txDataLen );
+        simSend( &gB, txData, txDataLen );
+    }
+    *rxData = gB.rx;
+    *rvdLen = &gB.rxLen;
+    return ERR_NONE;
+}
+
+ReturnCode B_rfalNfcDataExchangeGetStatus( void )
+{
+    return simReceive( &gA, &gB );
+}
+
+int main( void )
+{
+    printf( "LLCP_RW %u, LLCP_MIU %u, turnaround %.1f ms\n", LLCP_RW, LLCP_MIU, SIM_LATENCY );
+
+    testBulk( 0, 1, 16,  false );
+    testBulk( 0, 1, 48,  false );
+    testBulk( 0, 1, 125, false );
+    testBulk( 0, 1, 16,  true );
+    testBulk( 1, 1, 48,  false );
+    testBulk( 2, 1, 48,  false );
+    testBulk( 0, 2, 48,  false );
+    testIdle();
+
+    testReject( "Invalid N(S)", 1, 0, LLCP_FRMR_FLAG_S );
+    testReject( "Invalid N(R)", 0, 5, LLCP_FRMR_FLAG_R );
+
+    printf( "%s\n", (gFailures == 0U) ? "PASS" : "FAIL" );
+    return (gFailures == 0U) ? 0 : 1;
+}
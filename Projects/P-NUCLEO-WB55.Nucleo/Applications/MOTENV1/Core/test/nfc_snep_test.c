@@ -0,0 +1,451 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \brief Host test of the SNEP client and server
+ *
+ *  The SNEP client of instance A, the Initiator, sends PUT and GET requests
+ *  to the SNEP server of instance B, the Target, over two LLCP engines and
+ *  an in-memory NFC-DEP link at 424 kbps. Messages from 100 bytes to 64 kB
+ *  must arrive whole and in order, also when the receiving sink takes only
+ *  4 kB/s. Then the server refuses requests: the client gets the matching
+ *  status and the connection carries the next request.
+ *
+ *  Run by Tools/run_host_tests.sh
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdlib.h>
+#include "nfc_llcp_instance.h"
+#include "nfc_snep.h"
+#include "utils.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define SIM_STEP               0.01                    /*!< Worker call period [ms]               */
+#define SIM_LATENCY            1.0                     /*!< Turnaround per direction [ms]         */
+#define SIM_BYTE_MS            (8.0 / 424.0)           /*!< Byte time at 424 kbps [ms]            */
+#define SIM_DEP_OVERHEAD       6U                      /*!< LEN, CMD, PFB and CRC of a DEP frame  */
+#define SIM_FRAME_MAX          300U
+#define SIM_TIMEOUT            60000.0                 /*!< [ms] */
+
+#define MSG_MAX                65536U
+#define SINK_BURST             512.0                   /*!< Slow sink: bytes taken at once        */
+#define SLOW_SINK_RATE         4.0                     /*!< Slow sink [kB/s]                      */
+#define MIN_THROUGHPUT         20.0                    /*!< Messages of 4 kB or more [kB/s]       */
+
+#define CHECK( cond )          do { if( !(cond) ) { printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond ); gFailures++; } } while(0)
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! One side of the NFC-DEP link */
+typedef struct
+{
+    uint8_t  tx[SIM_FRAME_MAX];  /*!< Frame on its way to the other side  */
+    uint16_t txLen;
+    double   deliverAt;          /*!< Arrival time, < 0 when none         */
+    uint8_t  rx[SIM_FRAME_MAX];  /*!< RFAL receive buffer                 */
+    uint16_t rxLen;
+} simSide;
+
+/*! Receiver of a message, checks the byte pattern */
+typedef struct
+{
+    uint32_t   length;           /*!< Announced by begin()                */
+    uint32_t   got;
+    uint32_t   errors;           /*!< Bytes not matching the pattern      */
+    bool       ended;
+    ReturnCode endErr;
+    double     rate;             /*!< [kB/s], 0: no limit                 */
+    double     budget;           /*!< Bytes the sink can take now         */
+    double     last;
+    uint32_t   refuseAbove;      /*!< begin() refuses longer messages     */
+} simSink;
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static uint32_t  gFailures;
+static double    gMs;
+static uint32_t  gFrames;
+
+static simSide   gA;             /*!< Initiator, SNEP client */
+static simSide   gB;             /*!< Target, SNEP server    */
+
+static uint8_t   gMsg[MSG_MAX];
+static uint32_t  gGetLength;
+static simSink   gSink[2];       /*!< Client (GET response), server (PUT request) */
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+LLCP_INSTANCE_DECLARE( A );
+LLCP_INSTANCE_DECLARE( B );
+SNEP_INSTANCE_DECLARE( A );
+SNEP_INSTANCE_DECLARE( B );
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+static uint8_t simPattern( uint32_t i )
+{
+    return (uint8_t)((i * 7U) + (i / 251U));
+}
+
+static ReturnCode simSinkBegin( simSink* sink, uint32_t length )
+{
+    if( length > sink->refuseAbove )
+    {
+        return ERR_NOMEM;
+    }
+    sink->length = length;
+    sink->got    = 0;
+    sink->ended  = false;
+    sink->budget = 0.0;
+    sink->last   = gMs;
+    return ERR_NONE;
+}
+
+static ReturnCode simSinkData( simSink* sink, const uint8_t* buf, uint16_t len )
+{
+    uint16_t i;
+
+    if( sink->rate > 0.0 )
+    {
+        sink->budget += (gMs - sink->last) * sink->rate;
+        sink->last    = gMs;
+        if( sink->budget > SINK_BURST )
+        {
+            sink->budget = SINK_BURST;
+        }
+        if( sink->budget < (double)len )
+        {
+            return ERR_BUSY;
+        }
+        sink->budget -= (double)len;
+    }
+
+    for( i = 0; i < len; i++ )
+    {
+        if( buf[i] != simPattern( sink->got + i ) )
+        {
+            sink->errors++;
+        }
+    }
+    sink->got += len;
+    return ERR_NONE;
+}
+
+static void simSinkEnd( simSink* sink, ReturnCode err )
+{
+    sink->ended  = true;
+    sink->endErr = err;
+}
+
+static ReturnCode simBegin0( uint8_t code, uint32_t length )         { (void)code; return simSinkBegin( &gSink[0], length ); }
+static ReturnCode simData0( const uint8_t* buf, uint16_t len )       { return simSinkData( &gSink[0], buf, len ); }
+static void       simEnd0( ReturnCode err )                          { simSinkEnd( &gSink[0], err ); }
+static ReturnCode simBegin1( uint8_t code, uint32_t length )         { (void)code; return simSinkBegin( &gSink[1], length ); }
+static ReturnCode simData1( const uint8_t* buf, uint16_t len )       { return simSinkData( &gSink[1], buf, len ); }
+static void       simEnd1( ReturnCode err )                          { simSinkEnd( &gSink[1], err ); }
+
+static const snepSink gClientSink = { simBegin0, simData0, simEnd0 };
+static const snepSink gServerSink = { simBegin1, simData1, simEnd1 };
+
+static ReturnCode simGetResponse( ndefConstBuffer* message )
+{
+    message->buffer = gMsg;
+    message->length = gGetLength;
+    return ERR_NONE;
+}
+
+static snepServerConfig gServerConfig = { &gServerSink, simGetResponse };
+
+static void simSend( simSide* side, const uint8_t* frame, uint16_t length )
+{
+    ST_MEMCPY( side->tx, frame, length );
+    side->txLen     = length;
+    side->deliverAt = gMs + SIM_LATENCY + ((double)(length + SIM_DEP_OVERHEAD) * SIM_BYTE_MS);
+}
+
+static ReturnCode simReceive( simSide* from, simSide* to )
+{
+    if( (from->deliverAt < 0.0) || (gMs < from->deliverAt) )
+    {
+        return ERR_BUSY;
+    }
+    ST_MEMCPY( to->rx, from->tx, from->txLen );
+    to->rxLen       = from->txLen;
+    from->deliverAt = -1.0;
+    return ERR_NONE;
+}
+
+/* Bind the client and the server, activate the link */
+static void simSetup( void )
+{
+    static rfalNfcDevice devA;
+    static rfalNfcDevice devB;
+
+    ST_MEMSET( gSink, 0x00, sizeof(gSink) );
+    gSink[0].refuseAbove = UINT32_MAX;
+    gSink[1].refuseAbove = UINT32_MAX;
+    gA.deliverAt = -1.0;
+    gB.deliverAt = -1.0;
+    gMs          = 0.0;
+    gFrames      = 0;
+
+    CHECK( A_llcpInit() == ERR_NONE );
+    CHECK( B_llcpInit() == ERR_NONE );
+    CHECK( A_snepClientIni() == ERR_NONE );
+    CHECK( B_snepServerIni( &gServerConfig ) == ERR_NONE );
+
+    ST_MEMSET( &devA, 0x00, sizeof(devA) );
+    devA.type        = RFAL_NFC_LISTEN_TYPE_NFCA;
+    devA.rfInterface = RFAL_NFC_INTERFACE_NFCDEP;
+    devA.proto.nfcDep.info.GBLen = B_llcpGetGeneralBytes( devA.proto.nfcDep.activation.Target.ATR_RES.GBt, RFAL_NFCDEP_GB_MAX_LEN );
+
+    ST_MEMSET( &devB, 0x00, sizeof(devB) );
+    devB.type        = RFAL_NFC_POLL_TYPE_NFCA;
+    devB.rfInterface = RFAL_NFC_INTERFACE_NFCDEP;
+    devB.proto.nfcDep.info.GBLen = A_llcpGetGeneralBytes( devB.proto.nfcDep.activation.Initiator.ATR_REQ.GBi, RFAL_NFCDEP_GB_MAX_LEN );
+
+    CHECK( A_llcpActivate( &devA ) == ERR_NONE );
+    CHECK( B_llcpActivate( &devB ) == ERR_NONE );
+}
+
+/* Run the workers until the client request completes */
+static ReturnCode simRun( void )
+{
+    double     end = gMs + SIM_TIMEOUT;
+    ReturnCode status;
+
+    while( ((status = A_snepClientGetStatus()) == ERR_BUSY) && (gMs < end) )
+    {
+        A_llcpWorker();
+        A_snepWorker();
+        B_llcpWorker();
+        B_snepWorker();
+        gMs += SIM_STEP;
+    }
+    return status;
+}
+
+/* PUT or GET of a message of the given length */
+static void testTransfer( bool get, uint32_t length, double sinkRate )
+{
+    ndefConstBuffer message = { gMsg, length };
+    ndefConstBuffer request = { gMsg, 16U };
+    snepStats       statsA;
+    snepStats       statsB;
+    simSink*        sink;
+    ReturnCode      status;
+    double          start;
+    double          kBps;
+
+    simSetup();
+    gSink[0].rate = sinkRate;
+    gSink[1].rate = sinkRate;
+    sink          = get ? &gSink[0] : &gSink[1];
+
+    start = gMs;
+    if( get )
+    {
+        gGetLength = length;
+        CHECK( A_snepClientGet( &request, MSG_MAX, &gClientSink ) == ERR_NONE );
+    }
+    else
+    {
+        CHECK( A_snepClientPut( &message ) == ERR_NONE );
+    }
+    status = simRun();
+    kBps   = (double)length / (gMs - start);
+
+    A_snepGetStats( &statsA );
+    B_snepGetStats( &statsB );
+    printf( "  %s %5lu B%s: %7.1f ms, %5.1f kB/s, %4lu frames, fragments %3lu, sink busy %3lu\n",
+            get ? "GET" : "PUT", (unsigned long)length, (sinkRate > 0.0) ? " (slow sink)" : "            ",
+            gMs - start, kBps, (unsigned long)gFrames,
+            (unsigned long)(get ? statsB.fragTx : statsA.fragTx), (unsigned long)(get ? statsA.sinkBusy : statsB.sinkBusy) );
+
+    CHECK( status == ERR_NONE );
+    CHECK( sink->ended && (sink->endErr == ERR_NONE) );
+    CHECK( (sink->length == length) && (sink->got == length) );
+    CHECK( sink->errors == 0U );
+    CHECK( (get ? statsB.fragTx : statsA.fragTx) == (get ? statsA.fragRx : statsB.fragRx) );
+    CHECK( (statsA.rejected == 0U) && (statsB.rejected == 0U) );
+    if( sinkRate > 0.0 )
+    {
+        CHECK( (get ? statsA.sinkBusy : statsB.sinkBusy) != 0U );
+        CHECK( kBps <= (sinkRate * 1.1) );
+    }
+    else if( length >= 4096U )
+    {
+        CHECK( kBps >= MIN_THROUGHPUT );
+    }
+}
+
+/* Requests the server refuses, then requests on the same connection */
+static void testRefused( void )
+{
+    ndefConstBuffer request = { gMsg, 16U };
+    ndefConstBuffer message = { gMsg, 8192U };
+    ReturnCode      status;
+
+    /* GET with no handler */
+    gServerConfig.getResponse = NULL;
+    simSetup();
+    CHECK( A_snepClientGet( &request, 100U, &gClientSink ) == ERR_NONE );
+    status = simRun();
+    printf( "  GET not implemented: %d\n", status );
+    CHECK( status == ERR_NOTSUPP );
+    CHECK( !gSink[0].ended );
+
+    /* GET response longer than the acceptable length */
+    gServerConfig.getResponse = simGetResponse;
+    gGetLength                = 8192U;
+    simSetup();
+    CHECK( A_snepClientGet( &request, 100U, &gClientSink ) == ERR_NONE );
+    status = simRun();
+    printf( "  GET excess data: %d\n", status );
+    CHECK( status == ERR_NOMEM );
+    CHECK( !gSink[0].ended );
+
+    /* PUT refused by the server sink, then accepted on the same connection */
+    simSetup();
+    gSink[1].refuseAbove = 4096U;
+    CHECK( A_snepClientPut( &message ) == ERR_NONE );
+    status = simRun();
+    printf( "  PUT refused: %d\n", status );
+    CHECK( status == ERR_REQUEST );
+    CHECK( !gSink[1].ended );
+
+    message.length = 1000U;
+    CHECK( A_snepClientPut( &message ) == ERR_NONE );
+    status = simRun();
+    printf( "  PUT after a refused one: %d, %lu B\n", status, (unsigned long)gSink[1].got );
+    CHECK( status == ERR_NONE );
+    CHECK( gSink[1].ended && (gSink[1].got == 1000U) && (gSink[1].errors == 0U) );
+
+    message.length = 8192U;
+    CHECK( A_snepClientPut( &message ) == ERR_NONE );
+    CHECK( simRun() == ERR_REQUEST );
+
+    message.length = 3000U;
+    CHECK( A_snepClientPut( &message ) == ERR_NONE );
+    CHECK( simRun() == ERR_NONE );
+    CHECK( (gSink[1].got == 3000U) && (gSink[1].errors == 0U) );
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+uint32_t HAL_GetTick( void )
+{
+    return (uint32_t)gMs;
+}
+
+ReturnCode A_rfalNfcDataExchangeStart( uint8_t* txData, uint16_t txDataLen, uint8_t** rxData, uint16_t** rvdLen, uint32_t fwt )
+{
+    (void)fwt;
+    CHECK( txDataLen <= SIM_FRAME_MAX );
+
+    simSend( &gA, txData, txDataLen );
+    *rxData = gA.rx;
+    *rvdLen = &gA.rxLen;
+    gFrames++;
+    return ERR_NONE;
+}
+
+ReturnCode A_rfalNfcDataExchangeGetStatus( void )
+{
+    return simReceive( &gB, &gA );
+}
+
+ReturnCode B_rfalNfcDataExchangeStart( uint8_t* txData, uint16_t txDataLen, uint8_t** rxData, uint16_t** rvdLen, uint32_t fwt )
+{
+    (void)fwt;
+    CHECK( txDataLen <= SIM_FRAME_MAX );
+
+    /* The Target's first call only starts the reception */
+    if( txDataLen != 0U )
+    {
+        simSend( &gB, txData, txDataLen );
+    }
+    *rxData = gB.rx;
+    *rvdLen = &gB.rxLen;
+    return ERR_NONE;
+}
+
+ReturnCode B_rfalNfcDataExchangeGetStatus( void )
+{
+    return simReceive( &gA, &gB );
+}
+
+int main( void )
+{
+    uint32_t i;
+    uint32_t length;
+
+    for( i = 0; i < MSG_MAX; i++ )
+    {
+        gMsg[i] = simPattern( i );
+    }
+
+    printf( "LLCP_RW %u, LLCP_MIU %u, turnaround %.1f ms\n", LLCP_RW, LLCP_MIU, SIM_LATENCY );
+
+    testTransfer( false, 100U, 0.0 );
+    testTransfer( true,  100U, 0.0 );
+    for( length = 1024U; length <= MSG_MAX; length *= 4U )
+    {
+        testTransfer( false, length, 0.0 );
+        testTransfer( true,  length, 0.0 );
+    }
+    testTransfer( false, 16384U, SLOW_SINK_RATE );
+    testTransfer( true,  16384U, SLOW_SINK_RATE );
+
+    testRefused();
+
+    printf( "%s\n", (gFailures == 0U) ? "PASS" : "FAIL" );
+    return (gFailures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,264 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \brief Host test of the Type 4 Tag emulation engine
+ *
+ *  Plays the C-APDU scripts of a T4T reader against nfc_t4t_ce.c: the NDEF
+ *  read procedure with several Le, the NDEF update procedure, then the
+ *  commands the engine must refuse and the status word of each. The time
+ *  taken by t4tCeProcess() for the common commands is printed.
+ *
+ *  Run by Tools/run_host_tests.sh
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <time.h>
+#include "platform.h"
+#include "../Src/nfc_t4t_ce.c"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define NDEF_FILE_SIZE         1024U
+#define MSG_LEN                1000U
+#define BENCH_ITERATIONS       1000000U
+
+#define CHECK( cond )          do { if( !(cond) ) { printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond ); gFailures++; } } while(0)
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static uint32_t      gFailures;
+static t4tCe         gCe;
+static uint8_t       gFile[NDEF_FILE_SIZE];
+static uint8_t       gMsg[MSG_LEN];
+static t4tCeResponse gRsp;
+
+static const uint8_t gSelectApp[]  = { 0x00, 0xA4, 0x04, 0x00, 0x07, 0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01, 0x00 };
+static const uint8_t gSelectCc[]   = { 0x00, 0xA4, 0x00, 0x0C, 0x02, 0xE1, 0x03 };
+static const uint8_t gSelectNdef[] = { 0x00, 0xA4, 0x00, 0x0C, 0x02, 0xE1, 0x04 };
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+static uint16_t simApdu( const uint8_t* capdu, uint16_t len )
+{
+    t4tCeProcess( &gCe, capdu, len, &gRsp );
+    return gRsp.sw;
+}
+
+static uint16_t simReadBinary( uint16_t offset, uint8_t le )
+{
+    uint8_t capdu[5] = { 0x00, 0xB0, (uint8_t)(offset >> 8U), (uint8_t)offset, le };
+
+    return simApdu( capdu, sizeof(capdu) );
+}
+
+static uint16_t simUpdateBinary( uint16_t offset, const uint8_t* data, uint8_t len )
+{
+    uint8_t capdu[5U + 255U] = { 0x00, 0xD6, (uint8_t)(offset >> 8U), (uint8_t)offset, len };
+
+    ST_MEMCPY( &capdu[5], data, len );
+    return simApdu( capdu, (uint16_t)(5U + len) );
+}
+
+/* NDEF read procedure of the T4T specification, Le bytes at a time */
+static uint16_t simReadNdef( uint8_t* out, uint8_t le )
+{
+    uint16_t nlen;
+    uint16_t offset;
+
+    CHECK( simApdu( gSelectApp, sizeof(gSelectApp) ) == T4T_CE_SW_OK );
+    CHECK( simApdu( gSelectCc, sizeof(gSelectCc) ) == T4T_CE_SW_OK );
+    CHECK( (simReadBinary( 0, T4T_CE_CC_LEN ) == T4T_CE_SW_OK) && (gRsp.len == T4T_CE_CC_LEN) );
+    CHECK( (((uint16_t)gRsp.data[3] << 8U) | gRsp.data[4]) == T4T_CE_MLE );
+    CHECK( simApdu( gSelectNdef, sizeof(gSelectNdef) ) == T4T_CE_SW_OK );
+    CHECK( (simReadBinary( 0, T4T_CE_NLEN_LEN ) == T4T_CE_SW_OK) && (gRsp.len == T4T_CE_NLEN_LEN) );
+    nlen = (uint16_t)(((uint16_t)gRsp.data[0] << 8U) | gRsp.data[1]);
+
+    for( offset = 0; offset < nlen; offset += gRsp.len )
+    {
+        if( (simReadBinary( (uint16_t)(T4T_CE_NLEN_LEN + offset), le ) != T4T_CE_SW_OK) || (gRsp.len == 0U) )
+        {
+            CHECK( false );
+            break;
+        }
+        ST_MEMCPY( &out[offset], gRsp.data, gRsp.len );
+    }
+    return nlen;
+}
+
+static void testRead( void )
+{
+    static const uint8_t le[] = { 1U, 16U, 59U, 200U, 255U };
+    uint8_t  out[MSG_LEN];
+    uint8_t  i;
+
+    gFile[0] = 0x01U;
+    gFile[1] = 0x00U;
+    ST_MEMCPY( &gFile[T4T_CE_NLEN_LEN], gMsg, 256U );
+    CHECK( t4tCeIni( &gCe, gFile, 1U, false ) == ERR_PARAM );
+    CHECK( t4tCeIni( &gCe, gFile, sizeof(gFile), false ) == ERR_NONE );
+
+    for( i = 0; i < sizeof(le); i++ )
+    {
+        ST_MEMSET( out, 0x00, sizeof(out) );
+        CHECK( simReadNdef( out, le[i] ) == 256U );
+        CHECK( ST_BYTECMP( out, gMsg, 256U ) == 0 );
+    }
+
+    /* The response data is the file image itself */
+    CHECK( (simReadBinary( T4T_CE_NLEN_LEN, 10U ) == T4T_CE_SW_OK) && (gRsp.data == &gFile[T4T_CE_NLEN_LEN]) );
+}
+
+/* NDEF update procedure: NLEN 0, the message, then NLEN */
+static void testUpdate( void )
+{
+    static const uint8_t zero[T4T_CE_NLEN_LEN] = { 0x00, 0x00 };
+    uint8_t  nlen[T4T_CE_NLEN_LEN] = { (uint8_t)(MSG_LEN >> 8U), (uint8_t)MSG_LEN };
+    uint8_t  out[MSG_LEN];
+    uint16_t offset;
+
+    t4tCeReset( &gCe );
+    CHECK( simApdu( gSelectNdef, sizeof(gSelectNdef) ) == T4T_CE_SW_NOT_FOUND );
+    CHECK( simApdu( gSelectApp, sizeof(gSelectApp) ) == T4T_CE_SW_OK );
+    CHECK( simApdu( gSelectNdef, sizeof(gSelectNdef) ) == T4T_CE_SW_OK );
+
+    CHECK( simUpdateBinary( 0, zero, sizeof(zero) ) == T4T_CE_SW_OK );
+    for( offset = 0; offset < MSG_LEN; offset += 200U )
+    {
+        CHECK( simUpdateBinary( (uint16_t)(T4T_CE_NLEN_LEN + offset), &gMsg[offset], (uint8_t)MIN( 200U, MSG_LEN - offset ) ) == T4T_CE_SW_OK );
+    }
+    CHECK( simUpdateBinary( 0, nlen, sizeof(nlen) ) == T4T_CE_SW_OK );
+
+    CHECK( simReadNdef( out, 255U ) == MSG_LEN );
+    CHECK( ST_BYTECMP( out, gMsg, MSG_LEN ) == 0 );
+}
+
+static void testErrors( void )
+{
+    static const uint8_t zero[T4T_CE_NLEN_LEN] = { 0x00, 0x00 };
+    static const uint8_t badCla[]   = { 0x80, 0xB0, 0x00, 0x00, 0x02 };
+    static const uint8_t badIns[]   = { 0x00, 0xCA, 0x00, 0x00, 0x02 };
+    static const uint8_t badOff[]   = { 0x00, 0xB0, 0x7F, 0xFF, 0x02 };
+    static const uint8_t badAid[]   = { 0x00, 0xA4, 0x04, 0x00, 0x07, 0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x02 };
+    static const uint8_t badFid[]   = { 0x00, 0xA4, 0x00, 0x0C, 0x02, 0xE1, 0x05 };
+    static const uint8_t shortLc[]  = { 0x00, 0xA4, 0x00, 0x0C, 0x03, 0xE1, 0x04 };
+
+    CHECK( simApdu( badCla, sizeof(badCla) ) == T4T_CE_SW_CLA_NOT_SUPPORTED );
+    CHECK( simApdu( badIns, sizeof(badIns) ) == T4T_CE_SW_INS_NOT_SUPPORTED );
+    CHECK( simApdu( badOff, sizeof(badOff) ) == T4T_CE_SW_WRONG_OFFSET );
+    CHECK( simApdu( badAid, sizeof(badAid) ) == T4T_CE_SW_NOT_FOUND );
+
+    /* A failed SELECT leaves no current EF */
+    CHECK( simApdu( gSelectApp, sizeof(gSelectApp) ) == T4T_CE_SW_OK );
+    CHECK( simApdu( badFid, sizeof(badFid) ) == T4T_CE_SW_NOT_FOUND );
+    CHECK( simReadBinary( 0, 2U ) == T4T_CE_SW_NO_FILE_SELECTED );
+
+    /* Truncated APDUs */
+    CHECK( simApdu( shortLc, sizeof(shortLc) ) == T4T_CE_SW_WRONG_LENGTH );
+    CHECK( simApdu( badCla, 3U ) == T4T_CE_SW_WRONG_LENGTH );
+
+    /* The CC file is read only, the NDEF file ends where it ends */
+    CHECK( simApdu( gSelectCc, sizeof(gSelectCc) ) == T4T_CE_SW_OK );
+    CHECK( simUpdateBinary( 0, zero, sizeof(zero) ) == T4T_CE_SW_NOT_ALLOWED );
+    CHECK( simApdu( gSelectNdef, sizeof(gSelectNdef) ) == T4T_CE_SW_OK );
+    CHECK( (simUpdateBinary( NDEF_FILE_SIZE - 1U, zero, sizeof(zero) ) == T4T_CE_SW_WRONG_LENGTH) || (gRsp.sw == T4T_CE_SW_WRONG_OFFSET) );
+
+    /* Read-only tag */
+    CHECK( t4tCeIni( &gCe, gFile, sizeof(gFile), true ) == ERR_NONE );
+    CHECK( simApdu( gSelectApp, sizeof(gSelectApp) ) == T4T_CE_SW_OK );
+    CHECK( simApdu( gSelectNdef, sizeof(gSelectNdef) ) == T4T_CE_SW_OK );
+    CHECK( simUpdateBinary( 0, zero, sizeof(zero) ) == T4T_CE_SW_NOT_ALLOWED );
+    CHECK( gCe.stats.errors != 0U );
+}
+
+static double simBench( const uint8_t* capdu, uint16_t len )
+{
+    struct timespec start;
+    struct timespec end;
+    uint32_t        i;
+
+    clock_gettime( CLOCK_MONOTONIC, &start );
+    for( i = 0; i < BENCH_ITERATIONS; i++ )
+    {
+        t4tCeProcess( &gCe, capdu, len, &gRsp );
+        __asm__ volatile( "" : : "r"(gRsp.data) : "memory" );
+    }
+    clock_gettime( CLOCK_MONOTONIC, &end );
+
+    return (((double)(end.tv_sec - start.tv_sec) * 1e9) + (double)(end.tv_nsec - start.tv_nsec)) / BENCH_ITERATIONS;
+}
+
+static void testTiming( void )
+{
+    static const uint8_t read[]   = { 0x00, 0xB0, 0x00, 0x02, 0xF6 };
+    static const uint8_t badIns[] = { 0x00, 0xCA, 0x00, 0x00, 0x02 };
+    static uint8_t       update[5U + 246U] = { 0x00, 0xD6, 0x00, 0x02, 0xF6 };
+
+    CHECK( t4tCeIni( &gCe, gFile, sizeof(gFile), false ) == ERR_NONE );
+    CHECK( simApdu( gSelectApp, sizeof(gSelectApp) ) == T4T_CE_SW_OK );
+    CHECK( simApdu( gSelectNdef, sizeof(gSelectNdef) ) == T4T_CE_SW_OK );
+
+    printf( "  SELECT app  %6.1f ns\n", simBench( gSelectApp, sizeof(gSelectApp) ) );
+    printf( "  SELECT NDEF %6.1f ns\n", simBench( gSelectNdef, sizeof(gSelectNdef) ) );
+    printf( "  READ 246    %6.1f ns\n", simBench( read, sizeof(read) ) );
+    printf( "  UPDATE 246  %6.1f ns\n", simBench( update, sizeof(update) ) );
+    printf( "  unknown INS %6.1f ns\n", simBench( badIns, sizeof(badIns) ) );
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+int main( void )
+{
+    uint32_t i;
+
+    for( i = 0; i < MSG_LEN; i++ )
+    {
+        gMsg[i] = (uint8_t)((i * 7U) + 3U);
+    }
+
+    testRead();
+    testUpdate();
+    testErrors();
+    testTiming();
+
+    printf( "%s\n", (gFailures == 0U) ? "PASS" : "FAIL" );
+    return (gFailures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,485 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \brief Host test of the Wake-Up mode reference tracking
+ *
+ *  The ST25R3916 antenna measures and the Wake-Up mode comparison are
+ *  modelled on a synthetic 24 h trace: slow temperature drift, noise, tags
+ *  presented for a few seconds and metal objects left on the antenna. The
+ *  demo flow of ndef_demo.c (Wake-Up mode, discovery window, tag handling)
+ *  drives nfc_wakeup.c and is compared with continuous polling.
+ *
+ *  Run by Tools/run_host_tests.sh
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdlib.h>
+#include "platform.h"
+#include "../Src/nfc_wakeup.c"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define SIM_DURATION           (24UL * 3600UL * 1000UL) /*!< Simulated time [ms]                  */
+#define SIM_MAX_EVENTS         1024                    /*!< Tags and objects in the trace         */
+#define SIM_RAMP               300U                    /*!< Approach and removal time [ms]        */
+#define SIM_WUM_PERIOD         200U                    /*!< NFC_WAKEUP_PERIOD [ms]                */
+
+#define DISCOVERY_WINDOW       1200U                   /*!< DEMO_WAKEUP_DISCOVERY_WINDOW [ms]     */
+#define DISCOVERY_PERIOD       100U                    /*!< DEMO_WAKEUP_DISCOVERY_PERIOD [ms]     */
+#define CONTINUOUS_PERIOD      1000U                   /*!< Poll period without Wake-Up mode [ms] */
+#define TAG_HANDLING           150U                    /*!< Tag read time [ms]                    */
+
+#define MAX_FALSE_WAKES_PER_H  40U                     /*!< Discovery runs finding nothing        */
+#define MAX_LATENCY            (SIM_RAMP + SIM_WUM_PERIOD) /*!< Tag presented to tag read [ms]    */
+
+#define CHECK( cond )          do { if( !(cond) ) { printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond ); gFailures++; } } while(0)
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! Tag presented or object left on the antenna */
+typedef struct
+{
+    uint32_t start;       /*!< Approach start [ms]                      */
+    uint32_t end;         /*!< Removal start [ms]                       */
+    int8_t   amplitude;   /*!< Amplitude shift once on the antenna      */
+    int8_t   phase;       /*!< Phase shift once on the antenna          */
+    bool     tag;         /*!< A readable tag, not a metal object       */
+    bool     detected;    /*!< Read at least once                       */
+} simEvent;
+
+/*! Antenna conditions */
+typedef struct
+{
+    const char *name;
+    double      drift;    /*!< Temperature drift scale                  */
+    double      noise;    /*!< Standard deviation of a conversion       */
+} simScenario;
+
+/*! Demo results */
+typedef struct
+{
+    uint32_t polls;
+    uint32_t detected;
+    uint32_t missed;
+    uint32_t latencySum;
+    uint32_t latencyMax;
+} simResult;
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static uint32_t    gNow;
+static uint32_t    gFailures;
+static uint32_t    gRandom;
+
+static simEvent    gEvents[SIM_MAX_EVENTS];
+static uint32_t    gNbEvents;
+static uint32_t    gCurEvent;
+static simScenario gScenario;
+
+static rfalWakeUpConfig gWumCfg;
+static bool        gWumOn;
+static bool        gWumWoke;
+static uint32_t    gWumNext;
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+static double simUniform( void )
+{
+    gRandom = (gRandom * 1103515245U) + 12345U;
+    return (double)((gRandom >> 8) & 0xFFFFFFU) / (double)0x1000000;
+}
+
+static double simGauss( void )
+{
+    return (simUniform() + simUniform() + simUniform() + simUniform() - 2.0) * 1.22;
+}
+
+/* Tags held a few seconds, 10% metal objects left for 10 to 30 minutes */
+static void simBuildTrace( void )
+{
+    uint32_t t = 60000U;
+    simEvent *ev;
+
+    gNbEvents = 0;
+    gCurEvent = 0;
+    while( (t < (SIM_DURATION - 60000U)) && (gNbEvents < SIM_MAX_EVENTS) )
+    {
+        ev = &gEvents[gNbEvents++];
+        ev->start    = t;
+        ev->detected = false;
+        if( simUniform() < 0.1 )
+        {
+            ev->tag       = false;
+            ev->amplitude = (int8_t)-(4 + (int)(simUniform() * 4.0));
+            ev->phase     = (int8_t)(2 + (int)(simUniform() * 3.0));
+            ev->end       = t + 600000U + (uint32_t)(simUniform() * 1200000.0);
+        }
+        else
+        {
+            ev->tag       = true;
+            ev->amplitude = (int8_t)-(4 + (int)(simUniform() * 10.0));
+            ev->phase     = (int8_t)(3 + (int)(simUniform() * 8.0));
+            ev->end       = t + 2000U + (uint32_t)(simUniform() * 6000.0);
+        }
+        t = ev->end + 60000U + (uint32_t)(simUniform() * 900000.0);
+    }
+}
+
+/* Event on the antenna at gNow, NULL if none: the time only moves forward */
+static simEvent *simEventNow( void )
+{
+    while( (gCurEvent < gNbEvents) && (gNow >= (gEvents[gCurEvent].end + SIM_RAMP)) )
+    {
+        gCurEvent++;
+    }
+    if( (gCurEvent < gNbEvents) && (gNow >= gEvents[gCurEvent].start) )
+    {
+        return &gEvents[gCurEvent];
+    }
+    return NULL;
+}
+
+static uint8_t simMeasure( uint8_t meas )
+{
+    simEvent *ev = simEventNow();
+    double    h  = (double)gNow / 3600000.0;
+    double    env;
+    double    v;
+
+    if( meas == NFC_WAKEUP_MEAS_AMPLITUDE )
+    {
+        v = 140.0 + (gScenario.drift * ((6.0 * sin((2.0 * M_PI * h) / 4.0)) + (3.0 * sin(((2.0 * M_PI * h) / 9.0) + 1.0))));
+    }
+    else
+    {
+        v = 100.0 + (gScenario.drift * (4.0 * sin(((2.0 * M_PI * h) / 5.0) + 2.0)));
+    }
+    v += gScenario.noise * simGauss();
+
+    if( ev != NULL )
+    {
+        if( gNow < (ev->start + SIM_RAMP) )
+        {
+            env = (double)(gNow - ev->start) / (double)SIM_RAMP;
+        }
+        else if( gNow >= ev->end )
+        {
+            env = 1.0 - ((double)(gNow - ev->end) / (double)SIM_RAMP);
+        }
+        else
+        {
+            env = 1.0;
+        }
+        v += env * (double)((meas == NFC_WAKEUP_MEAS_AMPLITUDE) ? ev->amplitude : ev->phase);
+    }
+
+    return (uint8_t)lrint( v );
+}
+
+static simEvent *simTagReadable( void )
+{
+    simEvent *ev = simEventNow();
+
+    if( (ev != NULL) && ev->tag && (gNow >= (ev->start + SIM_RAMP)) && (gNow < ev->end) )
+    {
+        return ev;
+    }
+    return NULL;
+}
+
+/* Wake-Up mode: one measure per period compared with the fixed references */
+static void simWumTick( void )
+{
+    if( !gWumOn || gWumWoke || (gNow < gWumNext) )
+    {
+        return;
+    }
+    gWumNext += SIM_WUM_PERIOD;
+
+    if( gWumCfg.indAmp.enabled && (abs((int)simMeasure( NFC_WAKEUP_MEAS_AMPLITUDE ) - (int)gWumCfg.indAmp.reference) >= (int)gWumCfg.indAmp.delta) )
+    {
+        gWumWoke = true;
+    }
+    if( gWumCfg.indPha.enabled && (abs((int)simMeasure( NFC_WAKEUP_MEAS_PHASE ) - (int)gWumCfg.indPha.reference) >= (int)gWumCfg.indPha.delta) )
+    {
+        gWumWoke = true;
+    }
+}
+
+/* Demo flow, with Wake-Up mode detection or polling continuously */
+static simResult simRun( bool lowPower )
+{
+    enum { ST_START_WAKEUP, ST_WAKEUP, ST_START_DISCOVERY, ST_DISCOVERY, ST_HANDLE } state;
+    simResult res;
+    simEvent *ev;
+    uint32_t  discoveryEnd = 0;
+    uint32_t  nextPoll     = 0;
+    uint32_t  handleEnd    = 0;
+    uint32_t  latency;
+    uint32_t  i;
+
+    ST_MEMSET( &res, 0x00, sizeof(res) );
+    for( i = 0; i < gNbEvents; i++ )
+    {
+        gEvents[i].detected = false;
+    }
+    gCurEvent = 0;
+    gWumOn    = false;
+    gRandom   = 1U;
+    nfcWakeupIni();
+
+    state = lowPower ? ST_START_WAKEUP : ST_START_DISCOVERY;
+    for( gNow = 0; gNow < SIM_DURATION; gNow++ )
+    {
+        simWumTick();
+
+        switch( state )
+        {
+            case ST_START_WAKEUP:
+                CHECK( nfcWakeupStart() == ERR_NONE );
+                state = ST_WAKEUP;
+                break;
+
+            case ST_WAKEUP:
+                if( nfcWakeupHasWoken() )
+                {
+                    state = ST_START_DISCOVERY;
+                }
+                break;
+
+            case ST_START_DISCOVERY:
+                discoveryEnd = gNow + DISCOVERY_WINDOW;
+                nextPoll     = gNow + 20U;
+                state        = ST_DISCOVERY;
+                break;
+
+            case ST_DISCOVERY:
+                if( gNow == nextPoll )
+                {
+                    res.polls++;
+                    nextPoll += lowPower ? DISCOVERY_PERIOD : CONTINUOUS_PERIOD;
+
+                    ev = simTagReadable();
+                    if( ev != NULL )
+                    {
+                        if( !ev->detected )
+                        {
+                            ev->detected = true;
+                            latency = gNow - ev->start;
+                            res.detected++;
+                            res.latencySum += latency;
+                            res.latencyMax = (latency > res.latencyMax) ? latency : res.latencyMax;
+                        }
+                        if( lowPower )
+                        {
+                            nfcWakeupDiscoveryDone( true );
+                        }
+                        handleEnd = gNow + TAG_HANDLING;
+                        state     = ST_HANDLE;
+                        break;
+                    }
+                }
+                if( lowPower && (gNow >= discoveryEnd) )
+                {
+                    nfcWakeupDiscoveryDone( false );
+                    state = ST_START_WAKEUP;
+                }
+                break;
+
+            case ST_HANDLE:
+            default:
+                if( gNow >= handleEnd )
+                {
+                    state = lowPower ? ST_START_WAKEUP : ST_START_DISCOVERY;
+                }
+                break;
+        }
+    }
+
+    for( i = 0; i < gNbEvents; i++ )
+    {
+        if( gEvents[i].tag && !gEvents[i].detected )
+        {
+            res.missed++;
+        }
+    }
+
+    return res;
+}
+
+/* Tracker arithmetic: drift is followed, a step is reported */
+static void testTracker( void )
+{
+    nfcWakeupTracker tracker;
+    uint32_t i;
+
+    nfcWakeupTrackerInit( &tracker, 3U, 2U );
+    CHECK( !nfcWakeupTrackerUpdate( &tracker, 120U ) );
+    CHECK( nfcWakeupTrackerReference( &tracker ) == 120U );
+
+    /* One unit at a time up to 130: always within the delta */
+    for( i = 121U; i <= 130U; i++ )
+    {
+        CHECK( !nfcWakeupTrackerUpdate( &tracker, (uint8_t)i ) );
+        CHECK( !nfcWakeupTrackerUpdate( &tracker, (uint8_t)i ) );
+    }
+    CHECK( nfcWakeupTrackerReference( &tracker ) >= 129U );
+
+    /* A step is reported and does not move the reference */
+    CHECK( nfcWakeupTrackerUpdate( &tracker, 120U ) );
+    CHECK( nfcWakeupTrackerReference( &tracker ) >= 129U );
+
+    nfcWakeupTrackerRebaseline( &tracker, 120U );
+    CHECK( nfcWakeupTrackerReference( &tracker ) == 120U );
+    CHECK( !nfcWakeupTrackerIsOff( &tracker, 122U ) );
+    CHECK( nfcWakeupTrackerIsOff( &tracker, 117U ) );
+
+    /* The reference saturates */
+    nfcWakeupTrackerRebaseline( &tracker, 0xFFU );
+    CHECK( nfcWakeupTrackerReference( &tracker ) == 0xFFU );
+}
+
+static void testScenario( const simScenario *scenario )
+{
+    nfcWakeupStats stats;
+    simResult      wum;
+    simResult      poll;
+    uint32_t       tags = 0;
+    uint32_t       i;
+
+    gScenario = *scenario;
+    gRandom   = 12345U;
+    simBuildTrace();
+    for( i = 0; i < gNbEvents; i++ )
+    {
+        tags += gEvents[i].tag ? 1U : 0U;
+    }
+
+    wum = simRun( true );
+    nfcWakeupGetStats( &stats );
+    poll = simRun( false );
+
+    printf( "%s: %lu tags, %lu objects over 24 h\n", scenario->name, (unsigned long)tags, (unsigned long)(gNbEvents - tags) );
+    printf( "  wake-up    polls %6lu  wakes %5lu  false %5lu (%.1f/h)  read %3lu missed %lu  latency mean %3lu max %3lu ms\n",
+            (unsigned long)wum.polls, (unsigned long)stats.wakes, (unsigned long)stats.falseWakes, (double)stats.falseWakes / 24.0,
+            (unsigned long)wum.detected, (unsigned long)wum.missed,
+            (unsigned long)((wum.detected != 0U) ? (wum.latencySum / wum.detected) : 0U), (unsigned long)wum.latencyMax );
+    printf( "  continuous polls %6lu                              read %3lu missed %lu  latency mean %3lu max %3lu ms\n",
+            (unsigned long)poll.polls, (unsigned long)poll.detected, (unsigned long)poll.missed,
+            (unsigned long)((poll.detected != 0U) ? (poll.latencySum / poll.detected) : 0U), (unsigned long)poll.latencyMax );
+
+    CHECK( wum.missed == 0U );
+    CHECK( wum.detected == tags );
+    CHECK( wum.latencyMax <= MAX_LATENCY );
+    CHECK( stats.falseWakes <= (24U * MAX_FALSE_WAKES_PER_H) );
+    CHECK( (wum.polls * 4U) < poll.polls );
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+uint32_t HAL_GetTick( void )
+{
+    return gNow;
+}
+
+ReturnCode rfalChipMeasureAmplitude( uint8_t *result )
+{
+    *result = simMeasure( NFC_WAKEUP_MEAS_AMPLITUDE );
+    return ERR_NONE;
+}
+
+ReturnCode rfalChipMeasurePhase( uint8_t *result )
+{
+    *result = simMeasure( NFC_WAKEUP_MEAS_PHASE );
+    return ERR_NONE;
+}
+
+ReturnCode rfalChipMeasureCapacitance( uint8_t *result )
+{
+    *result = 0U;
+    return ERR_NONE;
+}
+
+ReturnCode rfalWakeUpModeStart( const rfalWakeUpConfig *config )
+{
+    gWumCfg  = *config;
+    gWumOn   = true;
+    gWumWoke = false;
+    gWumNext = gNow + SIM_WUM_PERIOD;
+    return ERR_NONE;
+}
+
+bool rfalWakeUpModeHasWoke( void )
+{
+    return gWumWoke;
+}
+
+ReturnCode rfalWakeUpModeStop( void )
+{
+    gWumOn   = false;
+    gWumWoke = false;
+    return ERR_NONE;
+}
+
+int main( void )
+{
+    static const simScenario scenarios[] =
+    {
+        { "Nominal",                  1.0, 0.5 },
+        { "Noisy",                    1.0, 1.0 },
+        { "Fast temperature drift",   2.5, 0.7 },
+    };
+    uint32_t i;
+
+    testTracker();
+    for( i = 0; i < (sizeof(scenarios) / sizeof(scenarios[0])); i++ )
+    {
+        testScenario( &scenarios[i] );
+    }
+
+    printf( "%s\n", (gFailures == 0U) ? "PASS" : "FAIL" );
+    return (gFailures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,328 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \brief Host test of the NFC-V multi-tag inventory
+ *
+ *  Up to 64 VICCs answer the 16 slots INVENTORY_REQ of nfcv_inventory.c
+ *  with their UID: a slot is empty, holds one answer, or a collision. A
+ *  lone answer can be corrupted and a read can fail, to exercise the
+ *  retries. Every tag in the field must be found and read. The air time
+ *  of the ISO 15693 frames at 26.48 kbps gives the inventory duration.
+ *
+ *  Run by Tools/run_host_tests.sh
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdlib.h>
+#include "platform.h"
+#include "../Src/nfcv_inventory.c"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define SIM_MAX_TAGS           64U
+#define SIM_RUNS               100U
+
+/* Air time [us]: 1 out of 4 PCD coding, VICC answer at 26.48 kbps, t1 = 320 us */
+#define SIM_T_REQ( maskLen )   ((((4U + (((maskLen) + 7U) / 8U) + 2U) * 8U) * 37.76) + 300.0)
+#define SIM_T_EOF              ((2.0 * 75.52) + 320.0)
+#define SIM_T_RES              ((96.0 * 37.76) + 320.0 + 150.0)
+#define SIM_T_NORES            (320.0 + 300.0)
+#define SIM_T_READ             (8.0 * (SIM_T_REQ( 64U ) + (12.0 * 8.0 * 37.76) + 320.0)) /*!< Select, CC, TLV, NDEF */
+
+#define CHECK( cond )          do { if( !(cond) ) { printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond ); gFailures++; } } while(0)
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static double   gUs;                               /*!< Air and delay time [us]          */
+static uint32_t gFailures;
+
+static uint8_t  gUid[SIM_MAX_TAGS][RFAL_NFCV_UID_LEN];
+static bool     gQuiet[SIM_MAX_TAGS];
+static uint32_t gNbTags;
+
+static uint8_t  gMaskLen;
+static uint8_t  gMask[RFAL_NFCV_UID_LEN];
+static uint8_t  gSlot;
+static double   gCorrupt;                          /*!< Probability a lone answer is corrupted */
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+static double simUniform( void )
+{
+    return (double)rand() / (double)RAND_MAX;
+}
+
+/* The VICC answers when its UID matches the mask and the next 4 bits the slot */
+static bool simMatches( uint32_t t )
+{
+    uint8_t nibble = 0U;
+    uint8_t b;
+
+    for( b = 0; b < gMaskLen; b++ )
+    {
+        if( ((gUid[t][b / 8U] >> (b % 8U)) & 1U) != ((gMask[b / 8U] >> (b % 8U)) & 1U) )
+        {
+            return false;
+        }
+    }
+    for( b = 0; b < 4U; b++ )
+    {
+        nibble |= (uint8_t)(((gUid[t][(gMaskLen + b) / 8U] >> ((gMaskLen + b) % 8U)) & 1U) << b);
+    }
+    return (nibble == gSlot);
+}
+
+static ReturnCode simSlot( rfalNfcvInventoryRes *invRes, uint16_t *rcvLen )
+{
+    uint32_t n   = 0;
+    uint32_t who = 0;
+    uint32_t t;
+
+    for( t = 0; t < gNbTags; t++ )
+    {
+        if( !gQuiet[t] && simMatches( t ) )
+        {
+            n++;
+            who = t;
+        }
+    }
+
+    if( n == 0U )
+    {
+        gUs += SIM_T_NORES;
+        *rcvLen = 0;
+        return ERR_TIMEOUT;
+    }
+
+    gUs += SIM_T_RES;
+    if( (n == 1U) && (simUniform() >= gCorrupt) )
+    {
+        ST_MEMSET( invRes, 0x00, sizeof(rfalNfcvInventoryRes) );
+        ST_MEMCPY( invRes->UID, gUid[who], RFAL_NFCV_UID_LEN );
+        *rcvLen = NFCV_INVENTORY_RES_BITS;
+        return ERR_NONE;
+    }
+
+    *rcvLen = 20U;
+    return (n == 1U) ? ERR_CRC : ERR_RF_COLLISION;
+}
+
+static void simField( uint32_t nbTags, bool sequential )
+{
+    uint32_t t;
+    uint8_t  b;
+
+    gNbTags = nbTags;
+    for( t = 0; t < nbTags; t++ )
+    {
+        for( b = 0; b < RFAL_NFCV_UID_LEN; b++ )
+        {
+            gUid[t][b] = (uint8_t)rand();
+        }
+        if( sequential )
+        {
+            /* Same batch: only the first byte differs */
+            gUid[t][0] = (uint8_t)t;
+            for( b = 1; b < 6U; b++ )
+            {
+                gUid[t][b] = (uint8_t)(0x11U * b);
+            }
+        }
+        gUid[t][6] = 0x02U;
+        gUid[t][7] = 0xE0U;
+        gQuiet[t]  = false;
+    }
+}
+
+static void testField( uint32_t nbTags, bool sequential, double corrupt )
+{
+    static nfcvInventory inv;
+    rfalNfcDevice dev;
+    uint8_t  idx;
+    uint32_t run;
+    uint32_t t;
+    uint32_t i;
+    uint32_t found;
+    uint32_t unread   = 0;
+    uint32_t requests = 0;
+    uint32_t missing  = 0;
+    double   invMs    = 0.0;
+    double   readMs   = 0.0;
+
+    gCorrupt = corrupt;
+    srand( 1234U + nbTags );
+
+    for( run = 0; run < SIM_RUNS; run++ )
+    {
+        simField( nbTags, sequential );
+
+        gUs = 0.0;
+        nfcvInventoryIni( &inv );
+        (void)nfcvInventoryRun( &inv );
+        invMs    += gUs / 1000.0;
+        requests += inv.stats.requests;
+        CHECK( inv.stats.dropped == 0U );
+
+        /* Every tag of the field found once */
+        found = 0;
+        for( t = 0; t < nbTags; t++ )
+        {
+            for( i = 0; i < inv.tagCnt; i++ )
+            {
+                if( ST_BYTECMP( inv.tag[i].invRes.UID, gUid[t], RFAL_NFCV_UID_LEN ) == 0 )
+                {
+                    found++;
+                    break;
+                }
+            }
+        }
+        CHECK( inv.tagCnt == nbTags );
+        missing += nbTags - found;
+
+        /* Reads fail twice as often as the inventory answers */
+        while( nfcvInventoryNextDevice( &inv, &dev, &idx ) )
+        {
+            CHECK( dev.type == RFAL_NFC_LISTEN_TYPE_NFCV );
+            CHECK( ST_BYTECMP( dev.dev.nfcv.InvRes.UID, inv.tag[idx].invRes.UID, RFAL_NFCV_UID_LEN ) == 0 );
+            gUs += SIM_T_READ;
+            nfcvInventoryReadDone( &inv, idx, (simUniform() < (2.0 * corrupt)) ? ERR_TIMEOUT : ERR_NONE );
+        }
+        readMs += gUs / 1000.0;
+
+        for( i = 0; i < inv.tagCnt; i++ )
+        {
+            CHECK( inv.tag[i].state != NFCV_INVENTORY_TAG_PENDING );
+            unread += (inv.tag[i].state != NFCV_INVENTORY_TAG_READ) ? 1U : 0U;
+        }
+    }
+
+    printf( "  %2lu tags: %5.1f requests, inventory %6.1f ms, all read %6.1f ms, unread %lu\n",
+            (unsigned long)nbTags, (double)requests / SIM_RUNS, invMs / SIM_RUNS, readMs / SIM_RUNS, (unsigned long)unread );
+
+    CHECK( missing == 0U );
+    if( corrupt == 0.0 )
+    {
+        CHECK( unread == 0U );
+    }
+    else
+    {
+        /* 3 reads failing in a row */
+        CHECK( unread <= ((SIM_RUNS * nbTags) / 100U) + 1U );
+    }
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+uint32_t HAL_GetTick( void )
+{
+    return (uint32_t)(gUs / 1000.0);
+}
+
+void HAL_Delay( uint32_t Delay )
+{
+    gUs += (double)Delay * 1000.0;
+}
+
+ReturnCode rfalNfcvPollerInventory( rfalNfcvNumSlots nSlots, uint8_t maskLen, const uint8_t *maskVal, rfalNfcvInventoryRes *invRes, uint16_t *rcvdLen )
+{
+    CHECK( nSlots == RFAL_NFCV_NUM_SLOTS_16 );
+
+    gMaskLen = maskLen;
+    ST_MEMSET( gMask, 0x00, sizeof(gMask) );
+    if( maskVal != NULL )
+    {
+        ST_MEMCPY( gMask, maskVal, (maskLen + 7U) / 8U );
+    }
+    gSlot = 0;
+    gUs  += SIM_T_REQ( maskLen );
+
+    return simSlot( invRes, rcvdLen );
+}
+
+ReturnCode rfalISO15693TransceiveEOFAnticollision( uint8_t *rxBuf, uint8_t rxBufLen, uint16_t *actLen )
+{
+    CHECK( rxBufLen >= sizeof(rfalNfcvInventoryRes) );
+
+    gSlot++;
+    gUs += SIM_T_EOF;
+
+    return simSlot( (rfalNfcvInventoryRes*)rxBuf, actLen );
+}
+
+ReturnCode rfalNfcvPollerSleep( uint8_t flags, const uint8_t* uid )
+{
+    uint32_t t;
+
+    (void)flags;
+    gUs += SIM_T_REQ( 64U );
+    for( t = 0; t < gNbTags; t++ )
+    {
+        if( ST_BYTECMP( gUid[t], uid, RFAL_NFCV_UID_LEN ) == 0 )
+        {
+            gQuiet[t] = true;
+        }
+    }
+    return ERR_NONE;
+}
+
+int main( void )
+{
+    static const uint32_t nbTags[] = { 1U, 2U, 8U, 16U, 32U, 64U };
+    uint32_t sequential;
+    uint32_t corrupt;
+    uint32_t k;
+
+    for( sequential = 0; sequential < 2U; sequential++ )
+    {
+        for( corrupt = 0; corrupt <= 5U; corrupt += 5U )
+        {
+            printf( "%s UIDs, %lu%% corrupted answers\n", (sequential != 0U) ? "Sequential" : "Random", (unsigned long)corrupt );
+            for( k = 0; k < (sizeof(nbTags) / sizeof(nbTags[0])); k++ )
+            {
+                testField( nbTags[k], (sequential != 0U), (double)corrupt / 100.0 );
+            }
+        }
+    }
+
+    printf( "%s\n", (gFailures == 0U) ? "PASS" : "FAIL" );
+    return (gFailures == 0U) ? 0 : 1;
+}
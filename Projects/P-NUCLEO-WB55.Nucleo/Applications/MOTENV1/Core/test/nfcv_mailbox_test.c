@@ -0,0 +1,701 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \brief Host test of the ST25DV fast transfer mailbox transport
+ *
+ *  An event-driven model of an ST25DV and of the I2C host behind it: the
+ *  mailbox and MB_CTRL_Dyn, the watchdog that frees a message not read in
+ *  time, a host that answers after a latency and may stall, and the RF
+ *  commands of nfcv_mailbox.c with their air time. RF commands can be lost
+ *  before or after the tag executed them. Transfers in both directions must
+ *  complete with the data intact, or give up only after
+ *  NFCV_MAILBOX_MAX_RETRIES errors in a row.
+ *
+ *  Run by Tools/run_host_tests.sh
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdlib.h>
+#include "platform.h"
+#include "../Src/nfcv_mailbox.c"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+
+/* RF timing [ms] */
+#define SIM_T_REQ_BIT          0.03776                 /*!< 1 out of 4 coding, 26.48 kbps         */
+#define SIM_T_RES_FAST_BIT     0.01888                 /*!< Fast commands, 52.97 kbps             */
+#define SIM_T_RES_HIGH_BIT     0.03776                 /*!< Other commands, 26.48 kbps            */
+#define SIM_T_SOF_EOF          0.30
+#define SIM_T_T1               0.32
+#define SIM_T_T2               0.31
+#define SIM_T_EEPROM_WRITE     5.0                     /*!< EEPROM block programming              */
+
+#define SIM_I2C_KBPS           400.0
+#define SIM_WATCHDOG           200.0                   /*!< Mailbox message watchdog [ms]         */
+#define SIM_ACK_TIMEOUT        250.0                   /*!< Host wait for an ACK request [ms]     */
+#define SIM_NEVER              1e18
+
+#define SIM_MAX_LEN            65536U
+#define SIM_FUZZ_RUNS          200U
+
+#define CHECK( cond )          do { if( !(cond) ) { printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond ); gFailures++; } } while(0)
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! Events of the tag and host model */
+typedef enum
+{
+    SIM_EV_NONE,
+    SIM_EV_WATCHDOG,        /*!< Message not read in time          */
+    SIM_EV_READ_START,      /*!< Host starts reading an RF message */
+    SIM_EV_READ_END,
+    SIM_EV_PUT_START,       /*!< Host starts writing a message     */
+    SIM_EV_PUT_END,
+    SIM_EV_ACK_TIMEOUT      /*!< Host sender resends the window    */
+} simEvent;
+
+/*! ST25DV mailbox */
+typedef struct
+{
+    uint8_t  msg[NFCV_MAILBOX_MSG_LEN + 1U];
+    uint16_t len;
+    uint8_t  ctrl;          /*!< MB_CTRL_Dyn                       */
+    double   putAt;         /*!< Message put time                  */
+    bool     byRf;          /*!< Message put by RF                 */
+    double   freeAt;        /*!< Last time the mailbox was emptied */
+    uint32_t rfRejected;    /*!< RF writes to a busy mailbox       */
+    uint32_t watchdogs;
+} simTag;
+
+/*! I2C host of the tag */
+typedef struct
+{
+    bool           sends;           /*!< Host sends, else receives         */
+    double         latency;         /*!< GPO to I2C access [ms]            */
+    double         stallProb;       /*!< Probability to miss a message     */
+    double         freeAt;
+    bool           reading;
+    double         readEnd;
+    bool           putting;
+    double         putEnd;
+    uint8_t        put[NFCV_MAILBOX_MSG_LEN];
+    uint16_t       putLen;
+    uint32_t       stalls;
+
+    /* Receiver */
+    uint8_t        rx[SIM_MAX_LEN];
+    uint32_t       rxLen;
+    uint32_t       expected;        /*!< Next sequence number              */
+    int32_t        rxTid;
+    bool           done;
+    bool           ackPending;
+    uint32_t       duplicates;
+    uint32_t       gaps;
+
+    /* Sender */
+    const uint8_t* tx;
+    uint32_t       txLen;
+    uint32_t       txFrames;
+    uint32_t       seq;             /*!< Next frame to write               */
+    uint32_t       acked;           /*!< Next frame expected by the reader */
+    uint8_t        txTid;
+    bool           txDone;
+    double         ackTimer;
+} simHost;
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static uint32_t gFailures;
+static double   gMs;
+static simTag   gTag;
+static simHost  gHost;
+static double   gErrProb;           /*!< Probability an RF command is lost */
+static uint32_t gInjected;
+static double   gKBps;              /*!< Rate of the last transfer         */
+
+static uint8_t  gData[SIM_MAX_LEN];
+static uint8_t  gRx[SIM_MAX_LEN];
+
+static const uint8_t gUid[RFAL_NFCV_UID_LEN] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+static double simUniform( void )
+{
+    return (double)rand() / (double)RAND_MAX;
+}
+
+static double simReq( uint32_t bytes )
+{
+    return ((double)bytes * 8.0 * SIM_T_REQ_BIT) + SIM_T_SOF_EOF + SIM_T_T1;
+}
+
+static double simRes( uint32_t bytes, bool fast )
+{
+    return ((double)bytes * 8.0 * (fast ? SIM_T_RES_FAST_BIT : SIM_T_RES_HIGH_BIT)) + SIM_T_SOF_EOF + SIM_T_T2;
+}
+
+static uint32_t simUidLen( const uint8_t* uid )
+{
+    return (uid != NULL) ? RFAL_NFCV_UID_LEN : 0U;
+}
+
+static double simI2c( uint32_t bytes )
+{
+    return (double)(bytes + 3U) * 9.0 / SIM_I2C_KBPS;
+}
+
+static bool simBusy( void )
+{
+    return ((gTag.ctrl & (NFCV_MAILBOX_RF_PUT_MSG | NFCV_MAILBOX_HOST_PUT_MSG)) != 0U);
+}
+
+static uint32_t simHostLimit( void )
+{
+    return MIN( gHost.acked + NFCV_MAILBOX_WINDOW, gHost.txFrames );
+}
+
+/* Message written by the reader, read by the host */
+static void simHostProcess( const uint8_t* m, uint16_t len )
+{
+    uint32_t seq = ((uint32_t)m[2] << 8U) | m[3];
+
+    if( !gHost.sends )
+    {
+        if( (m[0] & NFCV_MAILBOX_FRAME_TYPE_MASK) != NFCV_MAILBOX_FRAME_DATA )
+        {
+            return;
+        }
+        if( ((m[0] & NFCV_MAILBOX_FLAG_FIRST) != 0U) && (seq == 0U) && ((int32_t)m[1] != gHost.rxTid) )
+        {
+            gHost.rxTid    = m[1];
+            gHost.expected = 0;
+            gHost.rxLen    = 0;
+            gHost.done     = false;
+        }
+        if( (int32_t)m[1] != gHost.rxTid )
+        {
+            return;
+        }
+
+        if( seq == gHost.expected )
+        {
+            ST_MEMCPY( &gHost.rx[gHost.rxLen], &m[NFCV_MAILBOX_HEADER_LEN], len - NFCV_MAILBOX_HEADER_LEN );
+            gHost.rxLen += len - NFCV_MAILBOX_HEADER_LEN;
+            gHost.expected++;
+            gHost.done       = gHost.done || ((m[0] & NFCV_MAILBOX_FLAG_LAST) != 0U);
+            gHost.ackPending = gHost.ackPending || ((m[0] & NFCV_MAILBOX_FLAG_ACK_REQ) != 0U);
+        }
+        else if( seq < gHost.expected )
+        {
+            gHost.duplicates++;
+            gHost.ackPending = gHost.ackPending || ((m[0] & NFCV_MAILBOX_FLAG_ACK_REQ) != 0U);
+        }
+        else
+        {
+            gHost.gaps++;
+            gHost.ackPending = true;
+        }
+    }
+    else
+    {
+        if( (m[0] & NFCV_MAILBOX_FRAME_TYPE_MASK) != NFCV_MAILBOX_FRAME_ACK )
+        {
+            return;
+        }
+        if( (m[1] != gHost.txTid) && (seq != 0U) )
+        {
+            return;
+        }
+        if( seq >= gHost.txFrames )
+        {
+            gHost.txDone = true;
+            return;
+        }
+        gHost.seq   = MIN( gHost.seq, seq );
+        gHost.acked = seq;
+    }
+}
+
+static bool simHostWantsPut( void )
+{
+    return gHost.sends ? (!gHost.txDone && (gHost.seq < simHostLimit())) : gHost.ackPending;
+}
+
+/* Next message the host writes: an ACK or a DATA frame */
+static void simHostBuild( void )
+{
+    uint32_t offset;
+    uint32_t n;
+
+    if( !gHost.sends )
+    {
+        gHost.put[0]     = NFCV_MAILBOX_FRAME_ACK;
+        gHost.put[1]     = (uint8_t)gHost.rxTid;
+        gHost.put[2]     = (uint8_t)(gHost.expected >> 8U);
+        gHost.put[3]     = (uint8_t)gHost.expected;
+        gHost.putLen     = NFCV_MAILBOX_HEADER_LEN;
+        gHost.ackPending = false;
+        return;
+    }
+
+    offset       = gHost.seq * NFCV_MAILBOX_PAYLOAD_LEN;
+    n            = MIN( gHost.txLen - offset, NFCV_MAILBOX_PAYLOAD_LEN );
+    gHost.put[0] = NFCV_MAILBOX_FRAME_DATA;
+    gHost.put[0] |= (gHost.seq == 0U) ? NFCV_MAILBOX_FLAG_FIRST : 0U;
+    gHost.put[0] |= (gHost.seq == (gHost.txFrames - 1U)) ? NFCV_MAILBOX_FLAG_LAST : 0U;
+    gHost.put[0] |= (gHost.seq == (simHostLimit() - 1U)) ? NFCV_MAILBOX_FLAG_ACK_REQ : 0U;
+    gHost.put[1] = gHost.txTid;
+    gHost.put[2] = (uint8_t)(gHost.seq >> 8U);
+    gHost.put[3] = (uint8_t)gHost.seq;
+    ST_MEMCPY( &gHost.put[NFCV_MAILBOX_HEADER_LEN], &gHost.tx[offset], n );
+    gHost.putLen = (uint16_t)(NFCV_MAILBOX_HEADER_LEN + n);
+    if( (gHost.put[0] & NFCV_MAILBOX_FLAG_ACK_REQ) != 0U )
+    {
+        gHost.ackTimer = -1.0;   /* Armed once the frame is in the mailbox */
+    }
+    gHost.seq++;
+}
+
+/* Run the tag and host events up to time t */
+static void simRun( double t )
+{
+    simEvent ev;
+    double   next;
+    double   at;
+
+    for( ;; )
+    {
+        next = SIM_NEVER;
+        ev   = SIM_EV_NONE;
+
+        if( simBusy() && !gHost.reading && ((gTag.putAt + SIM_WATCHDOG) < next) )
+        {
+            next = gTag.putAt + SIM_WATCHDOG;
+            ev   = SIM_EV_WATCHDOG;
+        }
+        if( ((gTag.ctrl & NFCV_MAILBOX_RF_PUT_MSG) != 0U) && !gHost.reading )
+        {
+            at = MAX( gTag.putAt + gHost.latency, gHost.freeAt );
+            if( at < next )
+            {
+                next = at;
+                ev   = SIM_EV_READ_START;
+            }
+        }
+        if( gHost.reading && (gHost.readEnd < next) )
+        {
+            next = gHost.readEnd;
+            ev   = SIM_EV_READ_END;
+        }
+        if( !gHost.putting && !gHost.reading && !simBusy() && simHostWantsPut() )
+        {
+            at = MAX( gHost.freeAt, gTag.freeAt + gHost.latency );
+            if( at < next )
+            {
+                next = at;
+                ev   = SIM_EV_PUT_START;
+            }
+        }
+        if( gHost.putting && (gHost.putEnd < next) )
+        {
+            next = gHost.putEnd;
+            ev   = SIM_EV_PUT_END;
+        }
+        if( gHost.sends && !gHost.txDone && (gHost.seq >= simHostLimit()) && (gHost.ackTimer >= 0.0) && (gHost.ackTimer < next) )
+        {
+            next = gHost.ackTimer;
+            ev   = SIM_EV_ACK_TIMEOUT;
+        }
+
+        if( next > t )
+        {
+            return;
+        }
+
+        switch( ev )
+        {
+            case SIM_EV_WATCHDOG:
+                gTag.freeAt = next;
+                gTag.ctrl  &= (uint8_t)~(NFCV_MAILBOX_RF_PUT_MSG | NFCV_MAILBOX_HOST_PUT_MSG);
+                gTag.ctrl  |= gTag.byRf ? NFCV_MAILBOX_RF_MISS_MSG : NFCV_MAILBOX_HOST_MISS_MSG;
+                gTag.watchdogs++;
+                break;
+
+            case SIM_EV_READ_START:
+                if( (gHost.stallProb > 0.0) && (simUniform() < gHost.stallProb) )
+                {
+                    /* Busy elsewhere until the watchdog fired */
+                    gHost.freeAt = next + SIM_WATCHDOG + 5.0;
+                    gHost.stalls++;
+                    break;
+                }
+                gHost.reading = true;
+                gHost.readEnd = next + simI2c( gTag.len );
+                break;
+
+            case SIM_EV_READ_END:
+                gHost.reading = false;
+                gHost.freeAt  = next;
+                gTag.freeAt   = next;
+                gTag.ctrl    &= (uint8_t)~NFCV_MAILBOX_RF_PUT_MSG;
+                simHostProcess( gTag.msg, gTag.len );
+                break;
+
+            case SIM_EV_PUT_START:
+                simHostBuild();
+                gHost.putting = true;
+                gHost.putEnd  = next + simI2c( gHost.putLen );
+                break;
+
+            case SIM_EV_PUT_END:
+                gHost.putting = false;
+                gHost.freeAt  = next;
+                ST_MEMCPY( gTag.msg, gHost.put, gHost.putLen );
+                gTag.len   = gHost.putLen;
+                gTag.ctrl  = (uint8_t)((gTag.ctrl & (uint8_t)~NFCV_MAILBOX_HOST_MISS_MSG) | NFCV_MAILBOX_HOST_PUT_MSG);
+                gTag.putAt = next;
+                gTag.byRf  = false;
+                if( gHost.ackTimer < 0.0 )
+                {
+                    gHost.ackTimer = next + SIM_ACK_TIMEOUT;
+                }
+                break;
+
+            case SIM_EV_ACK_TIMEOUT:
+                gHost.seq      = simHostLimit() - 1U;
+                gHost.ackTimer = SIM_NEVER;
+                break;
+
+            default:
+                return;
+        }
+    }
+}
+
+static void simAdvance( double ms )
+{
+    gMs += ms;
+    simRun( gMs );
+}
+
+/* RF command lost on the way, before or after the tag executed it */
+static bool simLose( void )
+{
+    if( (gErrProb > 0.0) && (simUniform() < gErrProb) )
+    {
+        gInjected++;
+        return true;
+    }
+    return false;
+}
+
+static void simReset( bool hostSends, double latency, double stallProb )
+{
+    ST_MEMSET( &gTag, 0x00, sizeof(gTag) );
+    gTag.ctrl   = NFCV_MAILBOX_MB_EN;
+    gTag.freeAt = gMs;
+
+    ST_MEMSET( &gHost, 0x00, sizeof(gHost) );
+    gHost.sends     = hostSends;
+    gHost.latency   = latency;
+    gHost.stallProb = stallProb;
+    gHost.freeAt    = gMs;
+    gHost.rxTid     = -1;
+    gHost.ackTimer  = SIM_NEVER;
+
+    gErrProb  = 0.0;
+    gInjected = 0;
+}
+
+/* Reader sends len bytes to the host */
+static ReturnCode testSend( const char* name, uint32_t len, double latency, double errProb, double stallProb, bool mayGiveUp )
+{
+    nfcvMailbox mb;
+    ReturnCode  err;
+    double      start;
+    bool        ok;
+
+    simReset( false, latency, stallProb );
+    CHECK( nfcvMailboxIni( &mb, gUid ) == ERR_NONE );
+    gErrProb = errProb;
+
+    start = gMs;
+    err   = nfcvMailboxSend( &mb, gData, len );
+    gKBps = (double)len / (gMs - start);
+    ok    = (err == ERR_NONE) && gHost.done && (gHost.rxLen == len) && (ST_BYTECMP( gHost.rx, gData, len ) == 0);
+
+    if( name != NULL )
+    {
+        printf( "  %-26s %5lu B %8.1f ms %5.2f kB/s, frames %3lu, polls %5lu, retries %3lu, resumes %2lu, watchdog %2lu\n",
+                name, (unsigned long)len, gMs - start, gKBps, (unsigned long)mb.stats.framesTx,
+                (unsigned long)mb.stats.polls, (unsigned long)mb.stats.retries, (unsigned long)mb.stats.resumes,
+                (unsigned long)gTag.watchdogs );
+    }
+
+    if( !ok && !(mayGiveUp && (err != ERR_NONE) && (gInjected >= NFCV_MAILBOX_MAX_RETRIES)) )
+    {
+        printf( "  send %lu B: err %d, host received %lu B\n", (unsigned long)len, err, (unsigned long)gHost.rxLen );
+        CHECK( false );
+    }
+    return err;
+}
+
+/* Reader receives len bytes from the host */
+static ReturnCode testReceive( const char* name, uint32_t len, double latency, double errProb, bool mayGiveUp )
+{
+    nfcvMailbox mb;
+    ReturnCode  err;
+    uint32_t    rcvLen = 0;
+    double      start;
+    bool        ok;
+
+    simReset( true, latency, 0.0 );
+    CHECK( nfcvMailboxIni( &mb, gUid ) == ERR_NONE );
+    gErrProb = errProb;
+
+    gHost.tx       = gData;
+    gHost.txLen    = len;
+    gHost.txFrames = (len + NFCV_MAILBOX_PAYLOAD_LEN - 1U) / NFCV_MAILBOX_PAYLOAD_LEN;
+    gHost.txTid++;
+
+    start = gMs;
+    err   = nfcvMailboxReceive( &mb, gRx, sizeof(gRx), &rcvLen );
+    gKBps = (double)len / (gMs - start);
+    simAdvance( 50.0 );
+    ok    = (err == ERR_NONE) && (rcvLen == len) && (ST_BYTECMP( gRx, gData, len ) == 0) && gHost.txDone;
+
+    if( name != NULL )
+    {
+        printf( "  %-26s %5lu B %8.1f ms %5.2f kB/s, frames %3lu, polls %5lu, retries %3lu, duplicates %2lu, acks %3lu\n",
+                name, (unsigned long)len, (double)len / gKBps, gKBps, (unsigned long)mb.stats.framesRx,
+                (unsigned long)mb.stats.polls, (unsigned long)mb.stats.retries, (unsigned long)mb.stats.duplicates,
+                (unsigned long)mb.stats.acks );
+    }
+
+    if( !ok && !(mayGiveUp && (err != ERR_NONE) && (gInjected >= NFCV_MAILBOX_MAX_RETRIES)) )
+    {
+        printf( "  receive %lu B: err %d, %lu B received\n", (unsigned long)len, err, (unsigned long)rcvLen );
+        CHECK( false );
+    }
+    return err;
+}
+
+/* Random lengths, host latencies, losses and stalls */
+static void testFuzz( void )
+{
+    uint32_t run;
+    uint32_t len;
+    uint32_t gaveUp = 0;
+    double   latency;
+
+    for( run = 0; run < SIM_FUZZ_RUNS; run++ )
+    {
+        srand( 100U + run );
+        len     = 1U + ((uint32_t)rand() % 20000U);
+        latency = 1.0 + (double)(rand() % 10);
+        if( (run & 1U) != 0U )
+        {
+            gaveUp += (testSend( NULL, len, latency, 0.05, 0.02, true ) != ERR_NONE) ? 1U : 0U;
+        }
+        else
+        {
+            gaveUp += (testReceive( NULL, len, latency, 0.05, true ) != ERR_NONE) ? 1U : 0U;
+        }
+    }
+
+    printf( "  %lu random transfers, %lu gave up after %u RF errors in a row\n",
+            (unsigned long)SIM_FUZZ_RUNS, (unsigned long)gaveUp, NFCV_MAILBOX_MAX_RETRIES );
+    CHECK( gaveUp <= (SIM_FUZZ_RUNS / 100U) );
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+uint32_t HAL_GetTick( void )
+{
+    return (uint32_t)gMs;
+}
+
+void HAL_Delay( uint32_t Delay )
+{
+    simAdvance( (double)Delay );
+}
+
+ReturnCode rfalNfcvPollerSelect( uint8_t flags, const uint8_t* uid )
+{
+    (void)flags;
+    (void)uid;
+    simAdvance( simReq( 1U + 1U + RFAL_NFCV_UID_LEN + 2U ) + simRes( 3U, false ) );
+    return ERR_NONE;
+}
+
+ReturnCode rfalST25xVPollerFastReadDynamicConfiguration( uint8_t flags, const uint8_t* uid, uint8_t pointer, uint8_t* regValue )
+{
+    (void)flags;
+    CHECK( pointer == NFCV_MAILBOX_MB_CTRL_DYN );
+
+    simAdvance( simReq( 1U + 1U + 1U + simUidLen( uid ) + 1U + 2U ) );
+    *regValue = gTag.ctrl;
+    simAdvance( simRes( 1U + 1U + 2U, true ) );
+    return simLose() ? ERR_TIMEOUT : ERR_NONE;
+}
+
+ReturnCode rfalST25xVPollerFastWriteMessage( uint8_t flags, const uint8_t* uid, uint8_t msgLen, const uint8_t* msgData, uint8_t* txBuf, uint16_t txBufLen )
+{
+    bool lost;
+    bool beforeTag;
+
+    (void)flags;
+    (void)txBuf;
+    if( (msgLen == 0U) || (msgLen == 0xFFU) || (txBufLen < (msgLen + 1U + 4U + simUidLen( uid ))) )
+    {
+        return ERR_PARAM;
+    }
+
+    lost      = simLose();
+    beforeTag = lost && (simUniform() < 0.5);
+    simAdvance( simReq( 1U + 1U + 1U + simUidLen( uid ) + 1U + msgLen + 1U + 2U ) );
+
+    if( !beforeTag )
+    {
+        if( simBusy() || gHost.putting )
+        {
+            gTag.rfRejected++;
+            simAdvance( simRes( 4U, true ) );
+            return ERR_PROTO;
+        }
+        /* MSGLen is the message length minus 1 */
+        ST_MEMCPY( gTag.msg, msgData, msgLen + 1U );
+        gTag.len   = (uint16_t)(msgLen + 1U);
+        gTag.ctrl  = (uint8_t)((gTag.ctrl & (uint8_t)~NFCV_MAILBOX_RF_MISS_MSG) | NFCV_MAILBOX_RF_PUT_MSG);
+        gTag.putAt = gMs;
+        gTag.byRf  = true;
+    }
+    simAdvance( simRes( 1U + 2U, true ) );
+    return lost ? ERR_CRC : ERR_NONE;
+}
+
+ReturnCode rfalST25xVPollerFastReadMessage( uint8_t flags, const uint8_t* uid, uint8_t mbPointer, uint8_t numBytes, uint8_t* rxBuf, uint16_t rxBufLen, uint16_t *rcvLen )
+{
+    bool lost;
+
+    (void)flags;
+    (void)mbPointer;
+    (void)numBytes;
+
+    lost = simLose();
+    simAdvance( simReq( 1U + 1U + 1U + simUidLen( uid ) + 1U + 1U + 2U ) );
+
+    if( lost && (simUniform() < 0.5) )
+    {
+        /* Request lost: no answer */
+        simAdvance( 1.0 );
+        return ERR_TIMEOUT;
+    }
+
+    if( (gTag.ctrl & NFCV_MAILBOX_HOST_PUT_MSG) == 0U )
+    {
+        /* Error response: no message */
+        rxBuf[0] = 0x01U;
+        rxBuf[1] = 0x0FU;
+        *rcvLen  = 2U;
+        simAdvance( simRes( 4U, true ) );
+        return ERR_NONE;
+    }
+
+    if( rxBufLen < (gTag.len + 1U) )
+    {
+        return ERR_PARAM;
+    }
+
+    /* The message is freed once read, even if the answer is lost */
+    rxBuf[0] = 0x00U;
+    ST_MEMCPY( &rxBuf[1], gTag.msg, gTag.len );
+    *rcvLen  = (uint16_t)(gTag.len + 1U);
+    gTag.ctrl &= (uint8_t)~NFCV_MAILBOX_HOST_PUT_MSG;
+    simAdvance( simRes( 1U + gTag.len + 2U, true ) );
+    gTag.freeAt = gMs;
+    return lost ? ERR_CRC : ERR_NONE;
+}
+
+int main( void )
+{
+    uint32_t i;
+    double   eepromWrite;
+    double   eepromRead;
+
+    srand( 1 );
+    for( i = 0; i < SIM_MAX_LEN; i++ )
+    {
+        gData[i] = (uint8_t)rand();
+    }
+
+    /* EEPROM NDEF path for comparison: Write Single Block as ndef_t5t.c, Read Multiple Blocks */
+    eepromWrite = 4.0 / (simReq( 1U + 1U + 1U + 4U + 2U ) + SIM_T_EEPROM_WRITE + simRes( 1U + 2U, false ));
+    eepromRead  = (4.0 * 32.0) / (simReq( 1U + 1U + 1U + 1U + 2U ) + simRes( 1U + (4U * 32U) + 2U, false ));
+    printf( "  EEPROM NDEF path: write %.2f kB/s, read %.2f kB/s\n", eepromWrite, eepromRead );
+
+    (void)testSend( "send",                        1U,     1.0,  0.0,  0.0,  false );
+    (void)testSend( "send",                        251U,   1.0,  0.0,  0.0,  false );
+    (void)testSend( "send",                        4096U,  1.0,  0.0,  0.0,  false );
+    (void)testSend( "send",                        16384U, 1.0,  0.0,  0.0,  false );
+    CHECK( gKBps > (4.0 * eepromWrite) );
+    (void)testSend( "send, 20 ms host",            16384U, 20.0, 0.0,  0.0,  false );
+    (void)testSend( "send, 2% RF errors",          16384U, 1.0,  0.02, 0.0,  false );
+    (void)testSend( "send, host stalls",           16384U, 1.0,  0.0,  0.03, false );
+    (void)testSend( "send, 5% errors, stalls",     65000U, 2.0,  0.05, 0.02, false );
+    (void)testReceive( "receive",                  4096U,  1.0,  0.0,  false );
+    (void)testReceive( "receive",                  16384U, 1.0,  0.0,  false );
+    CHECK( gKBps > eepromRead );
+    (void)testReceive( "receive, 20 ms host",      16384U, 20.0, 0.0,  false );
+    (void)testReceive( "receive, 2% RF errors",    16384U, 1.0,  0.02, false );
+    (void)testReceive( "receive, 5% RF errors",    65000U, 2.0,  0.05, false );
+    testFuzz();
+
+    printf( "%s\n", (gFailures == 0U) ? "PASS" : "FAIL" );
+    return (gFailures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,418 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \brief Host test of the sequencer dispatch and statistics
+ *
+ *  Checks the dispatch order: the highest priority set first, the round
+ *  robin within a priority, the Pause/Resume and Run() masks, a task set
+ *  at several priorities run once at the highest one.
+ *
+ *  Runs a synthetic load against a simulated 32-bit cycle counter that
+ *  wraps during the test: a 10000 cycle timer sets a MotionFX-like task,
+ *  which sets a BLE-like task, and every fourth run a task waiting for an
+ *  event while the other tasks run nested. Run times, latencies and their
+ *  histogram must be exact and elapsed == tasks + idle + other. A task
+ *  then waits for an event, and another one stays paused, longer than the
+ *  counter period.
+ *
+ *  Run by Tools/run_host_tests.sh, with the count leading zeros instruction
+ *  and with the table of the Cortex-M0
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdbool.h>
+#include <stdio.h>
+#include "utilities_conf.h"
+#include "stm32_seq.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define SIM_TICK               10000U                  /*!< Timer period, cycles            */
+#define SIM_TICKS              400U
+#define SIM_EVT_DELAY          25000U                  /*!< Event waited by TASK_WAIT        */
+#define SIM_MAIN_LOOP          7U                      /*!< Work out of the tasks per loop  */
+
+#define TASK_FX                0U
+#define TASK_BLE               1U
+#define TASK_WAIT              2U
+
+#define SIM_TASKS              6U                      /*!< Tasks of the dispatch tests     */
+#define SIM_TRACE_LEN          32U
+
+#define SIM_TASK( n )          static void simTask##n( void ) { simTrace( n ); }
+
+#define CHECK( cond )          do { if( !(cond) ) { printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond ); gFailures++; } } while(0)
+
+/*
+******************************************************************************
+* GLOBAL VARIABLES
+******************************************************************************
+*/
+uint32_t               hostCycles = 0xFFFF0000U;        /* Wraps during the test */
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static uint32_t        gFailures;
+static uint32_t        gNextTick;
+static uint32_t        gTicks;
+static uint32_t        gEvtAt;
+static bool            gEvtPending;
+static bool            gLongMode;
+static uint32_t        gLongWait;                      /*!< Idle periods of half the counter period left */
+static bool            gQuiet;                         /*!< Nothing happens in idle         */
+
+static uint8_t         gTrace[SIM_TRACE_LEN];          /*!< Tasks run, in order             */
+static uint32_t        gTraceLen;
+static uint32_t        gRepeat;                        /*!< Runs left of the round robin tasks */
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+static void simBurn( uint32_t cycles )
+{
+    hostCycles += cycles;
+}
+
+static void simTrace( uint8_t task )
+{
+    if( gTraceLen < SIM_TRACE_LEN )
+    {
+        gTrace[gTraceLen++] = task;
+    }
+}
+
+SIM_TASK( 0 )
+SIM_TASK( 1 )
+SIM_TASK( 4 )
+SIM_TASK( 5 )
+
+/* Set again with the other round robin task while runs are left */
+static void simTaskRepeat( uint8_t task )
+{
+    simTrace( task );
+    if( gRepeat != 0U )
+    {
+        gRepeat--;
+        UTIL_SEQ_SetTask( ((1U << 2) | (1U << 3)), 2 );
+    }
+}
+
+static void simTask2( void )
+{
+    simTaskRepeat( 2 );
+}
+
+static void simTask3( void )
+{
+    simTaskRepeat( 3 );
+}
+
+static void simDispatchIni( void )
+{
+    UTIL_SEQ_Init( );
+    UTIL_SEQ_RegTask( (1U << 0), 0, simTask0 );
+    UTIL_SEQ_RegTask( (1U << 1), 0, simTask1 );
+    UTIL_SEQ_RegTask( (1U << 2), 0, simTask2 );
+    UTIL_SEQ_RegTask( (1U << 3), 0, simTask3 );
+    UTIL_SEQ_RegTask( (1U << 4), 0, simTask4 );
+    UTIL_SEQ_RegTask( (1U << 5), 0, simTask5 );
+    gQuiet    = true;
+    gTraceLen = 0;
+    gRepeat   = 0;
+}
+
+static bool simTraced( const uint8_t* expected, uint32_t len )
+{
+    return (gTraceLen == len) && (memcmp( gTrace, expected, len ) == 0);
+}
+
+/* The highest priority first, a task set at several priorities runs once */
+static void testPriority( void )
+{
+    static const uint8_t expected[] = { 5, 4, 1, 0 };
+
+    simDispatchIni();
+    UTIL_SEQ_SetTask( (1U << 0), 3 );
+    UTIL_SEQ_SetTask( (1U << 4), 3 );
+    UTIL_SEQ_SetTask( (1U << 1), 1 );
+    UTIL_SEQ_SetTask( (1U << 5), 0 );
+    UTIL_SEQ_SetTask( (1U << 4), 0 );
+    UTIL_SEQ_Run( UTIL_SEQ_DEFAULT );
+    CHECK( simTraced( expected, sizeof(expected) ) );
+
+    /* Nothing left */
+    gTraceLen = 0;
+    UTIL_SEQ_Run( UTIL_SEQ_DEFAULT );
+    CHECK( gTraceLen == 0U );
+}
+
+/* Two tasks always set at the same priority run in turn */
+static void testRoundRobin( void )
+{
+    static const uint8_t expected[] = { 3, 2, 3, 2, 3 };
+
+    simDispatchIni();
+    gRepeat = 3;
+    UTIL_SEQ_SetTask( ((1U << 2) | (1U << 3)), 2 );
+    UTIL_SEQ_Run( UTIL_SEQ_DEFAULT );
+    CHECK( simTraced( expected, sizeof(expected) ) );
+}
+
+/* Paused tasks and tasks out of the Run() mask wait, the lower priorities run meanwhile */
+static void testMasks( void )
+{
+    static const uint8_t paused[]  = { 1, 0 };
+    static const uint8_t masked[]  = { 5, 0 };
+    static const uint8_t resumed[] = { 4, 5, 1, 0 };
+
+    simDispatchIni();
+    UTIL_SEQ_PauseTask( (1U << 5) );
+    UTIL_SEQ_SetTask( (1U << 5), 0 );
+    UTIL_SEQ_SetTask( (1U << 1), 1 );
+    UTIL_SEQ_SetTask( (1U << 0), 3 );
+    UTIL_SEQ_Run( UTIL_SEQ_DEFAULT );
+    CHECK( simTraced( paused, sizeof(paused) ) );
+
+    gTraceLen = 0;
+    UTIL_SEQ_ResumeTask( (1U << 5) );
+    UTIL_SEQ_SetTask( (1U << 4), 1 );
+    UTIL_SEQ_SetTask( (1U << 0), 3 );
+    UTIL_SEQ_Run( ~(1U << 4) );
+    CHECK( simTraced( masked, sizeof(masked) ) );
+
+    /* Task 4 is still set */
+    gTraceLen = 0;
+    UTIL_SEQ_SetTask( (1U << 5), 2 );
+    UTIL_SEQ_SetTask( (1U << 1), 3 );
+    UTIL_SEQ_SetTask( (1U << 0), 3 );
+    UTIL_SEQ_Run( UTIL_SEQ_DEFAULT );
+    CHECK( simTraced( resumed, sizeof(resumed) ) );
+    gQuiet = false;
+}
+
+static void simTaskFx( void )
+{
+    simBurn( 200U );
+    UTIL_SEQ_SetTask( (1U << TASK_BLE), 0 );
+    simBurn( 300U );
+    if( (gTicks % 4U) == 0U )
+    {
+        UTIL_SEQ_SetTask( (1U << TASK_WAIT), 1 );
+    }
+}
+
+static void simTaskBle( void )
+{
+    simBurn( 200U );
+}
+
+static void simTaskWait( void )
+{
+    simBurn( 100U );
+    gEvtAt      = hostCycles + SIM_EVT_DELAY;
+    gEvtPending = true;
+    UTIL_SEQ_WaitEvt( 1U );
+    simBurn( 50U );
+}
+
+/* Statistics of the load, the run times and latencies are exact */
+static void testLoad( void )
+{
+    UTIL_SEQ_TaskStats_t fx;
+    UTIL_SEQ_TaskStats_t ble;
+    UTIL_SEQ_TaskStats_t wait;
+    UTIL_SEQ_Stats_t     stats;
+    uint32_t             hist = 0;
+    uint32_t             i;
+
+    UTIL_SEQ_Init( );
+    UTIL_SEQ_RegTask( (1U << TASK_FX), 0, simTaskFx );
+    UTIL_SEQ_RegTask( (1U << TASK_BLE), 0, simTaskBle );
+    UTIL_SEQ_RegTask( (1U << TASK_WAIT), 0, simTaskWait );
+    gNextTick = hostCycles + SIM_TICK;
+
+    while( gTicks < SIM_TICKS )
+    {
+        UTIL_SEQ_Run( UTIL_SEQ_DEFAULT );
+        simBurn( SIM_MAIN_LOOP );
+    }
+
+    UTIL_SEQ_GetStats( &stats );
+    UTIL_SEQ_GetTaskStats( (1U << TASK_FX), &fx );
+    UTIL_SEQ_GetTaskStats( (1U << TASK_BLE), &ble );
+    UTIL_SEQ_GetTaskStats( (1U << TASK_WAIT), &wait );
+
+    printf( "  fx %lu runs, ble latency %llu, wait run %llu, elapsed %llu tasks %llu idle %llu other %llu, load %lu permille\n",
+            (unsigned long)fx.count, (unsigned long long)ble.latency_max, (unsigned long long)wait.run_time_max,
+            (unsigned long long)stats.elapsed, (unsigned long long)stats.tasks, (unsigned long long)stats.idle,
+            (unsigned long long)stats.other, (unsigned long)stats.cpu_load );
+
+    CHECK( (fx.count >= (SIM_TICKS - 1U)) && (fx.run_time == (500ULL * fx.count)) && (fx.run_time_max == 500U) );
+    CHECK( (ble.count == fx.count) && (ble.run_time == (200ULL * ble.count)) );
+    CHECK( (ble.latency == (300ULL * ble.count)) && (ble.latency_max == 300U) );
+    CHECK( ble.latency_hist[3] == ble.count );                 /* 300 in [256, 512) */
+    CHECK( (wait.count == (SIM_TICKS / 4U) - 1U) && (wait.run_time == (150ULL * wait.count)) && (wait.run_time_max == 150U) );
+    CHECK( stats.tasks == (fx.run_time + ble.run_time + wait.run_time) );
+    CHECK( stats.elapsed == (stats.tasks + stats.idle + stats.other) );
+    CHECK( stats.cpu_load == (uint32_t)(((stats.elapsed - stats.idle) * 1000U) / stats.elapsed) );
+    for( i = 0; i < UTIL_SEQ_STATS_HIST_NBR; i++ )
+    {
+        hist += fx.latency_hist[i];
+    }
+    CHECK( hist == fx.count );
+
+    UTIL_SEQ_ResetStats( );
+    UTIL_SEQ_GetStats( &stats );
+    UTIL_SEQ_GetTaskStats( (1U << TASK_FX), &fx );
+    CHECK( (stats.tasks == 0U) && (stats.idle == 0U) && (fx.count == 0U) );
+}
+
+/* A wait longer than the counter period is not charged to the task */
+static void testLongWait( void )
+{
+    UTIL_SEQ_TaskStats_t wait;
+    UTIL_SEQ_Stats_t     stats;
+
+    UTIL_SEQ_Init( );
+    UTIL_SEQ_RegTask( (1U << TASK_WAIT), 0, simTaskWait );
+    gLongMode = true;
+    gLongWait = 3U;
+
+    UTIL_SEQ_SetTask( (1U << TASK_WAIT), 0 );
+    UTIL_SEQ_Run( UTIL_SEQ_DEFAULT );
+
+    UTIL_SEQ_GetStats( &stats );
+    UTIL_SEQ_GetTaskStats( (1U << TASK_WAIT), &wait );
+
+    printf( "  long wait: run %llu, idle %llu, elapsed %llu\n", (unsigned long long)wait.run_time,
+            (unsigned long long)stats.idle, (unsigned long long)stats.elapsed );
+
+    CHECK( (wait.count == 1U) && (wait.run_time == 150U) );
+    CHECK( stats.idle == (3ULL * 0x80000000U) );
+    CHECK( stats.elapsed == (stats.tasks + stats.idle + stats.other) );
+    gLongMode = false;
+}
+
+/* A task paused longer than the counter period has the whole latency */
+static void testLongLatency( void )
+{
+    UTIL_SEQ_TaskStats_t ble;
+
+    UTIL_SEQ_Init( );
+    UTIL_SEQ_RegTask( (1U << TASK_BLE), 0, simTaskBle );
+    gLongMode = true;
+    gLongWait = 3U;
+
+    UTIL_SEQ_SetTask( (1U << TASK_BLE), 0 );
+    UTIL_SEQ_PauseTask( (1U << TASK_BLE) );
+    do
+    {
+        UTIL_SEQ_Run( UTIL_SEQ_DEFAULT );
+        UTIL_SEQ_GetTaskStats( (1U << TASK_BLE), &ble );
+    } while( ble.count == 0U );
+
+    printf( "  long latency: %llu\n", (unsigned long long)ble.latency );
+
+    CHECK( (ble.latency == (3ULL * 0x80000000U)) && (ble.latency_max == ble.latency) );
+    CHECK( ble.latency_hist[UTIL_SEQ_STATS_HIST_NBR - 1] == 1U );
+    gLongMode = false;
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/* The timer interrupt wakes up every tick and sets TASK_FX, the event comes later */
+void UTIL_SEQ_Idle( void )
+{
+    uint32_t wake = gNextTick;
+
+    if( gQuiet )
+    {
+        return;
+    }
+
+    /* Long wait: the counter is read twice per period, then nothing to do */
+    if( gLongMode )
+    {
+        if( gLongWait != 0U )
+        {
+            hostCycles += 0x80000000U;
+            if( --gLongWait == 0U )
+            {
+                UTIL_SEQ_SetEvt( 1U );
+                UTIL_SEQ_ResumeTask( UTIL_SEQ_DEFAULT );
+            }
+        }
+        return;
+    }
+
+    if( gEvtPending && ((int32_t)(gEvtAt - wake) <= 0) )
+    {
+        hostCycles  = gEvtAt;
+        gEvtPending = false;
+        UTIL_SEQ_SetEvt( 1U );
+        return;
+    }
+
+    hostCycles  = wake;
+    gNextTick  += SIM_TICK;
+    gTicks++;
+    UTIL_SEQ_SetTask( (1U << TASK_FX), 1 );
+}
+
+/* The other tasks run while waiting */
+void UTIL_SEQ_EvtIdle( UTIL_SEQ_bm_t task_id_bm, UTIL_SEQ_bm_t evt_waited_bm )
+{
+    (void)evt_waited_bm;
+    UTIL_SEQ_Run( ~task_id_bm );
+}
+
+int main( void )
+{
+    testPriority();
+    testRoundRobin();
+    testMasks();
+    testLoad();
+    testLongWait();
+    testLongLatency();
+
+    printf( "%s\n", (gFailures == 0U) ? "PASS" : "FAIL" );
+    return (gFailures == 0U) ? 0 : 1;
+}
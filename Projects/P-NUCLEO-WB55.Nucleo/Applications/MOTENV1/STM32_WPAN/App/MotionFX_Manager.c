@@ -35,6 +35,9 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "MotionFX_Manager.h"
+#include "app_common.h"
+#include "hw_flash.h"
+#include "kv_store.h"
 
 /** @addtogroup MOTION_APPLICATIONS MOTION APPLICATIONS
  * @{
@@ -56,6 +59,9 @@
 
 #define DECIMATION                      1U
 
+/* Key of the magnetometer calibration in the key-value store */
+#define MAGCAL_KV_KEY                   0U
+
 /* Private variables ---------------------------------------------------------*/
 static MFX_knobs_t iKnobs;
 static MFX_knobs_t *ipKnobs = &iKnobs;
@@ -63,6 +69,17 @@ static MFX_knobs_t *ipKnobs = &iKnobs;
 static volatile int sampleToDiscard = SAMPLETODISCARD;
 static int discardedCount = 0;
 
+#if ((defined (MOTION_FX_STORE_CALIB_FLASH)))
+static const KV_STORE_Flash_t KvFlash =
+{
+  HW_FLASH_Erase,
+  HW_FLASH_Program
+};
+
+static KV_STORE_t KvStore;
+static uint8_t KvStoreReady = 0;
+#endif
+
 /* Private typedef -----------------------------------------------------------*/
 /* Exported function prototypes ----------------------------------------------*/
 /* Exported functions --------------------------------------------------------*/
@@ -89,6 +106,14 @@ void MotionFX_manager_init(void)
   mag_orientation[1] = 'e';
   mag_orientation[2] = 'u';
 
+#if ((defined (MOTION_FX_STORE_CALIB_FLASH)))
+  /* Before the library loads the calibration */
+  if (KV_STORE_Init(&KvStore, &KvFlash, CFG_KV_STORE_ADDRESS, CFG_KV_STORE_PAGE_NBR) == KV_STORE_OK)
+  {
+    KvStoreReady = 1;
+  }
+#endif
+
   MotionFX_initialize();
 
   MotionFX_getKnobs(ipKnobs);
@@ -224,7 +249,14 @@ void MotionFX_manager_MagCal_stop(int sampletime)
 char MotionFX_LoadMagCalFromNVM(unsigned short int dataSize, unsigned int *data)
 {
 #if ((defined (MOTION_FX_STORE_CALIB_FLASH)))
-  RecallCalibrationFromMemory(dataSize / 4, (uint32_t *) data);
+  uint16_t length;
+
+  if ((KvStoreReady == 0U)
+      || (KV_STORE_Read(&KvStore, MAGCAL_KV_KEY, data, dataSize, &length) != KV_STORE_OK)
+      || (length != dataSize))
+  {
+    return (char)1;
+  }
   return (char)0;
 #else
   return (char)1;
@@ -240,7 +272,11 @@ char MotionFX_LoadMagCalFromNVM(unsigned short int dataSize, unsigned int *data)
 char MotionFX_SaveMagCalInNVM(unsigned short int dataSize, unsigned int *data)
 {
 #if ((defined (MOTION_FX_STORE_CALIB_FLASH)))
-  SaveCalibrationToMemory(dataSize / 4, (uint32_t *) data);
+  if ((KvStoreReady == 0U)
+      || (KV_STORE_Write(&KvStore, MAGCAL_KV_KEY, data, dataSize) != KV_STORE_OK))
+  {
+    return (char)1;
+  }
   return (char)0;
 #else
   return (char)1;
@@ -35,6 +35,7 @@
 #include "otp.h"
 #include "p2p_server_app.h"
 #include "motenv_server_app.h"
+#include "conn_param_app.h"
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
@@ -53,8 +54,15 @@ extern ndefConstBuffer  bufConstRawMessage;
 
 #define NFC_READ_INTERVAL            (uint32_t)(2*1000*1000/CFG_TS_TICK_VAL) /**< 2s */     
 
+#define NFC_MS_TO_TICKS(ms)          (uint32_t)((ms)*1000/CFG_TS_TICK_VAL)
+
+#define NFC_UART_RETRY_MS            (10)        /**< LPUART1 busy with another transfer: next try of the vCard output */
+
 uint8_t nfc_reader_timer_Id;
+static uint8_t nfc_process_timer_Id;
+static uint8_t nfc_uart_tx_ongoing = 0;
 extern uint8_t demoCycleEnable;
+extern UART_HandleTypeDef hlpuart1;
 
 #endif
     
@@ -393,6 +401,8 @@ static void BLE_SVC_L2CAP_Conn_Update(uint16_t Connection_Handle);
 void APP_NFC_NDEF_Process();    
 void NFC_APP_Init(void);
 void NFC_Read_Callback(void);  
+static void NFC_Process(void);
+static void NFC_Process_Timer_Callback(void);
 #endif
 
 /* USER CODE BEGIN PFP */
@@ -574,6 +584,16 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification( void *pckt )
           APP_DBG_MSG("\r\n\r** CONNECTION UPDATE EVENT WITH CLIENT \n");
 #endif
           /* USER CODE BEGIN EVT_LE_CONN_UPDATE_COMPLETE */
+          {
+            hci_le_connection_update_complete_event_rp0 *connection_update_complete_event;
+
+            connection_update_complete_event = (hci_le_connection_update_complete_event_rp0 *) meta_evt->data;
+            if (connection_update_complete_event->Status == BLE_STATUS_SUCCESS)
+            {
+              CONN_PARAM_Updated(connection_update_complete_event->Connection_Handle,
+                                 connection_update_complete_event->Conn_Interval);
+            }
+          }
 
           /* USER CODE END EVT_LE_CONN_UPDATE_COMPLETE */
           break;
@@ -611,6 +631,12 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification( void *pckt )
           handleNotification.ConnectionHandle = BleApplicationContext.BleApplicationContext_legacy.connectionHandle;
           P2PS_APP_Notification(&handleNotification);
           /* USER CODE BEGIN HCI_EVT_LE_CONN_COMPLETE */
+          if (BleApplicationContext.Device_Connection_Status == APP_BLE_CONNECTED_SERVER)
+          {
+            /* Only the peripheral asks for other connection parameters */
+            CONN_PARAM_Connected(connection_complete_event->Connection_Handle,
+                                 connection_complete_event->Conn_Interval);
+          }
 
           /* USER CODE END HCI_EVT_LE_CONN_COMPLETE */
           }
@@ -643,6 +669,13 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification( void *pckt )
           mutex = 1;
 #endif
       /* USER CODE BEGIN EVT_BLUE_L2CAP_CONNECTION_UPDATE_RESP */
+          {
+            aci_l2cap_connection_update_resp_event_rp0 *l2cap_connection_update_resp_event;
+
+            l2cap_connection_update_resp_event = (aci_l2cap_connection_update_resp_event_rp0 *) blue_evt->data;
+            CONN_PARAM_Update_Resp(l2cap_connection_update_resp_event->Connection_Handle,
+                                   l2cap_connection_update_resp_event->Result);
+          }
 
       /* USER CODE END EVT_BLUE_L2CAP_CONNECTION_UPDATE_RESP */
       break;
@@ -1185,6 +1218,9 @@ void APP_NFC_NDEF_Process()
 
 void NFC_APP_Init(void)
 {
+  UTIL_SEQ_RegTask(1 << CFG_TASK_NFC_ID, UTIL_SEQ_RFU, NFC_Process);
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR, &nfc_process_timer_Id, hw_ts_SingleShot, NFC_Process_Timer_Callback);
+
   HW_TS_Create(CFG_TIM_PROC_ID_ISR, &nfc_reader_timer_Id, hw_ts_Repeated, NFC_Read_Callback);   
   HW_TS_Start(nfc_reader_timer_Id, NFC_READ_INTERVAL);
 }
@@ -1194,15 +1230,86 @@ void NFC_Read_Callback(void)
 /* USER CODE BEGIN Adv_Cancel_Req_1 */
 
 /* USER CODE END Adv_Cancel_Req_1 */
-  if (BleApplicationContext.Device_Connection_Status == APP_BLE_CONNECTED_SERVER)
+  if ((BleApplicationContext.Device_Connection_Status == APP_BLE_CONNECTED_SERVER) && (demoCycleEnable == 0))
   {
     demoCycleEnable = 1;
+    UTIL_SEQ_SetTask(1 << CFG_TASK_NFC_ID, CFG_SCH_PRIO_0);
   }
 /* USER CODE BEGIN Adv_Cancel_Req_2 */
 
 /* USER CODE END Adv_Cancel_Req_2 */
   return;
 }
+
+/**
+ * @brief  NFC reader task
+ *         Runs the demo state machine as long as it polls the RFAL worker. Once the reader waits
+ *         in Wake-Up mode, the task is set again only by the ST25R3916 IRQ (HAL_GPIO_EXTI_Callback())
+ *         or by the timer of the next demo deadline, and the device may stop meanwhile.
+ * @param  None
+ * @retval None
+ */
+static void NFC_Process(void)
+{
+  uint32_t idle_time = DEMO_IDLE_FOREVER;
+  uint32_t demo_idle_time;
+  HAL_StatusTypeDef hal_status;
+
+  /* HAL_UART_TxCpltCallback() clears tx_uart_pending at the end of the transfer */
+  if (tx_uart_pending == 0)
+  {
+    nfc_uart_tx_ongoing = 0;
+  }
+
+  if (demoCycleEnable)
+  {
+    demoCycle();
+  }
+
+  if ((tx_uart_pending != 0) && (nfc_uart_tx_ongoing == 0))
+  {
+    /* TRACE - Send the received NDEF string via UART */
+    hal_status = HAL_UART_Transmit_DMA(&hlpuart1, (uint8_t*)string_buff, VCARD_STRING_SIZE);
+    if (hal_status == HAL_OK)
+    {
+      nfc_uart_tx_ongoing = 1;
+    }
+    else if (hal_status == HAL_BUSY)
+    {
+      /* Another transfer on LPUART1: try again later, even with the demo idle */
+      idle_time = NFC_UART_RETRY_MS;
+    }
+    else
+    {
+      /* The string is lost, tx_uart_pending would keep the device out of Stop mode */
+      tx_uart_pending = 0;
+    }
+  }
+
+  HW_TS_Stop(nfc_process_timer_Id);
+  if (demoCycleEnable != 0)
+  {
+    demo_idle_time = demoIdleTime();
+    idle_time = (demo_idle_time < idle_time) ? demo_idle_time : idle_time;
+  }
+  /* else until the next NFC_Read_Callback(), or the UART retry */
+
+  if (idle_time == 0)
+  {
+    UTIL_SEQ_SetTask(1 << CFG_TASK_NFC_ID, CFG_SCH_PRIO_0);
+  }
+  else if (idle_time != DEMO_IDLE_FOREVER)
+  {
+    HW_TS_Start(nfc_process_timer_Id, NFC_MS_TO_TICKS(idle_time));
+  }
+  return;
+}
+
+static void NFC_Process_Timer_Callback(void)
+{
+  UTIL_SEQ_SetTask(1 << CFG_TASK_NFC_ID, CFG_SCH_PRIO_0);
+  return;
+}
 #endif
 /* USER CODE END FD_WRAP_FUNCTIONS */
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,346 @@
+/**
+ ******************************************************************************
+ * File Name          : batch_notify_app.c
+ * Description        : Pack several timestamped samples in one notification
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "app_common.h"
+#include "ble.h"
+
+#include "motenv_server_app.h"
+#include "batch_notify_app.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define BATCH_NOTIFY_MAX_DT             (255U)
+#define BATCH_NOTIFY_VARINT_MAX_LEN     (3U)
+
+#define BATCH_NOTIFY_MS_TO_TICKS(ms)    ((uint32_t)(ms)*1000/CFG_TS_TICK_VAL)
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private macros ------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Global variables ----------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void BATCH_NOTIFY_Start_Packet(BATCH_NOTIFY_t *pBatch, uint32_t TimeStamp, const int16_t *pValues);
+static uint8_t BATCH_NOTIFY_Put_Varint(uint8_t *pBuf, int16_t Delta);
+static void BATCH_NOTIFY_Start_Timer(BATCH_NOTIFY_t *pBatch, uint32_t Delay);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Init an empty batch
+ * @param  pBatch     Batch
+ * @param  Char       Characteristic (MOTENV_STM_Char_t) notified by MOTENV_STM_App_Update_Char()
+ * @param  NbFields   Values per sample (up to BATCH_NOTIFY_MAX_FIELDS)
+ * @param  MaxLatency Longest time a sample waits in the batch [ms]
+ * @param  TimerCb    Called (interrupt context) when the latency budget of the first
+ *                    sample expires: it must schedule a task that calls
+ *                    BATCH_NOTIFY_Check_Latency(), even when no new sample comes
+ * @retval None
+ */
+void BATCH_NOTIFY_Init(BATCH_NOTIFY_t *pBatch, uint8_t Char, uint8_t NbFields, uint32_t MaxLatency,
+                       HW_TS_pTimerCb_t TimerCb)
+{
+  memset(pBatch, 0, sizeof(BATCH_NOTIFY_t));
+  pBatch->Char = Char;
+  pBatch->NbFields = (NbFields > BATCH_NOTIFY_MAX_FIELDS) ? BATCH_NOTIFY_MAX_FIELDS : NbFields;
+  pBatch->MaxLatency = MaxLatency;
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR, &(pBatch->Timer_Id), hw_ts_SingleShot, TimerCb);
+  BATCH_NOTIFY_Set_Att_Mtu(pBatch, BLE_DEFAULT_ATT_MTU);
+}
+
+/**
+ * @brief  Size the packets to the ATT MTU negotiated with the client
+ * @param  pBatch Batch
+ * @param  Mtu    ATT MTU
+ * @retval None
+ */
+void BATCH_NOTIFY_Set_Att_Mtu(BATCH_NOTIFY_t *pBatch, uint16_t Mtu)
+{
+  uint16_t payload = (Mtu > 3U) ? (Mtu - 3U) : 0U;
+
+  if(payload > BATCH_NOTIFY_MAX_PAYLOAD)
+  {
+    payload = BATCH_NOTIFY_MAX_PAYLOAD;
+  }
+
+  /* Send what was packed for the previous size */
+  if(payload < pBatch->Length)
+  {
+    BATCH_NOTIFY_Flush(pBatch);
+  }
+
+  pBatch->MaxPayload = payload;
+}
+
+/**
+ * @brief  Add one sample, notify the batch when full or late
+ * @param  pBatch    Batch
+ * @param  TimeStamp Acquisition time [ms]
+ * @param  pValues   NbFields values
+ * @retval None
+ */
+void BATCH_NOTIFY_Add(BATCH_NOTIFY_t *pBatch, uint32_t TimeStamp, const int16_t *pValues)
+{
+  uint8_t sample[BATCH_NOTIFY_MAX_DELTA_LEN];
+  uint32_t dt;
+  uint16_t len;
+  uint8_t i;
+
+  pBatch->Stats.Samples++;
+
+  if(pBatch->Length != 0U)
+  {
+    dt = TimeStamp - pBatch->LastTimeStamp;
+    len = 0;
+
+    if(dt <= BATCH_NOTIFY_MAX_DT)
+    {
+      sample[len++] = (uint8_t)dt;
+      for(i = 0; i < pBatch->NbFields; i++)
+      {
+        len += BATCH_NOTIFY_Put_Varint(&sample[len], (int16_t)(uint16_t)(pValues[i] - pBatch->Last[i]));
+      }
+    }
+
+    if((len != 0U) && ((pBatch->Length + len) <= pBatch->MaxPayload))
+    {
+      memcpy(&pBatch->Buffer[pBatch->Length], sample, len);
+      pBatch->Length += len;
+      memcpy(pBatch->Last, pValues, pBatch->NbFields * sizeof(int16_t));
+      pBatch->LastTimeStamp = TimeStamp;
+    }
+    else
+    {
+      /* Full, or too far from the previous sample */
+      BATCH_NOTIFY_Flush(pBatch);
+      BATCH_NOTIFY_Start_Packet(pBatch, TimeStamp, pValues);
+    }
+  }
+  else
+  {
+    BATCH_NOTIFY_Start_Packet(pBatch, TimeStamp, pValues);
+  }
+
+  if((TimeStamp - pBatch->FirstTimeStamp) >= pBatch->MaxLatency)
+  {
+    BATCH_NOTIFY_Flush(pBatch);
+  }
+}
+
+/**
+ * @brief  Notify the samples packed so far
+ * @param  pBatch Batch
+ * @retval None
+ */
+void BATCH_NOTIFY_Flush(BATCH_NOTIFY_t *pBatch)
+{
+  if(pBatch->Length == 0U)
+  {
+    return;
+  }
+
+  HW_TS_Stop(pBatch->Timer_Id);
+
+  if(MOTENV_STM_App_Update_Char((MOTENV_STM_Char_t)pBatch->Char, (uint8_t)pBatch->Length, pBatch->Buffer) == BLE_STATUS_SUCCESS)
+  {
+    pBatch->Stats.Packets++;
+    pBatch->Stats.Bytes += pBatch->Length;
+  }
+  else
+  {
+    pBatch->Stats.Dropped++;
+  }
+
+  pBatch->Length = 0;
+}
+
+/**
+ * @brief  Notify the samples packed so far when the first one is late.
+ *         Called on the latency timer, when no sample comes to trigger the flush
+ * @param  pBatch Batch
+ * @param  Now    Current time [ms], same time base as the samples
+ * @retval None
+ */
+void BATCH_NOTIFY_Check_Latency(BATCH_NOTIFY_t *pBatch, uint32_t Now)
+{
+  uint32_t elapsed;
+
+  if(pBatch->Length == 0U)
+  {
+    return;
+  }
+
+  elapsed = Now - pBatch->FirstTimeStamp;
+  if(elapsed >= pBatch->MaxLatency)
+  {
+    BATCH_NOTIFY_Flush(pBatch);
+  }
+  else
+  {
+    /* The timer tick is shorter than 1ms: it may expire just before the deadline */
+    BATCH_NOTIFY_Start_Timer(pBatch, pBatch->MaxLatency - elapsed);
+  }
+}
+
+/**
+ * @brief  Drop the samples packed so far
+ * @param  pBatch Batch
+ * @retval None
+ */
+void BATCH_NOTIFY_Reset(BATCH_NOTIFY_t *pBatch)
+{
+  HW_TS_Stop(pBatch->Timer_Id);
+  pBatch->Length = 0;
+}
+
+/**
+ * @brief  Decode one notification of a batched characteristic
+ * @param  pPacket    Notification payload
+ * @param  Length     Payload length
+ * @param  NbFields   Values per sample
+ * @param  pSamples   Decoded samples
+ * @param  MaxSamples Size of pSamples
+ * @retval Number of samples decoded, -1 when the packet is malformed
+ */
+int32_t BATCH_NOTIFY_Decode(const uint8_t *pPacket, uint16_t Length, uint8_t NbFields,
+                            BATCH_NOTIFY_Sample_t *pSamples, uint16_t MaxSamples)
+{
+  uint16_t pos = BATCH_NOTIFY_HEADER_LEN;
+  uint16_t count = 0;
+  uint8_t i;
+
+  if((NbFields > BATCH_NOTIFY_MAX_FIELDS) || (Length < (BATCH_NOTIFY_HEADER_LEN + (2U * NbFields))) || (MaxSamples == 0U))
+  {
+    return -1;
+  }
+
+  pSamples[0].TimeStamp = (uint16_t)(pPacket[0] | (pPacket[1] << 8));
+  for(i = 0; i < NbFields; i++)
+  {
+    pSamples[0].Values[i] = (int16_t)(uint16_t)(pPacket[pos] | (pPacket[pos + 1U] << 8));
+    pos += 2U;
+  }
+  count = 1;
+
+  while(pos < Length)
+  {
+    if(count >= MaxSamples)
+    {
+      return -1;
+    }
+
+    pSamples[count].TimeStamp = (uint16_t)(pSamples[count - 1U].TimeStamp + pPacket[pos]);
+    pos++;
+
+    for(i = 0; i < NbFields; i++)
+    {
+      uint32_t zigzag = 0;
+      uint8_t shift = 0;
+      uint8_t byte;
+
+      do
+      {
+        if((pos >= Length) || (shift >= (7U * BATCH_NOTIFY_VARINT_MAX_LEN)))
+        {
+          return -1;
+        }
+        byte = pPacket[pos++];
+        zigzag |= (uint32_t)(byte & 0x7FU) << shift;
+        shift += 7U;
+      } while((byte & 0x80U) != 0U);
+
+      pSamples[count].Values[i] = (int16_t)(uint16_t)(pSamples[count - 1U].Values[i] +
+                                                      (int32_t)((zigzag >> 1) ^ (0U - (zigzag & 1U))));
+    }
+    count++;
+  }
+
+  return count;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Start a packet with the absolute time stamp and values
+ * @param  pBatch    Batch
+ * @param  TimeStamp Acquisition time [ms]
+ * @param  pValues   NbFields values
+ * @retval None
+ */
+static void BATCH_NOTIFY_Start_Packet(BATCH_NOTIFY_t *pBatch, uint32_t TimeStamp, const int16_t *pValues)
+{
+  uint8_t i;
+
+  STORE_LE_16(pBatch->Buffer, TimeStamp);
+  pBatch->Length = BATCH_NOTIFY_HEADER_LEN;
+
+  for(i = 0; i < pBatch->NbFields; i++)
+  {
+    STORE_LE_16(&pBatch->Buffer[pBatch->Length], pValues[i]);
+    pBatch->Length += 2U;
+  }
+
+  memcpy(pBatch->Last, pValues, pBatch->NbFields * sizeof(int16_t));
+  pBatch->FirstTimeStamp = TimeStamp;
+  pBatch->LastTimeStamp = TimeStamp;
+
+  BATCH_NOTIFY_Start_Timer(pBatch, pBatch->MaxLatency);
+}
+
+/**
+ * @brief  (Re)arm the latency timer
+ * @param  pBatch Batch
+ * @param  Delay  Time left before the deadline [ms]
+ * @retval None
+ */
+static void BATCH_NOTIFY_Start_Timer(BATCH_NOTIFY_t *pBatch, uint32_t Delay)
+{
+  HW_TS_Stop(pBatch->Timer_Id);
+  if(Delay != 0U)
+  {
+    HW_TS_Start(pBatch->Timer_Id, BATCH_NOTIFY_MS_TO_TICKS(Delay) + 1U);
+  }
+}
+
+/**
+ * @brief  Write a difference as a zigzag varint (7 bits per byte, LSB first)
+ * @param  pBuf  Destination, BATCH_NOTIFY_VARINT_MAX_LEN bytes available
+ * @param  Delta Difference with the previous value
+ * @retval Bytes written
+ */
+static uint8_t BATCH_NOTIFY_Put_Varint(uint8_t *pBuf, int16_t Delta)
+{
+  /* Small differences of both signs give small numbers */
+  uint16_t zigzag = (uint16_t)(((uint16_t)Delta << 1) ^ (uint16_t)(Delta >> 15));
+  uint8_t len = 0;
+
+  while(zigzag >= 0x80U)
+  {
+    pBuf[len++] = (uint8_t)(zigzag | 0x80U);
+    zigzag >>= 7;
+  }
+  pBuf[len++] = (uint8_t)zigzag;
+
+  return len;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,114 @@
+/**
+ ******************************************************************************
+ * File Name          : batch_notify_app.h
+ * Description        : Pack several timestamped samples in one notification
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef BATCH_NOTIFY_APP_H
+#define BATCH_NOTIFY_APP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/**
+ * @brief  Packet layout (little endian):
+ *   [0..1]  Time stamp of the first sample [ms, modulo 2^16]
+ *   [2..]   First sample: NbFields x int16 absolute values
+ *   then, for each next sample:
+ *           uint8 time since the previous sample [ms]
+ *           NbFields x zigzag varint (1 to 3 bytes) difference with the
+ *           previous value of the field
+ *   The number of samples is given by the length of the packet.
+ */
+#define BATCH_NOTIFY_HEADER_LEN         (2)
+#define BATCH_NOTIFY_MAX_FIELDS         (9)
+#ifdef CFG_BLE_MAX_ATT_MTU
+  #define BATCH_NOTIFY_MAX_PAYLOAD      (CFG_BLE_MAX_ATT_MTU - 3)
+#else
+  #define BATCH_NOTIFY_MAX_PAYLOAD      (244)   /* Host build: longest LE payload */
+#endif
+#if (BATCH_NOTIFY_MAX_PAYLOAD > 255)
+  /* aci_gatt_update_char_value() updates up to 255 bytes */
+  #undef BATCH_NOTIFY_MAX_PAYLOAD
+  #define BATCH_NOTIFY_MAX_PAYLOAD      (255)
+#endif
+/* Longest encoding of one sample after the first one */
+#define BATCH_NOTIFY_MAX_DELTA_LEN      (1 + (3 * BATCH_NOTIFY_MAX_FIELDS))
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief  One decoded sample
+ */
+typedef struct
+{
+  uint16_t TimeStamp;                         /* [ms, modulo 2^16] */
+  int16_t Values[BATCH_NOTIFY_MAX_FIELDS];
+} BATCH_NOTIFY_Sample_t;
+
+/**
+ * @brief  Batching statistics
+ */
+typedef struct
+{
+  uint32_t Samples;     /* Samples added */
+  uint32_t Packets;     /* Notifications sent */
+  uint32_t Bytes;       /* Payload bytes sent */
+  uint32_t Dropped;     /* Notifications refused by the stack */
+} BATCH_NOTIFY_Stats_t;
+
+/**
+ * @brief  Batch of one characteristic
+ */
+typedef struct
+{
+  uint8_t Char;                               /* MOTENV_STM_Char_t */
+  uint8_t NbFields;
+  uint8_t Timer_Id;                           /* Latency timer, armed by the first sample */
+  uint16_t Length;                            /* Bytes in Buffer, 0 when empty */
+  uint16_t MaxPayload;                        /* Negotiated ATT MTU - 3 */
+  uint32_t MaxLatency;                        /* Flush deadline after the first sample [ms] */
+  uint32_t FirstTimeStamp;                    /* [ms] */
+  uint32_t LastTimeStamp;                     /* [ms] */
+  int16_t Last[BATCH_NOTIFY_MAX_FIELDS];      /* Values of the previous sample */
+  uint8_t Buffer[BATCH_NOTIFY_MAX_PAYLOAD];
+  BATCH_NOTIFY_Stats_t Stats;
+} BATCH_NOTIFY_t;
+
+/* External variables --------------------------------------------------------*/
+/* Exported macros -----------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+void BATCH_NOTIFY_Init(BATCH_NOTIFY_t *pBatch, uint8_t Char, uint8_t NbFields, uint32_t MaxLatency,
+                       HW_TS_pTimerCb_t TimerCb);
+void BATCH_NOTIFY_Set_Att_Mtu(BATCH_NOTIFY_t *pBatch, uint16_t Mtu);
+void BATCH_NOTIFY_Add(BATCH_NOTIFY_t *pBatch, uint32_t TimeStamp, const int16_t *pValues);
+void BATCH_NOTIFY_Flush(BATCH_NOTIFY_t *pBatch);
+void BATCH_NOTIFY_Check_Latency(BATCH_NOTIFY_t *pBatch, uint32_t Now);
+void BATCH_NOTIFY_Reset(BATCH_NOTIFY_t *pBatch);
+/* Pure function of the packet: reference decoder for the client side */
+int32_t BATCH_NOTIFY_Decode(const uint8_t *pPacket, uint16_t Length, uint8_t NbFields,
+                            BATCH_NOTIFY_Sample_t *pSamples, uint16_t MaxSamples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BATCH_NOTIFY_APP_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -21,6 +21,7 @@
 #include "dbg_trace.h"
 
 #include "motenv_server_app.h"
+#include "notify_app.h"
 #include "config_server_app.h"
 #include "motionfx_server_app.h"
 #include "motion_ext_server_app.h"
@@ -28,6 +29,13 @@
 /* Private defines -----------------------------------------------------------*/
 #define VALUE_LEN_CONFIG        (2+4+1+1)
 
+/* Feature mask and command, then the optional data byte */
+#define CONFIG_COMMAND_LEN      (4+1)
+#define CONFIG_COMMAND_DATA_LEN (4+1+1)
+
+/* Acc events command setting all the events at once, the data is the EXT_HWF_* mask to be enabled */
+#define CONFIG_ACC_EVENTS_SET   'e'
+
 /* Private typedef -----------------------------------------------------------*/
 
 /**
@@ -41,6 +49,18 @@ typedef struct
 
 } CONFIG_Server_App_Context_t;
 
+/**
+ * @brief  Configuration command, identified by its feature mask and command byte
+ */
+typedef struct CONFIG_Command_s
+{
+  uint32_t FeatureMask;
+  uint8_t Command;
+  uint8_t Length;       /* Minimum length of the write */
+  uint8_t Feature;      /* EXT_HWF_* for the Acc events */
+  void (*Handler)(const struct CONFIG_Command_s *pCommand, uint8_t Data);
+} CONFIG_Command_t;
+
 /* Private macros ------------------------------------------------------------*/
 
 /* Private variables ---------------------------------------------------------*/
@@ -50,6 +70,32 @@ PLACE_IN_SECTION("BLE_APP_CONTEXT") static CONFIG_Server_App_Context_t CONFIG_Se
 /* Global variables ----------------------------------------------------------*/
 
 /* Private function prototypes -----------------------------------------------*/
+static void CONFIG_Cal_Status(const CONFIG_Command_t *pCommand, uint8_t Data);
+static void CONFIG_Cal_Reset(const CONFIG_Command_t *pCommand, uint8_t Data);
+static void CONFIG_Acc_Event(const CONFIG_Command_t *pCommand, uint8_t Data);
+static void CONFIG_Acc_Events_Set(const CONFIG_Command_t *pCommand, uint8_t Data);
+
+/* Private constants ---------------------------------------------------------*/
+
+/* W2ST_COMMAND_CAL_STOP and unknown commands are ignored */
+static const CONFIG_Command_t CONFIG_Commands[] =
+{
+  /* Sensor Fusion */
+  {FEATURE_MASK_SENSORFUSION_SHORT, W2ST_COMMAND_CAL_STATUS, CONFIG_COMMAND_LEN,      0,                       CONFIG_Cal_Status},
+  {FEATURE_MASK_SENSORFUSION_SHORT, W2ST_COMMAND_CAL_RESET,  CONFIG_COMMAND_LEN,      0,                       CONFIG_Cal_Reset},
+  {FEATURE_MASK_ECOMPASS,           W2ST_COMMAND_CAL_STATUS, CONFIG_COMMAND_LEN,      0,                       CONFIG_Cal_Status},
+  {FEATURE_MASK_ECOMPASS,           W2ST_COMMAND_CAL_RESET,  CONFIG_COMMAND_LEN,      0,                       CONFIG_Cal_Reset},
+  /* Acc events */
+  {FEATURE_MASK_ACC_EVENTS,         'm',                     CONFIG_COMMAND_DATA_LEN, EXT_HWF_MULTIPLE_EVENTS, CONFIG_Acc_Event},
+  {FEATURE_MASK_ACC_EVENTS,         'f',                     CONFIG_COMMAND_DATA_LEN, EXT_HWF_FREE_FALL,       CONFIG_Acc_Event},
+  {FEATURE_MASK_ACC_EVENTS,         'd',                     CONFIG_COMMAND_DATA_LEN, EXT_HWF_DOUBLE_TAP,      CONFIG_Acc_Event},
+  {FEATURE_MASK_ACC_EVENTS,         's',                     CONFIG_COMMAND_DATA_LEN, EXT_HWF_SINGLE_TAP,      CONFIG_Acc_Event},
+  {FEATURE_MASK_ACC_EVENTS,         'p',                     CONFIG_COMMAND_DATA_LEN, EXT_HWF_PEDOMETER,       CONFIG_Acc_Event},
+  {FEATURE_MASK_ACC_EVENTS,         'w',                     CONFIG_COMMAND_DATA_LEN, EXT_HWF_WAKE_UP,         CONFIG_Acc_Event},
+  {FEATURE_MASK_ACC_EVENTS,         't',                     CONFIG_COMMAND_DATA_LEN, EXT_HWF_TILT,            CONFIG_Acc_Event},
+  {FEATURE_MASK_ACC_EVENTS,         'o',                     CONFIG_COMMAND_DATA_LEN, EXT_HWF_6D_ORIENTATION,  CONFIG_Acc_Event},
+  {FEATURE_MASK_ACC_EVENTS,         CONFIG_ACC_EVENTS_SET,   CONFIG_COMMAND_DATA_LEN, 0,                       CONFIG_Acc_Events_Set},
+};
 
 /* Functions Definition ------------------------------------------------------*/
 
@@ -129,7 +175,7 @@ void CONFIG_Send_Notification(uint32_t Feature, uint8_t Command, uint8_t data)
     APP_DBG_MSG("-- CONFIG APPLICATION SERVER : NOTIFY CLIENT WITH NEW CONFIG PARAMETER VALUE \n ");
     APP_DBG_MSG(" \n\r");
 #endif
-    MOTENV_STM_App_Update_Char(CONFIG_CHAR_UUID, VALUE_LEN_CONFIG, (uint8_t *)&value);
+    NOTIFY_Update_Char(MOTENV_STM_CONFIG_CHAR, VALUE_LEN_CONFIG, (uint8_t *)&value);
   }
   else
   {
@@ -149,147 +195,31 @@ void CONFIG_Send_Notification(uint32_t Feature, uint8_t Command, uint8_t data)
  */
 uint8_t CONFIG_Parse_Command(uint8_t *att_data, uint8_t data_length)
 {
-  uint32_t FeatureMask = (att_data[3]) | (att_data[2]<<8) | (att_data[1]<<16) | (att_data[0]<<24);
-  uint8_t Command = att_data[4];
-  uint8_t Data    = att_data[5];
+  uint32_t FeatureMask;
+  uint8_t Command;
+  uint8_t Data;
   uint8_t SendItBack = 1;
+  uint8_t i;
+
+  if(data_length < CONFIG_COMMAND_LEN)
+  {
+    return SendItBack;
+  }
 
-  switch (FeatureMask)
+  FeatureMask = (att_data[3]) | (att_data[2]<<8) | (att_data[1]<<16) | (att_data[0]<<24);
+  Command = att_data[4];
+  Data = (data_length > CONFIG_COMMAND_LEN) ? att_data[5] : 0;
+
+  for(i = 0; i < (sizeof(CONFIG_Commands) / sizeof(CONFIG_Commands[0])); i++)
   {
-  case FEATURE_MASK_SENSORFUSION_SHORT:
-  case FEATURE_MASK_ECOMPASS:
-    /* Sensor Fusion */
-    switch (Command)
+    if((CONFIG_Commands[i].FeatureMask == FeatureMask) && (CONFIG_Commands[i].Command == Command))
     {
-    case W2ST_COMMAND_CAL_STATUS:
-      /* Reply with the calibration status for the feature */
-      /* Control the calibration status */
+      if(data_length >= CONFIG_Commands[i].Length)
       {
-        CONFIG_Send_Notification(FeatureMask, Command, MOTIONFX_Get_MagCalStatus() ? 100: 0);
-      }
-      break;
-    case W2ST_COMMAND_CAL_RESET:
-      /* Reset the calibration */
-      MOTIONFX_ReCalibration();
-      break;
-    case W2ST_COMMAND_CAL_STOP:
-      /* Do nothing in this case */
-      break;
-    default:
-      break;
-    }
-    break;
-    
-  case FEATURE_MASK_ACC_EVENTS:
-    /* Acc events */
-    switch (Command)
-    {
-    case 'm':
-      /* Multiple Events */
-      switch(Data) {
-      case 1:
-        MOTION_EXT_Enable_Feature(EXT_HWF_MULTIPLE_EVENTS);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
-      case 0:
-        MOTION_EXT_Disable_Feature(EXT_HWF_MULTIPLE_EVENTS);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
-      }
-      break;
-    case 'f':
-      /* FreeFall */
-      switch(Data) {
-      case 1:
-        MOTION_EXT_Enable_Feature(EXT_HWF_FREE_FALL);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
-      case 0:
-        MOTION_EXT_Disable_Feature(EXT_HWF_FREE_FALL);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
-      }
-      break;
-    case 'd':
-      /* Double Tap */
-      switch(Data) {
-      case 1:
-        MOTION_EXT_Enable_Feature(EXT_HWF_DOUBLE_TAP);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
-      case 0:
-        MOTION_EXT_Disable_Feature(EXT_HWF_DOUBLE_TAP);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
-      }
-      break;
-    case 's':
-      /* Single Tap */
-      switch(Data) {
-      case 1:
-        MOTION_EXT_Enable_Feature(EXT_HWF_SINGLE_TAP);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
-      case 0:
-        MOTION_EXT_Disable_Feature(EXT_HWF_SINGLE_TAP);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
-      }
-      break;
-    case 'p':
-      /* Pedometer */
-      switch(Data) {
-      case 1:
-        MOTION_EXT_Enable_Feature(EXT_HWF_PEDOMETER);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
-      case 0:
-        MOTION_EXT_Disable_Feature(EXT_HWF_PEDOMETER);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
-      }
-      break;
-    case 'w':
-      /* Wake UP */
-      switch(Data) {
-      case 1:
-        MOTION_EXT_Enable_Feature(EXT_HWF_WAKE_UP);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
-      case 0:
-        MOTION_EXT_Disable_Feature(EXT_HWF_WAKE_UP);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
-      }
-      break;
-    case 't':
-      /* Tilt */
-      switch(Data) {
-      case 1:
-        MOTION_EXT_Enable_Feature(EXT_HWF_TILT);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
-      case 0:
-        MOTION_EXT_Disable_Feature(EXT_HWF_TILT);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
-      }
-      break;
-    case 'o' :
-      /* 6DOrientation */
-      switch(Data) {
-      case 1:
-        MOTION_EXT_Enable_Feature(EXT_HWF_6D_ORIENTATION);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
-      case 0:
-        MOTION_EXT_Disable_Feature(EXT_HWF_6D_ORIENTATION);
-        CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS,Command,Data);
-        break;
+        CONFIG_Commands[i].Handler(&CONFIG_Commands[i], Data);
       }
       break;
     }
-    break;
   }
 
   return SendItBack;
@@ -297,4 +227,58 @@ uint8_t CONFIG_Parse_Command(uint8_t *att_data, uint8_t data_length)
 
 /* Private functions ---------------------------------------------------------*/
 
+/**
+ * @brief  Reply with the calibration status for the feature
+ * @param  pCommand The command received
+ * @param  Data Unused
+ * @retval None
+ */
+static void CONFIG_Cal_Status(const CONFIG_Command_t *pCommand, uint8_t Data)
+{
+  CONFIG_Send_Notification(pCommand->FeatureMask, pCommand->Command, MOTIONFX_Get_MagCalStatus() ? 100: 0);
+}
+
+/**
+ * @brief  Reset the calibration
+ * @param  pCommand The command received
+ * @param  Data Unused
+ * @retval None
+ */
+static void CONFIG_Cal_Reset(const CONFIG_Command_t *pCommand, uint8_t Data)
+{
+  MOTIONFX_ReCalibration();
+}
+
+/**
+ * @brief  Enable (Data 1) or disable (Data 0) one Accelerometer event
+ * @param  pCommand The command received
+ * @param  Data The new event status
+ * @retval None
+ */
+static void CONFIG_Acc_Event(const CONFIG_Command_t *pCommand, uint8_t Data)
+{
+  switch(Data)
+  {
+  case 1:
+    MOTION_EXT_Enable_Feature(pCommand->Feature);
+    CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS, pCommand->Command, Data);
+    break;
+  case 0:
+    MOTION_EXT_Disable_Feature(pCommand->Feature);
+    CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS, pCommand->Command, Data);
+    break;
+  }
+}
+
+/**
+ * @brief  Enable the Accelerometer events of the Data mask and disable the others
+ * @param  pCommand The command received
+ * @param  Data The EXT_HWF_* events to be enabled
+ * @retval None
+ */
+static void CONFIG_Acc_Events_Set(const CONFIG_Command_t *pCommand, uint8_t Data)
+{
+  CONFIG_Send_Notification(FEATURE_MASK_ACC_EVENTS, pCommand->Command, MOTION_EXT_Set_Features(Data));
+}
+
  /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
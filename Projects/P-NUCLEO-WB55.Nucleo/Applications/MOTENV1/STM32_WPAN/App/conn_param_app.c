@@ -0,0 +1,439 @@
+/**
+ ******************************************************************************
+ * File Name          : conn_param_app.c
+ * Description        : Connection interval requested for the notifications
+ *                      enabled
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "app_common.h"
+#include "dbg_trace.h"
+#include "ble.h"
+#include "stm32_seq.h"
+
+#include "motenv_server_app.h"
+#include "conn_param_app.h"
+
+/* Private defines -----------------------------------------------------------*/
+/* No interval requested since the last one in use was right */
+#define CONN_PARAM_NO_STEP              (0xFF)
+
+/* Answer of the central expected within the L2CAP RTX timer */
+#define CONN_PARAM_RESP_TIMEOUT_MS      (30000)
+
+/* Notifications per 1000s sent at each interval (1.25ms unit) */
+#define CONN_PARAM_CAPACITY(interval)   ((uint32_t)CFG_CONN_PARAM_NOTIFY_PER_EVENT*800000UL/(interval))
+
+#define CONN_PARAM_MS_TO_TICKS(ms)      ((uint32_t)(ms)*1000/CFG_TS_TICK_VAL)
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * @brief  Connection interval range requested [1.25ms]
+ */
+typedef struct
+{
+  uint16_t Min;
+  uint16_t Max;
+} CONN_PARAM_Step_t;
+
+/**
+ * @brief  Connection Parameters Context structure definition
+ */
+typedef struct
+{
+  uint32_t Rate[MOTENV_STM_CHAR_NUMBER]; /* Notifications per 1000s of each char enabled */
+  uint32_t Deadline;            /* HAL_GetTick() before which Target is not requested */
+  uint16_t ConnectionHandle;
+  uint16_t Interval;            /* Interval in use [1.25ms], 0 while not connected */
+  uint8_t Target;               /* Step of CONN_PARAM_Ladder requested */
+  uint8_t Attempts;             /* Requests of Target */
+  uint8_t Pending;              /* Request waiting for the answer of the central */
+  uint8_t Wait;                 /* Deadline running */
+  uint8_t Holding;              /* Deadline delays slowing down */
+  volatile uint8_t Timer_Running;
+  uint8_t Timer_Id;
+} CONN_PARAM_Context_t;
+
+/* Private macros ------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+PLACE_IN_SECTION("BLE_APP_CONTEXT") static CONN_PARAM_Context_t CONN_PARAM_Context;
+
+/**
+ * Intervals requested, the fastest first: multiples of 15ms and a range of
+ * at least 15ms, as the iOS centrals accept them
+ */
+static const CONN_PARAM_Step_t CONN_PARAM_Ladder[] =
+{
+  {CONN_P(15),  CONN_P(15)},
+  {CONN_P(30),  CONN_P(45)},
+  {CONN_P(60),  CONN_P(75)},
+  {CONN_P(120), CONN_P(135)},
+  {CONN_P(240), CONN_P(255)},
+  {CONN_P(480), CONN_P(495)},
+  {CONN_P(960), CONN_P(975)}
+};
+
+#define CONN_PARAM_STEP_NUMBER          (sizeof(CONN_PARAM_Ladder)/sizeof(CONN_PARAM_Ladder[0]))
+
+/* Global variables ----------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t CONN_PARAM_Step(uint32_t Rate, uint32_t Margin);
+static void CONN_PARAM_Evaluate(void);
+static void CONN_PARAM_Request(void);
+static void CONN_PARAM_Wait(uint32_t Delay);
+static uint8_t CONN_PARAM_Deadline_Reached(void);
+static void CONN_PARAM_Timer_Callback(void);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Init the Connection Parameters Context
+ * @param  None
+ * @retval None
+ */
+void CONN_PARAM_Init(void)
+{
+  memset(&CONN_PARAM_Context, 0, sizeof(CONN_PARAM_Context));
+  CONN_PARAM_Context.Target = CONN_PARAM_NO_STEP;
+
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+               &(CONN_PARAM_Context.Timer_Id),
+               hw_ts_SingleShot,
+               CONN_PARAM_Timer_Callback);
+}
+
+/**
+ * @brief  Notifications of a char enabled or disabled
+ * @param  Char   Characteristic
+ * @param  Period Time between two notifications [Timer Server ticks],
+ *                0 when the notifications are disabled
+ * @retval None
+ */
+void CONN_PARAM_Set_Char(MOTENV_STM_Char_t Char, uint32_t Period)
+{
+  if(Char >= MOTENV_STM_CHAR_NUMBER)
+  {
+    return;
+  }
+
+  if(Period == 0U)
+  {
+    CONN_PARAM_Context.Rate[Char] = 0;
+  }
+  else
+  {
+    CONN_PARAM_Context.Rate[Char] = (uint32_t)(1000000000UL / (Period * CFG_TS_TICK_VAL));
+  }
+  UTIL_SEQ_SetTask(1<<CFG_TASK_CONN_PARAM_ID, CFG_SCH_PRIO_0);
+}
+
+/**
+ * @brief  Connected as peripheral
+ * @param  ConnectionHandle Connection handle
+ * @param  Interval         Interval chosen by the central [1.25ms]
+ * @retval None
+ */
+void CONN_PARAM_Connected(uint16_t ConnectionHandle, uint16_t Interval)
+{
+  CONN_PARAM_Context.ConnectionHandle = ConnectionHandle;
+  CONN_PARAM_Context.Interval = Interval;
+  UTIL_SEQ_SetTask(1<<CFG_TASK_CONN_PARAM_ID, CFG_SCH_PRIO_0);
+}
+
+/**
+ * @brief  The central changed the connection parameters
+ * @param  ConnectionHandle Connection handle
+ * @param  Interval         Interval in use [1.25ms]
+ * @retval None
+ */
+void CONN_PARAM_Updated(uint16_t ConnectionHandle, uint16_t Interval)
+{
+  if((CONN_PARAM_Context.Interval == 0U) || (ConnectionHandle != CONN_PARAM_Context.ConnectionHandle))
+  {
+    return;
+  }
+
+  CONN_PARAM_Context.Interval = Interval;
+  UTIL_SEQ_SetTask(1<<CFG_TASK_CONN_PARAM_ID, CFG_SCH_PRIO_0);
+}
+
+/**
+ * @brief  Answer of the central to the L2CAP Connection Parameter Update Request.
+ *         Accepted or not, the same interval is requested again after a
+ *         delay if the interval in use is still not right
+ * @param  ConnectionHandle Connection handle
+ * @param  Result           0 accepted, 1 rejected
+ * @retval None
+ */
+void CONN_PARAM_Update_Resp(uint16_t ConnectionHandle, uint16_t Result)
+{
+  if((CONN_PARAM_Context.Pending == 0U) || (ConnectionHandle != CONN_PARAM_Context.ConnectionHandle))
+  {
+    return;
+  }
+
+  CONN_PARAM_Context.Pending = 0;
+#if(CFG_DEBUG_APP_TRACE != 0)
+  APP_DBG_MSG("-- CONN PARAM : %d..%d x1.25ms %s\n",
+              CONN_PARAM_Ladder[CONN_PARAM_Context.Target].Min,
+              CONN_PARAM_Ladder[CONN_PARAM_Context.Target].Max,
+              (Result == 0U) ? "accepted" : "rejected");
+#endif
+  CONN_PARAM_Wait((uint32_t)CFG_CONN_PARAM_RETRY_MS << (CONN_PARAM_Context.Attempts - 1U));
+  UTIL_SEQ_SetTask(1<<CFG_TASK_CONN_PARAM_ID, CFG_SCH_PRIO_0);
+}
+
+/**
+ * @brief  Forget the connection and the notifications enabled
+ * @param  None
+ * @retval None
+ */
+void CONN_PARAM_Disconnected(void)
+{
+  HW_TS_Stop(CONN_PARAM_Context.Timer_Id);
+  CONN_PARAM_Context.Timer_Running = 0;
+  memset(CONN_PARAM_Context.Rate, 0, sizeof(CONN_PARAM_Context.Rate));
+  CONN_PARAM_Context.Interval = 0;
+  CONN_PARAM_Context.Target = CONN_PARAM_NO_STEP;
+  CONN_PARAM_Context.Attempts = 0;
+  CONN_PARAM_Context.Pending = 0;
+  CONN_PARAM_Context.Wait = 0;
+  CONN_PARAM_Context.Holding = 0;
+}
+
+/**
+ * @brief  Request the interval matching the notifications enabled, when the
+ *         one in use does not match
+ * @param  None
+ * @retval None
+ */
+void CONN_PARAM_Task(void)
+{
+#if (CFG_CONN_PARAM_ADAPTIVE != 0)
+  if(CONN_PARAM_Context.Interval == 0U)
+  {
+    return;
+  }
+
+  if(CONN_PARAM_Context.Pending != 0U)
+  {
+    if(CONN_PARAM_Deadline_Reached() != 0U)
+    {
+      /* No answer: the central dropped the request */
+      CONN_PARAM_Context.Pending = 0;
+      CONN_PARAM_Wait((uint32_t)CFG_CONN_PARAM_RETRY_MS << (CONN_PARAM_Context.Attempts - 1U));
+    }
+    /* Evaluated again on the answer */
+    return;
+  }
+
+  CONN_PARAM_Evaluate();
+#endif
+}
+
+/**
+ * @brief  Notifications per 1000s of all the chars enabled
+ * @param  None
+ * @retval Rate
+ */
+uint32_t CONN_PARAM_Get_Required_Rate(void)
+{
+  uint32_t rate = 0;
+  uint8_t i;
+
+  for(i = 0; i < (uint8_t)MOTENV_STM_CHAR_NUMBER; i++)
+  {
+    rate += CONN_PARAM_Context.Rate[i];
+  }
+  return rate;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Slowest step sending Rate with Margin % of its capacity, the
+ *         fastest one when none does
+ * @param  Rate   Notifications per 1000s
+ * @param  Margin Part of the capacity used [%]
+ * @retval Step of CONN_PARAM_Ladder
+ */
+static uint8_t CONN_PARAM_Step(uint32_t Rate, uint32_t Margin)
+{
+  uint8_t step = (uint8_t)(CONN_PARAM_STEP_NUMBER - 1U);
+
+  while((step > 0U) && ((CONN_PARAM_CAPACITY(CONN_PARAM_Ladder[step].Max) / 100U * Margin) < Rate))
+  {
+    step--;
+  }
+  return step;
+}
+
+/**
+ * @brief  Compare the interval in use with the notifications enabled.
+ *         Too slow: the step fitting them with CFG_CONN_PARAM_MARGIN is
+ *         requested at once. Faster than this step: it is requested once the
+ *         rate stayed this low CFG_CONN_PARAM_HOLD_MS, so a feature enabled
+ *         again soon does not cost two updates. In between: nothing to do
+ * @param  None
+ * @retval None
+ */
+static void CONN_PARAM_Evaluate(void)
+{
+  uint32_t rate = CONN_PARAM_Get_Required_Rate();
+  uint16_t interval = CONN_PARAM_Context.Interval;
+  uint8_t step = CONN_PARAM_Step(rate, CFG_CONN_PARAM_MARGIN);
+  uint8_t faster;
+
+  if(interval > CONN_PARAM_Ladder[CONN_PARAM_Step(rate, 100)].Max)
+  {
+    faster = 1;
+  }
+  else if(interval < CONN_PARAM_Ladder[step].Min)
+  {
+    faster = 0;
+  }
+  else
+  {
+    HW_TS_Stop(CONN_PARAM_Context.Timer_Id);
+    CONN_PARAM_Context.Timer_Running = 0;
+    CONN_PARAM_Context.Target = CONN_PARAM_NO_STEP;
+    CONN_PARAM_Context.Wait = 0;
+    CONN_PARAM_Context.Holding = 0;
+    return;
+  }
+
+  if(step != CONN_PARAM_Context.Target)
+  {
+    CONN_PARAM_Context.Target = step;
+    CONN_PARAM_Context.Attempts = 0;
+    CONN_PARAM_Context.Wait = 0;
+    CONN_PARAM_Context.Holding = 0;
+    if(faster == 0U)
+    {
+      CONN_PARAM_Context.Holding = 1;
+      CONN_PARAM_Wait(CFG_CONN_PARAM_HOLD_MS);
+    }
+  }
+  else if((faster != 0U) && (CONN_PARAM_Context.Holding != 0U))
+  {
+    /* The hold only delays slowing down */
+    CONN_PARAM_Context.Wait = 0;
+    CONN_PARAM_Context.Holding = 0;
+  }
+
+  if(CONN_PARAM_Context.Attempts >= CFG_CONN_PARAM_MAX_RETRY)
+  {
+    /* Given up until another step is needed */
+    return;
+  }
+
+  if(CONN_PARAM_Context.Wait != 0U)
+  {
+    if(CONN_PARAM_Deadline_Reached() == 0U)
+    {
+      return;
+    }
+    CONN_PARAM_Context.Wait = 0;
+    CONN_PARAM_Context.Holding = 0;
+  }
+
+  CONN_PARAM_Request();
+}
+
+/**
+ * @brief  Send the L2CAP Connection Parameter Update Request of Target
+ * @param  None
+ * @retval None
+ */
+static void CONN_PARAM_Request(void)
+{
+  const CONN_PARAM_Step_t *pStep = &CONN_PARAM_Ladder[CONN_PARAM_Context.Target];
+  tBleStatus status;
+
+  status = aci_l2cap_connection_parameter_update_req(CONN_PARAM_Context.ConnectionHandle,
+                                                     pStep->Min,
+                                                     pStep->Max,
+                                                     CFG_CONN_PARAM_SLAVE_LATENCY,
+                                                     CFG_CONN_PARAM_TIMEOUT_MULTIPLIER);
+  CONN_PARAM_Context.Attempts++;
+#if(CFG_DEBUG_APP_TRACE != 0)
+  APP_DBG_MSG("-- CONN PARAM : %d -> %d..%d x1.25ms for %ld notifications/1000s, status 0x%x\n",
+              CONN_PARAM_Context.Interval, pStep->Min, pStep->Max,
+              CONN_PARAM_Get_Required_Rate(), status);
+#endif
+
+  if(status == BLE_STATUS_SUCCESS)
+  {
+    CONN_PARAM_Context.Pending = 1;
+    CONN_PARAM_Wait(CONN_PARAM_RESP_TIMEOUT_MS);
+  }
+  else
+  {
+    /* Procedure already running or busy link layer */
+    CONN_PARAM_Wait((uint32_t)CFG_CONN_PARAM_RETRY_MS << (CONN_PARAM_Context.Attempts - 1U));
+  }
+}
+
+/**
+ * @brief  Run the task again after a delay
+ * @param  Delay Delay [ms]
+ * @retval None
+ */
+static void CONN_PARAM_Wait(uint32_t Delay)
+{
+  CONN_PARAM_Context.Deadline = HAL_GetTick() + Delay;
+  CONN_PARAM_Context.Wait = 1;
+  CONN_PARAM_Context.Timer_Running = 1;
+  HW_TS_Start(CONN_PARAM_Context.Timer_Id, CONN_PARAM_MS_TO_TICKS(Delay));
+}
+
+/**
+ * @brief  Check the delay set by CONN_PARAM_Wait() is over, else wait for
+ *         the rest of it (the timer may expire a tick early)
+ * @param  None
+ * @retval 1 if the delay is over, 0 otherwise
+ */
+static uint8_t CONN_PARAM_Deadline_Reached(void)
+{
+  int32_t remaining = (int32_t)(CONN_PARAM_Context.Deadline - HAL_GetTick());
+
+  if(remaining <= 0)
+  {
+    return 1;
+  }
+  if(CONN_PARAM_Context.Timer_Running == 0U)
+  {
+    CONN_PARAM_Context.Timer_Running = 1;
+    HW_TS_Start(CONN_PARAM_Context.Timer_Id, CONN_PARAM_MS_TO_TICKS(remaining) + 1U);
+  }
+  return 0;
+}
+
+/**
+ * @brief  On timeout, trigger the task evaluating the interval
+ * @param  None
+ * @retval None
+ */
+static void CONN_PARAM_Timer_Callback(void)
+{
+  CONN_PARAM_Context.Timer_Running = 0;
+  UTIL_SEQ_SetTask(1<<CFG_TASK_CONN_PARAM_ID, CFG_SCH_PRIO_0);
+}
+
+ /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
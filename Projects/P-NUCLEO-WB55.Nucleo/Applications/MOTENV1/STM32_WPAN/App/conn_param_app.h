@@ -0,0 +1,48 @@
+/**
+ ******************************************************************************
+ * File Name          : conn_param_app.h
+ * Description        : Connection interval requested for the notifications
+ *                      enabled
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef CONN_PARAM_APP_H
+#define CONN_PARAM_APP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Exported macros -----------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+void CONN_PARAM_Init(void);
+void CONN_PARAM_Set_Char(MOTENV_STM_Char_t Char, uint32_t Period);
+void CONN_PARAM_Connected(uint16_t ConnectionHandle, uint16_t Interval);
+void CONN_PARAM_Updated(uint16_t ConnectionHandle, uint16_t Interval);
+void CONN_PARAM_Update_Resp(uint16_t ConnectionHandle, uint16_t Result);
+void CONN_PARAM_Disconnected(void);
+void CONN_PARAM_Task(void);
+uint32_t CONN_PARAM_Get_Required_Rate(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONN_PARAM_APP_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -19,26 +19,43 @@
 #include "app_common.h"
 #include "ble.h"
 #include "dbg_trace.h"
+#include "stm32_seq.h"
 
 #include "motenv_server_app.h"
 #include "console_server_app.h"
 
 /* Private defines -----------------------------------------------------------*/
-#define CONSOLE_MAX_CHAR_LEN (20)
+/* Char value length, see CONSOLE_CHAR_LEN in motenv_stm.c */
+#define CONSOLE_MAX_CHAR_LEN (CFG_BLE_MAX_ATT_MTU - 3)
+/* Bytes waiting for the link, per char */
+#define CONSOLE_TX_BUFFER_SIZE (512)
 
 /* Private typedef -----------------------------------------------------------*/
 
 /**
- * @brief  Console Service Context structure definition
+ * @brief  Transmit queue of one Console char
  */
 typedef struct
 {
-  uint8_t TermNotificationStatus;
-  uint8_t StderrNotificationStatus;
-  uint8_t ConsoleIsInitalized;
-  uint8_t LastTermBuffer[CONSOLE_MAX_CHAR_LEN];
-  uint8_t LastTermLen;
+  MOTENV_STM_Char_t Char;
+  uint8_t NotificationStatus;
+  uint16_t Head;                /* Next byte to notify */
+  uint16_t Count;               /* Bytes waiting */
+  uint8_t Buffer[CONSOLE_TX_BUFFER_SIZE];
+  uint8_t Last[CONSOLE_MAX_CHAR_LEN];   /* Last notification, sent again on a read request */
+  uint8_t LastLen;
+  uint32_t Dropped;             /* Bytes lost: queue full or refused by the stack */
+} CONSOLE_Tx_Queue_t;
 
+/**
+ * @brief  Console Service Context structure definition
+ */
+typedef struct
+{
+  CONSOLE_Tx_Queue_t Term;
+  CONSOLE_Tx_Queue_t Stderr;
+  uint8_t MaxPayload;           /* Negotiated ATT MTU - 3 */
+  uint8_t WaitTxPool;           /* Stack buffers full: wait for ACI_GATT_TX_POOL_AVAILABLE */
 } CONSOLE_Server_App_Context_t;
 
 /* Private macros ------------------------------------------------------------*/
@@ -50,6 +67,10 @@ PLACE_IN_SECTION("BLE_APP_CONTEXT") static CONSOLE_Server_App_Context_t CONSOLE_
 /* Global variables ----------------------------------------------------------*/
 
 /* Private function prototypes -----------------------------------------------*/
+static void CONSOLE_Write(CONSOLE_Tx_Queue_t *pQueue, const uint8_t *data, uint16_t length);
+static void CONSOLE_Set_Queue_Status(CONSOLE_Tx_Queue_t *pQueue, uint8_t status);
+static uint8_t CONSOLE_Send_Next(CONSOLE_Tx_Queue_t *pQueue);
+static void CONSOLE_Update_AfterRead(const CONSOLE_Tx_Queue_t *pQueue);
 
 /* Functions Definition ------------------------------------------------------*/
 
@@ -62,8 +83,10 @@ PLACE_IN_SECTION("BLE_APP_CONTEXT") static CONSOLE_Server_App_Context_t CONSOLE_
  */
 void CONSOLE_Context_Init(void)
 {
-  CONSOLE_Set_Term_Notification_Status(0);
-  CONSOLE_Set_Stderr_Notification_Status(0);
+  memset(&CONSOLE_Server_App_Context, 0, sizeof(CONSOLE_Server_App_Context));
+  CONSOLE_Server_App_Context.Term.Char = MOTENV_STM_CONSOLE_TERM_CHAR;
+  CONSOLE_Server_App_Context.Stderr.Char = MOTENV_STM_CONSOLE_STDERR_CHAR;
+  CONSOLE_Set_Att_Mtu(BLE_DEFAULT_ATT_MTU);
 }
 
 /**
@@ -73,7 +96,7 @@ void CONSOLE_Context_Init(void)
  */
 void CONSOLE_Set_Term_Notification_Status(uint8_t status)
 {
-  CONSOLE_Server_App_Context.TermNotificationStatus = status;
+  CONSOLE_Set_Queue_Status(&CONSOLE_Server_App_Context.Term, status);
 }
 
 /**
@@ -83,119 +106,232 @@ void CONSOLE_Set_Term_Notification_Status(uint8_t status)
  */
 void CONSOLE_Set_Stderr_Notification_Status(uint8_t status)
 {
-  CONSOLE_Server_App_Context.StderrNotificationStatus = status;
+  CONSOLE_Set_Queue_Status(&CONSOLE_Server_App_Context.Stderr, status);
+}
+
+/**
+ * @brief  Size the notifications to the negotiated ATT MTU
+ * @param  Mtu ATT MTU
+ * @retval None
+ */
+void CONSOLE_Set_Att_Mtu(uint16_t Mtu)
+{
+  uint16_t payload = (Mtu > 3U) ? (Mtu - 3U) : 0U;
+
+  CONSOLE_Server_App_Context.MaxPayload = (payload > CONSOLE_MAX_CHAR_LEN) ? CONSOLE_MAX_CHAR_LEN : (uint8_t)payload;
 }
 
 /**
- * @brief  Send a notification for Terminal char
+ * @brief  Queue a string on the Terminal char. It is notified by
+ *         CONSOLE_Tx_Task(), small writes packed up to the ATT MTU
  * @param  data String to write
- * @param  lenght Lengt of string to write
+ * @param  length Length of string to write
  * @retval None
  */
 void CONSOLE_Term_Update(uint8_t *data, uint8_t length)
 {
-  uint8_t Offset;
-  uint8_t DataToSend;
+  CONSOLE_Write(&CONSOLE_Server_App_Context.Term, data, length);
+}
+
+/**
+ * @brief Send a notification for Terminal char value after a read request
+ * @param None
+ * @retval None
+ */
+void CONSOLE_Term_Update_AfterRead(void)
+{
+  CONSOLE_Update_AfterRead(&CONSOLE_Server_App_Context.Term);
+}
+
+/**
+ * @brief  Queue a string on the Stderr char
+ * @param  data String to write
+ * @param  length Length of string to write
+ * @retval None
+ */
+void CONSOLE_Stderr_Update(uint8_t *data, uint8_t length)
+{
+  CONSOLE_Write(&CONSOLE_Server_App_Context.Stderr, data, length);
+}
+
+/**
+ * @brief Send a notification for Stderr char value after a read request
+ * @param None
+ * @retval None
+ */
+void CONSOLE_Stderr_Update_AfterRead(void)
+{
+  CONSOLE_Update_AfterRead(&CONSOLE_Server_App_Context.Stderr);
+}
 
-  if(CONSOLE_Server_App_Context.TermNotificationStatus)
+/**
+ * @brief  The stack has buffers again for the notifications
+ * @param  None
+ * @retval None
+ */
+void CONSOLE_Tx_Pool_Available(void)
+{
+  if(CONSOLE_Server_App_Context.WaitTxPool != 0U)
   {
-    /* Split the code in packages */
-    for(Offset =0; Offset<length; Offset += CONSOLE_MAX_CHAR_LEN)
-    {
-      DataToSend = (length-Offset);
-      DataToSend = (DataToSend>CONSOLE_MAX_CHAR_LEN) ?  CONSOLE_MAX_CHAR_LEN : DataToSend;
-      
-      /* keep a copy */
-      memcpy(CONSOLE_Server_App_Context.LastTermBuffer,data+Offset,DataToSend);
-      CONSOLE_Server_App_Context.LastTermLen = DataToSend;
-      
-#if(CFG_DEBUG_APP_TRACE != 0)
-      APP_DBG_MSG("-- CONSOLE APPLICATION SERVER : NOTIFY CLIENT WITH NEW TERM PARAMETER VALUE \n ");
-      APP_DBG_MSG(" \n\r");
-#endif
-      MOTENV_STM_App_Update_Char(CONSOLE_TERM_CHAR_UUID, DataToSend, data+Offset);
-      
-      HAL_Delay(20);
-    }
+    CONSOLE_Server_App_Context.WaitTxPool = 0;
+    UTIL_SEQ_SetTask(1<<CFG_TASK_CONSOLE_TX_ID, CFG_SCH_PRIO_0);
+  }
+}
+
+/**
+ * @brief  Notify one packet of each Console char and run again while
+ *         bytes are waiting, so that the other tasks are served in between
+ * @param  None
+ * @retval None
+ */
+void CONSOLE_Tx_Task(void)
+{
+  uint8_t more;
+
+  if(CONSOLE_Server_App_Context.WaitTxPool != 0U)
+  {
+    return;
   }
 
-  return;
+  more = CONSOLE_Send_Next(&CONSOLE_Server_App_Context.Term);
+  if(CONSOLE_Server_App_Context.WaitTxPool == 0U)
+  {
+    more |= CONSOLE_Send_Next(&CONSOLE_Server_App_Context.Stderr);
+  }
+
+  if((more != 0U) && (CONSOLE_Server_App_Context.WaitTxPool == 0U))
+  {
+    UTIL_SEQ_SetTask(1<<CFG_TASK_CONSOLE_TX_ID, CFG_SCH_PRIO_0);
+  }
 }
 
+/* Private functions ---------------------------------------------------------*/
+
 /**
- * @brief Send a notification for Terminal char value after a read request
- * @param None
+ * @brief  Append a string to a transmit queue
+ * @param  pQueue Queue of the char
+ * @param  data   String to write
+ * @param  length Length of string to write
  * @retval None
  */
-void CONSOLE_Term_Update_AfterRead(void)
+static void CONSOLE_Write(CONSOLE_Tx_Queue_t *pQueue, const uint8_t *data, uint16_t length)
 {
-  if(CONSOLE_Server_App_Context.TermNotificationStatus)
+  uint16_t tail;
+  uint16_t chunk;
+
+  if(pQueue->NotificationStatus == 0U)
   {
-#if(CFG_DEBUG_APP_TRACE != 0)
-      APP_DBG_MSG("-- CONSOLE APPLICATION SERVER : NOTIFY CLIENT WITH NEW TERM PARAMETER VALUE \n ");
-      APP_DBG_MSG(" \n\r");
-#endif
-      MOTENV_STM_App_Update_Char(CONSOLE_TERM_CHAR_UUID, CONSOLE_Server_App_Context.LastTermLen, CONSOLE_Server_App_Context.LastTermBuffer);
+    return;
   }
 
-  return;
+  if(length > (CONSOLE_TX_BUFFER_SIZE - pQueue->Count))
+  {
+    pQueue->Dropped += length - (CONSOLE_TX_BUFFER_SIZE - pQueue->Count);
+    length = CONSOLE_TX_BUFFER_SIZE - pQueue->Count;
+  }
+
+  while(length != 0U)
+  {
+    tail = (pQueue->Head + pQueue->Count) % CONSOLE_TX_BUFFER_SIZE;
+    chunk = CONSOLE_TX_BUFFER_SIZE - tail;
+    chunk = (chunk > length) ? length : chunk;
+    memcpy(&pQueue->Buffer[tail], data, chunk);
+    pQueue->Count += chunk;
+    data += chunk;
+    length -= chunk;
+  }
+
+  if(CONSOLE_Server_App_Context.WaitTxPool == 0U)
+  {
+    UTIL_SEQ_SetTask(1<<CFG_TASK_CONSOLE_TX_ID, CFG_SCH_PRIO_0);
+  }
 }
 
 /**
- * @brief  Send a notification for Stderr char
- * @param  data String to write
- * @param  lenght Lengt of string to write
+ * @brief  Enable/disable a char, the bytes not sent are dropped
+ * @param  pQueue Queue of the char
+ * @param  status The new notification status
  * @retval None
  */
-void CONSOLE_Stderr_Update(uint8_t *data, uint8_t length)
+static void CONSOLE_Set_Queue_Status(CONSOLE_Tx_Queue_t *pQueue, uint8_t status)
 {
-  uint8_t Offset;
-  uint8_t DataToSend;
+  pQueue->NotificationStatus = status;
+  pQueue->Head = 0;
+  pQueue->Count = 0;
+  if((CONSOLE_Server_App_Context.Term.NotificationStatus == 0U) &&
+     (CONSOLE_Server_App_Context.Stderr.NotificationStatus == 0U))
+  {
+    CONSOLE_Server_App_Context.WaitTxPool = 0;
+  }
+}
 
-  if(CONSOLE_Server_App_Context.StderrNotificationStatus)
+/**
+ * @brief  Notify the oldest bytes waiting, up to the ATT MTU
+ * @param  pQueue Queue of the char
+ * @retval 1 if bytes are still waiting, 0 otherwise
+ */
+static uint8_t CONSOLE_Send_Next(CONSOLE_Tx_Queue_t *pQueue)
+{
+  uint8_t packet[CONSOLE_MAX_CHAR_LEN];
+  uint16_t len;
+  uint16_t chunk;
+  tBleStatus status;
+
+  if(pQueue->Count == 0U)
   {
-    /* Split the code in packages */
-    for(Offset =0; Offset<length; Offset += CONSOLE_MAX_CHAR_LEN)
-    {
-      DataToSend = (length-Offset);
-      DataToSend = (DataToSend>CONSOLE_MAX_CHAR_LEN) ?  CONSOLE_MAX_CHAR_LEN : DataToSend;
-      
-      /* keep a copy */
-      memcpy(CONSOLE_Server_App_Context.LastTermBuffer,data+Offset,DataToSend);
-      CONSOLE_Server_App_Context.LastTermLen = DataToSend;
-      
+    return 0;
+  }
+
+  len = (pQueue->Count > CONSOLE_Server_App_Context.MaxPayload) ? CONSOLE_Server_App_Context.MaxPayload : pQueue->Count;
+  chunk = CONSOLE_TX_BUFFER_SIZE - pQueue->Head;
+  chunk = (chunk > len) ? len : chunk;
+  memcpy(packet, &pQueue->Buffer[pQueue->Head], chunk);
+  memcpy(&packet[chunk], &pQueue->Buffer[0], len - chunk);
+
 #if(CFG_DEBUG_APP_TRACE != 0)
-      APP_DBG_MSG("-- CONSOLE APPLICATION SERVER : NOTIFY CLIENT WITH NEW STDERR PARAMETER VALUE \n ");
-      APP_DBG_MSG(" \n\r");
+  APP_DBG_MSG("-- CONSOLE APPLICATION SERVER : NOTIFY CLIENT WITH NEW CONSOLE PARAMETER VALUE \n ");
+  APP_DBG_MSG(" \n\r");
 #endif
-      MOTENV_STM_App_Update_Char(CONSOLE_STDERR_CHAR_UUID, DataToSend, data+Offset);
-      
-      HAL_Delay(10);
-    }
+  status = MOTENV_STM_App_Update_Char(pQueue->Char, (uint8_t)len, packet);
+  if(status == BLE_STATUS_INSUFFICIENT_RESOURCES)
+  {
+    /* Kept in the queue, sent again on ACI_GATT_TX_POOL_AVAILABLE */
+    CONSOLE_Server_App_Context.WaitTxPool = 1;
+    return 1;
+  }
+
+  if(status == BLE_STATUS_SUCCESS)
+  {
+    /* keep a copy */
+    memcpy(pQueue->Last, packet, len);
+    pQueue->LastLen = (uint8_t)len;
   }
+  else
+  {
+    pQueue->Dropped += len;
+  }
+
+  pQueue->Head = (pQueue->Head + len) % CONSOLE_TX_BUFFER_SIZE;
+  pQueue->Count -= len;
 
-  return;
+  return (pQueue->Count != 0U) ? 1U : 0U;
 }
 
 /**
- * @brief Send a notification for Stderr char value after a read request
- * @param None
+ * @brief  Send the last notification of a char again after a read request
+ * @param  pQueue Queue of the char
  * @retval None
  */
-void CONSOLE_Stderr_Update_AfterRead(void)
+static void CONSOLE_Update_AfterRead(const CONSOLE_Tx_Queue_t *pQueue)
 {
-  if(CONSOLE_Server_App_Context.StderrNotificationStatus)
+  if(pQueue->NotificationStatus)
   {
 #if(CFG_DEBUG_APP_TRACE != 0)
-      APP_DBG_MSG("-- CONSOLE APPLICATION SERVER : NOTIFY CLIENT WITH NEW STDERR PARAMETER VALUE \n ");
-      APP_DBG_MSG(" \n\r");
+    APP_DBG_MSG("-- CONSOLE APPLICATION SERVER : NOTIFY CLIENT WITH NEW CONSOLE PARAMETER VALUE \n ");
+    APP_DBG_MSG(" \n\r");
 #endif
-      MOTENV_STM_App_Update_Char(CONSOLE_TERM_CHAR_UUID, CONSOLE_Server_App_Context.LastTermLen, CONSOLE_Server_App_Context.LastTermBuffer);
+    (void)MOTENV_STM_App_Update_Char(pQueue->Char, pQueue->LastLen, (uint8_t *)pQueue->Last);
   }
-
-  return;
 }
 
-/* Private functions ---------------------------------------------------------*/
-
  /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -36,6 +36,9 @@ void CONSOLE_Term_Update_AfterRead(void);
 void CONSOLE_Set_Stderr_Notification_Status(uint8_t status);
 void CONSOLE_Stderr_Update(uint8_t *data, uint8_t length);
 void CONSOLE_Stderr_Update_AfterRead(void);
+void CONSOLE_Set_Att_Mtu(uint16_t Mtu);
+void CONSOLE_Tx_Pool_Available(void);
+void CONSOLE_Tx_Task(void);
 
 #ifdef __cplusplus
 }
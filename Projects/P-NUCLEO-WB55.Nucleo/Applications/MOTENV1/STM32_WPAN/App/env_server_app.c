@@ -21,11 +21,13 @@
 #include "dbg_trace.h"
 
 #include "motenv_server_app.h"
+#include "notify_app.h"
 #include "env_server_app.h"
 #include "motionfx_server_app.h"
 #include "config_server_app.h"
 
 #include "iks01a3_env_sensors.h"
+#include "iks01a3_env_sensors_ex.h"
 
 /* Private defines -----------------------------------------------------------*/
 #define PRESSURE_BYTES          (4)
@@ -34,6 +36,11 @@
 
 #define VALUE_LEN_ENV           (2+PRESSURE_BYTES+HUMIDITY_BYTES+TEMPERATURE_BYTES/*Temp2*/+TEMPERATURE_BYTES/*Temp1*/)
 
+#ifdef ENV_BATCHED_ACQUISITION
+/* Batches without notification before the values are sent anyway */
+#define ENV_BATCH_MAX_SILENCE   ((CFG_ENV_MAX_SILENCE*CFG_ENV_BATCH_ODR)/CFG_ENV_BATCH_WATERMARK)
+#endif
+
 /* Private typedef -----------------------------------------------------------*/
 
 /**
@@ -49,9 +56,19 @@ typedef struct
   uint8_t hasPressure;
   uint8_t hasHumidity;
   uint8_t hasTemperature;
+#ifdef ENV_BATCHED_ACQUISITION
+  uint8_t BatchActive;
+  uint8_t Silence;            /* Batches since the last notification */
+  float   LpsOdr;             /* Output data rates restored when the batches stop */
+  float   HtsOdr;
+  int32_t NotifiedPressure;   /* Values of the last notification */
+  uint16_t NotifiedHumidity;
+  int16_t NotifiedTemperature[2];
+#endif
 } ENV_Server_App_Context_t;
 
 /* Private macros ------------------------------------------------------------*/
+#define ENV_ABS_DIFF(a, b)      (((a) > (b)) ? ((a) - (b)) : ((b) - (a)))
 
 /* Private variables ---------------------------------------------------------*/
 
@@ -68,6 +85,15 @@ extern uint8_t manuf_data[14];
 /* Private function prototypes -----------------------------------------------*/
 static void ENV_Handle_Sensor(void);
 static void EnvSensor_GetCaps(void);
+#ifdef NFC_ENABLE
+static void ENV_Nfc_Pressure(void);
+#endif
+#ifdef ENV_BATCHED_ACQUISITION
+static void ENV_Batch_Start(void);
+static void ENV_Batch_Stop(void);
+static void ENV_Batch_Acquire(void);
+static uint8_t ENV_Batch_Changed(void);
+#endif
 
 /* Functions Definition ------------------------------------------------------*/
 
@@ -87,6 +113,9 @@ void ENV_Context_Init(void)
   ENV_Server_App_Context.hasPressure = 0;
   ENV_Server_App_Context.hasHumidity = 0;
   ENV_Server_App_Context.hasTemperature = 0;
+#ifdef ENV_BATCHED_ACQUISITION
+  ENV_Server_App_Context.BatchActive = 0;
+#endif
 
   ENV_Set_Notification_Status(0);
 
@@ -101,6 +130,17 @@ void ENV_Context_Init(void)
  */
 void ENV_Set_Notification_Status(uint8_t status)
 {
+#ifdef ENV_BATCHED_ACQUISITION
+  if((status != 0) && (ENV_Server_App_Context.BatchActive == 0))
+  {
+    ENV_Batch_Start();
+  }
+  else if((status == 0) && (ENV_Server_App_Context.BatchActive != 0))
+  {
+    ENV_Batch_Stop();
+  }
+#endif
+
   ENV_Server_App_Context.NotificationStatus = status;
 }
 
@@ -125,7 +165,15 @@ void ENV_Send_Notification_Task(void)
 //    APP_DBG_MSG("-- ENV APPLICATION SERVER : NOTIFY CLIENT WITH NEW ENV PARAMETER VALUE \n ");
 //    APP_DBG_MSG(" \n\r");
 #endif
+#ifdef ENV_BATCHED_ACQUISITION
+    ENV_Batch_Acquire();
+    if(ENV_Batch_Changed() != 0)
+    {
+      ENV_Update();
+    }
+#else
     ENV_Update();
+#endif
   }
   else
   {
@@ -149,7 +197,15 @@ void ENV_Update(void)
   uint8_t BuffPos = 2;
 
   /* Read ENV values */
+#ifdef ENV_BATCHED_ACQUISITION
+  /* While batching, report the values of the last batch */
+  if(ENV_Server_App_Context.BatchActive == 0)
+  {
+    ENV_Handle_Sensor();
+  }
+#else
   ENV_Handle_Sensor();
+#endif
 
   /* Timestamp */
   STORE_LE_16(value, (HAL_GetTick()>>3));
@@ -172,7 +228,7 @@ void ENV_Update(void)
     BuffPos += TEMPERATURE_BYTES;
   }
 
-  MOTENV_STM_App_Update_Char(ENV_CHAR_UUID, VALUE_LEN_ENV, (uint8_t *)&value);
+  NOTIFY_Update_Char(MOTENV_STM_ENV_CHAR, VALUE_LEN_ENV, (uint8_t *)&value);
 
   return;
 }
@@ -199,24 +255,7 @@ static void ENV_Handle_Sensor(void)
     if(ENV_Server_App_Context.hasPressure == 1)
     {
 #ifdef NFC_ENABLE      
-      /* Stuff Pressure Sensor data from NFC reader here */
-      if (string_buff[11] == '.')   /* Check decimal point position on mBar value to determine value length */
-      {
-        /* string_buff [8:10] = intPart, [12:13] = decPart */        
-        string_buff[13] = NULL;  /* End the presssure sensor value with NULL after two decimals */
-        intPart = atoi(&string_buff[8]);                
-        decPart = atoi(&string_buff[12]);        
-      }
-      else if (string_buff[12] == '.')
-      {
-        /* string_buff [8:11] = intPart, [13:14] = decPart */
-        string_buff[14] = NULL;  /* End the presssure sensor value with NULL after two decimals */
-        intPart = atoi(&string_buff[8]);                
-        decPart = atoi(&string_buff[13]);          
-      }
-
-      
-      ENV_Server_App_Context.PressureValue = intPart*100+decPart;
+      ENV_Nfc_Pressure();
 #else
       if (IKS01A3_ENV_SENSOR_GetValue(i, ENV_PRESSURE, &pressure) == 0)
       {        
@@ -247,6 +286,229 @@ static void ENV_Handle_Sensor(void)
   }
 }
 
+#ifdef NFC_ENABLE
+/**
+ * @brief  Parse the pressure value read from the NFC tag
+ * @param  None
+ * @retval None
+ */
+static void ENV_Nfc_Pressure(void)
+{
+  int32_t decPart, intPart;
+
+  /* Stuff Pressure Sensor data from NFC reader here */
+  if (string_buff[11] == '.')   /* Check decimal point position on mBar value to determine value length */
+  {
+    /* string_buff [8:10] = intPart, [12:13] = decPart */        
+    string_buff[13] = NULL;  /* End the presssure sensor value with NULL after two decimals */
+    intPart = atoi(&string_buff[8]);                
+    decPart = atoi(&string_buff[12]);        
+  }
+  else if (string_buff[12] == '.')
+  {
+    /* string_buff [8:11] = intPart, [13:14] = decPart */
+    string_buff[14] = NULL;  /* End the presssure sensor value with NULL after two decimals */
+    intPart = atoi(&string_buff[8]);                
+    decPart = atoi(&string_buff[13]);          
+  }
+  else
+  {
+    /* No value read yet */
+    return;
+  }
+
+  ENV_Server_App_Context.PressureValue = intPart*100+decPart;
+}
+#endif
+
+#ifdef ENV_BATCHED_ACQUISITION
+/**
+ * @brief  Start the batched acquisition: LPS22HH FIFO in stream mode at
+ *         CFG_ENV_BATCH_ODR, HTS221 in one-shot mode
+ * @param  None
+ * @retval None
+ */
+static void ENV_Batch_Start(void)
+{
+  if(EnvCapabilities[IKS01A3_LPS22HH_0].Pressure)
+  {
+    (void)IKS01A3_ENV_SENSOR_GetOutputDataRate(IKS01A3_LPS22HH_0, ENV_PRESSURE, &ENV_Server_App_Context.LpsOdr);
+    (void)IKS01A3_ENV_SENSOR_SetOutputDataRate(IKS01A3_LPS22HH_0, ENV_PRESSURE, (float)CFG_ENV_BATCH_ODR);
+    /* Going through bypass mode empties the FIFO */
+    (void)IKS01A3_ENV_SENSOR_FIFO_Set_Mode(IKS01A3_LPS22HH_0, LPS22HH_BYPASS_MODE);
+    (void)IKS01A3_ENV_SENSOR_FIFO_Set_Watermark_Level(IKS01A3_LPS22HH_0, CFG_ENV_BATCH_WATERMARK);
+    (void)IKS01A3_ENV_SENSOR_FIFO_Set_Mode(IKS01A3_LPS22HH_0, LPS22HH_STREAM_MODE);
+  }
+
+  if(EnvCapabilities[IKS01A3_HTS221_0].Humidity)
+  {
+    (void)IKS01A3_ENV_SENSOR_GetOutputDataRate(IKS01A3_HTS221_0, ENV_HUMIDITY, &ENV_Server_App_Context.HtsOdr);
+    /* Conversion read by the first batch */
+    (void)IKS01A3_ENV_SENSOR_Set_One_Shot(IKS01A3_HTS221_0);
+  }
+
+  /* Always notify the first batch */
+  ENV_Server_App_Context.Silence = ENV_BATCH_MAX_SILENCE;
+  ENV_Server_App_Context.BatchActive = 1;
+}
+
+/**
+ * @brief  Stop the batched acquisition, the sensors free-run again
+ * @param  None
+ * @retval None
+ */
+static void ENV_Batch_Stop(void)
+{
+  if(EnvCapabilities[IKS01A3_LPS22HH_0].Pressure)
+  {
+    (void)IKS01A3_ENV_SENSOR_FIFO_Set_Mode(IKS01A3_LPS22HH_0, LPS22HH_BYPASS_MODE);
+    (void)IKS01A3_ENV_SENSOR_SetOutputDataRate(IKS01A3_LPS22HH_0, ENV_PRESSURE, ENV_Server_App_Context.LpsOdr);
+  }
+
+  if(EnvCapabilities[IKS01A3_HTS221_0].Humidity)
+  {
+    (void)IKS01A3_ENV_SENSOR_SetOutputDataRate(IKS01A3_HTS221_0, ENV_HUMIDITY, ENV_Server_App_Context.HtsOdr);
+  }
+
+  ENV_Server_App_Context.BatchActive = 0;
+}
+
+/**
+ * @brief  Read one batch: the HTS221 conversion triggered by the previous
+ *         batch and all the LPS22HH FIFO samples, averaged
+ * @param  None
+ * @retval None
+ */
+static void ENV_Batch_Acquire(void)
+{
+  float press[LPS22HH_FIFO_BURST_NBR];
+  float temp[LPS22HH_FIFO_BURST_NBR];
+  float humidity, temperature;
+  float pressSum = 0.0f;
+  float tempSum = 0.0f;
+  uint8_t level = 0;
+  uint8_t count;
+  uint8_t samples = 0;
+  uint8_t status = 0;
+  uint8_t tempIndex = 0;
+  uint8_t i;
+  int32_t decPart, intPart;
+
+  if(EnvCapabilities[IKS01A3_HTS221_0].Humidity)
+  {
+    if((IKS01A3_ENV_SENSOR_Get_One_Shot_Data(IKS01A3_HTS221_0, &status, &humidity, &temperature) == 0) && (status == 1))
+    {
+      MCR_BLUEMS_F2I_1D(humidity, intPart, decPart);
+      ENV_Server_App_Context.HumidityValue = intPart*10+decPart;
+      MCR_BLUEMS_F2I_1D(temperature, intPart, decPart);
+      ENV_Server_App_Context.TemperatureValue[tempIndex] = intPart*10+decPart;
+    }
+    tempIndex++;
+
+    /* Converted while the MCU sleeps, read by the next batch */
+    (void)IKS01A3_ENV_SENSOR_Set_One_Shot(IKS01A3_HTS221_0);
+  }
+
+  if(EnvCapabilities[IKS01A3_LPS22HH_0].Pressure)
+  {
+    if(IKS01A3_ENV_SENSOR_FIFO_Get_Num_Samples(IKS01A3_LPS22HH_0, &level) != 0)
+    {
+      level = 0;
+    }
+
+    /* One bus transaction per LPS22HH_FIFO_BURST_NBR samples */
+    while(level > 0)
+    {
+      count = (level < LPS22HH_FIFO_BURST_NBR) ? level : LPS22HH_FIFO_BURST_NBR;
+      if(IKS01A3_ENV_SENSOR_FIFO_Get_Data_Burst(IKS01A3_LPS22HH_0, press, temp, count) != 0)
+      {
+        break;
+      }
+      for(i = 0; i < count; i++)
+      {
+        pressSum += press[i];
+        tempSum += temp[i];
+      }
+      samples += count;
+      level -= count;
+    }
+
+    if(samples > 0)
+    {
+#ifdef NFC_ENABLE
+      /* The pressure notified is the one read from the NFC tag */
+      UNUSED(pressSum);
+#else
+      MCR_BLUEMS_F2I_2D(pressSum / samples, intPart, decPart);
+      ENV_Server_App_Context.PressureValue = intPart*100+decPart;
+#endif
+      MCR_BLUEMS_F2I_1D(tempSum / samples, intPart, decPart);
+      ENV_Server_App_Context.TemperatureValue[tempIndex] = intPart*10+decPart;
+    }
+  }
+
+#ifdef NFC_ENABLE
+  if(ENV_Server_App_Context.hasPressure == 1)
+  {
+    ENV_Nfc_Pressure();
+  }
+#endif
+}
+
+/**
+ * @brief  Tell whether the last batch is to be notified: a value moved by its
+ *         threshold since the last notification, or none was sent for
+ *         CFG_ENV_MAX_SILENCE
+ * @param  None
+ * @retval 1 if the values are to be notified, 0 otherwise
+ */
+static uint8_t ENV_Batch_Changed(void)
+{
+  uint8_t i;
+  uint8_t changed = 0;
+
+  if(ENV_Server_App_Context.Silence < ENV_BATCH_MAX_SILENCE)
+  {
+    ENV_Server_App_Context.Silence++;
+  }
+  if(ENV_Server_App_Context.Silence >= ENV_BATCH_MAX_SILENCE)
+  {
+    changed = 1;
+  }
+
+  if((ENV_Server_App_Context.hasPressure == 1) &&
+     (ENV_ABS_DIFF(ENV_Server_App_Context.PressureValue, ENV_Server_App_Context.NotifiedPressure) >= CFG_ENV_PRESSURE_THRESHOLD))
+  {
+    changed = 1;
+  }
+
+  if((ENV_Server_App_Context.hasHumidity == 1) &&
+     (ENV_ABS_DIFF(ENV_Server_App_Context.HumidityValue, ENV_Server_App_Context.NotifiedHumidity) >= CFG_ENV_HUMIDITY_THRESHOLD))
+  {
+    changed = 1;
+  }
+
+  for(i = 0; i < ENV_Server_App_Context.hasTemperature; i++)
+  {
+    if(ENV_ABS_DIFF(ENV_Server_App_Context.TemperatureValue[i], ENV_Server_App_Context.NotifiedTemperature[i]) >= CFG_ENV_TEMPERATURE_THRESHOLD)
+    {
+      changed = 1;
+    }
+  }
+
+  if(changed == 1)
+  {
+    ENV_Server_App_Context.NotifiedPressure = ENV_Server_App_Context.PressureValue;
+    ENV_Server_App_Context.NotifiedHumidity = ENV_Server_App_Context.HumidityValue;
+    ENV_Server_App_Context.NotifiedTemperature[0] = ENV_Server_App_Context.TemperatureValue[0];
+    ENV_Server_App_Context.NotifiedTemperature[1] = ENV_Server_App_Context.TemperatureValue[1];
+    ENV_Server_App_Context.Silence = 0;
+  }
+
+  return changed;
+}
+#endif
+
 /**
  * @brief  Check the Environmental active capabilities and set the ADV data accordingly
  * @param  None
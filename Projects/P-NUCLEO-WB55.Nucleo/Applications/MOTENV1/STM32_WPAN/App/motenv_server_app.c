@@ -37,37 +37,44 @@
 #include "motionid_server_app.h"
 #include "config_server_app.h"
 #include "console_server_app.h"
+#include "notify_app.h"
+#include "conn_param_app.h"
+#include "sensor_hub_app.h"
 
 /* Private defines -----------------------------------------------------------*/
 
+#ifdef ENV_BATCHED_ACQUISITION
+/* One batch each time the LPS22HH FIFO reaches its watermark */
+#define ENVIRONMENT_UPDATE_PERIOD       (uint32_t)((float)CFG_ENV_BATCH_WATERMARK/CFG_ENV_BATCH_ODR*1000*1000/CFG_TS_TICK_VAL)
+#else
 //#define ENVIRONMENT_UPDATE_PERIOD       (uint32_t)(1000*1000/CFG_TS_TICK_VAL) /*1s*/
 #define ENVIRONMENT_UPDATE_PERIOD       (uint32_t)(0.5*1000*1000/CFG_TS_TICK_VAL) /*500ms*/
+#endif
 #define ACC_GYRO_MAG_UPDATE_PERIOD      (uint32_t)(0.05*1000*1000/CFG_TS_TICK_VAL) /*50ms (20Hz)*/
+#define MOTION_BATCH_UPDATE_PERIOD      (uint32_t)(0.01*1000*1000/CFG_TS_TICK_VAL) /*10ms (100Hz)*/
 #define MOTIONFX_UPDATE_PERIOD          (uint32_t)(0.01*1000*1000/CFG_TS_TICK_VAL) /*10ms (100Hz)*/
-#define ECOMPASS_UPDATE_PERIOD          (uint32_t)(0.01*1000*1000/CFG_TS_TICK_VAL) /*10ms (100Hz)*/
 #define ACTIVITY_REC_UPDATE_PERIOD      (uint32_t)(0.0625*1000*1000/CFG_TS_TICK_VAL) /*62.5ms (16Hz)*/
 #define CARRY_POSITION_UPDATE_PERIOD    (uint32_t)(0.02*1000*1000/CFG_TS_TICK_VAL) /*20ms (50Hz)*/
 #define GESTURE_REC_UPDATE_PERIOD       (uint32_t)(0.02*1000*1000/CFG_TS_TICK_VAL) /*20ms (50Hz)*/
 #define PEDOMETER_UPDATE_PERIOD         (uint32_t)(0.02*1000*1000/CFG_TS_TICK_VAL) /*20ms (50Hz)*/
 #define INTENSITY_DET_UPDATE_PERIOD     (uint32_t)(0.0625*1000*1000/CFG_TS_TICK_VAL) /*62.5ms (16Hz)*/
 
+/* Time between two notifications of the chars, for the connection interval (conn_param_app.c) */
+#define MOTION_BATCH_NOTIFY_PERIOD      (uint32_t)(0.05*1000*1000/CFG_TS_TICK_VAL) /*50ms: full or MOTION_BATCH_MAX_LATENCY*/
+#define QUAT_NOTIFY_PERIOD              (uint32_t)(0.03*1000*1000/CFG_TS_TICK_VAL) /*30ms: SEND_N_QUATERNIONS per value*/
+#define ECOMPASS_NOTIFY_PERIOD          (uint32_t)(0.1*1000*1000/CFG_TS_TICK_VAL)  /*100ms*/
+#define RECOGNITION_NOTIFY_PERIOD       (uint32_t)(0.2*1000*1000/CFG_TS_TICK_VAL)  /*200ms: notified on change only*/
+
 /* Private typedef -----------------------------------------------------------*/
 
 /**
  * @brief  MOTENV Server Context structure definition
  *         Include just the Timer Ids for the Notifications
+ *         (motion features are paced by the Sensor Hub)
  */
 typedef struct
 {
-  uint8_t AccGyroMag_Update_Timer_Id;
   uint8_t Env_Update_Timer_Id;
-  uint8_t MotionFx_Update_Timer_Id;
-  uint8_t ECompass_Update_Timer_Id;
-  uint8_t ActivityRec_Update_Timer_Id;
-  uint8_t CarryPosition_Update_Timer_Id;
-  uint8_t GestureRec_Update_Timer_Id;
-  uint8_t Pedometer_Update_Timer_Id;
-  uint8_t IntensityDet_Update_Timer_Id;
 } MOTENV_Server_App_Context_t;
 
 /* Private macros ------------------------------------------------------------*/
@@ -84,15 +91,7 @@ PLACE_IN_SECTION("BLE_APP_CONTEXT") static MOTENV_Server_App_Context_t MOTENV_Se
 /* Global variables ----------------------------------------------------------*/
 
 /* Private function prototypes -----------------------------------------------*/
-static void MOTENV_AccGyroMagUpdate_Timer_Callback(void);
 static void MOTENV_EnvUpdate_Timer_Callback(void);
-static void MOTENV_MotionFxUpdate_Timer_Callback(void);
-static void MOTENV_ECompassUpdate_Timer_Callback(void);
-static void MOTENV_ActivityRecUpdate_Timer_Callback(void);
-static void MOTENV_CarryPositionUpdate_Timer_Callback(void);
-static void MOTENV_GestureRecUpdate_Timer_Callback(void);
-static void MOTENV_PedometerUpdate_Timer_Callback(void);
-static void MOTENV_IntensityDetUpdate_Timer_Callback(void);
 
 static void MOTENV_APP_context_Init(void);
 
@@ -114,6 +113,7 @@ void MOTENV_STM_App_Notification(MOTENV_STM_App_Notification_evt_t *pNotificatio
      * Env char notification enabled
      */
     case HW_ENV_NOTIFY_ENABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_ENV_CHAR, ENVIRONMENT_UPDATE_PERIOD);
       ENV_Set_Notification_Status(1);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : ENV NOTIFICATION ENABLED\n");
@@ -127,15 +127,30 @@ void MOTENV_STM_App_Notification(MOTENV_STM_App_Notification_evt_t *pNotificatio
      * Motion char notification enabled
      */
     case HW_MOTION_NOTIFY_ENABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_MOTION_CHAR, ACC_GYRO_MAG_UPDATE_PERIOD);
       MOTION_Set_Notification_Status(1);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : MOTION NOTIFICATION ENABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Start the timer used to update the AccGyroMag characteristic */
-      HW_TS_Start(MOTENV_Server_App_Context.AccGyroMag_Update_Timer_Id, ACC_GYRO_MAG_UPDATE_PERIOD);
+      /* Start the Sensor Hub samples used to update the AccGyroMag characteristic */
+      SENSOR_HUB_Start(SENSOR_HUB_MOTION);
       break; /* HW_MOTION_NOTIFY_ENABLED_EVT */
 
+    /*
+     * Motion Batch char notification enabled
+     */
+    case HW_MOTION_BATCH_NOTIFY_ENABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_MOTION_BATCH_CHAR, MOTION_BATCH_NOTIFY_PERIOD);
+      MOTION_Set_Batch_Notification_Status(1);
+#if(CFG_DEBUG_APP_TRACE != 0)
+      APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : MOTION BATCH NOTIFICATION ENABLED\n");
+      APP_DBG_MSG(" \n\r");
+#endif
+      /* Start the Sensor Hub samples packed in the Motion Batch characteristic */
+      SENSOR_HUB_Start(SENSOR_HUB_MOTION_BATCH);
+      break; /* HW_MOTION_BATCH_NOTIFY_ENABLED_EVT */
+
     /*
      * Motion Ext char notification enabled
      */
@@ -151,92 +166,99 @@ void MOTENV_STM_App_Notification(MOTENV_STM_App_Notification_evt_t *pNotificatio
      * MotionFx char notification enabled
      */
     case SW_MOTIONFX_NOTIFY_ENABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_MOTION_FX_CHAR, QUAT_NOTIFY_PERIOD);
       MOTIONFX_Set_Quat_Notification_Status(1);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : MOTIONFX NOTIFICATION ENABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Start the timer used to update the MotionFx characteristic */
-      HW_TS_Start(MOTENV_Server_App_Context.MotionFx_Update_Timer_Id, MOTIONFX_UPDATE_PERIOD);
+      /* Start the Sensor Hub samples used to update the MotionFx characteristic */
+      SENSOR_HUB_Start(SENSOR_HUB_MOTIONFX);
       break; /* SW_MOTIONFX_NOTIFY_ENABLED_EVT */
 
     /*
      * ECompass char notification enabled
      */
     case SW_ECOMPASS_NOTIFY_ENABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_ECOMPASS_CHAR, ECOMPASS_NOTIFY_PERIOD);
       MOTIONFX_Set_ECompass_Notification_Status(1);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : ECOMPASS NOTIFICATION ENABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Start the timer used to update the ECompass characteristic */
-      HW_TS_Start(MOTENV_Server_App_Context.ECompass_Update_Timer_Id, ECOMPASS_UPDATE_PERIOD);
+      /* Start the Sensor Hub samples used to update the ECompass characteristic (shared with MotionFx) */
+      SENSOR_HUB_Start(SENSOR_HUB_MOTIONFX);
       break; /* SW_ECOMPASS_NOTIFY_ENABLED_EVT */
 
     /*
      * ActivityRec char notification enabled
      */
     case SW_ACTIVITY_REC_NOTIFY_ENABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_ACTIVITY_REC_CHAR, RECOGNITION_NOTIFY_PERIOD);
       MOTIONAR_Set_Notification_Status(1);
 //      MOTIONAW_Set_Notification_Status(1);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : ACITIVITY REC NOTIFICATION ENABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Start the timer used to update the Activity Rec characteristic */
-      HW_TS_Start(MOTENV_Server_App_Context.ActivityRec_Update_Timer_Id, ACTIVITY_REC_UPDATE_PERIOD);
+      /* Start the Sensor Hub samples used to update the Activity Rec characteristic */
+      SENSOR_HUB_Start(SENSOR_HUB_ACTIVITY_REC);
       break; /* SW_ACTIVITY_REC_NOTIFY_ENABLED_EVT */
 
     /*
      * CarryPosition char notification enabled
      */
     case SW_CARRY_POSITION_NOTIFY_ENABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_CARRY_POSITION_CHAR, RECOGNITION_NOTIFY_PERIOD);
       MOTIONCP_Set_Notification_Status(1);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : CARRY POSITION NOTIFICATION ENABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Start the timer used to update the Carry Position characteristic */
-      HW_TS_Start(MOTENV_Server_App_Context.CarryPosition_Update_Timer_Id, CARRY_POSITION_UPDATE_PERIOD);
+      /* Start the Sensor Hub samples used to update the Carry Position characteristic */
+      SENSOR_HUB_Start(SENSOR_HUB_CARRY_POSITION);
       break; /* SW_CARRY_POSITION_NOTIFY_ENABLED_EVT */
 
     /*
      * GestureRec char notification enabled
      */
     case SW_GESTURE_REC_NOTIFY_ENABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_GESTURE_REC_CHAR, RECOGNITION_NOTIFY_PERIOD);
       MOTIONGR_Set_Notification_Status(1);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : GESTURE REC NOTIFICATION ENABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Start the timer used to update the GestureRec characteristic */
-      HW_TS_Start(MOTENV_Server_App_Context.GestureRec_Update_Timer_Id, GESTURE_REC_UPDATE_PERIOD);
+      /* Start the Sensor Hub samples used to update the GestureRec characteristic */
+      SENSOR_HUB_Start(SENSOR_HUB_GESTURE_REC);
       break; /* SW_GESTURE_REC_NOTIFY_ENABLED_EVT */
 
     /*
      * Pedometer char notification enabled
      */
     case SW_PEDOMETER_NOTIFY_ENABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_PEDOMETER_CHAR, RECOGNITION_NOTIFY_PERIOD);
       MOTIONPM_Set_Notification_Status(1);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : PEDOMETER NOTIFICATION ENABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Start the timer used to update the Pedometer characteristic */
-      HW_TS_Start(MOTENV_Server_App_Context.Pedometer_Update_Timer_Id, PEDOMETER_UPDATE_PERIOD);
+      /* Start the Sensor Hub samples used to update the Pedometer characteristic */
+      SENSOR_HUB_Start(SENSOR_HUB_PEDOMETER);
       break; /* SW_PEDOMETER_NOTIFY_ENABLED_EVT */
 
     /*
      * IntensityDet char notification enabled
      */
     case SW_INTENSITY_DET_NOTIFY_ENABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_INTENSITY_DET_CHAR, RECOGNITION_NOTIFY_PERIOD);
       MOTIONID_Set_Notification_Status(1);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : INTENSITY DET NOTIFICATION ENABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Start the timer used to update the IntensityDet characteristic */
-      HW_TS_Start(MOTENV_Server_App_Context.IntensityDet_Update_Timer_Id, INTENSITY_DET_UPDATE_PERIOD);
+      /* Start the Sensor Hub samples used to update the IntensityDet characteristic */
+      SENSOR_HUB_Start(SENSOR_HUB_INTENSITY_DET);
       break; /* SW_INTENSITY_DET_NOTIFY_ENABLED_EVT */
 
     /*
@@ -277,6 +299,7 @@ void MOTENV_STM_App_Notification(MOTENV_STM_App_Notification_evt_t *pNotificatio
      * Env char notification disabled
      */
     case HW_ENV_NOTIFY_DISABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_ENV_CHAR, 0);
       ENV_Set_Notification_Status(0);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : ENV NOTIFICATION DISABLED\n");
@@ -290,15 +313,30 @@ void MOTENV_STM_App_Notification(MOTENV_STM_App_Notification_evt_t *pNotificatio
      * Motion char notification disabled
      */
     case HW_MOTION_NOTIFY_DISABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_MOTION_CHAR, 0);
       MOTION_Set_Notification_Status(0);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : MOTION NOTIFICATION DISABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Stop the timer used to update the Motion characteristic */
-      HW_TS_Stop(MOTENV_Server_App_Context.AccGyroMag_Update_Timer_Id);
+      /* Stop the Sensor Hub samples used to update the Motion characteristic */
+      SENSOR_HUB_Stop(SENSOR_HUB_MOTION);
       break; /* HW_ENV_NOTIFY_DISABLED_EVT */
 
+    /*
+     * Motion Batch char notification disabled
+     */
+    case HW_MOTION_BATCH_NOTIFY_DISABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_MOTION_BATCH_CHAR, 0);
+      MOTION_Set_Batch_Notification_Status(0);
+#if(CFG_DEBUG_APP_TRACE != 0)
+      APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : MOTION BATCH NOTIFICATION DISABLED\n");
+      APP_DBG_MSG(" \n\r");
+#endif
+      /* Stop the Sensor Hub samples packed in the Motion Batch characteristic */
+      SENSOR_HUB_Stop(SENSOR_HUB_MOTION_BATCH);
+      break; /* HW_MOTION_BATCH_NOTIFY_DISABLED_EVT */
+
     /*
      * Motion Ext (Acc Event) char notification disabled
      */
@@ -314,92 +352,105 @@ void MOTENV_STM_App_Notification(MOTENV_STM_App_Notification_evt_t *pNotificatio
      * MotionFx char notification disabled
      */
     case SW_MOTIONFX_NOTIFY_DISABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_MOTION_FX_CHAR, 0);
       MOTIONFX_Set_Quat_Notification_Status(0);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : MOTIONFX NOTIFICATION DISABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Stop the timer used to update the MotionFx characteristic */
-      HW_TS_Stop(MOTENV_Server_App_Context.MotionFx_Update_Timer_Id);
+      /* Stop the Sensor Hub samples used to update the MotionFx characteristic, unless ECompass still needs them */
+      if(MOTIONFX_Get_Notification_Status() == 0)
+      {
+        SENSOR_HUB_Stop(SENSOR_HUB_MOTIONFX);
+      }
       break; /* SW_MOTIONFX_NOTIFY_DISABLED_EVT */
 
     /*
      * ECompass char notification disabled
      */
     case SW_ECOMPASS_NOTIFY_DISABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_ECOMPASS_CHAR, 0);
       MOTIONFX_Set_ECompass_Notification_Status(0);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : ECOMPASS NOTIFICATION DISABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Stop the timer used to update the ECopmass characteristic */
-      HW_TS_Stop(MOTENV_Server_App_Context.ECompass_Update_Timer_Id);
+      /* Stop the Sensor Hub samples used to update the ECompass characteristic, unless MotionFx still needs them */
+      if(MOTIONFX_Get_Notification_Status() == 0)
+      {
+        SENSOR_HUB_Stop(SENSOR_HUB_MOTIONFX);
+      }
       break; /* SW_ECOMPASS_NOTIFY_DISABLED_EVT */
 
     /*
      * ActivityRec char notification disabled
      */
     case SW_ACTIVITY_REC_NOTIFY_DISABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_ACTIVITY_REC_CHAR, 0);
       MOTIONAR_Set_Notification_Status(0);
 //      MOTIONAW_Set_Notification_Status(0);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : ACTIVITY REC NOTIFICATION DISABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Stop the timer used to update the ActivityRec characteristic */
-      HW_TS_Stop(MOTENV_Server_App_Context.ActivityRec_Update_Timer_Id);
+      /* Stop the Sensor Hub samples used to update the ActivityRec characteristic */
+      SENSOR_HUB_Stop(SENSOR_HUB_ACTIVITY_REC);
       break; /* SW_ACTIVITY_REC_NOTIFY_DISABLED_EVT */
 
     /*
      * CarryPosition char notification disabled
      */
     case SW_CARRY_POSITION_NOTIFY_DISABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_CARRY_POSITION_CHAR, 0);
       MOTIONCP_Set_Notification_Status(0);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : CARRY POSITION NOTIFICATION DISABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Stop the timer used to update the Carry Position characteristic */
-      HW_TS_Stop(MOTENV_Server_App_Context.CarryPosition_Update_Timer_Id);
+      /* Stop the Sensor Hub samples used to update the Carry Position characteristic */
+      SENSOR_HUB_Stop(SENSOR_HUB_CARRY_POSITION);
       break; /* SW_CARRY_POSITION_NOTIFY_DISABLED_EVT */
 
     /*
      * GestureRec char notification disabled
      */
     case SW_GESTURE_REC_NOTIFY_DISABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_GESTURE_REC_CHAR, 0);
       MOTIONGR_Set_Notification_Status(0);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : GESTURE REC NOTIFICATION DISABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Stop the timer used to update the Gesture Rec characteristic */
-      HW_TS_Stop(MOTENV_Server_App_Context.GestureRec_Update_Timer_Id);
+      /* Stop the Sensor Hub samples used to update the Gesture Rec characteristic */
+      SENSOR_HUB_Stop(SENSOR_HUB_GESTURE_REC);
       break; /* SW_GESTURE_REC_NOTIFY_DISABLED_EVT */
 
     /*
      * Pedometer char notification disabled
      */
     case SW_PEDOMETER_NOTIFY_DISABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_PEDOMETER_CHAR, 0);
       MOTIONPM_Set_Notification_Status(0);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : PEDOMETER NOTIFICATION DISABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Stop the timer used to update the Pedometer characteristic */
-      HW_TS_Stop(MOTENV_Server_App_Context.Pedometer_Update_Timer_Id);
+      /* Stop the Sensor Hub samples used to update the Pedometer characteristic */
+      SENSOR_HUB_Stop(SENSOR_HUB_PEDOMETER);
       break; /* SW_PEDOMETER_NOTIFY_DISABLED_EVT */
 
     /*
      * IntensityDet char notification disabled
      */
     case SW_INTENSITY_DET_NOTIFY_DISABLED_EVT:
+      CONN_PARAM_Set_Char(MOTENV_STM_INTENSITY_DET_CHAR, 0);
       MOTIONID_Set_Notification_Status(0);
 #if(CFG_DEBUG_APP_TRACE != 0)
       APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : INTENSITY DET NOTIFICATION DISABLED\n");
       APP_DBG_MSG(" \n\r");
 #endif
-      /* Stop the timer used to update the IntensityDet characteristic */
-      HW_TS_Stop(MOTENV_Server_App_Context.IntensityDet_Update_Timer_Id);
+      /* Stop the Sensor Hub samples used to update the IntensityDet characteristic */
+      SENSOR_HUB_Stop(SENSOR_HUB_INTENSITY_DET);
       break; /* SW_INTENSITY_DET_NOTIFY_DISABLED_EVT */
 
     /*
@@ -527,6 +578,28 @@ void MOTENV_STM_App_Notification(MOTENV_STM_App_Notification_evt_t *pNotificatio
 #endif
       CONFIG_Parse_Command(pNotification->DataTransfered.pPayload, pNotification->DataTransfered.Length);
       break; /* CONFIG_WRITE_EVT */
+
+    /*
+     * ATT MTU negotiated with the client
+     */
+    case ATT_MTU_EXCHANGED_EVT:
+#if(CFG_DEBUG_APP_TRACE != 0)
+      APP_DBG_MSG("-- TEMPLATE APPLICATION SERVER : ATT MTU EXCHANGED\n");
+      APP_DBG_MSG(" \n\r");
+#endif
+      MOTION_Set_Att_Mtu((uint16_t)(pNotification->DataTransfered.pPayload[0] |
+                                    (pNotification->DataTransfered.pPayload[1] << 8)));
+      CONSOLE_Set_Att_Mtu((uint16_t)(pNotification->DataTransfered.pPayload[0] |
+                                     (pNotification->DataTransfered.pPayload[1] << 8)));
+      break; /* ATT_MTU_EXCHANGED_EVT */
+
+    /*
+     * Notification buffers available again
+     */
+    case TX_POOL_AVAILABLE_EVT:
+      NOTIFY_Tx_Pool_Available();
+      CONSOLE_Tx_Pool_Available();
+      break; /* TX_POOL_AVAILABLE_EVT */
       
     default:
       break; /* DEFAULT */
@@ -547,36 +620,27 @@ void MOTENV_APP_HandleDisconnection( void )
   HW_TS_Stop(MOTENV_Server_App_Context.Env_Update_Timer_Id);
 
   MOTION_Set_Notification_Status(0);
-  /* Stop the timer used to update the Motion characteristic */
-  HW_TS_Stop(MOTENV_Server_App_Context.AccGyroMag_Update_Timer_Id);
-  
+  MOTION_Set_Batch_Notification_Status(0);
+  /* The next client starts with the default ATT MTU */
+  MOTION_Set_Att_Mtu(BLE_DEFAULT_ATT_MTU);
+  /* Drop the Console output not sent */
+  CONSOLE_Set_Term_Notification_Status(0);
+  CONSOLE_Set_Stderr_Notification_Status(0);
+  CONSOLE_Set_Att_Mtu(BLE_DEFAULT_ATT_MTU);
+  /* Drop the values waiting for the stack buffers */
+  NOTIFY_Reset();
+  /* No more notifications: the next client starts from its own interval */
+  CONN_PARAM_Disconnected();
   MOTIONFX_Set_Quat_Notification_Status(0);
-  /* Stop the timer used to update the MotionFx characteristic */
-  HW_TS_Stop(MOTENV_Server_App_Context.MotionFx_Update_Timer_Id);
-
   MOTIONFX_Set_ECompass_Notification_Status(0);
-  /* Stop the timer used to update the ECopmass characteristic */
-  HW_TS_Stop(MOTENV_Server_App_Context.ECompass_Update_Timer_Id);
- 
   MOTIONAR_Set_Notification_Status(0);
-  /* Stop the timer used to update the ActivityRec characteristic */
-  HW_TS_Stop(MOTENV_Server_App_Context.ActivityRec_Update_Timer_Id);
-
   MOTIONCP_Set_Notification_Status(0);
-  /* Stop the timer used to update the Carry Position characteristic */
-  HW_TS_Stop(MOTENV_Server_App_Context.CarryPosition_Update_Timer_Id);
-
   MOTIONGR_Set_Notification_Status(0);
-  /* Stop the timer used to update the Gesture Rec characteristic */
-  HW_TS_Stop(MOTENV_Server_App_Context.GestureRec_Update_Timer_Id);
-
   MOTIONPM_Set_Notification_Status(0);
-  /* Stop the timer used to update the Pedometer characteristic */
-  HW_TS_Stop(MOTENV_Server_App_Context.Pedometer_Update_Timer_Id);
-
   MOTIONID_Set_Notification_Status(0);
-  /* Stop the timer used to update the IntensityDet characteristic */
-  HW_TS_Stop(MOTENV_Server_App_Context.IntensityDet_Update_Timer_Id);
+
+  /* Stop the Sensor Hub samples used to update all the Motion characteristics */
+  SENSOR_HUB_StopAll();
 }
 
 /**
@@ -593,63 +657,60 @@ void MOTENV_APP_Init(void)
 		hw_ts_Repeated,
 		MOTENV_EnvUpdate_Timer_Callback);
 
+  /* Console output notified as fast as the stack accepts it */
+  UTIL_SEQ_RegTask( 1<<CFG_TASK_CONSOLE_TX_ID, UTIL_SEQ_RFU, CONSOLE_Tx_Task);
+
+  /* Newest char values kept while the stack has no buffer, notified by priority */
+  UTIL_SEQ_RegTask( 1<<CFG_TASK_NOTIFY_FLUSH_ID, UTIL_SEQ_RFU, NOTIFY_Flush_Task);
+
+  /* Connection interval requested for the notifications enabled */
+  UTIL_SEQ_RegTask( 1<<CFG_TASK_CONN_PARAM_ID, UTIL_SEQ_RFU, CONN_PARAM_Task);
+  CONN_PARAM_Init();
+
+  /* Shared acquisition of the motion sensors for all the features below */
+  SENSOR_HUB_Init();
+
 #ifndef NFC_READER_ONLY_DEMO	   // Disable other sensors, when not using an X-NUCLEO-ISK01A3 expansion board
   UTIL_SEQ_RegTask( 1<<CFG_TASK_NOTIFY_ACC_GYRO_MAG_ID, UTIL_SEQ_RFU, MOTION_Send_Notification_Task);
-  /* Create timer to get the AccGyroMag params and update charecteristic */
-  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
-        &(MOTENV_Server_App_Context.AccGyroMag_Update_Timer_Id),
-        hw_ts_Repeated,
-        MOTENV_AccGyroMagUpdate_Timer_Callback);
+  /* Get the AccGyroMag params from the Sensor Hub and update charecteristic */
+  SENSOR_HUB_Register(SENSOR_HUB_MOTION, ACC_GYRO_MAG_UPDATE_PERIOD,
+                      SENSOR_HUB_ACC | SENSOR_HUB_GYRO | SENSOR_HUB_MAG, CFG_TASK_NOTIFY_ACC_GYRO_MAG_ID);
 
-  UTIL_SEQ_RegTask( 1<<CFG_TASK_NOTIFY_MOTIONFX_ID, UTIL_SEQ_RFU, MOTIONFX_Send_Quat_Notification_Task);
-  /* Create timer to change the MotionFx params and update charecteristic */
-  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
-        &(MOTENV_Server_App_Context.MotionFx_Update_Timer_Id),
-        hw_ts_Repeated,
-        MOTENV_MotionFxUpdate_Timer_Callback);
+  UTIL_SEQ_RegTask( 1<<CFG_TASK_NOTIFY_MOTION_BATCH_ID, UTIL_SEQ_RFU, MOTION_Batch_Send_Notification_Task);
+  /* Get the AccGyroMag params from the Sensor Hub and pack them in the batched characteristic */
+  SENSOR_HUB_Register(SENSOR_HUB_MOTION_BATCH, MOTION_BATCH_UPDATE_PERIOD,
+                      SENSOR_HUB_ACC | SENSOR_HUB_GYRO | SENSOR_HUB_MAG, CFG_TASK_NOTIFY_MOTION_BATCH_ID);
 
-  UTIL_SEQ_RegTask( 1<<CFG_TASK_NOTIFY_ECOMPASS_ID, UTIL_SEQ_RFU, MOTIONFX_Send_ECompass_Notification_Task);
-  /* Create timer to change the ECompass params and update charecteristic */
-  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
-        &(MOTENV_Server_App_Context.ECompass_Update_Timer_Id),
-        hw_ts_Repeated,
-        MOTENV_ECompassUpdate_Timer_Callback);
+  UTIL_SEQ_RegTask( 1<<CFG_TASK_NOTIFY_MOTIONFX_ID, UTIL_SEQ_RFU, MOTIONFX_Send_Quat_Notification_Task);
+  /* Get the MotionFx/ECompass params from the Sensor Hub and update charecteristics */
+  SENSOR_HUB_Register(SENSOR_HUB_MOTIONFX, MOTIONFX_UPDATE_PERIOD,
+                      SENSOR_HUB_ACC | SENSOR_HUB_GYRO | SENSOR_HUB_MAG, CFG_TASK_NOTIFY_MOTIONFX_ID);
 
   UTIL_SEQ_RegTask( 1<<CFG_TASK_NOTIFY_ACTIVITY_REC_ID, UTIL_SEQ_RFU, MOTIONAR_Send_Notification_Task);
 //  UTIL_SEQ_RegTask( 1<<CFG_TASK_NOTIFY_ACTIVITY_REC_ID, UTIL_SEQ_RFU, MOTIONAW_Send_Notification_Task);
-  /* Create timer to change the Activity Rec params and update charecteristic */
-  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
-        &(MOTENV_Server_App_Context.ActivityRec_Update_Timer_Id),
-        hw_ts_Repeated,
-        MOTENV_ActivityRecUpdate_Timer_Callback);
+  /* Get the Activity Rec params from the Sensor Hub and update charecteristic */
+  SENSOR_HUB_Register(SENSOR_HUB_ACTIVITY_REC, ACTIVITY_REC_UPDATE_PERIOD,
+                      SENSOR_HUB_ACC, CFG_TASK_NOTIFY_ACTIVITY_REC_ID);
 
   UTIL_SEQ_RegTask( 1<<CFG_TASK_NOTIFY_CARRY_POSITION_ID, UTIL_SEQ_RFU, MOTIONCP_Send_Notification_Task);
-  /* Create timer to change the Carry Position params and update charecteristic */
-  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
-        &(MOTENV_Server_App_Context.CarryPosition_Update_Timer_Id),
-        hw_ts_Repeated,
-        MOTENV_CarryPositionUpdate_Timer_Callback);
+  /* Get the Carry Position params from the Sensor Hub and update charecteristic */
+  SENSOR_HUB_Register(SENSOR_HUB_CARRY_POSITION, CARRY_POSITION_UPDATE_PERIOD,
+                      SENSOR_HUB_ACC, CFG_TASK_NOTIFY_CARRY_POSITION_ID);
 
   UTIL_SEQ_RegTask( 1<<CFG_TASK_NOTIFY_GESTURE_REC_ID, UTIL_SEQ_RFU, MOTIONGR_Send_Notification_Task);
-  /* Create timer to change the Gesture Rec params and update charecteristic */
-  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
-        &(MOTENV_Server_App_Context.GestureRec_Update_Timer_Id),
-        hw_ts_Repeated,
-        MOTENV_GestureRecUpdate_Timer_Callback);
+  /* Get the Gesture Rec params from the Sensor Hub and update charecteristic */
+  SENSOR_HUB_Register(SENSOR_HUB_GESTURE_REC, GESTURE_REC_UPDATE_PERIOD,
+                      SENSOR_HUB_ACC, CFG_TASK_NOTIFY_GESTURE_REC_ID);
 
   UTIL_SEQ_RegTask( 1<<CFG_TASK_NOTIFY_PEDOMETER_ID, UTIL_SEQ_RFU, MOTIONPM_Send_Notification_Task);
-  /* Create timer to change the Pedometer params and update charecteristic */
-  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
-        &(MOTENV_Server_App_Context.Pedometer_Update_Timer_Id),
-        hw_ts_Repeated,
-        MOTENV_PedometerUpdate_Timer_Callback);
+  /* Get the Pedometer params from the Sensor Hub and update charecteristic */
+  SENSOR_HUB_Register(SENSOR_HUB_PEDOMETER, PEDOMETER_UPDATE_PERIOD,
+                      SENSOR_HUB_ACC, CFG_TASK_NOTIFY_PEDOMETER_ID);
 
   UTIL_SEQ_RegTask( 1<<CFG_TASK_NOTIFY_INTENSITY_DET_ID, UTIL_SEQ_RFU, MOTIONID_Send_Notification_Task);
-  /* Create timer to change the IntensityDet params and update charecteristic */
-  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
-        &(MOTENV_Server_App_Context.IntensityDet_Update_Timer_Id),
-        hw_ts_Repeated,
-        MOTENV_IntensityDetUpdate_Timer_Callback);
+  /* Get the IntensityDet params from the Sensor Hub and update charecteristic */
+  SENSOR_HUB_Register(SENSOR_HUB_INTENSITY_DET, INTENSITY_DET_UPDATE_PERIOD,
+                      SENSOR_HUB_ACC, CFG_TASK_NOTIFY_INTENSITY_DET_ID);
 
   /* Register the task handling Interrupt events from MEMS */
   UTIL_SEQ_RegTask( 1<<CFG_TASK_HANDLE_MEMS_IT_ID, UTIL_SEQ_RFU, MOTION_EXT_Handle_IT);
@@ -667,17 +728,6 @@ void MOTENV_APP_Init(void)
 
 /* Private functions ---------------------------------------------------------*/
 
-/**
- * @brief  On timeout, trigger the task
- *         for Motion Char (Acc-Gyro-Mag) notification
- * @param  None
- * @retval None
- */
-static void MOTENV_AccGyroMagUpdate_Timer_Callback(void)
-{
-  UTIL_SEQ_SetTask(1<<CFG_TASK_NOTIFY_ACC_GYRO_MAG_ID, CFG_SCH_PRIO_0);   
-}
-
 /**
  * @brief  On timeout, trigger the task
  *         for Environmental Char notification
@@ -689,83 +739,6 @@ static void MOTENV_EnvUpdate_Timer_Callback(void)
   UTIL_SEQ_SetTask(1<<CFG_TASK_NOTIFY_ENVIRONMENT_ID, CFG_SCH_PRIO_0);
 }
 
-/**
- * @brief  On timeout, trigger the task
- *         for Sensor Fusion Char notification
- * @param  None
- * @retval None
- */
-static void MOTENV_MotionFxUpdate_Timer_Callback(void)
-{
-  UTIL_SEQ_SetTask(1<<CFG_TASK_NOTIFY_MOTIONFX_ID, CFG_SCH_PRIO_0);
-}
-
-/**
- * @brief  On timeout, trigger the task
- *         for ECompass Char notification
- * @param  None
- * @retval None
- */
-static void MOTENV_ECompassUpdate_Timer_Callback(void)
-{
-  UTIL_SEQ_SetTask(1<<CFG_TASK_NOTIFY_ECOMPASS_ID, CFG_SCH_PRIO_0);
-}
-
-/**
- * @brief  On timeout, trigger the task
- *         for Activity Recognition Char notification
- * @param  None
- * @retval None
- */
-static void MOTENV_ActivityRecUpdate_Timer_Callback(void)
-{
-  UTIL_SEQ_SetTask(1<<CFG_TASK_NOTIFY_ACTIVITY_REC_ID, CFG_SCH_PRIO_0);
-}
-
-/**
- * @brief  On timeout, trigger the task
- *         for Carry Position Char notification
- * @param  None
- * @retval None
- */
-static void MOTENV_CarryPositionUpdate_Timer_Callback(void)
-{
-  UTIL_SEQ_SetTask(1<<CFG_TASK_NOTIFY_CARRY_POSITION_ID, CFG_SCH_PRIO_0);
-}
-
-/**
- * @brief  On timeout, trigger the task
- *         for Gesture Recognition Char notification
- * @param  None
- * @retval None
- */
-static void MOTENV_GestureRecUpdate_Timer_Callback(void)
-{
-  UTIL_SEQ_SetTask(1<<CFG_TASK_NOTIFY_GESTURE_REC_ID, CFG_SCH_PRIO_0);
-}
-
-/**
- * @brief  On timeout, trigger the task
- *         for Pedometer Char notification
- * @param  None
- * @retval None
- */
-static void MOTENV_PedometerUpdate_Timer_Callback(void)
-{
-  UTIL_SEQ_SetTask(1<<CFG_TASK_NOTIFY_PEDOMETER_ID, CFG_SCH_PRIO_0);
-}
-
-/**
- * @brief  On timeout, trigger the task
- *         for Intensity Detection Char notification
- * @param  None
- * @retval None
- */
-static void MOTENV_IntensityDetUpdate_Timer_Callback(void)
-{
-  UTIL_SEQ_SetTask(1<<CFG_TASK_NOTIFY_INTENSITY_DET_ID, CFG_SCH_PRIO_0);
-}
-
 /**
  * @brief  Init Context for each Service exposed by MOTENV Server App
  * @param  None
@@ -776,6 +749,12 @@ static void MOTENV_APP_context_Init(void)
   /* Init ENV context */
   ENV_Context_Init();
 
+  /* Init CONSOLE context */
+  CONSOLE_Context_Init();
+
+  /* Init the values waiting for the stack buffers */
+  NOTIFY_Init();
+
 #ifndef NFC_READER_ONLY_DEMO     // Disable other sensors, when not using an X-NUCLEO-ISK01A3 expansion board
   /* Init MOTION Context */
   MOTION_Context_Init();
@@ -21,6 +21,7 @@
 #include "dbg_trace.h"
 
 #include "motenv_server_app.h"
+#include "notify_app.h"
 #include "motion_ext_server_app.h"
 #include "config_server_app.h"
 
@@ -35,6 +36,9 @@
 #define VALUE_LEN_SMALL (2+2)
 #define VALUE_LEN_LARGE (2+3)
 
+#define EXT_FREE_FALL_THRESHOLD   LSM6DSO_FF_TSH_250mg
+#define EXT_DOUBLE_TAP_THRESHOLD  0x10/*LSM6DSL_TAP_THRESHOLD_MID*/
+
 /* Private typedef -----------------------------------------------------------*/
 
 /**
@@ -240,6 +244,71 @@ void MOTION_EXT_Disable_Feature(uint8_t feature)
   }
 }
 
+/**
+ * @brief  Enable the given Extended features and disable the others, programming the LSM6DSO once
+ * @param  features The features to be enabled (EXT_HWF_MULTIPLE_EVENTS is ignored)
+ * @retval The features enabled
+ */
+uint8_t MOTION_EXT_Set_Features(uint8_t features)
+{
+  IKS01A3_MOTION_SENSOR_Event_Config_t Config;
+
+  features &= (uint8_t)~EXT_HWF_MULTIPLE_EVENTS;
+
+  Config.Events = 0;
+  if(features & EXT_HWF_PEDOMETER)
+  {
+    Config.Events |= LSM6DSO_EVENT_PEDOMETER;
+  }
+  if(features & EXT_HWF_FREE_FALL)
+  {
+    Config.Events |= LSM6DSO_EVENT_FREE_FALL;
+  }
+  if(features & EXT_HWF_DOUBLE_TAP)
+  {
+    Config.Events |= LSM6DSO_EVENT_DOUBLE_TAP;
+  }
+  if(features & EXT_HWF_SINGLE_TAP)
+  {
+    Config.Events |= LSM6DSO_EVENT_SINGLE_TAP;
+  }
+  if(features & EXT_HWF_WAKE_UP)
+  {
+    Config.Events |= LSM6DSO_EVENT_WAKE_UP;
+  }
+  if(features & EXT_HWF_TILT)
+  {
+    Config.Events |= LSM6DSO_EVENT_TILT;
+  }
+  if(features & EXT_HWF_6D_ORIENTATION)
+  {
+    Config.Events |= LSM6DSO_EVENT_6D_ORIENTATION;
+  }
+  Config.FreeFallThreshold = EXT_FREE_FALL_THRESHOLD;
+  Config.DoubleTapThreshold = EXT_DOUBLE_TAP_THRESHOLD;
+  /* defaultODR holds the rate [Hz] times 100 */
+  Config.IdleOdr = MOTION_EXT_Server_App_Context.defaultODR / 100.0f;
+
+  if (IKS01A3_MOTION_SENSOR_Set_Event_Detection(IKS01A3_LSM6DSO_0, &Config) != BSP_ERROR_NONE)
+  {
+#if(CFG_DEBUG_APP_TRACE != 0)
+    APP_DBG_MSG("-- MOTION EXT APPLICATION SERVER : ERROR SETTING THE EVENTS\n ");
+#endif
+  }
+  else
+  {
+    HWExtFeaturesStatus = features;
+    MOTION_EXT_Server_App_Context.MultiEventEnabled = 0;
+
+    if(EXT_CHECK_HW_FEATURE(EXT_HWF_PEDOMETER))
+    {
+      IKS01A3_MOTION_SENSOR_Reset_Step_Counter(IKS01A3_LSM6DSO_0);
+    }
+  }
+
+  return (uint8_t)(HWExtFeaturesStatus & ~EXT_HWF_MULTIPLE_EVENTS);
+}
+
 /**
  * @brief  Send a notification for Step Count on read request from GATT Client (ST BLE Sensor App)
  * @param  None
@@ -419,7 +488,7 @@ static void Enable_FreeFall(void)
   {
     EXT_ON_HW_FEATURE(EXT_HWF_FREE_FALL);
   }
-  if (IKS01A3_MOTION_SENSOR_Set_Free_Fall_Threshold(IKS01A3_LSM6DSO_0, LSM6DSO_FF_TSH_250mg) != BSP_ERROR_NONE)
+  if (IKS01A3_MOTION_SENSOR_Set_Free_Fall_Threshold(IKS01A3_LSM6DSO_0, EXT_FREE_FALL_THRESHOLD) != BSP_ERROR_NONE)
   {
 #if(CFG_DEBUG_APP_TRACE != 0)
     APP_DBG_MSG("-- MOTION EXT APPLICATION SERVER : ERROR SETTING FF_TSH\n ");
@@ -469,7 +538,7 @@ static void Enable_DoubleTap(void)
   {
     EXT_ON_HW_FEATURE(EXT_HWF_DOUBLE_TAP);
   }
-  if (IKS01A3_MOTION_SENSOR_Set_Tap_Threshold(IKS01A3_LSM6DSO_0, 0x10/*LSM6DSL_TAP_THRESHOLD_MID*/) != BSP_ERROR_NONE)
+  if (IKS01A3_MOTION_SENSOR_Set_Tap_Threshold(IKS01A3_LSM6DSO_0, EXT_DOUBLE_TAP_THRESHOLD) != BSP_ERROR_NONE)
   {
 #if(CFG_DEBUG_APP_TRACE != 0)
     APP_DBG_MSG("-- MOTION EXT APPLICATION SERVER : ERROR SETTING TAP_TSH\n ");
@@ -898,10 +967,10 @@ static void AccEvent_Notify(uint16_t Command, uint8_t dimByte)
     switch(dimByte)
     {
     case 2:
-      MOTENV_STM_App_Update_Char(ACC_EVENT_CHAR_UUID, VALUE_LEN_SMALL, (uint8_t *)&valueSmall);
+      NOTIFY_Update_Char(MOTENV_STM_ACC_EVENT_CHAR, VALUE_LEN_SMALL, (uint8_t *)&valueSmall);
       break;
     case 3:
-      MOTENV_STM_App_Update_Char(ACC_EVENT_CHAR_UUID, VALUE_LEN_LARGE, (uint8_t *)&valueLarge);
+      NOTIFY_Update_Char(MOTENV_STM_ACC_EVENT_CHAR, VALUE_LEN_LARGE, (uint8_t *)&valueLarge);
       break;
     }
   }
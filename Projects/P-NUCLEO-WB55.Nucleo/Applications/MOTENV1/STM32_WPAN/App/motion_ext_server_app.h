@@ -67,6 +67,7 @@ void MOTION_EXT_Context_Init(void);
 void MOTION_EXT_Set_Notification_Status(uint8_t status);
 void MOTION_EXT_Enable_Feature(uint8_t feature);
 void MOTION_EXT_Disable_Feature(uint8_t feature);
+uint8_t MOTION_EXT_Set_Features(uint8_t features);
 void MOTION_EXT_ReadCB(void);
 void MOTION_EXT_Handle_IT(void);
 
@@ -19,12 +19,16 @@
 #include "app_common.h"
 #include "ble.h"
 #include "dbg_trace.h"
+#include "stm32_seq.h"
 
 #include "motenv_server_app.h"
+#include "notify_app.h"
 #include "motion_server_app.h"
 #include "motionfx_server_app.h"
 
 #include "iks01a3_motion_sensors.h"
+#include "sensor_hub_app.h"
+#include "batch_notify_app.h"
 
 /* Private defines -----------------------------------------------------------*/
 #define ACC_BYTES               (2)
@@ -33,6 +37,11 @@
 
 #define VALUE_LEN_MOTION        (2+3*ACC_BYTES+3*GYRO_BYTES+3*MAG_BYTES)
 
+/* Acc, Gyro and Mag axes */
+#define MOTION_NB_FIELDS        (9)
+/* Longest time a sample waits in the batched notification [ms] */
+#define MOTION_BATCH_MAX_LATENCY (100)
+
 /* Private typedef -----------------------------------------------------------*/
 
 /**
@@ -41,6 +50,7 @@
 typedef struct
 {
   uint8_t  NotificationStatus;
+  uint8_t  BatchNotificationStatus;
 
   IKS01A3_MOTION_SENSOR_Axes_t acceleration;
   IKS01A3_MOTION_SENSOR_Axes_t angular_velocity;
@@ -49,6 +59,7 @@ typedef struct
   uint8_t hasGyro;
   uint8_t hasMag;
 //  float sensitivity_Mul;
+  BATCH_NOTIFY_t Batch;
 } MOTION_Server_App_Context_t;
 
 /* Private macros ------------------------------------------------------------*/
@@ -62,8 +73,10 @@ PLACE_IN_SECTION("BLE_APP_CONTEXT") static MOTION_Server_App_Context_t MOTION_Se
 extern uint8_t manuf_data[14];
 
 /* Private function prototypes -----------------------------------------------*/
-static void MOTION_Handle_Sensor(void);
+static const SENSOR_HUB_Sample_t *MOTION_Handle_Sensor(SENSOR_HUB_Consumer_Id_t Id);
+static void MOTION_Get_Values(int16_t *pValues);
 static void MOTION_GetCaps(void);
+static void MOTION_Batch_Timer_Callback(void);
 
 /* Functions Definition ------------------------------------------------------*/
 
@@ -88,6 +101,10 @@ void MOTION_Context_Init(void)
   MOTION_Set2G_Accelerometer_FullScale();
   MOTION_Set_Notification_Status(0);
 
+  BATCH_NOTIFY_Init(&MOTION_Server_App_Context.Batch, MOTENV_STM_MOTION_BATCH_CHAR,
+                    MOTION_NB_FIELDS, MOTION_BATCH_MAX_LATENCY, MOTION_Batch_Timer_Callback);
+  MOTION_Set_Batch_Notification_Status(0);
+
   /* Check Motion caps */
   MOTION_GetCaps();
 }
@@ -113,6 +130,32 @@ void MOTION_Set_Notification_Status(uint8_t status)
   MOTION_Server_App_Context.NotificationStatus = status;
 }
 
+/**
+ * @brief  Set the batched notification status (enabled/disabled)
+ * @param  status The new notification status
+ * @retval None
+ */
+void MOTION_Set_Batch_Notification_Status(uint8_t status)
+{
+  MOTION_Server_App_Context.BatchNotificationStatus = status;
+
+  if(status == 0)
+  {
+    /* The client does not listen anymore */
+    BATCH_NOTIFY_Reset(&MOTION_Server_App_Context.Batch);
+  }
+}
+
+/**
+ * @brief  Size the batched notifications to the negotiated ATT MTU
+ * @param  Mtu ATT MTU
+ * @retval None
+ */
+void MOTION_Set_Att_Mtu(uint16_t Mtu)
+{
+  BATCH_NOTIFY_Set_Att_Mtu(&MOTION_Server_App_Context.Batch, Mtu);
+}
+
 /**
  * @brief  Send a notification for Motion (Acc/Gyro/Mag) char
  * @param  None
@@ -120,43 +163,25 @@ void MOTION_Set_Notification_Status(uint8_t status)
  */
 void MOTION_Send_Notification_Task(void)
 {
+  const SENSOR_HUB_Sample_t *pSample;
   uint8_t value[VALUE_LEN_MOTION];
+  int16_t values[MOTION_NB_FIELDS];
+  uint8_t i;
 
-  IKS01A3_MOTION_SENSOR_Axes_t AXIS;
-
-  /* Read Motion values */
-  MOTION_Handle_Sensor();
-
-  /* Timestamp */
-  STORE_LE_16(value, (HAL_GetTick()>>3));
-
-  if(MOTION_Server_App_Context.hasAcc == 1)
+  /* Read Motion values: only the last sample delivered is notified */
+  pSample = MOTION_Handle_Sensor(SENSOR_HUB_MOTION);
+  while(pSample != NULL)
   {
-    STORE_LE_16(value+2, MOTION_Server_App_Context.acceleration.x);
-    STORE_LE_16(value+4, MOTION_Server_App_Context.acceleration.y);
-    STORE_LE_16(value+6, MOTION_Server_App_Context.acceleration.z);
+    pSample = MOTION_Handle_Sensor(SENSOR_HUB_MOTION);
   }
+  MOTION_Get_Values(values);
 
-  if(MOTION_Server_App_Context.hasGyro == 1)
-  {
-    MOTION_Server_App_Context.angular_velocity.x/=100;
-    MOTION_Server_App_Context.angular_velocity.y/=100;
-    MOTION_Server_App_Context.angular_velocity.z/=100;
-
-    STORE_LE_16(value+8, MOTION_Server_App_Context.angular_velocity.x);
-    STORE_LE_16(value+10, MOTION_Server_App_Context.angular_velocity.y);
-    STORE_LE_16(value+12, MOTION_Server_App_Context.angular_velocity.z);
-  }
+  /* Timestamp */
+  STORE_LE_16(value, (HAL_GetTick()>>3));
 
-  if(MOTION_Server_App_Context.hasMag == 1)
+  for(i = 0; i < MOTION_NB_FIELDS; i++)
   {
-    AXIS.x = MOTION_Server_App_Context.magnetic_field.x - MOTIONFX_Get_MAG_Offset()->x;
-    AXIS.y = MOTION_Server_App_Context.magnetic_field.y - MOTIONFX_Get_MAG_Offset()->y;
-    AXIS.z = MOTION_Server_App_Context.magnetic_field.z - MOTIONFX_Get_MAG_Offset()->z;
-
-    STORE_LE_16(value+14, AXIS.x);
-    STORE_LE_16(value+16, AXIS.y);
-    STORE_LE_16(value+18, AXIS.z);
+    STORE_LE_16(value+2+(2*i), values[i]);
   }
 
   if(MOTION_Server_App_Context.NotificationStatus)
@@ -165,7 +190,7 @@ void MOTION_Send_Notification_Task(void)
     APP_DBG_MSG("-- MOTION APPLICATION SERVER : NOTIFY CLIENT WITH NEW MOTION PARAMETER VALUE \n ");
     APP_DBG_MSG(" \n\r");
 #endif
-    MOTENV_STM_App_Update_Char(MOTION_CHAR_UUID, VALUE_LEN_MOTION, (uint8_t *)&value);
+    NOTIFY_Update_Char(MOTENV_STM_MOTION_CHAR, VALUE_LEN_MOTION, (uint8_t *)&value);
   }
   else
   {
@@ -177,45 +202,110 @@ void MOTION_Send_Notification_Task(void)
   return;
 }
 
-/* Private functions ---------------------------------------------------------*/
-
 /**
- * @brief  Parse the values read by Motion sensors
+ * @brief  Add the Motion (Acc/Gyro/Mag) samples delivered since the last run
+ *         to the batched notification
  * @param  None
  * @retval None
  */
-static void MOTION_Handle_Sensor(void)
+void MOTION_Batch_Send_Notification_Task(void)
 {
-  uint8_t i;
-  IKS01A3_MOTION_SENSOR_Axes_t acceleration;
-  IKS01A3_MOTION_SENSOR_Axes_t angular_velocity;
-  IKS01A3_MOTION_SENSOR_Axes_t magnetic_field;
+  const SENSOR_HUB_Sample_t *pSample;
+  int16_t values[MOTION_NB_FIELDS];
 
-  for(i = 0; i < IKS01A3_MOTION_INSTANCES_NBR; i++)
+  /* Read Motion values */
+  pSample = MOTION_Handle_Sensor(SENSOR_HUB_MOTION_BATCH);
+  while(pSample != NULL)
   {
-    if(MOTION_Server_App_Context.hasAcc == 1)
-    {
-      if (IKS01A3_MOTION_SENSOR_GetAxes(i, MOTION_ACCELERO, &acceleration) == 0)
-      {
-        MOTION_Server_App_Context.acceleration = acceleration;
-      }
-    }
+    MOTION_Get_Values(values);
 
-    if(MOTION_Server_App_Context.hasGyro == 1)
+    if(MOTION_Server_App_Context.BatchNotificationStatus)
     {
-      if (IKS01A3_MOTION_SENSOR_GetAxes(i, MOTION_GYRO, &angular_velocity) == 0)
-      {
-        MOTION_Server_App_Context.angular_velocity = angular_velocity;
-      }
+      /* Notified when full or after MOTION_BATCH_MAX_LATENCY */
+      BATCH_NOTIFY_Add(&MOTION_Server_App_Context.Batch, pSample->TimeStamp, values);
     }
 
-    if(MOTION_Server_App_Context.hasMag == 1)
-    {
-      if (IKS01A3_MOTION_SENSOR_GetAxes(i, MOTION_MAGNETO, &magnetic_field) == 0)
-      {
-        MOTION_Server_App_Context.magnetic_field = magnetic_field;
-      }
-    }
+    pSample = MOTION_Handle_Sensor(SENSOR_HUB_MOTION_BATCH);
+  }
+
+  /* Run by the latency timer as well: the sensor hub may have stopped delivering */
+  BATCH_NOTIFY_Check_Latency(&MOTION_Server_App_Context.Batch, HAL_GetTick());
+
+  return;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  The first sample of the batch is due: run the batch task
+ * @param  None
+ * @retval None
+ */
+static void MOTION_Batch_Timer_Callback(void)
+{
+  UTIL_SEQ_SetTask(1<<CFG_TASK_NOTIFY_MOTION_BATCH_ID, CFG_SCH_PRIO_0);
+}
+
+/**
+ * @brief  Parse the next sample delivered to a Motion consumer
+ * @param  Id Sensor Hub consumer
+ * @retval Sample read, NULL if none is left
+ */
+static const SENSOR_HUB_Sample_t *MOTION_Handle_Sensor(SENSOR_HUB_Consumer_Id_t Id)
+{
+  const SENSOR_HUB_Sample_t *pSample = SENSOR_HUB_Get_Sample(Id);
+
+  if(pSample == NULL)
+  {
+    return NULL;
+  }
+
+  if((MOTION_Server_App_Context.hasAcc == 1) && ((pSample->Sensors & SENSOR_HUB_ACC) != 0U))
+  {
+    MOTION_Server_App_Context.acceleration = pSample->Acc;
+  }
+
+  if((MOTION_Server_App_Context.hasGyro == 1) && ((pSample->Sensors & SENSOR_HUB_GYRO) != 0U))
+  {
+    MOTION_Server_App_Context.angular_velocity = pSample->Gyro;
+  }
+
+  if((MOTION_Server_App_Context.hasMag == 1) && ((pSample->Sensors & SENSOR_HUB_MAG) != 0U))
+  {
+    MOTION_Server_App_Context.magnetic_field = pSample->Mag;
+  }
+
+  return pSample;
+}
+
+/**
+ * @brief  Scale the last Motion values as sent on the Motion chars
+ * @param  pValues Acc [mg], Gyro [dps/10] and Mag [mgauss, offset removed] axes
+ * @retval None
+ */
+static void MOTION_Get_Values(int16_t *pValues)
+{
+  memset(pValues, 0, MOTION_NB_FIELDS * sizeof(int16_t));
+
+  if(MOTION_Server_App_Context.hasAcc == 1)
+  {
+    pValues[0] = (int16_t)MOTION_Server_App_Context.acceleration.x;
+    pValues[1] = (int16_t)MOTION_Server_App_Context.acceleration.y;
+    pValues[2] = (int16_t)MOTION_Server_App_Context.acceleration.z;
+  }
+
+  if(MOTION_Server_App_Context.hasGyro == 1)
+  {
+    pValues[3] = (int16_t)(MOTION_Server_App_Context.angular_velocity.x / 100);
+    pValues[4] = (int16_t)(MOTION_Server_App_Context.angular_velocity.y / 100);
+    pValues[5] = (int16_t)(MOTION_Server_App_Context.angular_velocity.z / 100);
+  }
+
+  if(MOTION_Server_App_Context.hasMag == 1)
+  {
+    pValues[6] = (int16_t)(MOTION_Server_App_Context.magnetic_field.x - MOTIONFX_Get_MAG_Offset()->x);
+    pValues[7] = (int16_t)(MOTION_Server_App_Context.magnetic_field.y - MOTIONFX_Get_MAG_Offset()->y);
+    pValues[8] = (int16_t)(MOTION_Server_App_Context.magnetic_field.z - MOTIONFX_Get_MAG_Offset()->z);
   }
 }
 
@@ -32,6 +32,9 @@ extern "C" {
 void MOTION_Context_Init(void);
 void MOTION_Set_Notification_Status(uint8_t status);
 void MOTION_Send_Notification_Task(void);
+void MOTION_Set_Batch_Notification_Status(uint8_t status);
+void MOTION_Set_Att_Mtu(uint16_t Mtu);
+void MOTION_Batch_Send_Notification_Task(void);
 void MOTION_Set2G_Accelerometer_FullScale(void);
 
 #ifdef __cplusplus
@@ -21,8 +21,10 @@
 #include "dbg_trace.h"
 
 #include "motenv_server_app.h"
+#include "notify_app.h"
 #include "motionar_server_app.h"
 #include "iks01a3_motion_sensors.h"
+#include "sensor_hub_app.h"
 
 #include "MotionAR_Manager.h"
 
@@ -54,7 +56,7 @@ PLACE_IN_SECTION("BLE_APP_CONTEXT") static MOTIONAR_Server_App_Context_t MOTIONA
 extern uint8_t manuf_data[14];
 
 /* Private function prototypes -----------------------------------------------*/
-static void ComputeMotionAR(void);
+static void ComputeMotionAR(const SENSOR_HUB_Sample_t *pSample);
 static void ActivityRec_Update(MAR_output_t ActivityCode);
 
 /* Functions Definition ------------------------------------------------------*/
@@ -112,8 +114,15 @@ void MOTIONAR_Set_Notification_Status(uint8_t status)
  */
 void MOTIONAR_Send_Notification_Task(void)
 {
-  ComputeMotionAR();
-  MOTIONAR_Server_App_Context.TimeStamp += MOTIONAR_ALGO_PERIOD;
+  const SENSOR_HUB_Sample_t *pSample = SENSOR_HUB_Get_Sample(SENSOR_HUB_ACTIVITY_REC);
+
+  /* Run the algorithm on every sample delivered since the last run */
+  while(pSample != NULL)
+  {
+    ComputeMotionAR(pSample);
+    MOTIONAR_Server_App_Context.TimeStamp += MOTIONAR_ALGO_PERIOD;
+    pSample = SENSOR_HUB_Get_Sample(SENSOR_HUB_ACTIVITY_REC);
+  }
 }
 
 /**
@@ -130,22 +139,18 @@ void MOTIONAR_ActivityRec_Update(void)
 
 /**
  * @brief  Run the AR Manager and update the Activity Recognition char value
- * @param  None
+ * @param  pSample Acc values acquired by the Sensor Hub
  * @retval None
  */
-static void ComputeMotionAR(void)
+static void ComputeMotionAR(const SENSOR_HUB_Sample_t *pSample)
 {
-  IKS01A3_MOTION_SENSOR_Axes_t ACC_Value;
   MAR_input_t data_in = {.acc_x = 0.0f, .acc_y = 0.0f, .acc_z = 0.0f};
   static MAR_output_t ActivityCodePrev = MAR_NOACTIVITY;
 
-  /* Read the Acc values */
-  (void)IKS01A3_MOTION_SENSOR_GetAxes(IKS01A3_LSM6DSO_0, MOTION_ACCELERO, &ACC_Value);
-
   /* Convert acceleration from [mg] to [g] */
-  data_in.acc_x = (float)ACC_Value.x * FROM_MG_TO_G;
-  data_in.acc_y = (float)ACC_Value.y * FROM_MG_TO_G;
-  data_in.acc_z = (float)ACC_Value.z * FROM_MG_TO_G;
+  data_in.acc_x = (float)pSample->Acc.x * FROM_MG_TO_G;
+  data_in.acc_y = (float)pSample->Acc.y * FROM_MG_TO_G;
+  data_in.acc_z = (float)pSample->Acc.z * FROM_MG_TO_G;
 
   MotionAR_manager_run(&data_in, &MOTIONAR_Server_App_Context.ActivityCode, MOTIONAR_Server_App_Context.TimeStamp);
 
@@ -182,7 +187,7 @@ static void ActivityRec_Update(MAR_output_t ActivityCode)
   APP_DBG_MSG("-- MOTIONAR APPLICATION SERVER : NOTIFY CLIENT WITH NEW PARAMETER VALUE \n ");
   APP_DBG_MSG(" \n\r");
 #endif
-  MOTENV_STM_App_Update_Char(ACTIVITY_REC_CHAR_UUID, VALUE_LEN_AR, (uint8_t *)&value);
+  NOTIFY_Update_Char(MOTENV_STM_ACTIVITY_REC_CHAR, VALUE_LEN_AR, (uint8_t *)&value);
 
   return;
 }
@@ -21,8 +21,10 @@
 #include "dbg_trace.h"
 
 #include "motenv_server_app.h"
+#include "notify_app.h"
 #include "motionaw_server_app.h"
 #include "iks01a3_motion_sensors.h"
+#include "sensor_hub_app.h"
 
 #include "MotionAW_Manager.h"
 #include "MotionAR_Manager.h"
@@ -49,9 +51,8 @@ PLACE_IN_SECTION("BLE_APP_CONTEXT") static MOTIONAW_Server_App_Context_t MOTIONA
 extern uint8_t manuf_data[14];
 
 /* Private function prototypes -----------------------------------------------*/
-static void ComputeMotionAW(void);
+static void ComputeMotionAW(const SENSOR_HUB_Sample_t *pSample);
 
-static void Accelero_Sensor_Handler(IKS01A3_MOTION_SENSOR_Axes_t *ACC_Value);
 static void ActivityRec_Update(MAR_output_t ActivityCode);
 
 /* Functions Definition ------------------------------------------------------*/
@@ -92,7 +93,14 @@ void MOTIONAW_Set_Notification_Status(uint8_t status)
 
 void MOTIONAW_Send_Notification_Task(void)
 {
-  ComputeMotionAW();
+  /* Takes the place of MotionAR as the Sensor Hub activity consumer */
+  const SENSOR_HUB_Sample_t *pSample = SENSOR_HUB_Get_Sample(SENSOR_HUB_ACTIVITY_REC);
+
+  while(pSample != NULL)
+  {
+    ComputeMotionAW(pSample);
+    pSample = SENSOR_HUB_Get_Sample(SENSOR_HUB_ACTIVITY_REC);
+  }
 }
 
 void MOTIONAW_ActivityRec_Update(void)
@@ -105,20 +113,17 @@ void MOTIONAW_ActivityRec_Update(void)
  * LOCAL FUNCTIONS
  *
  *************************************************************/
-static void ComputeMotionAW(void)
+static void ComputeMotionAW(const SENSOR_HUB_Sample_t *pSample)
 {
-  IKS01A3_MOTION_SENSOR_Axes_t ACC_Value;
   MAW_input_t data_in = {.AccX = 0.0f, .AccY = 0.0f, .AccZ = 0.0f};
   static MAR_output_t ActivityCodePrev = MAR_NOACTIVITY;
 
   MAW_activity_t CurrentActivityCode;
-  /* Read the Acc values */
-  Accelero_Sensor_Handler(&ACC_Value);
 
   /* Convert acceleration from [mg] to [g] */
-  data_in.AccX = (float)ACC_Value.x * FROM_MG_TO_G;
-  data_in.AccY = (float)ACC_Value.y * FROM_MG_TO_G;
-  data_in.AccZ = (float)ACC_Value.z * FROM_MG_TO_G;
+  data_in.AccX = (float)pSample->Acc.x * FROM_MG_TO_G;
+  data_in.AccY = (float)pSample->Acc.y * FROM_MG_TO_G;
+  data_in.AccZ = (float)pSample->Acc.z * FROM_MG_TO_G;
 
   MotionAW_manager_run(&data_in, &CurrentActivityCode);
   if(CurrentActivityCode >= MAW_STATIONARY && 
@@ -163,16 +168,6 @@ static void ComputeMotionAW(void)
   }
 }
 
-/**
- * @brief  Handles the ACC axes data getting
- * @param  ACC_Value Accelerometer value to be read
- * @retval None
- */
-static void Accelero_Sensor_Handler(IKS01A3_MOTION_SENSOR_Axes_t *ACC_Value)
-{
-  (void)IKS01A3_MOTION_SENSOR_GetAxes(IKS01A3_LSM6DSO_0, MOTION_ACCELERO, ACC_Value);
-}
-
 static void ActivityRec_Update(MAR_output_t ActivityCode)
 {
   uint8_t value[VALUE_LEN_AW];
@@ -185,7 +180,7 @@ static void ActivityRec_Update(MAR_output_t ActivityCode)
   APP_DBG_MSG("-- MOTIONAW APPLICATION SERVER : NOTIFY CLIENT WITH NEW PARAMETER VALUE \n ");
   APP_DBG_MSG(" \n\r");
 #endif
-  MOTENV_STM_App_Update_Char(ACTIVITY_REC_CHAR_UUID, VALUE_LEN_AW, (uint8_t *)&value);
+  NOTIFY_Update_Char(MOTENV_STM_ACTIVITY_REC_CHAR, VALUE_LEN_AW, (uint8_t *)&value);
 
   return;
 }
@@ -21,10 +21,12 @@
 #include "dbg_trace.h"
 
 #include "motenv_server_app.h"
+#include "notify_app.h"
 #include "motionfx_server_app.h"
 #include "config_server_app.h"
 
 #include "MotionFX_Manager.h"
+#include "sensor_hub_app.h"
 
 /* Private defines -----------------------------------------------------------*/
 /**
@@ -74,12 +76,10 @@ extern uint8_t manuf_data[14];
 
 /* Private function prototypes -----------------------------------------------*/
 static void MagCalibTest(void);
-static void ComputeQuaternions(void);
+static void ComputeQuaternions(const SENSOR_HUB_Sample_t *pSample);
 static void Quat_Update(IKS01A3_MOTION_SENSOR_Axes_t *data);
 static void ECompass_Update(uint16_t Angle);
 
-static void Accelero_Sensor_Handler(IKS01A3_MOTION_SENSOR_Axes_t *ACC_Value);
-static void Gyro_Sensor_Handler(IKS01A3_MOTION_SENSOR_Axes_t *GYR_Value);
 static void Magneto_Sensor_Handler(IKS01A3_MOTION_SENSOR_Axes_t *MAG_Value);
 
 /* Functions Definition ------------------------------------------------------*/
@@ -133,23 +133,31 @@ void MOTIONFX_Set_ECompass_Notification_Status(uint8_t status)
 }
 
 /**
- * @brief  Send a notification for Quaternions (Sensor Data Fusion case)
+ * @brief  Return whether Sensor Data Fusion or ECompass notifications are enabled
  * @param  None
- * @retval None
+ * @retval 1 if at least one of them is enabled, 0 otherwise
  */
-void MOTIONFX_Send_Quat_Notification_Task(void)
+uint8_t MOTIONFX_Get_Notification_Status(void)
 {
-  ComputeQuaternions();
+  return ((MOTIONFX_Server_App_Context.QuatNotificationStatus != 0U) ||
+          (MOTIONFX_Server_App_Context.ECompassNotificationStatus != 0U)) ? 1U : 0U;
 }
 
 /**
- * @brief  Send a notification for Quaternions (ECompass case)
+ * @brief  Send a notification for Quaternions (Sensor Data Fusion and ECompass cases)
  * @param  None
  * @retval None
  */
-void MOTIONFX_Send_ECompass_Notification_Task(void)
+void MOTIONFX_Send_Quat_Notification_Task(void)
 {
-  ComputeQuaternions();
+  const SENSOR_HUB_Sample_t *pSample = SENSOR_HUB_Get_Sample(SENSOR_HUB_MOTIONFX);
+
+  /* The fusion runs at a fixed delta time: process every sample delivered */
+  while(pSample != NULL)
+  {
+    ComputeQuaternions(pSample);
+    pSample = SENSOR_HUB_Get_Sample(SENSOR_HUB_MOTIONFX);
+  }
 }
 
 /**
@@ -193,10 +201,10 @@ void MOTIONFX_ReCalibration(void)
 
 /** 
  * @brief  MotionFX Working function
- * @param  None
+ * @param  pSample Acc/Gyro/Mag values acquired by the Sensor Hub
  * @retval None
  */
-static void ComputeQuaternions(void)
+static void ComputeQuaternions(const SENSOR_HUB_Sample_t *pSample)
 {
   MFX_input_t data_in;
   MFX_input_t *pdata_in = &data_in;
@@ -205,9 +213,8 @@ static void ComputeQuaternions(void)
 
   static int32_t CounterFX = 0;
   static int32_t CounterEC = 0;
-  IKS01A3_MOTION_SENSOR_Axes_t ACC_Value;
-  IKS01A3_MOTION_SENSOR_Axes_t GYR_Value;
-  IKS01A3_MOTION_SENSOR_Axes_t MAG_Value;
+  /* Local copy: the ring sample is shared with the other consumers */
+  IKS01A3_MOTION_SENSOR_Axes_t MAG_Value = pSample->Mag;
 
    /* Increment the Counter */
   if(MOTIONFX_Server_App_Context.QuatNotificationStatus)
@@ -219,20 +226,16 @@ static void ComputeQuaternions(void)
     CounterEC++;
   }
 
-  /* Read the Acc values */
-  Accelero_Sensor_Handler(&ACC_Value);
-  /* Read the Gyro values */
-  Gyro_Sensor_Handler(&GYR_Value);
-  /* Read the Magneto values */
+  /* Run the Magneto calibration */
   Magneto_Sensor_Handler(&MAG_Value);
 
-  data_in.gyro[0] = (float)GYR_Value.x * FROM_MDPS_TO_DPS;
-  data_in.gyro[1] = (float)GYR_Value.y * FROM_MDPS_TO_DPS;
-  data_in.gyro[2] = (float)GYR_Value.z * FROM_MDPS_TO_DPS;
+  data_in.gyro[0] = (float)pSample->Gyro.x * FROM_MDPS_TO_DPS;
+  data_in.gyro[1] = (float)pSample->Gyro.y * FROM_MDPS_TO_DPS;
+  data_in.gyro[2] = (float)pSample->Gyro.z * FROM_MDPS_TO_DPS;
 
-  data_in.acc[0] = (float)ACC_Value.x * FROM_MG_TO_G;
-  data_in.acc[1] = (float)ACC_Value.y * FROM_MG_TO_G;
-  data_in.acc[2] = (float)ACC_Value.z * FROM_MG_TO_G;
+  data_in.acc[0] = (float)pSample->Acc.x * FROM_MG_TO_G;
+  data_in.acc[1] = (float)pSample->Acc.y * FROM_MG_TO_G;
+  data_in.acc[2] = (float)pSample->Acc.z * FROM_MG_TO_G;
 
   data_in.mag[0] = (float)MAG_Value.x * FROM_MGAUSS_TO_UT50;
   data_in.mag[1] = (float)MAG_Value.y * FROM_MGAUSS_TO_UT50;
@@ -282,28 +285,8 @@ static void ComputeQuaternions(void)
 }
 
 /**
- * @brief  Handle the ACC axes data getting
- * @param  ACC_Value Accelerometer value to be read
- * @retval None
- */
-static void Accelero_Sensor_Handler(IKS01A3_MOTION_SENSOR_Axes_t *ACC_Value)
-{
-  (void)IKS01A3_MOTION_SENSOR_GetAxes(IKS01A3_LSM6DSO_0, MOTION_ACCELERO, ACC_Value);
-}
-
-/**
- * @brief  Handle the GYRO axes data getting
- * @param  GYR_Value Gyro value to be read
- * @retval None
- */
-static void Gyro_Sensor_Handler(IKS01A3_MOTION_SENSOR_Axes_t *GYR_Value)
-{
-  (void)IKS01A3_MOTION_SENSOR_GetAxes(IKS01A3_LSM6DSO_0, MOTION_GYRO, GYR_Value);
-}
-
-/**
- * @brief  Handle the MAGNETO axes data getting
- * @param  MAG_Value Magneto value to be read
+ * @brief  Handle the MAGNETO calibration and offset compensation
+ * @param  MAG_Value Magneto value acquired by the Sensor Hub, compensated in place
  * @retval None
  */
 static void Magneto_Sensor_Handler(IKS01A3_MOTION_SENSOR_Axes_t *MAG_Value)
@@ -313,8 +296,6 @@ static void Magneto_Sensor_Handler(IKS01A3_MOTION_SENSOR_Axes_t *MAG_Value)
   MFX_MagCal_output_t mag_data_out;
   static int32_t calibIndex = 0;
 
-  IKS01A3_MOTION_SENSOR_GetAxes(IKS01A3_LIS2MDL_0, MOTION_MAGNETO, MAG_Value);
-
   if (MOTIONFX_Server_App_Context.MagCalStatus == 0U)
   {
     /* Run Compass Calibration @ 25Hz */
@@ -400,7 +381,7 @@ static void Quat_Update(IKS01A3_MOTION_SENSOR_Axes_t *data)
     //APP_DBG_MSG("-- MOTIONFX APPLICATION SERVER : NOTIFY CLIENT WITH NEW QUAT PARAMETER VALUE \n ");
     //APP_DBG_MSG(" \n\r");
 #endif
-    MOTENV_STM_App_Update_Char(MOTION_FX_CHAR_UUID, VALUE_LEN_QUAT, (uint8_t *)&value);
+    NOTIFY_Update_Char(MOTENV_STM_MOTION_FX_CHAR, VALUE_LEN_QUAT, (uint8_t *)&value);
   }
   else
   {
@@ -432,7 +413,7 @@ static void ECompass_Update(uint16_t Angle)
     //APP_DBG_MSG("-- MOTIONFX APPLICATION SERVER : NOTIFY CLIENT WITH NEW ECOMPASS PARAMETER VALUE \n ");
     //APP_DBG_MSG(" \n\r");
 #endif
-    MOTENV_STM_App_Update_Char(ECOMPASS_CHAR_UUID, VALUE_LEN_ECOMPASS, (uint8_t *)&value);
+    NOTIFY_Update_Char(MOTENV_STM_ECOMPASS_CHAR, VALUE_LEN_ECOMPASS, (uint8_t *)&value);
   }
   else
   {
@@ -33,8 +33,8 @@ extern "C" {
 void MOTIONFX_Context_Init(void);
 void MOTIONFX_Set_Quat_Notification_Status(uint8_t status);
 void MOTIONFX_Set_ECompass_Notification_Status(uint8_t status);
+uint8_t MOTIONFX_Get_Notification_Status(void);
 void MOTIONFX_Send_Quat_Notification_Task(void);
-void MOTIONFX_Send_ECompass_Notification_Task(void);
 
 uint8_t MOTIONFX_Get_MagCalStatus(void);
 IKS01A3_MOTION_SENSOR_Axes_t *MOTIONFX_Get_MAG_Offset(void);
@@ -21,8 +21,10 @@
 #include "dbg_trace.h"
 
 #include "motenv_server_app.h"
+#include "notify_app.h"
 #include "motiongr_server_app.h"
 #include "iks01a3_motion_sensors.h"
+#include "sensor_hub_app.h"
 
 #include "MotionGR_Manager.h"
 
@@ -50,7 +52,7 @@ PLACE_IN_SECTION("BLE_APP_CONTEXT") static MOTIONGR_Server_App_Context_t MOTIONG
 extern uint8_t manuf_data[14];
 
 /* Private function prototypes -----------------------------------------------*/
-static void ComputeMotionGR(void);
+static void ComputeMotionGR(const SENSOR_HUB_Sample_t *pSample);
 static void GestureRec_Update(MGR_output_t GestureRecCode);
 
 /* Functions Definition ------------------------------------------------------*/
@@ -107,7 +109,14 @@ void MOTIONGR_Set_Notification_Status(uint8_t status)
  */
 void MOTIONGR_Send_Notification_Task(void)
 {
-  ComputeMotionGR();
+  const SENSOR_HUB_Sample_t *pSample = SENSOR_HUB_Get_Sample(SENSOR_HUB_GESTURE_REC);
+
+  /* Run the algorithm on every sample delivered since the last run */
+  while(pSample != NULL)
+  {
+    ComputeMotionGR(pSample);
+    pSample = SENSOR_HUB_Get_Sample(SENSOR_HUB_GESTURE_REC);
+  }
 }
 
 /**
@@ -124,22 +133,18 @@ void MOTIONGR_GestureRec_Update(void)
 
 /**
  * @brief  Run the GR Manager and update the Gesture Recognition char value
- * @param  None
+ * @param  pSample Acc values acquired by the Sensor Hub
  * @retval None
  */
-static void ComputeMotionGR(void)
+static void ComputeMotionGR(const SENSOR_HUB_Sample_t *pSample)
 {
-  IKS01A3_MOTION_SENSOR_Axes_t ACC_Value;
   MGR_input_t data_in = {.AccX = 0.0f, .AccY = 0.0f, .AccZ = 0.0f};
   static MGR_output_t GestureRecCodePrev = MGR_NOGESTURE;
 
-  /* Read the Acc values */
-  (void)IKS01A3_MOTION_SENSOR_GetAxes(IKS01A3_LSM6DSO_0, MOTION_ACCELERO, &ACC_Value);
-
   /* Convert acceleration from [mg] to [g] */
-  data_in.AccX = (float)ACC_Value.x * FROM_MG_TO_G;
-  data_in.AccY = (float)ACC_Value.y * FROM_MG_TO_G;
-  data_in.AccZ = (float)ACC_Value.z * FROM_MG_TO_G;
+  data_in.AccX = (float)pSample->Acc.x * FROM_MG_TO_G;
+  data_in.AccY = (float)pSample->Acc.y * FROM_MG_TO_G;
+  data_in.AccZ = (float)pSample->Acc.z * FROM_MG_TO_G;
 
   MotionGR_manager_run(&data_in, &MOTIONGR_Server_App_Context.GestureRecCode);
 
@@ -176,7 +181,7 @@ static void GestureRec_Update(MGR_output_t GestureRecCode)
   APP_DBG_MSG("-- MOTIONGR APPLICATION SERVER : NOTIFY CLIENT WITH NEW PARAMETER VALUE \n ");
   APP_DBG_MSG(" \n\r");
 #endif
-  MOTENV_STM_App_Update_Char(GESTURE_REC_CHAR_UUID, VALUE_LEN_GR, (uint8_t *)&value);
+  NOTIFY_Update_Char(MOTENV_STM_GESTURE_REC_CHAR, VALUE_LEN_GR, (uint8_t *)&value);
 
   return;
 }
@@ -21,8 +21,10 @@
 #include "dbg_trace.h"
 
 #include "motenv_server_app.h"
+#include "notify_app.h"
 #include "motionid_server_app.h"
 #include "iks01a3_motion_sensors.h"
+#include "sensor_hub_app.h"
 
 #include "MotionID_Manager.h"
 
@@ -50,7 +52,7 @@ PLACE_IN_SECTION("BLE_APP_CONTEXT") static MOTIONID_Server_App_Context_t MOTIONI
 extern uint8_t manuf_data[14];
 
 /* Private function prototypes -----------------------------------------------*/
-static void ComputeMotionID(void);
+static void ComputeMotionID(const SENSOR_HUB_Sample_t *pSample);
 static void IntensityDet_Update(MID_output_t MIDCode);
 
 /* Functions Definition ------------------------------------------------------*/
@@ -107,7 +109,14 @@ void MOTIONID_Set_Notification_Status(uint8_t status)
  */
 void MOTIONID_Send_Notification_Task(void)
 {
-  ComputeMotionID();
+  const SENSOR_HUB_Sample_t *pSample = SENSOR_HUB_Get_Sample(SENSOR_HUB_INTENSITY_DET);
+
+  /* Run the algorithm on every sample delivered since the last run */
+  while(pSample != NULL)
+  {
+    ComputeMotionID(pSample);
+    pSample = SENSOR_HUB_Get_Sample(SENSOR_HUB_INTENSITY_DET);
+  }
 }
 
 /**
@@ -124,22 +133,18 @@ void MOTIONID_IntensityDet_Update(void)
 
 /**
  * @brief  Run the MID Manager and update the Motion Intensity char value
- * @param  None
+ * @param  pSample Acc values acquired by the Sensor Hub
  * @retval None
  */
-static void ComputeMotionID(void)
+static void ComputeMotionID(const SENSOR_HUB_Sample_t *pSample)
 {
-  IKS01A3_MOTION_SENSOR_Axes_t ACC_Value;
   MID_input_t data_in = {.AccX = 0.0f, .AccY = 0.0f, .AccZ = 0.0f};
   static MID_output_t MIDCodePrev = MID_ON_DESK;
 
-  /* Read the Acc values */
-  (void)IKS01A3_MOTION_SENSOR_GetAxes(IKS01A3_LSM6DSO_0, MOTION_ACCELERO, &ACC_Value);
-
   /* Convert acceleration from [mg] to [g] */
-  data_in.AccX = (float)ACC_Value.x * FROM_MG_TO_G;
-  data_in.AccY = (float)ACC_Value.y * FROM_MG_TO_G;
-  data_in.AccZ = (float)ACC_Value.z * FROM_MG_TO_G;
+  data_in.AccX = (float)pSample->Acc.x * FROM_MG_TO_G;
+  data_in.AccY = (float)pSample->Acc.y * FROM_MG_TO_G;
+  data_in.AccZ = (float)pSample->Acc.z * FROM_MG_TO_G;
 
   MotionID_manager_run(&data_in, &MOTIONID_Server_App_Context.MIDCode);
 
@@ -176,7 +181,7 @@ static void IntensityDet_Update(MID_output_t MIDCode)
   APP_DBG_MSG("-- MOTIONID APPLICATION SERVER : NOTIFY CLIENT WITH NEW PARAMETER VALUE \n ");
   APP_DBG_MSG(" \n\r");
 #endif
-  MOTENV_STM_App_Update_Char(INTENSITY_DET_CHAR_UUID, VALUE_LEN_ID, (uint8_t *)&value);
+  NOTIFY_Update_Char(MOTENV_STM_INTENSITY_DET_CHAR, VALUE_LEN_ID, (uint8_t *)&value);
 
   return;
 }
@@ -21,8 +21,10 @@
 #include "dbg_trace.h"
 
 #include "motenv_server_app.h"
+#include "notify_app.h"
 #include "motionpm_server_app.h"
 #include "iks01a3_motion_sensors.h"
+#include "sensor_hub_app.h"
 
 #include "MotionPM_Manager.h"
 
@@ -50,7 +52,7 @@ PLACE_IN_SECTION("BLE_APP_CONTEXT") static MOTIONPM_Server_App_Context_t MOTIONP
 extern uint8_t manuf_data[14];
 
 /* Private function prototypes -----------------------------------------------*/
-static void ComputeMotionPM(void);
+static void ComputeMotionPM(const SENSOR_HUB_Sample_t *pSample);
 static void Pedometer_Update(MPM_output_t *PM_Data);
 
 /* Functions Definition ------------------------------------------------------*/
@@ -108,7 +110,14 @@ void MOTIONPM_Set_Notification_Status(uint8_t status)
  */
 void MOTIONPM_Send_Notification_Task(void)
 {
-  ComputeMotionPM();
+  const SENSOR_HUB_Sample_t *pSample = SENSOR_HUB_Get_Sample(SENSOR_HUB_PEDOMETER);
+
+  /* Run the algorithm on every sample delivered since the last run */
+  while(pSample != NULL)
+  {
+    ComputeMotionPM(pSample);
+    pSample = SENSOR_HUB_Get_Sample(SENSOR_HUB_PEDOMETER);
+  }
 }
 
 /**
@@ -125,22 +134,18 @@ void MOTIONPM_Pedometer_Update(void)
 
 /**
  * @brief  Run the MPM Manager and update the Motion Pedometer char value
- * @param  None
+ * @param  pSample Acc values acquired by the Sensor Hub
  * @retval None
  */
-static void ComputeMotionPM(void)
+static void ComputeMotionPM(const SENSOR_HUB_Sample_t *pSample)
 {
-  IKS01A3_MOTION_SENSOR_Axes_t ACC_Value;
   MPM_input_t data_in = {.AccX = 0.0f, .AccY = 0.0f, .AccZ = 0.0f};
   static MPM_output_t PMDataPrev = {.Cadence = 0, .Nsteps = 0};
 
-  /* Read the Acc values */
-  (void)IKS01A3_MOTION_SENSOR_GetAxes(IKS01A3_LSM6DSO_0, MOTION_ACCELERO, &ACC_Value);
-
   /* Convert acceleration from [mg] to [g] */
-  data_in.AccX = (float)ACC_Value.x * FROM_MG_TO_G;
-  data_in.AccY = (float)ACC_Value.y * FROM_MG_TO_G;
-  data_in.AccZ = (float)ACC_Value.z * FROM_MG_TO_G;
+  data_in.AccX = (float)pSample->Acc.x * FROM_MG_TO_G;
+  data_in.AccY = (float)pSample->Acc.y * FROM_MG_TO_G;
+  data_in.AccZ = (float)pSample->Acc.z * FROM_MG_TO_G;
 
   MotionPM_manager_run(&data_in, &MOTIONPM_Server_App_Context.PMData);
 
@@ -180,7 +185,7 @@ static void Pedometer_Update(MPM_output_t *PMData)
   APP_DBG_MSG("-- MOTIONPM APPLICATION SERVER : NOTIFY CLIENT WITH NEW PARAMETER VALUE \n ");
   APP_DBG_MSG(" \n\r");
 #endif
-  MOTENV_STM_App_Update_Char(PEDOMETER_CHAR_UUID, VALUE_LEN_PM, (uint8_t *)&value);
+  NOTIFY_Update_Char(MOTENV_STM_PEDOMETER_CHAR, VALUE_LEN_PM, (uint8_t *)&value);
 
   return;
 }
@@ -0,0 +1,361 @@
+/**
+ ******************************************************************************
+ * File Name          : notify_app.c
+ * Description        : Keep the newest value of each char while the stack
+ *                      has no buffer for the notification, and queue every
+ *                      value of the event chars
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "app_common.h"
+#include "ble.h"
+#include "stm32_seq.h"
+
+#include "motenv_server_app.h"
+#include "notify_app.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * @brief  Newest value of one char not notified yet
+ */
+typedef struct
+{
+  uint8_t Value[NOTIFY_MAX_VALUE_LEN];
+  uint8_t Length;
+  uint32_t TimeStamp;           /* When Value was written [ms] */
+  NOTIFY_Stats_t Stats;
+} NOTIFY_Slot_t;
+
+/**
+ * @brief  Value of an event char not notified yet
+ */
+typedef struct
+{
+  MOTENV_STM_Char_t Char;
+  uint8_t Value[NOTIFY_MAX_VALUE_LEN];
+  uint8_t Length;
+  uint32_t TimeStamp;           /* When Value was written [ms] */
+} NOTIFY_Event_t;
+
+/**
+ * @brief  Notification Context structure definition
+ */
+typedef struct
+{
+  NOTIFY_Slot_t Slot[MOTENV_STM_CHAR_NUMBER];
+  uint8_t Rank[MOTENV_STM_CHAR_NUMBER];  /* Position of each char in NOTIFY_Order */
+  uint16_t Ready;               /* Slots waiting, bit n for NOTIFY_Order[n] */
+  uint16_t Served;              /* Slots notified in the current round */
+  NOTIFY_Event_t Fifo[NOTIFY_FIFO_SIZE];
+  uint8_t FifoHead;             /* Oldest event */
+  uint8_t FifoCount;
+  uint8_t WaitTxPool;           /* Stack buffers full: wait for ACI_GATT_TX_POOL_AVAILABLE */
+} NOTIFY_Context_t;
+
+/* Private macros ------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+PLACE_IN_SECTION("BLE_APP_CONTEXT") static NOTIFY_Context_t NOTIFY_Context;
+
+/**
+ * Chars notified first when the stack has buffers again, after the queued
+ * events: the rare values before the periodic ones, the fastest last
+ */
+static const MOTENV_STM_Char_t NOTIFY_Order[MOTENV_STM_CHAR_NUMBER] =
+{
+  MOTENV_STM_GESTURE_REC_CHAR,
+  MOTENV_STM_ACTIVITY_REC_CHAR,
+  MOTENV_STM_CARRY_POSITION_CHAR,
+  MOTENV_STM_PEDOMETER_CHAR,
+  MOTENV_STM_INTENSITY_DET_CHAR,
+  MOTENV_STM_ENV_CHAR,
+  MOTENV_STM_ECOMPASS_CHAR,
+  MOTENV_STM_MOTION_CHAR,
+  MOTENV_STM_MOTION_FX_CHAR,
+  /* Every value queued in the Fifo, not in a slot */
+  MOTENV_STM_CONFIG_CHAR,
+  MOTENV_STM_ACC_EVENT_CHAR,
+  /* Own queues, not kept here */
+  MOTENV_STM_MOTION_BATCH_CHAR,
+  MOTENV_STM_CONSOLE_TERM_CHAR,
+  MOTENV_STM_CONSOLE_STDERR_CHAR
+};
+
+/* Global variables ----------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static tBleStatus NOTIFY_Keep(MOTENV_STM_Char_t Char, uint8_t payloadLen, const uint8_t *pPayload);
+static void NOTIFY_Sent(NOTIFY_Slot_t *pSlot, tBleStatus status, uint32_t TimeStamp);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Init the Notification Context
+ * @param  None
+ * @retval None
+ */
+void NOTIFY_Init(void)
+{
+  uint8_t i;
+
+  memset(&NOTIFY_Context, 0, sizeof(NOTIFY_Context));
+  for(i = 0; i < (uint8_t)MOTENV_STM_CHAR_NUMBER; i++)
+  {
+    NOTIFY_Context.Rank[NOTIFY_Order[i]] = i;
+  }
+}
+
+/**
+ * @brief  Notify a char value. When the stack has no buffer left, or values
+ *         are already waiting, the value is kept in the slot of the char,
+ *         replacing the one not notified yet, or queued for the Config and
+ *         Acc Event chars, and NOTIFY_Flush_Task() sends it on
+ *         ACI_GATT_TX_POOL_AVAILABLE
+ * @param  Char       Characteristic
+ * @param  payloadLen Length of the char value (up to NOTIFY_MAX_VALUE_LEN)
+ * @param  pPayload   Char value
+ * @retval BLE_STATUS_SUCCESS if the value is notified or kept,
+ *         BLE_STATUS_INSUFFICIENT_RESOURCES if the event queue is full,
+ *         BLE status otherwise
+ */
+tBleStatus NOTIFY_Update_Char(MOTENV_STM_Char_t Char, uint8_t payloadLen, uint8_t *pPayload)
+{
+  NOTIFY_Slot_t *pSlot;
+  tBleStatus status;
+
+  if((Char >= MOTENV_STM_CHAR_NUMBER) || (payloadLen > NOTIFY_MAX_VALUE_LEN))
+  {
+    return MOTENV_STM_App_Update_Char(Char, payloadLen, pPayload);
+  }
+
+  /* Behind the values waiting: keep the order of the priorities */
+  if((NOTIFY_Context.WaitTxPool != 0U) || (NOTIFY_Context.Ready != 0U) || (NOTIFY_Context.FifoCount != 0U))
+  {
+    return NOTIFY_Keep(Char, payloadLen, pPayload);
+  }
+
+  pSlot = &NOTIFY_Context.Slot[Char];
+  status = MOTENV_STM_App_Update_Char(Char, payloadLen, pPayload);
+  if(status == BLE_STATUS_SUCCESS)
+  {
+    pSlot->Stats.Sent++;
+  }
+  else if(status == BLE_STATUS_INSUFFICIENT_RESOURCES)
+  {
+    NOTIFY_Context.WaitTxPool = 1;
+    status = NOTIFY_Keep(Char, payloadLen, pPayload);
+  }
+  else
+  {
+    pSlot->Stats.Dropped++;
+  }
+
+  return status;
+}
+
+/**
+ * @brief  Forget the values not notified (disconnection)
+ * @param  None
+ * @retval None
+ */
+void NOTIFY_Reset(void)
+{
+  NOTIFY_Context.Ready = 0;
+  NOTIFY_Context.Served = 0;
+  NOTIFY_Context.FifoCount = 0;
+  NOTIFY_Context.WaitTxPool = 0;
+}
+
+/**
+ * @brief  The stack has buffers again for the notifications
+ * @param  None
+ * @retval None
+ */
+void NOTIFY_Tx_Pool_Available(void)
+{
+  NOTIFY_Context.WaitTxPool = 0;
+  if((NOTIFY_Context.Ready != 0U) || (NOTIFY_Context.FifoCount != 0U))
+  {
+    UTIL_SEQ_SetTask(1<<CFG_TASK_NOTIFY_FLUSH_ID, CFG_SCH_PRIO_0);
+  }
+}
+
+/**
+ * @brief  Notify the oldest queued event, else the waiting value of the most
+ *         important char not served in the current round, so a char
+ *         refreshed faster than the link drains does not starve the others,
+ *         and run again while values are waiting, so that the other tasks
+ *         are served in between
+ * @param  None
+ * @retval None
+ */
+void NOTIFY_Flush_Task(void)
+{
+  NOTIFY_Event_t *pEvent;
+  NOTIFY_Slot_t *pSlot;
+  MOTENV_STM_Char_t Char;
+  tBleStatus status;
+  uint16_t waiting;
+  uint8_t rank;
+
+  if((NOTIFY_Context.WaitTxPool != 0U) || ((NOTIFY_Context.Ready == 0U) && (NOTIFY_Context.FifoCount == 0U)))
+  {
+    return;
+  }
+
+  if(NOTIFY_Context.FifoCount != 0U)
+  {
+    pEvent = &NOTIFY_Context.Fifo[NOTIFY_Context.FifoHead];
+    status = MOTENV_STM_App_Update_Char(pEvent->Char, pEvent->Length, pEvent->Value);
+    if(status == BLE_STATUS_INSUFFICIENT_RESOURCES)
+    {
+      /* Kept in the Fifo, sent again on ACI_GATT_TX_POOL_AVAILABLE */
+      NOTIFY_Context.WaitTxPool = 1;
+      return;
+    }
+
+    NOTIFY_Context.FifoHead = (NOTIFY_Context.FifoHead + 1U) % NOTIFY_FIFO_SIZE;
+    NOTIFY_Context.FifoCount--;
+    NOTIFY_Sent(&NOTIFY_Context.Slot[pEvent->Char], status, pEvent->TimeStamp);
+  }
+  else
+  {
+    waiting = NOTIFY_Context.Ready & (uint16_t)~NOTIFY_Context.Served;
+    if(waiting == 0U)
+    {
+      /* Every waiting char had its turn: next round */
+      NOTIFY_Context.Served = 0;
+      waiting = NOTIFY_Context.Ready;
+    }
+    rank = 0;
+    while((waiting & (1U << rank)) == 0U)
+    {
+      rank++;
+    }
+    Char = NOTIFY_Order[rank];
+    pSlot = &NOTIFY_Context.Slot[Char];
+
+    status = MOTENV_STM_App_Update_Char(Char, pSlot->Length, pSlot->Value);
+    if(status == BLE_STATUS_INSUFFICIENT_RESOURCES)
+    {
+      /* Kept in the slot, sent again on ACI_GATT_TX_POOL_AVAILABLE */
+      NOTIFY_Context.WaitTxPool = 1;
+      return;
+    }
+
+    NOTIFY_Context.Ready &= (uint16_t)~(1U << rank);
+    NOTIFY_Context.Served |= (uint16_t)(1U << rank);
+    NOTIFY_Sent(pSlot, status, pSlot->TimeStamp);
+  }
+
+  if((NOTIFY_Context.Ready != 0U) || (NOTIFY_Context.FifoCount != 0U))
+  {
+    UTIL_SEQ_SetTask(1<<CFG_TASK_NOTIFY_FLUSH_ID, CFG_SCH_PRIO_0);
+  }
+}
+
+/**
+ * @brief  Notification statistics of a char
+ * @param  Char Characteristic
+ * @retval Statistics, NULL for an unknown char
+ */
+const NOTIFY_Stats_t *NOTIFY_Get_Stats(MOTENV_STM_Char_t Char)
+{
+  if(Char >= MOTENV_STM_CHAR_NUMBER)
+  {
+    return NULL;
+  }
+  return &NOTIFY_Context.Slot[Char].Stats;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Write a value in the slot of its char, or at the end of the Fifo
+ *         for an event char: a Config reply or an Acc Event is not replaced
+ *         by the next one. Called behind the values waiting or with
+ *         WaitTxPool set: the flush task is already set, or due on
+ *         ACI_GATT_TX_POOL_AVAILABLE
+ * @param  Char       Characteristic
+ * @param  payloadLen Length of the char value
+ * @param  pPayload   Char value
+ * @retval BLE_STATUS_SUCCESS, BLE_STATUS_INSUFFICIENT_RESOURCES if the Fifo is full
+ */
+static tBleStatus NOTIFY_Keep(MOTENV_STM_Char_t Char, uint8_t payloadLen, const uint8_t *pPayload)
+{
+  NOTIFY_Slot_t *pSlot = &NOTIFY_Context.Slot[Char];
+  NOTIFY_Event_t *pEvent;
+  uint16_t bit = (uint16_t)(1U << NOTIFY_Context.Rank[Char]);
+
+  if((Char == MOTENV_STM_CONFIG_CHAR) || (Char == MOTENV_STM_ACC_EVENT_CHAR))
+  {
+    if(NOTIFY_Context.FifoCount == NOTIFY_FIFO_SIZE)
+    {
+      pSlot->Stats.Dropped++;
+      return BLE_STATUS_INSUFFICIENT_RESOURCES;
+    }
+    pEvent = &NOTIFY_Context.Fifo[(NOTIFY_Context.FifoHead + NOTIFY_Context.FifoCount) % NOTIFY_FIFO_SIZE];
+    pEvent->Char = Char;
+    memcpy(pEvent->Value, pPayload, payloadLen);
+    pEvent->Length = payloadLen;
+    pEvent->TimeStamp = HAL_GetTick();
+    NOTIFY_Context.FifoCount++;
+  }
+  else
+  {
+    if((NOTIFY_Context.Ready & bit) != 0U)
+    {
+      pSlot->Stats.Coalesced++;
+    }
+    memcpy(pSlot->Value, pPayload, payloadLen);
+    pSlot->Length = payloadLen;
+    pSlot->TimeStamp = HAL_GetTick();
+    NOTIFY_Context.Ready |= bit;
+  }
+
+  return BLE_STATUS_SUCCESS;
+}
+
+/**
+ * @brief  Count a value sent by NOTIFY_Flush_Task()
+ * @param  pSlot     Slot of the char
+ * @param  status    Status of the notification
+ * @param  TimeStamp When the value was written [ms]
+ * @retval None
+ */
+static void NOTIFY_Sent(NOTIFY_Slot_t *pSlot, tBleStatus status, uint32_t TimeStamp)
+{
+  uint32_t delay;
+
+  if(status == BLE_STATUS_SUCCESS)
+  {
+    pSlot->Stats.Deferred++;
+    delay = HAL_GetTick() - TimeStamp;
+    if(delay > pSlot->Stats.MaxDelay)
+    {
+      pSlot->Stats.MaxDelay = delay;
+    }
+  }
+  else
+  {
+    pSlot->Stats.Dropped++;
+  }
+}
+
+ /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,63 @@
+/**
+ ******************************************************************************
+ * File Name          : notify_app.h
+ * Description        : Keep the newest value of each char while the stack
+ *                      has no buffer for the notification
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef NOTIFY_APP_H
+#define NOTIFY_APP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief  Notification statistics of one char
+ */
+typedef struct
+{
+  uint32_t Sent;        /* Values notified at once */
+  uint32_t Deferred;    /* Values notified after ACI_GATT_TX_POOL_AVAILABLE */
+  uint32_t Coalesced;   /* Values replaced by a newer one before being notified */
+  uint32_t Dropped;     /* Values refused by the stack for another reason, or by a full queue */
+  uint32_t MaxDelay;    /* Longest time a deferred value waited [ms] */
+} NOTIFY_Stats_t;
+
+/* Exported constants --------------------------------------------------------*/
+/* Longest value kept while the stack is busy (Motion, Quaternions, Config) */
+#define NOTIFY_MAX_VALUE_LEN            (20)
+/* Config replies and Acc Events queued while the stack is busy */
+#define NOTIFY_FIFO_SIZE                (8)
+
+/* External variables --------------------------------------------------------*/
+/* Exported macros -----------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+void NOTIFY_Init(void);
+tBleStatus NOTIFY_Update_Char(MOTENV_STM_Char_t Char, uint8_t payloadLen, uint8_t *pPayload);
+void NOTIFY_Reset(void);
+void NOTIFY_Tx_Pool_Available(void);
+void NOTIFY_Flush_Task(void);
+const NOTIFY_Stats_t *NOTIFY_Get_Stats(MOTENV_STM_Char_t Char);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NOTIFY_APP_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,458 @@
+/**
+ ******************************************************************************
+ * File Name          : sensor_hub_app.c
+ * Description        : Shared motion sensor acquisition for all MOTENV features
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "app_common.h"
+#include "stm32_seq.h"
+
+#include "sensor_hub_app.h"
+#include "iks01a3_motion_sensors_ex.h"
+#include "stm32wbxx_nucleo_bus.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * @brief  Consumer descriptor
+ */
+typedef struct
+{
+  uint32_t Period;      /* Requested period [HW_TS ticks] */
+  uint32_t Elapsed;     /* Time accumulated since the last delivery [HW_TS ticks] */
+  uint32_t Sensors;     /* SENSOR_HUB_ACC/GYRO/MAG */
+  uint32_t TaskId;      /* Sequencer task run on delivery */
+  uint32_t ReadSeq;     /* Acquisition number of the last sample read */
+  uint32_t Unread;      /* Samples delivered and not read yet */
+  uint8_t  Active;
+} SENSOR_HUB_Consumer_t;
+
+/**
+ * @brief  Sensor Hub context
+ */
+typedef struct
+{
+  SENSOR_HUB_Consumer_t Consumer[SENSOR_HUB_CONSUMER_NBR];
+  SENSOR_HUB_Sample_t Ring[SENSOR_HUB_RING_SIZE];
+  uint32_t Seq;         /* Acquisition number of the last sample, in Ring[Seq % SENSOR_HUB_RING_SIZE] */
+  uint8_t Timer_Id;
+  uint32_t Period;      /* Current hub period [HW_TS ticks], 0 when stopped */
+  /* Acquisition in progress on the bus */
+  uint8_t Imu[LSM6DSO_AXES_ALL_SIZE];    /* Gyro then Acc: contiguous registers, one burst */
+  uint8_t Mag[LIS2MDL_AXES_SIZE];
+  uint32_t Due;         /* Consumers waiting for the acquisition */
+  uint32_t Sensors;     /* Sensors being read */
+  uint32_t TimeStamp;   /* When the reads were posted */
+  volatile uint8_t Pending; /* Reads not completed yet */
+  volatile int32_t ReadStatus;
+  SENSOR_HUB_Stats_t Stats;
+} SENSOR_HUB_Context_t;
+
+/* Private macros ------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static SENSOR_HUB_Context_t SENSOR_HUB_Context;
+
+/* Global variables ----------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void SENSOR_HUB_Timer_Callback(void);
+static void SENSOR_HUB_Task(void);
+static void SENSOR_HUB_Ready_Task(void);
+static void SENSOR_HUB_Update_Period(void);
+static void SENSOR_HUB_Acquire(uint32_t Sensors);
+static void SENSOR_HUB_Read(uint32_t Instance, uint8_t *pData, uint16_t Size);
+static void SENSOR_HUB_Read_Cb(int32_t Status, void *pCtx);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Init the Sensor Hub (register the acquisition task, create its timer)
+ * @param  None
+ * @retval None
+ */
+void SENSOR_HUB_Init(void)
+{
+  memset(&SENSOR_HUB_Context, 0, sizeof(SENSOR_HUB_Context));
+
+  UTIL_SEQ_RegTask(1<<CFG_TASK_SENSOR_HUB_ID, UTIL_SEQ_RFU, SENSOR_HUB_Task);
+  UTIL_SEQ_RegTask(1<<CFG_TASK_SENSOR_HUB_READY_ID, UTIL_SEQ_RFU, SENSOR_HUB_Ready_Task);
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+               &(SENSOR_HUB_Context.Timer_Id),
+               hw_ts_Repeated,
+               SENSOR_HUB_Timer_Callback);
+}
+
+/**
+ * @brief  Describe a consumer. It receives nothing until SENSOR_HUB_Start()
+ * @param  Id      Consumer identifier
+ * @param  Period  Delivery period [HW_TS ticks]
+ * @param  Sensors Sensors needed by the consumer (SENSOR_HUB_ACC/GYRO/MAG)
+ * @param  TaskId  Sequencer task set on every delivery
+ * @retval None
+ */
+void SENSOR_HUB_Register(SENSOR_HUB_Consumer_Id_t Id, uint32_t Period, uint32_t Sensors, uint32_t TaskId)
+{
+  SENSOR_HUB_Consumer_t *pConsumer = &SENSOR_HUB_Context.Consumer[Id];
+
+  pConsumer->Period = Period;
+  pConsumer->Sensors = Sensors;
+  pConsumer->TaskId = TaskId;
+  pConsumer->Active = 0;
+}
+
+/**
+ * @brief  Start delivering samples to a consumer
+ * @param  Id Consumer identifier
+ * @retval None
+ */
+void SENSOR_HUB_Start(SENSOR_HUB_Consumer_Id_t Id)
+{
+  SENSOR_HUB_Consumer_t *pConsumer = &SENSOR_HUB_Context.Consumer[Id];
+
+  /* Ignore consumers never registered (e.g. no motion sensors on board) */
+  if((pConsumer->Active == 0) && (pConsumer->Period != 0U))
+  {
+    pConsumer->Elapsed = 0;
+    /* Nothing to read from the acquisitions made before */
+    pConsumer->ReadSeq = SENSOR_HUB_Context.Seq;
+    pConsumer->Unread = 0;
+    pConsumer->Active = 1;
+    SENSOR_HUB_Update_Period();
+  }
+}
+
+/**
+ * @brief  Stop delivering samples to a consumer
+ * @param  Id Consumer identifier
+ * @retval None
+ */
+void SENSOR_HUB_Stop(SENSOR_HUB_Consumer_Id_t Id)
+{
+  SENSOR_HUB_Consumer_t *pConsumer = &SENSOR_HUB_Context.Consumer[Id];
+
+  if(pConsumer->Active == 1)
+  {
+    pConsumer->Active = 0;
+    SENSOR_HUB_Update_Period();
+  }
+}
+
+/**
+ * @brief  Stop all the consumers and the acquisition timer
+ * @param  None
+ * @retval None
+ */
+void SENSOR_HUB_StopAll(void)
+{
+  uint32_t i;
+
+  for(i = 0; i < (uint32_t)SENSOR_HUB_CONSUMER_NBR; i++)
+  {
+    SENSOR_HUB_Context.Consumer[i].Active = 0;
+  }
+  SENSOR_HUB_Update_Period();
+}
+
+/**
+ * @brief  Return the oldest sample delivered to a consumer and not read yet.
+ *         The consumer task runs once for several deliveries when it is late:
+ *         it must call this function until it returns NULL
+ * @param  Id Consumer identifier
+ * @retval Pointer to the sample in the ring, valid until the task returns, or NULL
+ */
+const SENSOR_HUB_Sample_t *SENSOR_HUB_Get_Sample(SENSOR_HUB_Consumer_Id_t Id)
+{
+  SENSOR_HUB_Consumer_t *pConsumer = &SENSOR_HUB_Context.Consumer[Id];
+  SENSOR_HUB_Sample_t *pSample;
+  uint32_t seq = pConsumer->ReadSeq;
+
+  /* The older acquisitions are overwritten */
+  if((SENSOR_HUB_Context.Seq - seq) > SENSOR_HUB_RING_SIZE)
+  {
+    seq = SENSOR_HUB_Context.Seq - SENSOR_HUB_RING_SIZE;
+  }
+
+  /* The ring holds the samples of all the consumers: skip those not due for this one */
+  while((pConsumer->Unread != 0U) && (seq != SENSOR_HUB_Context.Seq))
+  {
+    seq++;
+    pSample = &SENSOR_HUB_Context.Ring[seq % SENSOR_HUB_RING_SIZE];
+    if((pSample->Consumers & (1U << Id)) != 0U)
+    {
+      pConsumer->ReadSeq = seq;
+      pConsumer->Unread--;
+      return pSample;
+    }
+  }
+
+  /* What is left was overwritten */
+  SENSOR_HUB_Context.Stats.Lost += pConsumer->Unread;
+  pConsumer->Unread = 0;
+  pConsumer->ReadSeq = SENSOR_HUB_Context.Seq;
+
+  return NULL;
+}
+
+/**
+ * @brief  Return the acquisition statistics
+ * @param  pStats Where the statistics are copied
+ * @retval None
+ */
+void SENSOR_HUB_Get_Stats(SENSOR_HUB_Stats_t *pStats)
+{
+  *pStats = SENSOR_HUB_Context.Stats;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  On timeout, trigger the acquisition task
+ * @param  None
+ * @retval None
+ */
+static void SENSOR_HUB_Timer_Callback(void)
+{
+  UTIL_SEQ_SetTask(1<<CFG_TASK_SENSOR_HUB_ID, CFG_SCH_PRIO_0);
+}
+
+/**
+ * @brief  Run the hub at the fastest active consumer period. The GCD of the
+ *         periods would be a tick or two (e.g. 40 and 102 ticks for 20ms and 50ms):
+ *         the slower consumers are decimated by SENSOR_HUB_Task() instead
+ * @param  None
+ * @retval None
+ */
+static void SENSOR_HUB_Update_Period(void)
+{
+  uint32_t i;
+  uint32_t period = 0;
+
+  for(i = 0; i < (uint32_t)SENSOR_HUB_CONSUMER_NBR; i++)
+  {
+    SENSOR_HUB_Consumer_t *pConsumer = &SENSOR_HUB_Context.Consumer[i];
+
+    if((pConsumer->Active == 1) && ((period == 0) || (pConsumer->Period < period)))
+    {
+      period = pConsumer->Period;
+    }
+  }
+
+  if(period != SENSOR_HUB_Context.Period)
+  {
+    HW_TS_Stop(SENSOR_HUB_Context.Timer_Id);
+    if(period != 0)
+    {
+      HW_TS_Start(SENSOR_HUB_Context.Timer_Id, period);
+    }
+    SENSOR_HUB_Context.Period = period;
+  }
+}
+
+/**
+ * @brief  Post once the reads of the sensors needed by the consumers due
+ *         on this tick. The bus is serviced by DMA, the sample is delivered
+ *         by SENSOR_HUB_Ready_Task()
+ * @param  None
+ * @retval None
+ */
+static void SENSOR_HUB_Task(void)
+{
+  uint32_t i;
+  uint32_t due = 0;
+  uint32_t sensors = 0;
+
+  if(SENSOR_HUB_Context.Period == 0)
+  {
+    return;
+  }
+
+  SENSOR_HUB_Context.Stats.Ticks++;
+
+  /* The previous acquisition is still on the bus: skip this tick */
+  if(SENSOR_HUB_Context.Pending != 0)
+  {
+    SENSOR_HUB_Context.Stats.Overruns++;
+    return;
+  }
+
+  /* Consumer periods need not be multiples of the hub one (e.g. 62.5ms over 10ms):
+   * accumulate the elapsed time so that the average delivery rate is exact */
+  for(i = 0; i < (uint32_t)SENSOR_HUB_CONSUMER_NBR; i++)
+  {
+    SENSOR_HUB_Consumer_t *pConsumer = &SENSOR_HUB_Context.Consumer[i];
+
+    if(pConsumer->Active == 1)
+    {
+      pConsumer->Elapsed += SENSOR_HUB_Context.Period;
+      if(pConsumer->Elapsed >= pConsumer->Period)
+      {
+        pConsumer->Elapsed -= pConsumer->Period;
+        due |= (1U << i);
+        sensors |= pConsumer->Sensors;
+      }
+    }
+  }
+
+  if(due == 0)
+  {
+    return;
+  }
+
+  SENSOR_HUB_Context.Due = due;
+  SENSOR_HUB_Context.TimeStamp = HAL_GetTick();
+  SENSOR_HUB_Acquire(sensors);
+}
+
+/**
+ * @brief  All the reads are completed: store the sample in the ring,
+ *         tagged with the consumers due, and wake them up
+ * @param  None
+ * @retval None
+ */
+static void SENSOR_HUB_Ready_Task(void)
+{
+  uint32_t i;
+  SENSOR_HUB_Sample_t *pSample;
+
+  if(SENSOR_HUB_Context.ReadStatus != BSP_ERROR_NONE)
+  {
+    /* The consumers get no sample for this tick */
+    SENSOR_HUB_Context.Stats.BusErrors++;
+    return;
+  }
+
+  SENSOR_HUB_Context.Seq++;
+  pSample = &SENSOR_HUB_Context.Ring[SENSOR_HUB_Context.Seq % SENSOR_HUB_RING_SIZE];
+  pSample->TimeStamp = SENSOR_HUB_Context.TimeStamp;
+  pSample->Consumers = 0;
+  pSample->Sensors = SENSOR_HUB_Context.Sensors;
+
+  /* Fixed-point sensitivities are cached by the drivers: no bus access here */
+  if((pSample->Sensors & (SENSOR_HUB_ACC | SENSOR_HUB_GYRO)) != 0U)
+  {
+    (void)IKS01A3_MOTION_SENSOR_Convert_AccGyro_Axes(IKS01A3_LSM6DSO_0, &SENSOR_HUB_Context.Imu[0],
+                                                     &pSample->Acc, &pSample->Gyro);
+  }
+  if((pSample->Sensors & SENSOR_HUB_MAG) != 0U)
+  {
+    (void)IKS01A3_MOTION_SENSOR_Convert_Mag_Axes(IKS01A3_LIS2MDL_0, &SENSOR_HUB_Context.Mag[0], &pSample->Mag);
+  }
+
+  for(i = 0; i < (uint32_t)SENSOR_HUB_CONSUMER_NBR; i++)
+  {
+    /* A consumer may have been stopped while the bus was busy */
+    if(((SENSOR_HUB_Context.Due & (1U << i)) != 0U) && (SENSOR_HUB_Context.Consumer[i].Active == 1))
+    {
+      pSample->Consumers |= (1U << i);
+      SENSOR_HUB_Context.Consumer[i].Unread++;
+      SENSOR_HUB_Context.Stats.Deliveries++;
+      UTIL_SEQ_SetTask(1<<SENSOR_HUB_Context.Consumer[i].TaskId, CFG_SCH_PRIO_0);
+    }
+  }
+}
+
+/**
+ * @brief  Post the reads of the requested motion sensors. Gyro and Acc
+ *         are contiguous in the LSM6DSO: both are read in one burst
+ * @param  Sensors Sensors to be read (SENSOR_HUB_ACC/GYRO/MAG)
+ * @retval None
+ */
+static void SENSOR_HUB_Acquire(uint32_t Sensors)
+{
+  if((Sensors & (SENSOR_HUB_ACC | SENSOR_HUB_GYRO)) != 0U)
+  {
+    Sensors |= (SENSOR_HUB_ACC | SENSOR_HUB_GYRO);
+  }
+
+  SENSOR_HUB_Context.Sensors = Sensors;
+  SENSOR_HUB_Context.ReadStatus = BSP_ERROR_NONE;
+  /* Count of all the reads set before the first is posted, as the completion
+   * interrupt decrements it, plus one held until all the reads are posted */
+  SENSOR_HUB_Context.Pending = 1U + (((Sensors & SENSOR_HUB_ACC) != 0U) ? 1U : 0U)
+                                  + (((Sensors & SENSOR_HUB_MAG) != 0U) ? 1U : 0U);
+
+  if((Sensors & SENSOR_HUB_ACC) != 0U)
+  {
+    SENSOR_HUB_Read(IKS01A3_LSM6DSO_0, &SENSOR_HUB_Context.Imu[0], sizeof(SENSOR_HUB_Context.Imu));
+  }
+
+  if((Sensors & SENSOR_HUB_MAG) != 0U)
+  {
+    SENSOR_HUB_Read(IKS01A3_LIS2MDL_0, &SENSOR_HUB_Context.Mag[0], sizeof(SENSOR_HUB_Context.Mag));
+  }
+
+  /* Release the extra count */
+  SENSOR_HUB_Read_Cb(BSP_ERROR_NONE, NULL);
+}
+
+/**
+ * @brief  Post the read of the output registers of a sensor. The device address
+ *         and the registers are given by its driver. The read is already
+ *         counted in Pending
+ * @param  Instance Motion sensor instance
+ * @param  pData    Where the registers are read
+ * @param  Size     Size of pData
+ * @retval None
+ */
+static void SENSOR_HUB_Read(uint32_t Instance, uint8_t *pData, uint16_t Size)
+{
+  uint8_t address;
+  uint8_t reg;
+  uint16_t length;
+
+  SENSOR_HUB_Context.Stats.BusReads++;
+
+  if((IKS01A3_MOTION_SENSOR_Get_Axes_Reg(Instance, &address, &reg, &length) != BSP_ERROR_NONE) ||
+     (length > Size))
+  {
+    SENSOR_HUB_Read_Cb(BSP_ERROR_WRONG_PARAM, NULL);
+  }
+  else if(BSP_I2C1_ReadRegAsync(address, reg, pData, length, I2C_QUEUE_FLAG_MERGE,
+                                SENSOR_HUB_Read_Cb, NULL) != BSP_ERROR_NONE)
+  {
+    SENSOR_HUB_Read_Cb(BSP_ERROR_BUSY, NULL);
+  }
+}
+
+/**
+ * @brief  One read completed (I2C interrupt context)
+ * @param  Status BSP status of the read
+ * @param  pCtx   Not used
+ * @retval None
+ */
+static void SENSOR_HUB_Read_Cb(int32_t Status, void *pCtx)
+{
+  uint32_t primask_bit = __get_PRIMASK();
+
+  UNUSED(pCtx);
+
+  __disable_irq();
+  if(Status != BSP_ERROR_NONE)
+  {
+    SENSOR_HUB_Context.ReadStatus = Status;
+  }
+  SENSOR_HUB_Context.Pending--;
+  if(SENSOR_HUB_Context.Pending == 0)
+  {
+    UTIL_SEQ_SetTask(1<<CFG_TASK_SENSOR_HUB_READY_ID, CFG_SCH_PRIO_0);
+  }
+  __set_PRIMASK(primask_bit);
+}
+
+ /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
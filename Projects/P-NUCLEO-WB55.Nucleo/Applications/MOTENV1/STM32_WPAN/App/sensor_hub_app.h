@@ -0,0 +1,100 @@
+/**
+ ******************************************************************************
+ * File Name          : sensor_hub_app.h
+ * Description        : Shared motion sensor acquisition for all MOTENV features
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SENSOR_HUB_APP_H
+#define SENSOR_HUB_APP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "iks01a3_motion_sensors.h"
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief  Consumers of the motion samples, one per algorithm/characteristic
+ */
+typedef enum
+{
+  SENSOR_HUB_MOTION,
+  SENSOR_HUB_MOTION_BATCH,
+  SENSOR_HUB_MOTIONFX,
+  SENSOR_HUB_ACTIVITY_REC,
+  SENSOR_HUB_CARRY_POSITION,
+  SENSOR_HUB_GESTURE_REC,
+  SENSOR_HUB_PEDOMETER,
+  SENSOR_HUB_INTENSITY_DET,
+  SENSOR_HUB_CONSUMER_NBR
+} SENSOR_HUB_Consumer_Id_t;
+
+/**
+ * @brief  One timestamped acquisition of the motion sensors
+ */
+typedef struct
+{
+  uint32_t TimeStamp;                 /* HAL tick when the reads were posted [ms] */
+  uint32_t Consumers;                 /* Consumers the sample was delivered to */
+  uint32_t Sensors;                   /* SENSOR_HUB_ACC/GYRO/MAG fields actually read */
+  IKS01A3_MOTION_SENSOR_Axes_t Acc;   /* [mg] */
+  IKS01A3_MOTION_SENSOR_Axes_t Gyro;  /* [mdps] */
+  IKS01A3_MOTION_SENSOR_Axes_t Mag;   /* [mgauss] */
+} SENSOR_HUB_Sample_t;
+
+/**
+ * @brief  Acquisition statistics
+ */
+typedef struct
+{
+  uint32_t Ticks;       /* Hub timer expirations handled */
+  uint32_t BusReads;    /* I2C reads posted by the hub (before bus merging) */
+  uint32_t Deliveries;  /* Samples handed to consumers */
+  uint32_t Lost;        /* Samples delivered but overwritten before their consumer read them */
+  uint32_t Overruns;    /* Ticks skipped, previous acquisition still on the bus */
+  uint32_t BusErrors;   /* Acquisitions dropped on a bus error */
+} SENSOR_HUB_Stats_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define SENSOR_HUB_ACC                  (1U << 0)
+#define SENSOR_HUB_GYRO                 (1U << 1)
+#define SENSOR_HUB_MAG                  (1U << 2)
+
+/**
+ * @brief  Number of samples kept in the ring: a consumer reads all the samples
+ *         delivered to it as long as its task runs within this many acquisitions
+ */
+#define SENSOR_HUB_RING_SIZE            (8)
+
+/* External variables --------------------------------------------------------*/
+/* Exported macros -----------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+void SENSOR_HUB_Init(void);
+void SENSOR_HUB_Register(SENSOR_HUB_Consumer_Id_t Id, uint32_t Period, uint32_t Sensors, uint32_t TaskId);
+void SENSOR_HUB_Start(SENSOR_HUB_Consumer_Id_t Id);
+void SENSOR_HUB_Stop(SENSOR_HUB_Consumer_Id_t Id);
+void SENSOR_HUB_StopAll(void);
+const SENSOR_HUB_Sample_t *SENSOR_HUB_Get_Sample(SENSOR_HUB_Consumer_Id_t Id);
+void SENSOR_HUB_Get_Stats(SENSOR_HUB_Stats_t *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSOR_HUB_APP_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
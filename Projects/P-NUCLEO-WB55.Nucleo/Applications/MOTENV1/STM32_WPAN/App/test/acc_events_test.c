@@ -0,0 +1,383 @@
+/**
+ ******************************************************************************
+ * File Name          : acc_events_test.c
+ * Description        : Host test of the Acc events set in one command:
+ *                      config_server_app.c, motion_ext_server_app.c, the
+ *                      IKS01A3 BSP and the LSM6DSO driver run over a register
+ *                      model of the LSM6DSO (user and embedded functions
+ *                      banks, page memory).
+ *                      Run by Tools/run_host_tests.sh
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "app_common.h"
+#include "ble.h"
+
+#include "motenv_server_app.h"
+#include "notify_app.h"
+#include "config_server_app.h"
+#include "motion_ext_server_app.h"
+#include "iks01a3_motion_sensors.h"
+#include "iks01a3_motion_sensors_ex.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define LSM6DSO_ADDRESS                 (0xD6U)
+
+#define FUNC_CFG_ACCESS                 (0x01U)
+#define PAGE_SEL                        (0x02U)
+#define PAGE_ADDRESS                    (0x08U)
+#define PAGE_VALUE                      (0x09U)
+#define CTRL1_XL                        (0x10U)
+#define CTRL3_C                         (0x12U)
+
+#define BANK_USER                       (0U)
+#define BANK_EMBEDDED                   (2U)
+#define BANK()                          (User[FUNC_CFG_ACCESS] >> 6)
+
+#define NB_EVENT_SETS                   (128U)
+#define IMAGE_SIZE                      (256U + 256U + (16U * 256U))
+
+#define CHECK(cond)                     do { if(!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); Failures++; } } while(0)
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum
+{
+  FAIL_NONE,
+  FAIL_EMBEDDED_READ,           /* Next read in the embedded functions bank */
+  FAIL_EMBEDDED_WRITE,          /* Next write in the embedded functions bank */
+} Fail_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t Failures;
+static uint32_t Now;                    /* [ms] */
+
+/* LSM6DSO register model */
+static uint8_t User[256];
+static uint8_t Embedded[256];
+static uint8_t SensorHub[256];
+static uint8_t Page[16][256];
+static uint32_t Xfers;
+static Fail_t Fail;
+
+/* Last Config char notification */
+static uint8_t ConfigCommand;
+static uint8_t ConfigData;
+static uint32_t ConfigNotifications;
+
+/* The single event commands, in the order the events are enabled */
+static const char Single_Commands[] = "ptfsdow";
+static const uint8_t Single_Events[] =
+{
+  EXT_HWF_PEDOMETER, EXT_HWF_TILT, EXT_HWF_FREE_FALL, EXT_HWF_SINGLE_TAP,
+  EXT_HWF_DOUBLE_TAP, EXT_HWF_6D_ORIENTATION, EXT_HWF_WAKE_UP
+};
+
+static uint8_t Reference[NB_EVENT_SETS][IMAGE_SIZE];
+
+/* Private functions ---------------------------------------------------------*/
+static uint8_t *Reg(uint8_t Reg)
+{
+  if((Reg == FUNC_CFG_ACCESS) || (BANK() == BANK_USER))
+  {
+    return &User[Reg];
+  }
+  if(BANK() == BANK_EMBEDDED)
+  {
+    return &Embedded[Reg];
+  }
+  return &SensorHub[Reg];
+}
+
+static void Access(uint8_t Reg_Addr, uint8_t *pData, uint8_t Write)
+{
+  uint8_t *pValue;
+
+  if((BANK() == BANK_EMBEDDED) && (Reg_Addr == PAGE_VALUE))
+  {
+    pValue = &Page[Embedded[PAGE_SEL] >> 4][Embedded[PAGE_ADDRESS]];
+    Embedded[PAGE_ADDRESS]++;
+  }
+  else
+  {
+    pValue = Reg(Reg_Addr);
+  }
+
+  if(Write != 0U)
+  {
+    *pValue = *pData;
+    if(Reg_Addr == CTRL3_C)
+    {
+      /* BOOT and SW_RESET clear themselves */
+      User[CTRL3_C] &= (uint8_t)~0x81U;
+    }
+  }
+  else
+  {
+    *pData = *pValue;
+  }
+}
+
+/* Everything but the bank selection */
+static void Image(uint8_t *pImage)
+{
+  memcpy(pImage, User, 256);
+  pImage[FUNC_CFG_ACCESS] = 0;
+  memcpy(&pImage[256], Embedded, 256);
+  memcpy(&pImage[512], Page, sizeof(Page));
+}
+
+static void Boot(void)
+{
+  static uint8_t booted = 0;
+
+  if(booted != 0U)
+  {
+    (void)IKS01A3_MOTION_SENSOR_DeInit(IKS01A3_LSM6DSO_0);
+  }
+  booted = 1;
+
+  memset(User, 0, sizeof(User));
+  memset(Embedded, 0, sizeof(Embedded));
+  memset(SensorHub, 0, sizeof(SensorHub));
+  memset(Page, 0, sizeof(Page));
+  User[0x0F] = 0x6C;                    /* WHO_AM_I */
+  User[CTRL3_C] = 0x04;                 /* IF_INC */
+  Fail = FAIL_NONE;
+  Now = 1000;
+
+  /* Accelerometer running at the driver default, 104 Hz, when the Acc events context is initialized.
+   * Enabling the notifications turns the multiple events on */
+  CHECK(IKS01A3_MOTION_SENSOR_Init(IKS01A3_LSM6DSO_0, MOTION_ACCELERO | MOTION_GYRO) == BSP_ERROR_NONE);
+  CHECK(IKS01A3_MOTION_SENSOR_Enable(IKS01A3_LSM6DSO_0, MOTION_ACCELERO) == BSP_ERROR_NONE);
+  CONFIG_Context_Init();
+  CONFIG_Set_Notification_Status(1);
+  MOTION_EXT_Context_Init();
+  MOTION_EXT_Set_Notification_Status(1);
+}
+
+static void Command(uint8_t Command_Id, uint8_t Data)
+{
+  uint8_t att_data[6] =
+  {
+    (uint8_t)(FEATURE_MASK_ACC_EVENTS >> 24), (uint8_t)(FEATURE_MASK_ACC_EVENTS >> 16),
+    (uint8_t)(FEATURE_MASK_ACC_EVENTS >> 8), (uint8_t)FEATURE_MASK_ACC_EVENTS, Command_Id, Data
+  };
+
+  Now += 10U;
+  (void)CONFIG_Parse_Command(att_data, sizeof(att_data));
+}
+
+/* Each event set through the single event commands, from boot */
+static void Build_References(void)
+{
+  uint32_t set;
+  uint32_t i;
+
+  for(set = 1; set < NB_EVENT_SETS; set++)
+  {
+    Boot();
+    for(i = 0; i < sizeof(Single_Events); i++)
+    {
+      if((set & Single_Events[i]) != 0U)
+      {
+        Command((uint8_t)Single_Commands[i], 1);
+      }
+    }
+    Image(Reference[set]);
+  }
+}
+
+/* One 'e' command gives the registers of the single event commands */
+static void Test_Event_Sets(void)
+{
+  uint8_t image[IMAGE_SIZE];
+  uint32_t xfers = 0;
+  uint32_t set;
+  uint32_t t0;
+
+  for(set = 1; set < NB_EVENT_SETS; set++)
+  {
+    Boot();
+    t0 = Xfers;
+    ConfigNotifications = 0;
+    Command('e', (uint8_t)set);
+    xfers += Xfers - t0;
+
+    Image(image);
+    CHECK(memcmp(image, Reference[set], IMAGE_SIZE) == 0);
+    CHECK(BANK() == BANK_USER);
+    CHECK((ConfigNotifications == 1U) && (ConfigCommand == 'e') && (ConfigData == set));
+  }
+
+  printf("event sets: %.1f transactions per 'e' command\n", (double)xfers / (NB_EVENT_SETS - 1U));
+  CHECK(xfers < (30U * (NB_EVENT_SETS - 1U)));
+}
+
+/* From any set to any other is the same as from boot */
+static void Test_Transitions(void)
+{
+  uint8_t image[IMAGE_SIZE];
+  uint32_t seed = 99;
+  uint32_t set;
+  uint32_t n;
+
+  Boot();
+  for(n = 0; n < 2000U; n++)
+  {
+    seed = (seed * 1103515245U) + 12345U;
+    set = ((seed >> 16) % (NB_EVENT_SETS - 1U)) + 1U;
+    Command('e', (uint8_t)set);
+
+    /* The step counter and the status registers are not part of the configuration */
+    Image(image);
+    CHECK(memcmp(&image[0x0D], &Reference[set][0x0D], 2) == 0);
+    CHECK(image[CTRL1_XL] == Reference[set][CTRL1_XL]);
+    CHECK(memcmp(&image[0x56], &Reference[set][0x56], 10) == 0);
+    CHECK(memcmp(&image[256 + 0x04], &Reference[set][256 + 0x04], 2) == 0);
+    CHECK(memcmp(&image[256 + 0x0A], &Reference[set][256 + 0x0A], 3) == 0);
+    CHECK(memcmp(&image[256 + 0x0E], &Reference[set][256 + 0x0E], 3) == 0);
+    CHECK(BANK() == BANK_USER);
+  }
+}
+
+/* No event left: back to the ODR read at init, 104 Hz */
+static void Test_Idle_Odr(void)
+{
+  float odr = 0.0f;
+
+  Boot();
+  Command('e', EXT_HWF_FREE_FALL | EXT_HWF_PEDOMETER);
+  CHECK((User[CTRL1_XL] >> 4) == 0x6U);
+  Command('e', 0);
+  CHECK(IKS01A3_MOTION_SENSOR_GetOutputDataRate(IKS01A3_LSM6DSO_0, MOTION_ACCELERO, &odr) == BSP_ERROR_NONE);
+  CHECK(odr == 104.0f);
+  CHECK(ConfigData == 0U);
+}
+
+/* A bus error in the embedded functions bank leaves the user bank selected: the
+ * pedometer and tilt enabled at boot by the multiple events are turned off */
+static void Test_Bank_Restore(Fail_t Where)
+{
+  IKS01A3_MOTION_SENSOR_Event_Config_t config;
+
+  Boot();
+  config.Events = LSM6DSO_EVENT_FREE_FALL;
+  config.FreeFallThreshold = LSM6DSO_FF_TSH_250mg;
+  config.DoubleTapThreshold = 0x10;
+  config.IdleOdr = 104.0f;
+
+  Fail = Where;
+  CHECK(IKS01A3_MOTION_SENSOR_Set_Event_Detection(IKS01A3_LSM6DSO_0, &config) != BSP_ERROR_NONE);
+  CHECK(Fail == FAIL_NONE);
+  CHECK(BANK() == BANK_USER);
+
+  /* The next call goes through */
+  CHECK(IKS01A3_MOTION_SENSOR_Set_Event_Detection(IKS01A3_LSM6DSO_0, &config) == BSP_ERROR_NONE);
+  CHECK(memcmp(&Embedded[0x04], &Reference[EXT_HWF_FREE_FALL][256 + 0x04], 2) == 0);
+  CHECK(BANK() == BANK_USER);
+}
+
+/* Stubs ---------------------------------------------------------------------*/
+uint32_t HAL_GetTick(void)
+{
+  return Now;
+}
+
+int32_t BSP_GetTick(void)
+{
+  return (int32_t)Now;
+}
+
+int32_t BSP_I2C1_Init(void)
+{
+  return BSP_ERROR_NONE;
+}
+
+int32_t BSP_I2C1_DeInit(void)
+{
+  return BSP_ERROR_NONE;
+}
+
+int32_t BSP_I2C1_ReadReg(uint16_t Addr, uint16_t Reg, uint8_t *pData, uint16_t Length)
+{
+  uint16_t i;
+
+  Xfers++;
+  if(((Addr & 0xFEU) != LSM6DSO_ADDRESS) || ((Fail == FAIL_EMBEDDED_READ) && (BANK() == BANK_EMBEDDED)))
+  {
+    Fail = FAIL_NONE;
+    return BSP_ERROR_BUS_FAILURE;
+  }
+  for(i = 0; i < Length; i++)
+  {
+    Access((uint8_t)(Reg + i), &pData[i], 0);
+  }
+  return BSP_ERROR_NONE;
+}
+
+int32_t BSP_I2C1_WriteReg(uint16_t Addr, uint16_t Reg, uint8_t *pData, uint16_t Length)
+{
+  uint16_t i;
+
+  Xfers++;
+  if(((Addr & 0xFEU) != LSM6DSO_ADDRESS) ||
+     ((Fail == FAIL_EMBEDDED_WRITE) && (BANK() == BANK_EMBEDDED) && (Reg != FUNC_CFG_ACCESS)))
+  {
+    Fail = FAIL_NONE;
+    return BSP_ERROR_BUS_FAILURE;
+  }
+  for(i = 0; i < Length; i++)
+  {
+    Access((uint8_t)(Reg + i), &pData[i], 1);
+  }
+  return BSP_ERROR_NONE;
+}
+
+/* Payload: timestamp, feature mask, command, data */
+tBleStatus NOTIFY_Update_Char(MOTENV_STM_Char_t Char, uint8_t payloadLen, uint8_t *pPayload)
+{
+  if(Char == MOTENV_STM_CONFIG_CHAR)
+  {
+    CHECK(payloadLen >= 8U);
+    ConfigCommand = pPayload[6];
+    ConfigData = pPayload[7];
+    ConfigNotifications++;
+  }
+  return BLE_STATUS_SUCCESS;
+}
+
+uint8_t MOTIONFX_Get_MagCalStatus(void)
+{
+  return 0;
+}
+
+void MOTIONFX_ReCalibration(void)
+{
+}
+
+int main(void)
+{
+  Build_References();
+
+  Test_Event_Sets();
+  Test_Transitions();
+  Test_Idle_Odr();
+  Test_Bank_Restore(FAIL_EMBEDDED_READ);
+  Test_Bank_Restore(FAIL_EMBEDDED_WRITE);
+
+  printf("%s\n", (Failures == 0U) ? "PASS" : "FAIL");
+  return (Failures == 0U) ? 0 : 1;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,232 @@
+/**
+ ******************************************************************************
+ * File Name          : batch_notify_test.c
+ * Description        : Host test of the batched notifications: packets are
+ *                      decoded back and compared with the samples added, and
+ *                      the latency timer flushes a batch no sample completes.
+ *                      Run by Tools/run_host_tests.sh
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "app_common.h"
+#include "ble.h"
+
+#include "batch_notify_app.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define NB_FIELDS                       (9)
+#define MAX_LATENCY                     (100)
+#define NB_SAMPLES                      (5000)
+
+#define TICKS_TO_MS(ticks)              (((ticks) * CFG_TS_TICK_VAL) / 1000U)
+
+#define CHECK(cond)                     do { if(!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); Failures++; } } while(0)
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t Now;                    /* [ms] */
+static uint32_t Failures;
+
+/* Latency timer */
+static HW_TS_pTimerCb_t TimerCb;
+static uint32_t TimerDeadline;
+static uint8_t TimerRunning;
+static uint8_t TimerExpired;
+
+/* Samples added, in order, and how many were decoded back */
+static int16_t RefValues[NB_SAMPLES][NB_FIELDS];
+static uint16_t RefTimeStamp[NB_SAMPLES];
+static uint32_t NbRef;
+static uint32_t NbDecoded;
+static uint32_t NbPackets;
+static uint16_t LongestPacket;
+static uint32_t LastFlushTime;
+
+/* Stubs ---------------------------------------------------------------------*/
+uint32_t HAL_GetTick(void)
+{
+  return Now;
+}
+
+HW_TS_ReturnStatus_t HW_TS_Create(uint32_t TimerProcessID, uint8_t *pTimerId, HW_TS_Mode_t TimerMode, HW_TS_pTimerCb_t pTimerCallBack)
+{
+  (void)TimerProcessID;
+  (void)TimerMode;
+  *pTimerId = 0;
+  TimerCb = pTimerCallBack;
+  return hw_ts_Successful;
+}
+
+void HW_TS_Stop(uint8_t TimerID)
+{
+  (void)TimerID;
+  TimerRunning = 0;
+}
+
+void HW_TS_Start(uint8_t TimerID, uint32_t timeout_ticks)
+{
+  (void)TimerID;
+  TimerDeadline = Now + TICKS_TO_MS(timeout_ticks);
+  TimerRunning = 1;
+}
+
+tBleStatus MOTENV_STM_App_Update_Char(MOTENV_STM_Char_t Char, uint8_t payloadLen, uint8_t *pPayload)
+{
+  BATCH_NOTIFY_Sample_t samples[64];
+  int32_t n;
+  int32_t i;
+  uint8_t f;
+
+  (void)Char;
+
+  n = BATCH_NOTIFY_Decode(pPayload, payloadLen, NB_FIELDS, samples, 64);
+  CHECK(n > 0);
+  for(i = 0; i < n; i++)
+  {
+    CHECK(NbDecoded < NbRef);
+    CHECK(samples[i].TimeStamp == RefTimeStamp[NbDecoded]);
+    for(f = 0; f < NB_FIELDS; f++)
+    {
+      CHECK(samples[i].Values[f] == RefValues[NbDecoded][f]);
+    }
+    NbDecoded++;
+  }
+
+  if(payloadLen > LongestPacket)
+  {
+    LongestPacket = payloadLen;
+  }
+  NbPackets++;
+  LastFlushTime = Now;
+
+  return BLE_STATUS_SUCCESS;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static void Timer_Callback(void)
+{
+  TimerExpired = 1;
+}
+
+/* Advance the time by 1 ms, run the latency "task" when the timer expired */
+static void Tick(BATCH_NOTIFY_t *pBatch)
+{
+  Now++;
+  if((TimerRunning != 0U) && ((int32_t)(Now - TimerDeadline) >= 0))
+  {
+    TimerRunning = 0;
+    TimerCb();
+  }
+  if(TimerExpired != 0U)
+  {
+    TimerExpired = 0;
+    BATCH_NOTIFY_Check_Latency(pBatch, HAL_GetTick());
+  }
+}
+
+static void Add(BATCH_NOTIFY_t *pBatch, const int16_t *pValues)
+{
+  memcpy(RefValues[NbRef], pValues, sizeof(RefValues[0]));
+  RefTimeStamp[NbRef] = (uint16_t)Now;
+  NbRef++;
+  BATCH_NOTIFY_Add(pBatch, Now, pValues);
+}
+
+/* Random walk at 100Hz with pauses longer than the 255ms time delta and jumps */
+static void Test_Round_Trip(uint16_t Mtu)
+{
+  BATCH_NOTIFY_t batch;
+  int16_t values[NB_FIELDS] = {0};
+  uint32_t n;
+  uint32_t t;
+  uint8_t f;
+
+  NbRef = NbDecoded = NbPackets = LongestPacket = 0;
+  Now = 1000;
+  srand(Mtu);
+
+  BATCH_NOTIFY_Init(&batch, MOTENV_STM_MOTION_BATCH_CHAR, NB_FIELDS, MAX_LATENCY, Timer_Callback);
+  BATCH_NOTIFY_Set_Att_Mtu(&batch, Mtu);
+
+  for(n = 0; n < NB_SAMPLES; n++)
+  {
+    for(t = 0; t < (((n % 997U) == 0U) ? 400U : 10U); t++)
+    {
+      Tick(&batch);
+    }
+    for(f = 0; f < NB_FIELDS; f++)
+    {
+      values[f] = (int16_t)(values[f] + (rand() % 9) - 4);
+      if((n % 1000U) == 0U)
+      {
+        values[f] = (int16_t)rand();
+      }
+    }
+    Add(&batch, values);
+  }
+  BATCH_NOTIFY_Flush(&batch);
+
+  CHECK(NbDecoded == NbRef);
+  CHECK(LongestPacket <= (Mtu - 3U));
+  printf("MTU %3u: %lu samples in %lu packets, %.1f samples/packet, longest %u bytes\n",
+         Mtu, (unsigned long)NbRef, (unsigned long)NbPackets, (double)NbRef / (double)NbPackets, LongestPacket);
+}
+
+/* A single sample must be notified after MAX_LATENCY even when no other comes */
+static void Test_Latency_Timer(void)
+{
+  BATCH_NOTIFY_t batch;
+  int16_t values[NB_FIELDS] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+  uint32_t start;
+  uint32_t t;
+
+  NbRef = NbDecoded = NbPackets = 0;
+  Now = 5000;
+
+  BATCH_NOTIFY_Init(&batch, MOTENV_STM_MOTION_BATCH_CHAR, NB_FIELDS, MAX_LATENCY, Timer_Callback);
+  BATCH_NOTIFY_Set_Att_Mtu(&batch, 156);
+
+  start = Now;
+  Add(&batch, values);
+  for(t = 0; t < (3U * MAX_LATENCY); t++)
+  {
+    Tick(&batch);
+  }
+
+  CHECK(NbPackets == 1U);
+  CHECK(NbDecoded == 1U);
+  CHECK((LastFlushTime - start) >= MAX_LATENCY);
+  CHECK((LastFlushTime - start) <= (MAX_LATENCY + 2U));
+  printf("Latency: lone sample flushed after %lu ms (budget %u ms)\n", (unsigned long)(LastFlushTime - start), MAX_LATENCY);
+
+  /* A reset batch must not be notified */
+  Add(&batch, values);
+  BATCH_NOTIFY_Reset(&batch);
+  for(t = 0; t < (3U * MAX_LATENCY); t++)
+  {
+    Tick(&batch);
+  }
+  CHECK(NbPackets == 1U);
+}
+
+int main(void)
+{
+  Test_Round_Trip(23);
+  Test_Round_Trip(156);
+  Test_Latency_Timer();
+
+  printf("%s\n", (Failures == 0U) ? "PASS" : "FAIL");
+  return (Failures == 0U) ? 0 : 1;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,413 @@
+/**
+ ******************************************************************************
+ * File Name          : conn_param_test.c
+ * Description        : Host test of the connection interval requested for
+ *                      the notifications enabled: for each feature mix the
+ *                      slowest interval carrying the notifications is used,
+ *                      slowing down waits for the hold delay, and a central
+ *                      rejecting or ignoring the requests is asked a limited
+ *                      number of times, one request at a time, as the iOS
+ *                      centrals accept them.
+ *                      Run by Tools/run_host_tests.sh
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "app_common.h"
+#include "ble.h"
+#include "stm32_seq.h"
+
+#include "conn_param_app.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define PERIOD(s)                       (uint32_t)((s)*1000*1000/CFG_TS_TICK_VAL)
+#define CONNECTION_HANDLE               (1U)
+#define DEFAULT_INTERVAL                (24U)           /* 30ms, 1.25ms unit */
+#define RESPONSE_MS                     (40U)
+#define UPDATE_MS                       (300U)
+#define MAX_REQUESTS                    (16)
+
+/* Notifications per 1000s carried by an interval, 1.25ms unit */
+#define CAPACITY(interval)              ((uint32_t)CFG_CONN_PARAM_NOTIFY_PER_EVENT*800000UL/(interval))
+
+#define CHECK(cond)                     do { if(!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); Failures++; } } while(0)
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum
+{
+  CENTRAL_ACCEPT,
+  CENTRAL_REJECT,
+  CENTRAL_REJECT_TWICE,
+  CENTRAL_IGNORE,                       /* Accepts, keeps its interval */
+} Central_Mode_t;
+
+typedef enum
+{
+  FEATURE_ENV,
+  FEATURE_MOTION,
+  FEATURE_MOTION_BATCH,
+  FEATURE_QUAT,
+  FEATURE_ECOMPASS,
+  FEATURE_ACTIVITY_REC,
+  FEATURE_GESTURE_REC,
+  FEATURE_PEDOMETER,
+  FEATURE_NUMBER
+} Feature_t;
+
+typedef struct
+{
+  MOTENV_STM_Char_t Char;
+  double Period;                        /* [s], as in motenv_server_app.c */
+} Feature_Char_t;
+
+typedef struct
+{
+  const char *Name;
+  uint32_t Features;                    /* Bit n for Feature_t n */
+  uint16_t Interval;                    /* Expected [1.25ms] */
+} Mix_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t Failures;
+static uint32_t Now;                    /* [ms] */
+static uint8_t TaskSet;
+
+/* Timer Server */
+static HW_TS_pTimerCb_t TimerCallback;
+static uint8_t TimerRunning;
+static uint32_t TimerDue;               /* [ms] */
+
+/* Central */
+static Central_Mode_t Mode;
+static uint16_t Interval;
+static uint32_t Requests;
+static uint32_t RequestTime[MAX_REQUESTS]; /* [ms] */
+static uint32_t Rejects;
+static uint8_t InFlight;
+static uint32_t ResponseAt;
+static uint16_t ResponseResult;
+static uint8_t UpdatePending;
+static uint32_t UpdateAt;
+static uint16_t UpdateInterval;
+static uint32_t LastRequest;            /* [ms] */
+static int32_t LastMin;
+
+static const Feature_Char_t Feature[FEATURE_NUMBER] =
+{
+  { MOTENV_STM_ENV_CHAR,          5.0  },
+  { MOTENV_STM_MOTION_CHAR,       0.05 },
+  { MOTENV_STM_MOTION_BATCH_CHAR, 0.05 },
+  { MOTENV_STM_MOTION_FX_CHAR,    0.03 },
+  { MOTENV_STM_ECOMPASS_CHAR,     0.1  },
+  { MOTENV_STM_ACTIVITY_REC_CHAR, 0.2  },
+  { MOTENV_STM_GESTURE_REC_CHAR,  0.2  },
+  { MOTENV_STM_PEDOMETER_CHAR,    0.2  },
+};
+
+#define BIT(f)                          (1UL << (f))
+
+static const Mix_t Mix[] =
+{
+  { "none",              0,                                                                    CONN_P(975) },
+  { "Env",               BIT(FEATURE_ENV),                                                     CONN_P(975) },
+  { "Pedometer",         BIT(FEATURE_PEDOMETER),                                               CONN_P(255) },
+  { "Env+Rec+Pedometer", BIT(FEATURE_ENV) | BIT(FEATURE_ACTIVITY_REC) | BIT(FEATURE_GESTURE_REC) |
+                         BIT(FEATURE_PEDOMETER),                                               CONN_P(135) },
+  { "ECompass",          BIT(FEATURE_ECOMPASS),                                                CONN_P(135) },
+  { "Motion",            BIT(FEATURE_MOTION),                                                  CONN_P(75)  },
+  { "Quat",              BIT(FEATURE_QUAT),                                                    DEFAULT_INTERVAL },
+  { "Env+Motion+Quat",   BIT(FEATURE_ENV) | BIT(FEATURE_MOTION) | BIT(FEATURE_QUAT),           DEFAULT_INTERVAL },
+  { "MotionBatch",       BIT(FEATURE_MOTION_BATCH),                                            CONN_P(75)  },
+  { "all",               BIT(FEATURE_NUMBER) - 1U,                                             CONN_P(15)  },
+};
+
+/* Private functions ---------------------------------------------------------*/
+static void Enable(Feature_t Feature_Id, uint8_t On)
+{
+  CONN_PARAM_Set_Char(Feature[Feature_Id].Char, (On != 0U) ? PERIOD(Feature[Feature_Id].Period) : 0U);
+}
+
+/**
+ * One ms: timer, answers of the central, then the task
+ */
+static void Step(void)
+{
+  if((TimerRunning != 0U) && ((int32_t)(Now - TimerDue) >= 0))
+  {
+    TimerRunning = 0;
+    TimerCallback();
+  }
+  if((InFlight != 0U) && (Now >= ResponseAt))
+  {
+    InFlight = 0;
+    CONN_PARAM_Update_Resp(CONNECTION_HANDLE, ResponseResult);
+  }
+  if((UpdatePending != 0U) && (Now >= UpdateAt))
+  {
+    UpdatePending = 0;
+    Interval = UpdateInterval;
+    CONN_PARAM_Updated(CONNECTION_HANDLE, Interval);
+  }
+  while(TaskSet != 0U)
+  {
+    TaskSet = 0;
+    CONN_PARAM_Task();
+  }
+  Now++;
+}
+
+static void Run(uint32_t Ms)
+{
+  uint32_t end = Now + Ms;
+
+  while(Now < end)
+  {
+    Step();
+  }
+}
+
+static void Connect(Central_Mode_t Central, uint16_t Default)
+{
+  Now += 1000;
+  Mode = Central;
+  Interval = Default;
+  Requests = 0;
+  Rejects = 0;
+  InFlight = 0;
+  UpdatePending = 0;
+  LastMin = -1;
+  CONN_PARAM_Connected(CONNECTION_HANDLE, Interval);
+  Run(200);
+}
+
+static void Disconnect(void)
+{
+  CONN_PARAM_Disconnected();
+  CHECK(TimerRunning == 0U);
+  InFlight = 0;
+  UpdatePending = 0;
+}
+
+/**
+ * Each feature mix ends on the slowest interval of the ladder carrying it
+ */
+static void Test_Feature_Mix(void)
+{
+  uint32_t m;
+  uint32_t f;
+
+  for(m = 0; m < (sizeof(Mix) / sizeof(Mix[0])); m++)
+  {
+    Connect(CENTRAL_ACCEPT, DEFAULT_INTERVAL);
+    for(f = 0; f < FEATURE_NUMBER; f++)
+    {
+      if((Mix[m].Features & BIT(f)) != 0U)
+      {
+        Enable((Feature_t)f, 1);
+      }
+    }
+    Run(20000);
+    printf("  %-18s %6.1f notifications/s: %7.2f ms, %u requests\n", Mix[m].Name,
+           CONN_PARAM_Get_Required_Rate() / 1000.0, Interval * 1.25, (unsigned int)Requests);
+    CHECK(Interval == Mix[m].Interval);
+    CHECK(Requests <= 1U);
+    CHECK((CAPACITY(Interval) >= CONN_PARAM_Get_Required_Rate()) || (Interval == CONN_P(15)));
+    Disconnect();
+  }
+}
+
+/**
+ * Faster at once, slower only once the rate stayed low CFG_CONN_PARAM_HOLD_MS
+ */
+static void Test_Hold(void)
+{
+  uint32_t requests;
+
+  Connect(CENTRAL_ACCEPT, DEFAULT_INTERVAL);
+  Enable(FEATURE_ENV, 1);
+  Run(CFG_CONN_PARAM_HOLD_MS + 3000);
+  CHECK(Interval == CONN_P(975));
+
+  Enable(FEATURE_QUAT, 1);
+  Enable(FEATURE_ECOMPASS, 1);
+  Enable(FEATURE_MOTION, 1);
+  Run(1000);
+  CHECK(Interval == CONN_P(15));
+  requests = Requests;
+
+  /* Disabled shorter than the hold: no request */
+  Enable(FEATURE_MOTION, 0);
+  Run(CFG_CONN_PARAM_HOLD_MS - 2000);
+  Enable(FEATURE_MOTION, 1);
+  Run(CFG_CONN_PARAM_HOLD_MS + 1000);
+  CHECK(Requests == requests);
+  CHECK(Interval == CONN_P(15));
+
+  /* Disabled longer than the hold */
+  Enable(FEATURE_MOTION, 0);
+  Enable(FEATURE_QUAT, 0);
+  Enable(FEATURE_ECOMPASS, 0);
+  Run(CFG_CONN_PARAM_HOLD_MS - 1000);
+  CHECK(Requests == requests);
+  Run(2000);
+  CHECK(Requests == requests + 1U);
+  Run(1000);
+  CHECK(Interval == CONN_P(975));
+  Disconnect();
+}
+
+/**
+ * A central refusing or ignoring the interval is asked CFG_CONN_PARAM_MAX_RETRY
+ * times, each delay doubled
+ */
+static void Test_Retry(Central_Mode_t Central)
+{
+  uint32_t i;
+
+  Connect(Central, DEFAULT_INTERVAL);
+  Enable(FEATURE_ENV, 1);
+  Run(120000);
+  CHECK(Requests == CFG_CONN_PARAM_MAX_RETRY);
+  CHECK(Interval == DEFAULT_INTERVAL);
+  for(i = 1; (i < Requests) && (i < MAX_REQUESTS); i++)
+  {
+    CHECK((RequestTime[i] - RequestTime[i - 1U]) >= ((uint32_t)CFG_CONN_PARAM_RETRY_MS << (i - 1U)));
+  }
+
+  /* 30ms carries these: nothing to ask */
+  Enable(FEATURE_QUAT, 1);
+  Enable(FEATURE_ECOMPASS, 1);
+  Enable(FEATURE_MOTION, 1);
+  Run(10000);
+  CHECK(Requests == CFG_CONN_PARAM_MAX_RETRY);
+  Disconnect();
+}
+
+/**
+ * Too slow an interval rejected twice is asked again until accepted
+ */
+static void Test_Reject_Twice(void)
+{
+  Connect(CENTRAL_REJECT_TWICE, CONN_P(48.75));
+  Enable(FEATURE_QUAT, 1);
+  Enable(FEATURE_ECOMPASS, 1);
+  Enable(FEATURE_MOTION, 1);
+  Run(20000);
+  CHECK(Requests == 3U);
+  CHECK(Interval == CONN_P(15));
+  Disconnect();
+}
+
+/**
+ * Nothing is requested once disconnected, even with a delay running
+ */
+static void Test_Disconnect(void)
+{
+  Connect(CENTRAL_REJECT, DEFAULT_INTERVAL);
+  Enable(FEATURE_ENV, 1);
+  Run(CFG_CONN_PARAM_HOLD_MS + 500);
+  CHECK(Requests == 1U);
+  Disconnect();
+  Run(60000);
+  CHECK(Requests == 1U);
+  CHECK(CONN_PARAM_Get_Required_Rate() == 0U);
+}
+
+/* Stubs ---------------------------------------------------------------------*/
+uint32_t HAL_GetTick(void)
+{
+  return Now;
+}
+
+void UTIL_SEQ_SetTask(UTIL_SEQ_bm_t TaskId_bm, uint32_t Task_Prio)
+{
+  (void)Task_Prio;
+  CHECK(TaskId_bm == (1U << CFG_TASK_CONN_PARAM_ID));
+  TaskSet = 1;
+}
+
+HW_TS_ReturnStatus_t HW_TS_Create(uint32_t TimerProcessID, uint8_t *pTimerId, HW_TS_Mode_t TimerMode, HW_TS_pTimerCb_t pTimerCallBack)
+{
+  (void)TimerProcessID;
+  CHECK(TimerMode == hw_ts_SingleShot);
+  *pTimerId = 0;
+  TimerCallback = pTimerCallBack;
+  return hw_ts_Successful;
+}
+
+void HW_TS_Start(uint8_t TimerID, uint32_t timeout_ticks)
+{
+  (void)TimerID;
+  TimerRunning = 1;
+  TimerDue = Now + (uint32_t)((uint64_t)timeout_ticks * CFG_TS_TICK_VAL / 1000U);
+}
+
+void HW_TS_Stop(uint8_t TimerID)
+{
+  (void)TimerID;
+  TimerRunning = 0;
+}
+
+tBleStatus aci_l2cap_connection_parameter_update_req(uint16_t Connection_Handle, uint16_t Conn_Interval_Min,
+                                                     uint16_t Conn_Interval_Max, uint16_t Slave_latency,
+                                                     uint16_t Timeout_Multiplier)
+{
+  (void)Slave_latency;
+  (void)Timeout_Multiplier;
+  CHECK(Connection_Handle == CONNECTION_HANDLE);
+
+  /* One procedure at a time, an iOS range, not repeated before the retry delay */
+  CHECK(InFlight == 0U);
+  CHECK(((Conn_Interval_Min == CONN_P(15)) && (Conn_Interval_Max == CONN_P(15))) ||
+        ((Conn_Interval_Min >= CONN_P(15)) && (Conn_Interval_Max >= Conn_Interval_Min + CONN_P(15))));
+  CHECK((Conn_Interval_Min != LastMin) || ((Now - LastRequest) >= CFG_CONN_PARAM_RETRY_MS));
+  LastRequest = Now;
+  LastMin = Conn_Interval_Min;
+  if(Requests < MAX_REQUESTS)
+  {
+    RequestTime[Requests] = Now;
+  }
+  Requests++;
+
+  InFlight = 1;
+  ResponseAt = Now + RESPONSE_MS;
+  ResponseResult = ((Mode == CENTRAL_REJECT) || ((Mode == CENTRAL_REJECT_TWICE) && (Rejects < 2U))) ? 1U : 0U;
+  if(ResponseResult != 0U)
+  {
+    Rejects++;
+  }
+  else if(Mode != CENTRAL_IGNORE)
+  {
+    UpdatePending = 1;
+    UpdateAt = Now + UPDATE_MS;
+    UpdateInterval = Conn_Interval_Max;
+  }
+  return BLE_STATUS_SUCCESS;
+}
+
+int main(void)
+{
+  CONN_PARAM_Init();
+
+  Test_Feature_Mix();
+  Test_Hold();
+  Test_Retry(CENTRAL_REJECT);
+  Test_Retry(CENTRAL_IGNORE);
+  Test_Reject_Twice();
+  Test_Disconnect();
+
+  printf("%s\n", (Failures == 0U) ? "PASS" : "FAIL");
+  return (Failures == 0U) ? 0 : 1;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,372 @@
+/**
+ ******************************************************************************
+ * File Name          : console_server_test.c
+ * Description        : Host test of the Console transmit queues against a
+ *                      GATT layer with buffer credits drained at each
+ *                      connection event: every byte written reaches the
+ *                      client once and in order, the caller and the
+ *                      sequencer are never held for more than a packet.
+ *                      Run by Tools/run_host_tests.sh
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "app_common.h"
+#include "ble.h"
+
+/* Built with the module to check its drop counters */
+#include "../console_server_app.c"
+
+/* Private defines -----------------------------------------------------------*/
+#define ACI_US                          (60U)         /* Cost of one aci_gatt_update_char_value */
+#define STEP_US                         (250U)
+#define LINK_QUEUE                      (64)
+#define RX_SIZE                         (1U << 16)
+
+#define TERM                            (0)
+#define STDERR                          (1)
+
+#define CHECK(cond)                     do { if(!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); Failures++; } } while(0)
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  MOTENV_STM_Char_t Char;
+  uint8_t Length;
+  uint8_t Data[CFG_BLE_MAX_ATT_MTU];
+} Packet_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t Failures;
+static uint64_t Now;                    /* [us] */
+static uint64_t Busy;                   /* Time spent in the GATT calls [us] */
+static uint64_t LongestRun;             /* Longest caller or task run [us] */
+
+/* Link: credits are the stack buffers, PerEvent packets leave each connection event */
+static uint32_t Credits;
+static uint32_t PerEvent;
+static uint32_t ConnInterval;           /* [us] */
+static uint64_t NextEvent;
+static uint8_t Starved;
+static uint32_t Refused;
+static Packet_t Link[LINK_QUEUE];
+static uint32_t LinkLen;
+
+/* Bytes written and received, per char */
+static uint8_t Sent[2][RX_SIZE];
+static uint32_t SentLen[2];
+static uint8_t Received[2][RX_SIZE];
+static uint32_t ReceivedLen[2];
+static uint64_t LastReceived;
+
+static uint8_t TaskSet;
+
+/* Private functions ---------------------------------------------------------*/
+static void Link_Step(void)
+{
+  uint32_t n;
+  uint32_t i;
+  uint32_t c;
+
+  if(Now < NextEvent)
+  {
+    return;
+  }
+  NextEvent += ConnInterval;
+
+  n = (LinkLen < PerEvent) ? LinkLen : PerEvent;
+  for(i = 0; i < n; i++)
+  {
+    c = (Link[i].Char == MOTENV_STM_CONSOLE_STDERR_CHAR) ? STDERR : TERM;
+    memcpy(&Received[c][ReceivedLen[c]], Link[i].Data, Link[i].Length);
+    ReceivedLen[c] += Link[i].Length;
+    LastReceived = Now;
+  }
+  memmove(&Link[0], &Link[n], sizeof(Link[0]) * (LinkLen - n));
+  LinkLen -= n;
+  Credits += n;
+
+  /* ACI_GATT_TX_POOL_AVAILABLE_VSEVT_CODE */
+  if((Starved != 0U) && (Credits >= 2U))
+  {
+    Starved = 0;
+    CONSOLE_Tx_Pool_Available();
+  }
+}
+
+/* The Console task runs whenever it is set, the link runs in between */
+static void Idle(uint64_t Us)
+{
+  uint64_t end = Now + Us;
+  uint64_t busy;
+
+  while(Now < end)
+  {
+    if(TaskSet != 0U)
+    {
+      TaskSet = 0;
+      busy = Busy;
+      CONSOLE_Tx_Task();
+      busy = Busy - busy;
+      LongestRun = (busy > LongestRun) ? busy : LongestRun;
+      Now += busy;
+    }
+    Now += STEP_US;
+    Link_Step();
+  }
+}
+
+static void Write(uint32_t Char, const uint8_t *pData, uint8_t Length)
+{
+  uint64_t busy = Busy;
+
+  memcpy(&Sent[Char][SentLen[Char]], pData, Length);
+  SentLen[Char] += Length;
+  if(Char == STDERR)
+  {
+    CONSOLE_Stderr_Update((uint8_t *)pData, Length);
+  }
+  else
+  {
+    CONSOLE_Term_Update((uint8_t *)pData, Length);
+  }
+  busy = Busy - busy;
+  LongestRun = (busy > LongestRun) ? busy : LongestRun;
+  Now += busy;
+}
+
+static void Start(uint16_t Mtu, uint32_t Cred, uint32_t Ci)
+{
+  Credits = Cred;
+  PerEvent = 4;
+  ConnInterval = Ci;
+  Now = 0;
+  NextEvent = Ci;
+  LinkLen = 0;
+  Starved = 0;
+  Refused = 0;
+  Busy = 0;
+  LongestRun = 0;
+  TaskSet = 0;
+  memset(SentLen, 0, sizeof(SentLen));
+  memset(ReceivedLen, 0, sizeof(ReceivedLen));
+
+  CONSOLE_Context_Init();
+  CONSOLE_Set_Term_Notification_Status(1);
+  CONSOLE_Set_Stderr_Notification_Status(1);
+  CONSOLE_Set_Att_Mtu(Mtu);
+}
+
+static uint8_t Intact(void)
+{
+  return (ReceivedLen[TERM] == SentLen[TERM]) && (ReceivedLen[STDERR] == SentLen[STDERR]) &&
+         (memcmp(Received[TERM], Sent[TERM], SentLen[TERM]) == 0) &&
+         (memcmp(Received[STDERR], Sent[STDERR], SentLen[STDERR]) == 0);
+}
+
+/* 20 s: a 300 byte report every 500 ms in 30 byte lines, a 40 byte Stderr line every 2 s */
+static void Test_Workload(uint16_t Mtu, uint32_t Cred, uint32_t Ci)
+{
+  uint8_t line[40];
+  uint32_t seed = 1;
+  uint64_t t0;
+  uint32_t t;
+  uint32_t l;
+  uint32_t i;
+
+  Start(Mtu, Cred, Ci);
+  for(t = 0; t < 40U; t++)
+  {
+    t0 = Now;
+    for(l = 0; l < 10U; l++)
+    {
+      for(i = 0; i < 30U; i++)
+      {
+        seed = (seed * 1103515245U) + 12345U;
+        line[i] = (uint8_t)(seed >> 16);
+      }
+      Write(TERM, line, 30);
+    }
+    if((t % 4U) == 0U)
+    {
+      for(i = 0; i < 40U; i++)
+      {
+        seed = (seed * 1103515245U) + 12345U;
+        line[i] = (uint8_t)(seed >> 16);
+      }
+      Write(STDERR, line, 40);
+    }
+    Idle(500000U - (Now - t0));
+  }
+  Idle(2000000U);
+
+  printf("MTU %3u credits %lu CI %4.1f ms: %5lu B, sequencer held %5.1f ms total, %4.2f ms longest, refused %lu\n",
+         Mtu, (unsigned long)Cred, Ci / 1000.0, (unsigned long)(ReceivedLen[TERM] + ReceivedLen[STDERR]),
+         Busy / 1000.0, LongestRun / 1000.0, (unsigned long)Refused);
+
+  /* With 20 ms of HAL_Delay per 20 bytes, the sequencer was held 16 s */
+  CHECK(Intact());
+  CHECK(LongestRun <= (2U * ACI_US));
+  CHECK(Busy < 100000U);
+  CHECK((CONSOLE_Server_App_Context.Term.Dropped == 0U) && (CONSOLE_Server_App_Context.Stderr.Dropped == 0U));
+}
+
+/* 500 bytes at once, time until the last byte reached the client */
+static void Test_Burst(uint16_t Mtu, uint32_t Ci, double MinRate)
+{
+  uint8_t data[100];
+  double rate;
+  uint32_t i;
+
+  Start(Mtu, 8, Ci);
+  for(i = 0; i < sizeof(data); i++)
+  {
+    data[i] = (uint8_t)i;
+  }
+  for(i = 0; i < 5U; i++)
+  {
+    Write(TERM, data, sizeof(data));
+  }
+  CHECK(Busy == 0U);
+  Idle(3000000U);
+
+  rate = (ReceivedLen[TERM] * 1e6) / LastReceived;
+  printf("burst 500 B MTU %3u CI %4.1f ms: %5.0f B/s\n", Mtu, Ci / 1000.0, rate);
+  CHECK(Intact());
+  CHECK(rate >= MinRate);
+}
+
+/* One write longer than 235 bytes is sent once */
+static void Test_Long_Write(void)
+{
+  uint8_t data[250];
+  uint32_t i;
+
+  Start(23, 64, 7500);
+  for(i = 0; i < sizeof(data); i++)
+  {
+    data[i] = (uint8_t)(i * 7U);
+  }
+  Write(TERM, data, sizeof(data));
+  Idle(1000000U);
+  CHECK(Intact());
+}
+
+/* A full queue keeps the oldest bytes and counts the others */
+static void Test_Queue_Full(void)
+{
+  uint8_t data[200];
+  uint32_t i;
+
+  Start(156, 8, 7500);
+  for(i = 0; i < sizeof(data); i++)
+  {
+    data[i] = (uint8_t)i;
+  }
+  for(i = 0; i < 3U; i++)
+  {
+    Write(TERM, data, sizeof(data));
+  }
+  Idle(1000000U);
+
+  CHECK(CONSOLE_Server_App_Context.Term.Dropped == ((3U * sizeof(data)) - CONSOLE_TX_BUFFER_SIZE));
+  CHECK(ReceivedLen[TERM] == CONSOLE_TX_BUFFER_SIZE);
+  CHECK(memcmp(Received[TERM], Sent[TERM], CONSOLE_TX_BUFFER_SIZE) == 0);
+}
+
+/* Disabling the notifications drops what is queued */
+static void Test_Disable(void)
+{
+  uint8_t data[100];
+
+  memset(data, 0x5A, sizeof(data));
+  Start(23, 0, 7500);
+  Write(TERM, data, sizeof(data));
+  Idle(10000U);
+  CHECK(ReceivedLen[TERM] == 0U);
+
+  CONSOLE_Set_Term_Notification_Status(0);
+  CONSOLE_Set_Term_Notification_Status(1);
+  Credits = 8;
+  Idle(1000000U);
+  CHECK(ReceivedLen[TERM] == 0U);
+
+  /* The pool wait is cleared: the next write goes out */
+  SentLen[TERM] = 0;
+  Write(TERM, data, 10);
+  Idle(100000U);
+  CHECK(Intact());
+}
+
+/* Stubs ---------------------------------------------------------------------*/
+void UTIL_SEQ_SetTask(UTIL_SEQ_bm_t TaskId_bm, uint32_t Task_Prio)
+{
+  (void)Task_Prio;
+  CHECK(TaskId_bm == (1U << CFG_TASK_CONSOLE_TX_ID));
+  TaskSet = 1;
+}
+
+tBleStatus MOTENV_STM_App_Update_Char(MOTENV_STM_Char_t Char, uint8_t payloadLen, uint8_t *pPayload)
+{
+  Busy += ACI_US;
+  CHECK((Char == MOTENV_STM_CONSOLE_TERM_CHAR) || (Char == MOTENV_STM_CONSOLE_STDERR_CHAR));
+  CHECK(payloadLen <= CONSOLE_Server_App_Context.MaxPayload);
+  if((Credits == 0U) || (LinkLen == LINK_QUEUE))
+  {
+    Starved = 1;
+    Refused++;
+    return BLE_STATUS_INSUFFICIENT_RESOURCES;
+  }
+  Credits--;
+  Link[LinkLen].Char = Char;
+  Link[LinkLen].Length = payloadLen;
+  memcpy(Link[LinkLen].Data, pPayload, payloadLen);
+  LinkLen++;
+  return BLE_STATUS_SUCCESS;
+}
+
+int main(void)
+{
+  static const uint32_t ci[2] = { 7500, 30000 };
+  static const uint32_t credits[2] = { 2, 8 };
+  static const uint16_t mtu[2] = { 23, 156 };
+  uint32_t c;
+  uint32_t k;
+  uint32_t m;
+
+  for(c = 0; c < 2U; c++)
+  {
+    for(k = 0; k < 2U; k++)
+    {
+      for(m = 0; m < 2U; m++)
+      {
+        Test_Workload(mtu[m], credits[k], ci[c]);
+      }
+    }
+  }
+
+  /* The 20 ms pacing gave about 1 kB/s */
+  Test_Burst(23, 7500, 8000.0);
+  Test_Burst(156, 7500, 50000.0);
+  Test_Burst(23, 30000, 2000.0);
+  Test_Burst(156, 30000, 12000.0);
+
+  Test_Long_Write();
+  Test_Queue_Full();
+  Test_Disable();
+
+  printf("%s\n", (Failures == 0U) ? "PASS" : "FAIL");
+  return (Failures == 0U) ? 0 : 1;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,536 @@
+/**
+ ******************************************************************************
+ * File Name          : env_server_test.c
+ * Description        : Host test of the batched environmental acquisition:
+ *                      env_server_app.c, the IKS01A3 BSP and the HTS221 and
+ *                      LPS22HH drivers run over register models of both
+ *                      sensors for an hour of notifications.
+ *                      Run by Tools/run_host_tests.sh
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include "app_common.h"
+#include "ble.h"
+
+#include "env_server_app.h"
+#include "notify_app.h"
+#include "iks01a3_env_sensors.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define HOUR_MS                         (3600000U)
+#define EVENT_MS                        (1800000U)    /* Breath on the board, 60 s */
+#define BATCH_PERIOD_MS                 ((CFG_ENV_BATCH_WATERMARK * 1000U) / CFG_ENV_BATCH_ODR)
+#define LPS_DRIFT                       (1.015)       /* Internal oscillator 1.5% slow */
+
+#define HTS221_ADDRESS                  (0xBEU)
+#define LPS22HH_ADDRESS                 (0xBAU)
+#define LPS22HH_FIFO_DEPTH              (128)
+
+#define CHECK(cond)                     do { if(!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); Failures++; } } while(0)
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum
+{
+  SCENARIO_STEADY,              /* Slow daily drifts */
+  SCENARIO_EVENT,               /* +2 degC, +5 %rH for 60 s at the half hour */
+  SCENARIO_HEATING,             /* Heating cycles, 0.4 degC/min */
+} Scenario_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t Now;                    /* [ms] */
+static uint32_t T0;                     /* Time origin of the scenario */
+static uint32_t Failures;
+static Scenario_t Scenario;
+static double TrueP, TrueT, TrueH;
+static uint64_t Rng;
+
+/* Bus */
+static uint32_t Xfers;
+static uint32_t XBytes;
+
+/* HTS221 register model */
+static uint8_t Hts[0x40];
+static uint32_t HtsNext;
+static uint32_t HtsOneShotDone;
+static uint8_t HtsOneShot;
+
+/* LPS22HH register model */
+static uint8_t Lps[0x80];
+static uint8_t Fifo[LPS22HH_FIFO_DEPTH][5];
+static int32_t FifoHead;
+static int32_t FifoLen;
+static uint32_t FifoOverruns;
+static double LpsNext;
+
+/* BLE client */
+static uint32_t Notifications;
+static int32_t LastP;
+static uint16_t LastH;
+static int16_t LastT;
+static double ErrP2;
+static uint32_t ErrN;
+static uint32_t EventLatency;
+
+uint8_t manuf_data[14];
+
+/* Private functions ---------------------------------------------------------*/
+static double URand(void)
+{
+  Rng ^= Rng << 13;
+  Rng ^= Rng >> 7;
+  Rng ^= Rng << 17;
+  return ((double)(Rng >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static double Gauss(void)
+{
+  return sqrt(-2.0 * log(URand())) * cos(2.0 * M_PI * URand());
+}
+
+static void Physics(double s)
+{
+  double ph;
+
+  TrueP = 1013.25 + (0.8 * sin((2.0 * M_PI * s) / 21600.0));
+  TrueT = 22.0 + (0.3 * sin((2.0 * M_PI * s) / 3600.0));
+  TrueH = 45.0 + (1.5 * sin((2.0 * M_PI * s) / 2400.0));
+  if((Scenario == SCENARIO_EVENT) && (s >= (EVENT_MS / 1000.0)) && (s < ((EVENT_MS / 1000.0) + 60.0)))
+  {
+    TrueT += 2.0;
+    TrueH += 5.0;
+  }
+  if(Scenario == SCENARIO_HEATING)
+  {
+    ph = fmod(s, 600.0) / 600.0;
+    TrueT += 2.0 * ((ph < 0.5) ? ph : (1.0 - ph));
+  }
+}
+
+/* HTS221: 30 %rH at 0, 70 %rH at 8000, 20 degC at 0, 30 degC at 1000 */
+static void Hts_Reset(void)
+{
+  memset(Hts, 0, sizeof(Hts));
+  Hts[0x0F] = 0xBC;
+  Hts[0x10] = 0x1B;
+  Hts[0x30] = 60;
+  Hts[0x31] = 140;
+  Hts[0x32] = 160;
+  Hts[0x33] = 240;
+  Hts[0x3A] = 0x40;
+  Hts[0x3B] = 0x1F;
+  Hts[0x3E] = 0xE8;
+  Hts[0x3F] = 0x03;
+  HtsOneShot = 0;
+  HtsNext = 0;
+}
+
+static void Hts_Convert(void)
+{
+  int16_t rh = (int16_t)lround((((TrueH + (0.05 * Gauss())) - 30.0) / 40.0) * 8000.0);
+  int16_t rt = (int16_t)lround((((TrueT + (0.02 * Gauss())) - 20.0) / 10.0) * 1000.0);
+
+  Hts[0x28] = (uint8_t)rh;
+  Hts[0x29] = (uint8_t)((uint16_t)rh >> 8);
+  Hts[0x2A] = (uint8_t)rt;
+  Hts[0x2B] = (uint8_t)((uint16_t)rt >> 8);
+  Hts[0x27] |= 0x03;
+}
+
+static void Hts_Step(void)
+{
+  static const uint32_t period[4] = { 0, 1000, 143, 80 };
+  uint8_t odr = Hts[0x20] & 0x03U;
+
+  if((Hts[0x20] & 0x80U) == 0U)
+  {
+    return;
+  }
+  if(odr != 0U)
+  {
+    if((int32_t)(Now - HtsNext) >= 0)
+    {
+      Hts_Convert();
+      HtsNext = Now + period[odr];
+    }
+  }
+  else if((HtsOneShot != 0U) && (Now == HtsOneShotDone))
+  {
+    Hts_Convert();
+    Hts[0x21] &= (uint8_t)~0x01U;
+    HtsOneShot = 0;
+  }
+}
+
+static void Hts_Read(uint8_t Reg, uint8_t *pData, uint16_t Length)
+{
+  uint8_t inc = Reg & 0x80U;
+  uint8_t r;
+  uint16_t i;
+
+  Reg &= 0x7FU;
+  for(i = 0; i < Length; i++)
+  {
+    r = (uint8_t)((inc != 0U) ? (Reg + i) : Reg) & 0x3FU;
+    pData[i] = Hts[r];
+    if(r == 0x29U)
+    {
+      Hts[0x27] &= (uint8_t)~0x02U;
+    }
+    if(r == 0x2BU)
+    {
+      Hts[0x27] &= (uint8_t)~0x01U;
+    }
+  }
+}
+
+static void Hts_Write(uint8_t Reg, const uint8_t *pData, uint16_t Length)
+{
+  uint8_t inc = Reg & 0x80U;
+  uint8_t r;
+  uint16_t i;
+
+  Reg &= 0x7FU;
+  for(i = 0; i < Length; i++)
+  {
+    r = (uint8_t)((inc != 0U) ? (Reg + i) : Reg) & 0x3FU;
+    if((r < 0x10U) || (r >= 0x27U))
+    {
+      continue;
+    }
+    Hts[r] = pData[i];
+    if((r == 0x21U) && ((pData[i] & 0x01U) != 0U) && ((Hts[0x20] & 0x83U) == 0x80U))
+    {
+      HtsOneShot = 1;
+      HtsOneShotDone = Now + 30U;
+    }
+  }
+}
+
+static void Lps_Reset(void)
+{
+  memset(Lps, 0, sizeof(Lps));
+  Lps[0x0F] = 0xB3;
+  Lps[0x11] = 0x10;
+  FifoHead = 0;
+  FifoLen = 0;
+  FifoOverruns = 0;
+  LpsNext = 0;
+}
+
+/* The LPS22HH temperature reads 0.3 degC above, self-heating */
+static void Lps_Sample(void)
+{
+  int32_t rp = (int32_t)lround((TrueP + (0.0075 * Gauss())) * 4096.0);
+  int16_t rt = (int16_t)lround((TrueT + 0.3 + (0.01 * Gauss())) * 100.0);
+  uint8_t s[5] = { (uint8_t)rp, (uint8_t)(rp >> 8), (uint8_t)(rp >> 16), (uint8_t)rt, (uint8_t)((uint16_t)rt >> 8) };
+
+  memcpy(&Lps[0x28], s, sizeof(s));
+  Lps[0x27] |= 0x03;
+  if((Lps[0x13] & 0x03U) == 2U)
+  {
+    /* Stream mode */
+    if(FifoLen == LPS22HH_FIFO_DEPTH)
+    {
+      FifoHead = (FifoHead + 1) % LPS22HH_FIFO_DEPTH;
+      FifoLen--;
+      FifoOverruns++;
+    }
+    memcpy(Fifo[(FifoHead + FifoLen) % LPS22HH_FIFO_DEPTH], s, sizeof(s));
+    FifoLen++;
+  }
+  Lps[0x25] = (uint8_t)((FifoLen == LPS22HH_FIFO_DEPTH) ? 0 : FifoLen);
+  Lps[0x26] = (uint8_t)((((FifoLen >= Lps[0x14]) && (Lps[0x14] != 0U)) ? 0x80U : 0U) | ((FifoLen == LPS22HH_FIFO_DEPTH) ? 0x20U : 0U));
+}
+
+static void Lps_Step(void)
+{
+  static const double hz[8] = { 0, 1, 10, 25, 50, 75, 100, 200 };
+  uint8_t odr = (Lps[0x10] >> 4) & 7U;
+
+  if(odr == 0U)
+  {
+    LpsNext = 0;
+    return;
+  }
+  if(LpsNext == 0)
+  {
+    LpsNext = Now + ((1000.0 * LPS_DRIFT) / hz[odr]);
+  }
+  if(Now >= LpsNext)
+  {
+    Lps_Sample();
+    LpsNext += (1000.0 * LPS_DRIFT) / hz[odr];
+  }
+}
+
+/* FIFO_DATA_OUT rolls back from 0x7C to 0x78 with the address increment */
+static void Lps_Read(uint8_t Reg, uint8_t *pData, uint16_t Length)
+{
+  uint8_t inc = Lps[0x11] & 0x10U;
+  uint8_t r;
+  uint16_t i;
+
+  for(i = 0; i < Length; i++)
+  {
+    r = (uint8_t)((inc != 0U) ? (Reg + i) : Reg);
+    if((Reg >= 0x78U) && (inc != 0U))
+    {
+      r = (uint8_t)(0x78U + ((Reg - 0x78U + i) % 5U));
+    }
+    if((r >= 0x78U) && (r <= 0x7CU))
+    {
+      pData[i] = (FifoLen != 0) ? Fifo[FifoHead][r - 0x78U] : 0U;
+      if((r == 0x7CU) && (FifoLen != 0))
+      {
+        FifoHead = (FifoHead + 1) % LPS22HH_FIFO_DEPTH;
+        FifoLen--;
+      }
+      Lps[0x25] = (uint8_t)FifoLen;
+      continue;
+    }
+    pData[i] = Lps[r & 0x7FU];
+    if(r == 0x2AU)
+    {
+      Lps[0x27] &= (uint8_t)~0x01U;
+    }
+    if(r == 0x2CU)
+    {
+      Lps[0x27] &= (uint8_t)~0x02U;
+    }
+  }
+}
+
+static void Lps_Write(uint8_t Reg, const uint8_t *pData, uint16_t Length)
+{
+  uint8_t inc = Lps[0x11] & 0x10U;
+  uint8_t r;
+  uint16_t i;
+
+  for(i = 0; i < Length; i++)
+  {
+    r = (uint8_t)((inc != 0U) ? (Reg + i) : Reg);
+    Lps[r & 0x7FU] = pData[i];
+    if((r == 0x13U) && ((pData[i] & 0x03U) == 0U))
+    {
+      FifoHead = 0;
+      FifoLen = 0;
+      Lps[0x25] = 0;
+    }
+    if(r == 0x11U)
+    {
+      /* BOOT and SWRESET clear by themselves */
+      Lps[0x11] &= (uint8_t)~0x84U;
+    }
+  }
+}
+
+static void Step(void)
+{
+  Physics((double)(Now - T0) / 1000.0);
+  Hts_Step();
+  Lps_Step();
+}
+
+/* Sensors free-running for 10 s with the notifications off */
+static void Start(Scenario_t Scen)
+{
+  uint32_t end = Now + 10000U;
+
+  Scenario = Scen;
+  Rng = 88172645463325252ULL;
+  T0 = Now;
+  for(; Now < end; Now++)
+  {
+    Step();
+  }
+  FifoOverruns = 0;
+  Notifications = 0;
+  ErrP2 = 0;
+  ErrN = 0;
+  EventLatency = UINT32_MAX;
+}
+
+/* One hour of notifications */
+static void Test_Hour(Scenario_t Scen)
+{
+  uint32_t start;
+  uint32_t x0;
+  uint32_t startXfers;
+  uint32_t hourXfers;
+  double rmsP;
+
+  Start(Scen);
+
+  x0 = Xfers;
+  ENV_Set_Notification_Status(1);
+  startXfers = Xfers - x0;
+  start = Now;
+  T0 = start;
+  x0 = Xfers;
+  XBytes = 0;
+  for(; Now < (start + HOUR_MS); Now++)
+  {
+    Step();
+    if((((Now - start) % BATCH_PERIOD_MS) == 0U) && (Now != start))
+    {
+      ENV_Send_Notification_Task();
+    }
+    if((Scen == SCENARIO_EVENT) && (EventLatency == UINT32_MAX) && (Now >= (start + EVENT_MS)) && (LastT >= 235))
+    {
+      EventLatency = Now - (start + EVENT_MS);
+    }
+  }
+  hourXfers = Xfers - x0;
+  rmsP = sqrt(ErrP2 / ErrN);
+
+  printf("scenario %d, per hour: start %lu, %lu I2C transactions (%lu bus bytes), %lu notifications, P RMS %.4f hPa\n",
+         Scen, (unsigned long)startXfers, (unsigned long)hourXfers, (unsigned long)XBytes,
+         (unsigned long)Notifications, rmsP);
+
+  /* The 500 ms polling took 28796 transactions and 7199 notifications */
+  CHECK(hourXfers < 5500U);
+  CHECK(Notifications >= (HOUR_MS / (CFG_ENV_MAX_SILENCE * 1000U)));
+  CHECK(Notifications < 200U);
+  CHECK(FifoOverruns == 0U);
+  CHECK(rmsP < 0.01);
+  if(Scen == SCENARIO_EVENT)
+  {
+    printf("  step of +2 degC notified after %lu ms\n", (unsigned long)EventLatency);
+    CHECK(EventLatency <= BATCH_PERIOD_MS);
+  }
+
+  /* A read request reports the last batch */
+  x0 = Xfers;
+  ENV_Update();
+  CHECK(Xfers == x0);
+
+  /* Back to the free-running sensors: FIFO bypass, HTS221 continuous */
+  ENV_Set_Notification_Status(0);
+  CHECK((Lps[0x13] & 0x03U) == 0U);
+  CHECK((Lps[0x10] & 0x70U) != 0U);
+  CHECK((Hts[0x20] & 0x83U) > 0x80U);
+}
+
+/* Stubs ---------------------------------------------------------------------*/
+uint32_t HAL_GetTick(void)
+{
+  return Now;
+}
+
+int32_t BSP_GetTick(void)
+{
+  return (int32_t)Now;
+}
+
+int32_t BSP_I2C1_Init(void)
+{
+  return BSP_ERROR_NONE;
+}
+
+int32_t BSP_I2C1_DeInit(void)
+{
+  return BSP_ERROR_NONE;
+}
+
+int32_t BSP_I2C1_ReadReg(uint16_t Addr, uint16_t Reg, uint8_t *pData, uint16_t Length)
+{
+  Xfers++;
+  XBytes += Length + 3U;
+  if((Addr & 0xFEU) == HTS221_ADDRESS)
+  {
+    Hts_Read((uint8_t)Reg, pData, Length);
+  }
+  else if((Addr & 0xFEU) == LPS22HH_ADDRESS)
+  {
+    Lps_Read((uint8_t)Reg, pData, Length);
+  }
+  else
+  {
+    return BSP_ERROR_BUS_FAILURE;
+  }
+  return BSP_ERROR_NONE;
+}
+
+int32_t BSP_I2C1_WriteReg(uint16_t Addr, uint16_t Reg, uint8_t *pData, uint16_t Length)
+{
+  Xfers++;
+  XBytes += Length + 2U;
+  if((Addr & 0xFEU) == HTS221_ADDRESS)
+  {
+    Hts_Write((uint8_t)Reg, pData, Length);
+  }
+  else if((Addr & 0xFEU) == LPS22HH_ADDRESS)
+  {
+    Lps_Write((uint8_t)Reg, pData, Length);
+  }
+  else
+  {
+    return BSP_ERROR_BUS_FAILURE;
+  }
+  return BSP_ERROR_NONE;
+}
+
+/* Payload: timestamp, pressure x100, humidity x10, temperatures x10 */
+tBleStatus NOTIFY_Update_Char(MOTENV_STM_Char_t Char, uint8_t payloadLen, uint8_t *pPayload)
+{
+  CHECK(Char == MOTENV_STM_ENV_CHAR);
+  CHECK(payloadLen >= 10U);
+  Notifications++;
+  LastP = (int32_t)((uint32_t)pPayload[2] | ((uint32_t)pPayload[3] << 8) | ((uint32_t)pPayload[4] << 16) | ((uint32_t)pPayload[5] << 24));
+  LastH = (uint16_t)(pPayload[6] | (pPayload[7] << 8));
+  LastT = (int16_t)(pPayload[8] | (pPayload[9] << 8));
+  ErrP2 += pow(((double)LastP / 100.0) - TrueP, 2.0);
+  ErrN++;
+  return BLE_STATUS_SUCCESS;
+}
+
+uint8_t MOTIONFX_Get_MagCalStatus(void)
+{
+  return 0;
+}
+
+uint8_t CONFIG_Get_FirstConnection_Config(void)
+{
+  return 0;
+}
+
+void CONFIG_Set_FirstConnection_Config(uint8_t status)
+{
+  (void)status;
+}
+
+void CONFIG_Send_Notification(uint32_t Feature, uint8_t Command, uint8_t data)
+{
+  (void)Feature;
+  (void)Command;
+  (void)data;
+}
+
+int main(void)
+{
+  Physics(0);
+  Hts_Reset();
+  Lps_Reset();
+  ENV_Context_Init();
+
+  Test_Hour(SCENARIO_STEADY);
+  Test_Hour(SCENARIO_EVENT);
+  Test_Hour(SCENARIO_HEATING);
+
+  printf("%s\n", (Failures == 0U) ? "PASS" : "FAIL");
+  return (Failures == 0U) ? 0 : 1;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
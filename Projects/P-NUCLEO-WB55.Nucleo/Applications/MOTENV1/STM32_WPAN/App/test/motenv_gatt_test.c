@@ -0,0 +1,274 @@
+/**
+ ******************************************************************************
+ * File Name          : motenv_gatt_test.c
+ * Description        : Host test of the MOTENV GATT dispatch: the read,
+ *                      CCCD and write events on and around the service
+ *                      handles are replayed through the attribute table and
+ *                      must give the acks, the allowed reads and the
+ *                      application events recorded from the per-char
+ *                      handler, for several handle bases. The chars are
+ *                      updated on the handles they were added with.
+ *                      Run by Tools/run_host_tests.sh
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "common_blesvc.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define FIXTURE                         "STM32_WPAN/App/test/fixtures/motenv_gatt_events.txt"
+#define CONNECTION_HANDLE               (0x0801U)
+#define MAX_EFFECTS                     (8)
+
+#define CHECK(cond)                     do { if(!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); Failures++; } } while(0)
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t Failures;
+
+static SVC_CTL_p_EvtHandler_t Handler;
+static uint16_t NextHandle;
+static uint16_t CharHandle;
+static uint16_t UpdateSvc;
+static uint16_t UpdateChar;
+
+/* Calls to aci_gatt_allow_read and MOTENV_STM_App_Notification, in order */
+static int Effects[MAX_EFFECTS];
+static uint32_t EffectsLen;
+static uint16_t NotifiedConnection;
+
+static uint8_t Packet[64];
+
+/* Private functions ---------------------------------------------------------*/
+static void Effect(int Value)
+{
+  if(EffectsLen < MAX_EFFECTS)
+  {
+    Effects[EffectsLen] = Value;
+  }
+  EffectsLen++;
+}
+
+static void Init(uint16_t Base)
+{
+  Handler = NULL;
+  NextHandle = Base;
+  MOTENV_STM_Init();
+  CHECK(Handler != NULL);
+}
+
+static void *Vendor_Event(uint16_t Ecode)
+{
+  hci_event_pckt *event_pckt = (hci_event_pckt *)(((hci_uart_pckt *)Packet)->data);
+  evt_blue_aci *blue_evt = (evt_blue_aci *)event_pckt->data;
+
+  memset(Packet, 0, sizeof(Packet));
+  event_pckt->evt = EVT_VENDOR;
+  blue_evt->ecode = Ecode;
+  return blue_evt->data;
+}
+
+static SVCCTL_EvtAckStatus_t Replay(uint16_t Handle, int Modified, uint8_t Data)
+{
+  aci_gatt_read_permit_req_event_rp0 *read_permit_req;
+  aci_gatt_attribute_modified_event_rp0 *attribute_modified;
+
+  if(Modified == 0)
+  {
+    read_permit_req = Vendor_Event(EVT_BLUE_GATT_READ_PERMIT_REQ);
+    read_permit_req->Connection_Handle = CONNECTION_HANDLE;
+    read_permit_req->Attribute_Handle = Handle;
+  }
+  else
+  {
+    attribute_modified = Vendor_Event(EVT_BLUE_GATT_ATTRIBUTE_MODIFIED);
+    attribute_modified->Connection_Handle = CONNECTION_HANDLE;
+    attribute_modified->Attr_Handle = Handle;
+    attribute_modified->Attr_Data_Length = Data + 1U;
+    attribute_modified->Attr_Data[0] = Data;
+  }
+
+  EffectsLen = 0;
+  return Handler(Packet);
+}
+
+/**
+ * Every line of the fixture replayed against the service initialized on its base
+ */
+static void Test_Fixture(void)
+{
+  char line[160];
+  char *p;
+  uint32_t events = 0;
+  uint32_t updates = 0;
+  uint32_t base = 0x10000;
+  unsigned int b, c, svc, chr, d, ack, n, i;
+  int h, ev, effect, used;
+  FILE *f;
+
+  f = fopen(FIXTURE, "r");
+  CHECK(f != NULL);
+  if(f == NULL)
+  {
+    return;
+  }
+
+  while(fgets(line, sizeof(line), f) != NULL)
+  {
+    if(line[0] == 'U')
+    {
+      CHECK(sscanf(line, "U %x %u %u %u", &b, &c, &svc, &chr) == 4);
+      if(b != base)
+      {
+        base = b;
+        Init((uint16_t)base);
+      }
+      UpdateSvc = 0;
+      UpdateChar = 0;
+      CHECK(MOTENV_STM_App_Update_Char((MOTENV_STM_Char_t)c, 1, Packet) == BLE_STATUS_SUCCESS);
+      CHECK(UpdateSvc == (uint16_t)(base + svc));
+      CHECK(UpdateChar == (uint16_t)(base + chr));
+      updates++;
+    }
+    else if(line[0] == 'E')
+    {
+      CHECK(sscanf(line, "E %x %d %d %u %u %u%n", &b, &h, &ev, &d, &ack, &n, &used) == 6);
+      CHECK(b == base);
+      CHECK(Replay((uint16_t)(base + h), ev, (uint8_t)d) == (SVCCTL_EvtAckStatus_t)ack);
+      if(EffectsLen != n)
+      {
+        printf("base 0x%04X handle %+d event %d data %u: %u effects, %u expected\n",
+               (unsigned int)base, h, ev, d, (unsigned int)EffectsLen, n);
+      }
+      CHECK(EffectsLen == n);
+      p = line + used;
+      for(i = 0; (i < n) && (i < MAX_EFFECTS) && (sscanf(p, "%d%n", &effect, &used) == 1); i++)
+      {
+        CHECK(Effects[i] == effect);
+        p += used;
+      }
+      CHECK(i == n);
+      events++;
+    }
+  }
+  fclose(f);
+
+  printf("  %u events, %u updates replayed\n", (unsigned int)events, (unsigned int)updates);
+  CHECK(events > 0U);
+  CHECK(updates == 4U * MOTENV_STM_CHAR_NUMBER);
+}
+
+/**
+ * Events added with the batched and queued notifications
+ */
+static void Test_Link_Events(void)
+{
+  aci_att_exchange_mtu_resp_event_rp0 *exchange_mtu_resp;
+
+  Init(0x0C);
+
+  exchange_mtu_resp = Vendor_Event(EVT_BLUE_ATT_EXCHANGE_MTU_RESP);
+  exchange_mtu_resp->Connection_Handle = CONNECTION_HANDLE;
+  exchange_mtu_resp->Server_RX_MTU = 156;
+  EffectsLen = 0;
+  CHECK(Handler(Packet) == SVCCTL_EvtNotAck);
+  CHECK((EffectsLen == 1U) && (Effects[0] == ATT_MTU_EXCHANGED_EVT));
+  CHECK(NotifiedConnection == CONNECTION_HANDLE);
+
+  (void)Vendor_Event(EVT_BLUE_GATT_TX_POOL_AVAILABLE);
+  EffectsLen = 0;
+  CHECK(Handler(Packet) == SVCCTL_EvtNotAck);
+  CHECK((EffectsLen == 1U) && (Effects[0] == TX_POOL_AVAILABLE_EVT));
+
+  CHECK(MOTENV_STM_App_Update_Char(MOTENV_STM_CHAR_NUMBER, 1, Packet) == BLE_STATUS_INVALID_PARAMS);
+}
+
+/* Stubs ---------------------------------------------------------------------*/
+void SVCCTL_RegisterSvcHandler(SVC_CTL_p_EvtHandler_t pfBLE_SVC_Service_Event_Handler)
+{
+  Handler = pfBLE_SVC_Service_Event_Handler;
+}
+
+tBleStatus aci_gatt_add_service(uint8_t Service_UUID_Type, Service_UUID_t *Service_UUID, uint8_t Service_Type,
+                                uint8_t Max_Attribute_Records, uint16_t *Service_Handle)
+{
+  (void)Service_UUID_Type;
+  (void)Service_UUID;
+  (void)Service_Type;
+  *Service_Handle = NextHandle;
+  CharHandle = NextHandle + 1U;
+  NextHandle += Max_Attribute_Records;
+  return BLE_STATUS_SUCCESS;
+}
+
+tBleStatus aci_gatt_add_char(uint16_t Service_Handle, uint8_t Char_UUID_Type, Char_UUID_t *Char_UUID,
+                             uint16_t Char_Value_Length, uint8_t Char_Properties, uint8_t Security_Permissions,
+                             uint8_t GATT_Evt_Mask, uint8_t Enc_Key_Size, uint8_t Is_Variable, uint16_t *Char_Handle)
+{
+  (void)Service_Handle;
+  (void)Char_UUID_Type;
+  (void)Char_UUID;
+  (void)Char_Value_Length;
+  (void)Char_Properties;
+  (void)Security_Permissions;
+  (void)GATT_Evt_Mask;
+  (void)Enc_Key_Size;
+  (void)Is_Variable;
+  /* Declaration, value and CCCD */
+  *Char_Handle = CharHandle;
+  CharHandle += 3U;
+  return BLE_STATUS_SUCCESS;
+}
+
+tBleStatus aci_gatt_allow_read(uint16_t Connection_Handle)
+{
+  Effect(1000 + Connection_Handle);
+  return BLE_STATUS_SUCCESS;
+}
+
+tBleStatus aci_gatt_update_char_value(uint16_t Service_Handle, uint16_t Char_Handle, uint8_t Val_Offset,
+                                      uint8_t Char_Value_Length, uint8_t Char_Value[])
+{
+  (void)Val_Offset;
+  (void)Char_Value_Length;
+  (void)Char_Value;
+  UpdateSvc = Service_Handle;
+  UpdateChar = Char_Handle;
+  return BLE_STATUS_SUCCESS;
+}
+
+void MOTENV_STM_App_Notification(MOTENV_STM_App_Notification_evt_t *pNotification)
+{
+  Effect(pNotification->Motenv_Evt_Opcode);
+  if(pNotification->Motenv_Evt_Opcode == CONFIG_WRITE_EVT)
+  {
+    Effect(pNotification->DataTransfered.Length);
+    Effect(pNotification->DataTransfered.pPayload[0]);
+  }
+  else if(pNotification->Motenv_Evt_Opcode == ATT_MTU_EXCHANGED_EVT)
+  {
+    NotifiedConnection = pNotification->ConnectionHandle;
+  }
+}
+
+int main(void)
+{
+  Test_Fixture();
+  Test_Link_Events();
+
+  printf("%s\n", (Failures == 0U) ? "PASS" : "FAIL");
+  return (Failures == 0U) ? 0 : 1;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
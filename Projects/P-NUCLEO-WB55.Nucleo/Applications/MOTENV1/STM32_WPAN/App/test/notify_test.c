@@ -0,0 +1,333 @@
+/**
+ ******************************************************************************
+ * File Name          : notify_test.c
+ * Description        : Host test of the notifications kept while the stack
+ *                      has no buffer: over a link draining a few packets per
+ *                      connection event, the periodic chars end on their
+ *                      newest value and every value refused by the stack is
+ *                      counted, while every Config reply and Acc Event is
+ *                      notified once, in order.
+ *                      Run by Tools/run_host_tests.sh
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "app_common.h"
+#include "ble.h"
+#include "stm32_seq.h"
+
+#include "notify_app.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define LINK_QUEUE                      (64)
+#define RUN_MS                          (60000U)
+
+#define CHECK(cond)                     do { if(!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); Failures++; } } while(0)
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  MOTENV_STM_Char_t Char;
+  uint32_t Period;                      /* [ms] */
+  uint8_t Length;
+  const char *Name;
+} Producer_t;
+
+typedef struct
+{
+  MOTENV_STM_Char_t Char;
+  uint32_t Sequence;
+} Packet_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t Failures;
+static uint32_t Now;                    /* [ms] */
+static uint8_t TaskSet;
+
+/* Link: Pool is the stack buffers, PerEvent packets leave each connection event */
+static uint32_t Pool;
+static uint32_t PerEvent;
+static uint8_t Starved;
+static Packet_t Link[LINK_QUEUE];
+static uint32_t LinkLen;
+
+/* Values written and received, per char */
+static uint32_t Generated[MOTENV_STM_CHAR_NUMBER];
+static uint32_t Received[MOTENV_STM_CHAR_NUMBER];
+static uint32_t LastReceived[MOTENV_STM_CHAR_NUMBER];
+static uint32_t OutOfOrder[MOTENV_STM_CHAR_NUMBER];
+static uint32_t Refused[MOTENV_STM_CHAR_NUMBER];
+
+static const Producer_t Producer[] =
+{
+  { MOTENV_STM_MOTION_FX_CHAR,    10,   20, "Quat" },
+  { MOTENV_STM_ECOMPASS_CHAR,     10,   4,  "ECompass" },
+  { MOTENV_STM_MOTION_CHAR,       50,   20, "Motion" },
+  { MOTENV_STM_ACC_EVENT_CHAR,    70,   5,  "AccEvent" },
+  { MOTENV_STM_ENV_CHAR,          500,  12, "Env" },
+  { MOTENV_STM_ACTIVITY_REC_CHAR, 1000, 3,  "ActRec" },
+  { MOTENV_STM_CONFIG_CHAR,       300,  20, "Config" },
+};
+
+#define PRODUCERS                       (sizeof(Producer) / sizeof(Producer[0]))
+
+/* Private functions ---------------------------------------------------------*/
+static uint8_t Is_Event(MOTENV_STM_Char_t Char)
+{
+  return (Char == MOTENV_STM_CONFIG_CHAR) || (Char == MOTENV_STM_ACC_EVENT_CHAR);
+}
+
+static void Reset(uint32_t Buffers, uint32_t Packets)
+{
+  Now = 0;
+  TaskSet = 0;
+  Pool = Buffers;
+  PerEvent = Packets;
+  Starved = 0;
+  LinkLen = 0;
+  memset(Generated, 0, sizeof(Generated));
+  memset(Received, 0, sizeof(Received));
+  memset(LastReceived, 0, sizeof(LastReceived));
+  memset(OutOfOrder, 0, sizeof(OutOfOrder));
+  memset(Refused, 0, sizeof(Refused));
+  NOTIFY_Init();
+}
+
+static void Run_Tasks(void)
+{
+  while(TaskSet != 0U)
+  {
+    TaskSet = 0;
+    NOTIFY_Flush_Task();
+  }
+}
+
+/**
+ * The packets of a connection event leave the link, their buffers come back
+ */
+static void Connection_Event(void)
+{
+  uint32_t n = (PerEvent < LinkLen) ? PerEvent : LinkLen;
+  uint32_t i;
+  Packet_t *pPacket;
+
+  for(i = 0; i < n; i++)
+  {
+    pPacket = &Link[i];
+    if(pPacket->Sequence <= LastReceived[pPacket->Char])
+    {
+      OutOfOrder[pPacket->Char]++;
+    }
+    LastReceived[pPacket->Char] = pPacket->Sequence;
+    Received[pPacket->Char]++;
+  }
+  memmove(Link, &Link[n], (LinkLen - n) * sizeof(Packet_t));
+  LinkLen -= n;
+  Pool += n;
+
+  if((n != 0U) && (Starved != 0U))
+  {
+    Starved = 0;
+    NOTIFY_Tx_Pool_Available();
+  }
+  Run_Tasks();
+}
+
+static void Write(MOTENV_STM_Char_t Char, uint8_t Length)
+{
+  uint8_t value[NOTIFY_MAX_VALUE_LEN];
+
+  memset(value, 0, sizeof(value));
+  Generated[Char]++;
+  memcpy(value, &Generated[Char], sizeof(uint32_t));
+  if(NOTIFY_Update_Char(Char, Length, value) != BLE_STATUS_SUCCESS)
+  {
+    Refused[Char]++;
+  }
+  Run_Tasks();
+}
+
+/**
+ * All the chars notified together over a slow link for a minute, then drained
+ */
+static void Test_Workload(uint32_t Interval, uint32_t Packets, uint32_t Buffers)
+{
+  const NOTIFY_Stats_t *pStats;
+  MOTENV_STM_Char_t c;
+  uint32_t kept;
+  uint32_t i;
+
+  Reset(Buffers, Packets);
+  for(Now = 1; Now < RUN_MS; Now++)
+  {
+    for(i = 0; i < PRODUCERS; i++)
+    {
+      if((Now % Producer[i].Period) == 0U)
+      {
+        Write(Producer[i].Char, Producer[i].Length);
+      }
+    }
+    if((Now % Interval) == 0U)
+    {
+      Connection_Event();
+    }
+  }
+  for(i = 0; (i < 1000U) && ((LinkLen != 0U) || (Starved != 0U)); i++)
+  {
+    Now++;
+    Connection_Event();
+  }
+
+  printf("  CI %2u ms, %u packets, %u buffers:", (unsigned int)Interval, (unsigned int)Packets,
+         (unsigned int)Buffers);
+  for(i = 0; i < PRODUCERS; i++)
+  {
+    c = Producer[i].Char;
+    pStats = NOTIFY_Get_Stats(c);
+    printf(" %s %u/%u", Producer[i].Name, (unsigned int)Received[c], (unsigned int)Generated[c]);
+
+    CHECK(OutOfOrder[c] == 0U);
+    CHECK(LinkLen == 0U);
+    kept = pStats->Sent + pStats->Deferred;
+    CHECK(Received[c] == kept);
+    CHECK(kept + pStats->Coalesced + pStats->Dropped == Generated[c]);
+    if(Is_Event(c))
+    {
+      /* Queued: none replaced, none refused at these rates */
+      CHECK(pStats->Coalesced == 0U);
+      CHECK(Refused[c] == 0U);
+      CHECK(Received[c] == Generated[c]);
+      CHECK(pStats->MaxDelay < 1000U);
+    }
+    else
+    {
+      /* The newest value is always notified */
+      CHECK(LastReceived[c] == Generated[c]);
+    }
+  }
+  printf("\n");
+}
+
+/**
+ * Events written while the stack has no buffer: the queue keeps each of them,
+ * refuses the ones it cannot hold and sends them before the periodic values
+ */
+static void Test_Event_Queue(void)
+{
+  const NOTIFY_Stats_t *pStats;
+  uint32_t i;
+
+  Reset(0, 2 * NOTIFY_FIFO_SIZE);
+  Write(MOTENV_STM_MOTION_CHAR, 20);
+  CHECK(Starved != 0U);
+  for(i = 0; i < NOTIFY_FIFO_SIZE + 2U; i++)
+  {
+    Write((i & 1U) ? MOTENV_STM_CONFIG_CHAR : MOTENV_STM_ACC_EVENT_CHAR, 5);
+    Write(MOTENV_STM_MOTION_CHAR, 20);
+  }
+  CHECK(Refused[MOTENV_STM_ACC_EVENT_CHAR] + Refused[MOTENV_STM_CONFIG_CHAR] == 2U);
+  CHECK(NOTIFY_Get_Stats(MOTENV_STM_CONFIG_CHAR)->Dropped == 1U);
+  CHECK(NOTIFY_Get_Stats(MOTENV_STM_ACC_EVENT_CHAR)->Dropped == 1U);
+  CHECK(LinkLen == 0U);
+
+  /* The buffers come back: the events first, in order, then the newest motion */
+  Pool = 2 * NOTIFY_FIFO_SIZE;
+  Starved = 0;
+  NOTIFY_Tx_Pool_Available();
+  Run_Tasks();
+  CHECK(LinkLen == NOTIFY_FIFO_SIZE + 1U);
+  for(i = 0; (i < NOTIFY_FIFO_SIZE) && (i < LinkLen); i++)
+  {
+    CHECK(Link[i].Char == ((i & 1U) ? MOTENV_STM_CONFIG_CHAR : MOTENV_STM_ACC_EVENT_CHAR));
+    CHECK(Link[i].Sequence == (i / 2U) + 1U);
+  }
+  CHECK(Link[NOTIFY_FIFO_SIZE].Char == MOTENV_STM_MOTION_CHAR);
+  CHECK(Link[NOTIFY_FIFO_SIZE].Sequence == Generated[MOTENV_STM_MOTION_CHAR]);
+
+  pStats = NOTIFY_Get_Stats(MOTENV_STM_MOTION_CHAR);
+  CHECK(pStats->Deferred == 1U);
+  CHECK(pStats->Coalesced == NOTIFY_FIFO_SIZE + 2U);
+}
+
+/**
+ * A disconnection forgets the queued events
+ */
+static void Test_Reset(void)
+{
+  Reset(0, 4);
+  Write(MOTENV_STM_ACC_EVENT_CHAR, 5);
+  Write(MOTENV_STM_CONFIG_CHAR, 20);
+  NOTIFY_Reset();
+
+  Pool = 4;
+  Starved = 0;
+  NOTIFY_Tx_Pool_Available();
+  Run_Tasks();
+  CHECK(LinkLen == 0U);
+
+  Write(MOTENV_STM_CONFIG_CHAR, 20);
+  CHECK((LinkLen == 1U) && (Link[0].Char == MOTENV_STM_CONFIG_CHAR));
+  CHECK(NOTIFY_Get_Stats(MOTENV_STM_CONFIG_CHAR)->Sent == 1U);
+}
+
+/* Stubs ---------------------------------------------------------------------*/
+uint32_t HAL_GetTick(void)
+{
+  return Now;
+}
+
+void UTIL_SEQ_SetTask(UTIL_SEQ_bm_t TaskId_bm, uint32_t Task_Prio)
+{
+  (void)Task_Prio;
+  CHECK(TaskId_bm == (1U << CFG_TASK_NOTIFY_FLUSH_ID));
+  TaskSet = 1;
+}
+
+tBleStatus MOTENV_STM_App_Update_Char(MOTENV_STM_Char_t Char, uint8_t payloadLen, uint8_t *pPayload)
+{
+  CHECK(payloadLen <= NOTIFY_MAX_VALUE_LEN);
+  if((Pool == 0U) || (LinkLen == LINK_QUEUE))
+  {
+    Starved = 1;
+    return BLE_STATUS_INSUFFICIENT_RESOURCES;
+  }
+  Pool--;
+  Link[LinkLen].Char = Char;
+  memcpy(&Link[LinkLen].Sequence, pPayload, sizeof(uint32_t));
+  LinkLen++;
+  return BLE_STATUS_SUCCESS;
+}
+
+int main(void)
+{
+  static const uint32_t ci[3] = { 15, 30, 50 };
+  static const uint32_t packets[2] = { 2, 4 };
+  uint32_t c;
+  uint32_t k;
+
+  for(c = 0; c < 3U; c++)
+  {
+    for(k = 0; k < 2U; k++)
+    {
+      Test_Workload(ci[c], packets[k], 6);
+    }
+  }
+
+  Test_Event_Queue();
+  Test_Reset();
+
+  printf("%s\n", (Failures == 0U) ? "PASS" : "FAIL");
+  return (Failures == 0U) ? 0 : 1;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
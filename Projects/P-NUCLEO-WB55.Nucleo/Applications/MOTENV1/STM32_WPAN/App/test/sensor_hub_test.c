@@ -0,0 +1,437 @@
+/**
+ ******************************************************************************
+ * File Name          : sensor_hub_test.c
+ * Description        : Host test of the sensor hub: all the motion features
+ *                      are fed from one timer over a bus that merges the
+ *                      contiguous reads. Every consumer gets its samples in
+ *                      order, at its rate, also when its task is held back,
+ *                      and the samples overwritten in the ring are counted.
+ *                      Run by Tools/run_host_tests.sh
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "app_common.h"
+#include "stm32_seq.h"
+
+#include "sensor_hub_app.h"
+#include "iks01a3_motion_sensors_ex.h"
+#include "stm32wbxx_nucleo_bus.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define TICK_US                         ((1e6 * CFG_RTCCLK_DIV) / LSE_VALUE)
+#define PERIOD(s)                       (uint32_t)((s)*1000*1000/CFG_TS_TICK_VAL)
+#define RUN_S                           (60.0)
+#define QUEUE_SIZE                      (8)
+
+#define IMU_ADDRESS                     (0xD7U)
+#define IMU_REG                         (0x22U)         /* OUTX_L_G, then OUTX_L_A */
+#define MAG_ADDRESS                     (0x3DU)
+#define MAG_REG                         (0x68U)
+
+#define HUB_TASKS                       ((1U << CFG_TASK_SENSOR_HUB_ID) | (1U << CFG_TASK_SENSOR_HUB_READY_ID))
+
+#define CHECK(cond)                     do { if(!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); Failures++; } } while(0)
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint16_t Addr;
+  uint16_t Reg;
+  uint16_t Length;
+  I2C_QUEUE_Cb_t Callback;
+} Request_t;
+
+typedef struct
+{
+  const char *Name;
+  double Period;                        /* [s] */
+  uint32_t Sensors;
+  uint32_t TaskId;
+} Consumer_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t Failures;
+static uint64_t Now;                    /* [HW_TS ticks] */
+
+/* Timer and sequencer */
+static uint32_t TimerPeriod;
+static uint64_t TimerNext;
+static HW_TS_pTimerCb_t TimerCb;
+static void (*Tasks[32])(void);
+static uint32_t Pending;
+
+/* Bus: the requests complete on the next tick */
+static Request_t Queue[QUEUE_SIZE];
+static uint32_t QueueLen;
+static Request_t Done[QUEUE_SIZE];
+static uint32_t DoneLen;
+static uint64_t Transfers;
+static uint16_t Acquisition;            /* Written in the registers of each acquisition */
+static int32_t ReadError;               /* Status of the next read completion */
+
+/* Consumers as registered by MOTENV_APP_Init */
+static const Consumer_t Consumers[SENSOR_HUB_CONSUMER_NBR] =
+{
+  { "Motion",      0.05,   SENSOR_HUB_ACC | SENSOR_HUB_GYRO | SENSOR_HUB_MAG, CFG_TASK_NOTIFY_ACC_GYRO_MAG_ID },
+  { "MotionBatch", 0.01,   SENSOR_HUB_ACC | SENSOR_HUB_GYRO | SENSOR_HUB_MAG, CFG_TASK_NOTIFY_MOTION_BATCH_ID },
+  { "MotionFX",    0.01,   SENSOR_HUB_ACC | SENSOR_HUB_GYRO | SENSOR_HUB_MAG, CFG_TASK_NOTIFY_MOTIONFX_ID },
+  { "ActivityRec", 0.0625, SENSOR_HUB_ACC,                                    CFG_TASK_NOTIFY_ACTIVITY_REC_ID },
+  { "CarryPos",    0.02,   SENSOR_HUB_ACC,                                    CFG_TASK_NOTIFY_CARRY_POSITION_ID },
+  { "GestureRec",  0.02,   SENSOR_HUB_ACC,                                    CFG_TASK_NOTIFY_GESTURE_REC_ID },
+  { "Pedometer",   0.02,   SENSOR_HUB_ACC,                                    CFG_TASK_NOTIFY_PEDOMETER_ID },
+  { "IntensityDet",0.0625, SENSOR_HUB_ACC,                                    CFG_TASK_NOTIFY_INTENSITY_DET_ID },
+};
+
+/* What each consumer read */
+static uint32_t Runs[SENSOR_HUB_CONSUMER_NBR];
+static uint32_t Samples[SENSOR_HUB_CONSUMER_NBR];
+static int32_t LastAcq[SENSOR_HUB_CONSUMER_NBR];
+static uint32_t LastTimeStamp[SENSOR_HUB_CONSUMER_NBR];
+static uint32_t Errors;
+
+/* Private functions ---------------------------------------------------------*/
+
+/* The sample must hold one acquisition, newer than the previous one read */
+static void Consume(SENSOR_HUB_Consumer_Id_t Id)
+{
+  const SENSOR_HUB_Sample_t *pSample;
+
+  Runs[Id]++;
+  while((pSample = SENSOR_HUB_Get_Sample(Id)) != NULL)
+  {
+    if(((pSample->Sensors & Consumers[Id].Sensors) != Consumers[Id].Sensors) ||
+       ((pSample->Consumers & (1U << Id)) == 0U) ||
+       (pSample->Acc.x != pSample->Gyro.z) ||
+       (((pSample->Sensors & SENSOR_HUB_MAG) != 0U) && (pSample->Mag.x != pSample->Acc.x)) ||
+       ((Samples[Id] != 0U) && ((pSample->Acc.x <= LastAcq[Id]) || (pSample->TimeStamp < LastTimeStamp[Id]))))
+    {
+      Errors++;
+    }
+    LastAcq[Id] = pSample->Acc.x;
+    LastTimeStamp[Id] = pSample->TimeStamp;
+    Samples[Id]++;
+  }
+}
+
+static void Consumer0_Task(void) { Consume(SENSOR_HUB_MOTION); }
+static void Consumer1_Task(void) { Consume(SENSOR_HUB_MOTION_BATCH); }
+static void Consumer2_Task(void) { Consume(SENSOR_HUB_MOTIONFX); }
+static void Consumer3_Task(void) { Consume(SENSOR_HUB_ACTIVITY_REC); }
+static void Consumer4_Task(void) { Consume(SENSOR_HUB_CARRY_POSITION); }
+static void Consumer5_Task(void) { Consume(SENSOR_HUB_GESTURE_REC); }
+static void Consumer6_Task(void) { Consume(SENSOR_HUB_PEDOMETER); }
+static void Consumer7_Task(void) { Consume(SENSOR_HUB_INTENSITY_DET); }
+
+static void (*const ConsumerTasks[SENSOR_HUB_CONSUMER_NBR])(void) =
+{
+  Consumer0_Task, Consumer1_Task, Consumer2_Task, Consumer3_Task,
+  Consumer4_Task, Consumer5_Task, Consumer6_Task, Consumer7_Task,
+};
+
+static void Start_All(void)
+{
+  uint32_t i;
+
+  Now = 0;
+  Pending = 0;
+  QueueLen = 0;
+  DoneLen = 0;
+  Transfers = 0;
+  Errors = 0;
+  memset(Runs, 0, sizeof(Runs));
+  memset(Samples, 0, sizeof(Samples));
+
+  SENSOR_HUB_Init();
+  for(i = 0; i < (uint32_t)SENSOR_HUB_CONSUMER_NBR; i++)
+  {
+    UTIL_SEQ_RegTask(1U << Consumers[i].TaskId, UTIL_SEQ_RFU, ConsumerTasks[i]);
+    SENSOR_HUB_Register((SENSOR_HUB_Consumer_Id_t)i, PERIOD(Consumers[i].Period), Consumers[i].Sensors, Consumers[i].TaskId);
+    SENSOR_HUB_Start((SENSOR_HUB_Consumer_Id_t)i);
+  }
+}
+
+/* The consumer tasks are held back HoldMs every second, the hub tasks still run */
+static void Run(double Seconds, uint32_t HoldMs)
+{
+  uint64_t end = Now + (uint64_t)((Seconds * 1e6) / TICK_US);
+  uint32_t runnable;
+  uint32_t held;
+  uint32_t i;
+
+  for(; Now < end; Now++)
+  {
+    for(i = 0; i < DoneLen; i++)
+    {
+      Done[i].Callback(ReadError, NULL);
+      ReadError = BSP_ERROR_NONE;
+    }
+    memcpy(Done, Queue, sizeof(Queue[0]) * QueueLen);
+    DoneLen = QueueLen;
+    QueueLen = 0;
+
+    if((TimerPeriod != 0U) && (Now == TimerNext))
+    {
+      TimerNext += TimerPeriod;
+      TimerCb();
+    }
+
+    held = ((HoldMs != 0U) && ((HAL_GetTick() % 1000U) < HoldMs)) ? 1U : 0U;
+    while((runnable = ((held != 0U) ? (Pending & HUB_TASKS) : Pending)) != 0U)
+    {
+      i = (uint32_t)__builtin_ctz(runnable);
+      Pending &= ~(1U << i);
+      Tasks[i]();
+    }
+  }
+}
+
+static void Report(const char *Name, const SENSOR_HUB_Stats_t *pStats)
+{
+  uint32_t i;
+
+  printf("%s: %.0f I2C transactions/s, %.0f timer wakeups/s, overruns %lu, lost %lu\n", Name,
+         Transfers / RUN_S, pStats->Ticks / RUN_S, (unsigned long)pStats->Overruns, (unsigned long)pStats->Lost);
+  for(i = 0; i < (uint32_t)SENSOR_HUB_CONSUMER_NBR; i++)
+  {
+    printf("  %-12s requested %6.2f Hz, delivered %6.2f Hz, task runs %6.2f/s\n", Consumers[i].Name,
+           1.0 / Consumers[i].Period, Samples[i] / RUN_S, Runs[i] / RUN_S);
+  }
+}
+
+/* One read per sensor and per tick, each consumer at its rate */
+static void Test_Shared_Timebase(void)
+{
+  SENSOR_HUB_Stats_t stats;
+  double rate;
+  uint32_t i;
+
+  Start_All();
+  Run(RUN_S, 0);
+  SENSOR_HUB_Get_Stats(&stats);
+  Report("shared timebase", &stats);
+
+  /* Each feature on its own timer took 860 transactions/s */
+  CHECK((Transfers / RUN_S) < 220.0);
+  CHECK((stats.Ticks / RUN_S) < 110.0);
+  CHECK((stats.Overruns == 0U) && (stats.Lost == 0U) && (stats.BusErrors == 0U));
+  CHECK(Errors == 0U);
+  for(i = 0; i < (uint32_t)SENSOR_HUB_CONSUMER_NBR; i++)
+  {
+    /* The periods are whole HW_TS ticks */
+    rate = ((Samples[i] / RUN_S) * PERIOD(Consumers[i].Period) * TICK_US) / 1e6;
+    CHECK((rate > 0.98) && (rate < 1.02));
+  }
+  SENSOR_HUB_StopAll();
+  CHECK(TimerPeriod == 0U);
+}
+
+/* Consumers late by less than the ring read every sample, several per run */
+static void Test_Held_Back(void)
+{
+  SENSOR_HUB_Stats_t stats;
+  uint32_t reference[SENSOR_HUB_CONSUMER_NBR];
+  uint32_t i;
+
+  Start_All();
+  Run(RUN_S, 0);
+  memcpy(reference, Samples, sizeof(reference));
+  SENSOR_HUB_StopAll();
+
+  Start_All();
+  Run(RUN_S, 40);
+  SENSOR_HUB_Get_Stats(&stats);
+  Report("consumer tasks held back 40 ms every second", &stats);
+
+  CHECK(stats.Lost == 0U);
+  CHECK(Errors == 0U);
+  for(i = 0; i < (uint32_t)SENSOR_HUB_CONSUMER_NBR; i++)
+  {
+    CHECK((Samples[i] + 1U) >= reference[i]);
+  }
+  CHECK(Runs[SENSOR_HUB_MOTIONFX] < Samples[SENSOR_HUB_MOTIONFX]);
+  SENSOR_HUB_StopAll();
+}
+
+/* Held back longer than the ring: the samples overwritten are counted */
+static void Test_Overwritten(void)
+{
+  SENSOR_HUB_Stats_t stats;
+  uint32_t read = 0;
+  uint32_t i;
+
+  Start_All();
+  Run(RUN_S, 120);
+  for(i = 0; i < (uint32_t)SENSOR_HUB_CONSUMER_NBR; i++)
+  {
+    ConsumerTasks[i]();
+    read += Samples[i];
+  }
+  SENSOR_HUB_Get_Stats(&stats);
+  Report("consumer tasks held back 120 ms every second", &stats);
+
+  CHECK(stats.Lost != 0U);
+  CHECK((read + stats.Lost) == stats.Deliveries);
+  CHECK(Errors == 0U);
+  SENSOR_HUB_StopAll();
+}
+
+/* A failed read drops the acquisition, the next one is delivered */
+static void Test_Bus_Error(void)
+{
+  SENSOR_HUB_Stats_t before;
+  SENSOR_HUB_Stats_t after;
+
+  Start_All();
+  Run(0.1, 0);
+  SENSOR_HUB_Get_Stats(&before);
+  ReadError = BSP_ERROR_BUS_FAILURE;
+  Run(0.1, 0);
+  SENSOR_HUB_Get_Stats(&after);
+
+  CHECK((after.BusErrors - before.BusErrors) == 1U);
+  CHECK(after.Deliveries > before.Deliveries);
+  CHECK(Errors == 0U);
+  SENSOR_HUB_StopAll();
+}
+
+/* Stubs ---------------------------------------------------------------------*/
+uint32_t HAL_GetTick(void)
+{
+  return (uint32_t)(((double)Now * TICK_US) / 1000.0);
+}
+
+HW_TS_ReturnStatus_t HW_TS_Create(uint32_t TimerProcessID, uint8_t *pTimerId, HW_TS_Mode_t TimerMode, HW_TS_pTimerCb_t pTimerCallBack)
+{
+  (void)TimerProcessID;
+  CHECK(TimerMode == hw_ts_Repeated);
+  *pTimerId = 0;
+  TimerCb = pTimerCallBack;
+  return hw_ts_Successful;
+}
+
+void HW_TS_Start(uint8_t TimerID, uint32_t timeout_ticks)
+{
+  (void)TimerID;
+  TimerPeriod = timeout_ticks;
+  TimerNext = Now + timeout_ticks;
+}
+
+void HW_TS_Stop(uint8_t TimerID)
+{
+  (void)TimerID;
+  TimerPeriod = 0;
+}
+
+void UTIL_SEQ_RegTask(UTIL_SEQ_bm_t TaskId_bm, uint32_t Flags, void (*Task)(void))
+{
+  (void)Flags;
+  Tasks[__builtin_ctz(TaskId_bm)] = Task;
+}
+
+void UTIL_SEQ_SetTask(UTIL_SEQ_bm_t TaskId_bm, uint32_t Task_Prio)
+{
+  (void)Task_Prio;
+  Pending |= TaskId_bm;
+}
+
+/* Contiguous MERGE reads of one device are one transfer */
+int32_t BSP_I2C1_ReadRegAsync(uint16_t Addr, uint16_t Reg, uint8_t *pData, uint16_t Length,
+                              uint8_t Flags, I2C_QUEUE_Cb_t Callback, void *pCtx)
+{
+  uint16_t i;
+
+  (void)pCtx;
+  if(QueueLen == QUEUE_SIZE)
+  {
+    return BSP_ERROR_BUSY;
+  }
+  if(Addr == IMU_ADDRESS)
+  {
+    Acquisition++;
+  }
+  for(i = 0; (i + 1U) < Length; i += 2U)
+  {
+    pData[i] = (uint8_t)Acquisition;
+    pData[i + 1U] = (uint8_t)(Acquisition >> 8);
+  }
+
+  if(!((QueueLen > 0U) && ((Flags & I2C_QUEUE_FLAG_MERGE) != 0U) && (Queue[QueueLen - 1U].Addr == Addr) &&
+       (((Queue[QueueLen - 1U].Reg + Queue[QueueLen - 1U].Length) == Reg) || ((Reg + Length) == Queue[QueueLen - 1U].Reg))))
+  {
+    Transfers++;
+  }
+  Queue[QueueLen].Addr = Addr;
+  Queue[QueueLen].Reg = Reg;
+  Queue[QueueLen].Length = Length;
+  Queue[QueueLen].Callback = Callback;
+  QueueLen++;
+  return BSP_ERROR_NONE;
+}
+
+int32_t IKS01A3_MOTION_SENSOR_Get_Axes_Reg(uint32_t Instance, uint8_t *Address, uint8_t *Reg, uint16_t *Length)
+{
+  if(Instance == IKS01A3_LSM6DSO_0)
+  {
+    *Address = IMU_ADDRESS;
+    *Reg = IMU_REG;
+    *Length = 12;
+  }
+  else if(Instance == IKS01A3_LIS2MDL_0)
+  {
+    *Address = MAG_ADDRESS;
+    *Reg = MAG_REG;
+    *Length = 6;
+  }
+  else
+  {
+    return BSP_ERROR_WRONG_PARAM;
+  }
+  return BSP_ERROR_NONE;
+}
+
+/* Raw counts are returned as they are: gyro z is the last gyro axis, acc x the first acc one */
+int32_t IKS01A3_MOTION_SENSOR_Convert_AccGyro_Axes(uint32_t Instance, const uint8_t *Data, IKS01A3_MOTION_SENSOR_Axes_t *Acceleration, IKS01A3_MOTION_SENSOR_Axes_t *AngularRate)
+{
+  CHECK(Instance == IKS01A3_LSM6DSO_0);
+  AngularRate->x = (uint16_t)(Data[0] | (Data[1] << 8));
+  AngularRate->y = (uint16_t)(Data[2] | (Data[3] << 8));
+  AngularRate->z = (uint16_t)(Data[4] | (Data[5] << 8));
+  Acceleration->x = (uint16_t)(Data[6] | (Data[7] << 8));
+  Acceleration->y = (uint16_t)(Data[8] | (Data[9] << 8));
+  Acceleration->z = (uint16_t)(Data[10] | (Data[11] << 8));
+  return BSP_ERROR_NONE;
+}
+
+/* The magnetometer is read in the same acquisition as the IMU */
+int32_t IKS01A3_MOTION_SENSOR_Convert_Mag_Axes(uint32_t Instance, const uint8_t *Data, IKS01A3_MOTION_SENSOR_Axes_t *MagneticField)
+{
+  CHECK(Instance == IKS01A3_LIS2MDL_0);
+  MagneticField->x = (uint16_t)(Data[0] | (Data[1] << 8));
+  MagneticField->y = (uint16_t)(Data[2] | (Data[3] << 8));
+  MagneticField->z = (uint16_t)(Data[4] | (Data[5] << 8));
+  return BSP_ERROR_NONE;
+}
+
+int main(void)
+{
+  Test_Shared_Timebase();
+  Test_Held_Back();
+  Test_Overwritten();
+  Test_Bus_Error();
+
+  printf("%s\n", (Failures == 0U) ? "PASS" : "FAIL");
+  return (Failures == 0U) ? 0 : 1;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,41 @@
+/**
+ ******************************************************************************
+ * File Name          : ble.h
+ * Description        : Host build of the unit tests: BLE stack definitions
+ *                      and ACI prototypes used by the applications and the
+ *                      services, without the stack itself
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef HOST_BLE_H
+#define HOST_BLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "core/ble_core.h"
+#include "svc/Inc/svc_ctl.h"
+#include "svc/Inc/motenv_stm.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_BLE_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
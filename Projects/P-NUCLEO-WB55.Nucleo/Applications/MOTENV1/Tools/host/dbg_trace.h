@@ -0,0 +1,30 @@
+/**
+ ******************************************************************************
+ * File Name          : dbg_trace.h
+ * Description        : Host build of the unit tests: traces are discarded
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef HOST_DBG_TRACE_H
+#define HOST_DBG_TRACE_H
+
+#undef APP_DBG_MSG
+#define APP_DBG_MSG(...)                do {} while(0)
+
+#define PRINT_MESG_DBG(...)             do {} while(0)
+#define PRINT_NO_MESG(...)              do {} while(0)
+
+#endif /* HOST_DBG_TRACE_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
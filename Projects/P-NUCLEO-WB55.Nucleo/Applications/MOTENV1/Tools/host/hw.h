@@ -0,0 +1,139 @@
+/**
+ ******************************************************************************
+ * File Name          : hw.h
+ * Description        : Host build of the unit tests: hardware interface
+ *                      replacing the STM32WB HAL and Timer Server headers
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef HOST_HW_H
+#define HOST_HW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define LSE_VALUE                       (32768U)
+
+#define __IO                            volatile
+#define UNUSED(X)                       (void)(X)
+#define __weak                          __attribute__((weak))
+
+/* The flash is simulated by the test in hostFlash[], programmed through the HAL */
+#define FLASH_BASE                      ((uintptr_t)hostFlash)
+#define FLASH_PAGE_SIZE                 (4096U)
+#define FLASH_TYPEERASE_PAGES           (0x00U)
+#define FLASH_TYPEPROGRAM_DOUBLEWORD    (0x01U)
+#define FLASH_FLAG_ALL_ERRORS           (0x0000C3FAU)
+#define __HAL_FLASH_CLEAR_FLAG(FLAG)    ((void)(FLAG))
+
+#define HSEM                            ((HSEM_TypeDef *)0)
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  hw_ts_SingleShot,
+  hw_ts_Repeated
+} HW_TS_Mode_t;
+
+typedef enum
+{
+  hw_ts_Successful,
+  hw_ts_Failed,
+} HW_TS_ReturnStatus_t;
+
+typedef enum
+{
+  hw_ts_InitMode_Full,
+  hw_ts_InitMode_Limited,
+} HW_TS_InitMode_t;
+
+typedef enum
+{
+  HAL_OK       = 0x00U,
+  HAL_ERROR    = 0x01U,
+  HAL_BUSY     = 0x02U,
+  HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+typedef struct
+{
+  uint32_t Instance;
+} UART_HandleTypeDef;
+
+typedef struct
+{
+  uint32_t TypeErase;
+  uint32_t Page;
+  uint32_t NbPages;
+} FLASH_EraseInitTypeDef;
+
+typedef uint32_t HSEM_TypeDef;
+
+typedef void (*HW_TS_pTimerCb_t)(void);
+
+typedef struct
+{
+  uint32_t Wakeups;
+  uint32_t WakeupCycles;
+  uint32_t WakeupMaxCycles;
+  uint32_t Reschedules;
+} HW_TS_Stats_t;
+
+/* Exported functions ------------------------------------------------------- */
+/* The tests run in a single thread: the critical sections are empty */
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t PriMask) { (void)PriMask; }
+static inline void __disable_irq(void) { }
+
+/* Exclusive access: the store succeeds if the word still holds the value loaded */
+static __thread uint32_t hostExclusive;
+static inline uint32_t __LDREXW(volatile uint32_t *addr) { hostExclusive = __atomic_load_n(addr, __ATOMIC_SEQ_CST); return hostExclusive; }
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t *addr) { uint32_t expected = hostExclusive; return __atomic_compare_exchange_n(addr, &expected, value, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) ? 0U : 1U; }
+static inline void __CLREX(void) { }
+static inline void __DMB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+/* Implemented by each test, or by the module under test */
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+HW_TS_ReturnStatus_t HW_TS_Create(uint32_t TimerProcessID, uint8_t *pTimerId, HW_TS_Mode_t TimerMode, HW_TS_pTimerCb_t pTimerCallBack);
+void HW_TS_Stop(uint8_t TimerID);
+void HW_TS_Start(uint8_t TimerID, uint32_t timeout_ticks);
+void HW_TS_Delete(uint8_t TimerID);
+void HW_TS_RTC_Wakeup_Handler(void);
+uint16_t HW_TS_RTC_ReadLeftTicksToCount(void);
+void HW_TS_RTC_Int_AppNot(uint32_t TimerProcessID, uint8_t TimerID, HW_TS_pTimerCb_t pTimerCallBack);
+void HW_TS_RTC_CountUpdated_AppNot(void);
+void HW_TS_Get_Stats(HW_TS_Stats_t *pStats);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+extern uint8_t hostFlash[];
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError);
+uint32_t HAL_FLASHEx_IsOperationSuspended(void);
+uint32_t LL_HSEM_1StepLock(HSEM_TypeDef *HSEMx, uint32_t Semaphore);
+void LL_HSEM_ReleaseLock(HSEM_TypeDef *HSEMx, uint32_t Semaphore, uint32_t process);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_HW_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
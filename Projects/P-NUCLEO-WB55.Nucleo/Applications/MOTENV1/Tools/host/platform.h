@@ -0,0 +1,107 @@
+/******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2019 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file platform.h
+ *
+ *  \brief Host build of the unit tests: platform definition layer
+ *
+ *  Replaces Core/Inc/platform.h for the NFC modules built on the host. The
+ *  timers run on HAL_GetTick() and HAL_Delay(), implemented by each test,
+ *  the ST25R3916 access protections are void and the log is discarded
+ *  unless the test is built with HOST_LOG defined.
+ *
+ */
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
+#include "hw.h"
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#define platformProtectST25R391xComm()
+#define platformUnprotectST25R391xComm()
+
+#define platformProtectST25R391xIrqStatus()
+#define platformUnprotectST25R391xIrqStatus()
+
+#define platformProtectWorker()
+#define platformUnprotectWorker()
+
+#define platformLedOff( port, pin )
+#define platformLedOn( port, pin )
+#define platformLedToogle( port, pin )
+
+#define platformTimerCreate( t )                      (HAL_GetTick() + (uint32_t)(t))               /*!< Create a timer with the given time (ms)     */
+#define platformTimerIsExpired( timer )               ((int32_t)(HAL_GetTick() - (uint32_t)(timer)) >= 0) /*!< Checks if the given timer is expired */
+#define platformDelay( t )                            HAL_Delay( t )                                /*!< Performs a delay for the given time (ms)    */
+
+#define platformGetSysTick()                          HAL_GetTick()                                 /*!< Get System Tick ( 1 tick = 1 ms)            */
+
+#ifdef HOST_LOG
+#define platformLog(...)                              printf(__VA_ARGS__)                           /*!< Log  method                                 */
+#else
+#define platformLog(...)                              ((void)0)                                     /*!< Log  method                                 */
+#endif
+
+/*
+******************************************************************************
+* RFAL FEATURES CONFIGURATION
+******************************************************************************
+*/
+
+#define RFAL_FEATURE_NFCA                      true       /*!< Enable/Disable RFAL support for NFC-A (ISO14443A)                         */
+#define RFAL_FEATURE_NFCB                      true       /*!< Enable/Disable RFAL support for NFC-B (ISO14443B)                         */
+#define RFAL_FEATURE_NFCF                      true       /*!< Enable/Disable RFAL support for NFC-F (FeliCa)                            */
+#define RFAL_FEATURE_NFCV                      true       /*!< Enable/Disable RFAL support for NFC-V (ISO15693)                          */
+#define RFAL_FEATURE_T1T                       true       /*!< Enable/Disable RFAL support for T1T (Topaz)                               */
+#define RFAL_FEATURE_T2T                       true       /*!< Enable/Disable RFAL support for T2T                                       */
+#define RFAL_FEATURE_T4T                       true       /*!< Enable/Disable RFAL support for T4T                                       */
+#define RFAL_FEATURE_ST25TB                    true       /*!< Enable/Disable RFAL support for ST25TB                                    */
+#define RFAL_FEATURE_ST25xV                    true       /*!< Enable/Disable RFAL support for ST25TV/ST25DV                             */
+#define RFAL_FEATURE_DYNAMIC_ANALOG_CONFIG     false      /*!< Enable/Disable Analog Configs to be dynamically updated (RAM)             */
+#define RFAL_FEATURE_DYNAMIC_POWER             false      /*!< Enable/Disable RFAL dynamic power support                                 */
+#define RFAL_FEATURE_ISO_DEP                   true       /*!< Enable/Disable RFAL support for ISO-DEP (ISO14443-4)                      */
+#define RFAL_FEATURE_ISO_DEP_POLL              true       /*!< Enable/Disable RFAL support for Poller mode (PCD) ISO-DEP (ISO14443-4)    */
+#define RFAL_FEATURE_ISO_DEP_LISTEN            true       /*!< Enable/Disable RFAL support for Listen mode (PICC) ISO-DEP (ISO14443-4)   */
+#define RFAL_FEATURE_NFC_DEP                   true       /*!< Enable/Disable RFAL support for NFC-DEP (NFCIP1/P2P)                      */
+#define RFAL_FEATURE_LISTEN_MODE               true       /*!< RFAL's listen mode management                                             */
+#define RFAL_FEATURE_WAKEUP_MODE               true       /*!< RFAL's Wake-up mode management                                            */
+
+#define RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN    256U       /*!< ISO-DEP I-Block max length. Please use values as defined by rfalIsoDepFSx */
+#define RFAL_FEATURE_ISO_DEP_APDU_MAX_LEN      1024U      /*!< ISO-DEP APDU max length. Please use multiples of I-Block max length       */
+
+#endif /* PLATFORM_H */
@@ -0,0 +1,56 @@
+/**
+ ******************************************************************************
+ * File Name          : shci.h
+ * Description        : Host build of the unit tests: system commands to the
+ *                      CPU2 used by the applications, without the transport
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef HOST_SHCI_H
+#define HOST_SHCI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  SHCI_Success = 0x00,
+  SHCI_UNKNOWN_CMD = 0x01,
+  SHCI_ERR_UNSUPPORTED_FEATURE = 0x11,
+  SHCI_ERR_INVALID_HCI_CMD_PARAMS = 0x12,
+  SHCI_FUS_CMD_NOT_SUPPORTED = 0xFF,
+} SHCI_CmdStatus_t;
+
+typedef enum
+{
+  ERASE_ACTIVITY_OFF = 0x00,
+  ERASE_ACTIVITY_ON = 0x01,
+} SHCI_EraseActivity_t;
+
+/* Exported functions ------------------------------------------------------- */
+/* Implemented by each test */
+SHCI_CmdStatus_t SHCI_C2_FLASH_EraseActivity(SHCI_EraseActivity_t erase_activity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_SHCI_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
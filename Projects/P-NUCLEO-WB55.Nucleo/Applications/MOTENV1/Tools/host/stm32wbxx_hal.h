@@ -0,0 +1,51 @@
+/**
+ ******************************************************************************
+ * File Name          : stm32wbxx_hal.h
+ * Description        : Host build of the unit tests: HAL types used by the
+ *                      Nucleo bus and IKS01A3 headers, the sensors are
+ *                      simulated behind the BSP_I2C1_* functions
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef HOST_STM32WBXX_HAL_H
+#define HOST_STM32WBXX_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "hw.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define USE_HAL_I2C_REGISTER_CALLBACKS  0U
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint32_t Instance;
+} I2C_HandleTypeDef;
+
+typedef struct
+{
+  uint32_t Instance;
+} DMA_HandleTypeDef;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_STM32WBXX_HAL_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
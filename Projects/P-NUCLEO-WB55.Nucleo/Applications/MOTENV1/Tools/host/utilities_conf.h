@@ -0,0 +1,73 @@
+/**
+ ******************************************************************************
+ * File Name          : utilities_conf.h
+ * Description        : Host build of the unit tests: configuration of the
+ *                      sequencer, statistics timed by a simulated counter
+ ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2019 STMicroelectronics.
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed by ST under Ultimate Liberty license
+  * SLA0044, the "License"; You may not use this file except in compliance with
+  * the License. You may obtain a copy of the License at:
+  *                             www.st.com/SLA0044
+  *
+  ******************************************************************************
+  */
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef UTILITIES_CONF_H
+#define UTILITIES_CONF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <string.h>
+
+/******************************************************************************
+ * common
+ ******************************************************************************/
+#define __WEAK                                  __attribute__((weak))
+
+/** Cortex-M4 by default, 0 selects the count leading zeros table of the Cortex-M0 */
+#ifndef __CORTEX_M
+#define __CORTEX_M                              (4U)
+#endif
+#define __CLZ( value )                          (((value) == 0U) ? 32U : (uint32_t)__builtin_clz( value ))
+
+#define UTILS_ENTER_CRITICAL_SECTION( )         uint32_t primask_bit = 0U; (void)primask_bit
+#define UTILS_EXIT_CRITICAL_SECTION( )
+#define UTILS_MEMSET8( dest, value, size )      memset( dest, value, size);
+
+/******************************************************************************
+ * sequencer
+ ******************************************************************************/
+#define UTIL_SEQ_INIT_CRITICAL_SECTION( )
+#define UTIL_SEQ_ENTER_CRITICAL_SECTION( )      UTILS_ENTER_CRITICAL_SECTION( )
+#define UTIL_SEQ_EXIT_CRITICAL_SECTION( )       UTILS_EXIT_CRITICAL_SECTION( )
+#ifndef UTIL_SEQ_CONF_TASK_NBR
+#define UTIL_SEQ_CONF_TASK_NBR                  (32)
+#endif
+#ifndef UTIL_SEQ_CONF_PRIO_NBR
+#define UTIL_SEQ_CONF_PRIO_NBR                  (4)
+#endif
+#define UTIL_SEQ_MEMSET8( dest, value, size )   UTILS_MEMSET8( dest, value, size )
+
+/** The cycle counter is simulated by the test, 32 bits wide as the DWT one */
+extern uint32_t hostCycles;
+
+#define UTIL_SEQ_CONF_STATS                     1
+#define UTIL_SEQ_CONF_STATS_HIST_SHIFT          6
+#define UTIL_SEQ_STATS_GET_TIME( )              (hostCycles)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*UTILITIES_CONF_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
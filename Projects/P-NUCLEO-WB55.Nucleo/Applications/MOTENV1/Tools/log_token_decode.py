@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2016 STMicroelectronics.
+# Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License").
+#
+# Tokenized log decoder.
+#
+# Rebuilds the text of the records emitted by platformLog() when the firmware
+# is built with LOGGER_TOKENIZED (see Core/Inc/log_token.h). The format
+# strings are read from the .log_str section of the ELF file of the same
+# build. Bytes outside of records, such as the BLE traces, are passed through.
+#
+# Usage:
+#   log_token_decode.py firmware.elf [capture]
+#
+# Without capture the stream is read from stdin, for instance:
+#   stty -F /dev/ttyACM0 115200 raw -echo
+#   log_token_decode.py MOTENV1.elf < /dev/ttyACM0
+#
+
+import re
+import struct
+import sys
+
+LOG_TOKEN_SYNC = 0xA5
+LOG_TOKEN_HDR_LEN = 4
+LOG_STR_SECTION = b'.log_str'
+
+CONVERSION = re.compile(rb'%([-+ #0]*)(\*|[0-9]*)(?:\.(\*|[0-9]*))?(hh|h|ll|l|L|z|j|t)?([diuxXocpsfFeEgGaAn%])')
+
+
+def load_string_table(path):
+    """Return the content of the .log_str section of an ELF file."""
+    with open(path, 'rb') as f:
+        elf = f.read()
+    if elf[:4] != b'\x7fELF' or elf[5] != 1:
+        raise ValueError('%s: not a little endian ELF file' % path)
+
+    if elf[4] == 1:
+        shoff, = struct.unpack_from('<I', elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from('<HHH', elf, 0x2E)
+        fields = '<IIIIII'
+    else:
+        shoff, = struct.unpack_from('<Q', elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from('<HHH', elf, 0x3A)
+        fields = '<IIQQQQ'
+
+    sections = []
+    for i in range(shnum):
+        name, typ, flags, addr, offset, size = struct.unpack_from(fields, elf, shoff + i * shentsize)
+        sections.append((name, typ, offset, size))
+
+    names = sections[shstrndx]
+    for name, typ, offset, size in sections:
+        start = names[2] + name
+        if elf[start:elf.index(b'\0', start)] == LOG_STR_SECTION:
+            if typ == 8:
+                raise ValueError('%s: .log_str has no content' % path)
+            return elf[offset:offset + size]
+    raise ValueError('%s: no .log_str section, not a LOGGER_TOKENIZED build' % path)
+
+
+class Args(object):
+    """Reader of the encoded arguments of a record."""
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def varint(self):
+        val = 0
+        shift = 0
+        while True:
+            if self.pos >= len(self.data):
+                raise EOFError
+            byte = self.data[self.pos]
+            self.pos += 1
+            val |= (byte & 0x7F) << shift
+            shift += 7
+            if (byte & 0x80) == 0:
+                return val
+
+    def signed(self):
+        val = self.varint()
+        return (val >> 1) ^ -(val & 1)
+
+    def string(self):
+        hdr = self.varint()
+        length = hdr >> 1
+        raw = self.data[self.pos:self.pos + length]
+        self.pos += length
+        if hdr & 1:
+            return raw.hex().upper()
+        return raw.decode('latin-1')
+
+    def float(self):
+        if self.pos + 4 > len(self.data):
+            raise EOFError
+        val, = struct.unpack_from('<f', self.data, self.pos)
+        self.pos += 4
+        return val
+
+
+def render(fmt, args):
+    """Format a record; arguments missing from a truncated record show as '...'."""
+    out = []
+    last = 0
+    for m in CONVERSION.finditer(fmt):
+        out.append(fmt[last:m.start()].decode('latin-1'))
+        last = m.end()
+        flags, width, prec, _, conv = [g.decode() if g else '' for g in m.groups()]
+        if conv == '%':
+            out.append('%')
+            continue
+        try:
+            if width == '*':
+                width = str(args.signed())
+            if prec == '*':
+                prec = str(args.signed())
+            if conv in 'di':
+                val = args.signed()
+                conv = 'd'
+            elif conv in 'uxXoc':
+                val = args.varint()
+                conv = 'd' if conv == 'u' else conv
+            elif conv == 'p':
+                val = args.varint()
+                conv = 'x'
+                flags += '#'
+            elif conv == 's':
+                val = args.string()
+            elif conv == 'n':
+                continue
+            else:
+                val = args.float()
+        except EOFError:
+            out.append('...')
+            return ''.join(out)
+        spec = '%' + flags + width + ('.' + prec if prec != '' else '') + conv
+        out.append(spec % val)
+    out.append(fmt[last:].decode('latin-1'))
+    return ''.join(out)
+
+
+def decode(table, stream, out):
+    """Decode a byte stream, records and plain text mixed."""
+    buf = b''
+    while True:
+        chunk = stream.read(1)
+        if not chunk:
+            break
+        buf += chunk
+        while buf:
+            if buf[0] != LOG_TOKEN_SYNC:
+                out.write(buf[:1].decode('latin-1'))
+                buf = buf[1:]
+                continue
+            if len(buf) < 2 or len(buf) < 2 + buf[1]:
+                break                                   # Record not complete yet
+            text = record(table, buf[2:2 + buf[1]])
+            if text is None:
+                out.write(buf[:1].decode('latin-1'))    # Not a record
+                buf = buf[1:]
+                continue
+            out.write(text)
+            buf = buf[2 + buf[1]:]
+        out.flush()
+    out.write(buf.decode('latin-1'))
+
+
+def record(table, data):
+    """Text of a record, None if it does not hold a valid token."""
+    if len(data) < LOG_TOKEN_HDR_LEN - 2:
+        return None
+    token = data[0] | (data[1] << 8)
+    if token >= len(table) or (token > 0 and table[token - 1] != 0):
+        return None
+    fmt = table[token:table.index(b'\0', token)]
+    try:
+        return render(fmt, Args(data[2:]))
+    except (ValueError, TypeError, OverflowError):
+        return None
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write('usage: %s firmware.elf [capture]\n' % argv[0])
+        return 2
+    table = load_string_table(argv[1])
+    stream = open(argv[2], 'rb') if len(argv) == 3 else sys.stdin.buffer
+    try:
+        decode(table, stream, sys.stdout)
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2019 STMicroelectronics.
+# Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License").
+#
+# Low power residency simulator.
+#
+# Replays an activity trace through a model of the sequencer and of the
+# idle policy of UTIL_SEQ_Idle() (see Core/Src/app_entry.c), and reports
+# the time spent in Run, Sleep and Stop mode. The Stop mode budget is read
+# from Core/Inc/app_conf.h (CFG_LPM_STOP_ENTRY_US, CFG_LPM_STOP_EXIT_US,
+# CFG_LPM_STOP_MIN_US). Three policies are compared:
+#   run   : CFG_LPM_SUPPORTED 0, the CPU never leaves Run mode
+#   sleep : Sleep mode only, the SysTick wakes the CPU every ms
+#   stop  : Stop mode when no DMA is ongoing and the next Timer Server
+#           deadline is at least CFG_LPM_STOP_MIN_US away, Sleep otherwise
+#
+# Trace format, one event per line, '#' starts a comment:
+#   <time ms> timer <run us>   Timer Server expiry, known in advance, and
+#                              the time its tasks run
+#   <time ms> irq <run us>     interrupt setting a task, not known in
+#                              advance (ST25R3916 IRQ, MEMS, IPCC)
+#   <time ms> busy <ms>        task polling without idling (NFC discovery)
+#   <time ms> dma <ms>         DMA transfer holding Stop mode (log, vCard,
+#                              I2C1 queue)
+#
+# Usage:
+#   lpm_residency.py [--conf app_conf.h] [--current run,sleep,stop] trace...
+#   lpm_residency.py --example > trace.txt
+#
+
+import argparse
+import bisect
+import os
+import random
+import re
+import sys
+
+APP_CONF = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'Core', 'Inc', 'app_conf.h')
+LSE_HZ = 32768
+SYSTICK_WAKE_US = 2.0           # Sleep mode wakeup by the SysTick, tick handler included
+CURRENT_MA = (3.5, 1.0, 0.002)  # Rough CPU1 Run (HSE 32MHz), Sleep and Stop2 currents
+
+
+def read_conf(path):
+    """Return the Stop mode budget and the Timer Server tick of app_conf.h, in us."""
+    defines = {}
+    with open(path) as f:
+        for line in f:
+            m = re.match(r'\s*#define\s+(CFG_LPM_STOP_\w+|CFG_RTCCLK_DIV)\s+(.+?)\s*(/[*/].*)?$', line)
+            if m and m.group(1) not in defines:
+                defines[m.group(1)] = m.group(2)
+
+    def value(name):
+        expr = defines[name]
+        for key in defines:
+            expr = re.sub(r'\b%s\b' % key, '(%s)' % defines[key], expr)
+        if not re.match(r'^[0-9()+\-*/ ]+$', expr):
+            raise ValueError('%s: cannot evaluate %s' % (path, name))
+        return eval(expr)
+
+    tick = round(value('CFG_RTCCLK_DIV') * 1000000.0 / LSE_HZ)
+    return value('CFG_LPM_STOP_ENTRY_US'), value('CFG_LPM_STOP_EXIT_US'), value('CFG_LPM_STOP_MIN_US'), tick
+
+
+def read_trace(path):
+    """Return the events of a trace as (time us, kind, value) sorted by time."""
+    events = []
+    with open(path) as f:
+        for num, line in enumerate(f, 1):
+            fields = line.split('#', 1)[0].split()
+            if not fields:
+                continue
+            if len(fields) != 3 or fields[1] not in ('timer', 'irq', 'busy', 'dma'):
+                raise ValueError('%s:%d: expected "<ms> timer|irq|busy|dma <value>"' % (path, num))
+            t = float(fields[0]) * 1000.0
+            v = float(fields[2])
+            if fields[1] in ('busy', 'dma'):
+                v *= 1000.0
+            events.append((t, fields[1], v))
+    events.sort(key=lambda e: e[0])
+    return events
+
+
+class Residency(object):
+    """Time per mode of one policy."""
+
+    def __init__(self):
+        self.run = 0.0
+        self.transition = 0.0
+        self.sleep = 0.0
+        self.stop = 0.0
+        self.stops = 0
+        self.short_stops = 0
+        self.wakeups = 0
+
+    def total(self):
+        return self.run + self.transition + self.sleep + self.stop
+
+    def current(self, ma):
+        return ((self.run + self.transition) * ma[0] + self.sleep * ma[1] + self.stop * ma[2]) / self.total()
+
+
+def simulate(events, policy, budget):
+    """Replay the events: the tasks run one after the other, the idle gaps go to the policy."""
+    entry, exit, stop_min, tick = budget
+    min_gap = -(-stop_min // tick) * tick       # DIVC(CFG_LPM_STOP_MIN_US, CFG_TS_TICK_VAL) ticks
+    timers = [e[0] for e in events if e[1] == 'timer']
+    res = Residency()
+
+    # A DMA end wakes the CPU up from Sleep mode: the policy is evaluated again
+    queue = list(events)
+    for t, kind, v in events:
+        if kind == 'dma':
+            queue.append((t + v, 'dma_end', 0.0))
+    queue.sort(key=lambda e: e[0])
+
+    cur = queue[0][0]
+    dma_end = cur
+    for t, kind, v in queue:
+        if t > cur:
+            gap = t - cur
+            if policy == 'run':
+                res.run += gap
+            elif policy == 'stop' and cur >= dma_end and gap >= entry and \
+                    next_deadline(timers, cur) - cur >= min_gap:
+                res.wakeups += 1
+                res.stops += 1
+                if gap < min_gap:
+                    res.short_stops += 1        # Cut by an interrupt the policy could not foresee
+                res.transition += entry + exit
+                res.stop += gap - entry
+                t += exit
+            else:
+                ticks = int(gap // 1000)
+                res.wakeups += 1 + ticks
+                res.run += ticks * SYSTICK_WAKE_US
+                res.sleep += gap - ticks * SYSTICK_WAKE_US
+            cur = t
+
+        if kind in ('timer', 'irq'):
+            res.run += v
+            cur += v
+        elif kind == 'busy':
+            res.run += v
+            cur += v
+        elif kind == 'dma':
+            dma_end = max(dma_end, t + v)
+    return res
+
+
+def next_deadline(timers, t):
+    i = bisect.bisect_left(timers, t)
+    return timers[i] if i < len(timers) else float('inf')
+
+
+def example(duration_s):
+    """A connected device notifying the environment, the NFC reader in Wake-Up mode
+    and a tag presented every 20s."""
+    rnd = random.Random(1)
+    lines = ['# MOTENV1 example trace: <ms> timer|irq|busy|dma <run us | ms>']
+    for t in range(0, duration_s * 1000, 5000):
+        lines.append('%d timer 1800  # environment batch' % t)
+        lines.append('%d dma 2.1' % t)
+    for t in range(0, duration_s * 1000, 2000):
+        lines.append('%d timer 40    # NFC_Read_Callback' % (t + 7))
+    for t in range(10000, duration_s * 1000, 10000):
+        lines.append('%d timer 2600  # Wake-Up mode reference update' % (t + 13))
+    for t in range(0, duration_s * 1000, 40):
+        if rnd.random() < 0.2:
+            lines.append('%d irq 60      # IPCC, CPU2 event' % (t + rnd.randrange(40)))
+    for t in range(20000, duration_s * 1000, 20000):
+        t += rnd.randrange(1000)
+        lines.append('%d irq 120     # ST25R3916 wake-up IRQ' % t)
+        lines.append('%d busy 350    # discovery and NDEF read' % t)
+        lines.append('%d dma 21.7    # vCard on LPUART1' % (t + 350))
+        lines.append('%d dma 6.5     # log' % (t + 350))
+    lines.sort(key=lambda l: float(l.split()[0]) if l[0] != '#' else -1)
+    return '\n'.join(lines) + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Project the low power residency of activity traces.')
+    parser.add_argument('trace', nargs='*', help='activity trace')
+    parser.add_argument('--conf', default=APP_CONF, help='app_conf.h holding the Stop mode budget')
+    parser.add_argument('--current', help='Run,Sleep,Stop currents in mA (default %s)' %
+                        ','.join(str(c) for c in CURRENT_MA))
+    parser.add_argument('--example', type=int, nargs='?', const=120, metavar='SECONDS',
+                        help='print an example trace')
+    args = parser.parse_args()
+
+    if args.example:
+        sys.stdout.write(example(args.example))
+        return 0
+    if not args.trace:
+        parser.error('no trace')
+
+    ma = tuple(float(c) for c in args.current.split(',')) if args.current else CURRENT_MA
+    budget = read_conf(args.conf)
+    print('Stop budget: entry %dus, exit %dus, min %dus, tick %dus' % budget)
+
+    for path in args.trace:
+        events = read_trace(path)
+        if not events:
+            continue
+        print('\n%s: %.1fs' % (path, (events[-1][0] - events[0][0]) / 1e6))
+        print('%-6s %8s %8s %8s %8s %7s %7s %8s %8s' %
+              ('policy', 'run', 'trans', 'sleep', 'stop', 'stops', 'short', 'wakeups', 'avg mA'))
+        for policy in ('run', 'sleep', 'stop'):
+            r = simulate(events, policy, budget)
+            total = r.total() / 100.0
+            print('%-6s %7.2f%% %7.2f%% %7.2f%% %7.2f%% %7d %7d %8d %8.3f' %
+                  (policy, r.run / total, r.transition / total, r.sleep / total, r.stop / total,
+                   r.stops, r.short_stops, r.wakeups, r.current(ma)))
+    return 0
+
+
+if __name__ == '__main__':
+    try:
+        sys.exit(main())
+    except (IOError, ValueError) as e:
+        sys.stderr.write('lpm_residency.py: %s\n' % e)
+        sys.exit(1)
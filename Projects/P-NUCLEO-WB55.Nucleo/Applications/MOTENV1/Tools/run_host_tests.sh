@@ -0,0 +1,101 @@
+#!/bin/sh
+#
+# Copyright (c) 2019 STMicroelectronics.
+# Licensed under ST MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License").
+#
+# Host unit tests.
+#
+# Builds the tests of Core/test and STM32_WPAN/App/test with the host C
+# compiler and runs them. The modules under test are compiled unchanged:
+# Tools/host replaces the HAL, the Timer Server, the BLE stack and the NFC
+# platform headers, each test implements the functions its module calls. A
+# test prints its measurements and exits with a non-zero status on failure.
+#
+# Usage:
+#   run_host_tests.sh [test...]
+#
+# Without argument all the tests are run. CC and BUILD_DIR may be set in the
+# environment (default cc and /tmp/motenv1_host_tests).
+#
+
+cd "$(dirname "$0")/.." || exit 1
+
+ROOT=../../../..
+CC=${CC:-cc}
+BUILD_DIR=${BUILD_DIR:-/tmp/motenv1_host_tests}
+CFLAGS="-std=gnu99 -O1 -g -Wall -Wno-unused-function \
+  -ITools/host -ICore/Inc -ISTM32_WPAN/App \
+  -I$ROOT/Middlewares/ST/STM32_WPAN/ble -I$ROOT/Middlewares/ST/STM32_WPAN/ble/core \
+  -I$ROOT/Middlewares/ST/STM32_WPAN/ble/core/template -I$ROOT/Utilities/sequencer \
+  -I$ROOT/Drivers/BSP/common/firmware/STM/utils/Inc \
+  -I$ROOT/Drivers/BSP/common/firmware/STM/STM32/Inc \
+  -I$ROOT/Middlewares/ST/ndef/include/message \
+  -I$ROOT/Middlewares/ST/rfal/include -I$ROOT/Middlewares/ST/rfal/source/st25r3916 \
+  -IMEMS/Target -I$ROOT/Drivers/BSP/IKS01A3 -I$ROOT/Drivers/BSP/Components/Common \
+  -I$ROOT/Drivers/BSP/Components/hts221 -I$ROOT/Drivers/BSP/Components/lps22hh \
+  -I$ROOT/Drivers/BSP/Components/stts751 -I$ROOT/Drivers/BSP/Components/lsm6dso \
+  -I$ROOT/Drivers/BSP/Components/lis2dw12 -I$ROOT/Drivers/BSP/Components/lis2mdl"
+
+SELECTED="$*"
+PASSED=0
+FAILED=""
+
+# run <name> <sources...>
+run()
+{
+  name=$1
+  shift
+
+  if [ -n "$SELECTED" ]; then
+    case " $SELECTED " in
+      *" $name "*) ;;
+      *) return ;;
+    esac
+  fi
+
+  echo "== $name"
+  if $CC $CFLAGS -o "$BUILD_DIR/$name" "$@" -lm && "$BUILD_DIR/$name"; then
+    PASSED=$((PASSED + 1))
+  else
+    FAILED="$FAILED $name"
+  fi
+}
+
+mkdir -p "$BUILD_DIR" || exit 1
+
+run hw_timerserver Core/test/hw_timerserver_test.c
+run nfc_wakeup Core/test/nfc_wakeup_test.c
+run nfcv_inventory Core/test/nfcv_inventory_test.c
+run nfc_llcp Core/test/nfc_llcp_test.c Core/test/nfc_llcp_a.c Core/test/nfc_llcp_b.c
+run nfc_snep Core/test/nfc_snep_test.c Core/test/nfc_llcp_a.c Core/test/nfc_llcp_b.c Core/test/nfc_snep_a.c Core/test/nfc_snep_b.c
+run nfc_t4t_ce Core/test/nfc_t4t_ce_test.c
+run nfcv_mailbox Core/test/nfcv_mailbox_test.c
+run log_ring Core/test/log_ring_test.c -pthread
+run logger Core/test/logger_test.c
+run log_token Core/test/log_token_test.c -Wl,-T,Tools/host/log_str.ld
+run stm32_seq Core/test/stm32_seq_test.c $ROOT/Utilities/sequencer/stm32_seq.c
+run stm32_seq_m0 Core/test/stm32_seq_test.c $ROOT/Utilities/sequencer/stm32_seq.c -D__CORTEX_M=0
+run batch_notify STM32_WPAN/App/test/batch_notify_test.c STM32_WPAN/App/batch_notify_app.c
+run kv_store Core/test/kv_store_test.c
+run i2c_queue Core/test/i2c_queue_test.c Core/Src/i2c_queue.c
+run hts221 Core/test/hts221_test.c $ROOT/Drivers/BSP/Components/hts221/hts221.c $ROOT/Drivers/BSP/Components/hts221/hts221_reg.c
+run env_server STM32_WPAN/App/test/env_server_test.c STM32_WPAN/App/env_server_app.c \
+  $ROOT/Drivers/BSP/IKS01A3/iks01a3_env_sensors.c $ROOT/Drivers/BSP/IKS01A3/iks01a3_env_sensors_ex.c \
+  $ROOT/Drivers/BSP/Components/hts221/hts221.c $ROOT/Drivers/BSP/Components/hts221/hts221_reg.c \
+  $ROOT/Drivers/BSP/Components/lps22hh/lps22hh.c $ROOT/Drivers/BSP/Components/lps22hh/lps22hh_reg.c \
+  -DENV_BATCHED_ACQUISITION
+run sensor_hub STM32_WPAN/App/test/sensor_hub_test.c STM32_WPAN/App/sensor_hub_app.c
+run console_server STM32_WPAN/App/test/console_server_test.c
+run acc_events STM32_WPAN/App/test/acc_events_test.c STM32_WPAN/App/config_server_app.c \
+  STM32_WPAN/App/motion_ext_server_app.c \
+  $ROOT/Drivers/BSP/IKS01A3/iks01a3_motion_sensors.c $ROOT/Drivers/BSP/IKS01A3/iks01a3_motion_sensors_ex.c \
+  $ROOT/Drivers/BSP/Components/lsm6dso/lsm6dso.c $ROOT/Drivers/BSP/Components/lsm6dso/lsm6dso_reg.c \
+  $ROOT/Drivers/BSP/Components/lis2dw12/lis2dw12.c $ROOT/Drivers/BSP/Components/lis2dw12/lis2dw12_reg.c \
+  $ROOT/Drivers/BSP/Components/lis2mdl/lis2mdl.c $ROOT/Drivers/BSP/Components/lis2mdl/lis2mdl_reg.c
+run motenv_gatt STM32_WPAN/App/test/motenv_gatt_test.c $ROOT/Middlewares/ST/STM32_WPAN/ble/svc/Src/motenv_stm.c \
+  -I$ROOT/Middlewares/ST/STM32_WPAN/ble/svc/Src
+run notify STM32_WPAN/App/test/notify_test.c STM32_WPAN/App/notify_app.c
+run conn_param STM32_WPAN/App/test/conn_param_test.c STM32_WPAN/App/conn_param_app.c
+
+echo "== $PASSED passed${FAILED:+, failed:$FAILED}"
+[ -z "$FAILED" ]
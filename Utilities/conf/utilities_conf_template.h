@@ -58,6 +58,10 @@ extern "C" {
 #define UTIL_SEQ_CONF_TASK_NBR                  (32)
 #define UTIL_SEQ_CONF_PRIO_NBR                  (2)
 #define UTIL_SEQ_MEMSET8( dest, value, size )   UTILS_MEMSET8( dest, value, size )
+#define UTIL_SEQ_CONF_STATS                     (0)
+#define UTIL_SEQ_CONF_STATS_HIST_SHIFT          (10)
+#define UTIL_SEQ_STATS_INIT_TIME( )
+#define UTIL_SEQ_STATS_GET_TIME( )              (0)
 
 
 #ifdef __cplusplus
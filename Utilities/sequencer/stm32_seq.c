@@ -52,17 +52,43 @@ uint32_t round_robin;
 #endif 
 
 #if UTIL_SEQ_CONF_TASK_NBR > 32
-#error "UTIL_SEQ_CONF_PRIO_NBR must be less of equal then 32"
+#error "UTIL_SEQ_CONF_TASK_NBR must be less or equal than 32"
 #endif
   
 #ifndef UTIL_SEQ_CONF_PRIO_NBR 
   #define UTIL_SEQ_CONF_PRIO_NBR  (2)
 #endif
 
+#if UTIL_SEQ_CONF_PRIO_NBR > 32
+#error "UTIL_SEQ_CONF_PRIO_NBR must be less or equal than 32"
+#endif
+
+/** bit of a priority in PrioReady, the highest priority (0) is the most significant bit */
+#define UTIL_SEQ_PRIO_BIT(prio)   (0x80000000U >> (prio))
+
 #ifndef UTIL_SEQ_MEMSET8
 #define UTIL_SEQ_MEMSET8( dest, value, size )   UTILS_MEMSET8( dest, value, size )
 #endif
 
+/*statistics are not recorded by default, they need a time source defined in utilities_conf.h*/
+#ifndef UTIL_SEQ_CONF_STATS
+  #define UTIL_SEQ_CONF_STATS  (0)
+#endif
+
+#if (UTIL_SEQ_CONF_STATS != 0)
+#ifndef UTIL_SEQ_STATS_GET_TIME
+#error "UTIL_SEQ_STATS_GET_TIME( ) must be defined when UTIL_SEQ_CONF_STATS is set"
+#endif
+
+#ifndef UTIL_SEQ_STATS_INIT_TIME
+  #define UTIL_SEQ_STATS_INIT_TIME( )
+#endif
+
+#ifndef UTIL_SEQ_CONF_STATS_HIST_SHIFT
+  #define UTIL_SEQ_CONF_STATS_HIST_SHIFT  (10)
+#endif
+#endif
+
 /* Private variables ---------------------------------------------------------*/
 
 static UTIL_SEQ_bm_t TaskSet = UTIL_SEQ_NO_BIT_SET;
@@ -73,10 +99,34 @@ static UTIL_SEQ_bm_t EvtWaited = UTIL_SEQ_NO_BIT_SET;
 static uint32_t CurrentTaskIdx = 0;
 static void (*TaskCb[UTIL_SEQ_CONF_TASK_NBR])( void );
 static UTIL_SEQ_Priority_t TaskPrio[UTIL_SEQ_CONF_PRIO_NBR] = { 0 };
+#if (UTIL_SEQ_CONF_PRIO_NBR > 1)
+/** one bit per priority with a task set, see UTIL_SEQ_PRIO_BIT() */
+static uint32_t PrioReady = 0;
+/** priorities each task is set with, see UTIL_SEQ_PRIO_BIT() */
+static uint32_t TaskPrioSet[UTIL_SEQ_CONF_TASK_NBR];
+#endif
+
+#if (UTIL_SEQ_CONF_STATS != 0)
+static UTIL_SEQ_TaskStats_t TaskStats[UTIL_SEQ_CONF_TASK_NBR];
+static uint64_t TaskReadyTime[UTIL_SEQ_CONF_TASK_NBR];
+/** time source extended to 64 bits, see stats_time() */
+static uint64_t StatsTime;
+static uint32_t StatsLastTime;
+static uint64_t StatsResetTime;
+static uint64_t StatsTasks;
+static uint64_t StatsIdle;
+/** time spent in nested tasks and idle since the start of the current task, not to be accounted to it */
+static uint64_t StatsNested;
+#endif
 
 /* Global variables ----------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
+static uint32_t count_leading_zeros(uint32_t value);
 static uint32_t bit_position(uint32_t value);
+#if (UTIL_SEQ_CONF_STATS != 0)
+static uint64_t stats_time(void);
+static void stats_task(uint32_t task_idx, uint64_t ready, uint64_t start, uint64_t nested_backup);
+#endif
 
 /* Functions Definition ------------------------------------------------------*/
 void UTIL_SEQ_Init( void )
@@ -89,7 +139,15 @@ void UTIL_SEQ_Init( void )
   CurrentTaskIdx = 0;
   UTIL_SEQ_MEMSET8(TaskCb, 0, sizeof(TaskCb));
   UTIL_SEQ_MEMSET8(TaskPrio, 0, sizeof(TaskPrio));
+#if (UTIL_SEQ_CONF_PRIO_NBR > 1)
+  PrioReady = 0;
+  UTIL_SEQ_MEMSET8(TaskPrioSet, 0, sizeof(TaskPrioSet));
+#endif
   UTIL_SEQ_INIT_CRITICAL_SECTION( );
+#if (UTIL_SEQ_CONF_STATS != 0)
+  UTIL_SEQ_STATS_INIT_TIME( );
+#endif
+  UTIL_SEQ_ResetStats( );
 }
 
 void UTIL_SEQ_DeInit( void )
@@ -104,8 +162,18 @@ void UTIL_SEQ_DeInit( void )
 void UTIL_SEQ_Run( UTIL_SEQ_bm_t mask_bm )
 {
   uint32_t counter;
+#if (UTIL_SEQ_CONF_PRIO_NBR > 1)
+  uint32_t ready_prio;
+#endif
   UTIL_SEQ_bm_t current_task_set;
   UTIL_SEQ_bm_t super_mask_backup;
+#if (UTIL_SEQ_CONF_STATS != 0)
+  uint32_t task_idx;
+  uint64_t ready;
+  uint64_t start;
+  uint64_t now;
+  uint64_t nested_backup;
+#endif
 
   /**
    *  When this function is nested, the mask to be applied cannot be larger than the first call
@@ -124,16 +192,28 @@ void UTIL_SEQ_Run( UTIL_SEQ_bm_t mask_bm )
    */
   while( (TaskSet & TaskMask & SuperMask) && (!(EvtSet & EvtWaited)) )
   {
-    counter = 0;
     /**
      * When a flag is set, the associated bit is set in TaskPrio[counter].priority mask depending
-     * on the priority parameter given from UTIL_SEQ_SetTask()
-     * The while loop is looking for a flag set from the highest priority maskr to the lower
+     * on the priority parameter given from UTIL_SEQ_SetTask(), and the bit of the priority is set in PrioReady
+     * The highest priority with a flag set is given by counting the leading zeros of PrioReady, the lower ones
+     * are only looked at when all the flags set at a higher priority are masked
+     * When no priority is left, count_leading_zeros() returns 32: TaskPrio[] is not read, nothing is run
      */
-    while(!(TaskPrio[counter].priority & TaskMask & SuperMask))
+#if (UTIL_SEQ_CONF_PRIO_NBR > 1)
+    ready_prio = PrioReady;
+    counter = count_leading_zeros(ready_prio);
+    while((ready_prio != 0) && !(TaskPrio[counter].priority & TaskMask & SuperMask))
+    {
+      ready_prio &= ~UTIL_SEQ_PRIO_BIT(counter);
+      counter = count_leading_zeros(ready_prio);
+    }
+    if (ready_prio == 0)
     {
-      counter++;
+      break;
     }
+#else
+    counter = 0;
+#endif
 
     current_task_set = TaskPrio[counter].priority & TaskMask & SuperMask;
 
@@ -166,13 +246,38 @@ void UTIL_SEQ_Run( UTIL_SEQ_bm_t mask_bm )
     /** remove from the list or pending task the one that has been selected to be executed */
     TaskSet &= ~(1 << (CurrentTaskIdx));
     /** remove from all priority mask the task that has been selected to be executed */
-    for (counter = UTIL_SEQ_CONF_PRIO_NBR; counter; counter--)
+#if (UTIL_SEQ_CONF_PRIO_NBR > 1)
+    ready_prio = TaskPrioSet[CurrentTaskIdx];
+    TaskPrioSet[CurrentTaskIdx] = 0;
+    while (ready_prio)
     {
-      TaskPrio[counter - 1].priority &= ~(1 << (CurrentTaskIdx));
+      counter = count_leading_zeros(ready_prio);
+      ready_prio &= ~UTIL_SEQ_PRIO_BIT(counter);
+      TaskPrio[counter].priority &= ~(1 << (CurrentTaskIdx));
+      if (TaskPrio[counter].priority == 0)
+      {
+        PrioReady &= ~UTIL_SEQ_PRIO_BIT(counter);
+      }
     }
+#else
+    TaskPrio[0].priority &= ~(1 << (CurrentTaskIdx));
+#endif
+#if (UTIL_SEQ_CONF_STATS != 0)
+    /** the task may be set again while it runs, the next ready time is recorded from now on */
+    task_idx = CurrentTaskIdx;
+    ready = TaskReadyTime[task_idx];
+#endif
     UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+#if (UTIL_SEQ_CONF_STATS != 0)
+    nested_backup = StatsNested;
+    StatsNested = 0;
+    start = stats_time();
+#endif
     /** Execute the task */
     TaskCb[CurrentTaskIdx]( );
+#if (UTIL_SEQ_CONF_STATS != 0)
+    stats_task(task_idx, ready, start, nested_backup);
+#endif
   }
 
   UTIL_SEQ_PreIdle( );
@@ -180,7 +285,16 @@ void UTIL_SEQ_Run( UTIL_SEQ_bm_t mask_bm )
   UTIL_SEQ_ENTER_CRITICAL_SECTION( );
   if (!((TaskSet & TaskMask & SuperMask) || (EvtSet & EvtWaited)))
   {
+#if (UTIL_SEQ_CONF_STATS != 0)
+    /** the interrupt waking up is served after the critical section, it is not accounted as idle */
+    start = stats_time();
+    UTIL_SEQ_Idle( );
+    now = stats_time();
+    StatsIdle += now - start;
+    StatsNested += now - start;
+#else
     UTIL_SEQ_Idle( );
+#endif
   }
   UTIL_SEQ_EXIT_CRITICAL_SECTION( );
   
@@ -213,8 +327,34 @@ void UTIL_SEQ_SetTask( UTIL_SEQ_bm_t task_id_bm , uint32_t task_prio )
 {
   UTIL_SEQ_ENTER_CRITICAL_SECTION( );
 
+#if (UTIL_SEQ_CONF_STATS != 0)
+  {
+    UTIL_SEQ_bm_t new_task_set = task_id_bm & (~TaskSet);
+    uint64_t now = stats_time();
+
+    while (new_task_set)
+    {
+      TaskReadyTime[bit_position(new_task_set)] = now;
+      new_task_set &= ~(1U << bit_position(new_task_set));
+    }
+  }
+#endif
   TaskSet |= task_id_bm;
   TaskPrio[task_prio].priority |= task_id_bm;
+#if (UTIL_SEQ_CONF_PRIO_NBR > 1)
+  PrioReady |= UTIL_SEQ_PRIO_BIT(task_prio);
+  {
+    UTIL_SEQ_bm_t task_set = task_id_bm;
+    uint32_t task_idx;
+
+    while (task_set)
+    {
+      task_idx = bit_position(task_set);
+      TaskPrioSet[task_idx] |= UTIL_SEQ_PRIO_BIT(task_prio);
+      task_set &= ~(1U << task_idx);
+    }
+  }
+#endif
 
   UTIL_SEQ_EXIT_CRITICAL_SECTION( );
 
@@ -319,6 +459,63 @@ UTIL_SEQ_bm_t UTIL_SEQ_IsEvtPend( void )
   return (EvtSet & EvtWaited);
 }
 
+void UTIL_SEQ_GetStats( UTIL_SEQ_Stats_t *stats )
+{
+  UTIL_SEQ_MEMSET8(stats, 0, sizeof(UTIL_SEQ_Stats_t));
+#if (UTIL_SEQ_CONF_STATS != 0)
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  stats->elapsed = stats_time() - StatsResetTime;
+  stats->tasks = StatsTasks;
+  stats->idle = StatsIdle;
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+
+  /** the running tasks are only accounted when they complete */
+  if (stats->elapsed > (stats->tasks + stats->idle))
+  {
+    stats->other = stats->elapsed - stats->tasks - stats->idle;
+  }
+  if (stats->elapsed != 0)
+  {
+    stats->cpu_load = (uint32_t)(((stats->elapsed - stats->idle) * 1000U) / stats->elapsed);
+  }
+#endif
+
+  return;
+}
+
+void UTIL_SEQ_GetTaskStats( UTIL_SEQ_bm_t task_id_bm, UTIL_SEQ_TaskStats_t *stats )
+{
+#if (UTIL_SEQ_CONF_STATS != 0)
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  *stats = TaskStats[bit_position(task_id_bm)];
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+#else
+  UTIL_SEQ_MEMSET8(stats, 0, sizeof(UTIL_SEQ_TaskStats_t));
+#endif
+
+  return;
+}
+
+void UTIL_SEQ_ResetStats( void )
+{
+#if (UTIL_SEQ_CONF_STATS != 0)
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  UTIL_SEQ_MEMSET8(TaskStats, 0, sizeof(TaskStats));
+  StatsResetTime = stats_time();
+  StatsTasks = 0;
+  StatsIdle = 0;
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+#endif
+
+  return;
+}
+
 __WEAK void UTIL_SEQ_EvtIdle( uint32_t UTIL_SEQ_bm_t, uint32_t evt_waited_bm )
 {
   /**
@@ -357,7 +554,7 @@ __WEAK void UTIL_SEQ_PostIdle( void )
 
 #if( __CORTEX_M == 0)
 static const uint8_t clz_table_4bit[16] = { 4, 3, 2, 2, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0 };	
-static uint32_t bit_position(uint32_t value)
+static uint32_t count_leading_zeros(uint32_t value)
 {
 
   uint32_t n = 0;
@@ -368,12 +565,82 @@ static uint32_t bit_position(uint32_t value)
 
   n += (uint32_t)clz_table_4bit[value >> (32-4)];
 
-  return (31-n);
+  return n;
 }
 #else
+static uint32_t count_leading_zeros(uint32_t value)
+{
+  return __CLZ( value );
+}
+#endif
+
 static uint32_t bit_position(uint32_t value)
 {
-  return (31 -__CLZ( value ));
+  return (31 - count_leading_zeros( value ));
+}
+
+#if (UTIL_SEQ_CONF_STATS != 0)
+/**
+ * The time source is only 32 bits wide, the DWT cycle counter wraps after 67s at 64MHz: it is extended to 64 bits
+ * on each read, so a task or an idle period can last several wraps as long as the source is read once per wrap
+ */
+static uint64_t stats_time(void)
+{
+  uint64_t time;
+  uint32_t now;
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  now = UTIL_SEQ_STATS_GET_TIME( );
+  StatsTime += (uint32_t)(now - StatsLastTime);
+  StatsLastTime = now;
+  time = StatsTime;
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+
+  return time;
+}
+
+/**
+ * Account a task run, the time spent in nested tasks and idle is removed from the task and added to the
+ * nested time of the enclosing task
+ */
+static void stats_task(uint32_t task_idx, uint64_t ready, uint64_t start, uint64_t nested_backup)
+{
+  UTIL_SEQ_TaskStats_t *stats = &TaskStats[task_idx];
+  uint64_t now = stats_time();
+  uint64_t elapsed = now - start;
+  uint64_t run_time = elapsed - StatsNested;
+  uint64_t latency = start - ready;
+  uint64_t bucket = latency >> UTIL_SEQ_CONF_STATS_HIST_SHIFT;
+
+  StatsNested = nested_backup + elapsed;
+
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  StatsTasks += run_time;
+
+  stats->count++;
+  stats->run_time += run_time;
+  if (run_time > stats->run_time_max)
+  {
+    stats->run_time_max = run_time;
+  }
+  stats->latency += latency;
+  if (latency > stats->latency_max)
+  {
+    stats->latency_max = latency;
+  }
+  if (bucket > 0xFFFFFFFFU)
+  {
+    bucket = UTIL_SEQ_STATS_HIST_NBR - 1;
+  }
+  else
+  {
+    bucket = (bucket == 0) ? 0 : (bit_position((uint32_t)bucket) + 1);
+  }
+  stats->latency_hist[(bucket < UTIL_SEQ_STATS_HIST_NBR) ? bucket : (UTIL_SEQ_STATS_HIST_NBR - 1)]++;
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
 }
 #endif
 
@@ -32,6 +32,38 @@ extern "C" {
 /* Exported types ------------------------------------------------------------*/
   typedef uint32_t  UTIL_SEQ_bm_t;
 
+/**
+ * Number of buckets of the ready-to-run latency histogram
+ * Bucket 0 counts the latencies below (1 << UTIL_SEQ_CONF_STATS_HIST_SHIFT), then each bucket doubles the limit,
+ * the last one counts all the longer latencies
+ */
+#define UTIL_SEQ_STATS_HIST_NBR  10
+
+/**
+ * Statistics of a task, times are in units of UTIL_SEQ_STATS_GET_TIME( )
+ */
+typedef struct
+{
+  uint32_t count;                                   /* Number of runs                                         */
+  uint64_t run_time;                                /* Cumulative execution time                              */
+  uint64_t run_time_max;                            /* Longest execution time                                 */
+  uint64_t latency;                                 /* Cumulative time from UTIL_SEQ_SetTask() to the run     */
+  uint64_t latency_max;                             /* Longest time from UTIL_SEQ_SetTask() to the run        */
+  uint32_t latency_hist[UTIL_SEQ_STATS_HIST_NBR];   /* Histogram of the time from UTIL_SEQ_SetTask() to the run */
+} UTIL_SEQ_TaskStats_t;
+
+/**
+ * Statistics of the sequencer, times are in units of UTIL_SEQ_STATS_GET_TIME( )
+ */
+typedef struct
+{
+  uint64_t elapsed;                                 /* Time since the statistics were reset                   */
+  uint64_t tasks;                                   /* Time in the tasks                                      */
+  uint64_t idle;                                    /* Time in UTIL_SEQ_Idle()                                */
+  uint64_t other;                                   /* Remaining time: code out of the tasks, interrupts when idle */
+  uint32_t cpu_load;                                /* Time not idle, per mille of the elapsed time           */
+} UTIL_SEQ_Stats_t;
+
 /* Exported constants --------------------------------------------------------*/
 /* External variables --------------------------------------------------------*/
 /* Exported macros -----------------------------------------------------------*/
@@ -212,6 +244,38 @@ void UTIL_SEQ_WaitEvt( UTIL_SEQ_bm_t evt_id_bm );
  */
 UTIL_SEQ_bm_t UTIL_SEQ_IsEvtPend( void );
 
+/**
+ * @brief This API returns the statistics of the sequencer
+ *        The statistics are only recorded when UTIL_SEQ_CONF_STATS is set to 1 in utilities_conf.h,
+ *        otherwise they read 0
+ *
+ * @param  stats: The statistics
+ * @retval None
+ */
+void UTIL_SEQ_GetStats( UTIL_SEQ_Stats_t *stats );
+
+/**
+ * @brief This API returns the statistics of a task
+ *        The execution time of a task does not include the tasks run and the idle time spent from inside it,
+ *        through UTIL_SEQ_WaitEvt(), but it does include the interrupts it is preempted by.
+ *        The ready-to-run latency is measured from the first UTIL_SEQ_SetTask() since the previous run, it
+ *        includes the time the task was paused.
+ *
+ * @param  task_id_bm: The Id of the task
+ *         It shall be (1<<task_id) where task_id is the number assigned when the task has been registered
+ * @param  stats: The statistics of the task
+ * @retval None
+ */
+void UTIL_SEQ_GetTaskStats( UTIL_SEQ_bm_t task_id_bm, UTIL_SEQ_TaskStats_t *stats );
+
+/**
+ * @brief This API clears the statistics, they are also cleared by UTIL_SEQ_Init( )
+ *
+ * @param  None
+ * @retval None
+ */
+void UTIL_SEQ_ResetStats( void );
+
 /**
  * @brief The sequencer loops in that function until the waited event is set
  *        The application may either enter low power mode or call UTIL_SEQ_Run()